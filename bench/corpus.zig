@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Deterministic synthetic benchmark corpora
+//!
+//! Every corpus is a pure function of (kind, size, seed), so results from
+//! different machines and different runs are comparable. The generators
+//! use a fixed PRNG algorithm (Xoshiro256) rather than `std.crypto.random`.
+
+const std = @import("std");
+const zarc = @import("zarc");
+
+const types = zarc.core.types;
+const header = zarc.formats.tar.header;
+
+/// Default seed used when none is given on the command line
+pub const default_seed: u64 = 0x7a617263;
+
+/// Flat data corpora
+pub const Kind = enum {
+    /// Word-based English-like text (compresses ~3:1)
+    text,
+
+    /// Structured binary records (compresses ~2:1)
+    binary,
+
+    /// Uniformly random bytes (does not compress)
+    incompressible,
+};
+
+/// Tar archive corpora
+pub const TarShape = enum {
+    /// Many small text files (0-4 KiB), dominated by per-entry cost
+    many_small_files,
+
+    /// Four large files, dominated by data throughput
+    few_huge_files,
+};
+
+const words = [_][]const u8{
+    "the",     "archive", "of",     "and",      "to",       "data",     "in",
+    "file",    "is",      "stream", "block",    "with",     "for",      "header",
+    "that",    "on",      "entry",  "as",       "by",       "compress", "buffer",
+    "from",    "path",    "are",    "size",     "which",    "an",       "at",
+    "checksum", "zarc",   "format", "directory", "symbolic", "link",   "mode",
+    "time",    "owner",   "group",  "extract",  "deflate",  "huffman",  "window",
+};
+
+/// Generate a flat corpus
+///
+/// Parameters:
+///   - allocator: Memory allocator (caller owns the returned slice)
+///   - kind: Kind of data
+///   - size: Exact size in bytes
+///   - seed: PRNG seed
+pub fn generate(allocator: std.mem.Allocator, kind: Kind, size: usize, seed: u64) ![]u8 {
+    const data = try allocator.alloc(u8, size);
+    var prng = std.Random.Xoshiro256.init(seed ^ @intFromEnum(kind));
+    fill(prng.random(), kind, data);
+    return data;
+}
+
+fn fill(random: std.Random, kind: Kind, data: []u8) void {
+    switch (kind) {
+        .text => fillText(random, data),
+        .binary => fillBinary(random, data),
+        .incompressible => random.bytes(data),
+    }
+}
+
+fn fillText(random: std.Random, data: []u8) void {
+    var pos: usize = 0;
+    var line_len: usize = 0;
+    while (pos < data.len) {
+        // Zipf-like skew: low indices are picked far more often
+        const r = random.float(f64);
+        const word = words[@intFromFloat(r * r * @as(f64, @floatFromInt(words.len)))];
+
+        const n = @min(word.len, data.len - pos);
+        @memcpy(data[pos..][0..n], word[0..n]);
+        pos += n;
+        line_len += n;
+        if (pos == data.len) break;
+
+        data[pos] = if (line_len > 72) '\n' else ' ';
+        if (line_len > 72) line_len = 0;
+        pos += 1;
+    }
+}
+
+fn fillBinary(random: std.Random, data: []u8) void {
+    // 16-byte records: counter, small-range int, flags, random payload
+    var counter: u32 = 0;
+    var pos: usize = 0;
+    while (pos < data.len) : (pos += 16) {
+        var record: [16]u8 = undefined;
+        std.mem.writeInt(u32, record[0..4], counter, .little);
+        std.mem.writeInt(u32, record[4..8], random.uintLessThan(u32, 1000), .little);
+        std.mem.writeInt(u32, record[8..12], @as(u32, 1) << random.int(u5), .little);
+        random.bytes(record[12..16]);
+        counter +%= 1;
+
+        const n = @min(record.len, data.len - pos);
+        @memcpy(data[pos..][0..n], record[0..n]);
+    }
+}
+
+/// Generated tar archive
+pub const TarCorpus = struct {
+    /// Complete archive bytes
+    data: []u8,
+
+    /// Number of entries
+    entries: u64,
+
+    /// Sum of entry sizes
+    payload_bytes: u64,
+
+    pub fn deinit(self: *TarCorpus, allocator: std.mem.Allocator) void {
+        allocator.free(self.data);
+        self.* = undefined;
+    }
+};
+
+/// Generate a tar archive corpus
+///
+/// Parameters:
+///   - allocator: Memory allocator
+///   - shape: Entry size distribution
+///   - size: Approximate total payload size in bytes
+///   - seed: PRNG seed
+pub fn generateTar(allocator: std.mem.Allocator, shape: TarShape, size: usize, seed: u64) !TarCorpus {
+    var prng = std.Random.Xoshiro256.init(seed ^ (0x100 + @as(u64, @intFromEnum(shape))));
+    const random = prng.random();
+
+    var data = std.ArrayList(u8).init(allocator);
+    errdefer data.deinit();
+
+    var entries: u64 = 0;
+    var payload: u64 = 0;
+    var name_buf: [64]u8 = undefined;
+
+    while (payload < size) : (entries += 1) {
+        const file_size: usize = switch (shape) {
+            .many_small_files => random.uintAtMost(usize, 4096),
+            .few_huge_files => (size + 3) / 4,
+        };
+
+        // Spread files over directories as a real source tree would
+        const path = switch (shape) {
+            .many_small_files => try std.fmt.bufPrint(&name_buf, "src/d{d}/file{d}.txt", .{ entries % 64, entries }),
+            .few_huge_files => try std.fmt.bufPrint(&name_buf, "data/blob{d}.bin", .{entries}),
+        };
+
+        const entry = types.Entry{
+            .path = path,
+            .entry_type = .file,
+            .size = file_size,
+            .mode = 0o644,
+            .mtime = 1700000000,
+        };
+        const hdr = try header.createHeader(&entry, allocator);
+        try data.appendSlice(std.mem.asBytes(&hdr));
+
+        const start = data.items.len;
+        try data.resize(start + file_size);
+        fill(random, if (shape == .many_small_files) .text else .binary, data.items[start..]);
+
+        const block = header.TarHeader.BLOCK_SIZE;
+        try data.appendNTimes(0, (block - file_size % block) % block);
+        payload += file_size;
+    }
+
+    // End-of-archive marker
+    try data.appendNTimes(0, 2 * header.TarHeader.BLOCK_SIZE);
+
+    return .{
+        .data = try data.toOwnedSlice(),
+        .entries = entries,
+        .payload_bytes = payload,
+    };
+}
+
+// Tests
+test "generate: deterministic for a seed" {
+    const allocator = std.testing.allocator;
+
+    for ([_]Kind{ .text, .binary, .incompressible }) |kind| {
+        const a = try generate(allocator, kind, 10_000, 42);
+        defer allocator.free(a);
+        const b = try generate(allocator, kind, 10_000, 42);
+        defer allocator.free(b);
+        const c = try generate(allocator, kind, 10_000, 43);
+        defer allocator.free(c);
+
+        try std.testing.expectEqualSlices(u8, a, b);
+        try std.testing.expect(!std.mem.eql(u8, a, c));
+    }
+}
+
+test "generateTar: archives parse" {
+    const allocator = std.testing.allocator;
+
+    for ([_]TarShape{ .many_small_files, .few_huge_files }) |shape| {
+        var tar = try generateTar(allocator, shape, 200_000, default_seed);
+        defer tar.deinit(allocator);
+
+        try std.testing.expectEqual(@as(usize, 0), tar.data.len % header.TarHeader.BLOCK_SIZE);
+        try std.testing.expect(tar.payload_bytes >= 200_000);
+
+        const first = try header.TarHeader.parse(tar.data[0..header.TarHeader.BLOCK_SIZE]);
+        try std.testing.expect((try first.getSize()) > 0 or shape == .many_small_files);
+    }
+}
@@ -0,0 +1,346 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Benchmark regression gate
+//!
+//! Runs the benchmark harness several times, summarizes each kernel as a
+//! median with a confidence interval, and compares against a baseline.
+//!
+//! Usage:
+//!   zig build bench-gate -- [options] [-- <bench options>]
+//!
+//! Options:
+//!   --runs <n>           Harness runs (default: 5)
+//!   --baseline <file>    Baseline JSON (default: bench/baseline.json)
+//!   --threshold <pct>    Allowed slowdown in percent (default: 5)
+//!   --update             Write the results as the new baseline
+//!
+//! Exit codes: 0 no regression, 1 regression, 2 usage/baseline error.
+
+const std = @import("std");
+const harness = @import("harness.zig");
+const stats = @import("stats.zig");
+
+const Options = struct {
+    bench_path: ?[]const u8 = null,
+    runs: u32 = 5,
+    baseline_path: []const u8 = "bench/baseline.json",
+    threshold: f64 = 0.05,
+    update: bool = false,
+
+    /// Arguments forwarded to every harness run
+    bench_args: []const []const u8 = &.{},
+};
+
+/// Stored per-kernel summary
+pub const KernelSummary = struct {
+    name: []const u8,
+    ns_per_iter: stats.Summary,
+    allocs_per_iter: stats.Summary,
+};
+
+/// Baseline file contents
+pub const Baseline = struct {
+    /// Bumped when the layout changes
+    schema: u32 = 1,
+    corpus_size: u64,
+    seed: u64,
+    runs: u32,
+    kernels: []const KernelSummary,
+};
+
+/// Subset of the harness report the gate needs
+const RunReport = struct {
+    schema: u32,
+    corpus_size: u64,
+    seed: u64,
+    results: []const harness.Result,
+};
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+
+    var arena_state = std.heap.ArenaAllocator.init(gpa.allocator());
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const args = try std.process.argsAlloc(arena);
+    const options = parseOptions(args[1..]) catch |err| {
+        std.debug.print("bench-gate: {s}\n", .{@errorName(err)});
+        std.process.exit(2);
+    };
+    const bench_path = options.bench_path orelse {
+        std.debug.print("bench-gate: --bench <path> is required\n", .{});
+        std.process.exit(2);
+    };
+
+    var reports = std.ArrayList(RunReport).init(arena);
+    for (0..options.runs) |i| {
+        std.debug.print("bench-gate: run {d}/{d}\n", .{ i + 1, options.runs });
+        try reports.append(try runHarness(arena, bench_path, options.bench_args));
+    }
+
+    const current = try summarizeRuns(arena, reports.items);
+
+    var stdout = std.io.bufferedWriter(std.io.getStdOut().writer());
+    defer stdout.flush() catch {};
+
+    if (options.update) {
+        const file = try std.fs.cwd().createFile(options.baseline_path, .{});
+        defer file.close();
+        try std.json.stringify(current, .{ .whitespace = .indent_2 }, file.writer());
+        try file.writeAll("\n");
+        _ = try writeTable(stdout.writer(), null, current, options.threshold);
+        try stdout.writer().print("\nBaseline written to {s}\n", .{options.baseline_path});
+        return;
+    }
+
+    const baseline_json = std.fs.cwd().readFileAlloc(arena, options.baseline_path, 16 * 1024 * 1024) catch |err| {
+        std.debug.print(
+            "bench-gate: cannot read baseline '{s}': {s}\nRun with --update to create one.\n",
+            .{ options.baseline_path, @errorName(err) },
+        );
+        std.process.exit(2);
+    };
+    const baseline = try std.json.parseFromSliceLeaky(Baseline, arena, baseline_json, .{
+        .ignore_unknown_fields = true,
+    });
+
+    if (baseline.corpus_size != current.corpus_size or baseline.seed != current.seed) {
+        std.debug.print(
+            "bench-gate: baseline corpus (size {d}, seed {d}) differs from this run (size {d}, seed {d})\n",
+            .{ baseline.corpus_size, baseline.seed, current.corpus_size, current.seed },
+        );
+        std.process.exit(2);
+    }
+
+    const regressions = try writeTable(stdout.writer(), baseline, current, options.threshold);
+    if (regressions > 0) {
+        try stdout.writer().print("\n{d} kernel(s) regressed by more than {d:.1}%\n", .{
+            regressions,
+            options.threshold * 100,
+        });
+        try stdout.flush();
+        std.process.exit(1);
+    }
+    try stdout.writer().print("\nNo regressions\n", .{});
+}
+
+fn parseOptions(args: []const []const u8) !Options {
+    var options = Options{};
+    var i: usize = 0;
+    while (i < args.len) : (i += 1) {
+        const arg = args[i];
+        if (std.mem.eql(u8, arg, "--")) {
+            options.bench_args = args[i + 1 ..];
+            break;
+        } else if (std.mem.eql(u8, arg, "--update")) {
+            options.update = true;
+            continue;
+        }
+
+        // Remaining options all take a value
+        i += 1;
+        if (i >= args.len) return error.MissingArgument;
+        const value = args[i];
+
+        if (std.mem.eql(u8, arg, "--bench")) {
+            options.bench_path = value;
+        } else if (std.mem.eql(u8, arg, "--runs")) {
+            options.runs = try std.fmt.parseInt(u32, value, 10);
+        } else if (std.mem.eql(u8, arg, "--baseline")) {
+            options.baseline_path = value;
+        } else if (std.mem.eql(u8, arg, "--threshold")) {
+            options.threshold = try std.fmt.parseFloat(f64, value) / 100;
+        } else {
+            return error.UnknownOption;
+        }
+    }
+    if (options.runs == 0) return error.InvalidRuns;
+    return options;
+}
+
+/// Run the harness once and parse its JSON report
+fn runHarness(arena: std.mem.Allocator, bench_path: []const u8, bench_args: []const []const u8) !RunReport {
+    var argv = std.ArrayList([]const u8).init(arena);
+    try argv.append(bench_path);
+    try argv.append("--json");
+    try argv.appendSlice(bench_args);
+
+    const result = try std.process.Child.run(.{
+        .allocator = arena,
+        .argv = argv.items,
+        .max_output_bytes = 16 * 1024 * 1024,
+    });
+
+    const ok = switch (result.term) {
+        .Exited => |code| code == 0,
+        else => false,
+    };
+    if (!ok) {
+        std.debug.print("{s}", .{result.stderr});
+        return error.BenchmarkFailed;
+    }
+
+    return std.json.parseFromSliceLeaky(RunReport, arena, result.stdout, .{
+        .ignore_unknown_fields = true,
+    });
+}
+
+/// Summarize each kernel across runs
+fn summarizeRuns(arena: std.mem.Allocator, reports: []const RunReport) !Baseline {
+    std.debug.assert(reports.len > 0);
+    const first = reports[0];
+
+    var kernels = std.ArrayList(KernelSummary).init(arena);
+    for (first.results, 0..) |result, k| {
+        const times = try arena.alloc(f64, reports.len);
+        const allocs = try arena.alloc(f64, reports.len);
+        for (reports, 0..) |report, r| {
+            // Every run executes the same kernels in the same order
+            const other = report.results[k];
+            if (!std.mem.eql(u8, other.name, result.name)) return error.InconsistentRuns;
+            times[r] = @floatFromInt(other.ns_per_iter);
+            allocs[r] = other.allocs_per_iter;
+        }
+        try kernels.append(.{
+            .name = result.name,
+            .ns_per_iter = stats.summarize(times),
+            .allocs_per_iter = stats.summarize(allocs),
+        });
+    }
+
+    return .{
+        .corpus_size = first.corpus_size,
+        .seed = first.seed,
+        .runs = @intCast(reports.len),
+        .kernels = kernels.items,
+    };
+}
+
+fn findKernel(baseline: Baseline, name: []const u8) ?KernelSummary {
+    for (baseline.kernels) |kernel| {
+        if (std.mem.eql(u8, kernel.name, name)) return kernel;
+    }
+    return null;
+}
+
+/// Print the per-kernel comparison table
+///
+/// Returns:
+///   - Number of regressed kernels
+fn writeTable(writer: anytype, baseline: ?Baseline, current: Baseline, threshold: f64) !usize {
+    try writer.print("{s:<32} {s:>10} {s:>10} {s:>8} {s:>8} {s:>10} {s:>10}\n", .{
+        "kernel", "base ms", "ms", "+/-%", "change%", "allocs", "verdict",
+    });
+
+    var regressions: usize = 0;
+    for (current.kernels) |kernel| {
+        const ms = kernel.ns_per_iter.median / std.time.ns_per_ms;
+        const spread = kernel.ns_per_iter.relativeSpread() * 100;
+
+        const base = if (baseline) |b| findKernel(b, kernel.name) else null;
+        if (base) |b| {
+            const time_verdict = stats.compare(b.ns_per_iter, kernel.ns_per_iter, threshold);
+            const alloc_verdict = stats.compare(b.allocs_per_iter, kernel.allocs_per_iter, threshold);
+            const verdict: stats.Verdict = if (time_verdict == .regressed or alloc_verdict == .regressed)
+                .regressed
+            else
+                time_verdict;
+            if (verdict == .regressed) regressions += 1;
+
+            try writer.print("{s:<32} {d:>10.3} {d:>10.3} {d:>8.1} {d:>8.1} {d:>10.1} {s:>10}\n", .{
+                kernel.name,
+                b.ns_per_iter.median / std.time.ns_per_ms,
+                ms,
+                spread,
+                stats.percentChange(b.ns_per_iter.median, kernel.ns_per_iter.median),
+                kernel.allocs_per_iter.median - b.allocs_per_iter.median,
+                verdict.label(),
+            });
+        } else {
+            try writer.print("{s:<32} {s:>10} {d:>10.3} {d:>8.1} {s:>8} {s:>10} {s:>10}\n", .{
+                kernel.name, "-", ms, spread, "-", "-", if (baseline == null) "" else "new",
+            });
+        }
+    }
+    return regressions;
+}
+
+// Tests
+test "summarizeRuns and writeTable: regression detected" {
+    var arena_state = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    const makeResult = struct {
+        fn f(name: []const u8, ns: u64, allocs: f64) harness.Result {
+            return .{
+                .name = name,
+                .iterations = 3,
+                .bytes = 1024,
+                .entries = 0,
+                .ns_per_iter = ns,
+                .ns_min = ns,
+                .ns_max = ns,
+                .mb_per_s = 0,
+                .ns_per_entry = 0,
+                .allocs_per_iter = allocs,
+                .alloc_bytes_per_iter = 0,
+                .peak_rss_kb = 0,
+            };
+        }
+    }.f;
+
+    var base_reports: [3]RunReport = undefined;
+    var slow_reports: [3]RunReport = undefined;
+    for (0..3) |i| {
+        const jitter: u64 = @intCast(i);
+        const base_results = try arena.dupe(harness.Result, &.{
+            makeResult("crc32/text", 1_000_000 + jitter, 0),
+            makeResult("extract/x", 5_000_000 + jitter, 10),
+        });
+        const slow_results = try arena.dupe(harness.Result, &.{
+            makeResult("crc32/text", 1_000_000 + jitter, 0),
+            makeResult("extract/x", 6_000_000 + jitter, 10),
+        });
+        base_reports[i] = .{ .schema = 1, .corpus_size = 1, .seed = 2, .results = base_results };
+        slow_reports[i] = .{ .schema = 1, .corpus_size = 1, .seed = 2, .results = slow_results };
+    }
+
+    const baseline = try summarizeRuns(arena, &base_reports);
+    const current = try summarizeRuns(arena, &slow_reports);
+
+    // Round-trip the baseline through JSON as the gate does
+    const json = try std.json.stringifyAlloc(arena, baseline, .{});
+    const parsed = try std.json.parseFromSliceLeaky(Baseline, arena, json, .{});
+
+    var out = std.ArrayList(u8).init(arena);
+    try std.testing.expectEqual(@as(usize, 1), try writeTable(out.writer(), parsed, current, 0.05));
+    try std.testing.expect(std.mem.indexOf(u8, out.items, "REGRESSED") != null);
+
+    out.clearRetainingCapacity();
+    try std.testing.expectEqual(@as(usize, 0), try writeTable(out.writer(), parsed, baseline, 0.05));
+}
+
+test "parseOptions: forwards harness arguments" {
+    const args = [_][]const u8{ "--bench", "zarc-bench", "--runs", "7", "--threshold", "2.5", "--", "--size", "4" };
+    const options = try parseOptions(&args);
+    try std.testing.expectEqual(@as(u32, 7), options.runs);
+    try std.testing.expectApproxEqAbs(@as(f64, 0.025), options.threshold, 1e-9);
+    try std.testing.expectEqual(@as(usize, 2), options.bench_args.len);
+    try std.testing.expectEqualStrings("--size", options.bench_args[0]);
+}
@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const zarc = @import("zarc");
+
+const CountingAllocator = zarc.core.instrument.CountingAllocator;
+
+/// Work done by one kernel iteration
+pub const Work = struct {
+    /// Input bytes processed (used for MB/s)
+    bytes: u64,
+
+    /// Archive entries processed (used for ns/entry, 0 if not applicable)
+    entries: u64 = 0,
+};
+
+/// A benchmark kernel
+///
+/// `run` is timed; `reset`, when present, runs untimed before every
+/// iteration (e.g. to remove the previous extraction).
+pub const Kernel = struct {
+    name: []const u8,
+    context: *anyopaque,
+    run: *const fn (context: *anyopaque, allocator: std.mem.Allocator) anyerror!Work,
+    reset: ?*const fn (context: *anyopaque) anyerror!void = null,
+
+    /// Most allocator calls one iteration may make (null = unchecked)
+    ///
+    /// Hot paths that must not allocate in steady state set this to their
+    /// fixed setup cost, which is far below their entry/chunk count.
+    alloc_budget: ?u64 = null,
+};
+
+/// Measurement of one kernel
+pub const Result = struct {
+    name: []const u8,
+    iterations: u64,
+    bytes: u64,
+    entries: u64,
+
+    /// Median wall time of one iteration
+    ns_per_iter: u64,
+
+    /// Fastest and slowest iterations
+    ns_min: u64,
+    ns_max: u64,
+
+    mb_per_s: f64,
+    ns_per_entry: f64,
+
+    /// Allocator calls and bytes requested per iteration
+    allocs_per_iter: f64,
+    alloc_bytes_per_iter: f64,
+
+    /// Process peak resident set size after the kernel ran
+    peak_rss_kb: u64,
+
+    /// The kernel's allocation budget, if it has one
+    alloc_budget: ?u64 = null,
+
+    /// Whether the kernel allocated more than its budget
+    pub fn overBudget(self: Result) bool {
+        const budget = self.alloc_budget orelse return false;
+        return self.allocs_per_iter > @as(f64, @floatFromInt(budget));
+    }
+};
+
+/// Options controlling how long each kernel runs
+pub const RunOptions = struct {
+    /// Keep iterating until this much time has been spent
+    min_time_ns: u64 = 500 * std.time.ns_per_ms,
+
+    /// Lower and upper bounds on timed iterations
+    min_iterations: u32 = 3,
+    max_iterations: u32 = 1000,
+
+    /// Untimed iterations before measuring
+    warmup: u32 = 1,
+};
+
+/// Run a kernel and measure it
+///
+/// Parameters:
+///   - allocator: Backing allocator (for the kernel and for samples)
+///   - kernel: Kernel to run
+///   - options: Iteration bounds
+///
+/// Returns:
+///   - Median timing, throughput and allocation statistics
+pub fn measure(allocator: std.mem.Allocator, kernel: Kernel, options: RunOptions) !Result {
+    var counting = CountingAllocator.init(allocator);
+    const kernel_allocator = counting.allocator();
+
+    for (0..options.warmup) |_| {
+        if (kernel.reset) |reset| try reset(kernel.context);
+        _ = try kernel.run(kernel.context, kernel_allocator);
+    }
+
+    var samples = std.ArrayList(u64).init(allocator);
+    defer samples.deinit();
+
+    var work = Work{ .bytes = 0 };
+    var elapsed: u64 = 0;
+    counting.reset();
+
+    while (samples.items.len < options.max_iterations and
+        (samples.items.len < options.min_iterations or elapsed < options.min_time_ns))
+    {
+        if (kernel.reset) |reset| try reset(kernel.context);
+
+        var timer = try std.time.Timer.start();
+        work = try kernel.run(kernel.context, kernel_allocator);
+        const ns = timer.read();
+
+        try samples.append(ns);
+        elapsed += ns;
+    }
+
+    std.mem.sort(u64, samples.items, {}, std.sort.asc(u64));
+    const iterations = samples.items.len;
+    const median = samples.items[iterations / 2];
+    const seconds = @as(f64, @floatFromInt(@max(median, 1))) / std.time.ns_per_s;
+    const iters_f: f64 = @floatFromInt(iterations);
+
+    return .{
+        .name = kernel.name,
+        .iterations = iterations,
+        .bytes = work.bytes,
+        .entries = work.entries,
+        .ns_per_iter = median,
+        .ns_min = samples.items[0],
+        .ns_max = samples.items[iterations - 1],
+        .mb_per_s = @as(f64, @floatFromInt(work.bytes)) / (1024 * 1024) / seconds,
+        .ns_per_entry = if (work.entries == 0)
+            0
+        else
+            @as(f64, @floatFromInt(median)) / @as(f64, @floatFromInt(work.entries)),
+        .allocs_per_iter = @as(f64, @floatFromInt(counting.allocs.load(.monotonic))) / iters_f,
+        .alloc_bytes_per_iter = @as(f64, @floatFromInt(counting.bytes.load(.monotonic))) / iters_f,
+        .peak_rss_kb = peakRssKb(),
+        .alloc_budget = kernel.alloc_budget,
+    };
+}
+
+/// Peak resident set size of this process in KiB (0 if unknown)
+pub fn peakRssKb() u64 {
+    return switch (builtin.os.tag) {
+        // ru_maxrss is KiB on Linux/BSD and bytes on macOS
+        .linux, .freebsd, .netbsd, .openbsd, .dragonfly => blk: {
+            const usage = std.posix.getrusage(std.posix.rusage.SELF);
+            break :blk @intCast(usage.maxrss);
+        },
+        .macos => blk: {
+            const usage = std.posix.getrusage(std.posix.rusage.SELF);
+            break :blk @as(u64, @intCast(usage.maxrss)) / 1024;
+        },
+        else => 0,
+    };
+}
+
+/// Write results as a human-readable table
+pub fn writeTable(writer: anytype, results: []const Result) !void {
+    try writer.print("{s:<32} {s:>10} {s:>12} {s:>12} {s:>10} {s:>12} {s:>10}\n", .{
+        "kernel", "MB/s", "ms/iter", "ns/entry", "allocs", "alloc KB", "RSS MB",
+    });
+    for (results) |r| {
+        try writer.print("{s:<32} {d:>10.1} {d:>12.3} {d:>12.0} {d:>10.1} {d:>12.1} {d:>10.1}\n", .{
+            r.name,
+            r.mb_per_s,
+            @as(f64, @floatFromInt(r.ns_per_iter)) / std.time.ns_per_ms,
+            r.ns_per_entry,
+            r.allocs_per_iter,
+            r.alloc_bytes_per_iter / 1024,
+            @as(f64, @floatFromInt(r.peak_rss_kb)) / 1024,
+        });
+    }
+}
+
+/// Run metadata recorded alongside results
+pub const Report = struct {
+    /// Bumped when the JSON layout changes
+    schema: u32 = 1,
+    zig_version: []const u8 = builtin.zig_version_string,
+    os: []const u8 = @tagName(builtin.os.tag),
+    arch: []const u8 = @tagName(builtin.cpu.arch),
+    optimize: []const u8 = @tagName(builtin.mode),
+    corpus_size: u64,
+    seed: u64,
+    results: []const Result,
+};
+
+/// Write a report as JSON
+pub fn writeJson(writer: anytype, report: Report) !void {
+    try std.json.stringify(report, .{ .whitespace = .indent_2 }, writer);
+    try writer.writeByte('\n');
+}
+
+// Tests
+test "measure: reports median and work" {
+    const Sum = struct {
+        data: [4096]u8 = [_]u8{1} ** 4096,
+        total: u64 = 0,
+
+        fn run(context: *anyopaque, _: std.mem.Allocator) anyerror!Work {
+            const self: *@This() = @ptrCast(@alignCast(context));
+            for (self.data) |b| self.total += b;
+            return .{ .bytes = self.data.len, .entries = 4 };
+        }
+    };
+    var sum = Sum{};
+
+    const result = try measure(std.testing.allocator, .{
+        .name = "sum",
+        .context = &sum,
+        .run = Sum.run,
+    }, .{ .min_time_ns = 0, .min_iterations = 5, .warmup = 0 });
+
+    try std.testing.expectEqual(@as(u64, 5), result.iterations);
+    try std.testing.expectEqual(@as(u64, 4096), result.bytes);
+    try std.testing.expect(result.ns_min <= result.ns_per_iter and result.ns_per_iter <= result.ns_max);
+    try std.testing.expectEqual(@as(f64, 0), result.allocs_per_iter);
+    try std.testing.expect(!result.overBudget());
+}
+
+test "measure: allocation budget" {
+    const Churn = struct {
+        fn run(_: *anyopaque, allocator: std.mem.Allocator) anyerror!Work {
+            for (0..4) |_| allocator.free(try allocator.alloc(u8, 16));
+            return .{ .bytes = 64 };
+        }
+    };
+    var context: u8 = 0;
+
+    var kernel = Kernel{ .name = "churn", .context = &context, .run = Churn.run, .alloc_budget = 4 };
+    const options = RunOptions{ .min_time_ns = 0, .min_iterations = 3, .warmup = 0 };
+
+    const within = try measure(std.testing.allocator, kernel, options);
+    try std.testing.expectEqual(@as(f64, 4), within.allocs_per_iter);
+    try std.testing.expect(!within.overBudget());
+
+    kernel.alloc_budget = 0;
+    try std.testing.expect((try measure(std.testing.allocator, kernel, options)).overBudget());
+}
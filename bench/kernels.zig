@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Benchmark kernels
+//!
+//! Each kernel is a small struct holding its prepared input; `run` does
+//! one iteration of work and returns how much it processed.
+
+const std = @import("std");
+const zarc = @import("zarc");
+const harness = @import("harness.zig");
+
+const Work = harness.Work;
+const crc32 = zarc.compress.crc32;
+const encode = zarc.compress.deflate.encode;
+const decode = zarc.compress.deflate.decode;
+const zlib = zarc.compress.zlib;
+const streaming = zarc.io.streaming;
+const header = zarc.formats.tar.header;
+const tar = zarc.formats.tar.reader;
+const list = zarc.app.list;
+const extract = zarc.app.extract;
+
+/// Chunk size used by streaming kernels
+const chunk_size = 64 * 1024;
+
+/// Allocation budget for streaming kernels: setup (buffers, decoder
+/// state, the entry arena's first chunk) may allocate, the per-entry and
+/// per-chunk loop may not
+const setup_alloc_budget = 16;
+
+/// CRC-32 over a buffer
+pub const Crc32 = struct {
+    data: []const u8,
+
+    pub const alloc_budget = 0;
+
+    pub fn run(context: *anyopaque, _: std.mem.Allocator) anyerror!Work {
+        const self: *Crc32 = @ptrCast(@alignCast(context));
+        std.mem.doNotOptimizeAway(crc32.crc32(self.data));
+        return .{ .bytes = self.data.len };
+    }
+};
+
+/// Pure Zig deflate encoder at one level
+pub const DeflateEncode = struct {
+    data: []const u8,
+    level: encode.CompressionLevel,
+
+    pub fn run(context: *anyopaque, allocator: std.mem.Allocator) anyerror!Work {
+        const self: *DeflateEncode = @ptrCast(@alignCast(context));
+        const compressed = try encode.compress(allocator, self.data, self.level);
+        allocator.free(compressed);
+        return .{ .bytes = self.data.len };
+    }
+};
+
+/// Pure Zig inflate of a whole gzip buffer
+pub const Inflate = struct {
+    /// Gzip-compressed input
+    compressed: []const u8,
+    uncompressed_len: usize,
+
+    pub fn run(context: *anyopaque, allocator: std.mem.Allocator) anyerror!Work {
+        const self: *Inflate = @ptrCast(@alignCast(context));
+        const data = try decode.decompressGzip(allocator, self.compressed);
+        defer allocator.free(data);
+        if (data.len != self.uncompressed_len) return error.BenchmarkMismatch;
+        return .{ .bytes = data.len };
+    }
+};
+
+/// Streaming gzip read through InflateReader
+pub const GzipRead = struct {
+    compressed: []const u8,
+    uncompressed_len: usize,
+
+    pub const alloc_budget = setup_alloc_budget;
+
+    pub fn run(context: *anyopaque, allocator: std.mem.Allocator) anyerror!Work {
+        const self: *GzipRead = @ptrCast(@alignCast(context));
+
+        var fbs = std.io.fixedBufferStream(self.compressed);
+        const source = fbs.reader();
+
+        var inflate = try zlib.InflateReader.init(allocator, source.any(), .gzip);
+        defer inflate.deinit();
+
+        var buffer: [chunk_size]u8 = undefined;
+        var total: usize = 0;
+        while (true) {
+            const n = try inflate.read(&buffer);
+            if (n == 0) break;
+            total += n;
+        }
+        if (total != self.uncompressed_len) return error.BenchmarkMismatch;
+        return .{ .bytes = total };
+    }
+};
+
+/// Streaming gzip write through GzipWriter into a scratch file
+pub const GzipWrite = struct {
+    data: []const u8,
+    file: std.fs.File,
+
+    pub fn run(context: *anyopaque, allocator: std.mem.Allocator) anyerror!Work {
+        const self: *GzipWrite = @ptrCast(@alignCast(context));
+
+        var writer = try streaming.GzipWriter.init(allocator, self.file, .{});
+        defer writer.deinit();
+
+        var pos: usize = 0;
+        while (pos < self.data.len) {
+            const n = @min(chunk_size, self.data.len - pos);
+            try writer.writeAll(self.data[pos..][0..n]);
+            pos += n;
+        }
+        try writer.finish();
+        return .{ .bytes = self.data.len };
+    }
+
+    pub fn reset(context: *anyopaque) anyerror!void {
+        const self: *GzipWrite = @ptrCast(@alignCast(context));
+        try self.file.seekTo(0);
+        try self.file.setEndPos(0);
+    }
+};
+
+/// Parse and checksum every tar header in memory
+pub const HeaderParse = struct {
+    archive: []const u8,
+
+    pub const alloc_budget = 0;
+
+    pub fn run(context: *anyopaque, _: std.mem.Allocator) anyerror!Work {
+        const self: *HeaderParse = @ptrCast(@alignCast(context));
+        const block = header.TarHeader.BLOCK_SIZE;
+
+        var pos: usize = 0;
+        var entries: u64 = 0;
+        while (pos + block <= self.archive.len) {
+            const raw = self.archive[pos..][0..block];
+            if (std.mem.allEqual(u8, raw, 0)) break;
+
+            const hdr = try header.TarHeader.parse(raw);
+            const size = try hdr.getSize();
+            std.mem.doNotOptimizeAway(hdr.getEntryType());
+
+            pos += block + std.mem.alignForward(usize, @intCast(size), block);
+            entries += 1;
+        }
+        return .{ .bytes = pos, .entries = entries };
+    }
+};
+
+/// `zarc list -l` over a tar file
+pub const List = struct {
+    dir: std.fs.Dir,
+    path: []const u8,
+    archive_bytes: u64,
+
+    pub const alloc_budget = setup_alloc_budget;
+
+    pub fn run(context: *anyopaque, allocator: std.mem.Allocator) anyerror!Work {
+        const self: *List = @ptrCast(@alignCast(context));
+
+        const file = try self.dir.openFile(self.path, .{});
+        defer file.close();
+
+        var reader = try tar.TarReader.init(allocator, file);
+        defer reader.deinit();
+        var archive_reader = reader.archiveReader();
+
+        const result = try list.listArchive(&archive_reader, std.io.null_writer, .{ .format = .long });
+        return .{ .bytes = self.archive_bytes, .entries = result.entries };
+    }
+};
+
+/// `zarc extract` of a tar file into a scratch directory
+pub const Extract = struct {
+    dir: std.fs.Dir,
+    path: []const u8,
+
+    /// Destination, relative to the current working directory
+    dest_path: []const u8,
+
+    pub fn run(context: *anyopaque, allocator: std.mem.Allocator) anyerror!Work {
+        const self: *Extract = @ptrCast(@alignCast(context));
+
+        const file = try self.dir.openFile(self.path, .{});
+        defer file.close();
+
+        var reader = try tar.TarReader.init(allocator, file);
+        defer reader.deinit();
+        var archive_reader = reader.archiveReader();
+
+        var result = try extract.extractArchive(allocator, &archive_reader, self.dest_path, .{ .overwrite = true });
+        defer result.deinit(allocator);
+        if (result.failed > 0) return error.BenchmarkMismatch;
+
+        return .{ .bytes = result.total_bytes, .entries = result.succeeded };
+    }
+
+    pub fn reset(context: *anyopaque) anyerror!void {
+        const self: *Extract = @ptrCast(@alignCast(context));
+        try std.fs.cwd().deleteTree(self.dest_path);
+        try std.fs.cwd().makePath(self.dest_path);
+    }
+};
+
+// Tests
+test "kernels: in-memory kernels run" {
+    const allocator = std.testing.allocator;
+
+    const data = "hello hello hello hello zarc zarc zarc" ** 64;
+    const gz = try zlib.compress(allocator, .gzip, data);
+    defer allocator.free(gz);
+
+    var crc = Crc32{ .data = data };
+    try std.testing.expectEqual(@as(u64, data.len), (try Crc32.run(&crc, allocator)).bytes);
+
+    var inflate = Inflate{ .compressed = gz, .uncompressed_len = data.len };
+    try std.testing.expectEqual(@as(u64, data.len), (try Inflate.run(&inflate, allocator)).bytes);
+
+    var gzip_read = GzipRead{ .compressed = gz, .uncompressed_len = data.len };
+    try std.testing.expectEqual(@as(u64, data.len), (try GzipRead.run(&gzip_read, allocator)).bytes);
+
+    var deflate = DeflateEncode{ .data = data, .level = .fastest };
+    try std.testing.expectEqual(@as(u64, data.len), (try DeflateEncode.run(&deflate, allocator)).bytes);
+}
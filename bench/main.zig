@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! zarc benchmark harness
+//!
+//! Usage:
+//!   zig build bench -- [options]
+//!
+//! Options:
+//!   --json               Write a JSON report to stdout instead of a table
+//!   --output <file>      Also write the JSON report to <file>
+//!   --filter <text>      Only run kernels whose name contains <text>
+//!   --size <MiB>         Corpus size per kernel (default: 8)
+//!   --seed <n>           Corpus seed (default: fixed)
+//!   --min-time <ms>      Minimum time per kernel (default: 500)
+//!   --tmp <dir>          Scratch directory (default: .zig-cache/bench)
+
+const std = @import("std");
+const zarc = @import("zarc");
+const harness = @import("harness.zig");
+const corpus = @import("corpus.zig");
+const kernels = @import("kernels.zig");
+
+const zlib = zarc.compress.zlib;
+
+const Options = struct {
+    json: bool = false,
+    output: ?[]const u8 = null,
+    filter: ?[]const u8 = null,
+    size: usize = 8 * 1024 * 1024,
+    seed: u64 = corpus.default_seed,
+    run: harness.RunOptions = .{},
+    tmp: []const u8 = ".zig-cache/bench",
+};
+
+/// The pure Zig encoder is much slower than everything else; cap its input
+/// so one level-9 pass does not dominate the run
+const max_encode_size = 4 * 1024 * 1024;
+
+pub fn main() !void {
+    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
+    defer _ = gpa.deinit();
+    const allocator = gpa.allocator();
+
+    const args = try std.process.argsAlloc(allocator);
+    defer std.process.argsFree(allocator, args);
+
+    const options = parseOptions(args[1..]) catch |err| {
+        std.debug.print("bench: {s}\n", .{@errorName(err)});
+        std.process.exit(2);
+    };
+
+    // Inputs and kernel contexts live until the end of the run
+    var arena_state = std.heap.ArenaAllocator.init(allocator);
+    defer arena_state.deinit();
+    const arena = arena_state.allocator();
+
+    try std.fs.cwd().makePath(options.tmp);
+    defer std.fs.cwd().deleteTree(options.tmp) catch {};
+    var tmp_dir = try std.fs.cwd().openDir(options.tmp, .{});
+    defer tmp_dir.close();
+
+    var list = std.ArrayList(harness.Kernel).init(allocator);
+    defer list.deinit();
+    try buildKernels(arena, &list, tmp_dir, options);
+
+    var results = std.ArrayList(harness.Result).init(allocator);
+    defer results.deinit();
+
+    for (list.items) |kernel| {
+        if (options.filter) |filter| {
+            if (std.mem.indexOf(u8, kernel.name, filter) == null) continue;
+        }
+        if (!options.json) std.debug.print("running {s}...\n", .{kernel.name});
+        try results.append(try harness.measure(allocator, kernel, options.run));
+    }
+
+    const report = harness.Report{
+        .corpus_size = options.size,
+        .seed = options.seed,
+        .results = results.items,
+    };
+
+    if (options.output) |path| {
+        const file = try std.fs.cwd().createFile(path, .{});
+        defer file.close();
+        var buffered = std.io.bufferedWriter(file.writer());
+        try harness.writeJson(buffered.writer(), report);
+        try buffered.flush();
+    }
+
+    var buffered = std.io.bufferedWriter(std.io.getStdOut().writer());
+    if (options.json) {
+        try harness.writeJson(buffered.writer(), report);
+    } else {
+        try harness.writeTable(buffered.writer(), results.items);
+    }
+    try buffered.flush();
+
+    // Hot paths that allocate in steady state fail the run
+    var over_budget: usize = 0;
+    for (results.items) |r| {
+        if (!r.overBudget()) continue;
+        std.debug.print("bench: {s} made {d:.1} allocations per iteration (budget {d})\n", .{
+            r.name,
+            r.allocs_per_iter,
+            r.alloc_budget.?,
+        });
+        over_budget += 1;
+    }
+    if (over_budget > 0) std.process.exit(1);
+}
+
+fn parseOptions(args: []const []const u8) !Options {
+    var options = Options{};
+    var i: usize = 0;
+    while (i < args.len) : (i += 1) {
+        const arg = args[i];
+        if (std.mem.eql(u8, arg, "--json")) {
+            options.json = true;
+            continue;
+        }
+
+        // Remaining options all take a value
+        i += 1;
+        if (i >= args.len) return error.MissingArgument;
+        const value = args[i];
+
+        if (std.mem.eql(u8, arg, "--output")) {
+            options.output = value;
+        } else if (std.mem.eql(u8, arg, "--filter")) {
+            options.filter = value;
+        } else if (std.mem.eql(u8, arg, "--size")) {
+            options.size = try std.fmt.parseInt(usize, value, 10) * 1024 * 1024;
+        } else if (std.mem.eql(u8, arg, "--seed")) {
+            options.seed = try std.fmt.parseInt(u64, value, 0);
+        } else if (std.mem.eql(u8, arg, "--min-time")) {
+            options.run.min_time_ns = try std.fmt.parseInt(u64, value, 10) * std.time.ns_per_ms;
+        } else if (std.mem.eql(u8, arg, "--tmp")) {
+            options.tmp = value;
+        } else {
+            return error.UnknownOption;
+        }
+    }
+    if (options.size == 0) return error.InvalidSize;
+    return options;
+}
+
+/// Generate corpora and create every kernel
+fn buildKernels(
+    arena: std.mem.Allocator,
+    list: *std.ArrayList(harness.Kernel),
+    tmp_dir: std.fs.Dir,
+    options: Options,
+) !void {
+    const size = options.size;
+    const seed = options.seed;
+
+    const text = try corpus.generate(arena, .text, size, seed);
+    const binary = try corpus.generate(arena, .binary, size, seed);
+    const random = try corpus.generate(arena, .incompressible, size, seed);
+
+    const flat = [_]struct { name: []const u8, data: []const u8 }{
+        .{ .name = "text", .data = text },
+        .{ .name = "binary", .data = binary },
+        .{ .name = "incompressible", .data = random },
+    };
+
+    for (flat) |c| {
+        try add(arena, list, "crc32/{s}", .{c.name}, kernels.Crc32{ .data = c.data });
+    }
+
+    for (flat[0..2]) |c| {
+        for ([_]zarc.compress.deflate.encode.CompressionLevel{ .fastest, .default, .best }) |level| {
+            try add(arena, list, "deflate_encode/L{d}/{s}", .{ @intFromEnum(level), c.name }, kernels.DeflateEncode{
+                .data = c.data[0..@min(c.data.len, max_encode_size)],
+                .level = level,
+            });
+        }
+    }
+
+    for (flat) |c| {
+        const gz = try zlib.compress(arena, .gzip, c.data);
+        try add(arena, list, "inflate/{s}", .{c.name}, kernels.Inflate{
+            .compressed = gz,
+            .uncompressed_len = c.data.len,
+        });
+        try add(arena, list, "gzip_read/{s}", .{c.name}, kernels.GzipRead{
+            .compressed = gz,
+            .uncompressed_len = c.data.len,
+        });
+    }
+
+    for (flat[0..2]) |c| {
+        const file = try tmp_dir.createFile(try std.fmt.allocPrint(arena, "write-{s}.gz", .{c.name}), .{ .read = true });
+        try add(arena, list, "gzip_write/{s}", .{c.name}, kernels.GzipWrite{ .data = c.data, .file = file });
+    }
+
+    for ([_]corpus.TarShape{ .many_small_files, .few_huge_files }) |shape| {
+        const name = @tagName(shape);
+        const archive = try corpus.generateTar(arena, shape, size, seed);
+
+        const tar_path = try std.fmt.allocPrint(arena, "{s}.tar", .{name});
+        try tmp_dir.writeFile(.{ .sub_path = tar_path, .data = archive.data });
+
+        try add(arena, list, "tar_header_parse/{s}", .{name}, kernels.HeaderParse{ .archive = archive.data });
+        try add(arena, list, "list/{s}", .{name}, kernels.List{
+            .dir = tmp_dir,
+            .path = tar_path,
+            .archive_bytes = archive.data.len,
+        });
+        try add(arena, list, "extract/{s}", .{name}, kernels.Extract{
+            .dir = tmp_dir,
+            .path = tar_path,
+            .dest_path = try std.fmt.allocPrint(arena, "{s}/extract-{s}", .{ options.tmp, name }),
+        });
+    }
+}
+
+/// Store a kernel context in the arena and register it
+fn add(
+    arena: std.mem.Allocator,
+    list: *std.ArrayList(harness.Kernel),
+    comptime name_fmt: []const u8,
+    name_args: anytype,
+    kernel: anytype,
+) !void {
+    const T = @TypeOf(kernel);
+    const context = try arena.create(T);
+    context.* = kernel;
+
+    try list.append(.{
+        .name = try std.fmt.allocPrint(arena, name_fmt, name_args),
+        .context = context,
+        .run = T.run,
+        .reset = if (@hasDecl(T, "reset")) T.reset else null,
+        .alloc_budget = if (@hasDecl(T, "alloc_budget")) T.alloc_budget else null,
+    });
+}
+
+test {
+    _ = harness;
+    _ = corpus;
+    _ = kernels;
+    _ = @import("stats.zig");
+    _ = @import("gate.zig");
+}
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Robust summary statistics for benchmark samples
+
+const std = @import("std");
+
+/// Median with a distribution-free confidence interval
+pub const Summary = struct {
+    median: f64,
+    ci_low: f64,
+    ci_high: f64,
+    samples: u32,
+
+    /// Half-width of the interval relative to the median
+    pub fn relativeSpread(self: Summary) f64 {
+        if (self.median == 0) return 0;
+        return (self.ci_high - self.ci_low) / 2 / self.median;
+    }
+};
+
+/// Summarize samples as a median and ~95% confidence interval
+///
+/// The interval uses order statistics (the binomial/sign-test method),
+/// so it makes no assumption about the shape of the timing distribution.
+/// With few samples it widens to the full sample range.
+///
+/// `samples` is sorted in place.
+pub fn summarize(samples: []f64) Summary {
+    std.debug.assert(samples.len > 0);
+    std.mem.sort(f64, samples, {}, std.sort.asc(f64));
+
+    const n = samples.len;
+    const median = if (n % 2 == 1)
+        samples[n / 2]
+    else
+        (samples[n / 2 - 1] + samples[n / 2]) / 2;
+
+    // Ranks n/2 -/+ 1.96 * sqrt(n) / 2 (normal approximation to Binomial(n, 1/2))
+    const half_width = 1.96 * @sqrt(@as(f64, @floatFromInt(n))) / 2;
+    const center = @as(f64, @floatFromInt(n)) / 2;
+    const low_rank = @max(0, @floor(center - half_width));
+    const high_rank = @min(@as(f64, @floatFromInt(n - 1)), @ceil(center + half_width) - 1);
+
+    return .{
+        .median = median,
+        .ci_low = samples[@intFromFloat(low_rank)],
+        .ci_high = samples[@intFromFloat(@max(low_rank, high_rank))],
+        .samples = @intCast(n),
+    };
+}
+
+/// Outcome of comparing a lower-is-better metric with its baseline
+pub const Verdict = enum {
+    /// Within threshold or inside the noise
+    ok,
+
+    /// Faster/smaller beyond threshold and outside the noise
+    improved,
+
+    /// Slower/larger beyond threshold and outside the noise
+    regressed,
+
+    pub fn label(self: Verdict) []const u8 {
+        return switch (self) {
+            .ok => "ok",
+            .improved => "improved",
+            .regressed => "REGRESSED",
+        };
+    }
+};
+
+/// Compare a lower-is-better metric against a baseline
+///
+/// A change only counts when the medians differ by more than `threshold`
+/// (a fraction, e.g. 0.05) and the confidence intervals do not overlap,
+/// so a noisy kernel does not fail the gate on its own.
+pub fn compare(baseline: Summary, current: Summary, threshold: f64) Verdict {
+    const limit = baseline.median * threshold;
+    if (current.median > baseline.median + limit and current.ci_low > baseline.ci_high) {
+        return .regressed;
+    }
+    if (current.median < baseline.median - limit and current.ci_high < baseline.ci_low) {
+        return .improved;
+    }
+    return .ok;
+}
+
+/// Relative change from baseline to current, as a percentage
+pub fn percentChange(baseline: f64, current: f64) f64 {
+    if (baseline == 0) return if (current == 0) 0 else std.math.inf(f64);
+    return (current - baseline) / baseline * 100;
+}
+
+// Tests
+test "summarize: median and interval" {
+    var odd = [_]f64{ 5, 1, 4, 2, 3 };
+    const s = summarize(&odd);
+    try std.testing.expectEqual(@as(f64, 3), s.median);
+    try std.testing.expectEqual(@as(f64, 1), s.ci_low);
+    try std.testing.expectEqual(@as(f64, 5), s.ci_high);
+
+    var even = [_]f64{ 4, 1, 3, 2 };
+    try std.testing.expectEqual(@as(f64, 2.5), summarize(&even).median);
+
+    // With many samples the interval excludes the extremes
+    var many: [100]f64 = undefined;
+    for (&many, 0..) |*x, i| x.* = @floatFromInt(i);
+    const m = summarize(&many);
+    try std.testing.expect(m.ci_low > 30 and m.ci_low < 50);
+    try std.testing.expect(m.ci_high > 50 and m.ci_high < 70);
+
+    var one = [_]f64{7};
+    const single = summarize(&one);
+    try std.testing.expectEqual(@as(f64, 7), single.ci_low);
+    try std.testing.expectEqual(@as(f64, 7), single.ci_high);
+}
+
+test "compare: threshold and noise" {
+    const base = Summary{ .median = 100, .ci_low = 98, .ci_high = 102, .samples = 5 };
+
+    // Clearly slower
+    try std.testing.expectEqual(Verdict.regressed, compare(base, .{ .median = 120, .ci_low = 115, .ci_high = 125, .samples = 5 }, 0.05));
+
+    // Slower but within threshold
+    try std.testing.expectEqual(Verdict.ok, compare(base, .{ .median = 104, .ci_low = 103, .ci_high = 105, .samples = 5 }, 0.05));
+
+    // Slower median, but intervals overlap (noisy run)
+    try std.testing.expectEqual(Verdict.ok, compare(base, .{ .median = 120, .ci_low = 90, .ci_high = 150, .samples = 5 }, 0.05));
+
+    // Clearly faster
+    try std.testing.expectEqual(Verdict.improved, compare(base, .{ .median = 80, .ci_low = 78, .ci_high = 82, .samples = 5 }, 0.05));
+}
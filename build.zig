@@ -19,6 +19,14 @@ pub fn build(b: *std.Build) void {
     const target = b.standardTargetOptions(.{});
     const optimize = b.standardOptimizeOption(.{});
 
+    // Build options exposed to the source as @import("build_options")
+    const build_options = b.addOptions();
+    build_options.addOption(
+        bool,
+        "instrument",
+        b.option(bool, "instrument", "Compile in hot-path timing and counters for --stats") orelse false,
+    );
+
     // zlib dependency (Phase 1-2 temporary C integration)
     // See ADR-004-zlib-integration.md for rationale and migration plan
     // Migration target: Phase 3 (Pure Zig implementation)
@@ -37,6 +45,8 @@ pub fn build(b: *std.Build) void {
         }),
     });
 
+    exe.root_module.addOptions("build_options", build_options);
+
     // Link C dependencies (temporary, Phase 1-2 only)
     exe.linkLibC();
     exe.linkLibrary(zlib_dep.artifact("z")); // zlib for compression
@@ -61,6 +71,38 @@ pub fn build(b: *std.Build) void {
     const run_step = b.step("run", "Run the application");
     run_step.dependOn(&run_cmd.step);
 
+    // libzarc: C API (include/zarc.h) as static and shared libraries
+    const lib_step = b.step("lib", "Build libzarc (static and shared)");
+    for ([_]std.builtin.LinkMode{ .static, .dynamic }) |linkage| {
+        const lib_module = b.createModule(.{
+            .root_source_file = b.path("src/lib.zig"),
+            .target = target,
+            .optimize = optimize,
+            .link_libc = true,
+        });
+        lib_module.addOptions("build_options", build_options);
+
+        const lib = b.addLibrary(.{
+            .linkage = linkage,
+            .name = "zarc",
+            .root_module = lib_module,
+        });
+        lib.linkLibrary(zlib_dep.artifact("z"));
+        lib.addCSourceFile(.{
+            .file = b.path("src/c/zlib_compress.c"),
+            .flags = &.{"-std=c99"},
+        });
+        lib.addCSourceFile(.{
+            .file = b.path("src/c/huffman.c"),
+            .flags = &.{"-std=c99"},
+        });
+        lib.addIncludePath(b.path("src/c"));
+        lib.installHeader(b.path("include/zarc.h"), "zarc.h");
+
+        const install_lib = b.addInstallArtifact(lib, .{});
+        lib_step.dependOn(&install_lib.step);
+    }
+
     // Unit tests
     const unit_tests = b.addTest(.{
         .root_module = b.createModule(.{
@@ -69,6 +111,7 @@ pub fn build(b: *std.Build) void {
             .optimize = optimize,
         }),
     });
+    unit_tests.root_module.addOptions("build_options", build_options);
     unit_tests.linkLibC();
     unit_tests.linkLibrary(zlib_dep.artifact("z"));
     unit_tests.addCSourceFile(.{
@@ -91,6 +134,7 @@ pub fn build(b: *std.Build) void {
         .target = target,
         .optimize = optimize,
     });
+    src_module.addOptions("build_options", build_options);
 
     // Unit tests (tests/unit directory)
     const unit_only_tests = b.addTest(.{
@@ -154,8 +198,99 @@ pub fn build(b: *std.Build) void {
     test_all_step.dependOn(&run_unit_only_tests.step);
     test_all_step.dependOn(&run_integration_tests.step);
 
+    // Benchmarks (always optimized; pass options after `--`)
+    const bench_zlib_dep = b.dependency("zlib", .{
+        .target = target,
+        .optimize = .ReleaseFast,
+    });
+    const bench_src_module = b.createModule(.{
+        .root_source_file = b.path("src/main.zig"),
+        .target = target,
+        .optimize = .ReleaseFast,
+    });
+    bench_src_module.addOptions("build_options", build_options);
+    const bench_exe = b.addExecutable(.{
+        .name = "zarc-bench",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("bench/main.zig"),
+            .target = target,
+            .optimize = .ReleaseFast,
+            .imports = &.{
+                .{ .name = "zarc", .module = bench_src_module },
+            },
+        }),
+    });
+    bench_exe.linkLibC();
+    bench_exe.linkLibrary(bench_zlib_dep.artifact("z"));
+    bench_exe.addCSourceFile(.{
+        .file = b.path("src/c/zlib_compress.c"),
+        .flags = &.{"-std=c99"},
+    });
+    bench_exe.addCSourceFile(.{
+        .file = b.path("src/c/huffman.c"),
+        .flags = &.{"-std=c99"},
+    });
+    bench_exe.addIncludePath(b.path("src/c"));
+
+    const run_bench = b.addRunArtifact(bench_exe);
+    run_bench.setCwd(b.path(".")); // Scratch files go under .zig-cache/bench
+    if (b.args) |args| {
+        run_bench.addArgs(args);
+    }
+    const bench_step = b.step("bench", "Run benchmarks (e.g. zig build bench -- --json)");
+    bench_step.dependOn(&run_bench.step);
+
+    // Benchmark regression gate: runs the harness repeatedly and compares
+    // against bench/baseline.json (`zig build bench-gate -- --update` to record)
+    const gate_exe = b.addExecutable(.{
+        .name = "zarc-bench-gate",
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("bench/gate.zig"),
+            .target = target,
+            .optimize = .ReleaseSafe,
+            .imports = &.{
+                .{ .name = "zarc", .module = bench_src_module },
+            },
+        }),
+    });
+    const run_gate = b.addRunArtifact(gate_exe);
+    run_gate.setCwd(b.path("."));
+    run_gate.addArg("--bench");
+    run_gate.addArtifactArg(bench_exe);
+    if (b.args) |args| {
+        run_gate.addArgs(args);
+    }
+    const gate_step = b.step("bench-gate", "Fail if benchmarks regress against bench/baseline.json");
+    gate_step.dependOn(&run_gate.step);
+
+    // Benchmark harness tests
+    const bench_tests = b.addTest(.{
+        .root_module = b.createModule(.{
+            .root_source_file = b.path("bench/main.zig"),
+            .target = target,
+            .optimize = optimize,
+            .imports = &.{
+                .{ .name = "zarc", .module = src_module },
+            },
+        }),
+    });
+    bench_tests.linkLibC();
+    bench_tests.linkLibrary(zlib_dep.artifact("z"));
+    bench_tests.addCSourceFile(.{
+        .file = b.path("src/c/zlib_compress.c"),
+        .flags = &.{"-std=c99"},
+    });
+    bench_tests.addCSourceFile(.{
+        .file = b.path("src/c/huffman.c"),
+        .flags = &.{"-std=c99"},
+    });
+    bench_tests.addIncludePath(b.path("src/c"));
+
+    const run_bench_tests = b.addRunArtifact(bench_tests);
+    test_all_step.dependOn(&run_bench_tests.step);
+
     // Cross-compilation targets
-    addCrossCompileTargets(b, optimize);
+    addCrossCompileTargets(b, optimize, build_options);
 
     // Documentation generation
     const docs = b.addInstallDirectory(.{
@@ -167,7 +302,7 @@ pub fn build(b: *std.Build) void {
     docs_step.dependOn(&docs.step);
 }
 
-fn addCrossCompileTargets(b: *std.Build, optimize: std.builtin.OptimizeMode) void {
+fn addCrossCompileTargets(b: *std.Build, optimize: std.builtin.OptimizeMode, build_options: *std.Build.Step.Options) void {
     const targets = [_]struct {
         name: []const u8,
         query: std.Target.Query,
@@ -232,6 +367,7 @@ fn addCrossCompileTargets(b: *std.Build, optimize: std.builtin.OptimizeMode) voi
             }),
         });
 
+        exe.root_module.addOptions("build_options", build_options);
         exe.linkLibC();
         exe.linkLibrary(target_zlib_dep.artifact("z"));
         exe.addCSourceFile(.{
@@ -0,0 +1,232 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/*
+ * Copyright 2025 itsakeyfut
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * libzarc - C API
+ *
+ * Streaming archive reading, extraction and the compression engines of
+ * zarc, for use in-process. Built as libzarc.a and libzarc.so (zig build).
+ * The static library also needs zlib at link time (-lz).
+ *
+ * Conventions:
+ *   - Functions return ZARC_OK (0) or a negative zarc_status; read
+ *     functions return a byte count or a negative zarc_status.
+ *   - Every function that allocates takes a zarc_allocator. NULL selects
+ *     malloc/free. A handle keeps using the allocator it was opened with.
+ *   - Handles are not thread-safe; use one handle per thread.
+ *   - Strings returned through zarc_entry are NUL-terminated and valid
+ *     until the next call on the same handle.
+ */
+
+#ifndef ZARC_H
+#define ZARC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ZARC_ABI_VERSION 1
+
+/* Status codes */
+typedef enum zarc_status {
+    ZARC_OK = 0,
+    ZARC_END = 1,                  /* zarc_archive_next: no more entries */
+    ZARC_E_INVALID_ARGUMENT = -1,
+    ZARC_E_NO_MEMORY = -2,
+    ZARC_E_IO = -3,
+    ZARC_E_FORMAT = -4,            /* not an archive of the expected format */
+    ZARC_E_UNSUPPORTED = -5,       /* format, version or method not supported */
+    ZARC_E_CORRUPT = -6,           /* damaged or truncated data */
+    ZARC_E_CHECKSUM = -7,
+    ZARC_E_SECURITY = -8,          /* rejected by the extraction policy */
+    ZARC_E_BUFFER_TOO_SMALL = -9,  /* the required size is reported */
+    ZARC_E_EXISTS = -10,           /* extraction target exists */
+    ZARC_E_CALLBACK = -11          /* a read callback returned an error */
+} zarc_status;
+
+/* Archive formats; ZARC_FORMAT_AUTO detects from the first bytes */
+typedef enum zarc_format {
+    ZARC_FORMAT_AUTO = 0,
+    ZARC_FORMAT_TAR = 1,
+    ZARC_FORMAT_TAR_GZ = 2,
+    ZARC_FORMAT_TAR_BZ2 = 3,
+    ZARC_FORMAT_TAR_XZ = 4,
+    ZARC_FORMAT_TAR_ZST = 5,
+    ZARC_FORMAT_TAR_LZ4 = 6,
+    ZARC_FORMAT_ZIP = 7            /* seekable file descriptors only */
+} zarc_format;
+
+/* Compression codecs */
+typedef enum zarc_codec {
+    ZARC_CODEC_GZIP = 1,
+    ZARC_CODEC_ZLIB = 2,
+    ZARC_CODEC_ZSTD = 3,
+    ZARC_CODEC_LZ4 = 4,
+    ZARC_CODEC_BZIP2 = 5,          /* decompression only */
+    ZARC_CODEC_XZ = 6              /* decompression only */
+} zarc_codec;
+
+typedef enum zarc_entry_type {
+    ZARC_ENTRY_FILE = 0,
+    ZARC_ENTRY_DIRECTORY = 1,
+    ZARC_ENTRY_SYMLINK = 2,
+    ZARC_ENTRY_HARDLINK = 3,
+    ZARC_ENTRY_CHAR_DEVICE = 4,
+    ZARC_ENTRY_BLOCK_DEVICE = 5,
+    ZARC_ENTRY_FIFO = 6
+} zarc_entry_type;
+
+/*
+ * Caller-provided allocator. alloc returns memory aligned to `alignment`
+ * (a power of two) or NULL; free receives the size and alignment the
+ * block was allocated with.
+ */
+typedef struct zarc_allocator {
+    void *ctx;
+    void *(*alloc)(void *ctx, size_t size, size_t alignment);
+    void (*free)(void *ctx, void *ptr, size_t size, size_t alignment);
+} zarc_allocator;
+
+/*
+ * Read callback: fill up to `len` bytes of `buf` and return the count,
+ * 0 at the end of the data, or a negative value on error.
+ */
+typedef ptrdiff_t (*zarc_read_fn)(void *ctx, void *buf, size_t len);
+
+/* Metadata of the current entry */
+typedef struct zarc_entry {
+    const char *path;
+    const char *link_target;       /* "" unless a symlink or hard link */
+    uint64_t size;
+    int64_t mtime;                 /* seconds since the Unix epoch */
+    uint32_t mode;
+    uint32_t uid;
+    uint32_t gid;
+    int32_t type;                  /* zarc_entry_type */
+} zarc_entry;
+
+const char *zarc_version(void);
+
+/* Static description of a status code */
+const char *zarc_strerror(int status);
+
+/* --- Archive reading ------------------------------------------------- */
+
+typedef struct zarc_archive zarc_archive;
+
+/*
+ * Open an archive from a file descriptor, which is not closed. Seekable
+ * descriptors are read from offset 0 and also support ZIP and indexed
+ * .tar.gz/.tar.zst archives, decoded on all cores; pipes are read as a
+ * stream. POSIX only (ZARC_E_UNSUPPORTED on Windows).
+ */
+int zarc_archive_open_fd(const zarc_allocator *allocator, int fd,
+                         zarc_format format, zarc_archive **out);
+
+/* Open an archive held in memory; `data` must outlive the handle */
+int zarc_archive_open_memory(const zarc_allocator *allocator,
+                             const void *data, size_t len,
+                             zarc_format format, zarc_archive **out);
+
+/* Open an archive produced by a read callback (tar formats only) */
+int zarc_archive_open_callback(const zarc_allocator *allocator,
+                               zarc_read_fn read, void *ctx,
+                               zarc_format format, zarc_archive **out);
+
+/* Advance to the next entry: ZARC_OK, ZARC_END or an error */
+int zarc_archive_next(zarc_archive *archive, zarc_entry *entry);
+
+/* Read data of the current entry: bytes read (0 at its end) or an error */
+int64_t zarc_archive_read(zarc_archive *archive, void *buf, size_t len);
+
+/* Name of the last error on this handle (for diagnostics), or "" */
+const char *zarc_archive_error(const zarc_archive *archive);
+
+void zarc_archive_close(zarc_archive *archive);
+
+/* --- Extraction ------------------------------------------------------ */
+
+#define ZARC_EXTRACT_OVERWRITE            (1u << 0)
+#define ZARC_EXTRACT_PRESERVE_PERMISSIONS (1u << 1)
+#define ZARC_EXTRACT_PRESERVE_TIMESTAMPS  (1u << 2)
+#define ZARC_EXTRACT_CONTINUE_ON_ERROR    (1u << 3)
+
+typedef enum zarc_symlink_policy {
+    ZARC_SYMLINKS_DISALLOW = 0,
+    ZARC_SYMLINKS_ONLY_RELATIVE = 1,  /* relative links that stay inside */
+    ZARC_SYMLINKS_ALLOW_ALL = 2
+} zarc_symlink_policy;
+
+typedef struct zarc_extract_options {
+    uint32_t flags;                /* ZARC_EXTRACT_* */
+    int32_t symlinks;              /* zarc_symlink_policy */
+    uint64_t max_file_size;        /* bytes, 0 for the default */
+    uint64_t max_total_size;       /* bytes, 0 for the default */
+} zarc_extract_options;
+
+typedef struct zarc_extract_result {
+    uint64_t extracted;            /* entries */
+    uint64_t failed;               /* entries skipped with CONTINUE_ON_ERROR */
+    uint64_t bytes;
+} zarc_extract_result;
+
+/* Fill in the defaults (timestamps preserved, no symlinks, 10 GiB/100 GiB) */
+void zarc_extract_options_init(zarc_extract_options *options);
+
+/*
+ * Extract the remaining entries below the directory `dirfd`, with path
+ * validation and size limits. `options` and `result` may be NULL.
+ */
+int zarc_archive_extract(zarc_archive *archive, int dirfd,
+                         const zarc_extract_options *options,
+                         zarc_extract_result *result);
+
+/* --- Compression engines --------------------------------------------- */
+
+/*
+ * One-shot compression into a caller buffer. `level` is 0 for the
+ * codec's default or 1-9 (gzip and zstd; zlib and LZ4 always use their
+ * default). On ZARC_E_BUFFER_TOO_SMALL, *dst_len holds the size required.
+ */
+int zarc_compress(const zarc_allocator *allocator, zarc_codec codec, int level,
+                  const void *src, size_t src_len,
+                  void *dst, size_t dst_capacity, size_t *dst_len);
+
+/* One-shot decompression into a caller buffer, as zarc_compress */
+int zarc_decompress(const zarc_allocator *allocator, zarc_codec codec,
+                    const void *src, size_t src_len,
+                    void *dst, size_t dst_capacity, size_t *dst_len);
+
+typedef struct zarc_decoder zarc_decoder;
+
+/* Streaming decompression of the data produced by a read callback */
+int zarc_decoder_open(const zarc_allocator *allocator, zarc_codec codec,
+                      zarc_read_fn read, void *ctx, zarc_decoder **out);
+
+/* Bytes decoded (0 at the end of the stream) or an error */
+int64_t zarc_decoder_read(zarc_decoder *decoder, void *buf, size_t len);
+
+void zarc_decoder_close(zarc_decoder *decoder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZARC_H */
@@ -14,11 +14,16 @@
 // limitations under the License.
 
 const std = @import("std");
+const builtin = @import("builtin");
 const errors = @import("../core/errors.zig");
 const types = @import("../core/types.zig");
 const archive = @import("../formats/archive.zig");
+const pax = @import("../formats/tar/pax.zig");
 const security = @import("security.zig");
+const path_filter = @import("filter.zig");
 const platform = @import("../platform/common.zig");
+const linux = @import("../platform/linux.zig");
+const instrument = @import("../core/instrument.zig");
 
 /// Options for archive extraction
 pub const ExtractOptions = struct {
@@ -34,10 +39,20 @@ pub const ExtractOptions = struct {
     /// Default: true (maintain original timestamps)
     preserve_timestamps: bool = true,
 
+    /// Restore extended attributes, POSIX ACLs and file capabilities
+    /// (Linux only; needs privileges for trusted.* and security.*)
+    /// Default: false
+    preserve_xattrs: bool = false,
+
     /// Continue extraction even if some entries fail
     /// Default: false (stop on first error)
     continue_on_error: bool = false,
 
+    /// Compiled --include/--exclude patterns; entries it rejects are
+    /// skipped without being read
+    /// Default: null (extract everything)
+    filter: ?*path_filter.PathFilter = null,
+
     /// Security policy to apply during extraction
     /// Default: SecurityPolicy{} (secure defaults)
     security_policy: security.SecurityPolicy = .{},
@@ -55,6 +70,9 @@ pub const ExtractResult = struct {
     /// Number of failed entries
     failed: usize = 0,
 
+    /// Number of entries rejected by the filter
+    skipped: usize = 0,
+
     /// Warnings encountered during extraction
     warnings: std.ArrayListUnmanaged(Warning) = .{},
 
@@ -135,6 +153,7 @@ pub const ExtractResult = struct {
             error.SymlinkNotAllowed,
             error.AbsoluteSymlinkNotAllowed,
             error.NullByteInFilename,
+            error.CaseCollision,
             => errors.formatError(allocator, @errorCast(err), .{
                 .path = entry_path,
             }) catch try std.fmt.allocPrint(allocator, "Error: {s}\nFile: {s}", .{ @errorName(err), entry_path }),
@@ -154,21 +173,313 @@ pub const ExtractResult = struct {
     }
 };
 
+/// Extraction root and how containment beneath it is enforced
+const Destination = struct {
+    /// Destination directory handle
+    dir: std.fs.Dir,
+
+    /// Every open below `dir` goes through openat2(RESOLVE_BENEATH), so the
+    /// kernel rejects escapes and the realpath-based checks are skipped
+    kernel_contained: bool,
+
+    /// Metadata deferred until the entries it applies to are in place
+    metadata: *MetadataQueue,
+
+    /// Filesystem features of `dir`, probed once per extraction
+    caps: platform.DirCapabilities,
+
+    /// Paths extracted so far; null when `dir` is case-sensitive
+    case_folds: ?*CaseFolds = null,
+
+    inline fn contained(self: Destination) bool {
+        return builtin.os.tag == .linux and self.kernel_contained;
+    }
+};
+
+/// Entry metadata, applied in batches through descriptors
+///
+/// A file keeps the descriptor it was written through until its batch
+/// goes to `Platform.applyMetadata`. No path is looked up again, and a
+/// symlink extracted over the same name later cannot redirect the update.
+/// Files are flushed every `batch_size` records, which also bounds the
+/// descriptors held open. Directories wait until the end, so creating
+/// their children cannot change their mtime and a read-only mode cannot
+/// block later entries. Each directory is then opened once, without
+/// following a symlink at its name (and beneath the root when `contained`).
+const MetadataQueue = struct {
+    allocator: std.mem.Allocator,
+    dir: std.fs.Dir,
+    contained: bool,
+    files: std.ArrayListUnmanaged(platform.MetadataRecord) = .{},
+    file_paths: std.ArrayListUnmanaged([]const u8) = .{},
+    file_data: std.heap.ArenaAllocator,
+    dirs: std.ArrayListUnmanaged(platform.MetadataRecord) = .{},
+    dir_paths: std.ArrayListUnmanaged([]const u8) = .{},
+    dir_data: std.heap.ArenaAllocator,
+
+    const batch_size = 128;
+
+    fn init(allocator: std.mem.Allocator, dir: std.fs.Dir, contained: bool) MetadataQueue {
+        return .{
+            .allocator = allocator,
+            .dir = dir,
+            .contained = contained,
+            .file_data = std.heap.ArenaAllocator.init(allocator),
+            .dir_data = std.heap.ArenaAllocator.init(allocator),
+        };
+    }
+
+    fn deinit(self: *MetadataQueue) void {
+        for (self.files.items) |record| std.posix.close(record.fd);
+        self.files.deinit(self.allocator);
+        self.file_paths.deinit(self.allocator);
+        self.file_data.deinit();
+        self.dirs.deinit(self.allocator);
+        self.dir_paths.deinit(self.allocator);
+        self.dir_data.deinit();
+    }
+
+    /// Queue the metadata of a written file
+    ///
+    /// Returns true when the queue took `file` over (it is closed after its
+    /// batch), false when there is nothing to apply and the caller keeps it.
+    fn pushFile(
+        self: *MetadataQueue,
+        validated_path: []const u8,
+        entry: types.Entry,
+        file: std.fs.File,
+        options: ExtractOptions,
+    ) !bool {
+        if (!wantMetadata(entry, options)) return false;
+
+        try self.files.ensureUnusedCapacity(self.allocator, 1);
+        try self.file_paths.ensureUnusedCapacity(self.allocator, 1);
+        const arena = self.file_data.allocator();
+        const path = try arena.dupe(u8, validated_path);
+        const record = try makeRecord(arena, file.handle, entry, options);
+        self.file_paths.appendAssumeCapacity(path);
+        self.files.appendAssumeCapacity(record);
+        return true;
+    }
+
+    /// Queue the metadata of a directory, applied by flushAll()
+    fn pushDirectory(
+        self: *MetadataQueue,
+        validated_path: []const u8,
+        entry: types.Entry,
+        options: ExtractOptions,
+    ) !void {
+        if (!wantMetadata(entry, options)) return;
+
+        const arena = self.dir_data.allocator();
+        try self.dir_paths.append(self.allocator, try arena.dupe(u8, validated_path));
+        // The descriptor is opened when the record is applied
+        try self.dirs.append(self.allocator, try makeRecord(arena, undefined, entry, options));
+    }
+
+    fn makeRecord(
+        arena: std.mem.Allocator,
+        fd: std.posix.fd_t,
+        entry: types.Entry,
+        options: ExtractOptions,
+    ) !platform.MetadataRecord {
+        var record = platform.MetadataRecord{
+            .fd = fd,
+            .mode = if (wantPermissions(options)) entry.mode else null,
+        };
+        if (options.preserve_xattrs and entry.xattr_records.len > 0) {
+            record.xattrs = try pax.decodeXattrs(arena, entry.xattr_records);
+        }
+        if (options.preserve_timestamps) {
+            record.atime = entry.atime orelse entry.mtime;
+            record.atime_nsec = if (entry.atime != null) entry.atime_nsec else entry.mtime_nsec;
+            record.mtime = entry.mtime;
+            record.mtime_nsec = entry.mtime_nsec;
+        }
+        return record;
+    }
+
+    /// Apply queued file records once a batch is full
+    fn flushFiles(self: *MetadataQueue, result: *ExtractResult, options: ExtractOptions) !void {
+        if (self.files.items.len < batch_size) return;
+        try self.flushAll(result, options, false);
+    }
+
+    /// Apply queued file records, then directories if `include_dirs`
+    fn flushAll(
+        self: *MetadataQueue,
+        result: *ExtractResult,
+        options: ExtractOptions,
+        include_dirs: bool,
+    ) !void {
+        {
+            defer {
+                for (self.files.items) |record| std.posix.close(record.fd);
+                self.files.clearRetainingCapacity();
+                self.file_paths.clearRetainingCapacity();
+                _ = self.file_data.reset(.retain_capacity);
+            }
+            try self.apply(self.files.items, self.file_paths.items, result, options);
+        }
+
+        if (!include_dirs) return;
+        defer {
+            self.dirs.clearRetainingCapacity();
+            self.dir_paths.clearRetainingCapacity();
+            _ = self.dir_data.reset(.retain_capacity);
+        }
+
+        // Deepest first, so a read-only parent is restricted last
+        std.mem.reverse(platform.MetadataRecord, self.dirs.items);
+        std.mem.reverse([]const u8, self.dir_paths.items);
+
+        var start: usize = 0;
+        while (start < self.dirs.items.len) : (start += batch_size) {
+            const end = @min(start + batch_size, self.dirs.items.len);
+            try self.applyDirs(self.dirs.items[start..end], self.dir_paths.items[start..end], result, options);
+        }
+    }
+
+    /// Open a chunk of directories and apply their records
+    fn applyDirs(
+        self: *MetadataQueue,
+        records: []platform.MetadataRecord,
+        paths: [][]const u8,
+        result: *ExtractResult,
+        options: ExtractOptions,
+    ) !void {
+        // Records whose directory opened are compacted to the front
+        var opened: usize = 0;
+        defer for (records[0..opened]) |record| std.posix.close(record.fd);
+
+        for (records, paths) |record, path| {
+            const fd = self.openDir(path) catch |err| {
+                try self.fail(path, err, result, options);
+                continue;
+            };
+            records[opened] = record;
+            records[opened].fd = fd;
+            paths[opened] = path;
+            opened += 1;
+        }
+        try self.apply(records[0..opened], paths[0..opened], result, options);
+    }
+
+    fn openDir(self: *MetadataQueue, path: []const u8) !std.posix.fd_t {
+        if (builtin.os.tag == .linux and self.contained) {
+            return linux.openBeneath(self.dir.fd, path, .{
+                .DIRECTORY = true,
+                .NOFOLLOW = true,
+                .CLOEXEC = true,
+            }, 0);
+        }
+        return platform.openForMetadata(self.dir, path);
+    }
+
+    fn apply(
+        self: *MetadataQueue,
+        records: []const platform.MetadataRecord,
+        paths: []const []const u8,
+        result: *ExtractResult,
+        options: ExtractOptions,
+    ) !void {
+        if (records.len == 0) return;
+
+        const span = instrument.begin(.metadata);
+        defer span.end();
+
+        const failures = try self.allocator.alloc(?anyerror, records.len);
+        defer self.allocator.free(failures);
+
+        const failed = platform.getPlatform().applyMetadata(records, failures);
+        instrument.count(.syscalls, records.len);
+        if (failed == 0) return;
+
+        for (paths, failures) |path, failure| {
+            try self.fail(path, failure orelse continue, result, options);
+        }
+    }
+
+    /// Count an entry whose metadata could not be applied as failed
+    fn fail(
+        self: *MetadataQueue,
+        path: []const u8,
+        err: anyerror,
+        result: *ExtractResult,
+        options: ExtractOptions,
+    ) !void {
+        if (!options.continue_on_error) return err;
+        // The entry was already counted as extracted
+        result.succeeded -= 1;
+        result.failed += 1;
+        try result.addWarning(self.allocator, path, err);
+    }
+};
+
+/// Entry paths seen so far, keyed by their ASCII lowercase form
+///
+/// Used only when the destination is case-insensitive. There `README`
+/// and `readme` name the same file, so the later entry would silently
+/// replace the earlier one; it is rejected instead. Repeating the exact
+/// same path is still allowed (tar appends updated copies of a member).
+const CaseFolds = struct {
+    allocator: std.mem.Allocator,
+    paths: std.StringHashMapUnmanaged([]const u8) = .empty,
+    data: std.heap.ArenaAllocator,
+
+    fn init(allocator: std.mem.Allocator) CaseFolds {
+        return .{
+            .allocator = allocator,
+            .data = std.heap.ArenaAllocator.init(allocator),
+        };
+    }
+
+    fn deinit(self: *CaseFolds) void {
+        self.paths.deinit(self.allocator);
+        self.data.deinit();
+    }
+
+    /// Record an entry path
+    ///
+    /// Errors:
+    ///   - CaseCollision: An earlier entry differs from `path` only in case
+    ///   - OutOfMemory: Allocation failed
+    fn add(self: *CaseFolds, path: []const u8) !void {
+        const arena = self.data.allocator();
+        const folded = std.ascii.lowerString(try arena.alloc(u8, path.len), path);
+
+        const slot = try self.paths.getOrPut(self.allocator, folded);
+        if (slot.found_existing) {
+            if (!std.mem.eql(u8, slot.value_ptr.*, path)) return error.CaseCollision;
+            return;
+        }
+        slot.value_ptr.* = try arena.dupe(u8, path);
+    }
+};
+
 /// Extract an archive to a destination directory
 ///
 /// This is the main extraction function that handles all archive formats
 /// through the ArchiveReader trait. It applies security checks, creates
 /// directories, extracts files, and handles errors according to the options.
 ///
+/// `reader` is a pointer to an ArchiveReader, or to a concrete reader
+/// (TarReader, TarGzReader, ZipReader, ...) with the same next()/read()
+/// methods. A concrete reader gets its own instantiation, so the per-chunk
+/// read in the copy loop is a direct, inlinable call instead of a vtable
+/// call returning anyerror (see `open.OpenedArchive`).
+///
 /// Security Features:
 ///   - Path validation (prevent traversal attacks)
 ///   - Zip bomb detection
 ///   - Symlink validation
 ///   - Size limits enforcement
+///   - Kernel-enforced containment via openat2(RESOLVE_BENEATH) on Linux
+///     5.6+, falling back to userland checks elsewhere
 ///
 /// Parameters:
 ///   - allocator: Memory allocator
-///   - reader: Archive reader (implements ArchiveReader trait)
+///   - reader: Pointer to an ArchiveReader or a concrete archive reader
 ///   - dest_path: Destination directory path
 ///   - options: Extraction options
 ///
@@ -199,32 +510,82 @@ pub const ExtractResult = struct {
 /// ```
 pub fn extractArchive(
     allocator: std.mem.Allocator,
-    reader: *archive.ArchiveReader,
+    reader: anytype,
     dest_path: []const u8,
     options: ExtractOptions,
 ) !ExtractResult {
-    var result = ExtractResult.init(allocator);
-    errdefer result.deinit(allocator);
-
     // Open destination directory
     var dest_dir = try std.fs.cwd().openDir(dest_path, .{});
     defer dest_dir.close();
 
+    return extractArchiveToDir(allocator, reader, dest_dir, options);
+}
+
+/// Extract an archive into an open directory
+///
+/// Same as `extractArchive`, for callers that already hold a directory
+/// handle (e.g. a dirfd passed through the C API). Every entry is
+/// created relative to `dest_dir`, which is not closed.
+///
+/// Parameters:
+///   - allocator: Memory allocator
+///   - reader: Pointer to an ArchiveReader or a concrete archive reader
+///   - dest_dir: Destination directory handle
+///   - options: Extraction options
+///
+/// Returns:
+///   - ExtractResult containing success/failure counts and warnings
+pub fn extractArchiveToDir(
+    allocator: std.mem.Allocator,
+    reader: anytype,
+    dest_dir: std.fs.Dir,
+    options: ExtractOptions,
+) !ExtractResult {
+    var result = ExtractResult.init(allocator);
+    errdefer result.deinit(allocator);
+
+    const kernel_contained = platform.getCapabilities().supports_resolve_beneath;
+    var metadata = MetadataQueue.init(allocator, dest_dir, kernel_contained);
+    defer metadata.deinit();
+
+    const caps = platform.probeDirectory(dest_dir, sourceFile(reader));
+    var case_folds = CaseFolds.init(allocator);
+    defer case_folds.deinit();
+
+    const dest = Destination{
+        .dir = dest_dir,
+        .kernel_contained = kernel_contained,
+        .metadata = &metadata,
+        .caps = caps,
+        .case_folds = if (caps.case_sensitive) null else &case_folds,
+    };
+
     // Initialize extraction tracker for cumulative size checks
     var tracker = security.ExtractionTracker.init(options.security_policy);
 
     // Extract each entry
     while (try reader.next()) |entry| {
+        if (options.filter) |filter| {
+            if (!try filter.matches(entry.path)) {
+                try skipEntryData(reader);
+                result.skipped += 1;
+                continue;
+            }
+        }
+
         if (options.verbose) {
             std.debug.print("Extracting: {s}\n", .{entry.path});
         }
 
+        const entry_timer = instrument.beginEntry(entry.path);
+        defer entry_timer.end();
+
         // Extract this entry
         extractEntry(
             allocator,
             reader,
             entry,
-            dest_dir,
+            dest,
             &tracker,
             options,
         ) catch |err| {
@@ -246,11 +607,152 @@ pub fn extractArchive(
 
         result.succeeded += 1;
         result.total_bytes += entry.size;
+
+        try metadata.flushFiles(&result, options);
     }
 
+    try metadata.flushAll(&result, options, true);
+
     return result;
 }
 
+/// Extraction target that consumes entries in place instead of on disk
+///
+/// Lets a service index, hash or upload the members of an archive it
+/// received in memory without touching the filesystem.
+pub const EntryVisitor = struct {
+    context: *anyopaque,
+
+    /// Called once per entry that passed validation. `entry.path` is the
+    /// sanitized path; unread data is skipped after the call returns.
+    visitFn: *const fn (context: *anyopaque, entry: types.Entry, data: *EntryData) anyerror!void,
+
+    /// Build a visitor from a typed context pointer
+    ///
+    /// Example:
+    /// ```zig
+    /// const visitor = EntryVisitor.init(&index, Index.add);
+    /// ```
+    pub fn init(
+        context: anytype,
+        comptime visitFn: fn (@TypeOf(context), types.Entry, *EntryData) anyerror!void,
+    ) EntryVisitor {
+        const Context = @TypeOf(context);
+        const Wrapper = struct {
+            fn visit(ptr: *anyopaque, entry: types.Entry, data: *EntryData) anyerror!void {
+                const typed: Context = @ptrCast(@alignCast(ptr));
+                return visitFn(typed, entry, data);
+            }
+        };
+        return .{ .context = context, .visitFn = Wrapper.visit };
+    }
+};
+
+/// Data of the entry being visited
+pub const EntryData = struct {
+    reader: *archive.ArchiveReader,
+
+    /// The whole payload when the archive is in memory (not copied)
+    borrowed: ?[]const u8,
+    borrowed_pos: usize = 0,
+
+    /// The payload as a slice of the archive buffer, or null when the
+    /// archive is streamed (use read())
+    pub fn slice(self: *const EntryData) ?[]const u8 {
+        return self.borrowed;
+    }
+
+    /// Read the payload in pieces (0 at its end); works for any archive
+    pub fn read(self: *EntryData, buffer: []u8) !usize {
+        const data = self.borrowed orelse return self.reader.read(buffer);
+        const n = @min(buffer.len, data.len - self.borrowed_pos);
+        @memcpy(buffer[0..n], data[self.borrowed_pos..][0..n]);
+        self.borrowed_pos += n;
+        return n;
+    }
+};
+
+/// Hand every entry of an archive to a visitor
+///
+/// Applies the same path validation, size limits and error handling as
+/// `extractArchiveToDir`, but nothing is written: each entry goes to
+/// `visitor` instead. With an in-memory reader (TarReader.initSlice) the
+/// entry data is a borrowed slice of the archive buffer.
+///
+/// Parameters:
+///   - allocator: Memory allocator (warnings only)
+///   - reader: Archive reader (implements ArchiveReader trait)
+///   - visitor: Consumer of the entries
+///   - options: Extraction options (filesystem flags are ignored)
+///
+/// Returns:
+///   - ExtractResult containing success/failure counts and warnings
+///
+/// Example:
+/// ```zig
+/// var tar_reader = TarReader.initSlice(allocator, body);
+/// defer tar_reader.deinit();
+/// var arch = tar_reader.archiveReader();
+///
+/// var result = try visitArchive(allocator, &arch, EntryVisitor.init(&hasher, Hasher.visit), .{});
+/// defer result.deinit(allocator);
+/// ```
+pub fn visitArchive(
+    allocator: std.mem.Allocator,
+    reader: *archive.ArchiveReader,
+    visitor: EntryVisitor,
+    options: ExtractOptions,
+) !ExtractResult {
+    var result = ExtractResult.init(allocator);
+    errdefer result.deinit(allocator);
+
+    var tracker = security.ExtractionTracker.init(options.security_policy);
+
+    while (try reader.next()) |entry| {
+        if (options.filter) |filter| {
+            if (!try filter.matches(entry.path)) {
+                result.skipped += 1;
+                continue;
+            }
+        }
+
+        visitEntry(reader, entry, visitor, &tracker, options) catch |err| {
+            result.failed += 1;
+
+            if (options.continue_on_error) {
+                try result.addWarning(allocator, entry.path, err);
+                continue;
+            }
+            return err;
+        };
+
+        result.succeeded += 1;
+        result.total_bytes += entry.size;
+    }
+
+    return result;
+}
+
+/// Validate one entry and pass it to the visitor
+fn visitEntry(
+    reader: *archive.ArchiveReader,
+    entry: types.Entry,
+    visitor: EntryVisitor,
+    tracker: *security.ExtractionTracker,
+    options: ExtractOptions,
+) !void {
+    var visited = entry;
+    visited.path = try security.sanitizePath(entry.path, options.security_policy);
+    try security.checkFileSize(entry.size, options.security_policy);
+    try tracker.addFile(entry.size);
+
+    var data = EntryData{
+        .reader = reader,
+        .borrowed = try reader.readSlice(),
+    };
+    try visitor.visitFn(visitor.context, visited, &data);
+}
+
 /// Extract a single entry from an archive
 ///
 /// Internal function that handles extraction of one entry (file, directory,
@@ -260,7 +762,7 @@ pub fn extractArchive(
 ///   - allocator: Memory allocator
 ///   - reader: Archive reader
 ///   - entry: Entry metadata to extract
-///   - dest_dir: Destination directory handle
+///   - dest: Destination directory and containment mode
 ///   - tracker: Extraction tracker for cumulative checks
 ///   - options: Extraction options
 ///
@@ -269,40 +771,43 @@ pub fn extractArchive(
 ///   - (All I/O errors)
 fn extractEntry(
     allocator: std.mem.Allocator,
-    reader: *archive.ArchiveReader,
+    reader: anytype,
     entry: types.Entry,
-    dest_dir: std.fs.Dir,
+    dest: Destination,
     tracker: *security.ExtractionTracker,
     options: ExtractOptions,
 ) !void {
     // Validate path for security
-    const validated_path = try security.sanitizePath(
-        entry.path,
-        options.security_policy,
-    );
+    const validated_path = blk: {
+        const span = instrument.begin(.path_validation);
+        defer span.end();
+        break :blk try security.sanitizePath(entry.path, options.security_policy);
+    };
 
-    // Check for zip bomb (individual file)
-    try security.checkZipBomb(
-        0, // We don't track compressed size per entry for tar
-        entry.size,
-        options.security_policy,
-    );
+    // Per-file size limit. Tar has no per-entry compressed size, so the
+    // compression ratio is enforced on the stream (RatioMonitor) instead.
+    try security.checkFileSize(entry.size, options.security_policy);
 
     // Track cumulative extraction size
     try tracker.addFile(entry.size);
 
+    // Directories that differ only in case merge harmlessly; anything
+    // else would overwrite an earlier entry
+    if (dest.case_folds) |folds| {
+        if (entry.entry_type != .directory) try folds.add(validated_path);
+    }
+
     // Extract based on entry type
     switch (entry.entry_type) {
         .directory => {
-            try extractDirectory(validated_path, entry, dest_dir, options);
+            try extractDirectory(validated_path, entry, dest, options);
         },
         .file => {
             try extractFile(
-                allocator,
                 reader,
                 entry,
                 validated_path,
-                dest_dir,
+                dest,
                 options,
             );
         },
@@ -311,12 +816,12 @@ fn extractEntry(
                 allocator,
                 entry,
                 validated_path,
-                dest_dir,
+                dest,
                 options,
             );
         },
         .hardlink => {
-            try extractHardlink(entry, validated_path, dest_dir, options);
+            try extractHardlink(entry, validated_path, dest, options);
         },
         else => {
             // Skip unsupported entry types (devices, fifos, etc.)
@@ -328,78 +833,120 @@ fn extractEntry(
     }
 }
 
+/// Whether archive permissions should be applied
+fn wantPermissions(options: ExtractOptions) bool {
+    return options.preserve_permissions and options.security_policy.preserve_permissions;
+}
+
+/// Whether any metadata is to be applied to the entry after creation
+fn wantMetadata(entry: types.Entry, options: ExtractOptions) bool {
+    return wantPermissions(options) or options.preserve_timestamps or
+        (options.preserve_xattrs and entry.xattr_records.len > 0);
+}
+
+/// Set xattrs on a just-created symlink through its parent descriptor
+fn applyLinkXattrs(
+    allocator: std.mem.Allocator,
+    parent_fd: std.posix.fd_t,
+    name: []const u8,
+    entry: types.Entry,
+    options: ExtractOptions,
+) !void {
+    if (!options.preserve_xattrs or entry.xattr_records.len == 0) return;
+
+    const span = instrument.begin(.metadata);
+    defer span.end();
+
+    var arena = std.heap.ArenaAllocator.init(allocator);
+    defer arena.deinit();
+    const xattrs = try pax.decodeXattrs(arena.allocator(), entry.xattr_records);
+
+    for (xattrs) |xattr| try linux.setLinkXattr(parent_fd, name, xattr.name, xattr.value);
+    instrument.count(.syscalls, xattrs.len);
+}
+
 /// Extract a directory entry
 fn extractDirectory(
     validated_path: []const u8,
     entry: types.Entry,
-    dest_dir: std.fs.Dir,
+    dest: Destination,
     options: ExtractOptions,
 ) !void {
-    // Create directory (makePath creates parent directories as needed)
-    try dest_dir.makePath(validated_path);
-
-    // Set permissions if requested
-    if (options.preserve_permissions and options.security_policy.preserve_permissions) {
-        // Get absolute path for platform-specific operations
-        const abs_path = try dest_dir.realpathAlloc(
-            std.heap.page_allocator,
-            validated_path,
-        );
-        defer std.heap.page_allocator.free(abs_path);
-
-        const plat = platform.getPlatform();
-        try plat.setFilePermissions(abs_path, entry.mode);
+    const dest_dir = dest.dir;
+
+    // Create directory (and any missing parents)
+    {
+        const span = instrument.begin(.file_create);
+        defer span.end();
+        if (dest.contained()) {
+            try linux.makePathBeneath(dest_dir.fd, validated_path);
+        } else {
+            try dest_dir.makePath(validated_path);
+        }
+        instrument.count(.syscalls, 1);
     }
 
-    // Set timestamp if requested
-    if (options.preserve_timestamps) {
-        const abs_path = try dest_dir.realpathAlloc(
-            std.heap.page_allocator,
-            validated_path,
-        );
-        defer std.heap.page_allocator.free(abs_path);
+    // Set permissions and timestamp once the whole tree is in place
+    try dest.metadata.pushDirectory(validated_path, entry, options);
+}
+
+/// Entries at least this large are preallocated with fallocate(2)
+const preallocate_threshold: u64 = 1024 * 1024;
 
-        const plat = platform.getPlatform();
-        try plat.setFileTime(abs_path, entry.mtime);
+/// Entries at least this large are copied with copy_file_range(2) when
+/// the reader and destination allow it
+const direct_copy_threshold: u64 = 64 * 1024;
+
+/// Archive file behind a concrete reader, for probing kernel-side copies
+fn sourceFile(reader: anytype) ?std.fs.File {
+    const Reader = std.meta.Child(@TypeOf(reader));
+    if (comptime !@hasDecl(Reader, "sourceFile")) return null;
+    return reader.sourceFile();
+}
+
+/// Skip the data of a filtered-out entry
+///
+/// Tar readers seek past it when the archive is a plain file; other
+/// readers skip it in next().
+fn skipEntryData(reader: anytype) !void {
+    const Reader = std.meta.Child(@TypeOf(reader));
+    if (comptime @hasDecl(Reader, "skipRemainingData")) {
+        try reader.skipRemainingData();
+    } else if (comptime @hasField(Reader, "tar_reader")) {
+        try reader.tar_reader.skipRemainingData();
     }
 }
 
-/// Extract a regular file entry
-fn extractFile(
-    allocator: std.mem.Allocator,
-    reader: *archive.ArchiveReader,
+/// Copy an entry's data from the archive into an open file
+///
+/// Uses the fastest path `caps` allows: large files are preallocated in
+/// one call, and readers that can hand data to the kernel directly
+/// (plain tar files) move it with copy_file_range(2) instead of a
+/// read/write loop.
+fn copyEntryData(
+    reader: anytype,
     entry: types.Entry,
     validated_path: []const u8,
-    dest_dir: std.fs.Dir,
-    options: ExtractOptions,
+    file: std.fs.File,
+    caps: platform.DirCapabilities,
 ) !void {
-    // Ensure parent directories exist
-    if (std.fs.path.dirname(validated_path)) |parent| {
-        if (parent.len > 0) {
-            try dest_dir.makePath(parent);
-        }
+    if (builtin.os.tag == .linux and caps.fallocate and entry.size >= preallocate_threshold) {
+        // Only a layout hint; a real shortage surfaces in the writes
+        linux.preallocate(file.handle, entry.size) catch {};
+        instrument.count(.syscalls, 1);
     }
 
-    // Determine file creation flags
-    const create_flags: std.fs.File.CreateFlags = .{
-        .exclusive = !options.overwrite, // Fail if exists unless overwrite=true
-        .truncate = options.overwrite,
-    };
-
-    // Create file
-    const file = dest_dir.createFile(validated_path, create_flags) catch |err| {
-        // Provide better error message for common case
-        if (err == error.PathAlreadyExists) {
-            std.log.err("File already exists: {s} (use --overwrite to replace)", .{
-                validated_path,
-            });
+    var bytes_written: u64 = 0;
+    if (comptime @hasDecl(std.meta.Child(@TypeOf(reader)), "copyTo")) {
+        if (caps.copy_file_range and entry.size >= direct_copy_threshold) {
+            const span = instrument.begin(.write);
+            defer span.end();
+            bytes_written = try reader.copyTo(file);
+            instrument.count(.bytes_written, bytes_written);
         }
-        return err;
-    };
-    defer file.close();
+    }
 
-    // Read and write data in chunks
-    var bytes_written: u64 = 0;
+    // Read and write the rest in chunks
     var buffer: [types.BufferSize.default]u8 = undefined;
 
     while (bytes_written < entry.size) {
@@ -418,7 +965,13 @@ fn extractFile(
             return error.IncompleteArchive;
         }
 
-        try file.writeAll(buffer[0..n]);
+        {
+            const span = instrument.begin(.write);
+            defer span.end();
+            try file.writeAll(buffer[0..n]);
+            instrument.count(.syscalls, 1);
+            instrument.count(.bytes_written, n);
+        }
         bytes_written += @as(u64, n);
     }
 
@@ -431,24 +984,100 @@ fn extractFile(
         });
         return error.IncompleteArchive;
     }
+}
+
+/// Extract a regular file entry
+fn extractFile(
+    reader: anytype,
+    entry: types.Entry,
+    validated_path: []const u8,
+    dest: Destination,
+    options: ExtractOptions,
+) !void {
+    const dest_dir = dest.dir;
+
+    if (dest.contained()) {
+        const create_span = instrument.begin(.file_create);
+        if (std.fs.path.dirname(validated_path)) |parent| {
+            linux.makePathBeneath(dest_dir.fd, parent) catch |err| {
+                create_span.end();
+                return err;
+            };
+        }
+
+        // O_NOFOLLOW: never write through a symlink planted at the final component
+        const fd = linux.openBeneath(dest_dir.fd, validated_path, .{
+            .ACCMODE = .WRONLY,
+            .CREAT = true,
+            .EXCL = !options.overwrite,
+            .TRUNC = options.overwrite,
+            .NOFOLLOW = true,
+            .CLOEXEC = true,
+        }, std.fs.File.default_mode) catch |err| {
+            create_span.end();
+            if (err == error.PathAlreadyExists) {
+                std.log.err("File already exists: {s} (use --overwrite to replace)", .{
+                    validated_path,
+                });
+            }
+            return err;
+        };
+        create_span.end();
+        instrument.count(.syscalls, 1);
+        const file = std.fs.File{ .handle = fd };
+
+        // The metadata batch takes the descriptor over and closes it
+        var queued = false;
+        defer if (!queued) file.close();
 
-    // Set permissions if requested
-    if (options.preserve_permissions and options.security_policy.preserve_permissions) {
-        const abs_path = try dest_dir.realpathAlloc(allocator, validated_path);
-        defer allocator.free(abs_path);
+        try copyEntryData(reader, entry, validated_path, file, dest.caps);
 
-        const plat = platform.getPlatform();
-        try plat.setFilePermissions(abs_path, entry.mode);
+        // Set permissions and timestamp through this descriptor in the next batch
+        queued = try dest.metadata.pushFile(validated_path, entry, file, options);
+        return;
     }
 
-    // Set timestamp if requested
-    if (options.preserve_timestamps) {
-        const abs_path = try dest_dir.realpathAlloc(allocator, validated_path);
-        defer allocator.free(abs_path);
+    const create_span = instrument.begin(.file_create);
 
-        const plat = platform.getPlatform();
-        try plat.setFileTime(abs_path, entry.mtime);
+    // Ensure parent directories exist
+    if (std.fs.path.dirname(validated_path)) |parent| {
+        if (parent.len > 0) {
+            dest_dir.makePath(parent) catch |err| {
+                create_span.end();
+                return err;
+            };
+        }
     }
+
+    // Determine file creation flags
+    const create_flags: std.fs.File.CreateFlags = .{
+        .exclusive = !options.overwrite, // Fail if exists unless overwrite=true
+        .truncate = options.overwrite,
+    };
+
+    // Create file
+    const file = dest_dir.createFile(validated_path, create_flags) catch |err| {
+        create_span.end();
+
+        // Provide better error message for common case
+        if (err == error.PathAlreadyExists) {
+            std.log.err("File already exists: {s} (use --overwrite to replace)", .{
+                validated_path,
+            });
+        }
+        return err;
+    };
+    create_span.end();
+    instrument.count(.syscalls, 1);
+
+    // The metadata batch takes the descriptor over and closes it
+    var queued = false;
+    defer if (!queued) file.close();
+
+    try copyEntryData(reader, entry, validated_path, file, dest.caps);
+
+    // Set permissions and timestamp through this descriptor in the next batch
+    queued = try dest.metadata.pushFile(validated_path, entry, file, options);
 }
 
 /// Extract a symbolic link entry
@@ -456,9 +1085,39 @@ fn extractSymlink(
     allocator: std.mem.Allocator,
     entry: types.Entry,
     validated_path: []const u8,
-    dest_dir: std.fs.Dir,
+    dest: Destination,
     options: ExtractOptions,
 ) !void {
+    const dest_dir = dest.dir;
+
+    if (dest.contained()) {
+        // Later opens through this link are confined by the kernel, so the
+        // policy check needs no realpath of the destination
+        try security.validateSymlinkLexical(
+            validated_path,
+            entry.link_target,
+            options.security_policy,
+        );
+
+        var parent = try linux.openParentBeneath(dest_dir.fd, validated_path, true);
+        defer parent.close();
+
+        {
+            const span = instrument.begin(.file_create);
+            defer span.end();
+
+            if (options.overwrite) {
+                std.posix.unlinkat(parent.fd, parent.name, 0) catch |e| {
+                    if (e != error.FileNotFound) return e;
+                };
+            }
+            try std.posix.symlinkat(entry.link_target, parent.fd, parent.name);
+            instrument.count(.syscalls, 1);
+        }
+        try applyLinkXattrs(allocator, parent.fd, parent.name, entry, options);
+        return;
+    }
+
     // Validate symlink target
     const dest_path_abs = try dest_dir.realpathAlloc(allocator, ".");
     defer allocator.free(dest_path_abs);
@@ -471,20 +1130,37 @@ fn extractSymlink(
         options.security_policy,
     );
 
-    // Ensure parent directories exist
-    if (std.fs.path.dirname(validated_path)) |parent| {
-        if (parent.len > 0) {
-            try dest_dir.makePath(parent);
+    {
+        const span = instrument.begin(.file_create);
+        defer span.end();
+
+        // Ensure parent directories exist
+        if (std.fs.path.dirname(validated_path)) |parent| {
+            if (parent.len > 0) {
+                try dest_dir.makePath(parent);
+            }
         }
+
+        // Create symlink (optionally overwrite)
+        if (options.overwrite) {
+            dest_dir.deleteFile(validated_path) catch |e| {
+                if (e != error.FileNotFound) return e;
+            };
+        }
+        try dest_dir.symLink(entry.link_target, validated_path, .{});
+        instrument.count(.syscalls, 1);
     }
 
-    // Create symlink (optionally overwrite)
-    if (options.overwrite) {
-        dest_dir.deleteFile(validated_path) catch |e| {
-            if (e != error.FileNotFound) return e;
-        };
+    if (builtin.os.tag == .linux and options.preserve_xattrs and entry.xattr_records.len > 0) {
+        const parent = std.fs.path.dirname(validated_path) orelse ".";
+        const parent_fd = try std.posix.openat(dest_dir.fd, parent, .{
+            .DIRECTORY = true,
+            .PATH = true,
+            .CLOEXEC = true,
+        }, 0);
+        defer std.posix.close(parent_fd);
+        try applyLinkXattrs(allocator, parent_fd, std.fs.path.basename(validated_path), entry, options);
     }
-    try dest_dir.symLink(entry.link_target, validated_path, .{});
 
     // Note: We don't set permissions on symlinks as they're typically
     // not meaningful (the target's permissions are what matter)
@@ -497,11 +1173,39 @@ fn extractSymlink(
 fn extractHardlink(
     entry: types.Entry,
     validated_path: []const u8,
-    dest_dir: std.fs.Dir,
+    dest: Destination,
     options: ExtractOptions,
 ) !void {
+    const dest_dir = dest.dir;
+
     // Validate link target path with configured policy
-    const validated_target = try security.sanitizePath(entry.link_target, options.security_policy);
+    const validated_target = blk: {
+        const span = instrument.begin(.path_validation);
+        defer span.end();
+        break :blk try security.sanitizePath(entry.link_target, options.security_policy);
+    };
+
+    const create_span = instrument.begin(.file_create);
+    defer create_span.end();
+
+    if (dest.contained()) {
+        // Both ends are resolved beneath the root, so neither can be
+        // redirected outside it by a symlinked parent directory
+        var target = try linux.openParentBeneath(dest_dir.fd, validated_target, false);
+        defer target.close();
+
+        var link = try linux.openParentBeneath(dest_dir.fd, validated_path, true);
+        defer link.close();
+
+        if (options.overwrite) {
+            std.posix.unlinkat(link.fd, link.name, 0) catch |e| {
+                if (e != error.FileNotFound) return e;
+            };
+        }
+        try std.posix.linkat(target.fd, target.name, link.fd, link.name, 0);
+        instrument.count(.syscalls, 1);
+        return;
+    }
 
     // Ensure parent directories exist
     if (std.fs.path.dirname(validated_path)) |parent| {
@@ -535,6 +1239,7 @@ fn extractHardlink(
     // Create hardlink using platform abstraction
     const plat = platform.getPlatform();
     try plat.createHardLink(abs_target, abs_link);
+    instrument.count(.syscalls, 1);
 }
 
 // Tests
@@ -573,6 +1278,18 @@ test "ExtractResult: add warning" {
     try std.testing.expectEqual(error.FileNotFound, result.warnings.items[0].err);
 }
 
+test "CaseFolds: names differing only in case collide" {
+    var folds = CaseFolds.init(std.testing.allocator);
+    defer folds.deinit();
+
+    try folds.add("docs/README");
+    try folds.add("docs/README"); // Updated copy of the same member
+    try folds.add("docs/notes.txt");
+
+    try std.testing.expectError(error.CaseCollision, folds.add("docs/readme"));
+    try std.testing.expectError(error.CaseCollision, folds.add("Docs/notes.txt"));
+}
+
 test "extractArchive: empty archive" {
     const allocator = std.testing.allocator;
 
@@ -690,3 +1407,354 @@ test "extractArchive: continue on error" {
     try std.testing.expectEqual(@as(usize, 1), result.failed);
     try std.testing.expectEqual(@as(usize, 1), result.warnings.items.len);
 }
+
+test "extractArchive: kernel containment blocks writes through symlinks" {
+    if (!platform.getCapabilities().supports_resolve_beneath) {
+        return error.SkipZigTest;
+    }
+
+    const allocator = std.testing.allocator;
+
+    // A symlink escaping the root, then a file written through it
+    const MockReader = struct {
+        call_count: usize = 0,
+
+        fn nextImpl(ptr: *anyopaque) anyerror!?types.Entry {
+            const self: *@This() = @ptrCast(@alignCast(ptr));
+            self.call_count += 1;
+
+            return switch (self.call_count) {
+                1 => types.Entry{
+                    .path = "up",
+                    .entry_type = .symlink,
+                    .size = 0,
+                    .mode = 0o777,
+                    .mtime = 0,
+                    .link_target = "..",
+                },
+                2 => types.Entry{
+                    .path = "up/zarc-escape.txt",
+                    .entry_type = .file,
+                    .size = 0,
+                    .mode = 0o644,
+                    .mtime = 0,
+                },
+                else => null,
+            };
+        }
+
+        fn readImpl(_: *anyopaque, _: []u8) anyerror!usize {
+            return 0;
+        }
+
+        fn deinitImpl(_: *anyopaque) void {}
+
+        fn archiveReader(self: *@This()) archive.ArchiveReader {
+            return .{
+                .ptr = self,
+                .vtable = &.{
+                    .next = nextImpl,
+                    .read = readImpl,
+                    .deinit = deinitImpl,
+                },
+            };
+        }
+    };
+
+    var mock = MockReader{};
+    var reader = mock.archiveReader();
+    defer reader.deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const dest_path = try tmp_dir.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(dest_path);
+
+    // Even with every userland symlink check disabled, the kernel refuses
+    const options = ExtractOptions{
+        .continue_on_error = true,
+        .security_policy = .{ .symlink_policy = .allow_all },
+    };
+
+    var result = try extractArchive(allocator, &reader, dest_path, options);
+    defer result.deinit(allocator);
+
+    try std.testing.expectEqual(@as(usize, 1), result.succeeded);
+    try std.testing.expectEqual(@as(usize, 1), result.failed);
+    try std.testing.expectEqual(error.PathTraversalAttempt, result.warnings.items[0].err);
+    try std.testing.expectError(error.FileNotFound, tmp_dir.dir.access("../zarc-escape.txt", .{}));
+}
+
+test "visitArchive: in-memory archive, borrowed data, no filesystem" {
+    const allocator = std.testing.allocator;
+    const memory = @import("../formats/tar/memory.zig");
+    const TarReader = @import("../formats/tar/reader.zig").TarReader;
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "a.txt", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 0 }, .data = "alpha" },
+        .{ .entry = .{ .path = "../escape", .entry_type = .file, .size = 4, .mode = 0o644, .mtime = 0 }, .data = "evil" },
+        .{ .entry = .{ .path = "b.txt", .entry_type = .file, .size = 4, .mode = 0o644, .mtime = 0 }, .data = "beta" },
+    });
+
+    const Collector = struct {
+        total: usize = 0,
+        last_path: [16]u8 = undefined,
+        borrowed: bool = true,
+
+        fn visit(self: *@This(), entry: types.Entry, data: *EntryData) anyerror!void {
+            const bytes = data.slice() orelse {
+                self.borrowed = false;
+                return;
+            };
+            self.total += bytes.len;
+            @memcpy(self.last_path[0..entry.path.len], entry.path);
+        }
+    };
+
+    var tar_reader = TarReader.initSlice(allocator, tar_data.items);
+    defer tar_reader.deinit();
+    var reader = tar_reader.archiveReader();
+
+    var collector = Collector{};
+    var result = try visitArchive(allocator, &reader, EntryVisitor.init(&collector, Collector.visit), .{
+        .continue_on_error = true,
+    });
+    defer result.deinit(allocator);
+
+    try std.testing.expect(collector.borrowed);
+    try std.testing.expectEqual(@as(usize, 9), collector.total);
+    try std.testing.expectEqualStrings("b.txt", collector.last_path[0..5]);
+    try std.testing.expectEqual(@as(usize, 2), result.succeeded);
+    try std.testing.expectEqual(@as(usize, 1), result.failed);
+    try std.testing.expectEqual(error.PathTraversalAttempt, result.warnings.items[0].err);
+}
+
+test "extractArchive: concrete reader without vtable" {
+    const allocator = std.testing.allocator;
+    const memory = @import("../formats/tar/memory.zig");
+    const TarReader = @import("../formats/tar/reader.zig").TarReader;
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "dir", .entry_type = .directory, .size = 0, .mode = 0o755, .mtime = 0 } },
+        .{ .entry = .{ .path = "dir/a.txt", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 0 }, .data = "alpha" },
+    });
+
+    var tar_reader = TarReader.initSlice(allocator, tar_data.items);
+    defer tar_reader.deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const dest_path = try tmp_dir.dir.realpathAlloc(allocator, ".");
+    defer allocator.free(dest_path);
+
+    var result = try extractArchive(allocator, &tar_reader, dest_path, .{});
+    defer result.deinit(allocator);
+
+    try std.testing.expectEqual(@as(usize, 2), result.succeeded);
+    try std.testing.expectEqual(@as(usize, 0), result.failed);
+
+    var buf: [16]u8 = undefined;
+    try std.testing.expectEqualStrings("alpha", try tmp_dir.dir.readFile("dir/a.txt", &buf));
+}
+
+test "extractArchive: PAX nanosecond mtime is restored" {
+    // Windows file times are 100 ns ticks and set from whole seconds
+    if (builtin.os.tag == .windows) return error.SkipZigTest;
+
+    const allocator = std.testing.allocator;
+    const memory = @import("../formats/tar/memory.zig");
+    const TarReader = @import("../formats/tar/reader.zig").TarReader;
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try pax.appendExtendedHeader(&tar_data, "30 mtime=1700000000.123456789\n");
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "a.txt", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 1700000000 }, .data = "alpha" },
+    });
+
+    var tar_reader = TarReader.initSlice(allocator, tar_data.items);
+    defer tar_reader.deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    var result = try extractArchiveToDir(allocator, &tar_reader, tmp_dir.dir, .{});
+    defer result.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 1), result.succeeded);
+
+    const stat = try tmp_dir.dir.statFile("a.txt");
+    try std.testing.expectEqual(@as(i128, 1700000000123456789), stat.mtime);
+}
+
+test "extractArchive: directory metadata survives its children" {
+    if (builtin.os.tag == .windows) return error.SkipZigTest;
+
+    const allocator = std.testing.allocator;
+    const memory = @import("../formats/tar/memory.zig");
+    const TarReader = @import("../formats/tar/reader.zig").TarReader;
+
+    // A read-only directory listed before its contents
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "d", .entry_type = .directory, .size = 0, .mode = 0o555, .mtime = 1600000000 }, .data = "" },
+        .{ .entry = .{ .path = "d/a.txt", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 1700000000 }, .data = "alpha" },
+    });
+
+    var tar_reader = TarReader.initSlice(allocator, tar_data.items);
+    defer tar_reader.deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    // Let cleanup delete the child again
+    defer std.posix.fchmodat(tmp_dir.dir.fd, "d", 0o755, 0) catch {};
+
+    var result = try extractArchiveToDir(allocator, &tar_reader, tmp_dir.dir, .{
+        .preserve_permissions = true,
+        .security_policy = .{ .preserve_permissions = true },
+    });
+    defer result.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 2), result.succeeded);
+
+    const stat = try tmp_dir.dir.statFile("d");
+    try std.testing.expectEqual(@as(u32, 0o555), @as(u32, @intCast(stat.mode & 0o7777)));
+    try std.testing.expectEqual(@as(i128, 1600000000) * std.time.ns_per_s, stat.mtime);
+}
+
+test "extractArchive: PAX xattrs are restored on Linux" {
+    if (builtin.os.tag != .linux) return error.SkipZigTest;
+
+    const allocator = std.testing.allocator;
+    const memory = @import("../formats/tar/memory.zig");
+    const TarReader = @import("../formats/tar/reader.zig").TarReader;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    // Skip on filesystems without user.* xattrs
+    {
+        const probe = try tmp_dir.dir.createFile("probe", .{});
+        defer probe.close();
+        linux.setFdXattr(probe.handle, "user.probe", "1") catch return error.SkipZigTest;
+    }
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try pax.appendExtendedHeader(&tar_data, "42 SCHILY.xattr.user.mime_type=text/plain\n");
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "a.txt", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 1700000000 }, .data = "alpha" },
+    });
+
+    var tar_reader = TarReader.initSlice(allocator, tar_data.items);
+    defer tar_reader.deinit();
+
+    var result = try extractArchiveToDir(allocator, &tar_reader, tmp_dir.dir, .{ .preserve_xattrs = true });
+    defer result.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 1), result.succeeded);
+
+    const file = try tmp_dir.dir.openFile("a.txt", .{});
+    defer file.close();
+    var value: [32]u8 = undefined;
+    const rc = std.os.linux.syscall4(
+        .fgetxattr,
+        @as(usize, @bitCast(@as(isize, file.handle))),
+        @intFromPtr("user.mime_type"),
+        @intFromPtr(&value),
+        value.len,
+    );
+    try std.testing.expectEqual(std.posix.E.SUCCESS, std.posix.errno(rc));
+    try std.testing.expectEqualStrings("text/plain", value[0..rc]);
+}
+
+test "extractArchive: xattrs are restored on files without read permission" {
+    if (builtin.os.tag != .linux) return error.SkipZigTest;
+
+    const allocator = std.testing.allocator;
+    const memory = @import("../formats/tar/memory.zig");
+    const TarReader = @import("../formats/tar/reader.zig").TarReader;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    // Skip on filesystems without user.* xattrs
+    {
+        const probe = try tmp_dir.dir.createFile("probe", .{});
+        defer probe.close();
+        linux.setFdXattr(probe.handle, "user.probe", "1") catch return error.SkipZigTest;
+    }
+
+    // No access at all: reopening the file to set the attribute would fail
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try pax.appendExtendedHeader(&tar_data, "42 SCHILY.xattr.user.mime_type=text/plain\n");
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "a.txt", .entry_type = .file, .size = 5, .mode = 0o000, .mtime = 1700000000 }, .data = "alpha" },
+    });
+
+    var tar_reader = TarReader.initSlice(allocator, tar_data.items);
+    defer tar_reader.deinit();
+
+    var result = try extractArchiveToDir(allocator, &tar_reader, tmp_dir.dir, .{
+        .preserve_permissions = true,
+        .preserve_xattrs = true,
+        .security_policy = .{ .preserve_permissions = true },
+    });
+    defer result.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 1), result.succeeded);
+
+    const stat = try tmp_dir.dir.statFile("a.txt");
+    try std.testing.expectEqual(@as(u32, 0), @as(u32, @intCast(stat.mode & 0o7777)));
+
+    // getxattr(2) by path needs no permission on the file itself
+    var path_buf: [64]u8 = undefined;
+    const path = try std.fmt.bufPrintZ(&path_buf, "/proc/self/fd/{d}/a.txt", .{tmp_dir.dir.fd});
+    var value: [32]u8 = undefined;
+    const rc = std.os.linux.syscall4(
+        .getxattr,
+        @intFromPtr(path.ptr),
+        @intFromPtr("user.mime_type"),
+        @intFromPtr(&value),
+        value.len,
+    );
+    try std.testing.expectEqual(std.posix.E.SUCCESS, std.posix.errno(rc));
+    try std.testing.expectEqualStrings("text/plain", value[0..rc]);
+}
+
+test "extractArchive: filter skips rejected entries" {
+    const allocator = std.testing.allocator;
+    const memory = @import("../formats/tar/memory.zig");
+    const TarReader = @import("../formats/tar/reader.zig").TarReader;
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "src/main.c", .entry_type = .file, .size = 4, .mode = 0o644, .mtime = 0 }, .data = "main" },
+        .{ .entry = .{ .path = "src/main.o", .entry_type = .file, .size = 3, .mode = 0o644, .mtime = 0 }, .data = "obj" },
+        .{ .entry = .{ .path = "docs/guide.md", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 0 }, .data = "guide" },
+    });
+
+    var tar_reader = TarReader.initSlice(allocator, tar_data.items);
+    defer tar_reader.deinit();
+
+    var filter = try path_filter.PathFilter.init(allocator, &.{"src"}, &.{"*.o"});
+    defer filter.deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    var result = try extractArchiveToDir(allocator, &tar_reader, tmp_dir.dir, .{ .filter = &filter });
+    defer result.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 1), result.succeeded);
+    try std.testing.expectEqual(@as(usize, 2), result.skipped);
+
+    var buf: [8]u8 = undefined;
+    try std.testing.expectEqualStrings("main", try tmp_dir.dir.readFile("src/main.c", &buf));
+    try std.testing.expectError(error.FileNotFound, tmp_dir.dir.access("src/main.o", .{}));
+    try std.testing.expectError(error.FileNotFound, tmp_dir.dir.access("docs", .{}));
+}
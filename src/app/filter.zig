@@ -0,0 +1,485 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Include/exclude path filter for selective extraction
+//!
+//! All patterns are compiled once. Patterns without wildcards (the usual
+//! case for long file lists) go into hash sets; the globs are merged into
+//! a single NFA that is run as a lazily built DFA. Each entry path is then
+//! tested against every pattern in one pass over its bytes, and once the
+//! transition cache is warm that pass is one table lookup per byte.
+//!
+//! Pattern syntax (tar-style):
+//!   - `*` matches within one path component, `?` one character, and
+//!     `[abc]`, `[a-z]`, `[!a-z]` one character of a set
+//!   - `**` matches across components; `**/` zero or more directories
+//!   - `\` escapes the next character
+//!   - A pattern without '/' matches any component ("*.o", "node_modules");
+//!     a pattern with '/' is anchored at the archive root
+//!   - A pattern matching a directory also matches everything below it
+//!   - Leading "./" or "/" and trailing "/" are ignored
+
+const std = @import("std");
+
+/// Compiled include and exclude patterns
+///
+/// Matching fills a transition cache, so a filter must not be shared
+/// between threads.
+///
+/// Example:
+/// ```zig
+/// var filter = try PathFilter.init(allocator, &.{"src/**"}, &.{"*.o"});
+/// defer filter.deinit();
+///
+/// if (try filter.matches(entry.path)) { ... }
+/// ```
+pub const PathFilter = struct {
+    include: PatternSet,
+    exclude: PatternSet,
+
+    /// Compile the patterns
+    ///
+    /// Parameters:
+    ///   - allocator: Memory allocator
+    ///   - include_patterns: Entries to select (empty selects everything)
+    ///   - exclude_patterns: Entries to leave out, even if included
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Allocation failed
+    pub fn init(
+        allocator: std.mem.Allocator,
+        include_patterns: []const []const u8,
+        exclude_patterns: []const []const u8,
+    ) !PathFilter {
+        var include = try PatternSet.init(allocator, include_patterns);
+        errdefer include.deinit();
+        const exclude = try PatternSet.init(allocator, exclude_patterns);
+        return .{ .include = include, .exclude = exclude };
+    }
+
+    pub fn deinit(self: *PathFilter) void {
+        self.include.deinit();
+        self.exclude.deinit();
+    }
+
+    /// Whether the entry is selected: it matches an include pattern (or
+    /// there are none) and no exclude pattern
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Growing the transition cache failed
+    pub fn matches(self: *PathFilter, path: []const u8) !bool {
+        const normalized = normalize(path);
+        if (!self.include.isEmpty() and !try self.include.matches(normalized)) return false;
+        return !try self.exclude.matches(normalized);
+    }
+};
+
+/// Strip leading "./" and "/" and trailing "/"
+pub fn normalize(path: []const u8) []const u8 {
+    var p = path;
+    while (true) {
+        if (std.mem.startsWith(u8, p, "./")) {
+            p = p[2..];
+        } else if (std.mem.startsWith(u8, p, "/")) {
+            p = p[1..];
+        } else break;
+    }
+    while (p.len > 0 and p[p.len - 1] == '/') p = p[0 .. p.len - 1];
+    return if (std.mem.eql(u8, p, ".")) "" else p;
+}
+
+/// NFA instruction; each glob is a run of tokens ending in `accept`
+const Token = union(enum) {
+    byte: u8,
+    /// `?`
+    any,
+    /// `[...]`, index into `classes`
+    class: u32,
+    /// `*`
+    star,
+    /// `**` not followed by '/'
+    any_string,
+    /// `**/` (and the implicit prefix of unanchored patterns): entered
+    /// by epsilon, then loops in `dirs_loop` until a '/' is consumed
+    dirs_enter,
+    dirs_loop,
+    accept,
+};
+
+const CharSet = std.StaticBitSet(256);
+
+/// Cached DFA state: a sorted set of NFA positions
+const State = struct {
+    positions: []const u32,
+    accepting: bool,
+    next: [256]u32,
+};
+
+const unknown_state = std.math.maxInt(u32);
+const dead_state: u32 = 0;
+
+/// Transition cache bound (about 1 KiB per state); it is flushed and
+/// rebuilt from scratch when full
+const max_states = 2048;
+
+/// One side (include or exclude) of a filter
+const PatternSet = struct {
+    allocator: std.mem.Allocator,
+
+    /// Copies of the literal patterns
+    strings: std.heap.ArenaAllocator,
+
+    /// Wildcard-free patterns containing '/': the path or an ancestor
+    paths: std.StringHashMapUnmanaged(void) = .{},
+
+    /// Wildcard-free patterns without '/': any component of the path
+    names: std.StringHashMapUnmanaged(void) = .{},
+
+    tokens: std.ArrayListUnmanaged(Token) = .{},
+    classes: std.ArrayListUnmanaged(CharSet) = .{},
+
+    /// Epsilon closure of every glob's first token
+    start_set: std.ArrayListUnmanaged(u32) = .{},
+
+    states: std.ArrayListUnmanaged(State) = .{},
+    state_ids: std.StringHashMapUnmanaged(u32) = .{},
+    state_positions: std.heap.ArenaAllocator,
+    start: u32 = dead_state,
+    scratch: std.ArrayListUnmanaged(u32) = .{},
+
+    fn init(allocator: std.mem.Allocator, patterns: []const []const u8) !PatternSet {
+        var self = PatternSet{
+            .allocator = allocator,
+            .strings = std.heap.ArenaAllocator.init(allocator),
+            .state_positions = std.heap.ArenaAllocator.init(allocator),
+        };
+        errdefer self.deinit();
+
+        for (patterns) |raw| {
+            const pattern = normalize(raw);
+            if (pattern.len == 0) continue;
+
+            if (std.mem.indexOfAny(u8, pattern, "*?[\\") == null) {
+                const set = if (std.mem.indexOfScalar(u8, pattern, '/') == null) &self.names else &self.paths;
+                try set.put(allocator, try self.strings.allocator().dupe(u8, pattern), {});
+            } else {
+                const first: u32 = @intCast(self.tokens.items.len);
+                try self.compileGlob(pattern);
+                try self.addClosure(&self.start_set, first);
+            }
+        }
+
+        if (self.tokens.items.len > 0) {
+            std.mem.sort(u32, self.start_set.items, {}, std.sort.asc(u32));
+            self.start_set.shrinkRetainingCapacity(dedupSorted(self.start_set.items).len);
+            try self.resetCache();
+        }
+        return self;
+    }
+
+    fn deinit(self: *PatternSet) void {
+        self.strings.deinit();
+        self.paths.deinit(self.allocator);
+        self.names.deinit(self.allocator);
+        self.tokens.deinit(self.allocator);
+        self.classes.deinit(self.allocator);
+        self.start_set.deinit(self.allocator);
+        self.states.deinit(self.allocator);
+        self.state_ids.deinit(self.allocator);
+        self.state_positions.deinit();
+        self.scratch.deinit(self.allocator);
+    }
+
+    fn isEmpty(self: *const PatternSet) bool {
+        return self.paths.count() == 0 and self.names.count() == 0 and self.tokens.items.len == 0;
+    }
+
+    fn matches(self: *PatternSet, path: []const u8) !bool {
+        if (self.paths.count() > 0) {
+            if (self.paths.contains(path)) return true;
+            var i: usize = 0;
+            while (std.mem.indexOfScalarPos(u8, path, i, '/')) |slash| : (i = slash + 1) {
+                if (self.paths.contains(path[0..slash])) return true;
+            }
+        }
+        if (self.names.count() > 0) {
+            var components = std.mem.splitScalar(u8, path, '/');
+            while (components.next()) |name| {
+                if (self.names.contains(name)) return true;
+            }
+        }
+        if (self.states.items.len == 0) return false;
+
+        var state = self.start;
+        for (path) |c| {
+            // A match on a directory covers everything below it
+            if (c == '/' and self.states.items[state].accepting) return true;
+            state = try self.step(state, c);
+            if (state == dead_state) return false;
+        }
+        return self.states.items[state].accepting;
+    }
+
+    fn compileGlob(self: *PatternSet, pattern: []const u8) !void {
+        // Unanchored patterns may start at any component
+        if (std.mem.indexOfScalar(u8, pattern, '/') == null) {
+            try self.tokens.appendSlice(self.allocator, &[_]Token{ .dirs_enter, .dirs_loop });
+        }
+
+        var i: usize = 0;
+        while (i < pattern.len) {
+            switch (pattern[i]) {
+                '*' => {
+                    if (i + 1 < pattern.len and pattern[i + 1] == '*') {
+                        const segment_start = i == 0 or pattern[i - 1] == '/';
+                        while (i < pattern.len and pattern[i] == '*') i += 1;
+                        if (segment_start and i < pattern.len and pattern[i] == '/') {
+                            try self.tokens.appendSlice(self.allocator, &[_]Token{ .dirs_enter, .dirs_loop });
+                            i += 1;
+                        } else {
+                            try self.tokens.append(self.allocator, .any_string);
+                        }
+                    } else {
+                        try self.tokens.append(self.allocator, .star);
+                        i += 1;
+                    }
+                },
+                '?' => {
+                    try self.tokens.append(self.allocator, .any);
+                    i += 1;
+                },
+                '[' => {
+                    if (try self.compileClass(pattern, i)) |end| {
+                        i = end;
+                    } else {
+                        // Unterminated: a literal '['
+                        try self.tokens.append(self.allocator, .{ .byte = '[' });
+                        i += 1;
+                    }
+                },
+                '\\' => {
+                    const escaped = if (i + 1 < pattern.len) pattern[i + 1] else '\\';
+                    try self.tokens.append(self.allocator, .{ .byte = escaped });
+                    i += 2;
+                },
+                else => |c| {
+                    try self.tokens.append(self.allocator, .{ .byte = c });
+                    i += 1;
+                },
+            }
+        }
+        try self.tokens.append(self.allocator, .accept);
+    }
+
+    /// Compile the class opening at `open`; returns the index past its
+    /// ']', or null if it is not terminated
+    fn compileClass(self: *PatternSet, pattern: []const u8, open: usize) !?usize {
+        var set = CharSet.initEmpty();
+        var i = open + 1;
+        const negate = i < pattern.len and (pattern[i] == '!' or pattern[i] == '^');
+        if (negate) i += 1;
+        const first = i;
+
+        while (i < pattern.len) {
+            const lo = pattern[i];
+            // ']' right after the opening is a member
+            if (lo == ']' and i > first) break;
+            if (i + 2 < pattern.len and pattern[i + 1] == '-' and pattern[i + 2] != ']') {
+                const hi = pattern[i + 2];
+                var c: usize = lo;
+                while (c <= hi) : (c += 1) set.set(c);
+                i += 3;
+            } else {
+                set.set(lo);
+                i += 1;
+            }
+        } else return null;
+
+        if (negate) set.toggleAll();
+        try self.classes.append(self.allocator, set);
+        try self.tokens.append(self.allocator, .{ .class = @intCast(self.classes.items.len - 1) });
+        return i + 1;
+    }
+
+    /// Add `position` and everything reachable from it without input
+    fn addClosure(self: *PatternSet, out: *std.ArrayListUnmanaged(u32), position: u32) !void {
+        var p = position;
+        while (true) {
+            try out.append(self.allocator, p);
+            switch (self.tokens.items[p]) {
+                .star, .any_string => p += 1,
+                .dirs_enter => p += 2,
+                else => return,
+            }
+        }
+    }
+
+    /// Add the positions reached from `p` by consuming `c`
+    fn advance(self: *PatternSet, out: *std.ArrayListUnmanaged(u32), p: u32, c: u8) !void {
+        switch (self.tokens.items[p]) {
+            .byte => |b| if (c == b) try self.addClosure(out, p + 1),
+            .any => if (c != '/') try self.addClosure(out, p + 1),
+            .class => |index| if (c != '/' and self.classes.items[index].isSet(c)) try self.addClosure(out, p + 1),
+            .star => if (c != '/') try self.addClosure(out, p),
+            .any_string => try self.addClosure(out, p),
+            .dirs_enter => try self.advanceDirs(out, p + 1, c),
+            .dirs_loop => try self.advanceDirs(out, p, c),
+            .accept => {},
+        }
+    }
+
+    fn advanceDirs(self: *PatternSet, out: *std.ArrayListUnmanaged(u32), loop: u32, c: u8) !void {
+        try out.append(self.allocator, loop);
+        if (c == '/') try self.addClosure(out, loop + 1);
+    }
+
+    fn step(self: *PatternSet, state: u32, c: u8) !u32 {
+        const cached = self.states.items[state].next[c];
+        if (cached != unknown_state) return cached;
+
+        self.scratch.clearRetainingCapacity();
+        for (self.states.items[state].positions) |p| try self.advance(&self.scratch, p, c);
+        std.mem.sort(u32, self.scratch.items, {}, std.sort.asc(u32));
+        const positions = dedupSorted(self.scratch.items);
+
+        // `state` does not survive a flush, so its transition is not cached
+        const flushed = self.states.items.len >= max_states;
+        if (flushed) try self.resetCache();
+        const next = try self.intern(positions);
+        if (!flushed) self.states.items[state].next[c] = next;
+        return next;
+    }
+
+    fn resetCache(self: *PatternSet) !void {
+        self.states.clearRetainingCapacity();
+        self.state_ids.clearRetainingCapacity();
+        _ = self.state_positions.reset(.retain_capacity);
+        _ = try self.intern(&.{}); // dead_state
+        self.start = try self.intern(self.start_set.items);
+    }
+
+    fn intern(self: *PatternSet, positions: []const u32) !u32 {
+        if (self.state_ids.get(std.mem.sliceAsBytes(positions))) |id| return id;
+
+        const owned = try self.state_positions.allocator().dupe(u32, positions);
+        var accepting = false;
+        for (owned) |p| {
+            if (std.meta.activeTag(self.tokens.items[p]) == .accept) accepting = true;
+        }
+
+        const id: u32 = @intCast(self.states.items.len);
+        try self.states.append(self.allocator, .{
+            .positions = owned,
+            .accepting = accepting,
+            .next = [_]u32{unknown_state} ** 256,
+        });
+        try self.state_ids.put(self.allocator, std.mem.sliceAsBytes(owned), id);
+        return id;
+    }
+};
+
+fn dedupSorted(items: []u32) []u32 {
+    if (items.len == 0) return items;
+    var n: usize = 1;
+    for (items[1..]) |p| {
+        if (p != items[n - 1]) {
+            items[n] = p;
+            n += 1;
+        }
+    }
+    return items[0..n];
+}
+
+// Tests
+
+fn expectSelected(filter: *PathFilter, path: []const u8, expected: bool) !void {
+    try std.testing.expectEqual(expected, try filter.matches(path));
+}
+
+test "PathFilter: literal paths and names" {
+    var filter = try PathFilter.init(std.testing.allocator, &.{ "./src/main.zig", "docs/", "README.md" }, &.{});
+    defer filter.deinit();
+
+    try expectSelected(&filter, "src/main.zig", true);
+    try expectSelected(&filter, "src/main.zig.orig", false);
+    try expectSelected(&filter, "docs", true);
+    try expectSelected(&filter, "docs/guide/intro.md", true);
+    try expectSelected(&filter, "docsx/intro.md", false);
+    try expectSelected(&filter, "README.md", true);
+    try expectSelected(&filter, "pkg/README.md", true);
+    try expectSelected(&filter, "src/other.zig", false);
+}
+
+test "PathFilter: glob syntax" {
+    var filter = try PathFilter.init(
+        std.testing.allocator,
+        &.{ "src/*.zig", "*.[ch]", "test/**/data?.bin", "build/**", "lit\\*eral" },
+        &.{},
+    );
+    defer filter.deinit();
+
+    // '*' stays within a component
+    try expectSelected(&filter, "src/main.zig", true);
+    try expectSelected(&filter, "src/app/extract.zig", false);
+    // Unanchored, any component
+    try expectSelected(&filter, "lib/zlib/inflate.c", true);
+    try expectSelected(&filter, "include/zarc.h", true);
+    try expectSelected(&filter, "notes.cpp", false);
+    // '**/' matches zero or more directories
+    try expectSelected(&filter, "test/data1.bin", true);
+    try expectSelected(&filter, "test/a/b/data2.bin", true);
+    try expectSelected(&filter, "test/a/data10.bin", false);
+    try expectSelected(&filter, "build/x/y", true);
+    try expectSelected(&filter, "build", false);
+    try expectSelected(&filter, "lit*eral", true);
+    try expectSelected(&filter, "litxeral", false);
+}
+
+test "PathFilter: excludes override includes" {
+    var filter = try PathFilter.init(std.testing.allocator, &.{"src"}, &.{ "*.o", "[!a-z]*" });
+    defer filter.deinit();
+
+    try expectSelected(&filter, "src/main.c", true);
+    try expectSelected(&filter, "src/main.o", false);
+    try expectSelected(&filter, "src/obj.o/keep.c", false);
+    try expectSelected(&filter, "src/Makefile", false);
+    try expectSelected(&filter, "lib/main.c", false);
+
+    var everything = try PathFilter.init(std.testing.allocator, &.{}, &.{});
+    defer everything.deinit();
+    try expectSelected(&everything, "any/path", true);
+}
+
+test "PathFilter: many patterns survive cache flushes" {
+    const allocator = std.testing.allocator;
+
+    var arena = std.heap.ArenaAllocator.init(allocator);
+    defer arena.deinit();
+    var patterns = std.ArrayList([]const u8).init(allocator);
+    defer patterns.deinit();
+    for (0..5000) |i| {
+        try patterns.append(try std.fmt.allocPrint(arena.allocator(), "dir{d}/*.txt", .{i}));
+    }
+
+    var filter = try PathFilter.init(allocator, patterns.items, &.{});
+    defer filter.deinit();
+
+    var buf: [64]u8 = undefined;
+    for (0..10000) |i| {
+        const path = try std.fmt.bufPrint(&buf, "dir{d}/f.txt", .{i});
+        try expectSelected(&filter, path, i < 5000);
+    }
+    try expectSelected(&filter, "dir42/sub/f.txt", false);
+}
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+const std = @import("std");
+const types = @import("../core/types.zig");
+const util = @import("../core/util.zig");
+const archive = @import("../formats/archive.zig");
+
+/// Output format for archive listings
+pub const ListFormat = enum {
+    /// One path per line
+    names,
+
+    /// `ls -l` style columns: mode, owner, group, size, mtime, path
+    long,
+
+    /// JSON array with one object per entry
+    json,
+
+    /// Paths terminated by NUL bytes (for `xargs -0`)
+    null_delimited,
+};
+
+/// Options for archive listing
+pub const ListOptions = struct {
+    /// Output format
+    /// Default: names
+    format: ListFormat = .names,
+
+    /// Show sizes as "1.5 KB" instead of bytes (long format only)
+    /// Default: false
+    human_readable: bool = false,
+};
+
+/// Result of a listing operation
+pub const ListResult = struct {
+    /// Number of entries listed
+    entries: u64 = 0,
+
+    /// Sum of entry sizes in bytes
+    total_size: u64 = 0,
+};
+
+/// List archive entries
+///
+/// Only headers are examined: entry data is skipped by the reader (seeked
+/// over for plain tar files). Every line is formatted into `writer`
+/// without allocating, so callers should pass a buffered writer.
+///
+/// Parameters:
+///   - archive_reader: Pointer to an ArchiveReader or a concrete archive
+///     reader (instantiated per reader type, without vtable calls)
+///   - writer: Destination for the listing
+///   - options: Output format options
+///
+/// Returns:
+///   - Number of entries and their total size
+///
+/// Errors:
+///   - Any error from the archive reader or writer
+///
+/// Example:
+/// ```zig
+/// var buffered = std.io.bufferedWriter(std.io.getStdOut().writer());
+/// _ = try listArchive(&archive_reader, buffered.writer(), .{ .format = .long });
+/// try buffered.flush();
+/// ```
+pub fn listArchive(
+    archive_reader: anytype,
+    writer: anytype,
+    options: ListOptions,
+) !ListResult {
+    var result = ListResult{};
+
+    if (options.format == .json) try writer.writeAll("[");
+
+    while (try archive_reader.next()) |entry| {
+        try writeEntry(writer, entry, options, result.entries == 0);
+        result.entries += 1;
+        result.total_size += entry.size;
+    }
+
+    if (options.format == .json) {
+        try writer.writeAll(if (result.entries == 0) "]\n" else "\n]\n");
+    }
+
+    return result;
+}
+
+/// Write one entry in the requested format
+fn writeEntry(writer: anytype, entry: types.Entry, options: ListOptions, first: bool) !void {
+    switch (options.format) {
+        .names => {
+            try writer.writeAll(entry.path);
+            try writer.writeByte('\n');
+        },
+        .null_delimited => {
+            try writer.writeAll(entry.path);
+            try writer.writeByte(0);
+        },
+        .long => try writeLong(writer, entry, options.human_readable),
+        .json => try writeJson(writer, entry, first),
+    }
+}
+
+/// Write an `ls -l` style line
+fn writeLong(writer: anytype, entry: types.Entry, human_readable: bool) !void {
+    var mode_buf: [10]u8 = undefined;
+    var time_buf: [util.timestamp_len]u8 = undefined;
+    var size_buf: [util.max_size_len]u8 = undefined;
+    var uid_buf: [10]u8 = undefined;
+    var gid_buf: [10]u8 = undefined;
+
+    // Names are optional in tar headers; fall back to numeric IDs
+    const owner = if (entry.uname.len > 0)
+        entry.uname
+    else
+        std.fmt.bufPrint(&uid_buf, "{d}", .{entry.uid}) catch unreachable;
+    const group = if (entry.gname.len > 0)
+        entry.gname
+    else
+        std.fmt.bufPrint(&gid_buf, "{d}", .{entry.gid}) catch unreachable;
+
+    const size = if (human_readable)
+        util.formatSizeBuf(&size_buf, entry.size)
+    else
+        std.fmt.bufPrint(&size_buf, "{d}", .{entry.size}) catch unreachable;
+
+    // Drop seconds, as ls and tar -tv do
+    const mtime = util.formatTimestampBuf(&time_buf, entry.mtime)[0.."YYYY-MM-DD HH:MM".len];
+
+    try writer.print("{s}  {s:<8} {s:<8} {s:>10}  {s}  {s}", .{
+        util.formatMode(&mode_buf, entry.entry_type, entry.mode),
+        owner,
+        group,
+        size,
+        mtime,
+        entry.path,
+    });
+
+    switch (entry.entry_type) {
+        .symlink => try writer.print(" -> {s}", .{entry.link_target}),
+        .hardlink => try writer.print(" link to {s}", .{entry.link_target}),
+        else => {},
+    }
+    try writer.writeByte('\n');
+}
+
+/// Write one JSON object (array separators included)
+fn writeJson(writer: anytype, entry: types.Entry, first: bool) !void {
+    try writer.writeAll(if (first) "\n{\"path\":" else ",\n{\"path\":");
+    try std.json.encodeJsonString(entry.path, .{}, writer);
+    try writer.print(
+        ",\"type\":\"{s}\",\"size\":{d},\"mode\":{d},\"mtime\":{d},\"uid\":{d},\"gid\":{d}",
+        .{ @tagName(entry.entry_type), entry.size, entry.mode, entry.mtime, entry.uid, entry.gid },
+    );
+    if (entry.uname.len > 0) {
+        try writer.writeAll(",\"uname\":");
+        try std.json.encodeJsonString(entry.uname, .{}, writer);
+    }
+    if (entry.gname.len > 0) {
+        try writer.writeAll(",\"gname\":");
+        try std.json.encodeJsonString(entry.gname, .{}, writer);
+    }
+    if (entry.link_target.len > 0) {
+        try writer.writeAll(",\"link_target\":");
+        try std.json.encodeJsonString(entry.link_target, .{}, writer);
+    }
+    try writer.writeByte('}');
+}
+
+// Tests
+
+/// Minimal in-memory ArchiveReader over a fixed entry list
+const TestArchive = struct {
+    entries: []const types.Entry,
+    index: usize = 0,
+
+    fn archiveReader(self: *TestArchive) archive.ArchiveReader {
+        return .{
+            .ptr = self,
+            .vtable = &.{ .next = next, .read = read, .deinit = deinit },
+        };
+    }
+
+    fn next(ptr: *anyopaque) anyerror!?types.Entry {
+        const self: *TestArchive = @ptrCast(@alignCast(ptr));
+        if (self.index == self.entries.len) return null;
+        defer self.index += 1;
+        return self.entries[self.index];
+    }
+
+    fn read(_: *anyopaque, _: []u8) anyerror!usize {
+        return 0;
+    }
+
+    fn deinit(_: *anyopaque) void {}
+};
+
+const test_entries = [_]types.Entry{
+    .{ .path = "dir/", .entry_type = .directory, .size = 0, .mode = 0o755, .mtime = 1234567890, .uname = "alice", .gname = "staff" },
+    .{ .path = "dir/a \"b\".txt", .entry_type = .file, .size = 1536, .mode = 0o644, .mtime = 1234567890, .uid = 1000, .gid = 100 },
+    .{ .path = "dir/link", .entry_type = .symlink, .size = 0, .mode = 0o777, .mtime = 0, .link_target = "a \"b\".txt" },
+};
+
+test "listArchive: names and NUL-delimited" {
+    var buf: [512]u8 = undefined;
+
+    {
+        var fbs = std.io.fixedBufferStream(&buf);
+        var src = TestArchive{ .entries = &test_entries };
+        var reader = src.archiveReader();
+        const result = try listArchive(&reader, fbs.writer(), .{});
+        try std.testing.expectEqual(@as(u64, 3), result.entries);
+        try std.testing.expectEqual(@as(u64, 1536), result.total_size);
+        try std.testing.expectEqualStrings("dir/\ndir/a \"b\".txt\ndir/link\n", fbs.getWritten());
+    }
+
+    {
+        var fbs = std.io.fixedBufferStream(&buf);
+        var src = TestArchive{ .entries = &test_entries };
+        var reader = src.archiveReader();
+        _ = try listArchive(&reader, fbs.writer(), .{ .format = .null_delimited });
+        try std.testing.expectEqualStrings("dir/\x00dir/a \"b\".txt\x00dir/link\x00", fbs.getWritten());
+    }
+}
+
+test "listArchive: long format" {
+    var buf: [1024]u8 = undefined;
+    var fbs = std.io.fixedBufferStream(&buf);
+    var src = TestArchive{ .entries = &test_entries };
+    var reader = src.archiveReader();
+
+    _ = try listArchive(&reader, fbs.writer(), .{ .format = .long, .human_readable = true });
+
+    try std.testing.expectEqualStrings(
+        "drwxr-xr-x  alice    staff           0 B  2009-02-13 23:31  dir/\n" ++
+            "-rw-r--r--  1000     100          1.5 KB  2009-02-13 23:31  dir/a \"b\".txt\n" ++
+            "lrwxrwxrwx  0        0               0 B  1970-01-01 00:00  dir/link -> a \"b\".txt\n",
+        fbs.getWritten(),
+    );
+}
+
+test "listArchive: JSON output parses" {
+    const allocator = std.testing.allocator;
+
+    var buf: [1024]u8 = undefined;
+    var fbs = std.io.fixedBufferStream(&buf);
+    var src = TestArchive{ .entries = &test_entries };
+    var reader = src.archiveReader();
+
+    _ = try listArchive(&reader, fbs.writer(), .{ .format = .json });
+
+    const parsed = try std.json.parseFromSlice(std.json.Value, allocator, fbs.getWritten(), .{});
+    defer parsed.deinit();
+
+    const items = parsed.value.array.items;
+    try std.testing.expectEqual(@as(usize, 3), items.len);
+    try std.testing.expectEqualStrings("dir/a \"b\".txt", items[1].object.get("path").?.string);
+    try std.testing.expectEqualStrings("symlink", items[2].object.get("type").?.string);
+    try std.testing.expectEqual(@as(i64, 1536), items[1].object.get("size").?.integer);
+
+    // Empty archives are still valid JSON
+    var empty_fbs = std.io.fixedBufferStream(&buf);
+    var empty = TestArchive{ .entries = &.{} };
+    var empty_reader = empty.archiveReader();
+    _ = try listArchive(&empty_reader, empty_fbs.writer(), .{ .format = .json });
+    try std.testing.expectEqualStrings("[]\n", empty_fbs.getWritten());
+}
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Opening an archive file with the reader for its format
+//!
+//! Shared by the CLI commands and the C library.
+
+const std = @import("std");
+const types = @import("../core/types.zig");
+const archive = @import("../formats/archive.zig");
+const tar = @import("../formats/tar/reader.zig");
+const indexed = @import("../formats/tar/indexed.zig");
+const zip = @import("../formats/zip/reader.zig");
+
+/// Format-specific reader behind an ArchiveReader
+///
+/// Lives on the caller's stack so the ArchiveReader's pointer stays valid;
+/// do not move it after calling `archiveReader`.
+pub const OpenedArchive = union(enum) {
+    tar: tar.TarReader,
+    tar_gz: tar.TarGzReader,
+    tar_bz2: tar.TarBz2Reader,
+    tar_zst: tar.TarZstReader,
+    tar_lz4: tar.TarLz4Reader,
+    tar_xz: tar.TarXzReader,
+    tar_indexed: indexed.IndexedReader,
+    zip: zip.ZipReader,
+
+    /// Type-erased reader for callers that need dynamic dispatch
+    ///
+    /// Hot loops should instead switch on the union with `inline else`
+    /// and take the concrete reader, so each format is monomorphized.
+    pub fn archiveReader(self: *OpenedArchive) archive.ArchiveReader {
+        return switch (self.*) {
+            .tar => |*r| r.archiveReader(),
+            .tar_gz => |*r| r.archiveReader(),
+            .tar_bz2 => |*r| r.archiveReader(),
+            .tar_zst => |*r| r.archiveReader(),
+            .tar_lz4 => |*r| r.archiveReader(),
+            .tar_xz => |*r| r.archiveReader(),
+            .tar_indexed => |*r| r.archiveReader(),
+            .zip => |*r| r.archiveReader(),
+        };
+    }
+
+    pub fn deinit(self: *OpenedArchive) void {
+        switch (self.*) {
+            .tar => |*r| r.deinit(),
+            .tar_gz => |*r| r.deinit(),
+            .tar_bz2 => |*r| r.deinit(),
+            .tar_zst => |*r| r.deinit(),
+            .tar_lz4 => |*r| r.deinit(),
+            .tar_xz => |*r| r.deinit(),
+            .tar_indexed => |*r| r.deinit(),
+            .zip => |*r| r.deinit(),
+        }
+    }
+};
+
+/// How `openArchive` sets up the reader
+pub const OpenOptions = struct {
+    /// Attached to compressed streams to enforce ratio limits
+    observer: ?types.StreamObserver = null,
+
+    /// Decoding threads for formats that decode in parallel (0 = one per
+    /// CPU, 1 = decode on the calling thread). Workers allocate, so the
+    /// allocator must be thread-safe unless this is 1.
+    threads: usize = 0,
+};
+
+/// Open an archive reader for a detected format
+///
+/// Parameters:
+///   - allocator: Memory allocator
+///   - file: Open archive file
+///   - format: Detected format (`.unknown` is read as plain tar)
+///   - options: Observer and decoding threads
+///
+/// Errors:
+///   - error.UnsupportedFormat: No reader for this format yet
+pub fn openArchive(
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    format: types.FormatType,
+    options: OpenOptions,
+) !OpenedArchive {
+    const observer = options.observer;
+
+    // Indexed .tar.gz / .tar.zst archives decode their frames in parallel
+    if ((format == .tar_gz or format == .tar_zst) and try indexed.probe(file)) {
+        var reader = try indexed.IndexedReader.init(allocator, file, .{ .threads = options.threads });
+        reader.setObserver(observer);
+        return .{ .tar_indexed = reader };
+    }
+
+    return switch (format) {
+        .tar, .unknown => .{ .tar = try tar.TarReader.init(allocator, file) },
+        .tar_gz => blk: {
+            var reader = try tar.TarGzReader.init(allocator, file);
+            reader.setObserver(observer);
+            break :blk .{ .tar_gz = reader };
+        },
+        .tar_bz2 => blk: {
+            var reader = try tar.TarBz2Reader.init(allocator, file, .{ .threads = options.threads });
+            reader.setObserver(observer);
+            break :blk .{ .tar_bz2 = reader };
+        },
+        .tar_zst => blk: {
+            var reader = try tar.TarZstReader.init(allocator, file, .{});
+            reader.setObserver(observer);
+            break :blk .{ .tar_zst = reader };
+        },
+        .tar_lz4 => blk: {
+            var reader = try tar.TarLz4Reader.init(allocator, file, .{});
+            reader.setObserver(observer);
+            break :blk .{ .tar_lz4 = reader };
+        },
+        .tar_xz => blk: {
+            var reader = try tar.TarXzReader.init(allocator, file, .{ .threads = options.threads });
+            reader.setObserver(observer);
+            break :blk .{ .tar_xz = reader };
+        },
+        .zip => blk: {
+            var reader = try zip.ZipReader.init(allocator, file, .{ .threads = options.threads });
+            reader.setObserver(observer);
+            break :blk .{ .zip = reader };
+        },
+        else => error.UnsupportedFormat,
+    };
+}
@@ -16,6 +16,7 @@
 const std = @import("std");
 const errors = @import("../core/errors.zig");
 const types = @import("../core/types.zig");
+const util = @import("../core/util.zig");
 
 /// Security policy for archive extraction
 ///
@@ -103,8 +104,12 @@ pub fn sanitizePath(path: []const u8, policy: SecurityPolicy) ![]const u8 {
         return error.EmptyPath;
     }
 
+    // NULL bytes, control characters and ".." depth all come out of one
+    // vectorized pass; the checks below only consult its summary.
+    const scan = util.scanPath(path, .{ .backslash_is_separator = true });
+
     // NULL byte check (C string terminator - security issue)
-    if (std.mem.indexOfScalar(u8, path, 0) != null) {
+    if (scan.has_null) {
         std.log.warn("Path contains NULL byte: {s}", .{path});
         return error.NullByteInPath;
     }
@@ -144,34 +149,43 @@ pub fn sanitizePath(path: []const u8, policy: SecurityPolicy) ![]const u8 {
     }
 
     // Path traversal check
-    if (!policy.allow_path_traversal) {
-        var depth: i32 = 0;
-        var it = std.mem.splitAny(u8, path, "/\\");
-
-        while (it.next()) |component| {
-            if (std.mem.eql(u8, component, "..")) {
-                depth -= 1;
-                if (depth < 0) {
-                    std.log.warn("Path traversal attempt detected: {s}", .{path});
-                    return error.PathTraversalAttempt;
-                }
-            } else if (!std.mem.eql(u8, component, ".") and component.len > 0) {
-                depth += 1;
-            }
-        }
+    if (!policy.allow_path_traversal and scan.escapes_root) {
+        std.log.warn("Path traversal attempt detected: {s}", .{path});
+        return error.PathTraversalAttempt;
     }
 
     // Control character check (except tab which is sometimes legitimate)
-    for (path) |c| {
-        if (c < 0x20 and c != '\t') {
-            std.log.warn("Invalid control character in path: 0x{x}", .{c});
-            return error.InvalidCharacterInPath;
+    if (scan.has_control) {
+        for (path) |c| {
+            if (c < 0x20 and c != '\t') {
+                std.log.warn("Invalid control character in path: 0x{x}", .{c});
+                break;
+            }
         }
+        return error.InvalidCharacterInPath;
     }
 
     return path;
 }
 
+/// Check a single file's uncompressed size against the policy
+///
+/// Parameters:
+///   - uncompressed_size: Size after decompression
+///   - policy: Security policy with limits
+///
+/// Errors:
+///   - error.FileSizeExceedsLimit: Uncompressed size exceeds policy limit
+pub fn checkFileSize(uncompressed_size: u64, policy: SecurityPolicy) !void {
+    if (uncompressed_size > policy.max_file_size) {
+        std.log.warn(
+            "File size {d} exceeds limit {d}",
+            .{ uncompressed_size, policy.max_file_size },
+        );
+        return error.FileSizeExceedsLimit;
+    }
+}
+
 /// Check for potential zip bomb based on compression ratio
 ///
 /// A zip bomb is a maliciously crafted archive that has a very small
@@ -191,13 +205,7 @@ pub fn checkZipBomb(
     policy: SecurityPolicy,
 ) !void {
     // Check absolute uncompressed size
-    if (uncompressed_size > policy.max_file_size) {
-        std.log.warn(
-            "File size {d} exceeds limit {d}",
-            .{ uncompressed_size, policy.max_file_size },
-        );
-        return error.FileSizeExceedsLimit;
-    }
+    try checkFileSize(uncompressed_size, policy);
 
     // Check compression ratio (only if compressed_size > 0)
     if (compressed_size > 0) {
@@ -214,6 +222,82 @@ pub fn checkZipBomb(
     }
 }
 
+/// Running decompression-bomb monitor
+///
+/// `checkZipBomb` can only compare sizes declared in headers, after the
+/// fact. This monitor is fed the real totals from a streaming decoder
+/// (compressed bytes consumed, uncompressed bytes produced) and fails as
+/// soon as either the compression ratio or the total size limit is
+/// crossed, while the stream is still being decompressed.
+///
+/// Decoders report once per inflate step, not per byte, so the check
+/// stays off the per-byte path.
+///
+/// Example:
+/// ```zig
+/// var monitor = RatioMonitor.init(policy);
+/// tar_gz_reader.setObserver(monitor.observer());
+/// ```
+pub const RatioMonitor = struct {
+    /// Maximum allowed uncompressed:compressed ratio
+    max_ratio: f64,
+
+    /// Maximum total uncompressed bytes
+    max_total_size: u64,
+
+    /// Output below this size is not judged on ratio: with tiny streams
+    /// the container overhead dominates and ratios are meaningless
+    min_ratio_output: u64 = 1024 * 1024,
+
+    /// Initialize from a security policy
+    pub fn init(policy: SecurityPolicy) RatioMonitor {
+        return .{
+            .max_ratio = policy.max_compression_ratio,
+            .max_total_size = policy.max_total_size,
+        };
+    }
+
+    /// Check running totals against the policy limits
+    ///
+    /// Parameters:
+    ///   - compressed: Compressed bytes consumed so far
+    ///   - uncompressed: Uncompressed bytes produced so far
+    ///
+    /// Errors:
+    ///   - error.TotalSizeExceedsLimit: Output exceeds max_total_size
+    ///   - error.SuspiciousCompressionRatio: Ratio exceeds max_compression_ratio
+    pub fn check(self: *const RatioMonitor, compressed: u64, uncompressed: u64) !void {
+        if (uncompressed > self.max_total_size) {
+            std.log.warn(
+                "Decompressed size {d} exceeds limit {d} (stream aborted)",
+                .{ uncompressed, self.max_total_size },
+            );
+            return error.TotalSizeExceedsLimit;
+        }
+
+        if (uncompressed < self.min_ratio_output) return;
+
+        const limit = @as(f64, @floatFromInt(compressed)) * self.max_ratio;
+        if (@as(f64, @floatFromInt(uncompressed)) > limit) {
+            std.log.warn(
+                "Suspicious compression ratio: {d} bytes from {d} compressed (limit: {d:.2}:1, stream aborted)",
+                .{ uncompressed, compressed, self.max_ratio },
+            );
+            return error.SuspiciousCompressionRatio;
+        }
+    }
+
+    /// Get a stream observer that feeds this monitor
+    pub fn observer(self: *RatioMonitor) types.StreamObserver {
+        return .{ .ptr = self, .observeFn = observeFn };
+    }
+
+    fn observeFn(ptr: *anyopaque, compressed: u64, uncompressed: u64) anyerror!void {
+        const self: *RatioMonitor = @ptrCast(@alignCast(ptr));
+        return self.check(compressed, uncompressed);
+    }
+};
+
 /// Tracker for cumulative extraction metrics
 ///
 /// Tracks total uncompressed size across all extracted files to prevent
@@ -344,6 +428,61 @@ pub fn validateSymlink(
     }
 }
 
+/// Validate a symlink target without touching the filesystem
+///
+/// Used when the kernel already confines every open beneath the
+/// extraction root (openat2 RESOLVE_BENEATH), which makes the realpath
+/// resolution in `validateSymlink` redundant. The symlink policy itself
+/// still applies: under `.only_relative` the target, taken relative to
+/// the link's directory, must not climb above the extraction root.
+///
+/// Parameters:
+///   - link_path: Path of the symlink being created (already sanitized)
+///   - target: Target path the symlink points to
+///   - policy: Security policy to apply
+///
+/// Errors:
+///   - error.SymlinkNotAllowed: Symlinks are disallowed by policy
+///   - error.AbsoluteSymlinkNotAllowed: Absolute symlink not allowed
+///   - error.SymlinkEscapeAttempt: Symlink points outside extraction directory
+///   - error.PathTooLong: Link path plus target exceed path limits
+pub fn validateSymlinkLexical(
+    link_path: []const u8,
+    target: []const u8,
+    policy: SecurityPolicy,
+) !void {
+    switch (policy.symlink_policy) {
+        .disallow => {
+            std.log.warn("Symlink not allowed: {s} -> {s}", .{ link_path, target });
+            return error.SymlinkNotAllowed;
+        },
+
+        .only_relative => {
+            if (std.fs.path.isAbsolute(target)) {
+                std.log.warn("Absolute symlink not allowed: {s} -> {s}", .{
+                    link_path,
+                    target,
+                });
+                return error.AbsoluteSymlinkNotAllowed;
+            }
+
+            var buf: [types.SizeLimit.max_path_length + types.SizeLimit.max_link_target_length + 1]u8 = undefined;
+            const link_dir = std.fs.path.dirname(link_path) orelse "";
+            const joined = std.fmt.bufPrint(&buf, "{s}/{s}", .{ link_dir, target }) catch
+                return error.PathTooLong;
+
+            if (util.scanPath(joined, .{ .backslash_is_separator = false }).escapes_root) {
+                std.log.warn("Symlink escape attempt: {s} -> {s}", .{ link_path, target });
+                return error.SymlinkEscapeAttempt;
+            }
+        },
+
+        .allow_all => {
+            // Allow any symlink (dangerous)
+        },
+    }
+}
+
 /// Normalize a filename by removing or replacing dangerous characters
 ///
 /// This function handles:
@@ -484,6 +623,107 @@ test "sanitizePath: reject overly long paths" {
     try std.testing.expectError(error.PathTooLong, sanitizePath(long_path, policy));
 }
 
+test "sanitizePath: single-pass scan matches multi-pass reference" {
+    // The validator before vectorization, kept verbatim as an oracle
+    const reference = struct {
+        fn sanitize(path: []const u8, policy: SecurityPolicy) !void {
+            if (path.len == 0) return error.EmptyPath;
+            if (std.mem.indexOfScalar(u8, path, 0) != null) return error.NullByteInPath;
+            if (path.len > types.SizeLimit.max_path_length) return error.PathTooLong;
+            if (!policy.allow_absolute_paths) {
+                if (std.fs.path.isAbsolute(path)) return error.AbsolutePathNotAllowed;
+                if (path.len >= 2 and path[1] == ':' and std.ascii.isAlphabetic(path[0])) {
+                    return error.AbsolutePathNotAllowed;
+                }
+                if (path.len >= 2 and ((path[0] == '\\' and path[1] == '\\') or (path[0] == '/' and path[1] == '/'))) {
+                    return error.AbsolutePathNotAllowed;
+                }
+            }
+            if (!policy.allow_path_traversal) {
+                var depth: i32 = 0;
+                var it = std.mem.splitAny(u8, path, "/\\");
+                while (it.next()) |component| {
+                    if (std.mem.eql(u8, component, "..")) {
+                        depth -= 1;
+                        if (depth < 0) return error.PathTraversalAttempt;
+                    } else if (!std.mem.eql(u8, component, ".") and component.len > 0) {
+                        depth += 1;
+                    }
+                }
+            }
+            for (path) |c| {
+                if (c < 0x20 and c != '\t') return error.InvalidCharacterInPath;
+            }
+        }
+    };
+
+    // Rejections are expected by the thousand; keep the test log quiet
+    const saved_level = std.testing.log_level;
+    std.testing.log_level = .err;
+    defer std.testing.log_level = saved_level;
+
+    var prng = std.Random.DefaultPrng.init(0x7a617263);
+    const random = prng.random();
+    const common = "....//\\\\abC:";
+    const rare = "\x00\t\n\r";
+
+    const policies = [_]SecurityPolicy{
+        .{},
+        .{ .allow_path_traversal = true },
+        .{ .allow_absolute_paths = true },
+    };
+
+    var buf: [160]u8 = undefined;
+    for (0..20000) |i| {
+        const len = random.uintAtMost(usize, buf.len);
+        for (buf[0..len]) |*c| {
+            c.* = if (random.uintLessThan(u8, 64) == 0)
+                rare[random.uintLessThan(usize, rare.len)]
+            else
+                common[random.uintLessThan(usize, common.len)];
+        }
+        const path = buf[0..len];
+        const policy = policies[i % policies.len];
+
+        const expected = reference.sanitize(path, policy);
+        if (sanitizePath(path, policy)) |_| {
+            try expected;
+        } else |err| {
+            try std.testing.expectError(err, expected);
+        }
+    }
+}
+
+test "RatioMonitor: aborts on ratio and total size" {
+    const saved_level = std.testing.log_level;
+    std.testing.log_level = .err;
+    defer std.testing.log_level = saved_level;
+
+    var monitor = RatioMonitor.init(.{ .max_total_size = 100 * 1024 * 1024 });
+
+    // Small outputs are never judged on ratio
+    try monitor.check(1, 64 * 1024);
+
+    // Typical ratios pass
+    try monitor.check(1024 * 1024, 10 * 1024 * 1024);
+
+    try std.testing.expectError(
+        error.SuspiciousCompressionRatio,
+        monitor.check(2 * 1024, 4 * 1024 * 1024),
+    );
+    try std.testing.expectError(
+        error.TotalSizeExceedsLimit,
+        monitor.check(50 * 1024 * 1024, 101 * 1024 * 1024),
+    );
+
+    // Reached through the observer interface as decoders use it
+    const obs = monitor.observer();
+    try std.testing.expectError(
+        error.SuspiciousCompressionRatio,
+        obs.observe(1, 2 * 1024 * 1024),
+    );
+}
+
 test "checkZipBomb: normal files pass" {
     const policy = SecurityPolicy{};
 
@@ -519,6 +759,13 @@ test "checkZipBomb: zero compressed size is safe" {
     try checkZipBomb(0, 1000, policy);
 }
 
+test "checkFileSize: enforces the per-file limit" {
+    const policy = SecurityPolicy{ .max_file_size = 1024 };
+
+    try checkFileSize(1024, policy);
+    try std.testing.expectError(error.FileSizeExceedsLimit, checkFileSize(1025, policy));
+}
+
 test "ExtractionTracker: track cumulative size" {
     const policy = SecurityPolicy{ .max_total_size = 10000 };
     var tracker = ExtractionTracker.init(policy);
@@ -610,3 +857,28 @@ test "normalizeFilename: reject NULL byte" {
         normalizeFilename(allocator, "file\x00.txt"),
     );
 }
+
+test "validateSymlinkLexical: matches realpath-based validation" {
+    const policy = SecurityPolicy{ .symlink_policy = .only_relative };
+
+    try validateSymlinkLexical("link", "target", policy);
+    try validateSymlinkLexical("a/link", "../target", policy);
+    try validateSymlinkLexical("a/b/link", "../../c/./d", policy);
+
+    try std.testing.expectError(
+        error.AbsoluteSymlinkNotAllowed,
+        validateSymlinkLexical("link", "/etc/passwd", policy),
+    );
+    try std.testing.expectError(
+        error.SymlinkEscapeAttempt,
+        validateSymlinkLexical("link", "../../../../etc/passwd", policy),
+    );
+    try std.testing.expectError(
+        error.SymlinkEscapeAttempt,
+        validateSymlinkLexical("a/link", "../..", policy),
+    );
+    try std.testing.expectError(
+        error.SymlinkNotAllowed,
+        validateSymlinkLexical("link", "target", .{}),
+    );
+}
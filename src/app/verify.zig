@@ -0,0 +1,792 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+const std = @import("std");
+const types = @import("../core/types.zig");
+const tar = @import("../formats/tar/reader.zig");
+const indexed = @import("../formats/tar/indexed.zig");
+const zip = @import("../formats/zip/reader.zig");
+const zlib = @import("../compress/zlib.zig");
+const bgzf = @import("../compress/bgzf.zig");
+const zstd = @import("../compress/zstd.zig");
+const lz4 = @import("../compress/lz4.zig");
+const bzip2 = @import("../compress/bzip2.zig");
+const xz = @import("../compress/xz.zig");
+const readahead = @import("../io/readahead.zig");
+const instrument = @import("../core/instrument.zig");
+
+/// Options for archive verification
+pub const VerifyOptions = struct {
+    /// Worker threads for decompression (0 = one per CPU, 1 = no threads)
+    /// Default: 0
+    threads: usize = 0,
+
+    /// Print each entry as it is verified
+    /// Default: false
+    verbose: bool = false,
+};
+
+/// Result of a verification run
+pub const VerifyResult = struct {
+    /// Number of entries verified
+    entries: u64 = 0,
+
+    /// Entry payload bytes read
+    data_bytes: u64 = 0,
+
+    /// Archive file bytes consumed
+    archive_bytes: u64 = 0,
+
+    /// Decompressed stream bytes (equal to archive_bytes when uncompressed)
+    stream_bytes: u64 = 0,
+
+    /// BGZF, LZ4, bzip2 or XZ blocks, or Zstandard or indexed frames,
+    /// verified in parallel (0 for other inputs)
+    parallel_blocks: u64 = 0,
+
+    /// Wall-clock time spent
+    elapsed_ns: u64 = 0,
+
+    /// Archive bytes verified per second, in GB/s
+    pub fn throughputGBps(self: VerifyResult) f64 {
+        if (self.elapsed_ns == 0) return 0;
+        return @as(f64, @floatFromInt(self.archive_bytes)) / @as(f64, @floatFromInt(self.elapsed_ns));
+    }
+};
+
+/// Verify archive integrity without writing anything to disk
+///
+/// Every header checksum is checked, every entry's data is read to make
+/// sure it is all present, and for gzip input the whole compressed stream
+/// (including any padding after the tar end marker) is inflated so zlib
+/// checks the CRC-32 and ISIZE of every member.
+///
+/// Gzip, Zstandard and LZ4 input is decompressed on a separate thread from
+/// tar parsing. BGZF input (gzip members that record their own size) is
+/// inflated one member per core, and so are Zstandard frames that record
+/// their content size, independent LZ4 blocks, all bzip2 blocks and XZ
+/// blocks that record their sizes (as `xz -T` writes them).
+///
+/// Parameters:
+///   - allocator: Memory allocator (must be thread-safe when threads != 1)
+///   - file: Archive file
+///   - format: Archive format (`.unknown` is read as plain tar)
+///   - options: Verification options
+///
+/// Returns:
+///   - Verification statistics
+///
+/// Errors:
+///   - error.CorruptedHeader: Header checksum or magic mismatch
+///   - error.IncompleteArchive: Entry data or end marker missing
+///   - error.ChecksumMismatch: Gzip CRC-32/ISIZE, bzip2 CRC, XZ block check or Zstandard/LZ4 checksum mismatch
+///   - error.CorruptedStream: Compressed stream truncated
+///   - error.UnsupportedFormat: Format cannot be verified yet
+///
+/// Example:
+/// ```zig
+/// const result = try verifyFile(allocator, file, .tar_gz, .{});
+/// std.debug.print("{d:.2} GB/s\n", .{result.throughputGBps()});
+/// ```
+pub fn verifyFile(
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    format: types.FormatType,
+    options: VerifyOptions,
+) !VerifyResult {
+    var timer = try std.time.Timer.start();
+
+    var result = switch (format) {
+        .tar, .unknown => try verifyTar(allocator, file, options),
+        .tar_gz => try verifyTarGz(allocator, file, options),
+        .tar_bz2 => try verifyTarBz2(allocator, file, options),
+        .tar_zst => try verifyTarZst(allocator, file, options),
+        .tar_lz4 => try verifyTarLz4(allocator, file, options),
+        .tar_xz => try verifyTarXz(allocator, file, options),
+        .zip => try verifyZip(allocator, file, options),
+        else => return error.UnsupportedFormat,
+    };
+
+    result.elapsed_ns = timer.read();
+    return result;
+}
+
+/// Verify a plain tar file
+fn verifyTar(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    var tar_reader = try tar.TarReader.init(allocator, file);
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    result.archive_bytes = tar_reader.file_position;
+    result.stream_bytes = tar_reader.file_position;
+    return result;
+}
+
+/// Verify a gzip-compressed tar file
+fn verifyTarGz(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const threaded = options.threads != 1;
+    if (threaded and try indexed.probe(file)) return verifyIndexed(allocator, file, options);
+
+    // BGZF members can be split without decompressing
+    var head: [bgzf.header_size]u8 = undefined;
+    const head_len = try file.preadAll(&head, 0);
+    if (threaded and bgzf.blockSize(head[0..head_len]) != null) {
+        return verifyBgzf(allocator, file, options);
+    }
+
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var inflate = try zlib.InflateReader.init(allocator, file_source, .gzip);
+    defer inflate.deinit();
+    try inflate.checkHeader();
+
+    // Inflate on a producer thread while this thread parses tar
+    var ahead: readahead.ReadAhead = undefined;
+    const decoded = inflate.reader();
+    try ahead.init(allocator, decoded.any(), .{});
+    defer ahead.deinit();
+    if (threaded) try ahead.start();
+
+    const ahead_reader = ahead.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, ahead_reader.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    // Run the stream to its end so the final member's trailer is checked
+    result.stream_bytes = tar_reader.file_position + try drain(ahead_reader.any());
+
+    // The producer thread is done once drain() has seen end of stream
+    result.archive_bytes = inflate.compressed_bytes;
+    return result;
+}
+
+/// Verify a BGZF-compressed tar file, one member per core
+fn verifyBgzf(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var parallel: bgzf.ParallelReader = undefined;
+    try parallel.init(allocator, file_source, .{ .threads = options.threads });
+    defer parallel.deinit();
+
+    const decoded = parallel.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, decoded.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    result.stream_bytes = tar_reader.file_position + try drain(decoded.any());
+    result.archive_bytes = parallel.compressed_bytes;
+    result.parallel_blocks = parallel.blocks;
+    return result;
+}
+
+/// Verify an indexed tar.gz or tar.zst file, decoding batches of frames in parallel
+fn verifyIndexed(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    var reader = try indexed.IndexedReader.init(allocator, file, .{ .threads = options.threads });
+    defer reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &reader, options, &result);
+
+    // The end-of-archive blocks sit in the last frame, so every frame was checked
+    result.stream_bytes = reader.uncompressedBytes();
+    result.archive_bytes = reader.compressedBytes();
+    result.parallel_blocks = reader.framesDecoded();
+    return result;
+}
+
+/// Verify a bzip2-compressed tar file
+fn verifyTarBz2(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    // bzip2 blocks are always independent
+    if (options.threads != 1) return verifyBz2Parallel(allocator, file, options);
+
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var decoder = try bzip2.Bz2Reader.init(allocator, file_source);
+    defer decoder.deinit();
+    try decoder.checkHeader();
+
+    const decoded = decoder.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, decoded.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    // Run the stream to its end so every stream CRC is checked
+    result.stream_bytes = tar_reader.file_position + try drain(decoded.any());
+    result.archive_bytes = decoder.compressed_bytes;
+    return result;
+}
+
+/// Verify a bzip2 tar file, one block per core
+fn verifyBz2Parallel(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var parallel: bzip2.ParallelReader = undefined;
+    try parallel.init(allocator, file_source, .{ .threads = options.threads });
+    defer parallel.deinit();
+    try parallel.checkHeader();
+
+    const decoded = parallel.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, decoded.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    result.stream_bytes = tar_reader.file_position + try drain(decoded.any());
+    result.archive_bytes = parallel.compressed_bytes;
+    result.parallel_blocks = parallel.blocks;
+    return result;
+}
+
+/// Verify an XZ-compressed tar file
+fn verifyTarXz(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    // Blocks without sizes in their headers fall back to in-order decoding
+    if (options.threads != 1) return verifyXzParallel(allocator, file, options);
+
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var decoder = try xz.XzReader.init(allocator, file_source);
+    defer decoder.deinit();
+    try decoder.checkHeader();
+
+    const decoded = decoder.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, decoded.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    // Run the stream to its end so every block check and index is verified
+    result.stream_bytes = tar_reader.file_position + try drain(decoded.any());
+    result.archive_bytes = decoder.compressed_bytes;
+    return result;
+}
+
+/// Verify an XZ tar file, one block per core
+fn verifyXzParallel(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var parallel: xz.ParallelReader = undefined;
+    try parallel.init(allocator, file_source, .{ .threads = options.threads });
+    defer parallel.deinit();
+    try parallel.checkHeader();
+
+    const decoded = parallel.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, decoded.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    result.stream_bytes = tar_reader.file_position + try drain(decoded.any());
+    result.archive_bytes = parallel.compressed_bytes;
+    result.parallel_blocks = parallel.blocks;
+    return result;
+}
+
+/// Verify a Zstandard-compressed tar file
+fn verifyTarZst(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const threaded = options.threads != 1;
+    if (threaded and try indexed.probe(file)) return verifyIndexed(allocator, file, options);
+
+    // Frames that declare their content size can be decoded side by side
+    var head: [zstd.decode.max_frame_header_size]u8 = undefined;
+    const head_len = try file.preadAll(&head, 0);
+    const first_frame = zstd.decode.FrameHeader.parse(head[0..head_len]) catch null;
+    if (threaded and first_frame != null and first_frame.?.content_size != null) {
+        return verifyZstParallel(allocator, file, options);
+    }
+
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var decoder = try zstd.ZstdReader.init(allocator, file_source, .{});
+    defer decoder.deinit();
+    try decoder.checkHeader();
+
+    // Decode on a producer thread while this thread parses tar
+    var ahead: readahead.ReadAhead = undefined;
+    const decoded = decoder.reader();
+    try ahead.init(allocator, decoded.any(), .{});
+    defer ahead.deinit();
+    if (threaded) try ahead.start();
+
+    const ahead_reader = ahead.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, ahead_reader.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    // Run the stream to its end so the final frame's checksum is checked
+    result.stream_bytes = tar_reader.file_position + try drain(ahead_reader.any());
+    result.archive_bytes = decoder.compressed_bytes;
+    return result;
+}
+
+/// Verify a multi-frame Zstandard tar file, one frame per core
+fn verifyZstParallel(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var parallel: zstd.ParallelReader = undefined;
+    try parallel.init(allocator, file_source, .{ .threads = options.threads });
+    defer parallel.deinit();
+
+    const decoded = parallel.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, decoded.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    result.stream_bytes = tar_reader.file_position + try drain(decoded.any());
+    result.archive_bytes = parallel.compressed_bytes;
+    result.parallel_blocks = parallel.frames;
+    return result;
+}
+
+/// Verify an LZ4-compressed tar file
+fn verifyTarLz4(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const threaded = options.threads != 1;
+
+    // Independent blocks can be decoded side by side
+    var head: [lz4.max_header_size]u8 = undefined;
+    const head_len = try file.preadAll(&head, 0);
+    const first_frame = lz4.FrameHeader.parse(head[0..head_len]) catch null;
+    if (threaded and first_frame != null and first_frame.?.independent) {
+        return verifyLz4Parallel(allocator, file, options);
+    }
+
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var decoder = try lz4.Lz4Reader.init(allocator, file_source);
+    defer decoder.deinit();
+    try decoder.checkHeader();
+
+    // Decode on a producer thread while this thread parses tar
+    var ahead: readahead.ReadAhead = undefined;
+    const decoded = decoder.reader();
+    try ahead.init(allocator, decoded.any(), .{});
+    defer ahead.deinit();
+    if (threaded) try ahead.start();
+
+    const ahead_reader = ahead.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, ahead_reader.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    // Run the stream to its end so the content checksum is checked
+    result.stream_bytes = tar_reader.file_position + try drain(ahead_reader.any());
+    result.archive_bytes = decoder.compressed_bytes;
+    return result;
+}
+
+/// Verify an LZ4 tar file with independent blocks, one block per core
+fn verifyLz4Parallel(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    const file_source = std.io.AnyReader{ .context = &file, .readFn = readFile };
+
+    var parallel: lz4.ParallelReader = undefined;
+    try parallel.init(allocator, file_source, .{ .threads = options.threads });
+    defer parallel.deinit();
+
+    const decoded = parallel.reader();
+    var tar_reader = try tar.TarReader.initReader(allocator, decoded.any());
+    defer tar_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &tar_reader, options, &result);
+
+    result.stream_bytes = tar_reader.file_position + try drain(decoded.any());
+    result.archive_bytes = parallel.compressed_bytes;
+    result.parallel_blocks = parallel.blocks;
+    return result;
+}
+
+/// Verify a ZIP file, decoding members on `options.threads` cores
+fn verifyZip(allocator: std.mem.Allocator, file: std.fs.File, options: VerifyOptions) !VerifyResult {
+    var zip_reader = try zip.ZipReader.init(allocator, file, .{ .threads = options.threads });
+    defer zip_reader.deinit();
+
+    var result = VerifyResult{};
+    try verifyEntries(allocator, &zip_reader, options, &result);
+
+    result.archive_bytes = try file.getEndPos();
+    result.stream_bytes = result.data_bytes;
+    return result;
+}
+
+/// Read every entry's data, counting entries and bytes
+///
+/// Takes the concrete reader so each format gets its own inlined loop.
+fn verifyEntries(
+    allocator: std.mem.Allocator,
+    archive_reader: anytype,
+    options: VerifyOptions,
+    result: *VerifyResult,
+) !void {
+    const buffer = try allocator.alloc(u8, types.BufferSize.large);
+    defer allocator.free(buffer);
+
+    while (try archive_reader.next()) |entry| {
+        const entry_timer = instrument.beginEntry(entry.path);
+        defer entry_timer.end();
+
+        var read_bytes: u64 = 0;
+        while (true) {
+            const n = try archive_reader.read(buffer);
+            if (n == 0) break;
+            read_bytes += n;
+        }
+
+        if (read_bytes != entry.size) {
+            return error.IncompleteArchive;
+        }
+
+        if (options.verbose) {
+            std.debug.print("Testing {s} ... OK\n", .{entry.path});
+        }
+
+        result.entries += 1;
+        result.data_bytes += read_bytes;
+    }
+}
+
+/// Read a stream to its end, returning the number of bytes read
+fn drain(reader: std.io.AnyReader) !u64 {
+    var buffer: [32 * 1024]u8 = undefined;
+    var total: u64 = 0;
+    while (true) {
+        const n = try reader.read(&buffer);
+        if (n == 0) return total;
+        total += n;
+    }
+}
+
+fn readFile(context: *const anyopaque, buffer: []u8) anyerror!usize {
+    const file: *const std.fs.File = @ptrCast(@alignCast(context));
+    return file.read(buffer);
+}
+
+// Tests
+
+const header = @import("../formats/tar/header.zig");
+
+/// Build a small tar archive with `count` files of `size` bytes each
+fn buildTestTar(allocator: std.mem.Allocator, count: usize, size: usize) ![]u8 {
+    var data = std.ArrayList(u8).init(allocator);
+    errdefer data.deinit();
+
+    for (0..count) |i| {
+        var name_buf: [32]u8 = undefined;
+        const entry = types.Entry{
+            .path = try std.fmt.bufPrint(&name_buf, "file{d}.bin", .{i}),
+            .entry_type = .file,
+            .size = size,
+            .mode = 0o644,
+            .mtime = 0,
+        };
+        const hdr = try header.createHeader(&entry, allocator);
+        try data.appendSlice(std.mem.asBytes(&hdr));
+        for (0..size) |j| try data.append(@truncate(i + j));
+        try data.appendNTimes(0, (512 - size % 512) % 512);
+    }
+    try data.appendNTimes(0, 1024);
+    return data.toOwnedSlice();
+}
+
+test "verifyFile: tar and tar.gz, threaded and not" {
+    const allocator = std.testing.allocator;
+
+    const tar_data = try buildTestTar(allocator, 20, 3000);
+    defer allocator.free(tar_data);
+    const gz_data = try zlib.compress(allocator, .gzip, tar_data);
+    defer allocator.free(gz_data);
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "a.tar", .data = tar_data });
+    try tmp_dir.dir.writeFile(.{ .sub_path = "a.tar.gz", .data = gz_data });
+
+    {
+        const file = try tmp_dir.dir.openFile("a.tar", .{});
+        defer file.close();
+        const result = try verifyFile(allocator, file, .tar, .{});
+        try std.testing.expectEqual(@as(u64, 20), result.entries);
+        try std.testing.expectEqual(@as(u64, 20 * 3000), result.data_bytes);
+        try std.testing.expectEqual(@as(u64, tar_data.len), result.archive_bytes);
+    }
+
+    for ([_]usize{ 1, 0 }) |threads| {
+        const file = try tmp_dir.dir.openFile("a.tar.gz", .{});
+        defer file.close();
+        const result = try verifyFile(allocator, file, .tar_gz, .{ .threads = threads });
+        try std.testing.expectEqual(@as(u64, 20), result.entries);
+        try std.testing.expectEqual(@as(u64, gz_data.len), result.archive_bytes);
+        try std.testing.expectEqual(@as(u64, tar_data.len), result.stream_bytes);
+    }
+}
+
+test "verifyFile: indexed tar.gz and tar.zst, threaded and not" {
+    const allocator = std.testing.allocator;
+
+    const tar_data = try buildTestTar(allocator, 20, 3000);
+    defer allocator.free(tar_data);
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    for ([_]indexed.Codec{ .gzip, .zstd }) |codec| {
+        const format: types.FormatType = if (codec == .gzip) .tar_gz else .tar_zst;
+        const file = try tmp_dir.dir.createFile("indexed.tar", .{ .read = true });
+        defer file.close();
+
+        // Same members as buildTestTar, so the tar streams are identical
+        var writer: indexed.IndexedWriter = undefined;
+        try writer.init(allocator, file, .{ .codec = codec, .frame_size = 8192 });
+        defer writer.deinit();
+        for (0..20) |i| {
+            var name_buf: [32]u8 = undefined;
+            try writer.addEntry(.{
+                .path = try std.fmt.bufPrint(&name_buf, "file{d}.bin", .{i}),
+                .entry_type = .file,
+                .size = 3000,
+                .mode = 0o644,
+                .mtime = 0,
+            });
+            var data: [3000]u8 = undefined;
+            for (&data, 0..) |*b, j| b.* = @truncate(i + j);
+            _ = try writer.write(&data);
+        }
+        try writer.finalize();
+        const file_size = (try file.stat()).size;
+
+        for ([_]usize{ 1, 0 }) |threads| {
+            try file.seekTo(0);
+            const result = try verifyFile(allocator, file, format, .{ .threads = threads });
+            try std.testing.expectEqual(@as(u64, 20), result.entries);
+            try std.testing.expectEqual(file_size, result.archive_bytes);
+            try std.testing.expectEqual(@as(u64, tar_data.len), result.stream_bytes);
+            const frames = std.math.divCeil(usize, tar_data.len, 8192) catch unreachable;
+            try std.testing.expectEqual(@as(u64, if (threads == 1) 0 else frames), result.parallel_blocks);
+        }
+    }
+}
+
+test "verifyFile: corrupt gzip trailer is detected" {
+    const allocator = std.testing.allocator;
+
+    const tar_data = try buildTestTar(allocator, 3, 100);
+    defer allocator.free(tar_data);
+    const gz_data = try zlib.compress(allocator, .gzip, tar_data);
+    defer allocator.free(gz_data);
+
+    // The CRC sits after the tar end marker, so only a full drain sees it
+    gz_data[gz_data.len - 6] ^= 0x55;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "bad.tar.gz", .data = gz_data });
+
+    for ([_]usize{ 1, 2 }) |threads| {
+        const file = try tmp_dir.dir.openFile("bad.tar.gz", .{});
+        defer file.close();
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            verifyFile(allocator, file, .tar_gz, .{ .threads = threads }),
+        );
+    }
+}
+
+test "verifyFile: multi-frame tar.zst, threaded and not" {
+    const allocator = std.testing.allocator;
+
+    const tar_data = try buildTestTar(allocator, 40, 5000);
+    defer allocator.free(tar_data);
+    const zst_data = try zstd.compress(allocator, tar_data, .{ .frame_size = 32 * 1024 });
+    defer allocator.free(zst_data);
+    const frames = std.math.divCeil(usize, tar_data.len, 32 * 1024) catch unreachable;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "a.tar.zst", .data = zst_data });
+
+    for ([_]usize{ 1, 0 }) |threads| {
+        const file = try tmp_dir.dir.openFile("a.tar.zst", .{});
+        defer file.close();
+        const result = try verifyFile(allocator, file, .tar_zst, .{ .threads = threads });
+        try std.testing.expectEqual(@as(u64, 40), result.entries);
+        try std.testing.expectEqual(@as(u64, zst_data.len), result.archive_bytes);
+        try std.testing.expectEqual(@as(u64, tar_data.len), result.stream_bytes);
+        try std.testing.expectEqual(@as(u64, if (threads == 1) 0 else frames), result.parallel_blocks);
+    }
+
+    // The last frame's checksum sits after the tar end marker
+    zst_data[zst_data.len - 1] ^= 0x55;
+    try tmp_dir.dir.writeFile(.{ .sub_path = "bad.tar.zst", .data = zst_data });
+    for ([_]usize{ 1, 2 }) |threads| {
+        const file = try tmp_dir.dir.openFile("bad.tar.zst", .{});
+        defer file.close();
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            verifyFile(allocator, file, .tar_zst, .{ .threads = threads }),
+        );
+    }
+}
+
+test "verifyFile: tar.lz4, threaded and not" {
+    const allocator = std.testing.allocator;
+
+    const tar_data = try buildTestTar(allocator, 40, 5000);
+    defer allocator.free(tar_data);
+    const lz4_data = try lz4.compress(allocator, tar_data, .{ .block_size = .max64KB });
+    defer allocator.free(lz4_data);
+    const blocks = std.math.divCeil(usize, tar_data.len, 64 * 1024) catch unreachable;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "a.tar.lz4", .data = lz4_data });
+
+    for ([_]usize{ 1, 0 }) |threads| {
+        const file = try tmp_dir.dir.openFile("a.tar.lz4", .{});
+        defer file.close();
+        const result = try verifyFile(allocator, file, .tar_lz4, .{ .threads = threads });
+        try std.testing.expectEqual(@as(u64, 40), result.entries);
+        try std.testing.expectEqual(@as(u64, lz4_data.len), result.archive_bytes);
+        try std.testing.expectEqual(@as(u64, tar_data.len), result.stream_bytes);
+        try std.testing.expectEqual(@as(u64, if (threads == 1) 0 else blocks), result.parallel_blocks);
+    }
+
+    // The content checksum sits after the tar end marker
+    lz4_data[lz4_data.len - 1] ^= 0x55;
+    try tmp_dir.dir.writeFile(.{ .sub_path = "bad.tar.lz4", .data = lz4_data });
+    for ([_]usize{ 1, 2 }) |threads| {
+        const file = try tmp_dir.dir.openFile("bad.tar.lz4", .{});
+        defer file.close();
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            verifyFile(allocator, file, .tar_lz4, .{ .threads = threads }),
+        );
+    }
+}
+
+test "verifyFile: concatenated tar.bz2 streams, threaded and not" {
+    const allocator = std.testing.allocator;
+
+    // A two-entry, 10 KiB tar split in half and compressed as two
+    // streams, as pbzip2 would
+    var bz2_data = [_]u8{
+        0x42, 0x5a, 0x68, 0x39, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0xfe, 0xe6, 0x86, 0xe8, 0x00, 0x03,
+        0x97, 0xdb, 0x80, 0xc8, 0x90, 0x40, 0x05, 0x7f, 0x80, 0x00, 0xc0, 0x72, 0x44, 0x5e, 0x40, 0x0c,
+        0x00, 0x30, 0x00, 0xba, 0x81, 0x28, 0x84, 0x68, 0x7a, 0x80, 0x7a, 0x80, 0x00, 0xc6, 0x00, 0x00,
+        0x00, 0x00, 0x29, 0x52, 0x24, 0x3d, 0x21, 0xa1, 0xea, 0x64, 0x0c, 0x65, 0x33, 0xea, 0xd0, 0xcb,
+        0x30, 0xe3, 0xe9, 0x97, 0xf3, 0x93, 0x43, 0xc9, 0xc5, 0x87, 0x85, 0x60, 0x74, 0x25, 0x56, 0x4c,
+        0x04, 0x04, 0x55, 0x18, 0x89, 0x7d, 0x90, 0x10, 0xa0, 0x50, 0x43, 0x37, 0x88, 0x84, 0x47, 0x65,
+        0x59, 0xb1, 0x02, 0xe9, 0x38, 0xb3, 0x1e, 0x5a, 0x33, 0x35, 0xfc, 0x29, 0x18, 0xaa, 0x16, 0x31,
+        0xf3, 0x49, 0x1b, 0x74, 0xcd, 0xa8, 0x8b, 0x85, 0x42, 0xe1, 0xbf, 0xec, 0x22, 0xed, 0x29, 0x1f,
+        0x52, 0x91, 0xda, 0x52, 0x30, 0xd9, 0xbb, 0x68, 0x45, 0xbb, 0x66, 0xef, 0x66, 0xb7, 0xf8, 0xbb,
+        0x92, 0x29, 0xc2, 0x84, 0x87, 0xf7, 0x34, 0x37, 0x40, 0x42, 0x5a, 0x68, 0x39, 0x31, 0x41, 0x59,
+        0x26, 0x53, 0x59, 0x56, 0x73, 0x3c, 0xd6, 0x00, 0x00, 0x0a, 0x60, 0x00, 0xc0, 0x00, 0x40, 0x00,
+        0x00, 0x08, 0x20, 0x00, 0x20, 0xa5, 0x34, 0x19, 0x8c, 0x4d, 0x89, 0x3c, 0x5d, 0xc9, 0x14, 0xe1,
+        0x42, 0x41, 0x59, 0xcc, 0xf3, 0x58,
+    };
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "a.tar.bz2", .data = &bz2_data });
+
+    for ([_]usize{ 1, 0 }) |threads| {
+        const file = try tmp_dir.dir.openFile("a.tar.bz2", .{});
+        defer file.close();
+        const result = try verifyFile(allocator, file, .tar_bz2, .{ .threads = threads });
+        try std.testing.expectEqual(@as(u64, 2), result.entries);
+        try std.testing.expectEqual(@as(u64, bz2_data.len), result.archive_bytes);
+        try std.testing.expectEqual(@as(u64, 10240), result.stream_bytes);
+        try std.testing.expectEqual(@as(u64, if (threads == 1) 0 else 2), result.parallel_blocks);
+    }
+
+    // The second stream's combined CRC ends the file
+    bz2_data[bz2_data.len - 1] ^= 0x80;
+    try tmp_dir.dir.writeFile(.{ .sub_path = "bad.tar.bz2", .data = &bz2_data });
+    for ([_]usize{ 1, 2 }) |threads| {
+        const file = try tmp_dir.dir.openFile("bad.tar.bz2", .{});
+        defer file.close();
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            verifyFile(allocator, file, .tar_bz2, .{ .threads = threads }),
+        );
+    }
+}
+
+test "verifyFile: multi-block tar.xz, threaded and not" {
+    const allocator = std.testing.allocator;
+
+    // A two-entry, 10 KiB tar from `xz -T2 --block-size=5120 -C crc32`:
+    // two blocks that record their sizes
+    var xz_data = [_]u8{
+        0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x01, 0x69, 0x22, 0xde, 0x36, 0x03, 0xc0, 0x8b, 0x01,
+        0x80, 0x28, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x1b, 0xdb, 0xf7, 0x8f, 0xe0, 0x13, 0xff, 0x00,
+        0x83, 0x5d, 0x00, 0x30, 0x8b, 0x8a, 0x87, 0xc4, 0x0e, 0xf2, 0x97, 0xa4, 0xf8, 0x75, 0x3d, 0xc5,
+        0xa9, 0xed, 0xd9, 0x9a, 0x39, 0xdf, 0xfb, 0x8d, 0x99, 0xff, 0x08, 0xca, 0x74, 0x17, 0x0b, 0x10,
+        0x13, 0x9f, 0x42, 0x0e, 0x59, 0x0d, 0x22, 0x13, 0x2f, 0x32, 0x66, 0x1b, 0x6c, 0x0f, 0x7c, 0x52,
+        0x83, 0x5a, 0xb8, 0x32, 0x80, 0x94, 0xb9, 0x0a, 0x96, 0x9f, 0x80, 0x02, 0xac, 0x57, 0x9c, 0x46,
+        0x3a, 0x46, 0xf2, 0x56, 0x25, 0xdc, 0x0f, 0x6d, 0x26, 0xb2, 0xb8, 0xb2, 0x79, 0xa2, 0xb0, 0xd3,
+        0x30, 0x2b, 0x5c, 0x49, 0xc4, 0xd5, 0x21, 0xd8, 0xf2, 0x4e, 0xa5, 0xe7, 0xff, 0x16, 0xb8, 0xbf,
+        0x29, 0x7c, 0x65, 0x62, 0x0b, 0x77, 0x6d, 0x39, 0xdf, 0x67, 0x27, 0x3a, 0xb5, 0xe3, 0xf8, 0x0d,
+        0x95, 0x94, 0xc7, 0xad, 0x08, 0xde, 0xaf, 0x1e, 0x4c, 0xf7, 0x6a, 0x7c, 0x59, 0x7a, 0x75, 0x4b,
+        0xd4, 0x42, 0xd1, 0xf5, 0xb9, 0x00, 0x00, 0x00, 0xfe, 0xa7, 0x2f, 0x0a, 0x03, 0xc0, 0x37, 0x80,
+        0x28, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x00, 0xad, 0x5b, 0x3d, 0x26, 0xe0, 0x13, 0xff, 0x00,
+        0x2f, 0x5d, 0x00, 0x32, 0x08, 0x08, 0xa7, 0x24, 0x41, 0x0a, 0x70, 0xb1, 0x08, 0x4c, 0x1b, 0x2a,
+        0xc5, 0x71, 0x49, 0x36, 0xd5, 0xc0, 0x95, 0x7d, 0x6d, 0x81, 0xd9, 0x28, 0xbc, 0x38, 0x20, 0xdd,
+        0x6e, 0xd5, 0xfc, 0x58, 0x8d, 0xeb, 0x8c, 0x38, 0x08, 0xa0, 0xa6, 0x2a, 0x8e, 0x23, 0xc7, 0x62,
+        0x5c, 0x00, 0x00, 0x00, 0x3c, 0x5c, 0x63, 0xa4, 0x00, 0x02, 0x9f, 0x01, 0x80, 0x28, 0x4b, 0x80,
+        0x28, 0x00, 0x00, 0x00, 0x44, 0x87, 0xf4, 0x1a, 0x9b, 0xe3, 0x51, 0x40, 0x03, 0x00, 0x00, 0x00,
+        0x00, 0x01, 0x59, 0x5a,
+    };
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "a.tar.xz", .data = &xz_data });
+
+    for ([_]usize{ 1, 0 }) |threads| {
+        const file = try tmp_dir.dir.openFile("a.tar.xz", .{});
+        defer file.close();
+        const result = try verifyFile(allocator, file, .tar_xz, .{ .threads = threads });
+        try std.testing.expectEqual(@as(u64, 2), result.entries);
+        try std.testing.expectEqual(@as(u64, xz_data.len), result.archive_bytes);
+        try std.testing.expectEqual(@as(u64, 10240), result.stream_bytes);
+        try std.testing.expectEqual(@as(u64, if (threads == 1) 0 else 2), result.parallel_blocks);
+    }
+
+    // The first block's CRC32
+    xz_data[170] ^= 0x01;
+    try tmp_dir.dir.writeFile(.{ .sub_path = "bad.tar.xz", .data = &xz_data });
+    for ([_]usize{ 1, 2 }) |threads| {
+        const file = try tmp_dir.dir.openFile("bad.tar.xz", .{});
+        defer file.close();
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            verifyFile(allocator, file, .tar_xz, .{ .threads = threads }),
+        );
+    }
+}
@@ -20,6 +20,18 @@
 #include <string.h>
 #include <zlib.h>
 
+// windowBits for a format: 15 for zlib, 15+16 for gzip, -15 for raw deflate
+static int window_bits_for(CompressFormat format) {
+    switch (format) {
+    case COMPRESS_FORMAT_GZIP:
+        return 15 + 16;
+    case COMPRESS_FORMAT_RAW:
+        return -15;
+    default:
+        return 15;
+    }
+}
+
 CompressResult zlib_compress(CompressFormat format, const uint8_t *src, size_t src_len) {
     CompressResult result = {0};
 
@@ -53,8 +65,7 @@ CompressResult zlib_compress(CompressFormat format, const uint8_t *src, size_t s
     stream.avail_out = (uInt)((max_size > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uInt)max_size);
 
     // Initialize deflate
-    // windowBits: 15 for zlib, 15+16 for gzip
-    int window_bits = (format == COMPRESS_FORMAT_GZIP) ? (15 + 16) : 15;
+    int window_bits = window_bits_for(format);
     int ret = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
                           window_bits, 8, Z_DEFAULT_STRATEGY);
 
@@ -149,8 +160,7 @@ CompressResult zlib_decompress(CompressFormat format, const uint8_t *src, size_t
     stream.avail_out = (uInt)((initial_size > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uInt)initial_size);
 
     // Initialize inflate
-    // windowBits: 15 for zlib, 15+16 for gzip, 15+32 for auto-detect
-    int window_bits = (format == COMPRESS_FORMAT_GZIP) ? (15 + 16) : 15;
+    int window_bits = window_bits_for(format);
     int ret = inflateInit2(&stream, window_bits);
 
     if (ret != Z_OK) {
@@ -227,3 +237,137 @@ CompressResult zlib_decompress(CompressFormat format, const uint8_t *src, size_t
 void zlib_free(void *ptr) {
     free(ptr);
 }
+
+uint32_t zlib_crc32_update(uint32_t crc, const uint8_t *buf, size_t len) {
+    uLong value = crc;
+    // crc32() takes a uInt length; feed large buffers in 1 GiB pieces
+    while (len > 0) {
+        uInt n = (uInt)((len > (1u << 30)) ? (1u << 30) : len);
+        value = crc32(value, buf, n);
+        buf += n;
+        len -= n;
+    }
+    return (uint32_t)value;
+}
+
+struct ZlibInflater {
+    z_stream stream;
+};
+
+ZlibInflater *zlib_inflater_new(CompressFormat format) {
+    ZlibInflater *inf = (ZlibInflater *)calloc(1, sizeof(*inf));
+    if (!inf) {
+        return NULL;
+    }
+
+    if (inflateInit2(&inf->stream, window_bits_for(format)) != Z_OK) {
+        free(inf);
+        return NULL;
+    }
+
+    return inf;
+}
+
+int zlib_inflater_step(ZlibInflater *inf,
+                       const uint8_t *src, size_t src_len, size_t *src_used,
+                       uint8_t *dst, size_t dst_len, size_t *dst_written) {
+    z_stream *stream = &inf->stream;
+
+    // zlib uses uInt for buffer lengths; bound to 32-bit per step.
+    uInt in_len = (uInt)((src_len > 0xFFFFFFFFu) ? 0xFFFFFFFFu : src_len);
+    uInt out_len = (uInt)((dst_len > 0xFFFFFFFFu) ? 0xFFFFFFFFu : dst_len);
+
+    // Avoid passing NULL to zlib for empty input
+    stream->next_in = (Bytef *)((src_len == 0) ? (const uint8_t *)"" : src);
+    stream->avail_in = in_len;
+    stream->next_out = dst;
+    stream->avail_out = out_len;
+
+    int ret = inflate(stream, Z_NO_FLUSH);
+
+    *src_used = (size_t)(in_len - stream->avail_in);
+    *dst_written = (size_t)(out_len - stream->avail_out);
+
+    if (ret == Z_STREAM_END) return 1;
+    // Z_BUF_ERROR only means no progress was possible with these buffers
+    if (ret == Z_OK || ret == Z_BUF_ERROR) return 0;
+    // Preset dictionaries are not supported in archives
+    if (ret == Z_NEED_DICT) return Z_DATA_ERROR;
+    return ret;
+}
+
+int zlib_inflater_reset(ZlibInflater *inf) {
+    int ret = inflateReset(&inf->stream);
+    return (ret == Z_OK) ? 0 : ret;
+}
+
+void zlib_inflater_free(ZlibInflater *inf) {
+    if (!inf) {
+        return;
+    }
+    inflateEnd(&inf->stream);
+    free(inf);
+}
+
+struct ZlibDeflater {
+    z_stream stream;
+};
+
+ZlibDeflater *zlib_deflater_new(CompressFormat format, int level) {
+    ZlibDeflater *def = (ZlibDeflater *)calloc(1, sizeof(*def));
+    if (!def) {
+        return NULL;
+    }
+
+    if (deflateInit2(&def->stream, level, Z_DEFLATED, window_bits_for(format), 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(def);
+        return NULL;
+    }
+
+    return def;
+}
+
+size_t zlib_deflater_bound(ZlibDeflater *def, size_t src_len) {
+    // deflateBound takes a uLong, which is 32-bit on Windows
+    if (src_len > (size_t)(uLong)-1) {
+        return (size_t)-1;
+    }
+    return (size_t)deflateBound(&def->stream, (uLong)src_len);
+}
+
+int zlib_deflater_step(ZlibDeflater *def,
+                       const uint8_t *src, size_t src_len, size_t *src_used,
+                       uint8_t *dst, size_t dst_len, size_t *dst_written,
+                       int finish) {
+    z_stream *stream = &def->stream;
+
+    // zlib uses uInt for buffer lengths; bound to 32-bit per step.
+    uInt in_len = (uInt)((src_len > 0xFFFFFFFFu) ? 0xFFFFFFFFu : src_len);
+    uInt out_len = (uInt)((dst_len > 0xFFFFFFFFu) ? 0xFFFFFFFFu : dst_len);
+
+    // Avoid passing NULL to zlib for empty input
+    stream->next_in = (Bytef *)((src_len == 0) ? (const uint8_t *)"" : src);
+    stream->avail_in = in_len;
+    stream->next_out = dst;
+    stream->avail_out = out_len;
+
+    // Only the last chunk may finish, so all of it must be passed at once
+    int ret = deflate(stream, (finish && in_len == src_len) ? Z_FINISH : Z_NO_FLUSH);
+
+    *src_used = (size_t)(in_len - stream->avail_in);
+    *dst_written = (size_t)(out_len - stream->avail_out);
+
+    if (ret == Z_STREAM_END) return 1;
+    // Z_BUF_ERROR only means no progress was possible with these buffers
+    if (ret == Z_OK || ret == Z_BUF_ERROR) return 0;
+    return ret;
+}
+
+void zlib_deflater_free(ZlibDeflater *def) {
+    if (!def) {
+        return;
+    }
+    deflateEnd(&def->stream);
+    free(def);
+}
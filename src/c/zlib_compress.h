@@ -29,6 +29,7 @@ extern "C" {
 typedef enum {
     COMPRESS_FORMAT_GZIP = 0,
     COMPRESS_FORMAT_ZLIB = 1,
+    COMPRESS_FORMAT_RAW = 2,  // Raw deflate (no header or trailer, e.g. ZIP members)
 } CompressFormat;
 
 // Compression result
@@ -56,7 +57,7 @@ typedef struct {
 } CompressResult;
 
 // Compress data using zlib
-// format: COMPRESS_FORMAT_GZIP or COMPRESS_FORMAT_ZLIB
+// format: COMPRESS_FORMAT_GZIP, COMPRESS_FORMAT_ZLIB or COMPRESS_FORMAT_RAW
 // src: source data to compress
 // src_len: length of source data
 // Returns CompressResult with compressed data or error
@@ -64,7 +65,7 @@ typedef struct {
 CompressResult zlib_compress(CompressFormat format, const uint8_t *src, size_t src_len);
 
 // Decompress data using zlib
-// format: COMPRESS_FORMAT_GZIP or COMPRESS_FORMAT_ZLIB
+// format: COMPRESS_FORMAT_GZIP, COMPRESS_FORMAT_ZLIB or COMPRESS_FORMAT_RAW
 // src: compressed data to decompress
 // src_len: length of compressed data
 // Returns CompressResult with decompressed data or error
@@ -74,6 +75,70 @@ CompressResult zlib_decompress(CompressFormat format, const uint8_t *src, size_t
 // Free a buffer allocated by this library (FFI-safe).
 void zlib_free(void *ptr);
 
+// Update a CRC-32 (IEEE) with zlib's crc32 (braided, or ARMv8 CRC
+// instructions when zlib is built for them). Start with crc = 0.
+uint32_t zlib_crc32_update(uint32_t crc, const uint8_t *buf, size_t len);
+
+// Streaming inflater
+//
+// Unlike zlib_decompress, the caller feeds input and drains output in
+// bounded chunks, so memory stays constant and every step reports exactly
+// how many compressed bytes were consumed.
+typedef struct ZlibInflater ZlibInflater;
+
+// Create an inflater for the given format
+// Returns NULL on allocation or initialization failure
+ZlibInflater *zlib_inflater_new(CompressFormat format);
+
+// Run one inflate step
+// src/src_len: available compressed input (may be empty)
+// src_used: set to the number of input bytes consumed
+// dst/dst_len: output buffer
+// dst_written: set to the number of bytes produced
+// Returns 0 = progress (call again), 1 = end of stream/member,
+// or a negative zlib error code (Z_DATA_ERROR = -3 for corrupt data)
+int zlib_inflater_step(ZlibInflater *inf,
+                       const uint8_t *src, size_t src_len, size_t *src_used,
+                       uint8_t *dst, size_t dst_len, size_t *dst_written);
+
+// Reset after end of stream to decode a following gzip member
+// Returns 0 on success or a negative zlib error code
+int zlib_inflater_reset(ZlibInflater *inf);
+
+// Release an inflater (NULL is ignored)
+void zlib_inflater_free(ZlibInflater *inf);
+
+// Streaming deflater
+//
+// Counterpart of ZlibInflater: the caller feeds input and provides the
+// output buffer, so compressed bytes can go straight into memory the
+// caller sized with zlib_deflater_bound.
+typedef struct ZlibDeflater ZlibDeflater;
+
+// Create a deflater for the given format and level (0-9, -1 = default)
+// Returns NULL on allocation or initialization failure
+ZlibDeflater *zlib_deflater_new(CompressFormat format, int level);
+
+// Upper bound of the complete output (including the gzip/zlib wrapper)
+// for src_len bytes of input
+size_t zlib_deflater_bound(ZlibDeflater *def, size_t src_len);
+
+// Run one deflate step
+// src/src_len: next input bytes (may be empty)
+// src_used: set to the number of input bytes consumed
+// dst/dst_len: output buffer
+// dst_written: set to the number of bytes produced
+// finish: non-zero when src holds the last input bytes
+// Returns 0 = progress (call again), 1 = stream finished,
+// or a negative zlib error code
+int zlib_deflater_step(ZlibDeflater *def,
+                       const uint8_t *src, size_t src_len, size_t *src_used,
+                       uint8_t *dst, size_t dst_len, size_t *dst_written,
+                       int finish);
+
+// Release a deflater (NULL is ignored)
+void zlib_deflater_free(ZlibDeflater *def);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
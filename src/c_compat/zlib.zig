@@ -38,6 +38,8 @@ pub const Format = enum(c_int) {
     gzip = 0,
     /// Zlib format (RFC 1950)
     zlib = 1,
+    /// Raw deflate (RFC 1951), no header or trailer (ZIP members)
+    raw = 2,
 };
 
 /// C compression result structure
@@ -60,6 +62,27 @@ extern "c" fn zlib_decompress(format: Format, src: [*]const u8, src_len: usize)
 /// Implemented in src/c/zlib_compress.c
 extern "c" fn zlib_free(ptr: ?*anyopaque) void;
 
+/// External C function for zlib's crc32
+/// Implemented in src/c/zlib_compress.c
+extern "c" fn zlib_crc32_update(crc: u32, buf: [*]const u8, len: usize) u32;
+
+/// Update a CRC-32 (IEEE 802.3) with zlib's implementation
+///
+/// zlib's braided CRC is several times faster than a byte-at-a-time
+/// table, and uses the ARMv8 CRC instructions when zlib is built for
+/// them. Start with 0; the result needs no final XOR.
+///
+/// Example:
+/// ```zig
+/// var crc: u32 = 0;
+/// crc = crc32Update(crc, "Hello, ");
+/// crc = crc32Update(crc, "World!");
+/// ```
+pub fn crc32Update(crc: u32, data: []const u8) u32 {
+    if (data.len == 0) return crc;
+    return zlib_crc32_update(crc, data.ptr, data.len);
+}
+
 /// Compress data using zlib (via C implementation)
 ///
 /// This function wraps the zlib C library for compression operations.
@@ -165,6 +188,190 @@ pub fn decompress(allocator: std.mem.Allocator, format: Format, data: []const u8
     return decompressed;
 }
 
+/// Opaque C inflater handle (struct ZlibInflater)
+const CInflater = opaque {};
+
+extern "c" fn zlib_inflater_new(format: Format) ?*CInflater;
+extern "c" fn zlib_inflater_step(
+    inf: *CInflater,
+    src: [*]const u8,
+    src_len: usize,
+    src_used: *usize,
+    dst: [*]u8,
+    dst_len: usize,
+    dst_written: *usize,
+) c_int;
+extern "c" fn zlib_inflater_reset(inf: *CInflater) c_int;
+extern "c" fn zlib_inflater_free(inf: ?*CInflater) void;
+
+/// Streaming inflater (via C implementation)
+///
+/// Decompresses in caller-sized chunks with constant memory, reporting
+/// the exact number of compressed bytes consumed by each step.
+///
+/// Example:
+/// ```zig
+/// var inf = try Inflater.init(.gzip);
+/// defer inf.deinit();
+///
+/// const step = try inf.step(compressed[pos..], &out_buf);
+/// pos += step.consumed;
+/// // out_buf[0..step.produced] holds decompressed bytes
+/// ```
+pub const Inflater = struct {
+    handle: *CInflater,
+
+    /// Outcome of a single inflate step
+    pub const Step = struct {
+        /// Compressed bytes consumed from the input slice
+        consumed: usize,
+        /// Decompressed bytes written to the output slice
+        produced: usize,
+        /// End of the compressed stream (or gzip member) was reached
+        stream_end: bool,
+    };
+
+    /// Create an inflater
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: zlib state could not be allocated
+    pub fn init(format: Format) !Inflater {
+        return .{ .handle = zlib_inflater_new(format) orelse return error.OutOfMemory };
+    }
+
+    /// Release zlib state
+    pub fn deinit(self: *Inflater) void {
+        zlib_inflater_free(self.handle);
+    }
+
+    /// Run one inflate step
+    ///
+    /// Parameters:
+    ///   - src: Available compressed input (may be empty)
+    ///   - dst: Output buffer
+    ///
+    /// Errors:
+    ///   - error.ChecksumMismatch: Corrupted data or CRC/Adler32 mismatch
+    ///   - error.DecompressionFailed: Other zlib failure
+    pub fn step(self: *Inflater, src: []const u8, dst: []u8) !Step {
+        var used: usize = 0;
+        var written: usize = 0;
+        const rc = zlib_inflater_step(self.handle, src.ptr, src.len, &used, dst.ptr, dst.len, &written);
+        if (rc < 0) {
+            // Z_DATA_ERROR (-3) indicates corrupted data or checksum mismatch
+            if (rc == -3) return error.ChecksumMismatch;
+            return error.DecompressionFailed;
+        }
+        return .{ .consumed = used, .produced = written, .stream_end = rc == 1 };
+    }
+
+    /// Prepare to decode the next gzip member after `stream_end`
+    pub fn reset(self: *Inflater) !void {
+        if (zlib_inflater_reset(self.handle) != 0) return error.DecompressionFailed;
+    }
+};
+
+/// Opaque C deflater handle (struct ZlibDeflater)
+const CDeflater = opaque {};
+
+extern "c" fn zlib_deflater_new(format: Format, level: c_int) ?*CDeflater;
+extern "c" fn zlib_deflater_bound(def: *CDeflater, src_len: usize) usize;
+extern "c" fn zlib_deflater_step(
+    def: *CDeflater,
+    src: [*]const u8,
+    src_len: usize,
+    src_used: *usize,
+    dst: [*]u8,
+    dst_len: usize,
+    dst_written: *usize,
+    finish: c_int,
+) c_int;
+extern "c" fn zlib_deflater_free(def: ?*CDeflater) void;
+
+/// Streaming deflater (via C implementation)
+///
+/// Compresses into caller-provided output, so a buffer sized once with
+/// bound() can receive a whole stream fed in pieces.
+///
+/// Example:
+/// ```zig
+/// var def = try Deflater.init(.gzip, 6);
+/// defer def.deinit();
+///
+/// const step = try def.step(input, out_buf, true);
+/// // out_buf[0..step.produced] holds compressed bytes
+/// ```
+pub const Deflater = struct {
+    handle: *CDeflater,
+
+    /// Outcome of a single deflate step
+    pub const Step = struct {
+        /// Input bytes consumed from the input slice
+        consumed: usize,
+        /// Compressed bytes written to the output slice
+        produced: usize,
+        /// The stream (including its trailer) is complete
+        stream_end: bool,
+    };
+
+    /// Create a deflater
+    ///
+    /// Parameters:
+    ///   - format: Output wrapper (gzip, zlib or raw deflate)
+    ///   - level: Compression level 0-9, or -1 for zlib's default
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: zlib state could not be allocated
+    pub fn init(format: Format, level: i8) !Deflater {
+        return .{ .handle = zlib_deflater_new(format, level) orelse return error.OutOfMemory };
+    }
+
+    /// Release zlib state
+    pub fn deinit(self: *Deflater) void {
+        zlib_deflater_free(self.handle);
+    }
+
+    /// Upper bound of the complete output for `src_len` input bytes
+    pub fn bound(self: *Deflater, src_len: usize) usize {
+        return zlib_deflater_bound(self.handle, src_len);
+    }
+
+    /// Run one deflate step
+    ///
+    /// Parameters:
+    ///   - src: Next input bytes (may be empty)
+    ///   - dst: Output buffer
+    ///   - finish: `src` holds the last input bytes
+    ///
+    /// Errors:
+    ///   - error.CompressionFailed: zlib reported an error
+    pub fn step(self: *Deflater, src: []const u8, dst: []u8, finish: bool) !Step {
+        var used: usize = 0;
+        var written: usize = 0;
+        const rc = zlib_deflater_step(self.handle, src.ptr, src.len, &used, dst.ptr, dst.len, &written, @intFromBool(finish));
+        if (rc < 0) return error.CompressionFailed;
+        return .{ .consumed = used, .produced = written, .stream_end = rc == 1 };
+    }
+};
+
+test "crc32Update: matches the check value and is incremental" {
+    try std.testing.expectEqual(@as(u32, 0xCBF43926), crc32Update(0, "123456789"));
+    try std.testing.expectEqual(@as(u32, 0xCBF43926), crc32Update(crc32Update(0, "1234"), "56789"));
+    try std.testing.expectEqual(@as(u32, 0), crc32Update(0, ""));
+}
+
+test "compress/decompress raw deflate" {
+    const allocator = std.testing.allocator;
+    const original = "raw deflate raw deflate raw deflate";
+
+    const compressed = try compress(allocator, .raw, original);
+    defer allocator.free(compressed);
+
+    const decompressed = try decompress(allocator, .raw, compressed);
+    defer allocator.free(decompressed);
+    try std.testing.expectEqualStrings(original, decompressed);
+}
+
 test "compress gzip format" {
     const allocator = std.testing.allocator;
     const original = "Hello, World! This is a test of gzip compression.";
@@ -209,3 +416,58 @@ test "compress empty data" {
     try std.testing.expectEqual(@as(u8, 0x1f), compressed[0]);
     try std.testing.expectEqual(@as(u8, 0x8b), compressed[1]);
 }
+
+test "Inflater: streams with bounded buffers" {
+    const allocator = std.testing.allocator;
+
+    var original: [100_000]u8 = undefined;
+    for (&original, 0..) |*b, i| b.* = @truncate(i % 251);
+
+    const compressed = try compress(allocator, .gzip, &original);
+    defer allocator.free(compressed);
+
+    var inf = try Inflater.init(.gzip);
+    defer inf.deinit();
+
+    var out: [4096]u8 = undefined;
+    var in_pos: usize = 0;
+    var out_pos: usize = 0;
+    while (true) {
+        const end = @min(in_pos + 1000, compressed.len);
+        const s = try inf.step(compressed[in_pos..end], &out);
+        try std.testing.expectEqualSlices(u8, original[out_pos..][0..s.produced], out[0..s.produced]);
+        in_pos += s.consumed;
+        out_pos += s.produced;
+        if (s.stream_end) break;
+    }
+
+    try std.testing.expectEqual(compressed.len, in_pos);
+    try std.testing.expectEqual(original.len, out_pos);
+}
+
+test "Deflater: fills a buffer sized by bound()" {
+    const allocator = std.testing.allocator;
+
+    var original: [100_000]u8 = undefined;
+    for (&original, 0..) |*b, i| b.* = @truncate(i % 251);
+
+    var def = try Deflater.init(.gzip, -1);
+    defer def.deinit();
+
+    const out = try allocator.alloc(u8, def.bound(original.len));
+    defer allocator.free(out);
+
+    var in_pos: usize = 0;
+    var out_pos: usize = 0;
+    while (true) {
+        const end = @min(in_pos + 1000, original.len);
+        const s = try def.step(original[in_pos..end], out[out_pos..], end == original.len);
+        in_pos += s.consumed;
+        out_pos += s.produced;
+        if (s.stream_end) break;
+    }
+
+    const decompressed = try decompress(allocator, .gzip, out[0..out_pos]);
+    defer allocator.free(decompressed);
+    try std.testing.expectEqualSlices(u8, &original, decompressed);
+}
@@ -16,6 +16,8 @@
 const std = @import("std");
 const app = @import("../app/extract.zig");
 const security = @import("../app/security.zig");
+const list = @import("../app/list.zig");
+const verify = @import("../app/verify.zig");
 const output = @import("output.zig");
 
 /// Subcommand type
@@ -82,6 +84,15 @@ pub const GlobalOptions = struct {
     }
 };
 
+/// Format of the `--stats` report
+pub const StatsFormat = enum {
+    /// Per-phase table on stderr
+    text,
+
+    /// One JSON object on stderr
+    json,
+};
+
 /// Extract command arguments
 pub const ExtractArgs = struct {
     archive_path: []const u8,
@@ -89,6 +100,18 @@ pub const ExtractArgs = struct {
     options: app.ExtractOptions = .{},
     global: GlobalOptions = .{},
 
+    /// Print a timing breakdown after extraction (`--stats[=json]`)
+    stats: ?StatsFormat = null,
+
+    /// Write a Chrome trace of the extraction (`--trace=<file>`)
+    trace_path: ?[]const u8 = null,
+
+    /// `--include` patterns (allocated; the strings point into argv)
+    include_patterns: []const []const u8 = &.{},
+
+    /// `--exclude` patterns (allocated; the strings point into argv)
+    exclude_patterns: []const []const u8 = &.{},
+
     /// Convert to ExtractOptions
     pub fn toExtractOptions(self: ExtractArgs) app.ExtractOptions {
         var opts = self.options;
@@ -104,17 +127,29 @@ pub const CompressArgs = struct {
     global: GlobalOptions = .{},
 };
 
-/// List command arguments (placeholder for future implementation)
+/// List command arguments
 pub const ListArgs = struct {
     archive_path: []const u8,
+    options: list.ListOptions = .{},
     global: GlobalOptions = .{},
 };
 
+/// Test command arguments
+pub const TestArgs = struct {
+    archive_path: []const u8,
+    options: verify.VerifyOptions = .{},
+    global: GlobalOptions = .{},
+
+    /// Write a Chrome trace of the verification (`--trace=<file>`)
+    trace_path: ?[]const u8 = null,
+};
+
 /// Parsed command-line arguments
 pub const ParsedArgs = union(enum) {
     extract: ExtractArgs,
     compress: CompressArgs,
     list: ListArgs,
+    test_archive: TestArgs,
     help: ?[]const u8, // Optional subcommand to show help for
     version: void,
     invalid: []const u8, // Error message
@@ -122,6 +157,10 @@ pub const ParsedArgs = union(enum) {
     pub fn deinit(self: ParsedArgs, allocator: std.mem.Allocator) void {
         switch (self) {
             .invalid => |msg| allocator.free(msg),
+            .extract => |extract_args| {
+                allocator.free(extract_args.include_patterns);
+                allocator.free(extract_args.exclude_patterns);
+            },
             else => {},
         }
     }
@@ -146,6 +185,8 @@ pub fn parseArgs(allocator: std.mem.Allocator, args: []const []const u8) !Parsed
 
     return switch (subcommand) {
         .extract => try parseExtractArgs(allocator, args[1..]),
+        .list => try parseListArgs(allocator, args[1..]),
+        .test_archive => try parseTestArgs(allocator, args[1..]),
         .help => .{ .help = if (args.len > 1) args[1] else null },
         .version => .version,
         else => {
@@ -165,6 +206,11 @@ fn parseExtractArgs(allocator: std.mem.Allocator, args: []const []const u8) !Par
         .archive_path = undefined,
     };
 
+    var includes: std.ArrayListUnmanaged([]const u8) = .{};
+    defer includes.deinit(allocator);
+    var excludes: std.ArrayListUnmanaged([]const u8) = .{};
+    defer excludes.deinit(allocator);
+
     var positional_index: usize = 0;
     var i: usize = 0;
 
@@ -185,8 +231,18 @@ fn parseExtractArgs(allocator: std.mem.Allocator, args: []const []const u8) !Par
                 extract_args.options.preserve_permissions = true;
             } else if (std.mem.eql(u8, arg, "--no-preserve-permissions")) {
                 extract_args.options.preserve_permissions = false;
+            } else if (std.mem.eql(u8, arg, "--xattrs")) {
+                extract_args.options.preserve_xattrs = true;
+            } else if (std.mem.eql(u8, arg, "--no-xattrs")) {
+                extract_args.options.preserve_xattrs = false;
             } else if (std.mem.eql(u8, arg, "--continue-on-error")) {
                 extract_args.options.continue_on_error = true;
+            } else if (std.mem.eql(u8, arg, "--stats") or std.mem.eql(u8, arg, "--stats=text")) {
+                extract_args.stats = .text;
+            } else if (std.mem.eql(u8, arg, "--stats=json")) {
+                extract_args.stats = .json;
+            } else if (std.mem.startsWith(u8, arg, "--trace=") and arg.len > "--trace=".len) {
+                extract_args.trace_path = arg["--trace=".len..];
             } else if (std.mem.eql(u8, arg, "--no-color")) {
                 extract_args.global.color_mode = .never;
             } else if (std.mem.eql(u8, arg, "-C") or std.mem.eql(u8, arg, "--output")) {
@@ -201,6 +257,23 @@ fn parseExtractArgs(allocator: std.mem.Allocator, args: []const []const u8) !Par
                     return .{ .invalid = msg };
                 }
                 extract_args.destination = args[i];
+            } else if (std.mem.eql(u8, arg, "--include") or std.mem.eql(u8, arg, "--exclude")) {
+                // Next argument is the pattern
+                i += 1;
+                if (i >= args.len) {
+                    const msg = try std.fmt.allocPrint(
+                        allocator,
+                        "Option '{s}' requires an argument",
+                        .{arg},
+                    );
+                    return .{ .invalid = msg };
+                }
+                const patterns = if (std.mem.eql(u8, arg, "--include")) &includes else &excludes;
+                try patterns.append(allocator, args[i]);
+            } else if (std.mem.startsWith(u8, arg, "--include=")) {
+                try includes.append(allocator, arg["--include=".len..]);
+            } else if (std.mem.startsWith(u8, arg, "--exclude=")) {
+                try excludes.append(allocator, arg["--exclude=".len..]);
             } else if (std.mem.eql(u8, arg, "-h") or std.mem.eql(u8, arg, "--help")) {
                 return .{ .help = "extract" };
             } else {
@@ -243,9 +316,159 @@ fn parseExtractArgs(allocator: std.mem.Allocator, args: []const []const u8) !Par
     // Update output level based on flags
     extract_args.global.updateOutputLevel();
 
+    extract_args.include_patterns = try includes.toOwnedSlice(allocator);
+    errdefer allocator.free(extract_args.include_patterns);
+    extract_args.exclude_patterns = try excludes.toOwnedSlice(allocator);
+
     return .{ .extract = extract_args };
 }
 
+/// Parse list command arguments
+fn parseListArgs(allocator: std.mem.Allocator, args: []const []const u8) !ParsedArgs {
+    var list_args = ListArgs{
+        .archive_path = undefined,
+    };
+
+    var has_archive = false;
+
+    for (args) |arg| {
+        // Check for options
+        if (std.mem.startsWith(u8, arg, "-") and arg.len > 1) {
+            if (std.mem.eql(u8, arg, "-v") or std.mem.eql(u8, arg, "--verbose")) {
+                list_args.global.verbose = true;
+                list_args.options.format = .long;
+            } else if (std.mem.eql(u8, arg, "-q") or std.mem.eql(u8, arg, "--quiet")) {
+                list_args.global.quiet = true;
+            } else if (std.mem.eql(u8, arg, "-l") or std.mem.eql(u8, arg, "--long")) {
+                list_args.options.format = .long;
+            } else if (std.mem.eql(u8, arg, "-h") or std.mem.eql(u8, arg, "--human-readable")) {
+                // -h means human-readable here, as in ls; use --help for help
+                list_args.options.human_readable = true;
+            } else if (std.mem.eql(u8, arg, "-lh") or std.mem.eql(u8, arg, "-hl")) {
+                list_args.options.format = .long;
+                list_args.options.human_readable = true;
+            } else if (std.mem.eql(u8, arg, "--json")) {
+                list_args.options.format = .json;
+            } else if (std.mem.eql(u8, arg, "-0") or std.mem.eql(u8, arg, "--null")) {
+                list_args.options.format = .null_delimited;
+            } else if (std.mem.eql(u8, arg, "--no-color")) {
+                list_args.global.color_mode = .never;
+            } else if (std.mem.eql(u8, arg, "--help")) {
+                return .{ .help = "list" };
+            } else {
+                const msg = try std.fmt.allocPrint(
+                    allocator,
+                    "Unknown option: '{s}'",
+                    .{arg},
+                );
+                return .{ .invalid = msg };
+            }
+        } else if (!has_archive) {
+            list_args.archive_path = arg;
+            has_archive = true;
+        } else {
+            const msg = try std.fmt.allocPrint(
+                allocator,
+                "Too many arguments. Expected archive path, got extra: '{s}'",
+                .{arg},
+            );
+            return .{ .invalid = msg };
+        }
+    }
+
+    if (!has_archive) {
+        const msg = try std.fmt.allocPrint(
+            allocator,
+            "Missing required argument: <archive>",
+            .{},
+        );
+        return .{ .invalid = msg };
+    }
+
+    list_args.global.updateOutputLevel();
+
+    return .{ .list = list_args };
+}
+
+/// Parse test command arguments
+fn parseTestArgs(allocator: std.mem.Allocator, args: []const []const u8) !ParsedArgs {
+    var test_args = TestArgs{
+        .archive_path = undefined,
+    };
+
+    var has_archive = false;
+    var i: usize = 0;
+
+    while (i < args.len) : (i += 1) {
+        const arg = args[i];
+
+        // Check for options
+        if (std.mem.startsWith(u8, arg, "-") and arg.len > 1) {
+            if (std.mem.eql(u8, arg, "-v") or std.mem.eql(u8, arg, "--verbose")) {
+                test_args.global.verbose = true;
+                test_args.options.verbose = true;
+            } else if (std.mem.eql(u8, arg, "-q") or std.mem.eql(u8, arg, "--quiet")) {
+                test_args.global.quiet = true;
+            } else if (std.mem.eql(u8, arg, "-j") or std.mem.eql(u8, arg, "--threads")) {
+                // Next argument is the thread count
+                i += 1;
+                if (i >= args.len) {
+                    const msg = try std.fmt.allocPrint(
+                        allocator,
+                        "Option '{s}' requires an argument",
+                        .{arg},
+                    );
+                    return .{ .invalid = msg };
+                }
+                test_args.options.threads = std.fmt.parseInt(usize, args[i], 10) catch {
+                    const msg = try std.fmt.allocPrint(
+                        allocator,
+                        "Invalid thread count: '{s}'",
+                        .{args[i]},
+                    );
+                    return .{ .invalid = msg };
+                };
+            } else if (std.mem.startsWith(u8, arg, "--trace=") and arg.len > "--trace=".len) {
+                test_args.trace_path = arg["--trace=".len..];
+            } else if (std.mem.eql(u8, arg, "--no-color")) {
+                test_args.global.color_mode = .never;
+            } else if (std.mem.eql(u8, arg, "-h") or std.mem.eql(u8, arg, "--help")) {
+                return .{ .help = "test" };
+            } else {
+                const msg = try std.fmt.allocPrint(
+                    allocator,
+                    "Unknown option: '{s}'",
+                    .{arg},
+                );
+                return .{ .invalid = msg };
+            }
+        } else if (!has_archive) {
+            test_args.archive_path = arg;
+            has_archive = true;
+        } else {
+            const msg = try std.fmt.allocPrint(
+                allocator,
+                "Too many arguments. Expected archive path, got extra: '{s}'",
+                .{arg},
+            );
+            return .{ .invalid = msg };
+        }
+    }
+
+    if (!has_archive) {
+        const msg = try std.fmt.allocPrint(
+            allocator,
+            "Missing required argument: <archive>",
+            .{},
+        );
+        return .{ .invalid = msg };
+    }
+
+    test_args.global.updateOutputLevel();
+
+    return .{ .test_archive = test_args };
+}
+
 // Tests
 test "Subcommand: fromString with primary names" {
     try std.testing.expectEqual(Subcommand.extract, Subcommand.fromString("extract").?);
@@ -314,6 +537,32 @@ test "parseArgs: extract with all options" {
     }
 }
 
+test "parseArgs: extract with include and exclude patterns" {
+    const allocator = std.testing.allocator;
+    const args = [_][]const u8{
+        "extract",
+        "--include",
+        "src/**",
+        "--include=docs",
+        "--exclude=*.o",
+        "archive.tar",
+    };
+
+    const parsed = try parseArgs(allocator, &args);
+    defer parsed.deinit(allocator);
+
+    switch (parsed) {
+        .extract => |extract_args| {
+            try std.testing.expectEqual(@as(usize, 2), extract_args.include_patterns.len);
+            try std.testing.expectEqualStrings("src/**", extract_args.include_patterns[0]);
+            try std.testing.expectEqualStrings("docs", extract_args.include_patterns[1]);
+            try std.testing.expectEqual(@as(usize, 1), extract_args.exclude_patterns.len);
+            try std.testing.expectEqualStrings("*.o", extract_args.exclude_patterns[0]);
+        },
+        else => try std.testing.expect(false),
+    }
+}
+
 test "parseArgs: extract with positional destination" {
     const allocator = std.testing.allocator;
     const args = [_][]const u8{ "extract", "archive.tar.gz", "/dest" };
@@ -398,3 +647,114 @@ test "parseArgs: missing archive path" {
         else => try std.testing.expect(false),
     }
 }
+
+test "parseArgs: list formats" {
+    const allocator = std.testing.allocator;
+
+    {
+        const args = [_][]const u8{ "list", "archive.tar" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqualStrings("archive.tar", parsed.list.archive_path);
+        try std.testing.expectEqual(list.ListFormat.names, parsed.list.options.format);
+    }
+
+    {
+        const args = [_][]const u8{ "ls", "-lh", "archive.tar" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqual(list.ListFormat.long, parsed.list.options.format);
+        try std.testing.expect(parsed.list.options.human_readable);
+    }
+
+    {
+        const args = [_][]const u8{ "l", "archive.tar", "--json" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqual(list.ListFormat.json, parsed.list.options.format);
+    }
+
+    {
+        const args = [_][]const u8{ "list", "-0", "archive.tar" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqual(list.ListFormat.null_delimited, parsed.list.options.format);
+    }
+
+    {
+        const args = [_][]const u8{"list"};
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expect(parsed == .invalid);
+    }
+}
+
+test "parseArgs: test command" {
+    const allocator = std.testing.allocator;
+
+    {
+        const args = [_][]const u8{ "test", "-j", "4", "-v", "archive.tar.gz" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqualStrings("archive.tar.gz", parsed.test_archive.archive_path);
+        try std.testing.expectEqual(@as(usize, 4), parsed.test_archive.options.threads);
+        try std.testing.expect(parsed.test_archive.options.verbose);
+    }
+
+    {
+        const args = [_][]const u8{ "t", "archive.tar", "--threads", "many" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expect(parsed == .invalid);
+    }
+}
+
+test "parseArgs: extract --stats" {
+    const allocator = std.testing.allocator;
+
+    {
+        const args = [_][]const u8{ "extract", "--stats", "archive.tar" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqual(@as(?StatsFormat, .text), parsed.extract.stats);
+    }
+
+    {
+        const args = [_][]const u8{ "x", "archive.tar", "--stats=json" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqual(@as(?StatsFormat, .json), parsed.extract.stats);
+    }
+
+    {
+        const args = [_][]const u8{ "extract", "--stats=yaml", "archive.tar" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expect(parsed == .invalid);
+    }
+}
+
+test "parseArgs: --trace" {
+    const allocator = std.testing.allocator;
+
+    {
+        const args = [_][]const u8{ "extract", "--trace=out.json", "archive.tar" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqualStrings("out.json", parsed.extract.trace_path.?);
+    }
+
+    {
+        const args = [_][]const u8{ "test", "archive.tar.gz", "--trace=t.json" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expectEqualStrings("t.json", parsed.test_archive.trace_path.?);
+    }
+
+    {
+        const args = [_][]const u8{ "extract", "--trace=", "archive.tar" };
+        const parsed = try parseArgs(allocator, &args);
+        defer parsed.deinit(allocator);
+        try std.testing.expect(parsed == .invalid);
+    }
+}
@@ -15,14 +15,40 @@
 
 const std = @import("std");
 const app = @import("../app/extract.zig");
-const formats = @import("../formats/archive.zig");
-const tar = @import("../formats/tar/reader.zig");
+const list = @import("../app/list.zig");
+const verify = @import("../app/verify.zig");
+const security = @import("../app/security.zig");
+const detect = @import("../formats/detect.zig");
+const types = @import("../core/types.zig");
+const util = @import("../core/util.zig");
+const instrument = @import("../core/instrument.zig");
+const trace = @import("../core/trace.zig");
+const open = @import("../app/open.zig");
+const filter_mod = @import("../app/filter.zig");
 const args_mod = @import("args.zig");
 const output = @import("output.zig");
 const progress_mod = @import("progress.zig");
 
 const version = "0.1.0";
 
+/// Map an archive read error to a CLI exit code
+fn readErrorExitCode(err: anyerror) u8 {
+    return switch (err) {
+        error.FileNotFound => 3,
+        error.AccessDenied, error.PermissionDenied => 4,
+        error.CorruptedArchive,
+        error.CorruptedHeader,
+        error.InvalidFormat,
+        error.IncompleteArchive,
+        error.CorruptedStream,
+        error.ChecksumMismatch,
+        error.DecompressionFailed,
+        => 5,
+        error.UnsupportedVersion, error.UnsupportedFormat, error.UnsupportedMethod => 6,
+        else => 1,
+    };
+}
+
 /// Run extract command
 pub fn runExtract(
     allocator: std.mem.Allocator,
@@ -57,31 +83,53 @@ pub fn runExtract(
 
     try out.printInfo("Extracting {s}...", .{extract_args.archive_path});
 
+    instrument.reset();
+    if (extract_args.trace_path != null) try trace.start();
+    defer if (extract_args.trace_path) |path| saveTrace(err_out, path);
+
     const start_time = std.time.nanoTimestamp();
 
-    // Create tar reader
-    var tar_reader = try tar.TarReader.init(allocator, archive_file);
-    defer tar_reader.deinit();
+    var extract_options = extract_args.toExtractOptions();
 
-    var archive_reader = tar_reader.archiveReader();
-    defer archive_reader.deinit();
+    // Patterns are compiled once, before the first entry is read
+    var filter: ?filter_mod.PathFilter = null;
+    defer if (filter) |*f| f.deinit();
+    if (extract_args.include_patterns.len > 0 or extract_args.exclude_patterns.len > 0) {
+        filter = try filter_mod.PathFilter.init(
+            allocator,
+            extract_args.include_patterns,
+            extract_args.exclude_patterns,
+        );
+        extract_options.filter = &filter.?;
+    }
 
-    // Extract archive
-    const extract_options = extract_args.toExtractOptions();
-    var result = app.extractArchive(
-        allocator,
-        &archive_reader,
-        extract_args.destination,
-        extract_options,
-    ) catch |err| {
+    // Compressed streams report real byte counts to this monitor, which
+    // aborts decompression as soon as the policy ratio/size is exceeded
+    var monitor = security.RatioMonitor.init(extract_options.security_policy);
+
+    const format = detect.detectFormat(allocator, extract_args.archive_path) catch .unknown;
+
+    var opened = open.openArchive(allocator, archive_file, format, .{ .observer = monitor.observer() }) catch |err| {
+        if (err == error.UnsupportedFormat) {
+            try err_out.printError("Unsupported archive format: {s}", .{@tagName(format)});
+        } else {
+            try err_out.printError("Cannot read archive: {s}", .{@errorName(err)});
+        }
+        return readErrorExitCode(err);
+    };
+    defer opened.deinit();
+
+    // Extract archive; one specialized copy loop per reader type
+    var result = switch (opened) {
+        inline else => |*concrete| app.extractArchive(
+            allocator,
+            concrete,
+            extract_args.destination,
+            extract_options,
+        ),
+    } catch |err| {
         try err_out.printError("Extraction failed: {s}", .{@errorName(err)});
-        return switch (err) {
-            error.FileNotFound => 3,
-            error.AccessDenied, error.PermissionDenied => 4,
-            error.CorruptedArchive, error.CorruptedHeader, error.InvalidFormat => 5,
-            error.UnsupportedVersion => 6,
-            else => 1,
-        };
+        return readErrorExitCode(err);
     };
     defer result.deinit(allocator);
 
@@ -102,6 +150,10 @@ pub fn runExtract(
         );
     }
 
+    if (extract_args.stats) |stats_format| {
+        try printStats(stderr_file, stats_format, duration, result.total_bytes);
+    }
+
     // Print warnings
     if (result.warnings.items.len > 0) {
         try err_out.printWarning("{d} warnings occurred:", .{result.warnings.items.len});
@@ -119,11 +171,190 @@ pub fn runExtract(
     return 0;
 }
 
+/// Print the `--stats` breakdown to stderr
+fn printStats(file: std.fs.File, format: args_mod.StatsFormat, elapsed_ns: u64, payload_bytes: u64) !void {
+    var buffered = std.io.bufferedWriter(file.writer());
+    const snapshot = instrument.snapshot();
+    switch (format) {
+        .text => try snapshot.writeText(buffered.writer(), elapsed_ns, payload_bytes),
+        .json => try snapshot.writeJson(buffered.writer(), elapsed_ns, payload_bytes),
+    }
+    try buffered.flush();
+}
+
+/// Write the recorded `--trace` timeline and stop tracing
+///
+/// Failing to write the trace only warns; it never changes the exit code.
+fn saveTrace(err_out: output.OutputWriter, path: []const u8) void {
+    defer trace.stop();
+
+    writeTraceFile(path) catch |err| {
+        err_out.printWarning("Cannot write trace '{s}': {s}", .{ path, @errorName(err) }) catch {};
+    };
+}
+
+fn writeTraceFile(path: []const u8) !void {
+    const file = try std.fs.cwd().createFile(path, .{});
+    defer file.close();
+
+    var buffered = std.io.bufferedWriter(file.writer());
+    try trace.writeJson(buffered.writer());
+    try buffered.flush();
+}
+
+/// Run list command
+///
+/// Entries are formatted straight into one buffered stdout writer; entry
+/// data is skipped (seeked over for plain tar) rather than read.
+pub fn runList(
+    allocator: std.mem.Allocator,
+    list_args: args_mod.ListArgs,
+) !u8 {
+    const stdout_file = std.io.getStdOut();
+    const stderr_file = std.io.getStdErr();
+
+    var err_out = output.OutputWriter.init(
+        stderr_file,
+        list_args.global.output_level,
+        list_args.global.color_mode,
+    );
+
+    // Open archive file
+    const archive_file = std.fs.cwd().openFile(list_args.archive_path, .{}) catch |err| {
+        try err_out.printError("Cannot open archive file '{s}'", .{list_args.archive_path});
+        try err_out.printError("Reason: {s}", .{@errorName(err)});
+        return switch (err) {
+            error.FileNotFound => 3,
+            error.AccessDenied => 4,
+            else => 1,
+        };
+    };
+    defer archive_file.close();
+
+    // Listing a compressed archive still inflates it, so the same
+    // ratio/size limits as extraction apply
+    var monitor = security.RatioMonitor.init(.{});
+
+    const format = detect.detectFormat(allocator, list_args.archive_path) catch .unknown;
+
+    var opened = open.openArchive(allocator, archive_file, format, .{ .observer = monitor.observer() }) catch |err| {
+        if (err == error.UnsupportedFormat) {
+            try err_out.printError("Unsupported archive format: {s}", .{@tagName(format)});
+        } else {
+            try err_out.printError("Cannot read archive: {s}", .{@errorName(err)});
+        }
+        return readErrorExitCode(err);
+    };
+    defer opened.deinit();
+
+    var buffered = std.io.BufferedWriter(types.BufferSize.default, std.fs.File.Writer){
+        .unbuffered_writer = stdout_file.writer(),
+    };
+
+    const result = switch (opened) {
+        inline else => |*concrete| list.listArchive(concrete, buffered.writer(), list_args.options),
+    } catch |err| {
+        // Keep what was listed before the failure
+        buffered.flush() catch {};
+        try err_out.printError("Listing failed: {s}", .{@errorName(err)});
+        return readErrorExitCode(err);
+    };
+    try buffered.flush();
+
+    if (list_args.global.verbose) {
+        var size_buf: [util.max_size_len]u8 = undefined;
+        try err_out.printInfo("{d} entries, {s}", .{
+            result.entries,
+            util.formatSizeBuf(&size_buf, result.total_size),
+        });
+    }
+
+    return 0;
+}
+
+/// Run test command
+///
+/// Reads the whole archive, checking header checksums, entry sizes and
+/// gzip/ZIP CRCs, without writing anything to disk.
+pub fn runTest(
+    allocator: std.mem.Allocator,
+    test_args: args_mod.TestArgs,
+) !u8 {
+    const stdout_file = std.io.getStdOut();
+    const stderr_file = std.io.getStdErr();
+
+    var out = output.OutputWriter.init(
+        stdout_file,
+        test_args.global.output_level,
+        test_args.global.color_mode,
+    );
+
+    var err_out = output.OutputWriter.init(
+        stderr_file,
+        test_args.global.output_level,
+        test_args.global.color_mode,
+    );
+
+    // Open archive file
+    const archive_file = std.fs.cwd().openFile(test_args.archive_path, .{}) catch |err| {
+        try err_out.printError("Cannot open archive file '{s}'", .{test_args.archive_path});
+        try err_out.printError("Reason: {s}", .{@errorName(err)});
+        return switch (err) {
+            error.FileNotFound => 3,
+            error.AccessDenied => 4,
+            else => 1,
+        };
+    };
+    defer archive_file.close();
+
+    try out.printInfo("Testing {s}...", .{test_args.archive_path});
+
+    const format = detect.detectFormat(allocator, test_args.archive_path) catch .unknown;
+
+    if (test_args.trace_path != null) try trace.start();
+    defer if (test_args.trace_path) |path| saveTrace(err_out, path);
+
+    const result = verify.verifyFile(
+        allocator,
+        archive_file,
+        format,
+        test_args.options,
+    ) catch |err| {
+        if (err == error.UnsupportedFormat) {
+            try err_out.printError("Unsupported archive format: {s}", .{@tagName(format)});
+        } else {
+            try err_out.printError("Archive is corrupted: {s}", .{@errorName(err)});
+        }
+        return readErrorExitCode(err);
+    };
+
+    var size_buf: [util.max_size_len]u8 = undefined;
+    const duration_str = try output.formatDuration(allocator, result.elapsed_ns);
+    defer allocator.free(duration_str);
+
+    try out.printInfo("Verified {d} entries ({s}) in {s}, {d:.2} GB/s", .{
+        result.entries,
+        util.formatSizeBuf(&size_buf, result.archive_bytes),
+        duration_str,
+        result.throughputGBps(),
+    });
+    if (result.parallel_blocks > 0) {
+        try out.printVerbose("{d} blocks/frames decoded in parallel", .{result.parallel_blocks});
+    }
+    try out.printSuccess("All OK", .{});
+
+    return 0;
+}
+
 /// Print help message
 pub fn printHelp(file: std.fs.File, subcommand: ?[]const u8) !void {
     if (subcommand) |cmd| {
         if (std.mem.eql(u8, cmd, "extract") or std.mem.eql(u8, cmd, "x")) {
             try printExtractHelp(file);
+        } else if (std.mem.eql(u8, cmd, "list") or std.mem.eql(u8, cmd, "l") or std.mem.eql(u8, cmd, "ls")) {
+            try printListHelp(file);
+        } else if (std.mem.eql(u8, cmd, "test") or std.mem.eql(u8, cmd, "t")) {
+            try printTestHelp(file);
         } else {
             var buf: [256]u8 = undefined;
             const msg = try std.fmt.bufPrint(&buf, "Unknown subcommand: {s}\n\n", .{cmd});
@@ -146,8 +377,8 @@ fn printMainHelp(file: std.fs.File) !void {
         \\SUBCOMMANDS:
         \\    extract, x      Extract archive
         \\    compress, c     Create archive (not yet implemented)
-        \\    list, l         List contents (not yet implemented)
-        \\    test, t         Test integrity (not yet implemented)
+        \\    list, l         List contents
+        \\    test, t         Test integrity
         \\    info, i         Show information (not yet implemented)
         \\    help, h         Show help
         \\    version, v      Show version
@@ -162,6 +393,8 @@ fn printMainHelp(file: std.fs.File) !void {
         \\EXAMPLES:
         \\    zarc extract archive.tar.gz
         \\    zarc x archive.tar.gz -C /tmp/output
+        \\    zarc list -lh archive.tar.gz
+        \\    zarc test archive.tar.gz
         \\    zarc help extract
         \\
         \\For more information about a specific command, use:
@@ -191,7 +424,13 @@ fn printExtractHelp(file: std.fs.File) !void {
         \\    -q, --quiet                 Minimal output
         \\    -p, --preserve-permissions  Preserve permissions
         \\    --no-preserve-permissions   Ignore permissions (default)
+        \\    --xattrs                    Restore xattrs, ACLs and capabilities (Linux)
+        \\    --no-xattrs                 Ignore extended attributes (default)
+        \\    --include <pattern>         Extract only matching entries (repeatable)
+        \\    --exclude <pattern>         Skip matching entries (repeatable)
         \\    --continue-on-error         Continue extraction even if some entries fail
+        \\    --stats[=json]              Print a per-phase timing breakdown to stderr
+        \\    --trace=<file>              Write a Chrome trace (chrome://tracing, Perfetto)
         \\    --no-color                  Disable color output
         \\    -h, --help                  Show this help
         \\
@@ -215,6 +454,86 @@ fn printExtractHelp(file: std.fs.File) !void {
         \\    # Continue on errors
         \\    zarc extract archive.tar.gz --continue-on-error
         \\
+        \\    # Where does the time go? (build with -Dinstrument=true)
+        \\    zarc extract archive.tar.gz --stats
+        \\
+        \\    # Timeline of every entry and phase
+        \\    zarc extract archive.tar.gz --trace=extract.json
+        \\
+    );
+}
+
+/// Print list command help
+fn printListHelp(file: std.fs.File) !void {
+    try file.writeAll(
+        \\zarc list - List archive contents
+        \\
+        \\USAGE:
+        \\    zarc list [options] <archive>
+        \\    zarc l [options] <archive>
+        \\    zarc ls [options] <archive>
+        \\
+        \\ARGUMENTS:
+        \\    <archive>       Archive file to list
+        \\
+        \\OPTIONS:
+        \\    -l, --long                  Long format (mode, owner, size, mtime)
+        \\    -h, --human-readable        Human-readable sizes in long format
+        \\    -v, --verbose               Long format plus a summary on stderr
+        \\    --json                      JSON array, one object per entry
+        \\    -0, --null                  NUL-terminated paths (for xargs -0)
+        \\    -q, --quiet                 Minimal output
+        \\    --no-color                  Disable color output
+        \\    --help                      Show this help
+        \\
+        \\EXAMPLES:
+        \\    # Paths only
+        \\    zarc list archive.tar.gz
+        \\
+        \\    # Detailed listing with readable sizes
+        \\    zarc list -lh archive.tar.gz
+        \\
+        \\    # Machine-readable output
+        \\    zarc list --json archive.tar | jq '.[].path'
+        \\    zarc list -0 archive.tar | xargs -0 -n1 echo
+        \\
+    );
+}
+
+/// Print test command help
+fn printTestHelp(file: std.fs.File) !void {
+    try file.writeAll(
+        \\zarc test - Test archive integrity
+        \\
+        \\USAGE:
+        \\    zarc test [options] <archive>
+        \\    zarc t [options] <archive>
+        \\
+        \\ARGUMENTS:
+        \\    <archive>       Archive file to test
+        \\
+        \\Every header checksum, entry size, gzip/ZIP/bzip2 CRC, XZ block check
+        \\and Zstandard/LZ4 checksum is checked. Nothing is written to disk.
+        \\Gzip, Zstandard and LZ4 data is decompressed on a separate thread;
+        \\BGZF archives, multi-frame Zstandard archives, LZ4 archives with
+        \\independent blocks, bzip2 blocks, multi-threaded XZ blocks and ZIP
+        \\members are decompressed on all cores.
+        \\
+        \\OPTIONS:
+        \\    -j, --threads <n>           Decompression threads (default: CPU count, 1 = none)
+        \\    -v, --verbose               List each entry as it is verified
+        \\    --trace=<file>              Write a Chrome trace (chrome://tracing, Perfetto)
+        \\    -q, --quiet                 Minimal output
+        \\    --no-color                  Disable color output
+        \\    -h, --help                  Show this help
+        \\
+        \\EXAMPLES:
+        \\    # Verify an archive
+        \\    zarc test archive.tar.gz
+        \\
+        \\    # Single-threaded verification
+        \\    zarc test -j 1 archive.tar.gz
+        \\
     );
 }
 
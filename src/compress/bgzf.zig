@@ -0,0 +1,381 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! BGZF (blocked gzip) support
+//!
+//! BGZF files (SAMtools, bgzip) are a series of independent gzip members,
+//! each at most 64 KiB compressed and uncompressed, whose header carries
+//! the member's compressed size in a 'BC' extra subfield. Member
+//! boundaries are therefore known without decompressing, which lets the
+//! members be inflated (and CRC-checked) on all cores at once.
+//!
+//! Any plain gzip reader can read BGZF; this module only exists to make
+//! it parallel.
+
+const std = @import("std");
+const gzip = @import("gzip.zig");
+const c_zlib = @import("../c_compat/zlib.zig");
+const instrument = @import("../core/instrument.zig");
+const trace = @import("../core/trace.zig");
+
+/// Largest compressed or uncompressed size of one BGZF block
+pub const max_block_size: usize = 64 * 1024;
+
+/// Bytes needed to recognise a standard BGZF block header
+pub const header_size: usize = 18;
+
+/// Compressed size of the BGZF block starting at `data`
+///
+/// Parameters:
+///   - data: Bytes starting at a gzip member header
+///
+/// Returns:
+///   - Total block size (header, deflate data and trailer), or null if
+///     `data` does not start with a complete BGZF header
+pub fn blockSize(data: []const u8) ?usize {
+    if (data.len < 12) return null;
+    if (!std.mem.eql(u8, data[0..2], &gzip.magic_number)) return null;
+    if (data[2] != gzip.compression_method_deflate) return null;
+
+    const flags = gzip.Flags.fromByte(data[3]);
+    if (!flags.fextra) return null;
+
+    const xlen = std.mem.readInt(u16, data[10..12], .little);
+    if (data.len < 12 + @as(usize, xlen)) return null;
+    const extra = data[12..][0..xlen];
+
+    // Walk the extra subfields looking for BC (SI1='B', SI2='C', SLEN=2)
+    var i: usize = 0;
+    while (i + 4 <= extra.len) {
+        const slen = std.mem.readInt(u16, extra[i + 2 ..][0..2], .little);
+        if (extra[i] == 'B' and extra[i + 1] == 'C' and slen == 2 and i + 6 <= extra.len) {
+            return @as(usize, std.mem.readInt(u16, extra[i + 4 ..][0..2], .little)) + 1;
+        }
+        i += 4 + @as(usize, slen);
+    }
+    return null;
+}
+
+/// Parallel BGZF decompressor
+///
+/// Reads a batch of whole blocks from the source, inflates them on a
+/// thread pool (zlib verifies each block's CRC-32 and ISIZE on the worker
+/// that inflates it) and hands the output back in order.
+///
+/// Must not be moved after `init` (the pool keeps pointers into it).
+///
+/// Example:
+/// ```zig
+/// var parallel: ParallelReader = undefined;
+/// try parallel.init(allocator, file_reader.any(), .{ .threads = 8 });
+/// defer parallel.deinit();
+///
+/// const n = try parallel.read(&buffer);
+/// ```
+pub const ParallelReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+    pool: std.Thread.Pool,
+
+    /// Compressed input for the current batch and its unconsumed window
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    source_eof: bool = false,
+
+    /// One output slot per block in a batch
+    out_buf: []u8,
+    tasks: []Task,
+    batch_len: usize = 0,
+    out_index: usize = 0,
+    out_pos: usize = 0,
+
+    /// Blocks verified so far
+    blocks: u64 = 0,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    pub const Options = struct {
+        /// Worker threads (0 = one per CPU)
+        threads: usize = 0,
+
+        /// Blocks decoded per batch, per thread
+        blocks_per_thread: usize = 16,
+    };
+
+    pub const Reader = std.io.Reader(*ParallelReader, anyerror, read);
+
+    const Task = struct {
+        input: []const u8 = &.{},
+        output: []u8 = &.{},
+        produced: usize = 0,
+        err: ?anyerror = null,
+    };
+
+    /// Initialize in place
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate batch buffers
+    ///   - (Errors from spawning pool threads)
+    pub fn init(self: *ParallelReader, allocator: std.mem.Allocator, source: std.io.AnyReader, options: Options) !void {
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+        const batch_blocks = @max(1, threads * options.blocks_per_thread);
+
+        const in_buf = try allocator.alloc(u8, batch_blocks * max_block_size);
+        errdefer allocator.free(in_buf);
+        const out_buf = try allocator.alloc(u8, batch_blocks * max_block_size);
+        errdefer allocator.free(out_buf);
+        const tasks = try allocator.alloc(Task, batch_blocks);
+        errdefer allocator.free(tasks);
+
+        self.* = .{
+            .allocator = allocator,
+            .source = source,
+            .pool = undefined,
+            .in_buf = in_buf,
+            .out_buf = out_buf,
+            .tasks = tasks,
+        };
+        try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+    }
+
+    /// Stop worker threads and free buffers
+    pub fn deinit(self: *ParallelReader) void {
+        self.pool.deinit();
+        self.allocator.free(self.tasks);
+        self.allocator.free(self.out_buf);
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data in stream order
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Input is not BGZF or ends mid-block
+    ///   - error.ChecksumMismatch: A block failed its CRC-32/ISIZE check
+    ///   - error.DecompressionFailed: Other zlib failure
+    pub fn read(self: *ParallelReader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (true) {
+            while (self.out_index < self.batch_len) {
+                const task = &self.tasks[self.out_index];
+                const available = task.output[0..task.produced];
+                if (self.out_pos < available.len) {
+                    const n = @min(dest.len, available.len - self.out_pos);
+                    @memcpy(dest[0..n], available[self.out_pos..][0..n]);
+                    self.out_pos += n;
+                    return n;
+                }
+                self.out_index += 1;
+                self.out_pos = 0;
+            }
+
+            if (!try self.decodeBatch()) return 0;
+        }
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *ParallelReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Decode the next batch of blocks
+    ///
+    /// Returns:
+    ///   - false at the clean end of the input
+    fn decodeBatch(self: *ParallelReader) !bool {
+        try self.fill();
+
+        // Split the buffered input into whole blocks
+        var count: usize = 0;
+        var pos = self.in_start;
+        while (count < self.tasks.len) {
+            const remaining = self.in_buf[pos..self.in_end];
+            if (remaining.len == 0) break;
+
+            const size = blockSize(remaining) orelse {
+                // A short tail may just be a header cut off by the buffer end
+                if (remaining.len < max_block_size and !self.source_eof) break;
+                return error.CorruptedStream;
+            };
+            if (size > max_block_size) return error.CorruptedStream;
+            if (size > remaining.len) {
+                if (self.source_eof) return error.CorruptedStream;
+                break;
+            }
+
+            self.tasks[count] = .{
+                .input = remaining[0..size],
+                .output = self.out_buf[count * max_block_size ..][0..max_block_size],
+            };
+            count += 1;
+            pos += size;
+        }
+
+        if (count == 0) {
+            if (self.in_start == self.in_end and self.source_eof) return false;
+            return error.CorruptedStream;
+        }
+
+        var wg: std.Thread.WaitGroup = .{};
+        for (self.tasks[0..count]) |*task| {
+            self.pool.spawnWg(&wg, inflateBlock, .{task});
+        }
+        self.pool.waitAndWork(&wg);
+
+        for (self.tasks[0..count]) |task| {
+            if (task.err) |err| return err;
+            self.uncompressed_bytes += task.produced;
+        }
+
+        self.compressed_bytes += pos - self.in_start;
+        self.blocks += count;
+        self.in_start = pos;
+        self.batch_len = count;
+        self.out_index = 0;
+        self.out_pos = 0;
+        return true;
+    }
+
+    /// Move unconsumed input to the front and top the buffer up
+    fn fill(self: *ParallelReader) !void {
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < self.in_buf.len and !self.source_eof) {
+            const n = try self.source.read(self.in_buf[self.in_end..]);
+            if (n == 0) self.source_eof = true;
+            self.in_end += n;
+        }
+    }
+
+    /// Worker: inflate one complete block into its output slot
+    fn inflateBlock(task: *Task) void {
+        trace.setThreadName("bgzf worker");
+        const span = instrument.begin(.inflate);
+        defer span.end();
+
+        var inflater = c_zlib.Inflater.init(.gzip) catch |err| {
+            task.err = err;
+            return;
+        };
+        defer inflater.deinit();
+
+        const step = inflater.step(task.input, task.output) catch |err| {
+            task.err = err;
+            return;
+        };
+        if (!step.stream_end or step.consumed != task.input.len) {
+            task.err = error.CorruptedStream;
+            return;
+        }
+        task.produced = step.produced;
+    }
+};
+
+// Tests
+
+/// Build one BGZF block around raw deflate data compressed by zlib
+fn testBlock(allocator: std.mem.Allocator, payload: []const u8) ![]u8 {
+    const member = try c_zlib.compress(allocator, .gzip, payload);
+    defer allocator.free(member);
+
+    // Re-wrap the deflate body with a BGZF header (FEXTRA + BC subfield)
+    const deflate_body = member[10..];
+    const block = try allocator.alloc(u8, header_size + deflate_body.len);
+    const header = [_]u8{ 0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0 };
+    @memcpy(block[0..header.len], &header);
+    std.mem.writeInt(u16, block[16..18], @intCast(block.len - 1), .little);
+    @memcpy(block[header_size..], deflate_body);
+    return block;
+}
+
+test "blockSize: recognises BGZF headers only" {
+    const allocator = std.testing.allocator;
+
+    const block = try testBlock(allocator, "hello bgzf");
+    defer allocator.free(block);
+    try std.testing.expectEqual(@as(?usize, block.len), blockSize(block));
+
+    const plain = try c_zlib.compress(allocator, .gzip, "hello gzip");
+    defer allocator.free(plain);
+    try std.testing.expectEqual(@as(?usize, null), blockSize(plain));
+    try std.testing.expectEqual(@as(?usize, null), blockSize(block[0..8]));
+}
+
+test "ParallelReader: decodes blocks in order and detects corruption" {
+    const allocator = std.testing.allocator;
+
+    var expected = std.ArrayList(u8).init(allocator);
+    defer expected.deinit();
+    var file_data = std.ArrayList(u8).init(allocator);
+    defer file_data.deinit();
+
+    for (0..37) |i| {
+        var payload: [5000]u8 = undefined;
+        for (&payload, 0..) |*b, j| b.* = @truncate(i * 7 + j % 11);
+        const block = try testBlock(allocator, &payload);
+        defer allocator.free(block);
+        try expected.appendSlice(&payload);
+        try file_data.appendSlice(block);
+    }
+    // Standard BGZF end-of-file marker (empty block)
+    const eof_block = try testBlock(allocator, "");
+    defer allocator.free(eof_block);
+    try file_data.appendSlice(eof_block);
+
+    {
+        var fbs = std.io.fixedBufferStream(file_data.items);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 3, .blocks_per_thread = 2 });
+        defer parallel.deinit();
+
+        const out = try parallel.reader().readAllAlloc(allocator, 1 << 20);
+        defer allocator.free(out);
+        try std.testing.expectEqualSlices(u8, expected.items, out);
+        try std.testing.expectEqual(@as(u64, 38), parallel.blocks);
+        try std.testing.expectEqual(@as(u64, file_data.items.len), parallel.compressed_bytes);
+    }
+
+    {
+        // Flip a byte inside the 20th block's CRC
+        const corrupt = try allocator.dupe(u8, file_data.items);
+        defer allocator.free(corrupt);
+        var offset: usize = 0;
+        for (0..20) |_| offset += blockSize(corrupt[offset..]).?;
+        corrupt[offset - 8] ^= 0xff;
+
+        var fbs = std.io.fixedBufferStream(corrupt);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2, .blocks_per_thread = 4 });
+        defer parallel.deinit();
+
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            parallel.reader().readAllAlloc(allocator, 1 << 20),
+        );
+    }
+}
@@ -0,0 +1,786 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! bzip2 decompression
+//!
+//! A bzip2 stream is "BZh" plus a level digit, then blocks of up to level
+//! x 100 kB, then an end-of-stream record holding a CRC combined from the
+//! block CRCs. Streams may be concatenated (pbzip2 writes one per block).
+//!
+//! bzip2 is slow to decode, around 30-60 MB/s per core, but blocks are
+//! independent. `ParallelReader` finds them by scanning for the block
+//! magic (lbzip2 style) and decodes them on a thread pool. `Bz2Reader`
+//! decodes on the calling thread.
+
+const std = @import("std");
+const instrument = @import("../core/instrument.zig");
+const trace = @import("../core/trace.zig");
+const types = @import("../core/types.zig");
+
+pub const block = @import("bzip2/block.zig");
+
+/// Block size limit of the level in a stream header ("BZh1".."BZh9")
+///
+/// Errors:
+///   - error.CorruptedStream: Not a stream header
+fn parseStreamHeader(header: []const u8) !usize {
+    if (!std.mem.eql(u8, header[0..3], "BZh")) return error.CorruptedStream;
+    if (header[3] < '1' or header[3] > '9') return error.CorruptedStream;
+    return @as(usize, header[3] - '0') * 100_000;
+}
+
+fn combineCrc(combined: u32, block_crc: u32) u32 {
+    return std.math.rotl(u32, combined, 1) ^ block_crc;
+}
+
+/// Streaming bzip2 decompressor over any reader
+///
+/// Decodes one block at a time on the calling thread. Memory is the
+/// input buffer (one worst-case compressed block, about 2.3 MB), the BWT
+/// vector (4 bytes per block byte) and the decoded block.
+///
+/// Example:
+/// ```zig
+/// var bz2 = try Bz2Reader.init(allocator, source);
+/// defer bz2.deinit();
+///
+/// const n = try bz2.read(&buffer);
+/// ```
+pub const Bz2Reader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+
+    /// Compressed input; the next unread bit is bit `bit` of `in_buf[in_start]`
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    bit: usize = 0,
+    source_eof: bool = false,
+
+    decoder: block.Decoder,
+
+    /// Current decoded block
+    out: std.ArrayList(u8),
+    out_pos: usize = 0,
+
+    /// Block size limit of the current stream (0 between streams)
+    block_size: usize = 0,
+    combined_crc: u32 = 0,
+
+    finished: bool = false,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    /// Blocks decoded
+    blocks: u64 = 0,
+
+    /// Streams fully decoded and checked
+    streams: u64 = 0,
+
+    /// Progress observer, called after each block
+    observer: ?types.StreamObserver = null,
+
+    pub const Reader = std.io.Reader(*Bz2Reader, anyerror, read);
+
+    /// Initialize a streaming decompressor
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate the input buffer
+    pub fn init(allocator: std.mem.Allocator, source: std.io.AnyReader) !Bz2Reader {
+        return .{
+            .allocator = allocator,
+            .source = source,
+            .in_buf = try allocator.alloc(u8, block.max_compressed_size + types.BufferSize.default),
+            .decoder = block.Decoder.init(allocator),
+            .out = std.ArrayList(u8).init(allocator),
+        };
+    }
+
+    /// Release buffers
+    pub fn deinit(self: *Bz2Reader) void {
+        self.out.deinit();
+        self.decoder.deinit();
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input
+    ///   - error.ChecksumMismatch: A block or stream CRC does not match
+    ///   - error.UnsupportedFormat: Randomized block (bzip2 0.9.0 and older)
+    ///   - (Any error returned by the observer)
+    pub fn read(self: *Bz2Reader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (self.out_pos == self.out.items.len) {
+            if (self.finished) return 0;
+            try self.decodeStep();
+        }
+        const n = @min(dest.len, self.out.items.len - self.out_pos);
+        @memcpy(dest[0..n], self.out.items[self.out_pos..][0..n]);
+        self.out_pos += n;
+        return n;
+    }
+
+    /// Decompress and discard up to `count` bytes
+    ///
+    /// Returns:
+    ///   - Number of bytes skipped (less than `count` only at end of stream)
+    pub fn skip(self: *Bz2Reader, count: u64) anyerror!u64 {
+        var skipped: u64 = 0;
+        while (skipped < count) {
+            if (self.out_pos == self.out.items.len) {
+                if (self.finished) break;
+                try self.decodeStep();
+                continue;
+            }
+            const n: usize = @intCast(@min(count - skipped, @as(u64, self.out.items.len - self.out_pos)));
+            self.out_pos += n;
+            skipped += n;
+        }
+        return skipped;
+    }
+
+    /// Buffer the start of the stream and check its header
+    ///
+    /// Must be called before any data has been read.
+    ///
+    /// Errors:
+    ///   - error.DecompressionFailed: Input is empty or not a bzip2 stream
+    pub fn checkHeader(self: *Bz2Reader) !void {
+        std.debug.assert(self.compressed_bytes == 0 and self.in_start == 0);
+
+        if (!try self.ensure(4)) return error.DecompressionFailed;
+        _ = parseStreamHeader(self.in_buf[0..4]) catch return error.DecompressionFailed;
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *Bz2Reader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Start a stream, decode one block or finish a stream
+    fn decodeStep(self: *Bz2Reader) !void {
+        if (self.block_size == 0) return self.startStream();
+
+        // A whole block fits the buffer, so running out of data means truncation
+        _ = try self.ensure(block.max_compressed_size);
+        const data = self.in_buf[self.in_start..self.in_end];
+        var bits = block.BitReader.init(data, self.bit);
+        const magic = bits.readMagic() catch return error.CorruptedStream;
+
+        if (magic == block.end_magic) {
+            const expected = bits.readBits(32) catch return error.CorruptedStream;
+            if (expected != self.combined_crc) return error.ChecksumMismatch;
+            self.moveTo(std.mem.alignForward(usize, bits.bitPosition(), 8));
+            self.block_size = 0;
+            self.streams += 1;
+            return;
+        }
+        if (magic != block.block_magic) return error.CorruptedStream;
+
+        self.out.clearRetainingCapacity();
+        self.out_pos = 0;
+        const result = blk: {
+            const span = instrument.begin(.inflate);
+            defer span.end();
+
+            break :blk self.decoder.decodeBlock(data, self.bit, self.block_size, &self.out) catch |err| switch (err) {
+                error.EndOfStream => return error.CorruptedStream,
+                else => return err,
+            };
+        };
+        self.moveTo(result.end);
+        self.combined_crc = combineCrc(self.combined_crc, result.crc);
+        self.blocks += 1;
+        self.uncompressed_bytes += self.out.items.len;
+
+        if (self.observer) |observer| {
+            try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+        }
+    }
+
+    fn startStream(self: *Bz2Reader) !void {
+        std.debug.assert(self.bit == 0);
+        if (!try self.ensure(4)) {
+            if (self.in_start == self.in_end) {
+                self.finished = true;
+                return;
+            }
+            return error.CorruptedStream;
+        }
+        self.block_size = try parseStreamHeader(self.in_buf[self.in_start..][0..4]);
+        self.combined_crc = 0;
+        self.moveTo(32);
+    }
+
+    /// Move the read position to bit `bit_pos` of the buffered input
+    /// (counted from bit 0 of `in_buf[in_start]`)
+    fn moveTo(self: *Bz2Reader, bit_pos: usize) void {
+        self.in_start += bit_pos / 8;
+        self.compressed_bytes += bit_pos / 8;
+        self.bit = bit_pos % 8;
+    }
+
+    /// Buffer at least `n` bytes of input
+    ///
+    /// Returns:
+    ///   - false if the source ends first
+    fn ensure(self: *Bz2Reader, n: usize) !bool {
+        std.debug.assert(n <= self.in_buf.len);
+        if (self.in_end - self.in_start >= n) return true;
+
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < n and !self.source_eof) try self.fill();
+        return self.in_end >= n;
+    }
+
+    /// Read more input after the buffered bytes
+    fn fill(self: *Bz2Reader) !void {
+        const span = instrument.begin(.read);
+        defer span.end();
+
+        const n = try self.source.read(self.in_buf[self.in_end..]);
+        instrument.count(.bytes_read, n);
+        if (n == 0) self.source_eof = true;
+        self.in_end += n;
+    }
+};
+
+/// Parallel bzip2 decompressor
+///
+/// Reads a batch of input, scans it for block magics and decodes every
+/// candidate block on a thread pool (workers also check block CRCs). The
+/// blocks are then walked in stream order: each must start where the
+/// previous one ended, which discards magic-like bit patterns inside
+/// compressed data, and stream headers and combined CRCs are checked.
+///
+/// Memory is the batch buffer plus, per block in flight, a BWT vector
+/// (3.6 MB) and the decoded block. The batch buffer starts at two
+/// worst-case blocks and doubles, up to `Options.batch_size`, while it
+/// is what keeps a batch from filling every task.
+///
+/// Must not be moved after `init` (the pool keeps pointers into it).
+///
+/// Example:
+/// ```zig
+/// var parallel: ParallelReader = undefined;
+/// try parallel.init(allocator, file_reader.any(), .{ .threads = 8 });
+/// defer parallel.deinit();
+///
+/// const n = try parallel.read(&buffer);
+/// ```
+pub const ParallelReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+    pool: std.Thread.Pool,
+    threaded: bool,
+
+    /// Compressed input for the current batch; `cursor` is the bit
+    /// position of the next unread bit
+    in_buf: []u8,
+    in_end: usize = 0,
+    cursor: usize = 0,
+    source_eof: bool = false,
+
+    /// Size the batch buffer may grow to
+    batch_limit: usize,
+
+    /// Candidate blocks of the batch, and the accepted ones in stream order
+    tasks: []Task,
+    order: []usize,
+    batch_len: usize = 0,
+    out_index: usize = 0,
+    out_pos: usize = 0,
+
+    /// Block size limit of the current stream (0 between streams)
+    block_size: usize = 0,
+    combined_crc: u32 = 0,
+
+    /// Blocks decoded on the pool
+    blocks: u64 = 0,
+
+    /// Streams fully decoded and checked
+    streams: u64 = 0,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    /// Progress observer, called after each batch
+    observer: ?types.StreamObserver = null,
+
+    pub const Options = struct {
+        /// Worker threads (0 = one per CPU, 1 = decode on the calling thread)
+        threads: usize = 0,
+
+        /// Blocks decoded per batch, per thread
+        blocks_per_thread: usize = 2,
+
+        /// Size the input batch buffer may grow to (raised to hold at
+        /// least two worst-case blocks)
+        batch_size: usize = 32 * 1024 * 1024,
+    };
+
+    pub const Reader = std.io.Reader(*ParallelReader, anyerror, read);
+
+    const Task = struct {
+        data: []const u8 = &.{},
+
+        /// Bit position of the candidate block magic
+        start: usize = 0,
+
+        decoder: block.Decoder,
+        output: std.ArrayList(u8),
+        result: block.BlockResult = undefined,
+        err: ?anyerror = null,
+    };
+
+    /// Initialize in place
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate batch buffers
+    ///   - (Errors from spawning pool threads)
+    pub fn init(self: *ParallelReader, allocator: std.mem.Allocator, source: std.io.AnyReader, options: Options) !void {
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+        const batch_blocks = @max(1, threads * options.blocks_per_thread);
+        const min_batch = 2 * block.max_compressed_size;
+
+        const in_buf = try allocator.alloc(u8, min_batch);
+        errdefer allocator.free(in_buf);
+        const tasks = try allocator.alloc(Task, batch_blocks);
+        errdefer allocator.free(tasks);
+        const order = try allocator.alloc(usize, batch_blocks);
+        errdefer allocator.free(order);
+        for (tasks) |*task| {
+            task.* = .{
+                .decoder = block.Decoder.init(allocator),
+                .output = std.ArrayList(u8).init(allocator),
+            };
+        }
+
+        self.* = .{
+            .allocator = allocator,
+            .source = source,
+            .pool = undefined,
+            .threaded = threads > 1,
+            .in_buf = in_buf,
+            .batch_limit = @max(options.batch_size, min_batch),
+            .tasks = tasks,
+            .order = order,
+        };
+        if (self.threaded) try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+    }
+
+    /// Stop worker threads and free buffers
+    pub fn deinit(self: *ParallelReader) void {
+        if (self.threaded) self.pool.deinit();
+        for (self.tasks) |*task| {
+            task.output.deinit();
+            task.decoder.deinit();
+        }
+        self.allocator.free(self.order);
+        self.allocator.free(self.tasks);
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data in stream order
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input
+    ///   - error.ChecksumMismatch: A block or stream CRC does not match
+    ///   - error.UnsupportedFormat: Randomized block (bzip2 0.9.0 and older)
+    pub fn read(self: *ParallelReader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (true) {
+            while (self.out_index < self.batch_len) {
+                const available = self.tasks[self.order[self.out_index]].output.items;
+                if (self.out_pos < available.len) {
+                    const n = @min(dest.len, available.len - self.out_pos);
+                    @memcpy(dest[0..n], available[self.out_pos..][0..n]);
+                    self.out_pos += n;
+                    return n;
+                }
+                self.out_index += 1;
+                self.out_pos = 0;
+            }
+
+            if (!try self.decodeBatch()) return 0;
+        }
+    }
+
+    /// Decompress and discard up to `count` bytes
+    ///
+    /// Returns:
+    ///   - Number of bytes skipped (less than `count` only at end of stream)
+    pub fn skip(self: *ParallelReader, count: u64) anyerror!u64 {
+        var skipped: u64 = 0;
+        while (skipped < count) {
+            if (self.out_index == self.batch_len) {
+                if (!try self.decodeBatch()) break;
+                continue;
+            }
+            const available = self.tasks[self.order[self.out_index]].output.items.len - self.out_pos;
+            const n: usize = @intCast(@min(count - skipped, @as(u64, available)));
+            self.out_pos += n;
+            skipped += n;
+            if (self.out_pos == self.tasks[self.order[self.out_index]].output.items.len) {
+                self.out_index += 1;
+                self.out_pos = 0;
+            }
+        }
+        return skipped;
+    }
+
+    /// Buffer the start of the input and check the stream header
+    ///
+    /// Must be called before any data has been read.
+    ///
+    /// Errors:
+    ///   - error.DecompressionFailed: Input is empty or not a bzip2 stream
+    pub fn checkHeader(self: *ParallelReader) !void {
+        std.debug.assert(self.compressed_bytes == 0 and self.cursor == 0);
+
+        try self.fill();
+        if (self.in_end < 4) return error.DecompressionFailed;
+        _ = parseStreamHeader(self.in_buf[0..4]) catch return error.DecompressionFailed;
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *ParallelReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Decode the next batch of blocks
+    ///
+    /// Returns:
+    ///   - false at the clean end of the input
+    fn decodeBatch(self: *ParallelReader) !bool {
+        // The last batch ran out of buffered input before it ran out of
+        // tasks: make room for more blocks (no task points into it now)
+        if (self.batch_len > 0 and self.batch_len < self.tasks.len and !self.source_eof) {
+            const size = @min(self.batch_limit, 2 * self.in_buf.len);
+            if (size > self.in_buf.len) self.in_buf = try self.allocator.realloc(self.in_buf, size);
+        }
+
+        try self.fill();
+        self.batch_len = 0;
+        self.out_index = 0;
+        self.out_pos = 0;
+        const data = self.in_buf[0..self.in_end];
+
+        // Candidate block starts, plus one more to tell whether the last
+        // candidate is followed by anything
+        var count: usize = 0;
+        var followed = false;
+        {
+            const span = instrument.begin(.inflate);
+            defer span.end();
+
+            var search = self.cursor;
+            while (block.findBlockMagic(data, search)) |found| {
+                if (count == self.tasks.len) {
+                    followed = true;
+                    break;
+                }
+                self.tasks[count].data = data;
+                self.tasks[count].start = found;
+                count += 1;
+                search = found + 1;
+            }
+        }
+        // Without a successor the last block may run past the buffer
+        if (!followed and !self.source_eof and count > 1) count -= 1;
+
+        if (self.threaded and count > 1) {
+            var wg: std.Thread.WaitGroup = .{};
+            for (self.tasks[0..count]) |*task| {
+                self.pool.spawnWg(&wg, workerTask, .{task});
+            }
+            self.pool.waitAndWork(&wg);
+        } else {
+            for (self.tasks[0..count]) |*task| decodeTask(task);
+        }
+
+        // Walk the stream, taking decoded blocks where they belong
+        const start_cursor = self.cursor;
+        var next_task: usize = 0;
+        while (true) {
+            if (self.block_size == 0) {
+                const at = self.cursor / 8;
+                if (self.in_end - at < 4) {
+                    if (at == self.in_end or !self.source_eof) break;
+                    return error.CorruptedStream;
+                }
+                self.block_size = try parseStreamHeader(data[at..][0..4]);
+                self.combined_crc = 0;
+                self.advance(32);
+                continue;
+            }
+
+            var bits = block.BitReader.init(data, self.cursor);
+            const magic = bits.readMagic() catch {
+                if (self.source_eof) return error.CorruptedStream;
+                break;
+            };
+            if (magic == block.end_magic) {
+                const expected = bits.readBits(32) catch {
+                    if (self.source_eof) return error.CorruptedStream;
+                    break;
+                };
+                if (expected != self.combined_crc) return error.ChecksumMismatch;
+                self.advance(std.mem.alignForward(usize, bits.bitPosition(), 8) - self.cursor);
+                self.block_size = 0;
+                self.streams += 1;
+                continue;
+            }
+            if (magic != block.block_magic) return error.CorruptedStream;
+
+            // Skip candidates that were really inside earlier blocks
+            while (next_task < count and self.tasks[next_task].start < self.cursor) next_task += 1;
+            if (next_task == count or self.tasks[next_task].start != self.cursor) break;
+            const task = &self.tasks[next_task];
+            if (task.err) |err| {
+                if (err == error.EndOfStream) {
+                    if (!self.source_eof) break;
+                    return error.CorruptedStream;
+                }
+                return err;
+            }
+            if (task.result.size > self.block_size) return error.CorruptedStream;
+
+            self.combined_crc = combineCrc(self.combined_crc, task.result.crc);
+            self.order[self.batch_len] = next_task;
+            self.batch_len += 1;
+            self.uncompressed_bytes += task.output.items.len;
+            self.advance(task.result.end - self.cursor);
+            next_task += 1;
+        }
+        self.blocks += self.batch_len;
+
+        if (self.cursor != start_cursor) {
+            if (self.observer) |observer| {
+                try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+            }
+            return true;
+        }
+        if (self.block_size == 0 and self.cursor / 8 == self.in_end and self.source_eof) return false;
+        // No progress with a full buffer: a block larger than any bzip2 block
+        return error.CorruptedStream;
+    }
+
+    /// Move the cursor `bits` bits forward
+    fn advance(self: *ParallelReader, bits: usize) void {
+        const before = self.cursor / 8;
+        self.cursor += bits;
+        self.compressed_bytes += self.cursor / 8 - before;
+    }
+
+    /// Move unread input to the front and top the buffer up
+    fn fill(self: *ParallelReader) !void {
+        const keep = self.cursor / 8;
+        std.mem.copyForwards(u8, self.in_buf[0 .. self.in_end - keep], self.in_buf[keep..self.in_end]);
+        self.in_end -= keep;
+        self.cursor -= keep * 8;
+
+        while (self.in_end < self.in_buf.len and !self.source_eof) {
+            const n = try self.source.read(self.in_buf[self.in_end..]);
+            if (n == 0) self.source_eof = true;
+            self.in_end += n;
+        }
+    }
+
+    /// Worker: decode one candidate block
+    fn workerTask(task: *Task) void {
+        trace.setThreadName("bzip2 worker");
+        decodeTask(task);
+    }
+
+    fn decodeTask(task: *Task) void {
+        const span = instrument.begin(.inflate);
+        defer span.end();
+
+        task.err = null;
+        task.output.clearRetainingCapacity();
+        task.result = task.decoder.decodeBlock(task.data, task.start, block.max_block_size, &task.output) catch |err| {
+            task.err = err;
+            return;
+        };
+    }
+};
+
+/// Decompress a complete bzip2 stream (one or more concatenated streams)
+///
+/// Errors:
+///   - error.CorruptedStream: Malformed or truncated input
+///   - error.ChecksumMismatch: A block or stream CRC does not match
+pub fn decompress(allocator: std.mem.Allocator, data: []const u8) ![]u8 {
+    var fbs = std.io.fixedBufferStream(data);
+    const source = fbs.reader();
+    var stream = try Bz2Reader.init(allocator, source.any());
+    defer stream.deinit();
+
+    return stream.reader().readAllAlloc(allocator, std.math.maxInt(usize));
+}
+
+// Tests
+
+const reference_text = "bzip2 sorts each block with the Burrows-Wheeler transform, then codes it with " ++
+    "move-to-front, run lengths and Huffman tables. Blocks start with the digits of pi, " ++
+    "so they can be found without decoding them. ";
+
+/// `reference_text ** 20` compressed by bzip2 1.0.8 at level 9
+const reference_stream = [_]u8{
+    0x42, 0x5a, 0x68, 0x39, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0xf3, 0x1e, 0xf2, 0x2f, 0x00, 0x02,
+    0x39, 0x9f, 0x80, 0x40, 0x07, 0x10, 0x00, 0x10, 0x40, 0x00, 0x80, 0x3f, 0xef, 0xdf, 0xb0, 0x40,
+    0x02, 0x5c, 0x00, 0x00, 0x31, 0x80, 0x00, 0x00, 0x00, 0x31, 0x80, 0x00, 0x00, 0x00, 0x31, 0x80,
+    0x00, 0x00, 0x00, 0x0a, 0x54, 0x84, 0xd1, 0x33, 0x53, 0x51, 0xe1, 0x18, 0x93, 0x13, 0x32, 0x6c,
+    0x4d, 0x89, 0xe4, 0x9f, 0x04, 0xe8, 0x4d, 0xc4, 0xfc, 0x26, 0x64, 0xfa, 0x26, 0xf2, 0x6a, 0x4c,
+    0x13, 0x04, 0xcc, 0x9a, 0x93, 0x22, 0x75, 0x27, 0x11, 0x36, 0x26, 0x64, 0xdc, 0x4d, 0xc2, 0x76,
+    0x26, 0xe2, 0x79, 0x27, 0xd1, 0x38, 0x93, 0xc1, 0x30, 0x4e, 0x64, 0xc1, 0x3c, 0x13, 0xd1, 0x39,
+    0x13, 0x79, 0x39, 0x93, 0x22, 0x66, 0x4f, 0xa2, 0x75, 0x2a, 0xec, 0x4e, 0x04, 0xd4, 0x9e, 0x89,
+    0xa9, 0x37, 0x13, 0x62, 0x6e, 0x26, 0x44, 0xf2, 0x4c, 0x15, 0x60, 0x9c, 0x44, 0xc8, 0x9b, 0xc9,
+    0xd0, 0x4c, 0x89, 0x99, 0x30, 0x4c, 0x13, 0xa0, 0x9e, 0x89, 0xf6, 0x4d, 0x09, 0xfd, 0x26, 0x84,
+    0xde, 0x4c, 0x09, 0xfe, 0x13, 0x32, 0x60, 0x99, 0x13, 0x79, 0x3e, 0xc9, 0xe0, 0x9d, 0x49, 0xc0,
+    0x9d, 0x09, 0xb1, 0x3b, 0x13, 0x04, 0xea, 0x4f, 0xe9, 0x17, 0xd9, 0x30, 0x45, 0xdc, 0x9c, 0xc4,
+    0xfd, 0x27, 0xb1, 0x3f, 0x42, 0x7a, 0x27, 0x01, 0x33, 0x27, 0x52, 0x77, 0x13, 0xf0, 0x9e, 0x09,
+    0x99, 0x3a, 0x13, 0x71, 0x3c, 0x13, 0x32, 0x76, 0x26, 0x42, 0x60, 0x9d, 0x09, 0x99, 0x33, 0x27,
+    0x72, 0x77, 0x27, 0x42, 0x7c, 0x89, 0xee, 0x27, 0xb1, 0x39, 0x13, 0x91, 0x35, 0x26, 0x09, 0xf2,
+    0x4f, 0x24, 0xd0, 0x9b, 0x13, 0x52, 0x6c, 0x4e, 0x24, 0xe4, 0x4e, 0x04, 0xd4, 0x9e, 0xe4, 0xf7,
+    0x26, 0x84, 0xde, 0x4e, 0x24, 0xde, 0x4e, 0x04, 0xc1, 0x3d, 0x13, 0xa9, 0x33, 0x27, 0x82, 0x6a,
+    0x55, 0xec, 0x4d, 0x89, 0xc8, 0x9a, 0x13, 0x42, 0x73, 0x26, 0x85, 0x59, 0x11, 0x60, 0x9d, 0x89,
+    0xe4, 0x99, 0x93, 0x52, 0x68, 0x4f, 0xd2, 0x64, 0x4e, 0x64, 0xee, 0x4c, 0x09, 0xb8, 0x26, 0x09,
+    0xc8, 0x9f, 0x04, 0xff, 0x8b, 0xb9, 0x22, 0x9c, 0x28, 0x48, 0x79, 0x8f, 0x79, 0x17, 0x80,
+};
+
+/// 250000 bytes of `multiBlockByte` compressed at level 1: three blocks
+const multi_block_stream = [_]u8{
+    0x42, 0x5a, 0x68, 0x31, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0x28, 0x1b, 0x68, 0xea, 0x00, 0x00,
+    0x00, 0x70, 0x00, 0x78, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x20, 0x00, 0x70, 0x43, 0x02, 0x02, 0x95,
+    0x43, 0xd4, 0xda, 0x66, 0x55, 0x55, 0x55, 0x5e, 0x80, 0x01, 0xf0, 0x00, 0x18, 0x00, 0x06, 0xd0,
+    0x94, 0x19, 0xfd, 0x09, 0x41, 0xca, 0x12, 0x83, 0x68, 0x4a, 0x0e, 0x98, 0xa0, 0xac, 0x93, 0x29,
+    0xac, 0x87, 0x4a, 0xd1, 0x92, 0x80, 0x07, 0x97, 0x1f, 0x80, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00,
+    0xf0, 0x00, 0x00, 0x01, 0xe0, 0x00, 0x10, 0x00, 0x44, 0x84, 0xd5, 0x51, 0xa6, 0x81, 0x81, 0x4a,
+    0xa1, 0xa1, 0xa6, 0x4c, 0x50, 0x94, 0x3e, 0xe6, 0x84, 0xa1, 0x84, 0x25, 0x0e, 0x90, 0x95, 0x56,
+    0x33, 0x55, 0x55, 0x55, 0x78, 0x00, 0x07, 0xa0, 0x00, 0x64, 0x00, 0x0d, 0xa8, 0x4b, 0x1a, 0xa8,
+    0x4b, 0x4a, 0x12, 0xda, 0x89, 0x36, 0x62, 0x82, 0xb2, 0x4c, 0xa6, 0xb3, 0x64, 0x7b, 0xd7, 0x22,
+    0x00, 0x61, 0xba, 0x06, 0x00, 0x00, 0x07, 0x80, 0x00, 0x40, 0x00, 0xa0, 0xcd, 0x34, 0x13, 0x54,
+    0x1c, 0x84, 0x55, 0x31, 0x08, 0xaa, 0x66, 0xa1, 0x15, 0x4e, 0x82, 0x2a, 0x9e, 0x2e, 0xe4, 0x8a,
+    0x70, 0xa1, 0x20, 0x1e, 0xf6, 0x1c, 0xe6,
+};
+
+fn multiBlockByte(i: usize) u8 {
+    return @truncate((i >> 16) * 31 + (i & 3));
+}
+
+fn expectMultiBlock(out: []const u8) !void {
+    try std.testing.expectEqual(@as(usize, 250_000), out.len);
+    for (out, 0..) |b, i| {
+        if (b != multiBlockByte(i)) return error.TestExpectedEqual;
+    }
+}
+
+test "Bz2Reader: decodes concatenated streams" {
+    const allocator = std.testing.allocator;
+
+    const input = multi_block_stream ++ reference_stream;
+    var fbs = std.io.fixedBufferStream(&input);
+    const source = fbs.reader();
+    var stream = try Bz2Reader.init(allocator, source.any());
+    defer stream.deinit();
+    try stream.checkHeader();
+
+    const out = try stream.reader().readAllAlloc(allocator, 1 << 20);
+    defer allocator.free(out);
+    try expectMultiBlock(out[0..250_000]);
+    try std.testing.expectEqualStrings(reference_text ** 20, out[250_000..]);
+    try std.testing.expectEqual(@as(u64, 4), stream.blocks);
+    try std.testing.expectEqual(@as(u64, 2), stream.streams);
+    try std.testing.expectEqual(@as(u64, input.len), stream.compressed_bytes);
+}
+
+test "Bz2Reader: rejects truncated and corrupted streams" {
+    const allocator = std.testing.allocator;
+
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, reference_stream[0 .. reference_stream.len - 20]));
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, reference_stream[0 .. reference_stream.len - 3]));
+
+    // Block CRC (right after the header and block magic)
+    var bad_block = reference_stream;
+    bad_block[10] ^= 0x01;
+    try std.testing.expectError(error.ChecksumMismatch, decompress(allocator, &bad_block));
+
+    // Combined CRC (the top bit of the last byte is never padding)
+    var bad_stream = reference_stream;
+    bad_stream[bad_stream.len - 1] ^= 0x80;
+    try std.testing.expectError(error.ChecksumMismatch, decompress(allocator, &bad_stream));
+}
+
+test "ParallelReader: decodes blocks in order across batches" {
+    const allocator = std.testing.allocator;
+
+    const input = multi_block_stream ++ reference_stream ++ multi_block_stream;
+    for ([_]usize{ 1, 2 }) |blocks_per_thread| {
+        var fbs = std.io.fixedBufferStream(&input);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2, .blocks_per_thread = blocks_per_thread });
+        defer parallel.deinit();
+
+        const out = try parallel.reader().readAllAlloc(allocator, 1 << 20);
+        defer allocator.free(out);
+        try expectMultiBlock(out[0..250_000]);
+        try std.testing.expectEqualStrings(reference_text ** 20, out[250_000..][0 .. reference_text.len * 20]);
+        try expectMultiBlock(out[250_000 + reference_text.len * 20 ..]);
+        try std.testing.expectEqual(@as(u64, 7), parallel.blocks);
+        try std.testing.expectEqual(@as(u64, 3), parallel.streams);
+        try std.testing.expectEqual(@as(u64, input.len), parallel.compressed_bytes);
+        try std.testing.expectEqual(@as(u64, out.len), parallel.uncompressed_bytes);
+    }
+
+    {
+        // Combined CRC of the middle stream
+        var bad = input;
+        bad[multi_block_stream.len + reference_stream.len - 1] ^= 0x80;
+        var fbs = std.io.fixedBufferStream(&bad);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2 });
+        defer parallel.deinit();
+
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            parallel.reader().readAllAlloc(allocator, 1 << 20),
+        );
+    }
+}
@@ -0,0 +1,494 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! bzip2 block decoder
+//!
+//! A block is a bit-packed, MSB-first record: the 48-bit block magic (the
+//! BCD digits of pi), the CRC of its decoded bytes, the BWT origin
+//! pointer, the byte map, Huffman selectors and code lengths, and finally
+//! the Huffman-coded MTF/RLE2 symbols. Decoding undoes each stage in turn:
+//! Huffman, move-to-front with RUNA/RUNB zero runs, the inverse
+//! Burrows-Wheeler transform, then the initial run-length encoding (four
+//! equal bytes followed by a repeat count).
+//!
+//! Blocks are not byte-aligned and do not record their compressed size,
+//! but the magic is distinctive enough to find them by scanning, which is
+//! what lets blocks be decoded in parallel.
+
+const std = @import("std");
+
+/// Block header magic (BCD pi)
+pub const block_magic: u48 = 0x314159265359;
+
+/// End-of-stream magic (BCD sqrt(pi))
+pub const end_magic: u48 = 0x177245385090;
+
+/// Largest block (level 9); a stream's limit is its level times 100000
+pub const max_block_size: usize = 900_000;
+
+/// Largest compressed block: every symbol at the maximum code length,
+/// plus the tables
+pub const max_compressed_size: usize = (max_block_size + 1) * max_code_length / 8 + 64 * 1024;
+
+const max_groups = 6;
+const max_alpha_size = 258;
+const max_code_length = 20;
+const group_size = 50;
+const max_selectors = 2 + max_block_size / group_size;
+
+/// Codes up to this length decode with one table lookup
+const lookup_bits = 10;
+
+/// MSB-first bit reader over an in-memory buffer
+pub const BitReader = struct {
+    data: []const u8,
+
+    /// Next byte to load
+    index: usize,
+
+    /// Loaded bits, right-aligned; only the low `count` bits are valid
+    buffer: u64 = 0,
+    count: usize = 0,
+
+    /// Start reading at bit `bit_pos` of `data`
+    pub fn init(data: []const u8, bit_pos: usize) BitReader {
+        var self = BitReader{ .data = data, .index = bit_pos / 8 };
+        const skip = bit_pos % 8;
+        if (skip != 0 and self.index < data.len) {
+            self.buffer = data[self.index];
+            self.index += 1;
+            self.count = 8 - skip;
+        }
+        return self;
+    }
+
+    /// Bit position of the next unread bit
+    pub fn bitPosition(self: *const BitReader) usize {
+        return self.index * 8 - self.count;
+    }
+
+    /// Read `n` (at most 32) bits
+    ///
+    /// Errors:
+    ///   - error.EndOfStream: Fewer than `n` bits left
+    pub fn readBits(self: *BitReader, n: u6) !u32 {
+        if (self.count < n) {
+            self.refill();
+            if (self.count < n) return error.EndOfStream;
+        }
+        self.count -= n;
+        return @truncate((self.buffer >> @intCast(self.count)) & ((@as(u64, 1) << n) - 1));
+    }
+
+    /// Read a 48-bit magic number
+    pub fn readMagic(self: *BitReader) !u48 {
+        const high: u48 = try self.readBits(24);
+        return high << 24 | try self.readBits(24);
+    }
+
+    /// Next `n` bits without consuming them, zero-padded at the end of data
+    fn peek(self: *BitReader, comptime n: u6) u32 {
+        if (self.count < n) self.refill();
+        const mask = (@as(u64, 1) << n) - 1;
+        if (self.count >= n) return @truncate((self.buffer >> @intCast(self.count - n)) & mask);
+        return @truncate((self.buffer << @intCast(n - self.count)) & mask);
+    }
+
+    fn consume(self: *BitReader, n: usize) !void {
+        if (n > self.count) return error.EndOfStream;
+        self.count -= n;
+    }
+
+    fn refill(self: *BitReader) void {
+        while (self.count <= 56 and self.index < self.data.len) {
+            self.buffer = self.buffer << 8 | self.data[self.index];
+            self.index += 1;
+            self.count += 8;
+        }
+    }
+};
+
+/// Canonical Huffman decoding table for one coding group
+const HuffmanTable = struct {
+    /// `length << 9 | symbol` for every `lookup_bits`-bit prefix of a
+    /// short code (0 = the code is longer)
+    lookup: [1 << lookup_bits]u16,
+
+    /// Largest code of each length, and the offset from a code to its
+    /// index in `symbols`
+    limit: [max_code_length + 1]i32,
+    offset: [max_code_length + 1]i32,
+
+    /// Symbols in code order
+    symbols: [max_alpha_size]u16,
+    max_length: usize,
+
+    fn build(self: *HuffmanTable, lengths: []const u8) !void {
+        var counts = [_]i32{0} ** (max_code_length + 1);
+        for (lengths) |len| counts[len] += 1;
+
+        var next_code: [max_code_length + 1]i32 = undefined;
+        var code: i32 = 0;
+        var index: i32 = 0;
+        self.max_length = 0;
+        for (1..max_code_length + 1) |len| {
+            next_code[len] = code;
+            self.offset[len] = index - code;
+            code += counts[len];
+            index += counts[len];
+            if (code > @as(i32, 1) << @intCast(len)) return error.CorruptedStream;
+            self.limit[len] = code - 1;
+            if (counts[len] > 0) self.max_length = len;
+            code <<= 1;
+        }
+
+        @memset(&self.lookup, 0);
+        for (lengths, 0..) |len, symbol| {
+            const c = next_code[len];
+            next_code[len] += 1;
+            self.symbols[@intCast(c + self.offset[len])] = @intCast(symbol);
+
+            if (len <= lookup_bits) {
+                const shift: u4 = @intCast(lookup_bits - len);
+                const first = @as(usize, @intCast(c)) << shift;
+                const entry = @as(u16, len) << 9 | @as(u16, @intCast(symbol));
+                @memset(self.lookup[first..][0 .. @as(usize, 1) << shift], entry);
+            }
+        }
+    }
+
+    fn decode(self: *const HuffmanTable, bits: *BitReader) !u16 {
+        const window = bits.peek(max_code_length);
+        const entry = self.lookup[window >> (max_code_length - lookup_bits)];
+        if (entry != 0) {
+            try bits.consume(entry >> 9);
+            return entry & 0x1ff;
+        }
+
+        var len: usize = lookup_bits + 1;
+        while (len <= self.max_length) : (len += 1) {
+            const code: i32 = @intCast(window >> @intCast(max_code_length - len));
+            if (code <= self.limit[len]) {
+                try bits.consume(len);
+                return self.symbols[@intCast(code + self.offset[len])];
+            }
+        }
+        return error.CorruptedStream;
+    }
+};
+
+/// Result of decoding one block
+pub const BlockResult = struct {
+    /// Bit position just past the block
+    end: usize,
+
+    /// CRC stored in (and verified against) the block
+    crc: u32,
+
+    /// Length of the BWT data, which a stream's level bounds
+    size: usize,
+};
+
+/// Reusable block decoder
+///
+/// Holds the 4-byte-per-position BWT vector (up to 3.6 MB, allocated on
+/// first use) and the per-block tables, so one decoder per thread
+/// decodes any number of blocks without further allocation.
+pub const Decoder = struct {
+    allocator: std.mem.Allocator,
+
+    /// BWT bytes in the low 8 bits, then the inverse transform links
+    tt: []u32 = &.{},
+
+    tables: [max_groups]HuffmanTable = undefined,
+    selectors: [max_selectors]u8 = undefined,
+
+    pub fn init(allocator: std.mem.Allocator) Decoder {
+        return .{ .allocator = allocator };
+    }
+
+    pub fn deinit(self: *Decoder) void {
+        self.allocator.free(self.tt);
+    }
+
+    /// Decode one block and append its bytes to `out`
+    ///
+    /// Parameters:
+    ///   - data: Buffer holding the block
+    ///   - start: Bit position of the block magic in `data`
+    ///   - max_size: Largest BWT length accepted
+    ///   - out: Receives the decoded bytes
+    ///
+    /// Returns:
+    ///   - End position, CRC and size of the block
+    ///
+    /// Errors:
+    ///   - error.EndOfStream: `data` ends inside the block
+    ///   - error.CorruptedStream: Malformed block
+    ///   - error.ChecksumMismatch: Decoded bytes do not match the block CRC
+    ///   - error.UnsupportedFormat: Randomized block (bzip2 0.9.0 and older)
+    ///   - error.OutOfMemory: Failed to grow `out` or the BWT vector
+    pub fn decodeBlock(
+        self: *Decoder,
+        data: []const u8,
+        start: usize,
+        max_size: usize,
+        out: *std.ArrayList(u8),
+    ) !BlockResult {
+        std.debug.assert(max_size <= max_block_size);
+        var bits = BitReader.init(data, start);
+        if (try bits.readMagic() != block_magic) return error.CorruptedStream;
+        const expected_crc = try bits.readBits(32);
+        if (try bits.readBits(1) != 0) return error.UnsupportedFormat;
+        const origin: usize = try bits.readBits(24);
+
+        // Bytes used in the block, in ascending order
+        var seq: [256]u8 = undefined;
+        var in_use: usize = 0;
+        const used = try bits.readBits(16);
+        for (0..16) |i| {
+            if (used & (@as(u32, 0x8000) >> @intCast(i)) == 0) continue;
+            const group = try bits.readBits(16);
+            for (0..16) |j| {
+                if (group & (@as(u32, 0x8000) >> @intCast(j)) == 0) continue;
+                seq[in_use] = @intCast(i * 16 + j);
+                in_use += 1;
+            }
+        }
+        if (in_use == 0) return error.CorruptedStream;
+        const alpha_size = in_use + 2;
+
+        // Which table codes each group of 50 symbols (MTF coded, unary)
+        const group_count = try bits.readBits(3);
+        if (group_count < 2 or group_count > max_groups) return error.CorruptedStream;
+        const selector_count = try bits.readBits(15);
+        if (selector_count == 0) return error.CorruptedStream;
+        var group_order = [max_groups]u8{ 0, 1, 2, 3, 4, 5 };
+        for (0..selector_count) |i| {
+            var j: usize = 0;
+            while (try bits.readBits(1) == 1) {
+                j += 1;
+                if (j >= group_count) return error.CorruptedStream;
+            }
+            const group = group_order[j];
+            std.mem.copyBackwards(u8, group_order[1 .. j + 1], group_order[0..j]);
+            group_order[0] = group;
+            // Selectors past the limit can never be used; bzip2 ignores them too
+            if (i < max_selectors) self.selectors[i] = group;
+        }
+        const selectors = self.selectors[0..@min(selector_count, max_selectors)];
+
+        // Code lengths, delta coded
+        var lengths: [max_alpha_size]u8 = undefined;
+        for (self.tables[0..group_count]) |*group_table| {
+            var len = try bits.readBits(5);
+            for (lengths[0..alpha_size]) |*length| {
+                while (true) {
+                    if (len < 1 or len > max_code_length) return error.CorruptedStream;
+                    if (try bits.readBits(1) == 0) break;
+                    if (try bits.readBits(1) == 0) len += 1 else len -= 1;
+                }
+                length.* = @intCast(len);
+            }
+            try group_table.build(lengths[0..alpha_size]);
+        }
+
+        if (self.tt.len < max_size) {
+            self.allocator.free(self.tt);
+            self.tt = &.{};
+            self.tt = try self.allocator.alloc(u32, max_size);
+        }
+        const tt = self.tt;
+
+        // Huffman, then RUNA/RUNB zero runs and move-to-front
+        var mtf: [256]u8 = undefined;
+        @memcpy(mtf[0..in_use], seq[0..in_use]);
+        var counts = [_]u32{0} ** 256;
+        const end_of_block = alpha_size - 1;
+        var n: usize = 0;
+        var run: usize = 0;
+        var weight: usize = 1;
+        var selector: usize = 0;
+        var group_left: usize = 0;
+        var table: *const HuffmanTable = undefined;
+        while (true) {
+            if (group_left == 0) {
+                if (selector >= selectors.len) return error.CorruptedStream;
+                table = &self.tables[selectors[selector]];
+                selector += 1;
+                group_left = group_size;
+            }
+            group_left -= 1;
+
+            const symbol = try table.decode(&bits);
+            if (symbol <= 1) {
+                run += weight << @intCast(symbol);
+                weight <<= 1;
+                if (run > max_size) return error.CorruptedStream;
+                continue;
+            }
+            if (run > 0) {
+                if (run > max_size - n) return error.CorruptedStream;
+                const run_byte = mtf[0];
+                counts[run_byte] += @intCast(run);
+                @memset(tt[n..][0..run], run_byte);
+                n += run;
+                run = 0;
+                weight = 1;
+            }
+            if (symbol == end_of_block) break;
+
+            if (n >= max_size) return error.CorruptedStream;
+            const k = symbol - 1;
+            const byte = mtf[k];
+            std.mem.copyBackwards(u8, mtf[1 .. k + 1], mtf[0..k]);
+            mtf[0] = byte;
+            counts[byte] += 1;
+            tt[n] = byte;
+            n += 1;
+        }
+        if (origin >= n) return error.CorruptedStream;
+
+        // Inverse BWT: link each position to the next in the high 24 bits
+        var next: [256]u32 = undefined;
+        var sum: u32 = 0;
+        for (&next, counts) |*slot, count| {
+            slot.* = sum;
+            sum += count;
+        }
+        for (0..n) |i| {
+            const byte: u8 = @truncate(tt[i]);
+            tt[next[byte]] |= @as(u32, @intCast(i)) << 8;
+            next[byte] += 1;
+        }
+
+        // Walk the links, undoing the initial run-length encoding
+        const out_start = out.items.len;
+        try out.ensureUnusedCapacity(n);
+        var pos = tt[origin] >> 8;
+        var last: u16 = 256;
+        var repeat: u8 = 0;
+        var left = n;
+        while (left > 0) : (left -= 1) {
+            const entry = tt[pos];
+            pos = entry >> 8;
+            const byte: u8 = @truncate(entry);
+
+            if (repeat == 4) {
+                try out.ensureUnusedCapacity(@as(usize, byte) + left);
+                out.appendNTimesAssumeCapacity(@intCast(last), byte);
+                repeat = 0;
+                continue;
+            }
+            if (byte == last) {
+                repeat += 1;
+            } else {
+                last = byte;
+                repeat = 1;
+            }
+            out.appendAssumeCapacity(byte);
+        }
+
+        if (std.hash.crc.Crc32Bzip2.hash(out.items[out_start..]) != expected_crc) return error.ChecksumMismatch;
+        return .{ .end = bits.bitPosition(), .crc = expected_crc, .size = n };
+    }
+};
+
+/// For each value of the second byte of a 7-byte window, the bit offsets
+/// (within the first byte) at which the block magic could start
+const magic_offsets: [256]u8 = blk: {
+    var offsets = [_]u8{0} ** 256;
+    for (0..8) |s| {
+        offsets[@as(u8, @truncate(block_magic >> (32 + s)))] |= 1 << s;
+    }
+    break :blk offsets;
+};
+
+/// Find the next block magic at or after bit `start`
+///
+/// The magic can start at any bit. A cheap table test on one byte rules
+/// out almost every position before the full 48-bit comparison.
+///
+/// Returns:
+///   - Bit position of the magic, or null if there is none
+pub fn findBlockMagic(data: []const u8, start: usize) ?usize {
+    var i = start / 8;
+    while (i + 6 <= data.len) : (i += 1) {
+        const offsets = magic_offsets[data[i + 1]];
+        if (offsets == 0) continue;
+
+        // The 56 bits from byte i (zero-filled past the end)
+        var window: u64 = 0;
+        for (0..7) |k| {
+            window = window << 8 | (if (i + k < data.len) data[i + k] else 0);
+        }
+        for (0..8) |s| {
+            if (offsets & (@as(u8, 1) << @intCast(s)) == 0) continue;
+            const pos = i * 8 + s;
+            if (pos < start or (s > 0 and i + 7 > data.len)) continue;
+            if (@as(u48, @truncate(window >> @intCast(8 - s))) == block_magic) return pos;
+        }
+    }
+    return null;
+}
+
+// Tests
+
+test "findBlockMagic: finds the magic at every bit offset" {
+    for (0..8) |s| {
+        var buf = [_]u8{0x55} ++ [_]u8{0} ** 10;
+        const value = @as(u64, block_magic) << @intCast(16 - s);
+        std.mem.writeInt(u64, buf[1..9], value, .big);
+
+        try std.testing.expectEqual(@as(?usize, 8 + s), findBlockMagic(&buf, 0));
+        try std.testing.expectEqual(@as(?usize, 8 + s), findBlockMagic(&buf, 8 + s));
+        try std.testing.expectEqual(@as(?usize, null), findBlockMagic(&buf, 9 + s));
+    }
+    try std.testing.expectEqual(@as(?usize, null), findBlockMagic(&[_]u8{ 0x31, 0x41, 0x59, 0x26, 0x53 }, 0));
+}
+
+test "Decoder: decodes a block and checks its CRC" {
+    const allocator = std.testing.allocator;
+
+    // "banana" * 3 at level 1: header, then one block from bit 32
+    const stream = [_]u8{
+        0x42, 0x5a, 0x68, 0x31, 0x31, 0x41, 0x59, 0x26, 0x53, 0x59, 0x19, 0x96, 0x27, 0x44, 0x00, 0x00,
+        0x05, 0x81, 0x00, 0x30, 0x01, 0x20, 0x00, 0x30, 0xcc, 0x08, 0x9a, 0x43, 0x32, 0x1c, 0x5d, 0xc9,
+        0x14, 0xe1, 0x42, 0x40, 0x66, 0x58, 0x9d, 0x10,
+    };
+
+    var decoder = Decoder.init(allocator);
+    defer decoder.deinit();
+    var out = std.ArrayList(u8).init(allocator);
+    defer out.deinit();
+
+    try std.testing.expectEqual(@as(?usize, 32), findBlockMagic(&stream, 0));
+    const result = try decoder.decodeBlock(&stream, 32, 100_000, &out);
+    try std.testing.expectEqualStrings("banana" ** 3, out.items);
+    try std.testing.expectEqual(@as(usize, 18), result.size);
+
+    var bits = BitReader.init(&stream, result.end);
+    try std.testing.expectEqual(end_magic, try bits.readMagic());
+    try std.testing.expectEqual(result.crc, try bits.readBits(32));
+
+    // Too short for the block
+    out.clearRetainingCapacity();
+    try std.testing.expectError(error.EndOfStream, decoder.decodeBlock(stream[0..28], 32, 100_000, &out));
+
+    var bad = stream;
+    bad[10] ^= 0x01;
+    out.clearRetainingCapacity();
+    try std.testing.expectError(error.ChecksumMismatch, decoder.decodeBlock(&bad, 32, 100_000, &out));
+}
@@ -21,6 +21,7 @@
 //! The CRC-32 is used to verify data integrity in gzip archives.
 
 const std = @import("std");
+const instrument = @import("../core/instrument.zig");
 
 /// CRC-32 polynomial (IEEE 802.3)
 /// This is the standard polynomial used by gzip, zlib, PNG, Ethernet, etc.
@@ -68,6 +69,9 @@ const table_initialized = true;
 /// const checksum = crc32("Hello, World!");
 /// ```
 pub fn crc32(data: []const u8) u32 {
+    const span = instrument.begin(.crc);
+    defer span.end();
+
     var c: u32 = 0xFFFFFFFF; // Initialize to all 1s
 
     for (data) |byte| {
@@ -90,6 +94,9 @@ pub const Crc32 = struct {
 
     /// Update the CRC-32 with new data
     pub fn update(self: *Crc32, data: []const u8) void {
+        const span = instrument.begin(.crc);
+        defer span.end();
+
         for (data) |byte| {
             const index: u8 = @truncate((self.value ^ byte) & 0xFF);
             self.value = crc32_table[index] ^ (self.value >> 8);
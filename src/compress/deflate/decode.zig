@@ -30,8 +30,7 @@ const zlib_mod = @import("../zlib.zig");
 
 /// Deflate container format
 pub const Container = enum {
-    /// Raw deflate stream (no header/footer)
-    /// Note: Phase 1 implementation wraps raw deflate with zlib framing
+    /// Raw deflate stream (no header/footer), e.g. ZIP members
     raw,
     /// Zlib format (RFC 1950): 2-byte header + deflate + 4-byte Adler32
     zlib,
@@ -39,12 +38,11 @@ pub const Container = enum {
     gzip,
 
     /// Convert to zlib.Format
-    /// Returns error.UnsupportedContainer for raw deflate (not implemented in Phase 1)
     fn toZlibFormat(self: Container) !zlib_mod.Format {
         return switch (self) {
             .gzip => .gzip,
             .zlib => .zlib,
-            .raw => error.UnsupportedContainer,
+            .raw => .raw,
         };
     }
 };
@@ -103,7 +101,6 @@ pub const DeflateDecoder = struct {
     ///   - Caller owns the returned memory and must free it
     ///
     /// Errors:
-    ///   - error.UnsupportedContainer: Raw deflate is not supported in Phase 1
     ///   - error.CompressionFailed: Corrupted or invalid compressed stream
     ///   - error.OutOfMemory: Memory allocation failed
     ///
@@ -137,13 +134,9 @@ pub const DeflateDecoder = struct {
 };
 
 /// Convenience function: decompress raw deflate data
-///
-/// Note: Raw deflate is not supported in Phase 1
-/// Phase 2+ will handle true raw deflate streams
 pub fn decompressRaw(allocator: std.mem.Allocator, compressed: []const u8) ![]u8 {
-    _ = allocator;
-    _ = compressed;
-    return error.UnsupportedContainer;
+    const decoder = DeflateDecoder.init(allocator, .raw);
+    return decoder.decompress(compressed);
 }
 
 /// Convenience function: decompress zlib data
@@ -0,0 +1,1202 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! LZ4 frame format support
+//!
+//! The fastest codec zarc offers: a byte-aligned LZ77 with no entropy
+//! coding. Frames carry a descriptor (block size, block independence,
+//! optional content size and xxHash32 checksums) followed by blocks, each
+//! prefixed with its compressed size. When blocks are independent their
+//! boundaries are known without decoding, so `compress` and
+//! `ParallelReader` handle them one per core. Frames with linked blocks
+//! (matches reaching into the previous block) are decoded in order.
+
+const std = @import("std");
+const instrument = @import("../core/instrument.zig");
+const trace = @import("../core/trace.zig");
+const types = @import("../core/types.zig");
+
+pub const block = @import("lz4/block.zig");
+
+/// LZ4 frame magic number
+pub const magic_number: u32 = 0x184D2204;
+
+/// Magic number of the legacy (pre-frame) format written by old `lz4 -l`
+pub const legacy_magic_number: u32 = 0x184C2102;
+
+const skippable_magic_base: u32 = 0x184D2A50;
+
+/// Flag in a block size word marking a stored (uncompressed) block
+const uncompressed_flag: u32 = 0x80000000;
+
+/// Largest block size any frame may declare
+pub const max_block_size: usize = 4 * 1024 * 1024;
+
+/// Largest frame header (magic, descriptor with content size and
+/// dictionary id, header checksum)
+pub const max_header_size: usize = 19;
+
+/// History linked blocks may reference
+const history_size: usize = 64 * 1024;
+
+/// Whether `magic` starts a skippable frame
+pub fn isSkippable(magic: u32) bool {
+    return magic & 0xFFFFFFF0 == skippable_magic_base;
+}
+
+/// Maximum block size declared in a frame descriptor
+pub const BlockSize = enum(u3) {
+    max64KB = 4,
+    max256KB = 5,
+    max1MB = 6,
+    max4MB = 7,
+
+    pub fn bytes(self: BlockSize) usize {
+        return @as(usize, 1) << (8 + 2 * @as(u5, @intFromEnum(self)));
+    }
+};
+
+/// Parsed frame header
+pub const FrameHeader = struct {
+    block_size: BlockSize,
+
+    /// Whether blocks are independent (no matches into earlier blocks)
+    independent: bool,
+
+    /// Whether each block is followed by an xxHash32 of its stored bytes
+    block_checksum: bool,
+
+    /// Whether the frame ends with an xxHash32 of its content
+    content_checksum: bool,
+
+    /// Decoded size, when the encoder recorded it
+    content_size: ?u64,
+
+    /// Header size, magic number included
+    size: usize,
+
+    /// Parse a frame header
+    ///
+    /// Returns:
+    ///   - null if `data` ends before the header does
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Bad magic number, reserved bits or header checksum
+    ///   - error.UnsupportedVersion: Frame version other than 1
+    ///   - error.UnsupportedFormat: Legacy frame or dictionary frame
+    pub fn parse(data: []const u8) !?FrameHeader {
+        if (data.len < 4) return null;
+        const magic = std.mem.readInt(u32, data[0..4], .little);
+        if (magic == legacy_magic_number) return error.UnsupportedFormat;
+        if (magic != magic_number) return error.CorruptedStream;
+        if (data.len < 7) return null;
+
+        const flags = data[4];
+        const descriptor = data[5];
+        if (flags >> 6 != 1) return error.UnsupportedVersion;
+        if (flags & 0x02 != 0 or descriptor & 0x8f != 0) return error.CorruptedStream;
+        const size_id: u3 = @intCast(descriptor >> 4);
+        if (size_id < 4) return error.CorruptedStream;
+
+        const has_content_size = flags & 0x08 != 0;
+        const has_dictionary = flags & 0x01 != 0;
+        const size = 7 + @as(usize, if (has_content_size) 8 else 0) + @as(usize, if (has_dictionary) 4 else 0);
+        if (data.len < size) return null;
+
+        const checksum: u8 = @truncate(std.hash.XxHash32.hash(0, data[4 .. size - 1]) >> 8);
+        if (checksum != data[size - 1]) return error.CorruptedStream;
+        if (has_dictionary) return error.UnsupportedFormat;
+
+        return .{
+            .block_size = @enumFromInt(size_id),
+            .independent = flags & 0x20 != 0,
+            .block_checksum = flags & 0x10 != 0,
+            .content_checksum = flags & 0x04 != 0,
+            .content_size = if (has_content_size) std.mem.readInt(u64, data[6..14], .little) else null,
+            .size = size,
+        };
+    }
+};
+
+/// Streaming LZ4 frame decompressor over any reader
+///
+/// Memory is one block of input plus one block of output (and 64 KiB of
+/// history for linked blocks). Compressed and uncompressed byte counts
+/// are tracked exactly and reported to the observer after every block.
+///
+/// Example:
+/// ```zig
+/// var lz4 = try Lz4Reader.init(allocator, source);
+/// defer lz4.deinit();
+///
+/// const n = try lz4.read(&buffer);
+/// ```
+pub const Lz4Reader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+
+    /// Compressed input buffer (grown to hold a whole block) and its
+    /// unconsumed window
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    source_eof: bool = false,
+
+    /// Decoded output; for linked blocks the bytes before `out_start`
+    /// are kept as history
+    window: []u8 = &.{},
+    out_start: usize = 0,
+    out_end: usize = 0,
+
+    /// Header of the frame being decoded (null between frames)
+    frame: ?FrameHeader = null,
+    frame_output: u64 = 0,
+    hasher: std.hash.XxHash32 = std.hash.XxHash32.init(0),
+
+    finished: bool = false,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    /// Frames fully decoded and checked
+    frames: u64 = 0,
+
+    /// Progress observer, called after each block
+    observer: ?types.StreamObserver = null,
+
+    pub const Reader = std.io.Reader(*Lz4Reader, anyerror, read);
+
+    /// Initialize a streaming decompressor
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate the input buffer
+    pub fn init(allocator: std.mem.Allocator, source: std.io.AnyReader) !Lz4Reader {
+        return .{
+            .allocator = allocator,
+            .source = source,
+            .in_buf = try allocator.alloc(u8, types.BufferSize.default),
+        };
+    }
+
+    /// Release buffers
+    pub fn deinit(self: *Lz4Reader) void {
+        self.allocator.free(self.window);
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input
+    ///   - error.ChecksumMismatch: A block or frame failed its xxHash32 check
+    ///   - error.UnsupportedFormat: Legacy or dictionary frame
+    ///   - (Any error returned by the observer)
+    pub fn read(self: *Lz4Reader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (self.out_start == self.out_end) {
+            if (self.finished) return 0;
+            try self.decodeStep();
+        }
+        const n = @min(dest.len, self.out_end - self.out_start);
+        @memcpy(dest[0..n], self.window[self.out_start..][0..n]);
+        self.out_start += n;
+        return n;
+    }
+
+    /// Decompress and discard up to `count` bytes
+    ///
+    /// Returns:
+    ///   - Number of bytes skipped (less than `count` only at end of stream)
+    pub fn skip(self: *Lz4Reader, count: u64) anyerror!u64 {
+        var skipped: u64 = 0;
+        while (skipped < count) {
+            if (self.out_start == self.out_end) {
+                if (self.finished) break;
+                try self.decodeStep();
+                continue;
+            }
+            const n: usize = @intCast(@min(count - skipped, @as(u64, self.out_end - self.out_start)));
+            self.out_start += n;
+            skipped += n;
+        }
+        return skipped;
+    }
+
+    /// Buffer the start of the stream and check its magic number
+    ///
+    /// Must be called before any data has been read.
+    ///
+    /// Errors:
+    ///   - error.DecompressionFailed: Input is empty or not an LZ4 frame
+    pub fn checkHeader(self: *Lz4Reader) !void {
+        std.debug.assert(self.compressed_bytes == 0 and self.in_start == 0);
+
+        if (!try self.ensure(4)) return error.DecompressionFailed;
+        const magic = std.mem.readInt(u32, self.in_buf[0..4], .little);
+        if (magic != magic_number and !isSkippable(magic)) return error.DecompressionFailed;
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *Lz4Reader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Start a frame, decode one block or finish a frame
+    fn decodeStep(self: *Lz4Reader) !void {
+        const frame = self.frame orelse return self.startFrame();
+        try self.decodeBlock(frame);
+    }
+
+    fn startFrame(self: *Lz4Reader) !void {
+        if (!try self.ensure(4)) {
+            if (self.in_start == self.in_end) {
+                self.finished = true;
+                return;
+            }
+            return error.CorruptedStream;
+        }
+
+        const magic = std.mem.readInt(u32, self.in_buf[self.in_start..][0..4], .little);
+        if (isSkippable(magic)) {
+            if (!try self.ensure(8)) return error.CorruptedStream;
+            const size = std.mem.readInt(u32, self.in_buf[self.in_start + 4 ..][0..4], .little);
+            self.consume(8);
+            return self.discard(size);
+        }
+
+        _ = try self.ensure(max_header_size);
+        const header = try FrameHeader.parse(self.in_buf[self.in_start..self.in_end]) orelse
+            return error.CorruptedStream;
+        self.consume(header.size);
+
+        // A whole block (plus its size word and checksum) must fit the input buffer
+        const block_max = header.block_size.bytes();
+        if (self.in_buf.len < block_max + 8) {
+            const leftover = self.in_end - self.in_start;
+            const in_buf = try self.allocator.alloc(u8, block_max + 8);
+            @memcpy(in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+            self.allocator.free(self.in_buf);
+            self.in_buf = in_buf;
+            self.in_start = 0;
+            self.in_end = leftover;
+        }
+
+        // Linked blocks keep 64 KiB of history and slide once per two blocks
+        const capacity = (if (header.independent) block_max else history_size + 2 * block_max) + block.wild_slack;
+        if (self.window.len < capacity) {
+            self.allocator.free(self.window);
+            self.window = &.{};
+            self.window = try self.allocator.alloc(u8, capacity);
+        }
+
+        self.hasher = std.hash.XxHash32.init(0);
+        self.frame = header;
+        self.frame_output = 0;
+        self.out_start = 0;
+        self.out_end = 0;
+    }
+
+    fn decodeBlock(self: *Lz4Reader, frame: FrameHeader) !void {
+        if (!try self.ensure(4)) return error.CorruptedStream;
+        const word = std.mem.readInt(u32, self.in_buf[self.in_start..][0..4], .little);
+        if (word == 0) {
+            self.consume(4);
+            return self.endFrame(frame);
+        }
+
+        const block_max = frame.block_size.bytes();
+        const size: usize = word & ~uncompressed_flag;
+        if (size > block_max) return error.CorruptedStream;
+        const checksum_size: usize = if (frame.block_checksum) 4 else 0;
+        if (!try self.ensure(4 + size + checksum_size)) return error.CorruptedStream;
+        self.consume(4);
+
+        const src = self.in_buf[self.in_start..][0..size];
+        if (frame.block_checksum) {
+            const expected = std.mem.readInt(u32, self.in_buf[self.in_start + size ..][0..4], .little);
+            if (std.hash.XxHash32.hash(0, src) != expected) return error.ChecksumMismatch;
+        }
+
+        self.makeRoom(frame.independent, block_max);
+        const pos = self.out_end;
+        const produced = blk: {
+            const span = instrument.begin(.inflate);
+            defer span.end();
+
+            const n = if (word & uncompressed_flag != 0) stored: {
+                @memcpy(self.window[pos..][0..size], src);
+                break :stored size;
+            } else try block.decompressBlock(src, self.window, pos, pos + block_max);
+            if (frame.content_checksum) self.hasher.update(self.window[pos..][0..n]);
+            break :blk n;
+        };
+        self.consume(size + checksum_size);
+
+        self.out_end += produced;
+        self.frame_output += produced;
+        self.uncompressed_bytes += produced;
+
+        if (self.observer) |observer| {
+            try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+        }
+    }
+
+    fn endFrame(self: *Lz4Reader, frame: FrameHeader) !void {
+        if (frame.content_size) |size| {
+            if (size != self.frame_output) return error.CorruptedStream;
+        }
+        if (frame.content_checksum) {
+            if (!try self.ensure(4)) return error.CorruptedStream;
+            const expected = std.mem.readInt(u32, self.in_buf[self.in_start..][0..4], .little);
+            self.consume(4);
+            if (self.hasher.final() != expected) return error.ChecksumMismatch;
+        }
+        self.frame = null;
+        self.frames += 1;
+    }
+
+    /// Make room for one more block after the current output
+    fn makeRoom(self: *Lz4Reader, independent: bool, block_max: usize) void {
+        if (self.window.len - block.wild_slack - self.out_end >= block_max) return;
+        const keep = if (independent) 0 else @min(self.out_end, history_size);
+
+        std.mem.copyForwards(u8, self.window[0..keep], self.window[self.out_end - keep .. self.out_end]);
+        self.out_start = keep;
+        self.out_end = keep;
+    }
+
+    /// Buffer at least `n` bytes of input
+    ///
+    /// Returns:
+    ///   - false if the source ends first
+    fn ensure(self: *Lz4Reader, n: usize) !bool {
+        std.debug.assert(n <= self.in_buf.len);
+        if (self.in_end - self.in_start >= n) return true;
+
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < n and !self.source_eof) try self.fill();
+        return self.in_end >= n;
+    }
+
+    /// Read more input after the buffered bytes
+    fn fill(self: *Lz4Reader) !void {
+        const span = instrument.begin(.read);
+        defer span.end();
+
+        const n = try self.source.read(self.in_buf[self.in_end..]);
+        instrument.count(.bytes_read, n);
+        if (n == 0) self.source_eof = true;
+        self.in_end += n;
+    }
+
+    fn consume(self: *Lz4Reader, n: usize) void {
+        self.in_start += n;
+        self.compressed_bytes += n;
+    }
+
+    /// Skip `count` bytes of input (a skippable frame's payload)
+    fn discard(self: *Lz4Reader, count: u64) !void {
+        var left = count;
+        while (left > 0) {
+            if (self.in_start == self.in_end) {
+                if (self.source_eof) return error.CorruptedStream;
+                self.in_start = 0;
+                self.in_end = 0;
+                try self.fill();
+                continue;
+            }
+            const n: usize = @intCast(@min(left, @as(u64, self.in_end - self.in_start)));
+            self.consume(n);
+            left -= n;
+        }
+    }
+};
+
+/// Parallel LZ4 decompressor for frames with independent blocks
+///
+/// Reads a batch of whole blocks, decodes them on a thread pool (workers
+/// also check block checksums) and hands the output back in order. Content
+/// sizes and checksums are checked in stream order after each batch.
+/// Stored blocks are handed out straight from the input buffer.
+///
+/// At the first frame with linked blocks, the rest of the input is handed
+/// to an Lz4Reader instead.
+///
+/// Must not be moved after `init` (the pool keeps pointers into it).
+///
+/// Example:
+/// ```zig
+/// var parallel: ParallelReader = undefined;
+/// try parallel.init(allocator, file_reader.any(), .{ .threads = 8 });
+/// defer parallel.deinit();
+///
+/// const n = try parallel.read(&buffer);
+/// ```
+pub const ParallelReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+    pool: std.Thread.Pool,
+
+    /// Compressed input for the current batch and its unconsumed window
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    source_eof: bool = false,
+
+    /// One output slot per compressed block in a batch
+    out_buf: []u8,
+    tasks: []Task,
+    batch_len: usize = 0,
+    out_index: usize = 0,
+    out_pos: usize = 0,
+
+    /// Frame and block boundaries of the batch, in stream order
+    events: std.ArrayList(Event),
+
+    /// Frame being split into blocks
+    frame: ?FrameHeader = null,
+
+    /// Frame being checked, with its running checksum and size
+    checking: ?FrameHeader = null,
+    hasher: std.hash.XxHash32 = std.hash.XxHash32.init(0),
+    frame_output: u64 = 0,
+
+    /// Streaming decoder for the input from the first linked frame on
+    fallback: ?*Fallback = null,
+
+    /// Blocks decoded on the pool
+    blocks: u64 = 0,
+
+    /// Frames fully decoded and checked on the pool
+    frames: u64 = 0,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    pub const Options = struct {
+        /// Worker threads (0 = one per CPU)
+        threads: usize = 0,
+
+        /// Blocks decoded per batch, per thread
+        blocks_per_thread: usize = 4,
+
+        /// Size of each of the input and output batch buffers (raised to
+        /// hold at least one block of the largest size)
+        batch_size: usize = 64 * 1024 * 1024,
+    };
+
+    pub const Reader = std.io.Reader(*ParallelReader, anyerror, read);
+
+    const Task = struct {
+        input: []const u8 = &.{},
+        output: []u8 = &.{},
+        stored: bool = false,
+        checksum: ?u32 = null,
+        produced: usize = 0,
+        err: ?anyerror = null,
+
+        fn result(self: *const Task) []const u8 {
+            return if (self.stored) self.input else self.output[0..self.produced];
+        }
+    };
+
+    const Event = union(enum) {
+        frame_start: FrameHeader,
+        /// Task index
+        block: usize,
+        /// Expected content checksum, if any
+        frame_end: ?u32,
+    };
+
+    const Fallback = struct {
+        prefix: []const u8,
+        source: std.io.AnyReader,
+        stream: Lz4Reader,
+
+        /// `compressed_bytes` when the fallback took over
+        compressed_base: u64,
+
+        fn readChained(context: *const anyopaque, buffer: []u8) anyerror!usize {
+            const self: *Fallback = @constCast(@ptrCast(@alignCast(context)));
+            if (self.prefix.len > 0) {
+                const n = @min(buffer.len, self.prefix.len);
+                @memcpy(buffer[0..n], self.prefix[0..n]);
+                self.prefix = self.prefix[n..];
+                return n;
+            }
+            return self.source.read(buffer);
+        }
+    };
+
+    /// Initialize in place
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate batch buffers
+    ///   - (Errors from spawning pool threads)
+    pub fn init(self: *ParallelReader, allocator: std.mem.Allocator, source: std.io.AnyReader, options: Options) !void {
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+        const batch_blocks = @max(1, threads * options.blocks_per_thread);
+        const batch_size = @max(options.batch_size, max_block_size + max_header_size + 16);
+
+        const in_buf = try allocator.alloc(u8, batch_size);
+        errdefer allocator.free(in_buf);
+        const out_buf = try allocator.alloc(u8, batch_size);
+        errdefer allocator.free(out_buf);
+        const tasks = try allocator.alloc(Task, batch_blocks);
+        errdefer allocator.free(tasks);
+
+        self.* = .{
+            .allocator = allocator,
+            .source = source,
+            .pool = undefined,
+            .in_buf = in_buf,
+            .out_buf = out_buf,
+            .tasks = tasks,
+            .events = std.ArrayList(Event).init(allocator),
+        };
+        errdefer self.events.deinit();
+        try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+    }
+
+    /// Stop worker threads and free buffers
+    pub fn deinit(self: *ParallelReader) void {
+        self.pool.deinit();
+        if (self.fallback) |fallback| {
+            fallback.stream.deinit();
+            self.allocator.destroy(fallback);
+        }
+        self.events.deinit();
+        self.allocator.free(self.tasks);
+        self.allocator.free(self.out_buf);
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data in stream order
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input
+    ///   - error.ChecksumMismatch: A block or frame failed its xxHash32 check
+    ///   - error.UnsupportedFormat: Legacy or dictionary frame
+    pub fn read(self: *ParallelReader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (true) {
+            while (self.out_index < self.batch_len) {
+                const available = self.tasks[self.out_index].result();
+                if (self.out_pos < available.len) {
+                    const n = @min(dest.len, available.len - self.out_pos);
+                    @memcpy(dest[0..n], available[self.out_pos..][0..n]);
+                    self.out_pos += n;
+                    return n;
+                }
+                self.out_index += 1;
+                self.out_pos = 0;
+            }
+
+            if (self.fallback) |fallback| {
+                const n = try fallback.stream.read(dest);
+                self.compressed_bytes = fallback.compressed_base + fallback.stream.compressed_bytes;
+                self.uncompressed_bytes += n;
+                return n;
+            }
+
+            if (!try self.decodeBatch()) return 0;
+        }
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *ParallelReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Decode the next batch of blocks, or hand over to the fallback
+    ///
+    /// Returns:
+    ///   - false at the clean end of the input
+    fn decodeBatch(self: *ParallelReader) !bool {
+        try self.fill();
+        self.batch_len = 0;
+        self.out_index = 0;
+        self.out_pos = 0;
+
+        // Split the buffered input into frame headers, blocks and end marks
+        const start = self.in_start;
+        var pos = start;
+        var count: usize = 0;
+        var out_used: usize = 0;
+        while (count < self.tasks.len) {
+            const rest = self.in_buf[pos..self.in_end];
+            if (rest.len == 0) break;
+            if (rest.len < 4) {
+                if (self.source_eof) return error.CorruptedStream;
+                break;
+            }
+
+            const frame = self.frame orelse {
+                const magic = std.mem.readInt(u32, rest[0..4], .little);
+                if (isSkippable(magic)) {
+                    const frame_size = if (rest.len >= 8) 8 + @as(usize, std.mem.readInt(u32, rest[4..8], .little)) else 8;
+                    if (frame_size > rest.len) {
+                        if (self.source_eof) return error.CorruptedStream;
+                        break;
+                    }
+                    pos += frame_size;
+                    continue;
+                }
+
+                const header = try FrameHeader.parse(rest) orelse {
+                    if (self.source_eof) return error.CorruptedStream;
+                    break;
+                };
+                // Linked blocks must be decoded in order
+                if (!header.independent) break;
+
+                try self.events.append(.{ .frame_start = header });
+                self.frame = header;
+                pos += header.size;
+                continue;
+            };
+
+            const word = std.mem.readInt(u32, rest[0..4], .little);
+            if (word == 0) {
+                const end_size: usize = if (frame.content_checksum) 8 else 4;
+                if (end_size > rest.len) {
+                    if (self.source_eof) return error.CorruptedStream;
+                    break;
+                }
+                const expected: ?u32 = if (frame.content_checksum) std.mem.readInt(u32, rest[4..8], .little) else null;
+                try self.events.append(.{ .frame_end = expected });
+                self.frame = null;
+                pos += end_size;
+                continue;
+            }
+
+            const block_max = frame.block_size.bytes();
+            const size: usize = word & ~uncompressed_flag;
+            if (size > block_max) return error.CorruptedStream;
+            const checksum_size: usize = if (frame.block_checksum) 4 else 0;
+            if (4 + size + checksum_size > rest.len) {
+                if (self.source_eof) return error.CorruptedStream;
+                break;
+            }
+
+            const stored = word & uncompressed_flag != 0;
+            const slot = if (stored) 0 else block_max + block.wild_slack;
+            if (slot > self.out_buf.len - out_used) break;
+
+            self.tasks[count] = .{
+                .input = rest[4..][0..size],
+                .output = self.out_buf[out_used..][0..slot],
+                .stored = stored,
+                .checksum = if (frame.block_checksum) std.mem.readInt(u32, rest[4 + size ..][0..4], .little) else null,
+            };
+            try self.events.append(.{ .block = count });
+            count += 1;
+            out_used += slot;
+            pos += 4 + size + checksum_size;
+        }
+        self.compressed_bytes += pos - start;
+        self.in_start = pos;
+
+        if (count > 0) {
+            var wg: std.Thread.WaitGroup = .{};
+            for (self.tasks[0..count]) |*task| {
+                self.pool.spawnWg(&wg, decodeTask, .{task});
+            }
+            self.pool.waitAndWork(&wg);
+
+            for (self.tasks[0..count]) |task| {
+                if (task.err) |err| return err;
+            }
+        }
+        try self.checkFrames();
+        self.blocks += count;
+        self.batch_len = count;
+
+        if (count > 0 or pos > start) return true;
+        if (self.in_start == self.in_end) {
+            if (self.frame != null) return error.CorruptedStream;
+            return false;
+        }
+
+        // A linked frame, or a skippable frame larger than the buffer
+        try self.startFallback();
+        return true;
+    }
+
+    /// Check content sizes and checksums of the batch in stream order
+    fn checkFrames(self: *ParallelReader) !void {
+        const span = instrument.begin(.crc);
+        defer span.end();
+
+        for (self.events.items) |event| switch (event) {
+            .frame_start => |header| {
+                self.checking = header;
+                self.hasher = std.hash.XxHash32.init(0);
+                self.frame_output = 0;
+            },
+            .block => |index| {
+                const output = self.tasks[index].result();
+                if (self.checking.?.content_checksum) self.hasher.update(output);
+                self.frame_output += output.len;
+                self.uncompressed_bytes += output.len;
+            },
+            .frame_end => |expected| {
+                const header = self.checking.?;
+                if (header.content_size) |size| {
+                    if (size != self.frame_output) return error.CorruptedStream;
+                }
+                if (expected) |checksum| {
+                    if (self.hasher.final() != checksum) return error.ChecksumMismatch;
+                }
+                self.checking = null;
+                self.frames += 1;
+            },
+        };
+        self.events.clearRetainingCapacity();
+    }
+
+    /// Stream everything from the next frame on
+    fn startFallback(self: *ParallelReader) !void {
+        std.debug.assert(self.frame == null);
+        const fallback = try self.allocator.create(Fallback);
+        errdefer self.allocator.destroy(fallback);
+
+        fallback.* = .{
+            .prefix = self.in_buf[self.in_start..self.in_end],
+            .source = self.source,
+            .stream = undefined,
+            .compressed_base = self.compressed_bytes,
+        };
+        fallback.stream = try Lz4Reader.init(
+            self.allocator,
+            .{ .context = fallback, .readFn = Fallback.readChained },
+        );
+        self.in_start = self.in_end;
+        self.fallback = fallback;
+    }
+
+    /// Move unconsumed input to the front and top the buffer up
+    fn fill(self: *ParallelReader) !void {
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < self.in_buf.len and !self.source_eof) {
+            const n = try self.source.read(self.in_buf[self.in_end..]);
+            if (n == 0) self.source_eof = true;
+            self.in_end += n;
+        }
+    }
+
+    /// Worker: check and decode one block into its output slot
+    fn decodeTask(task: *Task) void {
+        trace.setThreadName("lz4 worker");
+        const span = instrument.begin(.inflate);
+        defer span.end();
+
+        task.err = null;
+        if (task.checksum) |expected| {
+            if (std.hash.XxHash32.hash(0, task.input) != expected) {
+                task.err = error.ChecksumMismatch;
+                return;
+            }
+        }
+        if (task.stored) return;
+
+        const end = task.output.len - block.wild_slack;
+        task.produced = block.decompressBlock(task.input, task.output, 0, end) catch |err| {
+            task.err = err;
+            return;
+        };
+    }
+};
+
+/// Options for `compress`
+pub const CompressOptions = struct {
+    block_size: BlockSize = .max4MB,
+
+    /// Worker threads (0 = one per CPU)
+    threads: usize = 1,
+
+    /// Record the content size in the frame header
+    content_size: bool = true,
+
+    /// Append an xxHash32 of the content
+    content_checksum: bool = true,
+
+    /// Follow every block with an xxHash32 of its stored bytes
+    block_checksum: bool = false,
+};
+
+const CompressTask = struct {
+    input: []const u8,
+    scratch: []u8,
+    block_checksum: bool,
+
+    /// Block as written: compressed, or the input itself when that is no larger
+    body: []const u8 = &.{},
+    stored: bool = false,
+    checksum: u32 = 0,
+
+    fn run(task: *CompressTask, table: *block.HashTable) void {
+        const n = block.compressBlock(task.input, task.scratch, table);
+        if (n >= task.input.len) {
+            task.body = task.input;
+            task.stored = true;
+        } else {
+            task.body = task.scratch[0..n];
+        }
+        if (task.block_checksum) task.checksum = std.hash.XxHash32.hash(0, task.body);
+    }
+
+    fn runPooled(task: *CompressTask) void {
+        trace.setThreadName("lz4 worker");
+        var table: block.HashTable = undefined;
+        task.run(&table);
+    }
+};
+
+fn hashContent(data: []const u8, result: *u32) void {
+    trace.setThreadName("lz4 worker");
+    result.* = std.hash.XxHash32.hash(0, data);
+}
+
+/// Compress data as one LZ4 frame of independent blocks
+///
+/// Blocks (and the content checksum) are computed on `options.threads`
+/// cores; the output is the same for any thread count.
+///
+/// Parameters:
+///   - allocator: Allocator for the result and scratch buffers
+///   - data: Input data
+///   - options: Block size, threads and checksums
+///
+/// Returns:
+///   - Compressed frame (caller owns)
+///
+/// Errors:
+///   - error.OutOfMemory: Failed to allocate
+pub fn compress(allocator: std.mem.Allocator, data: []const u8, options: CompressOptions) ![]u8 {
+    const block_max = options.block_size.bytes();
+    const block_count = std.math.divCeil(usize, data.len, block_max) catch unreachable;
+    const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+    const bound = block.compressBound(block_max);
+
+    const tasks = try allocator.alloc(CompressTask, block_count);
+    defer allocator.free(tasks);
+    const scratch = try allocator.alloc(u8, block_count * bound);
+    defer allocator.free(scratch);
+    for (tasks, 0..) |*task, i| {
+        const start = i * block_max;
+        task.* = .{
+            .input = data[start..@min(data.len, start + block_max)],
+            .scratch = scratch[i * bound ..][0..bound],
+            .block_checksum = options.block_checksum,
+        };
+    }
+
+    var content_hash: u32 = 0;
+    if (threads == 1 or block_count <= 1) {
+        var table: block.HashTable = undefined;
+        for (tasks) |*task| task.run(&table);
+        if (options.content_checksum) content_hash = std.hash.XxHash32.hash(0, data);
+    } else {
+        var pool: std.Thread.Pool = undefined;
+        try pool.init(.{ .allocator = allocator, .n_jobs = @min(threads, block_count) });
+        defer pool.deinit();
+
+        var wg: std.Thread.WaitGroup = .{};
+        if (options.content_checksum) pool.spawnWg(&wg, hashContent, .{ data, &content_hash });
+        for (tasks) |*task| pool.spawnWg(&wg, CompressTask.runPooled, .{task});
+        pool.waitAndWork(&wg);
+    }
+
+    var out = std.ArrayList(u8).init(allocator);
+    errdefer out.deinit();
+    var total: usize = max_header_size + 8;
+    for (tasks) |task| total += task.body.len + 8;
+    try out.ensureTotalCapacity(total);
+
+    // Frame header: version 1, independent blocks
+    var header: [max_header_size]u8 = undefined;
+    std.mem.writeInt(u32, header[0..4], magic_number, .little);
+    header[4] = 0x40 | 0x20 |
+        (if (options.block_checksum) @as(u8, 0x10) else 0) |
+        (if (options.content_size) @as(u8, 0x08) else 0) |
+        (if (options.content_checksum) @as(u8, 0x04) else 0);
+    header[5] = @as(u8, @intFromEnum(options.block_size)) << 4;
+    var header_len: usize = 6;
+    if (options.content_size) {
+        std.mem.writeInt(u64, header[6..14], data.len, .little);
+        header_len = 14;
+    }
+    header[header_len] = @truncate(std.hash.XxHash32.hash(0, header[4..header_len]) >> 8);
+    out.appendSliceAssumeCapacity(header[0 .. header_len + 1]);
+
+    var word: [4]u8 = undefined;
+    for (tasks) |task| {
+        const size: u32 = @intCast(task.body.len);
+        std.mem.writeInt(u32, &word, if (task.stored) size | uncompressed_flag else size, .little);
+        out.appendSliceAssumeCapacity(&word);
+        out.appendSliceAssumeCapacity(task.body);
+        if (options.block_checksum) {
+            std.mem.writeInt(u32, &word, task.checksum, .little);
+            out.appendSliceAssumeCapacity(&word);
+        }
+    }
+    out.appendSliceAssumeCapacity(&.{ 0, 0, 0, 0 });
+    if (options.content_checksum) {
+        std.mem.writeInt(u32, &word, content_hash, .little);
+        out.appendSliceAssumeCapacity(&word);
+    }
+    return out.toOwnedSlice();
+}
+
+/// Decompress a complete LZ4 stream (one or more frames)
+///
+/// Errors:
+///   - error.CorruptedStream: Malformed or truncated input
+///   - error.ChecksumMismatch: A block or frame failed its xxHash32 check
+///   - error.UnsupportedFormat: Legacy or dictionary frame
+pub fn decompress(allocator: std.mem.Allocator, data: []const u8) ![]u8 {
+    var fbs = std.io.fixedBufferStream(data);
+    const source = fbs.reader();
+    var stream = try Lz4Reader.init(allocator, source.any());
+    defer stream.deinit();
+
+    return stream.reader().readAllAlloc(allocator, std.math.maxInt(usize));
+}
+
+// Tests
+
+const reference_text = "LZ4 trades ratio for speed: literals and matches are byte-aligned, so " ++
+    "decoding is little more than copying. Independent blocks decode on " ++
+    "every core at once, while linked ones must run in order. ";
+
+/// `reference_text ** 4` compressed by liblz4: independent 64 KiB blocks,
+/// content size and content checksum
+const reference_frame = [_]u8{
+    0x04, 0x22, 0x4d, 0x18, 0x6c, 0x40, 0x08, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x82, 0xcf,
+    0x00, 0x00, 0x00, 0xf0, 0x81, 0x4c, 0x5a, 0x34, 0x20, 0x74, 0x72, 0x61, 0x64, 0x65, 0x73, 0x20,
+    0x72, 0x61, 0x74, 0x69, 0x6f, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x73, 0x70, 0x65, 0x65, 0x64, 0x3a,
+    0x20, 0x6c, 0x69, 0x74, 0x65, 0x72, 0x61, 0x6c, 0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6d, 0x61,
+    0x74, 0x63, 0x68, 0x65, 0x73, 0x20, 0x61, 0x72, 0x65, 0x20, 0x62, 0x79, 0x74, 0x65, 0x2d, 0x61,
+    0x6c, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x2c, 0x20, 0x73, 0x6f, 0x20, 0x64, 0x65, 0x63, 0x6f, 0x64,
+    0x69, 0x6e, 0x67, 0x20, 0x69, 0x73, 0x20, 0x6c, 0x69, 0x74, 0x74, 0x6c, 0x65, 0x20, 0x6d, 0x6f,
+    0x72, 0x65, 0x20, 0x74, 0x68, 0x61, 0x6e, 0x20, 0x63, 0x6f, 0x70, 0x79, 0x69, 0x6e, 0x67, 0x2e,
+    0x20, 0x49, 0x6e, 0x64, 0x65, 0x70, 0x65, 0x6e, 0x64, 0x65, 0x6e, 0x74, 0x20, 0x62, 0x6c, 0x6f,
+    0x63, 0x6b, 0x73, 0x20, 0x64, 0x65, 0x63, 0x6f, 0x64, 0x65, 0x20, 0x6f, 0x6e, 0x20, 0x65, 0x76,
+    0x65, 0x72, 0x79, 0x20, 0x63, 0x36, 0x00, 0xff, 0x1f, 0x61, 0x74, 0x20, 0x6f, 0x6e, 0x63, 0x65,
+    0x2c, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x20, 0x6c, 0x69, 0x6e, 0x6b, 0x65, 0x64, 0x20, 0x6f,
+    0x6e, 0x65, 0x73, 0x20, 0x6d, 0x75, 0x73, 0x74, 0x20, 0x72, 0x75, 0x6e, 0x20, 0x69, 0x6e, 0x20,
+    0x6f, 0x72, 0x64, 0x65, 0x72, 0x2e, 0x20, 0xc2, 0x00, 0xff, 0xff, 0x30, 0x50, 0x64, 0x65, 0x72,
+    0x2e, 0x20, 0x00, 0x00, 0x00, 0x00, 0x93, 0xed, 0x7c, 0xe2,
+};
+
+/// `reference_text ** 350` compressed by liblz4: linked 64 KiB blocks, no
+/// content size, block and content checksums
+const reference_linked_frame = [_]u8{
+    0x04, 0x22, 0x4d, 0x18, 0x54, 0x40, 0xae, 0xcd, 0x01, 0x00, 0x00, 0xff, 0xb3, 0x4c, 0x5a, 0x34,
+    0x20, 0x74, 0x72, 0x61, 0x64, 0x65, 0x73, 0x20, 0x72, 0x61, 0x74, 0x69, 0x6f, 0x20, 0x66, 0x6f,
+    0x72, 0x20, 0x73, 0x70, 0x65, 0x65, 0x64, 0x3a, 0x20, 0x6c, 0x69, 0x74, 0x65, 0x72, 0x61, 0x6c,
+    0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x6d, 0x61, 0x74, 0x63, 0x68, 0x65, 0x73, 0x20, 0x61, 0x72,
+    0x65, 0x20, 0x62, 0x79, 0x74, 0x65, 0x2d, 0x61, 0x6c, 0x69, 0x67, 0x6e, 0x65, 0x64, 0x2c, 0x20,
+    0x73, 0x6f, 0x20, 0x64, 0x65, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67, 0x20, 0x69, 0x73, 0x20, 0x6c,
+    0x69, 0x74, 0x74, 0x6c, 0x65, 0x20, 0x6d, 0x6f, 0x72, 0x65, 0x20, 0x74, 0x68, 0x61, 0x6e, 0x20,
+    0x63, 0x6f, 0x70, 0x79, 0x69, 0x6e, 0x67, 0x2e, 0x20, 0x49, 0x6e, 0x64, 0x65, 0x70, 0x65, 0x6e,
+    0x64, 0x65, 0x6e, 0x74, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x73, 0x20, 0x64, 0x65, 0x63, 0x6f,
+    0x64, 0x65, 0x20, 0x6f, 0x6e, 0x20, 0x65, 0x76, 0x65, 0x72, 0x79, 0x20, 0x63, 0x6f, 0x72, 0x65,
+    0x20, 0x61, 0x74, 0x20, 0x6f, 0x6e, 0x63, 0x65, 0x2c, 0x20, 0x77, 0x68, 0x69, 0x6c, 0x65, 0x20,
+    0x6c, 0x69, 0x6e, 0x6b, 0x65, 0x64, 0x20, 0x6f, 0x6e, 0x65, 0x73, 0x20, 0x6d, 0x75, 0x73, 0x74,
+    0x20, 0x72, 0x75, 0x6e, 0x20, 0x69, 0x6e, 0x20, 0x6f, 0x72, 0x64, 0x65, 0x72, 0x2e, 0x20, 0xc2,
+    0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x26, 0x50, 0x63, 0x65, 0x2c, 0x20, 0x77, 0xf7, 0x52, 0xd5, 0xf8, 0x13, 0x00, 0x00, 0x00,
+    0x0f, 0x62, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x2d, 0x50, 0x64, 0x65,
+    0x72, 0x2e, 0x20, 0xfe, 0x89, 0x3b, 0x7e, 0x00, 0x00, 0x00, 0x00, 0xa9, 0x8b, 0x65, 0x6f,
+};
+
+fn testData(allocator: std.mem.Allocator, len: usize) ![]u8 {
+    const data = try allocator.alloc(u8, len);
+    var prng = std.Random.DefaultPrng.init(0x124);
+    const random = prng.random();
+    var i: usize = 0;
+    while (i < len) {
+        const run = @min(len - i, random.intRangeAtMost(usize, 1, 3000));
+        const chunk = data[i..][0..run];
+        switch (random.uintLessThan(u8, 3)) {
+            0 => random.bytes(chunk),
+            1 => @memset(chunk, random.int(u8)),
+            else => for (chunk, i..) |*b, j| {
+                b.* = reference_text[j % reference_text.len];
+            },
+        }
+        i += run;
+    }
+    return data;
+}
+
+test "Lz4Reader: decodes reference frames, independent and linked" {
+    const allocator = std.testing.allocator;
+
+    var input = std.ArrayList(u8).init(allocator);
+    defer input.deinit();
+    try input.appendSlice(&reference_frame);
+    // Skippable frame with a 3-byte payload
+    try input.appendSlice(&.{ 0x50, 0x2a, 0x4d, 0x18, 3, 0, 0, 0, 1, 2, 3 });
+    try input.appendSlice(&reference_linked_frame);
+
+    var fbs = std.io.fixedBufferStream(input.items);
+    const source = fbs.reader();
+    var stream = try Lz4Reader.init(allocator, source.any());
+    defer stream.deinit();
+    try stream.checkHeader();
+
+    const out = try stream.reader().readAllAlloc(allocator, 1 << 20);
+    defer allocator.free(out);
+    try std.testing.expectEqualStrings(reference_text ** 4 ++ reference_text ** 350, out);
+    try std.testing.expectEqual(@as(u64, 2), stream.frames);
+    try std.testing.expectEqual(@as(u64, input.items.len), stream.compressed_bytes);
+}
+
+test "Lz4Reader: rejects truncated and corrupted frames" {
+    const allocator = std.testing.allocator;
+
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, reference_frame[0 .. reference_frame.len - 6]));
+
+    var bad_content = reference_frame;
+    bad_content[bad_content.len - 1] ^= 0xff;
+    try std.testing.expectError(error.ChecksumMismatch, decompress(allocator, &bad_content));
+
+    // Flip a literal in the first block: caught by its block checksum
+    var bad_block = reference_linked_frame;
+    bad_block[12] ^= 0x01;
+    try std.testing.expectError(error.ChecksumMismatch, decompress(allocator, &bad_block));
+
+    var bad_header = reference_frame;
+    bad_header[5] ^= 0x10;
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, &bad_header));
+}
+
+test "compress: round trips with any block size and thread count" {
+    const allocator = std.testing.allocator;
+
+    const data = try testData(allocator, 600 * 1024);
+    defer allocator.free(data);
+
+    for ([_]BlockSize{ .max64KB, .max256KB, .max4MB }) |block_size| {
+        const single = try compress(allocator, data, .{ .block_size = block_size, .block_checksum = true });
+        defer allocator.free(single);
+        const threaded = try compress(allocator, data, .{ .block_size = block_size, .block_checksum = true, .threads = 3 });
+        defer allocator.free(threaded);
+        try std.testing.expectEqualSlices(u8, single, threaded);
+        try std.testing.expect(single.len < data.len);
+
+        const out = try decompress(allocator, single);
+        defer allocator.free(out);
+        try std.testing.expectEqualSlices(u8, data, out);
+    }
+
+    const empty = try compress(allocator, "", .{});
+    defer allocator.free(empty);
+    const empty_out = try decompress(allocator, empty);
+    defer allocator.free(empty_out);
+    try std.testing.expectEqual(@as(usize, 0), empty_out.len);
+}
+
+test "ParallelReader: decodes blocks in order and streams linked frames" {
+    const allocator = std.testing.allocator;
+
+    const data = try testData(allocator, 500 * 1024);
+    defer allocator.free(data);
+    const frame = try compress(allocator, data, .{ .block_size = .max64KB });
+    defer allocator.free(frame);
+
+    var input = std.ArrayList(u8).init(allocator);
+    defer input.deinit();
+    try input.appendSlice(frame);
+    try input.appendSlice(&reference_frame);
+    try input.appendSlice(&reference_linked_frame);
+
+    var expected = std.ArrayList(u8).init(allocator);
+    defer expected.deinit();
+    try expected.appendSlice(data);
+    try expected.appendSlice(reference_text ** 4 ++ reference_text ** 350);
+
+    {
+        var fbs = std.io.fixedBufferStream(input.items);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2, .blocks_per_thread = 2 });
+        defer parallel.deinit();
+
+        const out = try parallel.reader().readAllAlloc(allocator, 1 << 22);
+        defer allocator.free(out);
+        try std.testing.expectEqualSlices(u8, expected.items, out);
+        try std.testing.expectEqual(@as(u64, 8 + 1), parallel.blocks);
+        try std.testing.expectEqual(@as(u64, 2), parallel.frames);
+        try std.testing.expectEqual(@as(u64, input.items.len), parallel.compressed_bytes);
+        try std.testing.expectEqual(@as(u64, expected.items.len), parallel.uncompressed_bytes);
+    }
+
+    {
+        // Corrupt the first frame's content checksum
+        input.items[frame.len - 1] ^= 0xff;
+
+        var fbs = std.io.fixedBufferStream(input.items);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2 });
+        defer parallel.deinit();
+
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            parallel.reader().readAllAlloc(allocator, 1 << 22),
+        );
+    }
+}
@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! LZ4 block format
+//!
+//! A block is a series of sequences: a token (literal length and match
+//! length nibbles), optional length extension bytes, the literals, a
+//! 16-bit little-endian offset and more match length bytes. The last
+//! sequence has literals only. Nothing is entropy coded, so decoding is
+//! mostly copying; the decoder copies in 16-byte chunks whenever the
+//! buffers have room to overshoot ("wild copy").
+
+const std = @import("std");
+
+pub const min_match = 4;
+
+/// The last 5 bytes of a block are always literals
+pub const last_literals = 5;
+
+/// The last match must start at least 12 bytes before the end of a block
+pub const mf_limit = 12;
+
+/// Largest match offset
+pub const max_distance = 65535;
+
+/// Spare bytes after a decode buffer that let wild copies run to the end
+pub const wild_slack = 32;
+
+const hash_log = 12;
+
+/// Misses before the match search starts skipping ahead faster
+const skip_trigger = 6;
+
+/// Match finder state for `compressBlock` (16 KiB; reuse it between blocks)
+pub const HashTable = [1 << hash_log]u32;
+
+/// Largest compressed size of `n` input bytes
+pub fn compressBound(n: usize) usize {
+    return n + n / 255 + 16;
+}
+
+inline fn read32(data: []const u8, i: usize) u32 {
+    return std.mem.readInt(u32, data[i..][0..4], .little);
+}
+
+inline fn read64(data: []const u8, i: usize) u64 {
+    return std.mem.readInt(u64, data[i..][0..8], .little);
+}
+
+inline fn hash(value: u32) u32 {
+    return (value *% 2654435761) >> (32 - hash_log);
+}
+
+/// Compress `src` as one independent block
+///
+/// Parameters:
+///   - src: Block content
+///   - dst: At least `compressBound(src.len)` bytes
+///   - table: Scratch match finder table
+///
+/// Returns:
+///   - Compressed size (may exceed `src.len` for incompressible input;
+///     frame writers store such blocks uncompressed)
+pub fn compressBlock(src: []const u8, dst: []u8, table: *HashTable) usize {
+    std.debug.assert(dst.len >= compressBound(src.len));
+    var op: usize = 0;
+    var anchor: usize = 0;
+
+    if (src.len > mf_limit) {
+        @memset(table, 0);
+        const match_limit = src.len - last_literals;
+        const ip_limit = src.len - mf_limit;
+        var ip: usize = 0;
+
+        search: while (true) {
+            // Find a match, stepping further after every 64 misses
+            var step: usize = 1;
+            var attempts: usize = 1 << skip_trigger;
+            var ref: usize = undefined;
+            while (true) {
+                if (ip > ip_limit) break :search;
+                const h = hash(read32(src, ip));
+                ref = table[h];
+                table[h] = @intCast(ip);
+                if (ref < ip and ip - ref <= max_distance and read32(src, ref) == read32(src, ip)) break;
+                ip += step;
+                step = attempts >> skip_trigger;
+                attempts += 1;
+            }
+
+            // Extend backwards over pending literals
+            while (ip > anchor and ref > 0 and src[ip - 1] == src[ref - 1]) {
+                ip -= 1;
+                ref -= 1;
+            }
+
+            const length = min_match + matchLength(src, ip + min_match, ref + min_match, match_limit);
+            op = writeSequence(dst, op, src[anchor..ip], ip - ref, length);
+            ip += length;
+            anchor = ip;
+            if (ip > ip_limit) break;
+
+            const back = ip - 2;
+            table[hash(read32(src, back))] = @intCast(back);
+        }
+    }
+
+    return writeLastLiterals(dst, op, src[anchor..]);
+}
+
+/// Number of equal bytes at `start` and `ref`, stopping at `limit`
+inline fn matchLength(src: []const u8, start: usize, ref: usize, limit: usize) usize {
+    var i = start;
+    var r = ref;
+    while (i + 8 <= limit) {
+        const diff = read64(src, i) ^ read64(src, r);
+        if (diff != 0) return i - start + (@ctz(diff) >> 3);
+        i += 8;
+        r += 8;
+    }
+    while (i < limit and src[i] == src[r]) {
+        i += 1;
+        r += 1;
+    }
+    return i - start;
+}
+
+/// Write a length above 14 as 255-valued bytes plus a remainder
+fn writeLength(dst: []u8, start: usize, n: usize) usize {
+    var op = start;
+    var left = n;
+    while (left >= 255) {
+        dst[op] = 255;
+        op += 1;
+        left -= 255;
+    }
+    dst[op] = @intCast(left);
+    return op + 1;
+}
+
+fn writeSequence(dst: []u8, start: usize, literals: []const u8, offset: usize, length: usize) usize {
+    var op = start + 1;
+    var token: u8 = 0xf0;
+    if (literals.len >= 15) {
+        op = writeLength(dst, op, literals.len - 15);
+    } else {
+        token = @as(u8, @intCast(literals.len)) << 4;
+    }
+    @memcpy(dst[op..][0..literals.len], literals);
+    op += literals.len;
+
+    std.mem.writeInt(u16, dst[op..][0..2], @intCast(offset), .little);
+    op += 2;
+
+    const extra = length - min_match;
+    if (extra >= 15) {
+        token |= 15;
+        op = writeLength(dst, op, extra - 15);
+    } else {
+        token |= @intCast(extra);
+    }
+    dst[start] = token;
+    return op;
+}
+
+fn writeLastLiterals(dst: []u8, start: usize, literals: []const u8) usize {
+    var op = start + 1;
+    if (literals.len >= 15) {
+        dst[start] = 0xf0;
+        op = writeLength(dst, op, literals.len - 15);
+    } else {
+        dst[start] = @as(u8, @intCast(literals.len)) << 4;
+    }
+    @memcpy(dst[op..][0..literals.len], literals);
+    return op + literals.len;
+}
+
+/// Decode one block
+///
+/// Parameters:
+///   - src: Compressed block
+///   - out: Output buffer; matches may reach back to `out[0]` (the
+///     history of linked blocks), and bytes past `end` may be used as
+///     scratch by wild copies
+///   - start: Write position
+///   - end: Output must not go past this position
+///
+/// Returns:
+///   - Bytes written
+///
+/// Errors:
+///   - error.CorruptedStream: Truncated block, bad offset or too much output
+pub fn decompressBlock(src: []const u8, out: []u8, start: usize, end: usize) !usize {
+    std.debug.assert(start <= end and end <= out.len);
+    var ip: usize = 0;
+    var op = start;
+
+    while (true) {
+        if (ip >= src.len) return error.CorruptedStream;
+        const token = src[ip];
+        ip += 1;
+
+        var literal_length: usize = token >> 4;
+        if (literal_length == 15) literal_length += try readLength(src, &ip);
+        if (literal_length > src.len - ip or literal_length > end - op) return error.CorruptedStream;
+
+        if (ip + literal_length + 16 <= src.len and op + literal_length + 16 <= out.len) {
+            var i: usize = 0;
+            while (i < literal_length) : (i += 16) copy16(out, op + i, src, ip + i);
+        } else {
+            @memcpy(out[op..][0..literal_length], src[ip..][0..literal_length]);
+        }
+        ip += literal_length;
+        op += literal_length;
+        if (ip == src.len) return op - start;
+
+        if (src.len - ip < 2) return error.CorruptedStream;
+        const offset: usize = std.mem.readInt(u16, src[ip..][0..2], .little);
+        ip += 2;
+        if (offset == 0 or offset > op) return error.CorruptedStream;
+
+        var match_length: usize = (token & 15) + min_match;
+        if (token & 15 == 15) match_length += try readLength(src, &ip);
+        if (match_length > end - op) return error.CorruptedStream;
+
+        copyMatch(out, op, offset, match_length);
+        op += match_length;
+    }
+}
+
+fn readLength(src: []const u8, ip: *usize) !usize {
+    var total: usize = 0;
+    while (true) {
+        if (ip.* >= src.len) return error.CorruptedStream;
+        const byte = src[ip.*];
+        ip.* += 1;
+        total += byte;
+        if (byte != 255) return total;
+    }
+}
+
+inline fn copy16(dst: []u8, d: usize, src: []const u8, s: usize) void {
+    dst[d..][0..16].* = src[s..][0..16].*;
+}
+
+inline fn copy8(dst: []u8, d: usize, src: []const u8, s: usize) void {
+    std.mem.writeInt(u64, dst[d..][0..8], read64(src, s), .little);
+}
+
+/// Copy a match; chunks never overlap their source because each is at
+/// most `offset` bytes long
+inline fn copyMatch(out: []u8, op: usize, offset: usize, length: usize) void {
+    const from = op - offset;
+    if (offset >= 16 and op + length + 16 <= out.len) {
+        var i: usize = 0;
+        while (i < length) : (i += 16) copy16(out, op + i, out, from + i);
+    } else if (offset >= 8 and op + length + 8 <= out.len) {
+        var i: usize = 0;
+        while (i < length) : (i += 8) copy8(out, op + i, out, from + i);
+    } else if (offset == 1) {
+        @memset(out[op..][0..length], out[from]);
+    } else {
+        for (out[op..][0..length], from..) |*b, i| b.* = out[i];
+    }
+}
+
+// Tests
+
+test "compressBlock: round trips through decompressBlock" {
+    const allocator = std.testing.allocator;
+
+    var prng = std.Random.DefaultPrng.init(0x124);
+    const random = prng.random();
+    var table: HashTable = undefined;
+
+    for ([_]usize{ 0, 1, 12, 13, 100, 4096, 70 * 1024 }) |len| {
+        const input = try allocator.alloc(u8, len);
+        defer allocator.free(input);
+        // Short repeating phrases with random noise: both literals and matches
+        for (input, 0..) |*b, i| b.* = if (random.uintLessThan(u8, 8) == 0) random.int(u8) else @truncate(i % 251 / 3);
+
+        const compressed = try allocator.alloc(u8, compressBound(len));
+        defer allocator.free(compressed);
+        const n = compressBlock(input, compressed, &table);
+
+        const out = try allocator.alloc(u8, len + wild_slack);
+        defer allocator.free(out);
+        try std.testing.expectEqual(len, try decompressBlock(compressed[0..n], out, 0, len));
+        try std.testing.expectEqualSlices(u8, input, out[0..len]);
+
+        // Exact-size buffer: no room for wild copies
+        const exact = try allocator.alloc(u8, len);
+        defer allocator.free(exact);
+        try std.testing.expectEqual(len, try decompressBlock(compressed[0..n], exact, 0, len));
+        try std.testing.expectEqualSlices(u8, input, exact);
+    }
+}
+
+test "decompressBlock: rejects bad offsets and overlong output" {
+    var out: [64]u8 = undefined;
+
+    // 4 literals, then a match reaching 5 bytes back
+    const bad_offset = [_]u8{ 0x40, 'a', 'b', 'c', 'd', 5, 0, 0x10, 'e' };
+    try std.testing.expectError(error.CorruptedStream, decompressBlock(&bad_offset, &out, 0, out.len));
+
+    // Same with a valid offset, but only 6 bytes of room
+    const good = [_]u8{ 0x40, 'a', 'b', 'c', 'd', 2, 0, 0x10, 'e' };
+    try std.testing.expectEqual(@as(usize, 9), try decompressBlock(&good, &out, 0, out.len));
+    try std.testing.expectEqualStrings("abcdcdcde", out[0..9]);
+    try std.testing.expectError(error.CorruptedStream, decompressBlock(&good, &out, 0, 6));
+
+    // Truncated length extension
+    const truncated = [_]u8{ 0xf0, 255 };
+    try std.testing.expectError(error.CorruptedStream, decompressBlock(&truncated, &out, 0, out.len));
+}
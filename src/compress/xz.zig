@@ -0,0 +1,1394 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! XZ decompression
+//!
+//! An XZ stream is a 12-byte header (magic and check type), blocks, an
+//! index listing every block's sizes and a 12-byte footer. Each block is
+//! a header (filters and, optionally, its compressed and uncompressed
+//! sizes), LZMA2 data, padding to 4 bytes and a CRC32, CRC64 or SHA-256
+//! of its content. Streams may be concatenated with zero padding between
+//! them.
+//!
+//! Blocks are independent. Multi-threaded `xz -T` records both sizes in
+//! every block header, so `ParallelReader` can cut them out of the input
+//! and decode them one per core; blocks without sizes (single-threaded
+//! `xz`) are decoded in order by `XzReader`. Only the LZMA2 filter is
+//! supported (no BCJ or delta filters).
+
+const std = @import("std");
+const instrument = @import("../core/instrument.zig");
+const trace = @import("../core/trace.zig");
+const types = @import("../core/types.zig");
+
+pub const lzma = @import("xz/lzma.zig");
+
+/// XZ stream header magic
+pub const magic = [6]u8{ 0xfd, '7', 'z', 'X', 'Z', 0x00 };
+
+const footer_magic = "YZ";
+
+/// Size of the stream header and of the stream footer
+pub const stream_header_size = 12;
+
+const lzma2_filter_id = 0x21;
+
+/// Integrity check stored after each block
+pub const CheckType = enum(u4) {
+    none = 0,
+    crc32 = 1,
+    crc64 = 4,
+    sha256 = 10,
+    _,
+
+    /// Size of the check field (also defined for reserved types)
+    pub fn size(self: CheckType) usize {
+        const id = @intFromEnum(self);
+        if (id == 0) return 0;
+        return @as(usize, 4) << @intCast((id - 1) / 3);
+    }
+};
+
+/// Running check of one block's content
+const Check = union(enum) {
+    none,
+    crc32: std.hash.Crc32,
+    crc64: std.hash.crc.Crc64Xz,
+    sha256: std.crypto.hash.sha2.Sha256,
+
+    fn init(check_type: CheckType) Check {
+        return switch (check_type) {
+            .none => .none,
+            .crc32 => .{ .crc32 = std.hash.Crc32.init() },
+            .crc64 => .{ .crc64 = std.hash.crc.Crc64Xz.init() },
+            .sha256 => .{ .sha256 = std.crypto.hash.sha2.Sha256.init(.{}) },
+            _ => unreachable,
+        };
+    }
+
+    fn update(self: *Check, data: []const u8) void {
+        switch (self.*) {
+            .none => {},
+            inline else => |*hasher| hasher.update(data),
+        }
+    }
+
+    /// Compare with the check field stored after the block
+    fn matches(self: *Check, expected: []const u8) bool {
+        switch (self.*) {
+            .none => return true,
+            .crc32 => |hasher| return hasher.final() == std.mem.readInt(u32, expected[0..4], .little),
+            .crc64 => |hasher| return hasher.final() == std.mem.readInt(u64, expected[0..8], .little),
+            .sha256 => |*hasher| {
+                var digest: [32]u8 = undefined;
+                hasher.final(&digest);
+                return std.mem.eql(u8, &digest, expected);
+            },
+        }
+    }
+};
+
+/// Parse a stream header
+///
+/// Returns:
+///   - The stream's check type
+///
+/// Errors:
+///   - error.CorruptedStream: Bad magic, flags or CRC32
+///   - error.UnsupportedFormat: Reserved check type
+pub fn parseStreamHeader(header: *const [stream_header_size]u8) !CheckType {
+    if (!std.mem.eql(u8, header[0..6], &magic)) return error.CorruptedStream;
+    if (std.hash.Crc32.hash(header[6..8]) != std.mem.readInt(u32, header[8..12], .little)) return error.CorruptedStream;
+    if (header[6] != 0 or header[7] > 0x0f) return error.CorruptedStream;
+
+    const check_type: CheckType = @enumFromInt(@as(u4, @intCast(header[7])));
+    return switch (check_type) {
+        .none, .crc32, .crc64, .sha256 => check_type,
+        _ => error.UnsupportedFormat,
+    };
+}
+
+/// Check a stream footer against the header and the index just read
+///
+/// Errors:
+///   - error.CorruptedStream: Bad CRC32, backward size, flags or magic
+fn checkStreamFooter(footer: *const [stream_header_size]u8, check_type: CheckType, index_size: usize) !void {
+    if (std.hash.Crc32.hash(footer[4..10]) != std.mem.readInt(u32, footer[0..4], .little)) return error.CorruptedStream;
+    const backward_size = (@as(u64, std.mem.readInt(u32, footer[4..8], .little)) + 1) * 4;
+    if (backward_size != index_size) return error.CorruptedStream;
+    if (footer[8] != 0 or footer[9] != @intFromEnum(check_type)) return error.CorruptedStream;
+    if (!std.mem.eql(u8, footer[10..12], footer_magic)) return error.CorruptedStream;
+}
+
+const Vli = struct {
+    value: u64,
+    len: usize,
+};
+
+/// Decode a variable-length integer (7 bits per byte, at most 9 bytes)
+///
+/// Returns:
+///   - The value and its length, or null if `data` ends first
+///
+/// Errors:
+///   - error.CorruptedStream: Too long or not minimally encoded
+fn decodeVli(data: []const u8) !?Vli {
+    var value: u64 = 0;
+    for (0..9) |i| {
+        if (i == data.len) return null;
+        const byte = data[i];
+        value |= @as(u64, byte & 0x7f) << @intCast(7 * i);
+        if (byte & 0x80 == 0) {
+            if (byte == 0 and i > 0) return error.CorruptedStream;
+            return .{ .value = value, .len = i + 1 };
+        }
+    }
+    return error.CorruptedStream;
+}
+
+/// Zero bytes after `compressed` bytes of block data
+fn blockPadding(compressed: u64) usize {
+    return @intCast(std.mem.alignForward(u64, compressed, 4) - compressed);
+}
+
+/// Block header
+pub const BlockHeader = struct {
+    /// Header bytes, including its CRC32
+    size: usize,
+
+    compressed: ?u64,
+    uncompressed: ?u64,
+
+    /// LZMA2 dictionary size
+    dict_size: u32,
+
+    /// Header size from its first byte (nonzero; 0 starts the index)
+    pub fn headerSize(first: u8) usize {
+        return (@as(usize, first) + 1) * 4;
+    }
+
+    /// Parse a whole block header
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Bad CRC32, sizes or padding
+    ///   - error.UnsupportedFormat: Filters other than a single LZMA2
+    pub fn parse(bytes: []const u8) !BlockHeader {
+        std.debug.assert(bytes.len == headerSize(bytes[0]));
+        const body = bytes[0 .. bytes.len - 4];
+        if (std.hash.Crc32.hash(body) != std.mem.readInt(u32, bytes[body.len..][0..4], .little)) return error.CorruptedStream;
+
+        const flags = body[1];
+        if (flags & 0x3c != 0) return error.UnsupportedFormat;
+        // A filter chain of BCJ or delta before LZMA2
+        if (flags & 0x03 != 0) return error.UnsupportedFormat;
+
+        var pos: usize = 2;
+        var header = BlockHeader{ .size = bytes.len, .compressed = null, .uncompressed = null, .dict_size = 0 };
+        if (flags & 0x40 != 0) {
+            const vli = try decodeVli(body[pos..]) orelse return error.CorruptedStream;
+            if (vli.value == 0) return error.CorruptedStream;
+            header.compressed = vli.value;
+            pos += vli.len;
+        }
+        if (flags & 0x80 != 0) {
+            const vli = try decodeVli(body[pos..]) orelse return error.CorruptedStream;
+            header.uncompressed = vli.value;
+            pos += vli.len;
+        }
+
+        const filter_id = try decodeVli(body[pos..]) orelse return error.CorruptedStream;
+        pos += filter_id.len;
+        if (filter_id.value != lzma2_filter_id) return error.UnsupportedFormat;
+        const props_size = try decodeVli(body[pos..]) orelse return error.CorruptedStream;
+        pos += props_size.len;
+        if (props_size.value != 1 or pos >= body.len) return error.CorruptedStream;
+        header.dict_size = try lzma.dictionarySize(body[pos]);
+        pos += 1;
+
+        for (body[pos..]) |b| {
+            if (b != 0) return error.CorruptedStream;
+        }
+        return header;
+    }
+};
+
+/// Block sizes of a stream, as recorded while decoding or read from its index
+const IndexHash = struct {
+    count: u64 = 0,
+    unpadded: u64 = 0,
+    uncompressed: u64 = 0,
+    crc: std.hash.Crc32 = std.hash.Crc32.init(),
+
+    fn add(self: *IndexHash, unpadded: u64, uncompressed: u64) void {
+        self.count += 1;
+        self.unpadded +%= unpadded;
+        self.uncompressed +%= uncompressed;
+
+        var record: [16]u8 = undefined;
+        std.mem.writeInt(u64, record[0..8], unpadded, .little);
+        std.mem.writeInt(u64, record[8..16], uncompressed, .little);
+        self.crc.update(&record);
+    }
+
+    fn eql(self: IndexHash, other: IndexHash) bool {
+        return self.count == other.count and
+            self.unpadded == other.unpadded and
+            self.uncompressed == other.uncompressed and
+            self.crc.final() == other.crc.final();
+    }
+};
+
+const Index = struct {
+    /// Bytes from the indicator through the CRC32
+    size: usize,
+    hash: IndexHash,
+};
+
+/// Parse an index
+///
+/// Parameters:
+///   - data: Input starting at the index indicator
+///   - blocks: Number of blocks the stream had
+///
+/// Returns:
+///   - The index, or null if it continues past `data`
+///
+/// Errors:
+///   - error.CorruptedStream: Wrong record count, padding or CRC32
+fn parseIndex(data: []const u8, blocks: u64) !?Index {
+    std.debug.assert(data[0] == 0);
+    var pos: usize = 1;
+    const count = try decodeVli(data[pos..]) orelse return null;
+    if (count.value != blocks) return error.CorruptedStream;
+    pos += count.len;
+
+    var hash = IndexHash{};
+    for (0..count.value) |_| {
+        const unpadded = try decodeVli(data[pos..]) orelse return null;
+        pos += unpadded.len;
+        const uncompressed = try decodeVli(data[pos..]) orelse return null;
+        pos += uncompressed.len;
+        hash.add(unpadded.value, uncompressed.value);
+    }
+
+    const padded = std.mem.alignForward(usize, pos, 4);
+    if (data.len < padded + 4) return null;
+    for (data[pos..padded]) |b| {
+        if (b != 0) return error.CorruptedStream;
+    }
+    if (std.hash.Crc32.hash(data[0..padded]) != std.mem.readInt(u32, data[padded..][0..4], .little)) return error.CorruptedStream;
+    return .{ .size = padded + 4, .hash = hash };
+}
+
+/// Streaming XZ decompressor over any reader
+///
+/// Decodes on the calling thread, one LZMA2 chunk at a time. Memory is
+/// the input buffer (one chunk, about 64 KiB) and a window of the
+/// dictionary size each block declares, or of the block's size when its
+/// header records a smaller one.
+///
+/// Example:
+/// ```zig
+/// var xz_stream = try XzReader.init(allocator, source);
+/// defer xz_stream.deinit();
+///
+/// const n = try xz_stream.read(&buffer);
+/// ```
+pub const XzReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+
+    /// Compressed input buffer and its unconsumed window (grown only to
+    /// hold a large index)
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    source_eof: bool = false,
+
+    /// Decoded output and match history; `out_pos` is the next byte to
+    /// hand out
+    window_buf: []u8 = &.{},
+    window: lzma.Window = .{ .buf = &.{} },
+    out_pos: usize = 0,
+
+    decoder: lzma.Lzma2Decoder = .{},
+    state: State = .stream_start,
+
+    /// Check type of the current stream, and its blocks so far
+    check_type: CheckType = .none,
+    index: IndexHash = .{},
+
+    /// Current block
+    block: BlockHeader = undefined,
+    block_compressed: u64 = 0,
+    block_uncompressed: u64 = 0,
+    check: Check = .none,
+
+    finished: bool = false,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    /// Blocks decoded and checked
+    blocks: u64 = 0,
+
+    /// Streams fully decoded and checked
+    streams: u64 = 0,
+
+    /// Progress observer, called after each LZMA2 chunk
+    observer: ?types.StreamObserver = null,
+
+    pub const Reader = std.io.Reader(*XzReader, anyerror, read);
+
+    const State = enum {
+        stream_start,
+        block_start,
+        chunk_start,
+        chunk,
+    };
+
+    /// Initialize a streaming decompressor
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate the input buffer
+    pub fn init(allocator: std.mem.Allocator, source: std.io.AnyReader) !XzReader {
+        return .{
+            .allocator = allocator,
+            .source = source,
+            .in_buf = try allocator.alloc(u8, lzma.max_chunk_size + types.BufferSize.default),
+        };
+    }
+
+    /// Release buffers
+    pub fn deinit(self: *XzReader) void {
+        self.allocator.free(self.window_buf);
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input, or sizes
+    ///     that disagree with the block headers or index
+    ///   - error.ChecksumMismatch: A block failed its CRC32/CRC64/SHA-256
+    ///   - error.UnsupportedFormat: Filters other than LZMA2, or a
+    ///     reserved check type
+    ///   - error.OutOfMemory: Failed to allocate a block's dictionary
+    ///   - (Any error returned by the observer)
+    pub fn read(self: *XzReader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (self.out_pos == self.window.pos) {
+            if (self.finished) return 0;
+            try self.decodeStep();
+        }
+        const n = @min(dest.len, self.window.pos - self.out_pos);
+        @memcpy(dest[0..n], self.window.buf[self.out_pos..][0..n]);
+        self.out_pos += n;
+        return n;
+    }
+
+    /// Decompress and discard up to `count` bytes
+    ///
+    /// Returns:
+    ///   - Number of bytes skipped (less than `count` only at end of stream)
+    pub fn skip(self: *XzReader, count: u64) anyerror!u64 {
+        var skipped: u64 = 0;
+        while (skipped < count) {
+            if (self.out_pos == self.window.pos) {
+                if (self.finished) break;
+                try self.decodeStep();
+                continue;
+            }
+            const n: usize = @intCast(@min(count - skipped, @as(u64, self.window.pos - self.out_pos)));
+            self.out_pos += n;
+            skipped += n;
+        }
+        return skipped;
+    }
+
+    /// Buffer the start of the stream and check its magic
+    ///
+    /// Must be called before any data has been read.
+    ///
+    /// Errors:
+    ///   - error.DecompressionFailed: Input is empty or not an XZ stream
+    pub fn checkHeader(self: *XzReader) !void {
+        std.debug.assert(self.compressed_bytes == 0 and self.in_start == 0);
+
+        if (!try self.ensure(magic.len)) return error.DecompressionFailed;
+        if (!std.mem.eql(u8, self.in_buf[0..magic.len], &magic)) return error.DecompressionFailed;
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *XzReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Advance to the next output, or to the next header
+    fn decodeStep(self: *XzReader) !void {
+        switch (self.state) {
+            .stream_start => try self.startStream(),
+            .block_start => try self.startBlock(),
+            .chunk_start => try self.startChunk(),
+            .chunk => try self.runChunk(),
+        }
+    }
+
+    fn startStream(self: *XzReader) !void {
+        if (!try self.ensure(4)) {
+            if (self.in_start == self.in_end and self.streams > 0) {
+                self.finished = true;
+                return;
+            }
+            return error.CorruptedStream;
+        }
+
+        // Stream padding: zero words after a stream
+        if (self.streams > 0 and std.mem.readInt(u32, self.in_buf[self.in_start..][0..4], .little) == 0) {
+            self.consume(4);
+            return;
+        }
+
+        if (!try self.ensure(stream_header_size)) return error.CorruptedStream;
+        self.check_type = try parseStreamHeader(self.in_buf[self.in_start..][0..stream_header_size]);
+        self.consume(stream_header_size);
+        self.index = .{};
+        self.state = .block_start;
+    }
+
+    fn startBlock(self: *XzReader) !void {
+        if (!try self.ensure(1)) return error.CorruptedStream;
+        const first = self.in_buf[self.in_start];
+        if (first == 0) return self.endStream();
+
+        const header_size = BlockHeader.headerSize(first);
+        if (!try self.ensure(header_size)) return error.CorruptedStream;
+        const header = try BlockHeader.parse(self.in_buf[self.in_start..][0..header_size]);
+        self.consume(header_size);
+
+        // The dictionary bounds the window; a block that declares a smaller
+        // size never needs more than that (16 bytes at least, so a block
+        // that overruns its size shows up)
+        var window_size = std.mem.alignForward(u64, header.dict_size, 16);
+        if (header.uncompressed) |size| window_size = @min(window_size, @max(size, 16));
+        const size = std.math.cast(usize, window_size) orelse return error.OutOfMemory;
+        if (self.window_buf.len < size) {
+            self.allocator.free(self.window_buf);
+            self.window_buf = &.{};
+            self.window_buf = try self.allocator.alloc(u8, size);
+        }
+
+        self.window = .{ .buf = self.window_buf[0..size] };
+        self.out_pos = 0;
+        self.decoder.reset();
+        self.block = header;
+        self.block_compressed = 0;
+        self.block_uncompressed = 0;
+        self.check = Check.init(self.check_type);
+        self.state = .chunk_start;
+    }
+
+    fn startChunk(self: *XzReader) !void {
+        _ = try self.ensure(lzma.max_chunk_size);
+        const available = self.in_buf[self.in_start..self.in_end];
+        const header = try lzma.ChunkHeader.parse(available) orelse return error.CorruptedStream;
+        if (header.isEnd()) {
+            self.consume(1);
+            self.block_compressed += 1;
+            return self.endBlock();
+        }
+        if (header.compressed > available.len - header.size) return error.CorruptedStream;
+
+        // The payload stays in place until the next `ensure`, after the chunk
+        try self.decoder.startChunk(header, available[header.size..][0..header.compressed], &self.window);
+        self.out_pos = self.window.pos;
+        self.consume(header.size + header.compressed);
+        self.block_compressed += header.size + header.compressed;
+        self.state = .chunk;
+    }
+
+    fn runChunk(self: *XzReader) !void {
+        // Everything in the window has been read: keep it only as history
+        if (self.window.pos == self.window.buf.len) {
+            self.window.pos = 0;
+            self.out_pos = 0;
+        }
+
+        const start = self.window.pos;
+        const done = blk: {
+            const span = instrument.begin(.inflate);
+            defer span.end();
+            break :blk try self.decoder.run(&self.window);
+        };
+        const produced = self.window.buf[start..self.window.pos];
+        {
+            const span = instrument.begin(.crc);
+            defer span.end();
+            self.check.update(produced);
+        }
+        self.block_uncompressed += produced.len;
+        self.uncompressed_bytes += produced.len;
+        if (self.block.uncompressed) |size| {
+            if (self.block_uncompressed > size) return error.CorruptedStream;
+        }
+
+        if (done) {
+            self.state = .chunk_start;
+            if (self.observer) |observer| {
+                try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+            }
+        }
+    }
+
+    /// Check the block's sizes, padding and check field
+    fn endBlock(self: *XzReader) !void {
+        const header = self.block;
+        if (header.compressed) |size| {
+            if (size != self.block_compressed) return error.CorruptedStream;
+        }
+        if (header.uncompressed) |size| {
+            if (size != self.block_uncompressed) return error.CorruptedStream;
+        }
+
+        const padding = blockPadding(self.block_compressed);
+        const check_size = self.check_type.size();
+        if (!try self.ensure(padding + check_size)) return error.CorruptedStream;
+        const trailer = self.in_buf[self.in_start..][0 .. padding + check_size];
+        for (trailer[0..padding]) |b| {
+            if (b != 0) return error.CorruptedStream;
+        }
+        if (!self.check.matches(trailer[padding..])) return error.ChecksumMismatch;
+        self.consume(padding + check_size);
+
+        self.index.add(header.size + self.block_compressed + check_size, self.block_uncompressed);
+        self.blocks += 1;
+        self.state = .block_start;
+    }
+
+    /// Check the index against the blocks decoded, then the footer
+    fn endStream(self: *XzReader) !void {
+        const index = while (true) {
+            if (try parseIndex(self.in_buf[self.in_start..self.in_end], self.index.count)) |index| break index;
+            if (self.source_eof) return error.CorruptedStream;
+
+            const buffered = self.in_end - self.in_start;
+            if (buffered == self.in_buf.len) try self.growInput();
+            _ = try self.ensure(buffered + 1);
+        };
+        if (!index.hash.eql(self.index)) return error.CorruptedStream;
+        self.consume(index.size);
+
+        if (!try self.ensure(stream_header_size)) return error.CorruptedStream;
+        try checkStreamFooter(self.in_buf[self.in_start..][0..stream_header_size], self.check_type, index.size);
+        self.consume(stream_header_size);
+        self.streams += 1;
+        self.state = .stream_start;
+    }
+
+    /// Double the input buffer (for an index larger than it)
+    fn growInput(self: *XzReader) !void {
+        const buffered = self.in_end - self.in_start;
+        const in_buf = try self.allocator.alloc(u8, self.in_buf.len * 2);
+        @memcpy(in_buf[0..buffered], self.in_buf[self.in_start..self.in_end]);
+        self.allocator.free(self.in_buf);
+        self.in_buf = in_buf;
+        self.in_start = 0;
+        self.in_end = buffered;
+    }
+
+    /// Buffer at least `n` bytes of input
+    ///
+    /// Returns:
+    ///   - false if the source ends first
+    fn ensure(self: *XzReader, n: usize) !bool {
+        std.debug.assert(n <= self.in_buf.len);
+        if (self.in_end - self.in_start >= n) return true;
+
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < n and !self.source_eof) try self.fill();
+        return self.in_end >= n;
+    }
+
+    /// Read more input after the buffered bytes
+    fn fill(self: *XzReader) !void {
+        const span = instrument.begin(.read);
+        defer span.end();
+
+        const n = try self.source.read(self.in_buf[self.in_end..]);
+        instrument.count(.bytes_read, n);
+        if (n == 0) self.source_eof = true;
+        self.in_end += n;
+    }
+
+    fn consume(self: *XzReader, n: usize) void {
+        self.in_start += n;
+        self.compressed_bytes += n;
+    }
+};
+
+/// Parallel XZ decompressor for blocks that record their sizes
+///
+/// Reads a batch of whole blocks (as `xz -T` writes them), decodes them
+/// on a thread pool, where workers also verify block checks, and hands the
+/// output back in order. Each stream's index is checked against its blocks
+/// in stream order after each batch.
+///
+/// At the first block without sizes in its header, or too large for a
+/// batch, the rest of the input is handed to an XzReader, which keeps
+/// memory to one dictionary. The batch buffers start at one LZMA2 chunk
+/// of input and no output, and grow to a batch of blocks the size the
+/// block headers declare, so single-threaded `xz` output never allocates
+/// more than the fallback needs.
+///
+/// Must not be moved after `init` (the pool keeps pointers into it).
+///
+/// Example:
+/// ```zig
+/// var parallel: ParallelReader = undefined;
+/// try parallel.init(allocator, file_reader.any(), .{ .threads = 8 });
+/// defer parallel.deinit();
+///
+/// const n = try parallel.read(&buffer);
+/// ```
+pub const ParallelReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+    pool: std.Thread.Pool,
+    threaded: bool,
+
+    /// Compressed input for the current batch and its unconsumed window
+    in_buf: []u8,
+    /// Size the batch buffers may grow to
+    batch_limit: usize,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    source_eof: bool = false,
+
+    /// One output slot per block in a batch
+    out_buf: []u8,
+    tasks: []Task,
+    batch_len: usize = 0,
+    out_index: usize = 0,
+    out_pos: usize = 0,
+
+    /// Stream and block boundaries of the batch, in stream order
+    events: std.ArrayList(Event),
+
+    /// Stream being split into blocks (null between streams), and its
+    /// blocks so far
+    scan_check: ?CheckType = null,
+    scan_blocks: u64 = 0,
+    seen_stream: bool = false,
+
+    /// Index records of the stream being checked
+    index: IndexHash = .{},
+
+    /// Streaming decoder for the input from the first unsized block on
+    fallback: ?*Fallback = null,
+
+    /// Blocks decoded on the pool
+    blocks: u64 = 0,
+
+    /// Streams fully decoded and checked on the pool
+    streams: u64 = 0,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    /// Progress observer, called after each batch (and each chunk once
+    /// decoding is handed to an XzReader)
+    observer: ?types.StreamObserver = null,
+
+    pub const Options = struct {
+        /// Worker threads (0 = one per CPU, 1 = decode on the calling thread)
+        threads: usize = 0,
+
+        /// Blocks decoded per batch, per thread
+        blocks_per_thread: usize = 1,
+
+        /// Size each of the input and output batch buffers may grow to;
+        /// `xz -T` blocks are three dictionaries (24 MiB at the default
+        /// preset)
+        batch_size: usize = 128 * 1024 * 1024,
+    };
+
+    pub const Reader = std.io.Reader(*ParallelReader, anyerror, read);
+
+    const Task = struct {
+        /// LZMA2 data, without header or padding
+        input: []const u8 = &.{},
+        output: []u8 = &.{},
+        check_type: CheckType = .none,
+        expected: []const u8 = &.{},
+        unpadded: u64 = 0,
+        decoder: lzma.Lzma2Decoder = .{},
+        err: ?anyerror = null,
+    };
+
+    const Event = union(enum) {
+        stream_start,
+        /// Task index
+        block: usize,
+        /// Records read from the stream's index
+        stream_end: IndexHash,
+    };
+
+    const Fallback = struct {
+        prefix: []const u8,
+        source: std.io.AnyReader,
+        stream: XzReader,
+
+        /// Counters when the fallback took over
+        compressed_base: u64,
+        uncompressed_base: u64,
+        observer: ?types.StreamObserver,
+
+        fn readChained(context: *const anyopaque, buffer: []u8) anyerror!usize {
+            const self: *Fallback = @constCast(@ptrCast(@alignCast(context)));
+            if (self.prefix.len > 0) {
+                const n = @min(buffer.len, self.prefix.len);
+                @memcpy(buffer[0..n], self.prefix[0..n]);
+                self.prefix = self.prefix[n..];
+                return n;
+            }
+            return self.source.read(buffer);
+        }
+
+        fn observe(ptr: *anyopaque, compressed: u64, uncompressed: u64) anyerror!void {
+            const self: *Fallback = @ptrCast(@alignCast(ptr));
+            const observer = self.observer orelse return;
+            try observer.observe(self.compressed_base + compressed, self.uncompressed_base + uncompressed);
+        }
+    };
+
+    /// Initialize in place
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate batch buffers
+    ///   - (Errors from spawning pool threads)
+    pub fn init(self: *ParallelReader, allocator: std.mem.Allocator, source: std.io.AnyReader, options: Options) !void {
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+        const batch_blocks = @max(1, threads * options.blocks_per_thread);
+        const min_input = lzma.max_chunk_size + types.BufferSize.default;
+
+        // Grown by reserve() once block headers give the sizes
+        const in_buf = try allocator.alloc(u8, min_input);
+        errdefer allocator.free(in_buf);
+        const out_buf = try allocator.alloc(u8, 0);
+        errdefer allocator.free(out_buf);
+        const tasks = try allocator.alloc(Task, batch_blocks);
+        errdefer allocator.free(tasks);
+        for (tasks) |*task| task.* = .{};
+
+        self.* = .{
+            .allocator = allocator,
+            .source = source,
+            .pool = undefined,
+            .threaded = threads > 1,
+            .in_buf = in_buf,
+            .batch_limit = @max(options.batch_size, min_input),
+            .out_buf = out_buf,
+            .tasks = tasks,
+            .events = std.ArrayList(Event).init(allocator),
+        };
+        errdefer self.events.deinit();
+        if (self.threaded) try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+    }
+
+    /// Stop worker threads and free buffers
+    pub fn deinit(self: *ParallelReader) void {
+        if (self.threaded) self.pool.deinit();
+        if (self.fallback) |fallback| {
+            fallback.stream.deinit();
+            self.allocator.destroy(fallback);
+        }
+        self.events.deinit();
+        self.allocator.free(self.tasks);
+        self.allocator.free(self.out_buf);
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data in stream order
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input, or sizes
+    ///     that disagree with the block headers or index
+    ///   - error.ChecksumMismatch: A block failed its CRC32/CRC64/SHA-256
+    ///   - error.UnsupportedFormat: Filters other than LZMA2, or a
+    ///     reserved check type
+    pub fn read(self: *ParallelReader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (true) {
+            while (self.out_index < self.batch_len) {
+                const output = self.tasks[self.out_index].output;
+                if (self.out_pos < output.len) {
+                    const n = @min(dest.len, output.len - self.out_pos);
+                    @memcpy(dest[0..n], output[self.out_pos..][0..n]);
+                    self.out_pos += n;
+                    return n;
+                }
+                self.out_index += 1;
+                self.out_pos = 0;
+            }
+
+            if (self.fallback) |fallback| {
+                const n = try fallback.stream.read(dest);
+                self.compressed_bytes = fallback.compressed_base + fallback.stream.compressed_bytes;
+                self.uncompressed_bytes += n;
+                return n;
+            }
+
+            if (!try self.decodeBatch()) return 0;
+        }
+    }
+
+    /// Decompress and discard up to `count` bytes
+    ///
+    /// Returns:
+    ///   - Number of bytes skipped (less than `count` only at end of stream)
+    pub fn skip(self: *ParallelReader, count: u64) anyerror!u64 {
+        var skipped: u64 = 0;
+        while (skipped < count) {
+            if (self.out_index == self.batch_len) {
+                if (self.fallback) |fallback| {
+                    const n = try fallback.stream.skip(count - skipped);
+                    self.compressed_bytes = fallback.compressed_base + fallback.stream.compressed_bytes;
+                    self.uncompressed_bytes += n;
+                    skipped += n;
+                    break;
+                }
+                if (!try self.decodeBatch()) break;
+                continue;
+            }
+            const output = self.tasks[self.out_index].output;
+            const n: usize = @intCast(@min(count - skipped, @as(u64, output.len - self.out_pos)));
+            self.out_pos += n;
+            skipped += n;
+            if (self.out_pos == output.len) {
+                self.out_index += 1;
+                self.out_pos = 0;
+            }
+        }
+        return skipped;
+    }
+
+    /// Buffer the start of the input and check its magic
+    ///
+    /// Must be called before any data has been read.
+    ///
+    /// Errors:
+    ///   - error.DecompressionFailed: Input is empty or not an XZ stream
+    pub fn checkHeader(self: *ParallelReader) !void {
+        std.debug.assert(self.compressed_bytes == 0 and self.in_start == 0);
+
+        try self.fill();
+        if (self.in_end < magic.len) return error.DecompressionFailed;
+        if (!std.mem.eql(u8, self.in_buf[0..magic.len], &magic)) return error.DecompressionFailed;
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *ParallelReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Decode the next batch of blocks, or hand over to the fallback
+    ///
+    /// Returns:
+    ///   - false at the clean end of the input
+    fn decodeBatch(self: *ParallelReader) !bool {
+        try self.fill();
+        self.batch_len = 0;
+        self.out_index = 0;
+        self.out_pos = 0;
+
+        // Split the buffered input into stream headers, blocks and indexes
+        var start = self.in_start;
+        var pos = start;
+        var count: usize = 0;
+        var out_used: usize = 0;
+        while (count < self.tasks.len) {
+            const rest = self.in_buf[pos..self.in_end];
+            if (rest.len == 0) break;
+
+            const check_type = self.scan_check orelse {
+                // Stream padding: zero words after a stream
+                if (self.seen_stream and rest.len >= 4 and std.mem.readInt(u32, rest[0..4], .little) == 0) {
+                    pos += 4;
+                    continue;
+                }
+                if (rest.len < stream_header_size) {
+                    if (self.source_eof) return error.CorruptedStream;
+                    break;
+                }
+                self.scan_check = try parseStreamHeader(rest[0..stream_header_size]);
+                self.scan_blocks = 0;
+                self.seen_stream = true;
+                try self.events.append(.stream_start);
+                pos += stream_header_size;
+                continue;
+            };
+
+            if (rest[0] == 0) {
+                const index = try parseIndex(rest, self.scan_blocks) orelse {
+                    if (self.source_eof) return error.CorruptedStream;
+                    break;
+                };
+                if (rest.len - index.size < stream_header_size) {
+                    if (self.source_eof) return error.CorruptedStream;
+                    break;
+                }
+                try checkStreamFooter(rest[index.size..][0..stream_header_size], check_type, index.size);
+                try self.events.append(.{ .stream_end = index.hash });
+                self.scan_check = null;
+                pos += index.size + stream_header_size;
+                continue;
+            }
+
+            const header_size = BlockHeader.headerSize(rest[0]);
+            if (rest.len < header_size) {
+                if (self.source_eof) return error.CorruptedStream;
+                break;
+            }
+            const header = try BlockHeader.parse(rest[0..header_size]);
+
+            // Blocks that do not record both sizes are decoded in order
+            const compressed = header.compressed orelse break;
+            const uncompressed = header.uncompressed orelse break;
+            const check_size = check_type.size();
+            const total = @as(u64, header_size) + std.mem.alignForward(u64, compressed, 4) + check_size;
+
+            // Tasks of a started batch point into the buffers
+            if (count == 0 and try self.reserve(total, uncompressed)) {
+                // The input moved: top it up and rescan from this block
+                self.compressed_bytes += pos - start;
+                self.in_start = pos;
+                try self.fill();
+                start = self.in_start;
+                pos = start;
+                continue;
+            }
+            if (total > self.in_buf.len or uncompressed > self.out_buf.len) break;
+            if (total > rest.len) {
+                if (self.source_eof) return error.CorruptedStream;
+                break;
+            }
+            if (uncompressed > self.out_buf.len - out_used) break;
+
+            const data_end = header_size + @as(usize, @intCast(compressed));
+            const check_start = data_end + blockPadding(compressed);
+            for (rest[data_end..check_start]) |b| {
+                if (b != 0) return error.CorruptedStream;
+            }
+
+            const size: usize = @intCast(uncompressed);
+            const task = &self.tasks[count];
+            task.input = rest[header_size..data_end];
+            task.output = self.out_buf[out_used..][0..size];
+            task.check_type = check_type;
+            task.expected = rest[check_start..][0..check_size];
+            task.unpadded = @as(u64, header_size) + compressed + check_size;
+            try self.events.append(.{ .block = count });
+            count += 1;
+            out_used += size;
+            pos += @intCast(total);
+            self.scan_blocks += 1;
+        }
+        self.compressed_bytes += pos - start;
+        self.in_start = pos;
+
+        if (count > 0) {
+            if (self.threaded and count > 1) {
+                var wg: std.Thread.WaitGroup = .{};
+                for (self.tasks[0..count]) |*task| {
+                    self.pool.spawnWg(&wg, workerTask, .{task});
+                }
+                self.pool.waitAndWork(&wg);
+            } else {
+                for (self.tasks[0..count]) |*task| decodeTask(task);
+            }
+
+            for (self.tasks[0..count]) |task| {
+                if (task.err) |err| return err;
+            }
+        }
+        try self.checkStreams();
+        self.blocks += count;
+        self.batch_len = count;
+
+        if (count > 0) {
+            if (self.observer) |observer| {
+                try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+            }
+        }
+
+        if (count > 0 or pos > start) return true;
+        if (self.in_start == self.in_end) {
+            if (self.scan_check != null) return error.CorruptedStream;
+            return false;
+        }
+
+        // A block without sizes, one too large for a batch, or a huge index
+        try self.startFallback();
+        return true;
+    }
+
+    /// Check each finished stream's index against its blocks, in stream order
+    fn checkStreams(self: *ParallelReader) !void {
+        for (self.events.items) |event| switch (event) {
+            .stream_start => self.index = .{},
+            .block => |i| {
+                const task = &self.tasks[i];
+                self.index.add(task.unpadded, task.output.len);
+                self.uncompressed_bytes += task.output.len;
+            },
+            .stream_end => |hash| {
+                if (!hash.eql(self.index)) return error.CorruptedStream;
+                self.streams += 1;
+            },
+        };
+        self.events.clearRetainingCapacity();
+    }
+
+    /// Stream everything from the next block (or stream) on
+    fn startFallback(self: *ParallelReader) !void {
+        const fallback = try self.allocator.create(Fallback);
+        errdefer self.allocator.destroy(fallback);
+
+        fallback.* = .{
+            .prefix = self.in_buf[self.in_start..self.in_end],
+            .source = self.source,
+            .stream = undefined,
+            .compressed_base = self.compressed_bytes,
+            .uncompressed_base = self.uncompressed_bytes,
+            .observer = self.observer,
+        };
+        fallback.stream = try XzReader.init(
+            self.allocator,
+            .{ .context = fallback, .readFn = Fallback.readChained },
+        );
+
+        // Pick up mid-stream where the scan stopped
+        const stream = &fallback.stream;
+        stream.streams = @intFromBool(self.seen_stream);
+        if (self.scan_check) |check_type| {
+            stream.state = .block_start;
+            stream.check_type = check_type;
+            stream.index = self.index;
+        }
+        if (self.observer != null) {
+            stream.observer = .{ .ptr = fallback, .observeFn = Fallback.observe };
+        }
+
+        self.in_start = self.in_end;
+        self.fallback = fallback;
+    }
+
+    /// Grow the batch buffers to a batch of blocks of the given sizes
+    ///
+    /// Only called between batches: no task points into the buffers.
+    ///
+    /// Returns:
+    ///   - true if either buffer grew
+    fn reserve(self: *ParallelReader, total: u64, uncompressed: u64) !bool {
+        const blocks: u64 = self.tasks.len;
+        const in_size: usize = @intCast(@min(self.batch_limit, total *| blocks));
+        const out_size: usize = @intCast(@min(self.batch_limit, uncompressed *| blocks));
+
+        var grew = false;
+        if (in_size > self.in_buf.len) {
+            // Keeps the buffered input
+            self.in_buf = try self.allocator.realloc(self.in_buf, in_size);
+            grew = true;
+        }
+        if (out_size > self.out_buf.len) {
+            // Everything decoded into it has been read
+            self.allocator.free(self.out_buf);
+            self.out_buf = self.out_buf[0..0];
+            self.out_buf = try self.allocator.alloc(u8, out_size);
+            grew = true;
+        }
+        return grew;
+    }
+
+    /// Move unconsumed input to the front and top the buffer up
+    fn fill(self: *ParallelReader) !void {
+        const span = instrument.begin(.read);
+        defer span.end();
+
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < self.in_buf.len and !self.source_eof) {
+            const n = try self.source.read(self.in_buf[self.in_end..]);
+            instrument.count(.bytes_read, n);
+            if (n == 0) self.source_eof = true;
+            self.in_end += n;
+        }
+    }
+
+    /// Worker: decode one block into its output slot and verify its check
+    fn workerTask(task: *Task) void {
+        trace.setThreadName("xz worker");
+        decodeTask(task);
+    }
+
+    fn decodeTask(task: *Task) void {
+        task.err = null;
+        decodeBlock(task) catch |err| {
+            task.err = err;
+        };
+    }
+
+    fn decodeBlock(task: *Task) !void {
+        {
+            const span = instrument.begin(.inflate);
+            defer span.end();
+
+            var window = lzma.Window{ .buf = task.output };
+            const used = try lzma.decodeStream(&task.decoder, task.input, &window);
+            if (used != task.input.len or window.pos != task.output.len) return error.CorruptedStream;
+        }
+
+        const span = instrument.begin(.crc);
+        defer span.end();
+        var check = Check.init(task.check_type);
+        check.update(task.output);
+        if (!check.matches(task.expected)) return error.ChecksumMismatch;
+    }
+};
+
+/// Decompress complete XZ data (one or more concatenated streams)
+///
+/// Errors:
+///   - error.CorruptedStream: Malformed or truncated input
+///   - error.ChecksumMismatch: A block failed its check
+///   - error.UnsupportedFormat: Filters other than LZMA2
+pub fn decompress(allocator: std.mem.Allocator, data: []const u8) ![]u8 {
+    var fbs = std.io.fixedBufferStream(data);
+    const source = fbs.reader();
+    var stream = try XzReader.init(allocator, source.any());
+    defer stream.deinit();
+
+    return stream.reader().readAllAlloc(allocator, std.math.maxInt(usize));
+}
+
+// Tests
+
+fn sampleByte(i: usize) u8 {
+    const words = "tar xz lzma2 zarc block index stream ";
+    return words[(i * 7 + i / 1000) % words.len];
+}
+
+/// 3000 `sampleByte`s from `xz -T2 --block-size=1024 -C crc64`: three
+/// blocks with sizes in their headers
+const multi_block_stream = [_]u8{
+    0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x04, 0xe6, 0xd6, 0xb4, 0x46, 0x03, 0xc0, 0x3b, 0x80,
+    0x08, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x00, 0x75, 0xd9, 0x77, 0xc5, 0xe0, 0x03, 0xff, 0x00,
+    0x33, 0x5d, 0x00, 0x3a, 0x1b, 0x08, 0x47, 0x01, 0x4d, 0x07, 0x1a, 0x45, 0x59, 0xa1, 0x52, 0x91,
+    0x32, 0x99, 0x46, 0xe2, 0xc8, 0x25, 0x0c, 0x2e, 0x4e, 0xfb, 0xde, 0x69, 0xd8, 0x43, 0x34, 0xe4,
+    0x57, 0x10, 0xa5, 0x32, 0x30, 0x9e, 0x0a, 0x3c, 0x9a, 0xb4, 0x4a, 0x08, 0x16, 0x1d, 0xc7, 0xc6,
+    0x8f, 0x2f, 0x8b, 0x89, 0x80, 0x00, 0x00, 0x00, 0x4a, 0x03, 0x54, 0x86, 0x47, 0x48, 0x25, 0x63,
+    0x03, 0xc0, 0x3b, 0x80, 0x08, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x00, 0x75, 0xd9, 0x77, 0xc5,
+    0xe0, 0x03, 0xff, 0x00, 0x33, 0x5d, 0x00, 0x3c, 0x1b, 0x4b, 0xb6, 0x1f, 0xac, 0xd9, 0xcb, 0xe8,
+    0x81, 0x4d, 0x32, 0xbc, 0x93, 0xd4, 0x5e, 0xb2, 0x72, 0x86, 0xa2, 0x07, 0x04, 0x94, 0x70, 0xb3,
+    0x3a, 0x0c, 0x85, 0xa4, 0x2a, 0x5a, 0x19, 0xcb, 0xe5, 0xe2, 0x93, 0xac, 0x6c, 0x79, 0x6a, 0x9b,
+    0x53, 0xf4, 0x7a, 0xaa, 0xd3, 0x3a, 0x98, 0x8f, 0x20, 0x00, 0x00, 0x00, 0xc2, 0x1f, 0xd5, 0xe3,
+    0x4e, 0xa2, 0xff, 0xc6, 0x03, 0xc0, 0x38, 0xb8, 0x07, 0x21, 0x01, 0x16, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x12, 0x89, 0x62, 0xe0, 0x03, 0xb7, 0x00, 0x30, 0x5d, 0x00, 0x36, 0x19, 0x08, 0xd8, 0xed,
+    0x7e, 0xf0, 0x87, 0xb9, 0x96, 0x23, 0xd1, 0xa2, 0x25, 0xcc, 0xa7, 0x79, 0xfc, 0x80, 0x1f, 0x53,
+    0xb8, 0x2e, 0xb0, 0x72, 0xc3, 0x4e, 0xa2, 0x45, 0x0d, 0x78, 0xd9, 0x1d, 0x95, 0x03, 0xcb, 0x7f,
+    0xc9, 0xdd, 0x64, 0x33, 0xe9, 0xc6, 0xfe, 0x8b, 0xfc, 0x47, 0x00, 0x00, 0xe0, 0x9d, 0x4d, 0xa0,
+    0x08, 0x82, 0x3c, 0x07, 0x00, 0x03, 0x53, 0x80, 0x08, 0x53, 0x80, 0x08, 0x50, 0xb8, 0x07, 0x00,
+    0x21, 0x1c, 0x58, 0x76, 0x14, 0x17, 0x3b, 0x30, 0x03, 0x00, 0x00, 0x00, 0x00, 0x04, 0x59, 0x5a,
+};
+
+const short_text = "zarc reads .tar.xz\n" ** 4;
+
+/// `short_text` from liblzma's single-threaded encoder with a SHA-256
+/// check (no sizes in the block header)
+const sha256_stream = [_]u8{
+    0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x0a, 0xe1, 0xfb, 0x0c, 0xa1, 0x02, 0x00, 0x21, 0x01,
+    0x16, 0x00, 0x00, 0x00, 0x74, 0x2f, 0xe5, 0xa3, 0xe0, 0x00, 0x4b, 0x00, 0x1a, 0x5d, 0x00, 0x3d,
+    0x18, 0x4a, 0xaa, 0xc3, 0xe8, 0xb4, 0xcc, 0x9d, 0x99, 0x92, 0x1a, 0xf6, 0xd7, 0x29, 0x43, 0x92,
+    0x82, 0xb4, 0xa0, 0xe2, 0x85, 0xcd, 0x3f, 0x50, 0x00, 0x00, 0x00, 0x00, 0x63, 0xcf, 0x08, 0x48,
+    0x08, 0xf0, 0xf5, 0x9d, 0x4e, 0x8f, 0xad, 0x8a, 0x4b, 0x92, 0xf9, 0xe4, 0x2e, 0x94, 0x5e, 0xfa,
+    0xaa, 0x2a, 0x4c, 0x25, 0xc2, 0x48, 0xc1, 0x89, 0xd0, 0xb5, 0x70, 0x58, 0x00, 0x01, 0x4e, 0x4c,
+    0x1b, 0xda, 0x16, 0x31, 0x18, 0x9b, 0x4b, 0x9a, 0x01, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x59, 0x5a,
+};
+
+/// 10000 `sampleByte`s with a 4 KiB dictionary and a CRC32 check, so the
+/// window wraps
+const small_dict_stream = [_]u8{
+    0xfd, 0x37, 0x7a, 0x58, 0x5a, 0x00, 0x00, 0x01, 0x69, 0x22, 0xde, 0x36, 0x02, 0x00, 0x21, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x37, 0x27, 0x97, 0xd6, 0xe0, 0x27, 0x0f, 0x00, 0x68, 0x5d, 0x00, 0x3a,
+    0x1b, 0x08, 0x47, 0x01, 0x4d, 0x07, 0x1a, 0x45, 0x59, 0xa1, 0x52, 0x91, 0x32, 0x99, 0x46, 0xe2,
+    0xc8, 0x25, 0x0c, 0x2e, 0x4e, 0xfb, 0xde, 0x69, 0xd8, 0x43, 0x34, 0xe4, 0x57, 0x10, 0xa5, 0x32,
+    0x30, 0x9e, 0x0a, 0x3c, 0x9a, 0xb4, 0x4a, 0x08, 0x16, 0x1d, 0xc7, 0xc6, 0xae, 0xbd, 0x56, 0xcf,
+    0x01, 0xfa, 0x20, 0xa7, 0xe8, 0xa0, 0xf6, 0x09, 0x6e, 0xa4, 0x90, 0xc7, 0xd6, 0xe1, 0x0f, 0x3e,
+    0xc5, 0xc5, 0x0d, 0xf8, 0x3e, 0x2d, 0xd1, 0x26, 0x54, 0xfc, 0xfe, 0x80, 0x9f, 0xd7, 0x3f, 0x43,
+    0x26, 0x6b, 0x93, 0x72, 0xb9, 0x6a, 0x36, 0xf8, 0xab, 0x6d, 0x4f, 0xf2, 0x32, 0xaf, 0x67, 0xea,
+    0x98, 0x60, 0xa2, 0x74, 0xdc, 0x6b, 0xe8, 0x00, 0xd8, 0xd0, 0x52, 0x5d, 0x00, 0x01, 0x80, 0x01,
+    0x90, 0x4e, 0x00, 0x00, 0xdb, 0xa8, 0xc1, 0x27, 0x3e, 0x30, 0x0d, 0x8b, 0x02, 0x00, 0x00, 0x00,
+    0x00, 0x01, 0x59, 0x5a,
+};
+
+/// All three streams, with stream padding between and after them
+const concatenated = multi_block_stream ++ [_]u8{0} ** 4 ++ sha256_stream ++ small_dict_stream ++ [_]u8{0} ** 8;
+
+fn expectConcatenated(out: []const u8) !void {
+    try std.testing.expectEqual(@as(usize, 3000 + short_text.len + 10000), out.len);
+    for (out[0..3000], 0..) |b, i| {
+        if (b != sampleByte(i)) return error.TestExpectedEqual;
+    }
+    try std.testing.expectEqualStrings(short_text, out[3000..][0..short_text.len]);
+    for (out[3000 + short_text.len ..], 0..) |b, i| {
+        if (b != sampleByte(i)) return error.TestExpectedEqual;
+    }
+}
+
+test "XzReader: decodes concatenated streams with every check type" {
+    const allocator = std.testing.allocator;
+
+    var fbs = std.io.fixedBufferStream(&concatenated);
+    const source = fbs.reader();
+    var stream = try XzReader.init(allocator, source.any());
+    defer stream.deinit();
+    try stream.checkHeader();
+
+    const out = try stream.reader().readAllAlloc(allocator, 1 << 20);
+    defer allocator.free(out);
+    try expectConcatenated(out);
+    try std.testing.expectEqual(@as(u64, 5), stream.blocks);
+    try std.testing.expectEqual(@as(u64, 3), stream.streams);
+    try std.testing.expectEqual(@as(u64, concatenated.len), stream.compressed_bytes);
+
+    // The last stream's window is its 4 KiB dictionary
+    try std.testing.expectEqual(@as(usize, 4096), stream.window.buf.len);
+}
+
+test "XzReader: rejects truncated and corrupted streams" {
+    const allocator = std.testing.allocator;
+
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, multi_block_stream[0..200]));
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, multi_block_stream[0 .. multi_block_stream.len - 1]));
+
+    // CRC64 of the first block
+    var bad_check = multi_block_stream;
+    bad_check[90] ^= 0x01;
+    try std.testing.expectError(error.ChecksumMismatch, decompress(allocator, &bad_check));
+
+    // A record in the index (its CRC32 no longer matches)
+    var bad_index = multi_block_stream;
+    bad_index[262] ^= 0x01;
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, &bad_index));
+
+    // Stream padding that is not a multiple of four bytes
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, &(sha256_stream ++ [_]u8{ 0, 0 })));
+}
+
+test "ParallelReader: decodes sized blocks on the pool, then streams the rest" {
+    const allocator = std.testing.allocator;
+
+    for ([_]usize{ 1, 2 }) |threads| {
+        var fbs = std.io.fixedBufferStream(&concatenated);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = threads, .batch_size = 0 });
+        defer parallel.deinit();
+        try parallel.checkHeader();
+
+        const out = try parallel.reader().readAllAlloc(allocator, 1 << 20);
+        defer allocator.free(out);
+        try expectConcatenated(out);
+        try std.testing.expectEqual(@as(u64, 3), parallel.blocks);
+        try std.testing.expectEqual(@as(u64, 1), parallel.streams);
+        // The fallback counts the pool's stream too
+        try std.testing.expectEqual(@as(u64, 3), parallel.fallback.?.stream.streams);
+        try std.testing.expectEqual(@as(u64, concatenated.len), parallel.compressed_bytes);
+        try std.testing.expectEqual(@as(u64, out.len), parallel.uncompressed_bytes);
+    }
+
+    {
+        // Default limits: the buffers are sized from the block headers
+        var fbs = std.io.fixedBufferStream(&multi_block_stream);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2 });
+        defer parallel.deinit();
+        try parallel.checkHeader();
+
+        const out = try parallel.reader().readAllAlloc(allocator, 1 << 20);
+        defer allocator.free(out);
+        try std.testing.expect(parallel.fallback == null);
+        try std.testing.expectEqual(lzma.max_chunk_size + types.BufferSize.default, parallel.in_buf.len);
+        try std.testing.expect(parallel.out_buf.len <= 2 * out.len);
+    }
+
+    {
+        // CRC64 of the first block, checked on a worker
+        var bad = multi_block_stream;
+        bad[90] ^= 0x01;
+        var fbs = std.io.fixedBufferStream(&bad);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2 });
+        defer parallel.deinit();
+
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            parallel.reader().readAllAlloc(allocator, 1 << 20),
+        );
+    }
+}
+
+test "BlockHeader: parses sizes and rejects other filters" {
+    // First block header of `multi_block_stream`
+    const bytes = multi_block_stream[12..28];
+    const header = try BlockHeader.parse(bytes);
+    try std.testing.expectEqual(@as(usize, 16), header.size);
+    try std.testing.expectEqual(@as(?u64, 59), header.compressed);
+    try std.testing.expectEqual(@as(?u64, 1024), header.uncompressed);
+    try std.testing.expectEqual(@as(u32, 8 << 20), header.dict_size);
+
+    // Two filters (as with BCJ before LZMA2), CRC32 fixed up
+    var two_filters = bytes.*;
+    two_filters[1] |= 0x01;
+    std.mem.writeInt(u32, two_filters[12..16], std.hash.Crc32.hash(two_filters[0..12]), .little);
+    try std.testing.expectError(error.UnsupportedFormat, BlockHeader.parse(&two_filters));
+
+    var bad_crc = bytes.*;
+    bad_crc[15] ^= 0x01;
+    try std.testing.expectError(error.CorruptedStream, BlockHeader.parse(&bad_crc));
+}
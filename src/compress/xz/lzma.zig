@@ -0,0 +1,640 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! LZMA and LZMA2 decoding
+//!
+//! LZMA codes literals, matches and repeated matches with an adaptive
+//! binary range coder. LZMA2 wraps it in chunks of at most 64 KiB
+//! compressed / 2 MiB uncompressed, each either LZMA or stored, which may
+//! reset the dictionary, the coder state or the literal properties.
+//!
+//! Chunks are always decoded from memory: callers buffer a whole chunk
+//! first, so the range coder never has to stop for input. It keeps its
+//! state in locals through the decode loop and reads past the end as
+//! zeros; the chunk end check catches any overrun.
+
+const std = @import("std");
+
+/// Largest LZMA2 chunk: 6 header bytes plus 64 KiB of compressed data
+pub const max_chunk_size = 6 + 65536;
+
+/// Largest uncompressed size of one LZMA2 chunk
+pub const max_chunk_output = 2 * 1024 * 1024;
+
+const states = 12;
+const literal_states = 7;
+const pos_states_max = 16;
+const dist_states = 4;
+const dist_model_end = 14;
+const full_distances = 128;
+const align_bits = 4;
+
+const prob_init: u16 = 1024;
+const prob_bits = 11;
+const move_bits = 5;
+const top_value: u32 = 1 << 24;
+
+/// Dictionary size from an LZMA2 filter property byte
+///
+/// Errors:
+///   - error.CorruptedStream: Property above 40
+pub fn dictionarySize(props: u8) !u32 {
+    if (props > 40) return error.CorruptedStream;
+    if (props == 40) return std.math.maxInt(u32);
+    return (2 | @as(u32, props & 1)) << @intCast(props / 2 + 11);
+}
+
+/// Output buffer that doubles as the match history
+///
+/// Decoding writes at `pos` and stops at `limit`. When `pos` reaches the
+/// end of `buf`, the owner hands the output on and wraps `pos` to 0; the
+/// old bytes stay behind as history. A window as large as the whole
+/// output never wraps.
+pub const Window = struct {
+    buf: []u8,
+    pos: usize = 0,
+
+    /// Bytes of valid history (at most `buf.len`)
+    full: usize = 0,
+
+    limit: usize = 0,
+
+    /// Forget all history (LZMA2 dictionary reset)
+    pub fn reset(self: *Window) void {
+        self.pos = 0;
+        self.full = 0;
+    }
+
+    /// Byte `dist + 1` positions back, or 0 before the start
+    inline fn get(self: *const Window, dist: u32) u8 {
+        if (dist >= self.full) return 0;
+        var offset = self.pos -% dist -% 1;
+        if (dist >= self.pos) offset +%= self.buf.len;
+        return self.buf[offset];
+    }
+
+    inline fn put(self: *Window, byte: u8) void {
+        self.buf[self.pos] = byte;
+        self.pos += 1;
+        if (self.full < self.pos) self.full = self.pos;
+    }
+
+    /// Copy a match, stopping at `limit`
+    ///
+    /// Returns:
+    ///   - Match bytes still to copy
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Distance reaches before the history
+    fn repeat(self: *Window, dist: u32, length: u32) !u32 {
+        if (dist >= self.full) return error.CorruptedStream;
+        const n: usize = @min(self.limit - self.pos, length);
+        var src = self.pos -% dist -% 1;
+        if (dist >= self.pos) src +%= self.buf.len;
+
+        if (src < self.pos and @as(usize, dist) + 1 >= n) {
+            @memcpy(self.buf[self.pos..][0..n], self.buf[src..][0..n]);
+        } else if (dist == 0) {
+            @memset(self.buf[self.pos..][0..n], self.buf[src]);
+        } else {
+            for (self.buf[self.pos..][0..n]) |*b| {
+                b.* = self.buf[src];
+                src += 1;
+                if (src == self.buf.len) src = 0;
+            }
+        }
+        self.pos += n;
+        if (self.full < self.pos) self.full = self.pos;
+        return length - @as(u32, @intCast(n));
+    }
+
+    /// Copy stored bytes, stopping at `limit`
+    fn copy(self: *Window, data: []const u8) usize {
+        const n = @min(self.limit - self.pos, data.len);
+        @memcpy(self.buf[self.pos..][0..n], data[0..n]);
+        self.pos += n;
+        if (self.full < self.pos) self.full = self.pos;
+        return n;
+    }
+};
+
+/// Binary range decoder over one buffered chunk
+pub const RangeDecoder = struct {
+    data: []const u8,
+    pos: usize,
+    range: u32,
+    code: u32,
+
+    /// Start decoding a chunk
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Shorter than the 5 initial bytes, or a
+    ///     nonzero first byte
+    pub fn init(data: []const u8) !RangeDecoder {
+        if (data.len < 5 or data[0] != 0) return error.CorruptedStream;
+        return .{
+            .data = data,
+            .pos = 5,
+            .range = std.math.maxInt(u32),
+            .code = std.mem.readInt(u32, data[1..5], .big),
+        };
+    }
+
+    /// Whether the chunk was consumed exactly and ended cleanly
+    pub fn isFinished(self: *const RangeDecoder) bool {
+        return self.code == 0 and self.pos == self.data.len;
+    }
+
+    inline fn normalize(self: *RangeDecoder) void {
+        if (self.range < top_value) {
+            const byte: u32 = if (self.pos < self.data.len) self.data[self.pos] else 0;
+            self.pos += 1;
+            self.range <<= 8;
+            self.code = (self.code << 8) | byte;
+        }
+    }
+
+    inline fn bit(self: *RangeDecoder, prob: *u16) u32 {
+        self.normalize();
+        const bound = (self.range >> prob_bits) * prob.*;
+        if (self.code < bound) {
+            self.range = bound;
+            prob.* += ((1 << prob_bits) - prob.*) >> move_bits;
+            return 0;
+        }
+        self.range -= bound;
+        self.code -= bound;
+        prob.* -= prob.* >> move_bits;
+        return 1;
+    }
+
+    /// Decode a `bits`-bit symbol, most significant bit first
+    inline fn tree(self: *RangeDecoder, probs: []u16, comptime bits: u4) u32 {
+        var symbol: u32 = 1;
+        inline for (0..bits) |_| symbol = (symbol << 1) | self.bit(&probs[symbol]);
+        return symbol - (1 << bits);
+    }
+
+    /// Decode a `bits`-bit symbol, least significant bit first
+    fn reverse(self: *RangeDecoder, probs: []u16, bits: u5) u32 {
+        var symbol: u32 = 1;
+        var result: u32 = 0;
+        for (0..bits) |i| {
+            const b = self.bit(&probs[symbol]);
+            symbol = (symbol << 1) | b;
+            result |= b << @intCast(i);
+        }
+        return result;
+    }
+
+    /// Decode `count` bits with fixed probability one half
+    fn direct(self: *RangeDecoder, count: u5) u32 {
+        var result: u32 = 0;
+        for (0..count) |_| {
+            self.normalize();
+            self.range >>= 1;
+            if (self.code >= self.range) {
+                self.code -= self.range;
+                result = (result << 1) | 1;
+            } else {
+                result <<= 1;
+            }
+        }
+        return result;
+    }
+};
+
+const LengthProbabilities = extern struct {
+    choice: u16,
+    choice2: u16,
+    low: [pos_states_max][8]u16,
+    mid: [pos_states_max][8]u16,
+    high: [256]u16,
+
+    inline fn decode(self: *LengthProbabilities, rc: *RangeDecoder, pos_state: usize) u32 {
+        if (rc.bit(&self.choice) == 0) return 2 + rc.tree(&self.low[pos_state], 3);
+        if (rc.bit(&self.choice2) == 0) return 10 + rc.tree(&self.mid[pos_state], 3);
+        return 18 + rc.tree(&self.high, 8);
+    }
+};
+
+/// Adaptive probabilities, all reset to one half together
+const Probabilities = extern struct {
+    is_match: [states][pos_states_max]u16,
+    is_rep: [states]u16,
+    is_rep0: [states]u16,
+    is_rep1: [states]u16,
+    is_rep2: [states]u16,
+    is_rep0_long: [states][pos_states_max]u16,
+    dist_slot: [dist_states][64]u16,
+    /// One leading spare so the tree for slot 4, which starts one entry
+    /// before the others, stays in bounds
+    dist_special: [1 + full_distances - dist_model_end]u16,
+    dist_align: [1 << align_bits]u16,
+    match_len: LengthProbabilities,
+    rep_len: LengthProbabilities,
+    /// 0x300 per literal coder; LZMA2 allows at most 16 (lc + lp <= 4)
+    literal: [0x300 << 4]u16,
+};
+
+/// LZMA decoder state
+pub const LzmaDecoder = struct {
+    probs: Probabilities = undefined,
+    state: u32 = 0,
+    reps: [4]u32 = .{ 0, 0, 0, 0 },
+
+    /// Bytes left of a match cut short by the window limit
+    pending: u32 = 0,
+
+    lc: u4 = 0,
+    literal_pos_mask: u32 = 0,
+    pos_mask: u32 = 0,
+
+    /// Set lc/lp/pb from an LZMA2 properties byte and reset
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Out of range, or lc + lp above 4
+    pub fn setProperties(self: *LzmaDecoder, props: u8) !void {
+        if (props >= 9 * 5 * 5) return error.CorruptedStream;
+        const lc = props % 9;
+        const lp = props / 9 % 5;
+        const pb = props / 45;
+        if (lc + lp > 4 or pb > 4) return error.CorruptedStream;
+
+        self.lc = @intCast(lc);
+        self.literal_pos_mask = (@as(u32, 1) << @intCast(lp)) - 1;
+        self.pos_mask = (@as(u32, 1) << @intCast(pb)) - 1;
+        self.reset();
+    }
+
+    /// Reset the coder state and probabilities, keeping the properties
+    pub fn reset(self: *LzmaDecoder) void {
+        @memset(std.mem.bytesAsSlice(u16, std.mem.asBytes(&self.probs)), prob_init);
+        self.state = 0;
+        self.reps = .{ 0, 0, 0, 0 };
+        self.pending = 0;
+    }
+
+    /// Decode until the window reaches its limit
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: A match reaches before the history
+    pub fn decode(self: *LzmaDecoder, range_decoder: *RangeDecoder, window: *Window) !void {
+        var rc = range_decoder.*;
+        defer range_decoder.* = rc;
+        var state = self.state;
+        var reps = self.reps;
+        defer {
+            self.state = state;
+            self.reps = reps;
+        }
+        const probs = &self.probs;
+
+        if (self.pending > 0 and window.pos < window.limit) {
+            self.pending = try window.repeat(reps[0], self.pending);
+        }
+
+        while (window.pos < window.limit) {
+            const pos_state = window.pos & self.pos_mask;
+
+            if (rc.bit(&probs.is_match[state][pos_state]) == 0) {
+                const prev: u32 = window.get(0);
+                const coder = ((window.pos & self.literal_pos_mask) << self.lc) + (prev >> @intCast(@as(u5, 8) - self.lc));
+                const literal = probs.literal[coder * 0x300 ..][0..0x300];
+
+                var symbol: u32 = 1;
+                if (state < literal_states) {
+                    symbol = rc.tree(literal, 8);
+                } else {
+                    // After a match, the byte at rep0 steers the first bits
+                    var match_byte: u32 = window.get(reps[0]);
+                    var offset: u32 = 0x100;
+                    while (symbol < 0x100) {
+                        match_byte <<= 1;
+                        const match_bit = match_byte & offset;
+                        const b = rc.bit(&literal[offset + match_bit + symbol]);
+                        symbol = (symbol << 1) | b;
+                        offset = if (b == 1) match_bit else offset & ~match_bit;
+                    }
+                    symbol -= 0x100;
+                }
+                window.put(@intCast(symbol));
+                state = if (state < 4) 0 else if (state < 10) state - 3 else state - 6;
+                continue;
+            }
+
+            var length: u32 = undefined;
+            if (rc.bit(&probs.is_rep[state]) == 1) {
+                if (rc.bit(&probs.is_rep0[state]) == 0) {
+                    if (rc.bit(&probs.is_rep0_long[state][pos_state]) == 0) {
+                        // Short rep: one byte from rep0
+                        state = if (state < literal_states) 9 else 11;
+                        self.pending = try window.repeat(reps[0], 1);
+                        continue;
+                    }
+                } else {
+                    var dist: u32 = undefined;
+                    if (rc.bit(&probs.is_rep1[state]) == 0) {
+                        dist = reps[1];
+                    } else {
+                        if (rc.bit(&probs.is_rep2[state]) == 0) {
+                            dist = reps[2];
+                        } else {
+                            dist = reps[3];
+                            reps[3] = reps[2];
+                        }
+                        reps[2] = reps[1];
+                    }
+                    reps[1] = reps[0];
+                    reps[0] = dist;
+                }
+                state = if (state < literal_states) 8 else 11;
+                length = probs.rep_len.decode(&rc, pos_state);
+            } else {
+                reps[3] = reps[2];
+                reps[2] = reps[1];
+                reps[1] = reps[0];
+                state = if (state < literal_states) 7 else 10;
+                length = probs.match_len.decode(&rc, pos_state);
+
+                const slot = rc.tree(&probs.dist_slot[@min(length - 2, dist_states - 1)], 6);
+                if (slot < 4) {
+                    reps[0] = slot;
+                } else {
+                    const bits: u5 = @intCast((slot >> 1) - 1);
+                    var dist = (2 | (slot & 1)) << bits;
+                    if (slot < dist_model_end) {
+                        dist += rc.reverse(probs.dist_special[dist - slot ..], bits);
+                    } else {
+                        dist += rc.direct(bits - align_bits) << align_bits;
+                        dist += rc.reverse(&probs.dist_align, align_bits);
+                    }
+                    reps[0] = dist;
+                }
+            }
+            self.pending = try window.repeat(reps[0], length);
+        }
+        rc.normalize();
+    }
+};
+
+/// Header of one LZMA2 chunk
+pub const ChunkHeader = struct {
+    control: u8,
+
+    /// Header bytes (1, 3, 5 or 6)
+    size: usize,
+
+    uncompressed: usize,
+
+    /// Payload bytes after the header
+    compressed: usize,
+
+    /// Properties byte (chunks that set new properties)
+    props: u8,
+
+    /// Whether this is the end marker
+    pub fn isEnd(self: ChunkHeader) bool {
+        return self.control == 0;
+    }
+
+    /// Parse the chunk header at the start of `data`
+    ///
+    /// Returns:
+    ///   - The header, or null if `data` is too short to hold it
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Invalid control byte
+    pub fn parse(data: []const u8) !?ChunkHeader {
+        if (data.len == 0) return null;
+        const control = data[0];
+        if (control == 0) return .{ .control = 0, .size = 1, .uncompressed = 0, .compressed = 0, .props = 0 };
+
+        if (control >= 0x80) {
+            const size: usize = if (control >= 0xc0) 6 else 5;
+            if (data.len < size) return null;
+            return .{
+                .control = control,
+                .size = size,
+                .uncompressed = (@as(usize, control & 0x1f) << 16) + std.mem.readInt(u16, data[1..3], .big) + 1,
+                .compressed = @as(usize, std.mem.readInt(u16, data[3..5], .big)) + 1,
+                .props = if (size == 6) data[5] else 0,
+            };
+        }
+
+        if (control > 2) return error.CorruptedStream;
+        if (data.len < 3) return null;
+        const stored = @as(usize, std.mem.readInt(u16, data[1..3], .big)) + 1;
+        return .{ .control = control, .size = 3, .uncompressed = stored, .compressed = stored, .props = 0 };
+    }
+};
+
+/// LZMA2 decoder, fed one buffered chunk at a time
+///
+/// Example:
+/// ```zig
+/// decoder.reset();
+/// try decoder.startChunk(header, payload, &window);
+/// while (!try decoder.run(&window)) {
+///     // window.buf is full: hand it on, then wrap
+///     window.pos = 0;
+/// }
+/// ```
+pub const Lzma2Decoder = struct {
+    lzma: LzmaDecoder = .{},
+    need_dict_reset: bool = true,
+    need_props: bool = true,
+
+    /// Current chunk
+    rc: RangeDecoder = undefined,
+    stored: ?[]const u8 = null,
+    remaining: usize = 0,
+
+    /// Start a new LZMA2 stream (an XZ block)
+    pub fn reset(self: *Lzma2Decoder) void {
+        self.need_dict_reset = true;
+        self.need_props = true;
+        self.remaining = 0;
+    }
+
+    /// Start a chunk whose payload is fully buffered
+    ///
+    /// Must be called with no output pending from the previous chunk;
+    /// a dictionary reset empties the window.
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Chunk does not follow the reset rules,
+    ///     bad properties or range coder start
+    pub fn startChunk(self: *Lzma2Decoder, header: ChunkHeader, payload: []const u8, window: *Window) !void {
+        std.debug.assert(!header.isEnd() and payload.len == header.compressed and self.remaining == 0);
+        const control = header.control;
+
+        if (control >= 0xe0 or control == 1) {
+            self.need_props = true;
+            self.need_dict_reset = false;
+            window.reset();
+        } else if (self.need_dict_reset) {
+            return error.CorruptedStream;
+        }
+
+        if (control >= 0x80) {
+            if (control >= 0xc0) {
+                self.need_props = false;
+                try self.lzma.setProperties(header.props);
+            } else if (self.need_props) {
+                return error.CorruptedStream;
+            } else if (control >= 0xa0) {
+                self.lzma.reset();
+            }
+            self.rc = try RangeDecoder.init(payload);
+            self.stored = null;
+        } else {
+            self.stored = payload;
+        }
+        self.remaining = header.uncompressed;
+    }
+
+    /// Decode the current chunk until it ends or the window is full
+    ///
+    /// Returns:
+    ///   - true when the chunk is done, false when `window.buf` is full
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Bad match distance, or the chunk's
+    ///     compressed and uncompressed sizes disagree
+    pub fn run(self: *Lzma2Decoder, window: *Window) !bool {
+        const start = window.pos;
+        window.limit = @min(window.buf.len, start + self.remaining);
+        if (self.stored) |stored| {
+            self.stored = stored[window.copy(stored)..];
+        } else {
+            try self.lzma.decode(&self.rc, window);
+        }
+        self.remaining -= window.pos - start;
+        if (self.remaining > 0) return false;
+
+        if (self.stored == null) {
+            if (self.lzma.pending != 0 or !self.rc.isFinished()) return error.CorruptedStream;
+        }
+        return true;
+    }
+};
+
+/// Decode a whole LZMA2 stream held in memory into a window that never wraps
+///
+/// Parameters:
+///   - decoder: Decoder (reset here)
+///   - data: Compressed data, starting with the first chunk
+///   - window: Output; the stream must fit in `window.buf`
+///
+/// Returns:
+///   - Compressed bytes used, including the end marker
+///
+/// Errors:
+///   - error.CorruptedStream: Malformed, truncated, or more output than
+///     `window.buf` holds
+pub fn decodeStream(decoder: *Lzma2Decoder, data: []const u8, window: *Window) !usize {
+    decoder.reset();
+    var pos: usize = 0;
+    while (true) {
+        const header = try ChunkHeader.parse(data[pos..]) orelse return error.CorruptedStream;
+        if (header.isEnd()) return pos + 1;
+        if (header.compressed > data.len - pos - header.size) return error.CorruptedStream;
+
+        const payload = data[pos + header.size ..][0..header.compressed];
+        pos += header.size + header.compressed;
+        try decoder.startChunk(header, payload, window);
+        if (!try decoder.run(window)) return error.CorruptedStream;
+    }
+}
+
+// Tests
+
+/// 600 bytes of a 6-byte pattern, flipped every 96 bytes (lc=1, lp=1, pb=1)
+const reference_stream = [_]u8{
+    0xe0, 0x02, 0x57, 0x00, 0x1c, 0x37, 0x00, 0x3d, 0x18, 0x4a, 0xfe, 0x79, 0x17, 0xf2, 0x6a, 0xb3,
+    0xa0, 0x8e, 0xe3, 0x1e, 0x03, 0x3c, 0xe2, 0xb1, 0x89, 0xd0, 0xd5, 0xa7, 0xf6, 0x12, 0xc5, 0x47,
+    0x30, 0xd4, 0x00, 0x00,
+};
+
+fn referenceByte(i: usize) u8 {
+    return "zarc!\n"[i % 6] ^ @as(u8, @intCast(i / 96 & 1));
+}
+
+test "decodeStream: decodes a reference stream" {
+    var out: [600]u8 = undefined;
+    var window = Window{ .buf = &out };
+    var decoder = Lzma2Decoder{};
+    try std.testing.expectEqual(reference_stream.len, try decodeStream(&decoder, &reference_stream, &window));
+    try std.testing.expectEqual(out.len, window.pos);
+    for (out, 0..) |b, i| try std.testing.expectEqual(referenceByte(i), b);
+
+    // One byte too little room
+    var short = Window{ .buf = out[0..599] };
+    try std.testing.expectError(error.CorruptedStream, decodeStream(&decoder, &reference_stream, &short));
+}
+
+test "Lzma2Decoder: wraps a window smaller than the output" {
+    var buf: [256]u8 = undefined;
+    var window = Window{ .buf = &buf };
+    var decoder = Lzma2Decoder{};
+
+    const header = (try ChunkHeader.parse(&reference_stream)).?;
+    try decoder.startChunk(header, reference_stream[header.size..][0..header.compressed], &window);
+
+    var produced: usize = 0;
+    while (true) {
+        const start = window.pos;
+        const done = try decoder.run(&window);
+        for (buf[start..window.pos], produced..) |b, i| try std.testing.expectEqual(referenceByte(i), b);
+        produced += window.pos - start;
+        if (done) break;
+        window.pos = 0;
+    }
+    try std.testing.expectEqual(@as(usize, 600), produced);
+    try std.testing.expect((try ChunkHeader.parse(reference_stream[header.size + header.compressed ..])).?.isEnd());
+}
+
+test "decodeStream: rejects broken chunk sequences" {
+    var out: [600]u8 = undefined;
+    var decoder = Lzma2Decoder{};
+
+    // LZMA chunk without a dictionary reset first
+    var no_reset = reference_stream;
+    no_reset[0] = 0xc0;
+    var window = Window{ .buf = &out };
+    try std.testing.expectError(error.CorruptedStream, decodeStream(&decoder, &no_reset, &window));
+
+    // Invalid control byte
+    window = .{ .buf = &out };
+    try std.testing.expectError(error.CorruptedStream, decodeStream(&decoder, &[_]u8{ 0x03, 0, 0 }, &window));
+
+    // Truncated payload
+    window = .{ .buf = &out };
+    try std.testing.expectError(error.CorruptedStream, decodeStream(&decoder, reference_stream[0..20], &window));
+
+    // Stored chunk, then the end marker
+    window = .{ .buf = &out };
+    try std.testing.expectEqual(@as(usize, 7), try decodeStream(&decoder, &[_]u8{ 0x01, 0x00, 0x02, 'x', 'y', 'z', 0x00 }, &window));
+    try std.testing.expectEqualStrings("xyz", out[0..window.pos]);
+}
+
+test "dictionarySize: decodes property bytes" {
+    try std.testing.expectEqual(@as(u32, 4096), try dictionarySize(0));
+    try std.testing.expectEqual(@as(u32, 6144), try dictionarySize(1));
+    try std.testing.expectEqual(@as(u32, 8 << 20), try dictionarySize(22));
+    try std.testing.expectEqual(@as(u32, std.math.maxInt(u32)), try dictionarySize(40));
+    try std.testing.expectError(error.CorruptedStream, dictionarySize(41));
+}
@@ -17,6 +17,8 @@ const std = @import("std");
 const gzip = @import("gzip.zig");
 const c_zlib = @import("../c_compat/zlib.zig");
 const crc32_mod = @import("crc32.zig");
+const instrument = @import("../core/instrument.zig");
+const types = @import("../core/types.zig");
 
 /// Re-export compression format from c_compat layer
 pub const Format = c_zlib.Format;
@@ -101,6 +103,212 @@ pub fn readGzipHeader(allocator: std.mem.Allocator, compressed_data: []const u8)
     return try GzipHeader.parse(allocator, stream.reader());
 }
 
+/// Streaming gzip/zlib decompressor over any reader
+///
+/// Memory is bounded by the input buffer regardless of archive size.
+/// Compressed bytes consumed and uncompressed bytes produced are tracked
+/// exactly and, when an observer is set, reported after every inflate
+/// step so a decompression bomb can be stopped mid-stream instead of
+/// trusting sizes declared in headers.
+///
+/// Concatenated gzip members (RFC 1952 section 2.2) decode as one stream.
+///
+/// Example:
+/// ```zig
+/// var inflate = try InflateReader.init(allocator, source, .gzip);
+/// defer inflate.deinit();
+///
+/// var buffer: [4096]u8 = undefined;
+/// while (true) {
+///     const n = try inflate.read(&buffer);
+///     if (n == 0) break;
+/// }
+/// ```
+pub const InflateReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+    format: Format,
+    inflater: c_zlib.Inflater,
+
+    /// Compressed input buffer and its unconsumed window
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+
+    source_eof: bool = false,
+    finished: bool = false,
+
+    /// Total compressed bytes consumed by the inflater
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    /// Progress observer, called after each inflate step
+    observer: ?types.StreamObserver = null,
+
+    pub const Reader = std.io.Reader(*InflateReader, anyerror, read);
+
+    /// Initialize a streaming decompressor
+    ///
+    /// Parameters:
+    ///   - allocator: Allocator for the input buffer
+    ///   - source: Reader providing compressed data
+    ///   - format: gzip or zlib container
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate buffers or zlib state
+    pub fn init(allocator: std.mem.Allocator, source: std.io.AnyReader, format: Format) !InflateReader {
+        const in_buf = try allocator.alloc(u8, types.BufferSize.default);
+        errdefer allocator.free(in_buf);
+
+        return .{
+            .allocator = allocator,
+            .source = source,
+            .format = format,
+            .inflater = try c_zlib.Inflater.init(format),
+            .in_buf = in_buf,
+        };
+    }
+
+    /// Release buffers and zlib state
+    pub fn deinit(self: *InflateReader) void {
+        self.inflater.deinit();
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Compressed input ended early
+    ///   - error.ChecksumMismatch: Corrupted data or CRC mismatch
+    ///   - (Any error returned by the observer)
+    pub fn read(self: *InflateReader, dest: []u8) anyerror!usize {
+        if (self.finished or dest.len == 0) return 0;
+
+        while (true) {
+            if (self.in_start == self.in_end and !self.source_eof) {
+                try self.fill();
+            }
+
+            const step = blk: {
+                const span = instrument.begin(.inflate);
+                defer span.end();
+                break :blk try self.inflater.step(self.in_buf[self.in_start..self.in_end], dest);
+            };
+            self.in_start += step.consumed;
+            self.compressed_bytes += step.consumed;
+            self.uncompressed_bytes += step.produced;
+
+            if (self.observer) |observer| {
+                try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+            }
+
+            if (step.stream_end) {
+                if (self.format == .gzip and try self.nextMemberFollows()) {
+                    try self.inflater.reset();
+                } else {
+                    self.finished = true;
+                }
+                if (step.produced > 0 or self.finished) return step.produced;
+                continue;
+            }
+
+            if (step.produced > 0) return step.produced;
+
+            if (self.source_eof and self.in_start == self.in_end) {
+                return error.CorruptedStream;
+            }
+        }
+    }
+
+    /// Decompress and discard up to `count` bytes
+    ///
+    /// Inflates in large steps into a scratch buffer without surfacing the
+    /// data, which is the cheapest way to move past content that is not
+    /// needed (e.g. entry payloads while listing an archive).
+    ///
+    /// Returns:
+    ///   - Number of bytes skipped (less than `count` only at end of stream)
+    pub fn skip(self: *InflateReader, count: u64) anyerror!u64 {
+        var scratch: [32 * 1024]u8 = undefined;
+        var skipped: u64 = 0;
+        while (skipped < count) {
+            const want: usize = @intCast(@min(count - skipped, @as(u64, scratch.len)));
+            const n = try self.read(scratch[0..want]);
+            if (n == 0) break;
+            skipped += n;
+        }
+        return skipped;
+    }
+
+    /// Buffer the start of the stream and check its container header
+    ///
+    /// Lets callers reject non-gzip/zlib input up front instead of on the
+    /// first read. Must be called before any data has been read.
+    ///
+    /// Errors:
+    ///   - error.DecompressionFailed: Input is empty, truncated or not in the expected format
+    pub fn checkHeader(self: *InflateReader) !void {
+        std.debug.assert(self.compressed_bytes == 0 and self.in_start == 0);
+
+        const min_len: usize = switch (self.format) {
+            .gzip => 10,
+            .zlib => 2,
+            // Raw deflate has no header to check
+            .raw => return,
+        };
+        while (self.in_end < min_len and !self.source_eof) {
+            const n = try self.source.read(self.in_buf[self.in_end..]);
+            if (n == 0) self.source_eof = true;
+            self.in_end += n;
+        }
+        if (self.in_end < min_len) return error.DecompressionFailed;
+
+        const head = self.in_buf[0..min_len];
+        const valid = switch (self.format) {
+            .gzip => std.mem.eql(u8, head[0..2], &gzip.magic_number) and
+                head[2] == gzip.compression_method_deflate,
+            .zlib => (head[0] & 0x0f) == 8 and
+                ((@as(u16, head[0]) << 8) | head[1]) % 31 == 0,
+            .raw => unreachable,
+        };
+        if (!valid) return error.DecompressionFailed;
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *InflateReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Refill the input buffer from the source
+    fn fill(self: *InflateReader) !void {
+        const span = instrument.begin(.read);
+        defer span.end();
+
+        self.in_start = 0;
+        self.in_end = try self.source.read(self.in_buf);
+        instrument.count(.bytes_read, self.in_end);
+        if (self.in_end == 0) self.source_eof = true;
+    }
+
+    /// Whether another gzip member starts after the one just finished
+    ///
+    /// Anything other than a gzip magic byte (e.g. zero padding written by
+    /// tape tools) is treated as trailing garbage and ignored, as gzip does.
+    fn nextMemberFollows(self: *InflateReader) !bool {
+        if (self.in_start == self.in_end) {
+            if (self.source_eof) return false;
+            try self.fill();
+            if (self.source_eof) return false;
+        }
+        return self.in_buf[self.in_start] == 0x1f;
+    }
+};
+
 test "compress and decompress gzip" {
     const allocator = std.testing.allocator;
     const original = "Hello, World! This is a test of compression.";
@@ -217,3 +425,62 @@ test "CRC-32 validation: successful validation" {
     try std.testing.expectEqual(expected_crc32, result.footer.crc32);
     try std.testing.expectEqual(@as(u32, @truncate(original.len)), result.footer.isize);
 }
+
+test "InflateReader: streams concatenated members and reports progress" {
+    const allocator = std.testing.allocator;
+
+    var original: [50_000]u8 = undefined;
+    for (&original, 0..) |*b, i| b.* = @truncate(i % 13);
+
+    const member = try compress(allocator, .gzip, &original);
+    defer allocator.free(member);
+
+    const two = try std.mem.concat(allocator, u8, &.{ member, member });
+    defer allocator.free(two);
+
+    const Counter = struct {
+        calls: usize = 0,
+        last_compressed: u64 = 0,
+
+        fn observe(ptr: *anyopaque, compressed: u64, uncompressed: u64) anyerror!void {
+            const self: *@This() = @ptrCast(@alignCast(ptr));
+            _ = uncompressed;
+            self.calls += 1;
+            self.last_compressed = compressed;
+        }
+    };
+    var counter = Counter{};
+
+    var fbs = std.io.fixedBufferStream(two);
+    const source = fbs.reader();
+    var inflate = try InflateReader.init(allocator, source.any(), .gzip);
+    defer inflate.deinit();
+    inflate.observer = .{ .ptr = &counter, .observeFn = Counter.observe };
+
+    const out = try inflate.reader().readAllAlloc(allocator, 1 << 20);
+    defer allocator.free(out);
+
+    try std.testing.expectEqual(original.len * 2, out.len);
+    try std.testing.expectEqualSlices(u8, &original, out[0..original.len]);
+    try std.testing.expectEqualSlices(u8, &original, out[original.len..]);
+    try std.testing.expectEqual(@as(u64, two.len), inflate.compressed_bytes);
+    try std.testing.expectEqual(@as(u64, two.len), counter.last_compressed);
+    try std.testing.expect(counter.calls > 0);
+}
+
+test "InflateReader: truncated input is an error" {
+    const allocator = std.testing.allocator;
+
+    const compressed = try compress(allocator, .gzip, "truncated stream test data " ** 64);
+    defer allocator.free(compressed);
+
+    var fbs = std.io.fixedBufferStream(compressed[0 .. compressed.len / 2]);
+    const source = fbs.reader();
+    var inflate = try InflateReader.init(allocator, source.any(), .gzip);
+    defer inflate.deinit();
+
+    try std.testing.expectError(
+        error.CorruptedStream,
+        inflate.reader().readAllAlloc(allocator, 1 << 20),
+    );
+}
@@ -0,0 +1,994 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Zstandard (RFC 8878) support
+//!
+//! Native decoder and encoder; no C library is linked. The decoder handles
+//! every frame the reference implementation writes without a dictionary:
+//! raw, RLE and compressed blocks, all literal and sequence table modes,
+//! concatenated and skippable frames, and the XXH64 content checksum.
+//!
+//! The encoder writes single-segment frames at two levels (see `Level`).
+//! Large inputs are split into independent frames, which is what lets
+//! both `compress` and `ParallelReader` use every core.
+
+const std = @import("std");
+const instrument = @import("../core/instrument.zig");
+const trace = @import("../core/trace.zig");
+const types = @import("../core/types.zig");
+
+pub const bitstream = @import("zstd/bitstream.zig");
+pub const fse = @import("zstd/fse.zig");
+pub const huffman = @import("zstd/huffman.zig");
+pub const decode = @import("zstd/decode.zig");
+pub const encode = @import("zstd/encode.zig");
+
+pub const magic_number = decode.magic_number;
+pub const frameSize = decode.frameSize;
+pub const Level = encode.Level;
+pub const Encoder = encode.Encoder;
+
+/// Largest window accepted by default (the reference decoder's limit
+/// without --long)
+pub const default_max_window: u64 = 128 * 1024 * 1024;
+
+/// Streaming Zstandard decompressor over any reader
+///
+/// Memory is the input buffer plus one window (the frame's content size
+/// when that is smaller). Compressed and uncompressed byte counts are
+/// tracked exactly and reported to the observer after every block.
+///
+/// Example:
+/// ```zig
+/// var zstd = try ZstdReader.init(allocator, source, .{});
+/// defer zstd.deinit();
+///
+/// var buffer: [4096]u8 = undefined;
+/// while (true) {
+///     const n = try zstd.read(&buffer);
+///     if (n == 0) break;
+/// }
+/// ```
+pub const ZstdReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+    decoder: *decode.BlockDecoder,
+
+    /// Compressed input buffer and its unconsumed window
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    source_eof: bool = false,
+
+    /// Decoded output of the current frame; bytes before `out_start` are
+    /// kept as match history
+    window: []u8 = &.{},
+    out_start: usize = 0,
+    out_end: usize = 0,
+
+    /// Header of the frame being decoded (null between frames)
+    frame: ?decode.FrameHeader = null,
+    last_block: bool = false,
+    frame_output: u64 = 0,
+    hasher: std.hash.XxHash64 = std.hash.XxHash64.init(0),
+
+    max_window: u64,
+    finished: bool = false,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    /// Frames fully decoded and checked
+    frames: u64 = 0,
+
+    /// Progress observer, called after each block
+    observer: ?types.StreamObserver = null,
+
+    pub const Options = struct {
+        /// Frames declaring a larger window are rejected
+        max_window: u64 = default_max_window,
+    };
+
+    pub const Reader = std.io.Reader(*ZstdReader, anyerror, read);
+
+    /// Initialize a streaming decompressor
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate buffers
+    pub fn init(allocator: std.mem.Allocator, source: std.io.AnyReader, options: Options) !ZstdReader {
+        const decoder = try allocator.create(decode.BlockDecoder);
+        errdefer allocator.destroy(decoder);
+        decoder.* = .{};
+
+        // Room for a whole block plus its header
+        const in_buf = try allocator.alloc(u8, decode.max_block_size + types.BufferSize.default);
+
+        return .{
+            .allocator = allocator,
+            .source = source,
+            .decoder = decoder,
+            .in_buf = in_buf,
+            .max_window = options.max_window,
+        };
+    }
+
+    /// Release buffers
+    pub fn deinit(self: *ZstdReader) void {
+        self.allocator.free(self.window);
+        self.allocator.free(self.in_buf);
+        self.allocator.destroy(self.decoder);
+    }
+
+    /// Read decompressed data
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input
+    ///   - error.ChecksumMismatch: A frame failed its content checksum
+    ///   - error.UnsupportedFormat: Dictionary frame or window above `max_window`
+    ///   - (Any error returned by the observer)
+    pub fn read(self: *ZstdReader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (self.out_start == self.out_end) {
+            if (self.finished) return 0;
+            try self.decodeStep();
+        }
+        const n = @min(dest.len, self.out_end - self.out_start);
+        @memcpy(dest[0..n], self.window[self.out_start..][0..n]);
+        self.out_start += n;
+        return n;
+    }
+
+    /// Decompress and discard up to `count` bytes
+    ///
+    /// Decoded blocks are dropped straight from the window without being
+    /// copied out.
+    ///
+    /// Returns:
+    ///   - Number of bytes skipped (less than `count` only at end of stream)
+    pub fn skip(self: *ZstdReader, count: u64) anyerror!u64 {
+        var skipped: u64 = 0;
+        while (skipped < count) {
+            if (self.out_start == self.out_end) {
+                if (self.finished) break;
+                try self.decodeStep();
+                continue;
+            }
+            const n: usize = @intCast(@min(count - skipped, @as(u64, self.out_end - self.out_start)));
+            self.out_start += n;
+            skipped += n;
+        }
+        return skipped;
+    }
+
+    /// Buffer the start of the stream and check its magic number
+    ///
+    /// Must be called before any data has been read.
+    ///
+    /// Errors:
+    ///   - error.DecompressionFailed: Input is empty or not Zstandard
+    pub fn checkHeader(self: *ZstdReader) !void {
+        std.debug.assert(self.compressed_bytes == 0 and self.in_start == 0);
+
+        if (!try self.ensure(4)) return error.DecompressionFailed;
+        const magic = std.mem.readInt(u32, self.in_buf[0..4], .little);
+        if (magic != decode.magic_number and !decode.isSkippable(magic)) return error.DecompressionFailed;
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *ZstdReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Start a frame, decode one block or finish a frame
+    fn decodeStep(self: *ZstdReader) !void {
+        const frame = self.frame orelse return self.startFrame();
+        if (self.last_block) return self.endFrame(frame);
+        try self.decodeBlock(frame);
+    }
+
+    fn startFrame(self: *ZstdReader) !void {
+        if (!try self.ensure(4)) {
+            if (self.in_start == self.in_end) {
+                self.finished = true;
+                return;
+            }
+            return error.CorruptedStream;
+        }
+
+        const magic = std.mem.readInt(u32, self.in_buf[self.in_start..][0..4], .little);
+        if (decode.isSkippable(magic)) {
+            if (!try self.ensure(8)) return error.CorruptedStream;
+            const size = std.mem.readInt(u32, self.in_buf[self.in_start + 4 ..][0..4], .little);
+            self.consume(8);
+            return self.discard(size);
+        }
+
+        _ = try self.ensure(decode.max_frame_header_size);
+        const header = try decode.FrameHeader.parse(self.in_buf[self.in_start..self.in_end]) orelse
+            return error.CorruptedStream;
+        if (header.window_size > self.max_window) return error.UnsupportedFormat;
+        self.consume(header.size);
+
+        // Single-segment frames decode in place; otherwise keep two windows
+        // so the buffer only slides once per window of output
+        const wanted: u64 = if (header.single_segment)
+            header.window_size
+        else
+            2 * header.window_size + @as(u64, header.blockMaximum());
+        const capacity: usize = @intCast(if (header.content_size) |size| @min(size, wanted) else wanted);
+        if (self.window.len < capacity) {
+            self.allocator.free(self.window);
+            self.window = &.{};
+            self.window = try self.allocator.alloc(u8, capacity);
+        }
+
+        self.decoder.reset();
+        self.hasher = std.hash.XxHash64.init(0);
+        self.frame = header;
+        self.last_block = false;
+        self.frame_output = 0;
+        self.out_start = 0;
+        self.out_end = 0;
+    }
+
+    fn decodeBlock(self: *ZstdReader, frame: decode.FrameHeader) !void {
+        if (!try self.ensure(decode.block_header_size)) return error.CorruptedStream;
+        const block = decode.BlockHeader.parse(self.in_buf[self.in_start..][0..decode.block_header_size]);
+        const block_max = frame.blockMaximum();
+        if (block.block_type == .reserved or block.size > block_max) return error.CorruptedStream;
+
+        const content = block.contentSize();
+        if (!try self.ensure(decode.block_header_size + content)) return error.CorruptedStream;
+        self.consume(decode.block_header_size);
+        const src = self.in_buf[self.in_start..][0..content];
+
+        const window_size: usize = @intCast(frame.window_size);
+        self.makeRoom(window_size, block_max);
+        const pos = self.out_end;
+        const limit = @min(block_max, self.window.len - pos);
+
+        const produced = blk: {
+            const span = instrument.begin(.inflate);
+            defer span.end();
+
+            const n: usize = switch (block.block_type) {
+                .raw => raw: {
+                    if (content > limit) return error.CorruptedStream;
+                    @memcpy(self.window[pos..][0..content], src);
+                    break :raw content;
+                },
+                .rle => rle: {
+                    if (block.size > limit) return error.CorruptedStream;
+                    @memset(self.window[pos..][0..block.size], src[0]);
+                    break :rle block.size;
+                },
+                .compressed => try self.decoder.decodeBlock(src, self.window, pos, @min(pos, window_size), limit),
+                .reserved => unreachable,
+            };
+            if (frame.checksum) self.hasher.update(self.window[pos..][0..n]);
+            break :blk n;
+        };
+        self.consume(content);
+
+        self.out_end += produced;
+        self.frame_output += produced;
+        self.uncompressed_bytes += produced;
+        self.last_block = block.last;
+
+        if (self.observer) |observer| {
+            try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+        }
+    }
+
+    fn endFrame(self: *ZstdReader, frame: decode.FrameHeader) !void {
+        if (frame.content_size) |size| {
+            if (size != self.frame_output) return error.CorruptedStream;
+        }
+        if (frame.checksum) {
+            if (!try self.ensure(4)) return error.CorruptedStream;
+            const expected = std.mem.readInt(u32, self.in_buf[self.in_start..][0..4], .little);
+            self.consume(4);
+            if (@as(u32, @truncate(self.hasher.final())) != expected) return error.ChecksumMismatch;
+        }
+        self.frame = null;
+        self.frames += 1;
+    }
+
+    /// Slide the window, keeping only the history matches can still reach,
+    /// when a whole block would not fit after the current output
+    fn makeRoom(self: *ZstdReader, window_size: usize, block_max: usize) void {
+        if (self.window.len - self.out_end >= block_max) return;
+        const keep = @min(self.out_end, window_size);
+        if (keep == self.out_end) return;
+
+        std.mem.copyForwards(u8, self.window[0..keep], self.window[self.out_end - keep .. self.out_end]);
+        self.out_start = keep;
+        self.out_end = keep;
+    }
+
+    /// Buffer at least `n` bytes of input
+    ///
+    /// Returns:
+    ///   - false if the source ends first
+    fn ensure(self: *ZstdReader, n: usize) !bool {
+        std.debug.assert(n <= self.in_buf.len);
+        if (self.in_end - self.in_start >= n) return true;
+
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < n and !self.source_eof) try self.fill();
+        return self.in_end >= n;
+    }
+
+    /// Read more input after the buffered bytes
+    fn fill(self: *ZstdReader) !void {
+        const span = instrument.begin(.read);
+        defer span.end();
+
+        const n = try self.source.read(self.in_buf[self.in_end..]);
+        instrument.count(.bytes_read, n);
+        if (n == 0) self.source_eof = true;
+        self.in_end += n;
+    }
+
+    fn consume(self: *ZstdReader, n: usize) void {
+        self.in_start += n;
+        self.compressed_bytes += n;
+    }
+
+    /// Skip `count` bytes of input (a skippable frame's payload)
+    fn discard(self: *ZstdReader, count: u64) !void {
+        var left = count;
+        while (left > 0) {
+            if (self.in_start == self.in_end) {
+                if (self.source_eof) return error.CorruptedStream;
+                self.in_start = 0;
+                self.in_end = 0;
+                try self.fill();
+                continue;
+            }
+            const n: usize = @intCast(@min(left, @as(u64, self.in_end - self.in_start)));
+            self.consume(n);
+            left -= n;
+        }
+    }
+};
+
+/// Parallel Zstandard decompressor for multi-frame streams
+///
+/// Reads a batch of whole frames, decodes them on a thread pool (each
+/// worker checks its frame's content size and checksum) and hands the
+/// output back in order. Only frames that declare a content size of at
+/// most `max_parallel_frame` can be placed in a batch; at the first frame
+/// that cannot (a streaming frame, or one larger than the batch buffers),
+/// the rest of the input is handed to a ZstdReader instead.
+///
+/// Must not be moved after `init` (the pool keeps pointers into it).
+///
+/// Example:
+/// ```zig
+/// var parallel: ParallelReader = undefined;
+/// try parallel.init(allocator, file_reader.any(), .{ .threads = 8 });
+/// defer parallel.deinit();
+///
+/// const n = try parallel.read(&buffer);
+/// ```
+pub const ParallelReader = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+    pool: std.Thread.Pool,
+    max_parallel_frame: usize,
+    max_window: u64,
+
+    /// Compressed input for the current batch and its unconsumed window
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+    source_eof: bool = false,
+
+    /// Output of every frame in a batch, back to back
+    out_buf: []u8,
+    tasks: []Task,
+    decoders: []decode.BlockDecoder,
+    batch_len: usize = 0,
+    out_index: usize = 0,
+    out_pos: usize = 0,
+
+    /// Streaming decoder for the input after the last batched frame
+    fallback: ?*Fallback = null,
+
+    /// Frames decoded on the pool
+    frames: u64 = 0,
+
+    /// Total compressed bytes consumed
+    compressed_bytes: u64 = 0,
+
+    /// Total decompressed bytes produced
+    uncompressed_bytes: u64 = 0,
+
+    pub const Options = struct {
+        /// Worker threads (0 = one per CPU)
+        threads: usize = 0,
+
+        /// Frames decoded per batch, per thread
+        frames_per_thread: usize = 4,
+
+        /// Largest frame content decoded on the pool
+        max_parallel_frame: usize = 8 * 1024 * 1024,
+
+        /// Size of each of the input and output batch buffers
+        batch_size: usize = 64 * 1024 * 1024,
+
+        /// Frames declaring a larger window are rejected
+        max_window: u64 = default_max_window,
+    };
+
+    pub const Reader = std.io.Reader(*ParallelReader, anyerror, read);
+
+    const Task = struct {
+        input: []const u8 = &.{},
+        output: []u8 = &.{},
+        decoder: *decode.BlockDecoder,
+        err: ?anyerror = null,
+    };
+
+    /// Reader chaining input already buffered for batches with the rest
+    /// of the source
+    const Fallback = struct {
+        prefix: []const u8,
+        source: std.io.AnyReader,
+        stream: ZstdReader,
+
+        /// `compressed_bytes` when the fallback took over
+        compressed_base: u64,
+
+        fn readChained(context: *const anyopaque, buffer: []u8) anyerror!usize {
+            const self: *Fallback = @constCast(@ptrCast(@alignCast(context)));
+            if (self.prefix.len > 0) {
+                const n = @min(buffer.len, self.prefix.len);
+                @memcpy(buffer[0..n], self.prefix[0..n]);
+                self.prefix = self.prefix[n..];
+                return n;
+            }
+            return self.source.read(buffer);
+        }
+    };
+
+    /// Initialize in place
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate batch buffers
+    ///   - (Errors from spawning pool threads)
+    pub fn init(self: *ParallelReader, allocator: std.mem.Allocator, source: std.io.AnyReader, options: Options) !void {
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+        const batch_frames = @max(1, threads * options.frames_per_thread);
+
+        const in_buf = try allocator.alloc(u8, options.batch_size);
+        errdefer allocator.free(in_buf);
+        const out_buf = try allocator.alloc(u8, options.batch_size);
+        errdefer allocator.free(out_buf);
+        const tasks = try allocator.alloc(Task, batch_frames);
+        errdefer allocator.free(tasks);
+        const decoders = try allocator.alloc(decode.BlockDecoder, batch_frames);
+        errdefer allocator.free(decoders);
+
+        self.* = .{
+            .allocator = allocator,
+            .source = source,
+            .pool = undefined,
+            .max_parallel_frame = options.max_parallel_frame,
+            .max_window = options.max_window,
+            .in_buf = in_buf,
+            .out_buf = out_buf,
+            .tasks = tasks,
+            .decoders = decoders,
+        };
+        try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+    }
+
+    /// Stop worker threads and free buffers
+    pub fn deinit(self: *ParallelReader) void {
+        self.pool.deinit();
+        if (self.fallback) |fallback| {
+            fallback.stream.deinit();
+            self.allocator.destroy(fallback);
+        }
+        self.allocator.free(self.decoders);
+        self.allocator.free(self.tasks);
+        self.allocator.free(self.out_buf);
+        self.allocator.free(self.in_buf);
+    }
+
+    /// Read decompressed data in stream order
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed or truncated input
+    ///   - error.ChecksumMismatch: A frame failed its content checksum
+    ///   - error.UnsupportedFormat: Dictionary frame or window above `max_window`
+    pub fn read(self: *ParallelReader, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+
+        while (true) {
+            while (self.out_index < self.batch_len) {
+                const available = self.tasks[self.out_index].output;
+                if (self.out_pos < available.len) {
+                    const n = @min(dest.len, available.len - self.out_pos);
+                    @memcpy(dest[0..n], available[self.out_pos..][0..n]);
+                    self.out_pos += n;
+                    return n;
+                }
+                self.out_index += 1;
+                self.out_pos = 0;
+            }
+
+            if (self.fallback) |fallback| {
+                const n = try fallback.stream.read(dest);
+                self.compressed_bytes = fallback.compressed_base + fallback.stream.compressed_bytes;
+                self.uncompressed_bytes += n;
+                return n;
+            }
+
+            if (!try self.decodeBatch()) return 0;
+        }
+    }
+
+    /// Get a std.io.Reader for this decompressor
+    pub fn reader(self: *ParallelReader) Reader {
+        return .{ .context = self };
+    }
+
+    /// Decode the next batch of frames, or hand over to the fallback
+    ///
+    /// Returns:
+    ///   - false at the clean end of the input
+    fn decodeBatch(self: *ParallelReader) !bool {
+        try self.fill();
+        self.batch_len = 0;
+        self.out_index = 0;
+        self.out_pos = 0;
+
+        // Split the buffered input into whole frames
+        const start = self.in_start;
+        var count: usize = 0;
+        var pos = self.in_start;
+        var out_used: usize = 0;
+        while (count < self.tasks.len) {
+            const remaining = self.in_buf[pos..self.in_end];
+            if (remaining.len == 0) break;
+
+            const size = try decode.frameSize(remaining) orelse {
+                if (self.source_eof) return error.CorruptedStream;
+                break;
+            };
+            if (decode.isSkippable(std.mem.readInt(u32, remaining[0..4], .little))) {
+                pos += size;
+                continue;
+            }
+
+            const header = (try decode.FrameHeader.parse(remaining)).?;
+            if (header.window_size > self.max_window) return error.UnsupportedFormat;
+            const content = header.content_size orelse break;
+            if (content > self.max_parallel_frame or content > self.out_buf.len - out_used) break;
+            const content_len: usize = @intCast(content);
+
+            self.tasks[count] = .{
+                .input = remaining[0..size],
+                .output = self.out_buf[out_used..][0..content_len],
+                .decoder = &self.decoders[count],
+            };
+            count += 1;
+            pos += size;
+            out_used += content_len;
+        }
+        self.compressed_bytes += pos - start;
+        self.in_start = pos;
+
+        if (count == 0) {
+            if (pos > start) return true;
+            if (self.in_start == self.in_end) return false;
+            try self.startFallback();
+            return true;
+        }
+
+        var wg: std.Thread.WaitGroup = .{};
+        for (self.tasks[0..count]) |*task| {
+            self.pool.spawnWg(&wg, decodeFrame, .{task});
+        }
+        self.pool.waitAndWork(&wg);
+
+        for (self.tasks[0..count]) |task| {
+            if (task.err) |err| return err;
+        }
+
+        self.frames += count;
+        self.uncompressed_bytes += out_used;
+        self.batch_len = count;
+        return true;
+    }
+
+    /// Stream everything from the next frame on
+    fn startFallback(self: *ParallelReader) !void {
+        const fallback = try self.allocator.create(Fallback);
+        errdefer self.allocator.destroy(fallback);
+
+        fallback.* = .{
+            .prefix = self.in_buf[self.in_start..self.in_end],
+            .source = self.source,
+            .stream = undefined,
+            .compressed_base = self.compressed_bytes,
+        };
+        fallback.stream = try ZstdReader.init(
+            self.allocator,
+            .{ .context = fallback, .readFn = Fallback.readChained },
+            .{ .max_window = self.max_window },
+        );
+        self.in_start = self.in_end;
+        self.fallback = fallback;
+    }
+
+    /// Move unconsumed input to the front and top the buffer up
+    fn fill(self: *ParallelReader) !void {
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        while (self.in_end < self.in_buf.len and !self.source_eof) {
+            const n = try self.source.read(self.in_buf[self.in_end..]);
+            if (n == 0) self.source_eof = true;
+            self.in_end += n;
+        }
+    }
+
+    /// Worker: decode one complete frame into its output slot
+    fn decodeFrame(task: *Task) void {
+        trace.setThreadName("zstd worker");
+        const span = instrument.begin(.inflate);
+        defer span.end();
+
+        task.err = null;
+        decode.decodeFrame(task.decoder, task.input, task.output) catch |err| {
+            task.err = err;
+        };
+    }
+};
+
+/// Options for `compress`
+pub const CompressOptions = struct {
+    level: Level = .default,
+
+    /// Worker threads (0 = one per CPU)
+    threads: usize = 1,
+
+    /// Input bytes per independent frame
+    frame_size: usize = 4 * 1024 * 1024,
+
+    /// Append a content checksum to every frame
+    checksum: bool = true,
+};
+
+const CompressJob = struct {
+    allocator: std.mem.Allocator,
+    input: []const u8,
+    level: Level,
+    checksum: bool,
+    output: std.ArrayList(u8),
+    err: ?anyerror = null,
+
+    fn run(job: *CompressJob) void {
+        trace.setThreadName("zstd worker");
+        var encoder = Encoder.init(job.allocator, job.level) catch |err| {
+            job.err = err;
+            return;
+        };
+        defer encoder.deinit();
+        encoder.compressFrame(job.input, job.checksum, &job.output) catch |err| {
+            job.err = err;
+        };
+    }
+};
+
+/// Compress data as a series of independent frames
+///
+/// The output is the same for any thread count.
+///
+/// Parameters:
+///   - allocator: Allocator for the result and encoder state
+///   - data: Input data
+///   - options: Level, threads and frame size
+///
+/// Returns:
+///   - Compressed data (caller owns)
+///
+/// Errors:
+///   - error.OutOfMemory: Failed to allocate
+pub fn compress(allocator: std.mem.Allocator, data: []const u8, options: CompressOptions) ![]u8 {
+    std.debug.assert(options.frame_size > 0 and options.frame_size < std.math.maxInt(u32));
+    const frame_count = @max(1, std.math.divCeil(usize, data.len, options.frame_size) catch unreachable);
+    const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+
+    if (threads == 1 or frame_count == 1) {
+        var encoder = try Encoder.init(allocator, options.level);
+        defer encoder.deinit();
+
+        var out = std.ArrayList(u8).init(allocator);
+        errdefer out.deinit();
+        for (0..frame_count) |i| {
+            try encoder.compressFrame(frameInput(data, i, options.frame_size), options.checksum, &out);
+        }
+        return out.toOwnedSlice();
+    }
+
+    const jobs = try allocator.alloc(CompressJob, frame_count);
+    defer allocator.free(jobs);
+    for (jobs, 0..) |*job, i| {
+        job.* = .{
+            .allocator = allocator,
+            .input = frameInput(data, i, options.frame_size),
+            .level = options.level,
+            .checksum = options.checksum,
+            .output = std.ArrayList(u8).init(allocator),
+        };
+    }
+    defer for (jobs) |*job| job.output.deinit();
+
+    {
+        var pool: std.Thread.Pool = undefined;
+        try pool.init(.{ .allocator = allocator, .n_jobs = @min(threads, frame_count) });
+        defer pool.deinit();
+
+        var wg: std.Thread.WaitGroup = .{};
+        for (jobs) |*job| pool.spawnWg(&wg, CompressJob.run, .{job});
+        pool.waitAndWork(&wg);
+    }
+
+    var total: usize = 0;
+    for (jobs) |job| {
+        if (job.err) |err| return err;
+        total += job.output.items.len;
+    }
+    const out = try allocator.alloc(u8, total);
+    var pos: usize = 0;
+    for (jobs) |job| {
+        @memcpy(out[pos..][0..job.output.items.len], job.output.items);
+        pos += job.output.items.len;
+    }
+    return out;
+}
+
+fn frameInput(data: []const u8, index: usize, frame_size: usize) []const u8 {
+    const start = @min(data.len, index * frame_size);
+    return data[start..@min(data.len, start + frame_size)];
+}
+
+/// Decompress a complete Zstandard stream
+///
+/// Errors:
+///   - error.CorruptedStream: Malformed or truncated input
+///   - error.ChecksumMismatch: A frame failed its content checksum
+///   - error.UnsupportedFormat: Dictionary frame or window above the default limit
+pub fn decompress(allocator: std.mem.Allocator, data: []const u8) ![]u8 {
+    var fbs = std.io.fixedBufferStream(data);
+    const source = fbs.reader();
+    var stream = try ZstdReader.init(allocator, source.any(), .{});
+    defer stream.deinit();
+
+    return stream.reader().readAllAlloc(allocator, std.math.maxInt(usize));
+}
+
+// Tests
+
+const reference_text = ("Zstandard combines a fast LZ77 match finder with Huffman-coded literals " ++
+    "and FSE-coded sequences. Frames are independent, so archives written as " ++
+    "many small frames can be decoded on every core at once. ") ** 4;
+
+/// `reference_text` compressed by the reference library at level 3, with
+/// content size and checksum
+const reference_frame = [_]u8{
+    0x28, 0xb5, 0x2f, 0xfd, 0x64, 0x20, 0x02, 0x95, 0x04, 0x00, 0xd2, 0xca, 0x1e, 0x1b, 0x80, 0xa7,
+    0x69, 0x03, 0xe0, 0xff, 0xef, 0x6e, 0x0c, 0xb2, 0xe7, 0xd8, 0x49, 0x29, 0xa2, 0x03, 0xc8, 0xe1,
+    0x50, 0x44, 0x48, 0xd5, 0x52, 0x77, 0x14, 0x19, 0x0d, 0x26, 0x6e, 0x98, 0xbc, 0xe5, 0x67, 0x32,
+    0x1f, 0xf2, 0x85, 0x1b, 0xd3, 0xcf, 0x47, 0x8c, 0x65, 0xc5, 0xe7, 0x14, 0x52, 0x1f, 0xb0, 0x90,
+    0xb5, 0x8c, 0xdf, 0x35, 0x69, 0xb0, 0xbe, 0x60, 0x12, 0xcb, 0x72, 0x52, 0x03, 0x2c, 0xfe, 0xf0,
+    0x06, 0x7e, 0xa2, 0x4a, 0xc3, 0x84, 0xde, 0xf0, 0x84, 0x83, 0xab, 0x40, 0x81, 0xe1, 0xc3, 0xb2,
+    0x9e, 0xca, 0xaf, 0x39, 0xbe, 0x5f, 0xb2, 0x00, 0x2c, 0x54, 0x0a, 0x61, 0xc0, 0xc9, 0x1a, 0x83,
+    0xf3, 0x87, 0xa6, 0x38, 0xb1, 0x2d, 0xe4, 0xa2, 0x38, 0x08, 0xbc, 0x5a, 0xc5, 0x65, 0x3d, 0x1a,
+    0x04, 0x25, 0xf3, 0x65, 0x1d, 0xd6, 0xea, 0x11, 0x06, 0x00, 0xab, 0x2c, 0xad, 0xb6, 0x3a, 0x8c,
+    0xc3, 0xae, 0x53, 0x92, 0x08, 0x17, 0x0b, 0xa1, 0x3e, 0x9a, 0xcd, 0x28, 0x26, 0x4f, 0x41, 0xce,
+};
+
+/// `reference_text` compressed by the reference library's streaming API at
+/// level 1 (no content size, so never decoded on the pool)
+const reference_streamed_frame = [_]u8{
+    0x28, 0xb5, 0x2f, 0xfd, 0x04, 0x48, 0x95, 0x04, 0x00, 0x12, 0x4c, 0x21, 0x1b, 0x80, 0x37, 0x69,
+    0x03, 0x60, 0xf6, 0xbb, 0x1b, 0x83, 0xec, 0xe9, 0x7f, 0x52, 0x8a, 0x9c, 0x46, 0xe0, 0x51, 0x44,
+    0x32, 0x20, 0xc0, 0x66, 0x77, 0x30, 0x2f, 0x0d, 0x25, 0x9c, 0xec, 0x34, 0xdd, 0xdf, 0xa1, 0x36,
+    0xee, 0x8b, 0xd7, 0x4e, 0xeb, 0x75, 0xe8, 0xd5, 0x23, 0x6a, 0xa6, 0xe2, 0x8d, 0x8f, 0xf4, 0x38,
+    0x6c, 0xb0, 0x0d, 0xb3, 0x29, 0xba, 0xf6, 0xcc, 0x72, 0x8c, 0xe2, 0x17, 0x25, 0x41, 0xe7, 0x1e,
+    0x2c, 0x40, 0xda, 0xcb, 0x6e, 0xf0, 0xb2, 0xd2, 0x9f, 0x8b, 0x37, 0x3e, 0x43, 0x09, 0x78, 0xb2,
+    0x2b, 0x0e, 0x8e, 0x02, 0x05, 0x86, 0x96, 0xb9, 0x78, 0xf8, 0x9e, 0xe5, 0x68, 0xbd, 0x0e, 0x05,
+    0x98, 0x0d, 0x21, 0x8a, 0x81, 0x26, 0xb2, 0x30, 0x7a, 0x2f, 0x2b, 0xa4, 0x09, 0x4a, 0x9b, 0x16,
+    0x0a, 0x07, 0x82, 0x26, 0x9a, 0xd4, 0xc5, 0x5b, 0x41, 0x98, 0x43, 0xad, 0x73, 0x99, 0x13, 0x0f,
+    0x01, 0x02, 0x00, 0x72, 0x95, 0xa5, 0xa9, 0xf1, 0x68, 0x36, 0xcf, 0x26, 0x4f, 0x41, 0xce,
+};
+
+/// Mix of incompressible bytes, runs, text and long-distance repeats
+fn testData(allocator: std.mem.Allocator, len: usize) ![]u8 {
+    const data = try allocator.alloc(u8, len);
+    var prng = std.Random.DefaultPrng.init(0x7a73);
+    const random = prng.random();
+    const words = "the quick brown fox jumps over the lazy dog ";
+
+    var i: usize = 0;
+    while (i < len) {
+        const run = @min(len - i, random.intRangeAtMost(usize, 1, 3000));
+        const chunk = data[i..][0..run];
+        switch (random.uintLessThan(u8, 4)) {
+            0 => random.bytes(chunk),
+            1 => @memset(chunk, random.int(u8)),
+            2 => for (chunk, i..) |*b, j| {
+                b.* = words[j % words.len];
+            },
+            else => if (i == 0) {
+                @memset(chunk, 0);
+            } else {
+                const from = random.uintLessThan(usize, i);
+                for (chunk, 0..) |*b, j| b.* = data[from + j];
+            },
+        }
+        i += run;
+    }
+    return data;
+}
+
+test "ZstdReader: decodes reference frames, concatenated and skippable" {
+    const allocator = std.testing.allocator;
+
+    var input = std.ArrayList(u8).init(allocator);
+    defer input.deinit();
+    try input.appendSlice(&reference_frame);
+    // Skippable frame with a 5-byte payload
+    try input.appendSlice(&.{ 0x5e, 0x2a, 0x4d, 0x18, 5, 0, 0, 0, 1, 2, 3, 4, 5 });
+    try input.appendSlice(&reference_streamed_frame);
+
+    var fbs = std.io.fixedBufferStream(input.items);
+    const source = fbs.reader();
+    var stream = try ZstdReader.init(allocator, source.any(), .{});
+    defer stream.deinit();
+    try stream.checkHeader();
+
+    const out = try stream.reader().readAllAlloc(allocator, 1 << 20);
+    defer allocator.free(out);
+    try std.testing.expectEqualStrings(reference_text ++ reference_text, out);
+    try std.testing.expectEqual(@as(u64, 2), stream.frames);
+    try std.testing.expectEqual(@as(u64, input.items.len), stream.compressed_bytes);
+}
+
+test "ZstdReader: rejects truncated, corrupted and foreign input" {
+    const allocator = std.testing.allocator;
+
+    try std.testing.expectError(error.CorruptedStream, decompress(allocator, reference_frame[0 .. reference_frame.len - 10]));
+
+    var corrupt = reference_frame;
+    corrupt[corrupt.len - 1] ^= 0xff;
+    try std.testing.expectError(error.ChecksumMismatch, decompress(allocator, &corrupt));
+
+    var fbs = std.io.fixedBufferStream("\x1f\x8b\x08\x00 not zstd");
+    const source = fbs.reader();
+    var stream = try ZstdReader.init(allocator, source.any(), .{});
+    defer stream.deinit();
+    try std.testing.expectError(error.DecompressionFailed, stream.checkHeader());
+
+    // A window above the configured limit is refused before allocating it
+    var limited_fbs = std.io.fixedBufferStream(&reference_streamed_frame);
+    const limited_source = limited_fbs.reader();
+    var limited = try ZstdReader.init(allocator, limited_source.any(), .{ .max_window = 64 * 1024 });
+    defer limited.deinit();
+    var buffer: [64]u8 = undefined;
+    try std.testing.expectError(error.UnsupportedFormat, limited.read(&buffer));
+}
+
+test "compress: round trips at both levels with any thread count" {
+    const allocator = std.testing.allocator;
+
+    const data = try testData(allocator, 700 * 1024);
+    defer allocator.free(data);
+
+    for ([_]Level{ .fast, .default }) |level| {
+        const single = try compress(allocator, data, .{ .level = level, .frame_size = 256 * 1024 });
+        defer allocator.free(single);
+        const threaded = try compress(allocator, data, .{ .level = level, .threads = 3, .frame_size = 256 * 1024 });
+        defer allocator.free(threaded);
+        try std.testing.expectEqualSlices(u8, single, threaded);
+        try std.testing.expect(single.len < data.len);
+
+        const out = try decompress(allocator, single);
+        defer allocator.free(out);
+        try std.testing.expectEqualSlices(u8, data, out);
+    }
+
+    // Empty input is still one (empty) frame
+    const empty = try compress(allocator, "", .{});
+    defer allocator.free(empty);
+    const empty_out = try decompress(allocator, empty);
+    defer allocator.free(empty_out);
+    try std.testing.expectEqual(@as(usize, 0), empty_out.len);
+}
+
+test "ParallelReader: decodes frames in order and streams the rest" {
+    const allocator = std.testing.allocator;
+
+    const data = try testData(allocator, 300 * 1024);
+    defer allocator.free(data);
+    const frames = try compress(allocator, data, .{ .frame_size = 64 * 1024 });
+    defer allocator.free(frames);
+
+    var input = std.ArrayList(u8).init(allocator);
+    defer input.deinit();
+    try input.appendSlice(frames);
+    try input.appendSlice(&reference_streamed_frame);
+    try input.appendSlice(&reference_frame);
+
+    var expected = std.ArrayList(u8).init(allocator);
+    defer expected.deinit();
+    try expected.appendSlice(data);
+    try expected.appendSlice(reference_text ++ reference_text);
+
+    {
+        var fbs = std.io.fixedBufferStream(input.items);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2, .frames_per_thread = 2, .batch_size = 256 * 1024 });
+        defer parallel.deinit();
+
+        const out = try parallel.reader().readAllAlloc(allocator, 1 << 22);
+        defer allocator.free(out);
+        try std.testing.expectEqualSlices(u8, expected.items, out);
+        try std.testing.expectEqual(@as(u64, 5), parallel.frames);
+        try std.testing.expectEqual(@as(u64, input.items.len), parallel.compressed_bytes);
+        try std.testing.expectEqual(@as(u64, expected.items.len), parallel.uncompressed_bytes);
+    }
+
+    {
+        // Flip a byte in the third frame's checksum
+        var offset: usize = 0;
+        for (0..3) |_| offset += (try frameSize(input.items[offset..])).?;
+        input.items[offset - 1] ^= 0xff;
+
+        var fbs = std.io.fixedBufferStream(input.items);
+        const source = fbs.reader();
+        var parallel: ParallelReader = undefined;
+        try parallel.init(allocator, source.any(), .{ .threads = 2, .frames_per_thread = 2, .batch_size = 256 * 1024 });
+        defer parallel.deinit();
+
+        try std.testing.expectError(
+            error.ChecksumMismatch,
+            parallel.reader().readAllAlloc(allocator, 1 << 22),
+        );
+    }
+}
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Zstandard bit streams (RFC 8878 section 4.1)
+//!
+//! FSE table descriptions are read forwards, least significant bit first.
+//! Entropy-coded payloads (Huffman literals, FSE sequences and Huffman
+//! weights) are written forwards but read backwards: the highest set bit
+//! of the last byte is an end marker and decoding starts just below it.
+
+const std = @import("std");
+
+inline fn mask(n: u6) u64 {
+    return (@as(u64, 1) << n) - 1;
+}
+
+/// Little-endian load of up to 8 bytes at `offset`, zero-padded past the end
+inline fn load64(data: []const u8, offset: usize) u64 {
+    if (offset + 8 <= data.len) return std.mem.readInt(u64, data[offset..][0..8], .little);
+    var buf = [_]u8{0} ** 8;
+    if (offset < data.len) {
+        const n = data.len - offset;
+        @memcpy(buf[0..n], data[offset..]);
+    }
+    return std.mem.readInt(u64, &buf, .little);
+}
+
+/// Forward bit reader for FSE table descriptions
+pub const ForwardBitReader = struct {
+    data: []const u8,
+
+    /// Bits consumed so far
+    pos: usize = 0,
+
+    /// Next `n` bits without consuming them (bits past the end read as zero)
+    pub fn peek(self: *const ForwardBitReader, n: u6) u32 {
+        const value = load64(self.data, self.pos >> 3) >> @intCast(self.pos & 7);
+        return @truncate(value & mask(n));
+    }
+
+    /// Consume `n` bits
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Fewer than `n` bits remain
+    pub fn read(self: *ForwardBitReader, n: u6) !u32 {
+        if (self.pos + n > self.data.len * 8) return error.CorruptedStream;
+        const value = self.peek(n);
+        self.pos += n;
+        return value;
+    }
+
+    /// Whole bytes touched so far
+    pub fn bytesConsumed(self: *const ForwardBitReader) usize {
+        return (self.pos + 7) / 8;
+    }
+};
+
+/// Backward bit reader for entropy-coded payloads
+///
+/// Reading past the start of the stream returns zero bits and sets
+/// `overflow`, which FSE weight decoding uses as its end condition; every
+/// other caller treats it as corruption.
+pub const ReverseBitReader = struct {
+    data: []const u8,
+
+    /// Bits left to read, counted from the start of `data`
+    remaining: usize,
+
+    /// Set once a read has gone past the start of the stream
+    overflow: bool = false,
+
+    /// Position the reader just below the end marker
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Empty stream or missing end marker
+    pub fn init(data: []const u8) !ReverseBitReader {
+        if (data.len == 0) return error.CorruptedStream;
+        const last = data[data.len - 1];
+        if (last == 0) return error.CorruptedStream;
+        return .{
+            .data = data,
+            .remaining = (data.len - 1) * 8 + (7 - @as(usize, @clz(last))),
+        };
+    }
+
+    /// Read `n` bits (at most 56)
+    pub inline fn readBits(self: *ReverseBitReader, n: u6) u64 {
+        if (n == 0) return 0;
+        if (n > self.remaining) {
+            const have: u6 = @intCast(self.remaining);
+            const value = if (have == 0) 0 else load64(self.data, 0) & mask(have);
+            self.remaining = 0;
+            self.overflow = true;
+            return value << (n - have);
+        }
+        self.remaining -= n;
+        return (load64(self.data, self.remaining >> 3) >> @intCast(self.remaining & 7)) & mask(n);
+    }
+
+    /// Next `n` bits without consuming them (at most 56)
+    pub inline fn peek(self: *const ReverseBitReader, n: u6) u64 {
+        if (n <= self.remaining) {
+            const start = self.remaining - n;
+            return (load64(self.data, start >> 3) >> @intCast(start & 7)) & mask(n);
+        }
+        const have: u6 = @intCast(self.remaining);
+        if (have == 0) return 0;
+        return (load64(self.data, 0) & mask(have)) << (n - have);
+    }
+
+    /// Consume `n` bits after a peek
+    pub inline fn consume(self: *ReverseBitReader, n: u6) void {
+        if (n > self.remaining) {
+            self.remaining = 0;
+            self.overflow = true;
+        } else {
+            self.remaining -= n;
+        }
+    }
+
+    /// Whether every bit was read, and no more
+    pub fn finished(self: *const ReverseBitReader) bool {
+        return self.remaining == 0 and !self.overflow;
+    }
+};
+
+/// Bit writer producing streams for either reader
+///
+/// Bits are packed least significant first. `close` appends the end marker
+/// a ReverseBitReader looks for; `flush` pads the last byte with zeros for
+/// forward-read table descriptions.
+pub const BitWriter = struct {
+    out: *std.ArrayList(u8),
+    acc: u64 = 0,
+    count: u6 = 0,
+
+    /// Append the low `n` bits of `value` (at most 32)
+    pub inline fn add(self: *BitWriter, value: u64, n: u6) !void {
+        std.debug.assert(n <= 32);
+        self.acc |= (value & mask(n)) << self.count;
+        self.count += n;
+        if (self.count >= 32) {
+            var bytes: [4]u8 = undefined;
+            std.mem.writeInt(u32, &bytes, @truncate(self.acc), .little);
+            try self.out.appendSlice(&bytes);
+            self.acc >>= 32;
+            self.count -= 32;
+        }
+    }
+
+    /// Write out pending bits, zero-padding the last byte
+    pub fn flush(self: *BitWriter) !void {
+        while (self.count > 0) {
+            try self.out.append(@truncate(self.acc));
+            self.acc >>= 8;
+            self.count -|= 8;
+        }
+        self.acc = 0;
+    }
+
+    /// Append the end marker and write out pending bits
+    pub fn close(self: *BitWriter) !void {
+        try self.add(1, 1);
+        try self.flush();
+    }
+};
+
+// Tests
+
+test "ReverseBitReader: reads a BitWriter stream backwards" {
+    const allocator = std.testing.allocator;
+
+    var out = std.ArrayList(u8).init(allocator);
+    defer out.deinit();
+    var writer = BitWriter{ .out = &out };
+    for (0..100) |i| try writer.add(i, @intCast(i % 17));
+    try writer.close();
+
+    var reader = try ReverseBitReader.init(out.items);
+    var i: usize = 100;
+    while (i > 0) {
+        i -= 1;
+        const n: u6 = @intCast(i % 17);
+        try std.testing.expectEqual(@as(u64, i) & ((@as(u64, 1) << n) - 1), reader.readBits(n));
+    }
+    try std.testing.expect(reader.finished());
+
+    _ = reader.readBits(3);
+    try std.testing.expect(reader.overflow);
+}
+
+test "ForwardBitReader: reads least significant bits first" {
+    var reader = ForwardBitReader{ .data = &.{ 0b1010_0101, 0xff } };
+    try std.testing.expectEqual(@as(u32, 0b0101), try reader.read(4));
+    try std.testing.expectEqual(@as(u32, 0b11_1010), try reader.read(6));
+    try std.testing.expectEqual(@as(usize, 2), reader.bytesConsumed());
+    try std.testing.expectError(error.CorruptedStream, reader.read(7));
+}
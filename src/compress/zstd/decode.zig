@@ -0,0 +1,640 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Zstandard frame and block decoding (RFC 8878 section 3)
+//!
+//! This module decodes one block at a time into a caller-owned buffer
+//! that also holds the frame's history (the window matches copy from).
+//! Buffer management and streaming live in `zstd.zig`.
+
+const std = @import("std");
+const bitstream = @import("bitstream.zig");
+const fse = @import("fse.zig");
+const huffman = @import("huffman.zig");
+
+/// Zstandard frame magic number
+pub const magic_number: u32 = 0xFD2FB528;
+
+/// Skippable frames use magic numbers 0x184D2A50..0x184D2A5F
+pub const skippable_magic_base: u32 = 0x184D2A50;
+
+/// Largest decoded size of one block
+pub const max_block_size: usize = 128 * 1024;
+
+/// Largest frame header, magic number included
+pub const max_frame_header_size: usize = 18;
+
+/// Block header size
+pub const block_header_size: usize = 3;
+
+/// Literal length code baselines and extra bits
+pub const literal_length_base = [36]u32{
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 128, 256, 512, 1024, 2048, 4096,
+    8192, 16384, 32768, 65536,
+};
+pub const literal_length_bits = [36]u8{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8, 9, 10, 11, 12,
+    13, 14, 15, 16,
+};
+
+/// Match length code baselines and extra bits
+pub const match_length_base = [53]u32{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+    19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+    35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515, 1027, 2051,
+    4099, 8195, 16387, 32771, 65539,
+};
+pub const match_length_bits = [53]u8{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16,
+};
+
+/// Largest literal length, offset and match length codes
+pub const max_literal_length_code = 35;
+pub const max_offset_code = 31;
+pub const max_match_length_code = 52;
+
+/// Whether `magic` starts a skippable frame
+pub fn isSkippable(magic: u32) bool {
+    return magic & 0xFFFFFFF0 == skippable_magic_base;
+}
+
+/// Parsed frame header (RFC 8878 section 3.1.1.1)
+pub const FrameHeader = struct {
+    /// Bytes of history matches may reach back
+    window_size: u64,
+
+    /// Decoded size, when the encoder recorded it
+    content_size: ?u64,
+
+    /// Whether an XXH64-based checksum follows the last block
+    checksum: bool,
+
+    /// Whether the whole frame is one window (no history beyond the content)
+    single_segment: bool,
+
+    /// Header size, magic number included
+    size: usize,
+
+    /// Parse a frame header
+    ///
+    /// Returns:
+    ///   - null if `data` ends before the header does
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Bad magic number or reserved bit set
+    ///   - error.UnsupportedFormat: Frame needs a dictionary
+    pub fn parse(data: []const u8) !?FrameHeader {
+        if (data.len < 5) return null;
+        if (std.mem.readInt(u32, data[0..4], .little) != magic_number) return error.CorruptedStream;
+
+        const descriptor = data[4];
+        const fcs_flag: u2 = @intCast(descriptor >> 6);
+        const single_segment = descriptor & 0x20 != 0;
+        if (descriptor & 0x08 != 0) return error.CorruptedStream;
+        const dictionary_id_size = [4]usize{ 0, 1, 2, 4 }[descriptor & 3];
+        const content_size_size = [4]usize{ @intFromBool(single_segment), 2, 4, 8 }[fcs_flag];
+
+        const size = 5 + @as(usize, @intFromBool(!single_segment)) + dictionary_id_size + content_size_size;
+        if (data.len < size) return null;
+
+        var pos: usize = 5;
+        var window_size: u64 = 0;
+        if (!single_segment) {
+            const exponent: u6 = @intCast(data[pos] >> 3);
+            const base = @as(u64, 1) << (10 + exponent);
+            window_size = base + (base >> 3) * (data[pos] & 7);
+            pos += 1;
+        }
+
+        var dictionary_id: u32 = 0;
+        for (0..dictionary_id_size) |i| dictionary_id |= @as(u32, data[pos + i]) << @intCast(8 * i);
+        pos += dictionary_id_size;
+        if (dictionary_id != 0) return error.UnsupportedFormat;
+
+        var content_size: ?u64 = null;
+        if (content_size_size > 0) {
+            var value: u64 = 0;
+            for (0..content_size_size) |i| value |= @as(u64, data[pos + i]) << @intCast(8 * i);
+            if (content_size_size == 2) value += 256;
+            content_size = value;
+        }
+        if (single_segment) window_size = content_size.?;
+
+        return .{
+            .window_size = window_size,
+            .content_size = content_size,
+            .checksum = descriptor & 0x04 != 0,
+            .single_segment = single_segment,
+            .size = size,
+        };
+    }
+
+    /// Largest block this frame may contain
+    pub fn blockMaximum(self: FrameHeader) usize {
+        return @intCast(@min(self.window_size, max_block_size));
+    }
+};
+
+/// Block types (RFC 8878 section 3.1.1.2.2)
+pub const BlockType = enum(u2) {
+    raw,
+    rle,
+    compressed,
+    reserved,
+};
+
+/// Parsed 3-byte block header
+pub const BlockHeader = struct {
+    last: bool,
+    block_type: BlockType,
+
+    /// Decoded size for raw and RLE blocks, compressed size otherwise
+    size: u21,
+
+    pub fn parse(bytes: *const [3]u8) BlockHeader {
+        const value = std.mem.readInt(u24, bytes, .little);
+        return .{
+            .last = value & 1 != 0,
+            .block_type = @enumFromInt(@as(u2, @truncate(value >> 1))),
+            .size = @intCast(value >> 3),
+        };
+    }
+
+    /// Bytes of block content following the header
+    pub fn contentSize(self: BlockHeader) usize {
+        return switch (self.block_type) {
+            .rle => 1,
+            else => self.size,
+        };
+    }
+};
+
+/// Total size of the frame starting at `data`, found by walking block headers
+///
+/// Lets independent frames be handed to separate threads without decoding.
+///
+/// Returns:
+///   - Frame size in bytes (skippable frames included), or null if `data`
+///     ends before the frame does
+///
+/// Errors:
+///   - error.CorruptedStream: Not a frame, or a reserved block type
+pub fn frameSize(data: []const u8) !?usize {
+    if (data.len < 4) return null;
+    const magic = std.mem.readInt(u32, data[0..4], .little);
+    if (isSkippable(magic)) {
+        if (data.len < 8) return null;
+        const size = 8 + @as(usize, std.mem.readInt(u32, data[4..8], .little));
+        return if (size <= data.len) size else null;
+    }
+
+    const header = try FrameHeader.parse(data) orelse return null;
+    var pos = header.size;
+    while (true) {
+        if (data.len < pos + block_header_size) return null;
+        const block = BlockHeader.parse(data[pos..][0..3]);
+        if (block.block_type == .reserved) return error.CorruptedStream;
+        pos += block_header_size + block.contentSize();
+        if (block.last) break;
+    }
+    if (header.checksum) pos += 4;
+    return if (pos <= data.len) pos else null;
+}
+
+/// Decode a complete in-memory frame whose content size is known
+///
+/// Parameters:
+///   - decoder: Scratch decoder (reset here)
+///   - frame: Exactly one frame, as measured by `frameSize`
+///   - out: Exactly the frame's content size
+///
+/// Errors:
+///   - error.CorruptedStream: Malformed frame or wrong content size
+///   - error.ChecksumMismatch: Content checksum does not match
+pub fn decodeFrame(decoder: *BlockDecoder, frame: []const u8, out: []u8) !void {
+    const header = try FrameHeader.parse(frame) orelse return error.CorruptedStream;
+    const block_max = header.blockMaximum();
+    const window_size: usize = @intCast(@min(header.window_size, out.len));
+    decoder.reset();
+
+    var pos = header.size;
+    var produced: usize = 0;
+    while (true) {
+        if (frame.len < pos + block_header_size) return error.CorruptedStream;
+        const block = BlockHeader.parse(frame[pos..][0..3]);
+        pos += block_header_size;
+
+        const content = block.contentSize();
+        if (block.block_type == .reserved or block.size > block_max or content > frame.len - pos) {
+            return error.CorruptedStream;
+        }
+        const src = frame[pos..][0..content];
+        const limit = @min(block_max, out.len - produced);
+        produced += switch (block.block_type) {
+            .raw => raw: {
+                if (content > limit) return error.CorruptedStream;
+                @memcpy(out[produced..][0..content], src);
+                break :raw content;
+            },
+            .rle => rle: {
+                if (block.size > limit) return error.CorruptedStream;
+                @memset(out[produced..][0..block.size], src[0]);
+                break :rle block.size;
+            },
+            .compressed => try decoder.decodeBlock(src, out, produced, @min(produced, window_size), limit),
+            .reserved => unreachable,
+        };
+        pos += content;
+        if (block.last) break;
+    }
+
+    if (produced != out.len) return error.CorruptedStream;
+    if (header.content_size) |size| {
+        if (size != produced) return error.CorruptedStream;
+    }
+    if (header.checksum) {
+        if (frame.len < pos + 4) return error.CorruptedStream;
+        const expected = std.mem.readInt(u32, frame[pos..][0..4], .little);
+        if (@as(u32, @truncate(std.hash.XxHash64.hash(0, out))) != expected) return error.ChecksumMismatch;
+        pos += 4;
+    }
+    if (pos != frame.len) return error.CorruptedStream;
+}
+
+/// Decoder state carried between the blocks of one frame
+///
+/// Large (literal buffer and entropy tables); allocate it on the heap.
+pub const BlockDecoder = struct {
+    huffman_table: huffman.DecodeTable = .{},
+    has_huffman: bool = false,
+
+    /// Literal length, offset and match length tables
+    tables: [3]fse.DecodeTable = .{ .{}, .{}, .{} },
+    has_tables: [3]bool = .{ false, false, false },
+
+    /// Repeat offsets
+    reps: [3]u32 = .{ 1, 4, 8 },
+
+    literals: [max_block_size]u8 = undefined,
+
+    const Field = enum(u2) { literal_length, offset, match_length };
+
+    /// Forget tables and repeat offsets at the start of a frame
+    pub fn reset(self: *BlockDecoder) void {
+        self.has_huffman = false;
+        self.has_tables = .{ false, false, false };
+        self.reps = .{ 1, 4, 8 };
+    }
+
+    /// Decode one compressed block
+    ///
+    /// Parameters:
+    ///   - block: Block content (after the block header)
+    ///   - out: Frame buffer; output is written at `out[pos..]`
+    ///   - pos: Write position
+    ///   - history: Bytes before `pos` that matches may reference
+    ///   - limit: Largest output allowed for this block
+    ///
+    /// Returns:
+    ///   - Bytes written
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed block or out-of-range match
+    pub fn decodeBlock(self: *BlockDecoder, block: []const u8, out: []u8, pos: usize, history: usize, limit: usize) !usize {
+        std.debug.assert(pos + limit <= out.len);
+        var p: usize = 0;
+        const literals = try self.decodeLiterals(block, &p);
+        if (p >= block.len) return error.CorruptedStream;
+
+        // Number of sequences
+        var count: usize = block[p];
+        p += 1;
+        if (count >= 128) {
+            if (count == 255) {
+                if (p + 2 > block.len) return error.CorruptedStream;
+                count = @as(usize, block[p]) + (@as(usize, block[p + 1]) << 8) + 0x7F00;
+                p += 2;
+            } else {
+                if (p + 1 > block.len) return error.CorruptedStream;
+                count = ((count - 128) << 8) + block[p];
+                p += 1;
+            }
+        }
+
+        if (count == 0) {
+            if (p != block.len or literals.len > limit) return error.CorruptedStream;
+            @memcpy(out[pos..][0..literals.len], literals);
+            return literals.len;
+        }
+
+        if (p >= block.len) return error.CorruptedStream;
+        const modes = block[p];
+        p += 1;
+        if (modes & 3 != 0) return error.CorruptedStream;
+        try self.readTable(.literal_length, modes >> 6, block, &p);
+        try self.readTable(.offset, (modes >> 4) & 3, block, &p);
+        try self.readTable(.match_length, (modes >> 2) & 3, block, &p);
+
+        return self.executeSequences(block[p..], count, literals, out, pos, history, limit);
+    }
+
+    /// Decode the literals section, advancing `p` past it
+    fn decodeLiterals(self: *BlockDecoder, block: []const u8, p: *usize) ![]const u8 {
+        if (block.len == 0) return error.CorruptedStream;
+        const b0 = block[0];
+        const literals_type = b0 & 3;
+        const size_format = (b0 >> 2) & 3;
+
+        if (literals_type < 2) {
+            // Raw or RLE
+            var regenerated: usize = undefined;
+            var header_size: usize = undefined;
+            switch (size_format) {
+                0, 2 => {
+                    regenerated = b0 >> 3;
+                    header_size = 1;
+                },
+                1 => {
+                    if (block.len < 2) return error.CorruptedStream;
+                    regenerated = (b0 >> 4) + (@as(usize, block[1]) << 4);
+                    header_size = 2;
+                },
+                else => {
+                    if (block.len < 3) return error.CorruptedStream;
+                    regenerated = (b0 >> 4) + (@as(usize, block[1]) << 4) + (@as(usize, block[2]) << 12);
+                    header_size = 3;
+                },
+            }
+            if (regenerated > max_block_size) return error.CorruptedStream;
+
+            if (literals_type == 0) {
+                if (header_size + regenerated > block.len) return error.CorruptedStream;
+                p.* = header_size + regenerated;
+                return block[header_size..][0..regenerated];
+            }
+            if (header_size + 1 > block.len) return error.CorruptedStream;
+            @memset(self.literals[0..regenerated], block[header_size]);
+            p.* = header_size + 1;
+            return self.literals[0..regenerated];
+        }
+
+        // Huffman-compressed (2) or treeless, reusing the previous tree (3)
+        var header_size: usize = undefined;
+        var size_bits: u5 = undefined;
+        var streams: usize = 4;
+        switch (size_format) {
+            0, 1 => {
+                header_size = 3;
+                size_bits = 10;
+                if (size_format == 0) streams = 1;
+            },
+            2 => {
+                header_size = 4;
+                size_bits = 14;
+            },
+            else => {
+                header_size = 5;
+                size_bits = 18;
+            },
+        }
+        if (block.len < header_size) return error.CorruptedStream;
+        var header_value: u64 = 0;
+        for (0..header_size) |i| header_value |= @as(u64, block[i]) << @intCast(8 * i);
+        header_value >>= 4;
+        const regenerated: usize = @intCast(header_value & ((@as(u64, 1) << size_bits) - 1));
+        const compressed: usize = @intCast(header_value >> size_bits);
+        if (regenerated > max_block_size) return error.CorruptedStream;
+        if (header_size + compressed > block.len) return error.CorruptedStream;
+
+        var payload = block[header_size..][0..compressed];
+        if (literals_type == 2) {
+            const used = try self.huffman_table.read(payload);
+            payload = payload[used..];
+            self.has_huffman = true;
+        } else if (!self.has_huffman) {
+            return error.CorruptedStream;
+        }
+
+        const out = self.literals[0..regenerated];
+        if (streams == 1) {
+            try self.huffman_table.decodeStream(payload, out);
+        } else {
+            if (payload.len < 6) return error.CorruptedStream;
+            var sizes: [4]usize = undefined;
+            for (0..3) |i| sizes[i] = std.mem.readInt(u16, payload[2 * i ..][0..2], .little);
+            const streams_len = payload.len - 6;
+            if (sizes[0] + sizes[1] + sizes[2] >= streams_len) return error.CorruptedStream;
+            sizes[3] = streams_len - sizes[0] - sizes[1] - sizes[2];
+
+            const segment = (regenerated + 3) / 4;
+            if (3 * segment > regenerated) return error.CorruptedStream;
+            var src = payload[6..];
+            var dst = out;
+            for (sizes, 0..) |size, i| {
+                const n = if (i < 3) segment else dst.len;
+                try self.huffman_table.decodeStream(src[0..size], dst[0..n]);
+                src = src[size..];
+                dst = dst[n..];
+            }
+        }
+        p.* = header_size + compressed;
+        return out;
+    }
+
+    /// Set up one sequence decoding table according to its mode
+    fn readTable(self: *BlockDecoder, field: Field, mode: u8, block: []const u8, p: *usize) !void {
+        const index = @intFromEnum(field);
+        const table = &self.tables[index];
+        const max_symbol: usize = switch (field) {
+            .literal_length => max_literal_length_code,
+            .offset => max_offset_code,
+            .match_length => max_match_length_code,
+        };
+        const max_log: u4 = if (field == .offset) 8 else 9;
+
+        switch (mode) {
+            // Predefined distribution
+            0 => switch (field) {
+                .literal_length => try table.build(&fse.literal_length_default, 6),
+                .offset => try table.build(&fse.offset_default, 5),
+                .match_length => try table.build(&fse.match_length_default, 6),
+            },
+            // RLE: a single symbol
+            1 => {
+                if (p.* >= block.len) return error.CorruptedStream;
+                const symbol = block[p.*];
+                if (symbol > max_symbol) return error.CorruptedStream;
+                table.rle(symbol);
+                p.* += 1;
+            },
+            // FSE table description
+            2 => {
+                var dist: fse.Distribution = .{};
+                p.* += try fse.readDistribution(block[p.*..], max_symbol, max_log, &dist);
+                try table.build(dist.slice(), dist.accuracy_log);
+            },
+            // Repeat the previous block's table
+            else => if (!self.has_tables[index]) return error.CorruptedStream,
+        }
+        self.has_tables[index] = true;
+    }
+
+    /// Decode the sequences bitstream and execute each sequence
+    fn executeSequences(
+        self: *BlockDecoder,
+        data: []const u8,
+        count: usize,
+        literals: []const u8,
+        out: []u8,
+        pos: usize,
+        history: usize,
+        limit: usize,
+    ) !usize {
+        var reader = try bitstream.ReverseBitReader.init(data);
+        const ll_table = &self.tables[0];
+        const of_table = &self.tables[1];
+        const ml_table = &self.tables[2];
+
+        var ll_state: usize = @intCast(reader.readBits(ll_table.accuracy_log));
+        var of_state: usize = @intCast(reader.readBits(of_table.accuracy_log));
+        var ml_state: usize = @intCast(reader.readBits(ml_table.accuracy_log));
+
+        const end = pos + limit;
+        var op = pos;
+        var lit_pos: usize = 0;
+        for (0..count) |n| {
+            const ll_entry = ll_table.entries[ll_state];
+            const of_entry = of_table.entries[of_state];
+            const ml_entry = ml_table.entries[ml_state];
+            const of_code: u6 = @intCast(of_entry.symbol);
+
+            // Extra bits are read offset, match length, literal length
+            const offset_value = (@as(u64, 1) << of_code) + reader.readBits(of_code);
+            const match_length: usize = match_length_base[ml_entry.symbol] +
+                @as(usize, @intCast(reader.readBits(@intCast(match_length_bits[ml_entry.symbol]))));
+            const literal_length: usize = literal_length_base[ll_entry.symbol] +
+                @as(usize, @intCast(reader.readBits(@intCast(literal_length_bits[ll_entry.symbol]))));
+
+            const offset = try self.resolveOffset(offset_value, literal_length == 0);
+
+            if (n + 1 < count) {
+                ll_state = ll_entry.baseline + @as(usize, @intCast(reader.readBits(@intCast(ll_entry.bits))));
+                ml_state = ml_entry.baseline + @as(usize, @intCast(reader.readBits(@intCast(ml_entry.bits))));
+                of_state = of_entry.baseline + @as(usize, @intCast(reader.readBits(@intCast(of_entry.bits))));
+            }
+            if (reader.overflow) return error.CorruptedStream;
+
+            if (literal_length > literals.len - lit_pos or literal_length > end - op) {
+                return error.CorruptedStream;
+            }
+            @memcpy(out[op..][0..literal_length], literals[lit_pos..][0..literal_length]);
+            op += literal_length;
+            lit_pos += literal_length;
+
+            if (offset > history + (op - pos) or match_length > end - op) return error.CorruptedStream;
+            copyMatch(out, op, offset, match_length);
+            op += match_length;
+        }
+        if (!reader.finished()) return error.CorruptedStream;
+
+        const rest = literals.len - lit_pos;
+        if (rest > end - op) return error.CorruptedStream;
+        @memcpy(out[op..][0..rest], literals[lit_pos..]);
+        op += rest;
+        return op - pos;
+    }
+
+    /// Turn an offset value into a distance, updating the repeat offsets
+    inline fn resolveOffset(self: *BlockDecoder, offset_value: u64, no_literals: bool) !usize {
+        const reps = &self.reps;
+        if (offset_value > 3) {
+            const offset: u32 = @intCast(offset_value - 3);
+            reps[2] = reps[1];
+            reps[1] = reps[0];
+            reps[0] = offset;
+            return offset;
+        }
+
+        const index: usize = @intCast(offset_value - 1 + @intFromBool(no_literals));
+        switch (index) {
+            0 => return reps[0],
+            3 => {
+                const offset = reps[0] -% 1;
+                if (offset == 0) return error.CorruptedStream;
+                reps[2] = reps[1];
+                reps[1] = reps[0];
+                reps[0] = offset;
+                return offset;
+            },
+            else => {
+                const offset = reps[index];
+                if (index == 2) reps[2] = reps[1];
+                reps[1] = reps[0];
+                reps[0] = offset;
+                return offset;
+            },
+        }
+    }
+};
+
+/// Copy `length` bytes from `offset` back, allowing overlap (run-length style)
+inline fn copyMatch(out: []u8, op: usize, offset: usize, length: usize) void {
+    const src = op - offset;
+    if (offset >= length) {
+        @memcpy(out[op..][0..length], out[src..][0..length]);
+    } else if (offset == 1) {
+        @memset(out[op..][0..length], out[src]);
+    } else {
+        for (0..length) |i| out[op + i] = out[src + i];
+    }
+}
+
+// Tests
+
+test "FrameHeader: parses window and content size fields" {
+    // Single segment, 2-byte content size (value + 256), checksum
+    const single = [_]u8{ 0x28, 0xB5, 0x2F, 0xFD, 0x64, 0x10, 0x00 };
+    const header = (try FrameHeader.parse(&single)).?;
+    try std.testing.expectEqual(@as(?u64, 272), header.content_size);
+    try std.testing.expectEqual(@as(u64, 272), header.window_size);
+    try std.testing.expect(header.checksum and header.single_segment);
+    try std.testing.expectEqual(@as(usize, 7), header.size);
+
+    // Window descriptor 0x58: 1 << (10 + 11) = 2 MiB, no content size
+    const windowed = [_]u8{ 0x28, 0xB5, 0x2F, 0xFD, 0x04, 0x58 };
+    const streamed = (try FrameHeader.parse(&windowed)).?;
+    try std.testing.expectEqual(@as(?u64, null), streamed.content_size);
+    try std.testing.expectEqual(@as(u64, 2 << 20), streamed.window_size);
+
+    try std.testing.expectEqual(@as(?FrameHeader, null), try FrameHeader.parse(single[0..6]));
+    try std.testing.expectError(error.CorruptedStream, FrameHeader.parse(&[_]u8{ 0, 0, 0, 0, 0 }));
+}
+
+test "frameSize: walks blocks and skippable frames" {
+    // Frame of one raw block "abc" followed by a skippable frame
+    const data = [_]u8{
+        0x28, 0xB5, 0x2F, 0xFD, 0x20, 0x03, // single segment, content size 3
+        0x19, 0x00, 0x00, 'a', 'b', 'c', // last raw block of 3 bytes
+        0x50, 0x2A, 0x4D, 0x18, 0x02, 0x00, 0x00, 0x00, 0xAA, 0xBB,
+    };
+    try std.testing.expectEqual(@as(?usize, 12), try frameSize(&data));
+    try std.testing.expectEqual(@as(?usize, 10), try frameSize(data[12..]));
+    try std.testing.expectEqual(@as(?usize, null), try frameSize(data[0..11]));
+}
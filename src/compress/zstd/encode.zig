@@ -0,0 +1,582 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Zstandard frame encoding
+//!
+//! Produces single-segment frames (content size recorded, no separate
+//! window) made of 128 KiB blocks. Each block is matched with a hash table
+//! (`fast`) or hash chains with one step of lazy evaluation (`default`),
+//! then literals are Huffman-coded and sequences FSE-coded, choosing per
+//! block between predefined, RLE and block-specific tables. Blocks that do
+//! not shrink are stored raw. Dictionaries are not supported.
+
+const std = @import("std");
+const bitstream = @import("bitstream.zig");
+const fse = @import("fse.zig");
+const huffman = @import("huffman.zig");
+const decode = @import("decode.zig");
+
+/// Match finder effort
+pub const Level = enum {
+    /// Single hash probe per position, comparable to `zstd -1`
+    fast,
+    /// Hash chains (16 candidates) with lazy matching, comparable to `zstd -3`
+    default,
+};
+
+/// Shortest match the finder reports (it hashes 4 bytes)
+const min_match = 4;
+
+const hash_log = 17;
+const chain_log = 16;
+const chain_mask = (1 << chain_log) - 1;
+const chain_depth = 16;
+
+/// Literal blocks shorter than this are not worth a Huffman tree
+const min_huffman_literals = 64;
+
+const Sequence = struct {
+    literal_length: u32,
+    match_length: u32,
+    /// Offset + 3, or a repeat offset code 1..3
+    offset_base: u32,
+};
+
+const Match = struct {
+    length: usize = 0,
+    offset: usize = 0,
+};
+
+/// Literal length code for a length (ZSTD_LLcode)
+fn literalLengthCode(length: u32) u8 {
+    const table = comptime blk: {
+        var codes: [64]u8 = undefined;
+        var code: u8 = 0;
+        for (0..64) |value| {
+            while (code + 1 < decode.literal_length_base.len and decode.literal_length_base[code + 1] <= value) code += 1;
+            codes[value] = code;
+        }
+        break :blk codes;
+    };
+    if (length < 64) return table[length];
+    return @as(u8, std.math.log2_int(u32, length)) + 19;
+}
+
+/// Match length code for a length of at least 3 (ZSTD_MLcode)
+fn matchLengthCode(length: u32) u8 {
+    const table = comptime blk: {
+        var codes: [128]u8 = undefined;
+        var code: u8 = 0;
+        for (0..128) |value| {
+            while (code + 1 < decode.match_length_base.len and decode.match_length_base[code + 1] <= value + 3) code += 1;
+            codes[value] = code;
+        }
+        break :blk codes;
+    };
+    const base = length - 3;
+    if (base < 128) return table[base];
+    return @as(u8, std.math.log2_int(u32, base)) + 36;
+}
+
+inline fn read32(data: []const u8, pos: usize) u32 {
+    return std.mem.readInt(u32, data[pos..][0..4], .little);
+}
+
+inline fn hash4(data: []const u8, pos: usize) usize {
+    return (read32(data, pos) *% 2654435761) >> (32 - hash_log);
+}
+
+/// Length of the common prefix of data[a..] and data[b..] (a < b), up to `end`
+inline fn matchLength(data: []const u8, a: usize, b: usize, end: usize) usize {
+    var length: usize = 0;
+    while (b + length + 8 <= end) {
+        const x = std.mem.readInt(u64, data[a + length ..][0..8], .little) ^
+            std.mem.readInt(u64, data[b + length ..][0..8], .little);
+        if (x != 0) return length + @ctz(x) / 8;
+        length += 8;
+    }
+    while (b + length < end and data[a + length] == data[b + length]) length += 1;
+    return length;
+}
+
+/// Frame encoder; reusable across frames
+///
+/// Example:
+/// ```zig
+/// var encoder = try Encoder.init(allocator, .default);
+/// defer encoder.deinit();
+///
+/// var out = std.ArrayList(u8).init(allocator);
+/// try encoder.compressFrame(data, true, &out);
+/// ```
+pub const Encoder = struct {
+    allocator: std.mem.Allocator,
+    level: Level,
+
+    /// Most recent position + 1 per hash (0 = empty)
+    hash_table: []u32,
+    /// Previous position + 1 with the same hash, indexed by position (default level)
+    chain_table: []u32,
+    /// Next position to enter into the chains
+    next_to_index: usize = 0,
+
+    literals: std.ArrayList(u8),
+    sequences: std.ArrayList(Sequence),
+
+    /// Scratch tables, kept here rather than on the stack
+    huffman_encoder: huffman.Encoder = .{},
+    tables: [3]fse.EncodeTable = .{ .{}, .{}, .{} },
+
+    /// Initialize an encoder
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate match finder tables
+    pub fn init(allocator: std.mem.Allocator, level: Level) !Encoder {
+        const hash_table = try allocator.alloc(u32, 1 << hash_log);
+        errdefer allocator.free(hash_table);
+        const chain_len: usize = if (level == .default) 1 << chain_log else 0;
+        const chain_table = try allocator.alloc(u32, chain_len);
+        errdefer allocator.free(chain_table);
+
+        var literals = std.ArrayList(u8).init(allocator);
+        errdefer literals.deinit();
+        try literals.ensureTotalCapacity(decode.max_block_size);
+        var sequences = std.ArrayList(Sequence).init(allocator);
+        errdefer sequences.deinit();
+        try sequences.ensureTotalCapacity(decode.max_block_size / min_match + 1);
+
+        return .{
+            .allocator = allocator,
+            .level = level,
+            .hash_table = hash_table,
+            .chain_table = chain_table,
+            .literals = literals,
+            .sequences = sequences,
+        };
+    }
+
+    /// Release match finder tables and scratch buffers
+    pub fn deinit(self: *Encoder) void {
+        self.sequences.deinit();
+        self.literals.deinit();
+        self.allocator.free(self.chain_table);
+        self.allocator.free(self.hash_table);
+    }
+
+    /// Compress `input` as one frame, appending it to `out`
+    ///
+    /// Parameters:
+    ///   - input: Frame content (below 4 GiB: positions are 32-bit)
+    ///   - checksum: Append the XXH64-based content checksum
+    ///   - out: Receives the frame
+    pub fn compressFrame(self: *Encoder, input: []const u8, checksum: bool, out: *std.ArrayList(u8)) !void {
+        std.debug.assert(input.len < std.math.maxInt(u32));
+        @memset(self.hash_table, 0);
+        @memset(self.chain_table, 0);
+        self.next_to_index = 0;
+
+        // Frame header: single segment, smallest content size field
+        var header: [decode.max_frame_header_size]u8 = undefined;
+        std.mem.writeInt(u32, header[0..4], decode.magic_number, .little);
+        const n = input.len;
+        const fcs_size: usize = if (n < 256) 1 else if (n < 65536 + 256) 2 else 4;
+        const fcs_flag: u8 = if (fcs_size == 1) 0 else if (fcs_size == 2) 1 else 2;
+        header[4] = (fcs_flag << 6) | 0x20 | (if (checksum) @as(u8, 0x04) else 0);
+        const stored: u64 = if (fcs_size == 2) n - 256 else n;
+        for (0..fcs_size) |i| header[5 + i] = @truncate(stored >> @intCast(8 * i));
+        try out.appendSlice(header[0 .. 5 + fcs_size]);
+
+        var reps = [3]u32{ 1, 4, 8 };
+        var pos: usize = 0;
+        while (true) {
+            const end = @min(pos + decode.max_block_size, n);
+            const last = end == n;
+            const block = input[pos..end];
+
+            if (block.len > 1 and std.mem.allEqual(u8, block, block[0])) {
+                try appendBlockHeader(out, last, .rle, block.len);
+                try out.append(block[0]);
+            } else {
+                const saved = reps;
+                const header_pos = out.items.len;
+                try out.appendNTimes(0, decode.block_header_size);
+
+                try self.findSequences(input, pos, end, &reps);
+                try self.writeLiterals(self.literals.items, out);
+                try self.writeSequences(out);
+
+                const size = out.items.len - header_pos - decode.block_header_size;
+                if (size < block.len) {
+                    writeBlockHeader(out.items[header_pos..][0..3], last, .compressed, size);
+                } else {
+                    // The decoder sees no sequences in a raw block
+                    reps = saved;
+                    out.shrinkRetainingCapacity(header_pos);
+                    try appendBlockHeader(out, last, .raw, block.len);
+                    try out.appendSlice(block);
+                }
+            }
+            pos = end;
+            if (last) break;
+        }
+
+        if (checksum) {
+            var trailer: [4]u8 = undefined;
+            std.mem.writeInt(u32, &trailer, @truncate(std.hash.XxHash64.hash(0, input)), .little);
+            try out.appendSlice(&trailer);
+        }
+    }
+
+    /// Best match at `pos` among earlier positions with the same hash
+    fn findMatch(self: *Encoder, data: []const u8, pos: usize, end: usize) Match {
+        var best: Match = .{};
+        var candidate: usize = self.hash_table[hash4(data, pos)];
+        var depth: usize = if (self.level == .default) chain_depth else 1;
+        while (candidate != 0 and depth > 0) : (depth -= 1) {
+            const cand = candidate - 1;
+            if (read32(data, cand) == read32(data, pos)) {
+                const length = 4 + matchLength(data, cand + 4, pos + 4, end);
+                if (length > best.length) best = .{ .length = length, .offset = pos - cand };
+            }
+            if (self.level != .default) break;
+            const previous = self.chain_table[cand & chain_mask];
+            // Older chain slots have been reused by later positions
+            if (previous == 0 or pos - (previous - 1) > chain_mask) break;
+            candidate = previous;
+        }
+        return best;
+    }
+
+    /// Enter a position into the hash table (and chain)
+    inline fn insert(self: *Encoder, data: []const u8, pos: usize) void {
+        const h = hash4(data, pos);
+        if (self.level == .default) self.chain_table[pos & chain_mask] = self.hash_table[h];
+        self.hash_table[h] = @intCast(pos + 1);
+    }
+
+    /// Enter every position before `pos` not yet indexed (default level)
+    inline fn indexTo(self: *Encoder, data: []const u8, pos: usize) void {
+        while (self.next_to_index < pos) : (self.next_to_index += 1) self.insert(data, self.next_to_index);
+    }
+
+    /// Split data[start..end] into literals and sequences
+    fn findSequences(self: *Encoder, data: []const u8, start: usize, end: usize, reps: *[3]u32) !void {
+        self.literals.clearRetainingCapacity();
+        self.sequences.clearRetainingCapacity();
+
+        // Leave room for 4- and 8-byte reads near the end of the block
+        const limit = if (end - start > 8) end - 8 else start;
+        var anchor = start;
+        var pos = start;
+        if (self.next_to_index < start) self.next_to_index = start;
+
+        while (pos < limit) {
+            if (self.level == .default) self.indexTo(data, pos);
+            var best = self.findMatch(data, pos, end);
+
+            // Prefer continuing with the last offset when it is nearly as long
+            const rep: usize = reps[0];
+            if (pos >= rep) {
+                const length = matchLength(data, pos - rep, pos, end);
+                if (length >= min_match and length + 1 >= best.length) best = .{ .length = length, .offset = rep };
+            }
+
+            if (self.level == .default and best.length >= min_match and pos + 1 < limit) {
+                self.indexTo(data, pos + 1);
+                const next = self.findMatch(data, pos + 1, end);
+                if (next.length > best.length) {
+                    pos += 1;
+                    best = next;
+                }
+            }
+
+            if (best.length < min_match) {
+                if (self.level == .fast) {
+                    self.insert(data, pos);
+                    // Skip faster through data that does not match
+                    pos += 1 + ((pos - anchor) >> 6);
+                } else {
+                    pos += 1;
+                }
+                continue;
+            }
+
+            const literal_length = pos - anchor;
+            self.literals.appendSliceAssumeCapacity(data[anchor..pos]);
+            self.sequences.appendAssumeCapacity(.{
+                .literal_length = @intCast(literal_length),
+                .match_length = @intCast(best.length),
+                .offset_base = offsetBase(@intCast(best.offset), literal_length, reps),
+            });
+            if (self.level == .fast) {
+                self.insert(data, pos);
+                if (pos + best.length - 2 < limit) self.insert(data, pos + best.length - 2);
+            }
+            pos += best.length;
+            anchor = pos;
+        }
+        self.literals.appendSliceAssumeCapacity(data[anchor..end]);
+    }
+
+    /// Write the literals section
+    fn writeLiterals(self: *Encoder, literals: []const u8, out: *std.ArrayList(u8)) !void {
+        const n = literals.len;
+        if (n > 0 and std.mem.allEqual(u8, literals, literals[0])) {
+            try appendLiteralsHeader(out, 1, n);
+            try out.append(literals[0]);
+            return;
+        }
+        if (n < min_huffman_literals) return writeRawLiterals(literals, out);
+
+        var freq = [_]u32{0} ** 256;
+        for (literals) |b| freq[b] += 1;
+        const encoder = &self.huffman_encoder;
+        if (!encoder.build(&freq)) return writeRawLiterals(literals, out);
+
+        const start = out.items.len;
+        // Reserve the largest header; it is shrunk once sizes are known
+        try out.appendNTimes(0, 5);
+        if (!try encoder.writeTree(out)) {
+            out.shrinkRetainingCapacity(start);
+            return writeRawLiterals(literals, out);
+        }
+
+        var streams: usize = 1;
+        const tree_end = out.items.len;
+        if (n <= 1023) try encoder.writeStream(literals, out);
+        if (n > 1023 or out.items.len - start - 5 > 1023) {
+            // Four streams behind a jump table of the first three sizes
+            out.shrinkRetainingCapacity(tree_end);
+            streams = 4;
+            try out.appendNTimes(0, 6);
+            const segment = (n + 3) / 4;
+            for (0..4) |i| {
+                const stream_start = out.items.len;
+                const first = i * segment;
+                try encoder.writeStream(literals[first..@min(first + segment, n)], out);
+                if (i < 3) {
+                    const size = out.items.len - stream_start;
+                    if (size > std.math.maxInt(u16)) {
+                        out.shrinkRetainingCapacity(start);
+                        return writeRawLiterals(literals, out);
+                    }
+                    std.mem.writeInt(u16, out.items[tree_end + 2 * i ..][0..2], @intCast(size), .little);
+                }
+            }
+        }
+
+        // Size format: 0 = one stream; 1, 2, 3 = four streams with 10, 14, 18-bit sizes
+        const compressed = out.items.len - start - 5;
+        const largest = @max(n, compressed);
+        const size_format: u64 = if (streams == 1) 0 else if (largest <= 0x3ff) 1 else if (largest <= 0x3fff) 2 else 3;
+        const header_size: usize = if (size_format < 2) 3 else @intCast(size_format + 2);
+        const size_bits: u6 = if (size_format < 2) 10 else @intCast(4 * size_format + 6);
+        if (header_size + compressed >= n + 3) {
+            out.shrinkRetainingCapacity(start);
+            return writeRawLiterals(literals, out);
+        }
+
+        const value = ((@as(u64, n) | (@as(u64, compressed) << size_bits)) << 4) | (size_format << 2) | 2;
+        var header: [8]u8 = undefined;
+        std.mem.writeInt(u64, &header, value, .little);
+        const body = out.items[start + 5 ..];
+        std.mem.copyForwards(u8, out.items[start + header_size ..][0..body.len], body);
+        @memcpy(out.items[start..][0..header_size], header[0..header_size]);
+        out.shrinkRetainingCapacity(start + header_size + compressed);
+    }
+
+    /// Write the sequences section
+    fn writeSequences(self: *Encoder, out: *std.ArrayList(u8)) !void {
+        const sequences = self.sequences.items;
+        const n = sequences.len;
+        if (n < 128) {
+            try out.append(@intCast(n));
+        } else if (n < 0x7F00) {
+            try out.appendSlice(&.{ @intCast((n >> 8) + 128), @truncate(n) });
+        } else {
+            try out.appendSlice(&.{ 255, @truncate(n - 0x7F00), @intCast((n - 0x7F00) >> 8) });
+        }
+        if (n == 0) return;
+
+        var counts: [3][fse.max_symbols]u32 = .{[_]u32{0} ** fse.max_symbols} ** 3;
+        for (sequences) |seq| {
+            counts[0][literalLengthCode(seq.literal_length)] += 1;
+            counts[1][std.math.log2_int(u32, seq.offset_base)] += 1;
+            counts[2][matchLengthCode(seq.match_length)] += 1;
+        }
+
+        // Mode per field: predefined, RLE or a table for this block
+        const modes_pos = out.items.len;
+        try out.append(0);
+        var modes: u8 = 0;
+        var rle = [3]bool{ false, false, false };
+        const fields = [3]struct { max_symbol: usize, max_log: u4, default: []const i16, default_log: u4, shift: u3 }{
+            .{ .max_symbol = decode.max_literal_length_code, .max_log = 9, .default = &fse.literal_length_default, .default_log = 6, .shift = 6 },
+            .{ .max_symbol = decode.max_offset_code, .max_log = 8, .default = &fse.offset_default, .default_log = 5, .shift = 4 },
+            .{ .max_symbol = decode.max_match_length_code, .max_log = 9, .default = &fse.match_length_default, .default_log = 6, .shift = 2 },
+        };
+        for (fields, 0..) |field, k| {
+            const field_counts = counts[k][0 .. field.max_symbol + 1];
+            var present: usize = 0;
+            var max_symbol: usize = 0;
+            for (field_counts, 0..) |c, s| {
+                if (c == 0) continue;
+                present += 1;
+                max_symbol = s;
+            }
+            if (present == 1 and n > 2) {
+                modes |= @as(u8, 1) << field.shift;
+                rle[k] = true;
+                try out.append(@intCast(max_symbol));
+                continue;
+            }
+
+            const predefined = fse.cost(field_counts, field.default, field.default_log) orelse std.math.inf(f64);
+            const log = fse.optimalAccuracyLog(field.max_log, n, max_symbol);
+            var dist: fse.Distribution = .{};
+            fse.normalize(field_counts[0 .. max_symbol + 1], n, log, &dist);
+
+            const table_start = out.items.len;
+            var writer = bitstream.BitWriter{ .out = out };
+            try fse.writeDistribution(&dist, &writer);
+            const table_bits: f64 = @floatFromInt(8 * (out.items.len - table_start));
+            if (fse.cost(field_counts, dist.slice(), log).? + table_bits < predefined) {
+                modes |= @as(u8, 2) << field.shift;
+                try self.tables[k].build(dist.slice(), log);
+            } else {
+                out.shrinkRetainingCapacity(table_start);
+                try self.tables[k].build(field.default, field.default_log);
+            }
+        }
+        out.items[modes_pos] = modes;
+
+        // Sequences are coded last to first so the decoder reads them in order
+        var writer = bitstream.BitWriter{ .out = out };
+        var states: [3]u32 = .{ 0, 0, 0 };
+        var codes = sequenceCodes(sequences[n - 1]);
+        for ([_]usize{ 2, 1, 0 }) |k| {
+            if (!rle[k]) states[k] = self.tables[k].initState(codes[k]);
+        }
+        try writeExtraBits(&writer, sequences[n - 1], codes);
+
+        var i = n - 1;
+        while (i > 0) {
+            i -= 1;
+            codes = sequenceCodes(sequences[i]);
+            for ([_]usize{ 1, 2, 0 }) |k| {
+                if (!rle[k]) try self.tables[k].encode(&writer, &states[k], codes[k]);
+            }
+            try writeExtraBits(&writer, sequences[i], codes);
+        }
+        for ([_]usize{ 2, 1, 0 }) |k| {
+            if (!rle[k]) try self.tables[k].flush(&writer, states[k]);
+        }
+        try writer.close();
+    }
+};
+
+/// Literal length, offset and match length codes of a sequence
+inline fn sequenceCodes(seq: Sequence) [3]u8 {
+    return .{
+        literalLengthCode(seq.literal_length),
+        std.math.log2_int(u32, seq.offset_base),
+        matchLengthCode(seq.match_length),
+    };
+}
+
+/// Extra bits in the order the decoder reads them backwards: LL, ML, OF
+inline fn writeExtraBits(writer: *bitstream.BitWriter, seq: Sequence, codes: [3]u8) !void {
+    try writer.add(seq.literal_length - decode.literal_length_base[codes[0]], @intCast(decode.literal_length_bits[codes[0]]));
+    try writer.add(seq.match_length - decode.match_length_base[codes[2]], @intCast(decode.match_length_bits[codes[2]]));
+    try writer.add(seq.offset_base, @intCast(codes[1]));
+}
+
+/// Offset field for a match, updating repeat offsets the way the decoder will
+fn offsetBase(offset: u32, literal_length: usize, reps: *[3]u32) u32 {
+    const candidates = if (literal_length > 0)
+        [3]u32{ reps[0], reps[1], reps[2] }
+    else
+        [3]u32{ reps[1], reps[2], reps[0] -% 1 };
+
+    for (candidates, 0..) |candidate, k| {
+        if (offset != candidate) continue;
+        const index = k + @intFromBool(literal_length == 0);
+        if (index != 0) {
+            if (index >= 2) reps[2] = reps[1];
+            reps[1] = reps[0];
+            reps[0] = offset;
+        }
+        return @intCast(k + 1);
+    }
+    reps[2] = reps[1];
+    reps[1] = reps[0];
+    reps[0] = offset;
+    return offset + 3;
+}
+
+fn appendBlockHeader(out: *std.ArrayList(u8), last: bool, block_type: decode.BlockType, size: usize) !void {
+    var header: [3]u8 = undefined;
+    writeBlockHeader(&header, last, block_type, size);
+    try out.appendSlice(&header);
+}
+
+fn writeBlockHeader(header: *[3]u8, last: bool, block_type: decode.BlockType, size: usize) void {
+    const value: u24 = @intCast((size << 3) | (@as(usize, @intFromEnum(block_type)) << 1) | @intFromBool(last));
+    std.mem.writeInt(u24, header, value, .little);
+}
+
+/// Raw (type 0) or RLE (type 1) literals header
+fn appendLiteralsHeader(out: *std.ArrayList(u8), literals_type: u8, n: usize) !void {
+    if (n < 32) {
+        try out.append(@intCast((n << 3) | literals_type));
+    } else if (n < 4096) {
+        try out.appendSlice(&.{ @truncate((n << 4) | 0x4 | literals_type), @intCast(n >> 4) });
+    } else {
+        try out.appendSlice(&.{ @truncate((n << 4) | 0xc | literals_type), @truncate(n >> 4), @intCast(n >> 12) });
+    }
+}
+
+fn writeRawLiterals(literals: []const u8, out: *std.ArrayList(u8)) !void {
+    try appendLiteralsHeader(out, 0, literals.len);
+    try out.appendSlice(literals);
+}
+
+// Tests
+
+test "literalLengthCode and matchLengthCode: pick the largest baseline" {
+    for ([_]u32{ 0, 15, 16, 17, 63, 64, 65, 100, 4095, 65536, 131071 }) |length| {
+        const code = literalLengthCode(length);
+        try std.testing.expect(decode.literal_length_base[code] <= length);
+        try std.testing.expect(length - decode.literal_length_base[code] < @as(u32, 1) << @intCast(decode.literal_length_bits[code]));
+    }
+    for ([_]u32{ 3, 34, 35, 36, 130, 131, 132, 1000, 65539, 131074 }) |length| {
+        const code = matchLengthCode(length);
+        try std.testing.expect(decode.match_length_base[code] <= length);
+        try std.testing.expect(length - decode.match_length_base[code] < @as(u32, 1) << @intCast(decode.match_length_bits[code]));
+    }
+}
+
+test "offsetBase: repeat codes follow the decoder's rules" {
+    var reps = [3]u32{ 1, 4, 8 };
+    try std.testing.expectEqual(@as(u32, 1), offsetBase(1, 5, &reps));
+    try std.testing.expectEqual(@as(u32, 103), offsetBase(100, 5, &reps));
+    try std.testing.expectEqualSlices(u32, &.{ 100, 1, 4 }, &reps);
+    // With no literals, code 3 means the first repeat offset minus one ...
+    try std.testing.expectEqual(@as(u32, 3), offsetBase(99, 0, &reps));
+    try std.testing.expectEqualSlices(u32, &.{ 99, 100, 1 }, &reps);
+    // ... and code 1 the second repeat offset
+    try std.testing.expectEqual(@as(u32, 1), offsetBase(100, 0, &reps));
+    try std.testing.expectEqualSlices(u32, &.{ 100, 99, 1 }, &reps);
+}
@@ -0,0 +1,468 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Finite State Entropy tables (RFC 8878 section 4.1.1)
+//!
+//! A distribution is a list of normalized probabilities summing to
+//! `1 << accuracy_log`, where -1 marks a "less than one" symbol. Decoding
+//! and encoding tables are both derived from it by the same symbol
+//! spreading, so an encoder and decoder built from one distribution agree.
+
+const std = @import("std");
+const bitstream = @import("bitstream.zig");
+
+/// Largest accuracy log used by any Zstandard table
+pub const max_accuracy_log = 9;
+
+/// Largest alphabet of any FSE-coded Zstandard field (match length codes)
+pub const max_symbols = 64;
+
+/// Predefined literal length distribution (accuracy log 6)
+pub const literal_length_default = [_]i16{
+    4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+    -1, -1, -1, -1,
+};
+
+/// Predefined match length distribution (accuracy log 6)
+pub const match_length_default = [_]i16{
+    1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/// Predefined offset code distribution (accuracy log 5)
+pub const offset_default = [_]i16{
+    1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+};
+
+inline fn highBit(value: u32) u5 {
+    return @intCast(31 - @clz(value));
+}
+
+/// A normalized distribution read from or written to a table description
+pub const Distribution = struct {
+    probs: [max_symbols]i16 = undefined,
+    len: usize = 0,
+    accuracy_log: u4 = 0,
+
+    pub fn slice(self: *const Distribution) []const i16 {
+        return self.probs[0..self.len];
+    }
+};
+
+/// Spread symbols over the table positions (shared by both table kinds)
+///
+/// Returns:
+///   - Index of the first "less than one" slot; those occupy the top of the table
+fn spreadSymbols(probs: []const i16, accuracy_log: u4, symbols: *[1 << max_accuracy_log]u8) !usize {
+    const size = @as(usize, 1) << accuracy_log;
+    if (probs.len > max_symbols) return error.CorruptedStream;
+
+    var total: usize = 0;
+    for (probs) |p| {
+        if (p < -1) return error.CorruptedStream;
+        total += if (p == -1) 1 else @as(usize, @intCast(p));
+    }
+    if (total != size) return error.CorruptedStream;
+
+    var high = size;
+    for (probs, 0..) |p, s| {
+        if (p == -1) {
+            high -= 1;
+            symbols[high] = @intCast(s);
+        }
+    }
+
+    const step = (size >> 1) + (size >> 3) + 3;
+    const table_mask = size - 1;
+    var position: usize = 0;
+    for (probs, 0..) |p, s| {
+        if (p <= 0) continue;
+        for (0..@intCast(p)) |_| {
+            symbols[position] = @intCast(s);
+            position = (position + step) & table_mask;
+            while (position >= high) position = (position + step) & table_mask;
+        }
+    }
+    if (position != 0) return error.CorruptedStream;
+    return high;
+}
+
+/// One decoding table cell
+pub const DecodeEntry = struct {
+    symbol: u8,
+    bits: u8,
+    baseline: u16,
+};
+
+/// FSE decoding table
+pub const DecodeTable = struct {
+    entries: [1 << max_accuracy_log]DecodeEntry = undefined,
+    accuracy_log: u4 = 0,
+
+    /// Build from a normalized distribution
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Probabilities do not sum to the table size
+    pub fn build(self: *DecodeTable, probs: []const i16, accuracy_log: u4) !void {
+        std.debug.assert(accuracy_log <= max_accuracy_log);
+        var symbols: [1 << max_accuracy_log]u8 = undefined;
+        _ = try spreadSymbols(probs, accuracy_log, &symbols);
+
+        var next: [max_symbols]u32 = undefined;
+        for (probs, 0..) |p, s| next[s] = if (p == -1) 1 else @intCast(p);
+
+        const size = @as(u32, 1) << accuracy_log;
+        for (self.entries[0..size], symbols[0..size]) |*entry, s| {
+            const state = next[s];
+            next[s] += 1;
+            const bits = accuracy_log - highBit(state);
+            entry.* = .{
+                .symbol = s,
+                .bits = bits,
+                .baseline = @intCast((state << @intCast(bits)) - size),
+            };
+        }
+        self.accuracy_log = accuracy_log;
+    }
+
+    /// Single-symbol table for RLE mode (no state bits)
+    pub fn rle(self: *DecodeTable, symbol: u8) void {
+        self.entries[0] = .{ .symbol = symbol, .bits = 0, .baseline = 0 };
+        self.accuracy_log = 0;
+    }
+};
+
+/// Read a table description (FSE_readNCount)
+///
+/// Parameters:
+///   - data: Bytes starting at the description
+///   - max_symbol: Largest symbol the field allows
+///   - max_log: Largest accuracy log the field allows
+///   - dist: Receives the distribution
+///
+/// Returns:
+///   - Bytes consumed
+///
+/// Errors:
+///   - error.CorruptedStream: Malformed or truncated description
+pub fn readDistribution(data: []const u8, max_symbol: usize, max_log: u4, dist: *Distribution) !usize {
+    std.debug.assert(max_symbol < max_symbols);
+    var reader = bitstream.ForwardBitReader{ .data = data };
+
+    const accuracy_log = try reader.read(4) + 5;
+    if (accuracy_log > max_log) return error.CorruptedStream;
+
+    var remaining: i32 = (@as(i32, 1) << @intCast(accuracy_log)) + 1;
+    var threshold: i32 = @as(i32, 1) << @intCast(accuracy_log);
+    var nbits: u6 = @intCast(accuracy_log + 1);
+    var symbol: usize = 0;
+
+    while (remaining > 1 and symbol <= max_symbol) {
+        const max: i32 = (2 * threshold - 1) - remaining;
+        var value: i32 = @intCast(reader.peek(nbits - 1));
+        if (value < max) {
+            _ = try reader.read(nbits - 1);
+        } else {
+            value = @intCast(reader.peek(nbits));
+            if (value >= threshold) value -= max;
+            _ = try reader.read(nbits);
+        }
+
+        const count = value - 1;
+        remaining -= @intCast(@abs(count));
+        dist.probs[symbol] = @intCast(count);
+        symbol += 1;
+
+        if (count == 0) {
+            // Runs of zero probabilities, two bits at a time
+            while (true) {
+                const run = try reader.read(2);
+                for (0..run) |_| {
+                    if (symbol > max_symbol) return error.CorruptedStream;
+                    dist.probs[symbol] = 0;
+                    symbol += 1;
+                }
+                if (run != 3) break;
+            }
+        }
+
+        while (remaining < threshold) {
+            nbits -= 1;
+            threshold >>= 1;
+        }
+    }
+    if (remaining != 1) return error.CorruptedStream;
+
+    dist.len = symbol;
+    dist.accuracy_log = @intCast(accuracy_log);
+    return reader.bytesConsumed();
+}
+
+/// FSE encoding table (FSE_buildCTable)
+pub const EncodeTable = struct {
+    accuracy_log: u4 = 0,
+    states: [1 << max_accuracy_log]u16 = undefined,
+    delta_bits: [max_symbols]u32 = undefined,
+    delta_state: [max_symbols]i32 = undefined,
+
+    /// Build from a normalized distribution
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Probabilities do not sum to the table size
+    pub fn build(self: *EncodeTable, probs: []const i16, accuracy_log: u4) !void {
+        var symbols: [1 << max_accuracy_log]u8 = undefined;
+        _ = try spreadSymbols(probs, accuracy_log, &symbols);
+
+        const size = @as(u32, 1) << accuracy_log;
+        var cumul: [max_symbols]u32 = undefined;
+        var total: u32 = 0;
+        for (probs, 0..) |p, s| {
+            cumul[s] = total;
+            total += if (p == -1) 1 else @intCast(p);
+        }
+        for (symbols[0..size], 0..) |s, u| {
+            self.states[cumul[s]] = @intCast(size + u);
+            cumul[s] += 1;
+        }
+
+        const log: u32 = accuracy_log;
+        total = 0;
+        for (probs, 0..) |p, s| {
+            switch (p) {
+                0 => {
+                    self.delta_bits[s] = ((log + 1) << 16) - size;
+                    self.delta_state[s] = 0;
+                },
+                -1, 1 => {
+                    self.delta_bits[s] = (log << 16) - size;
+                    self.delta_state[s] = @as(i32, @intCast(total)) - 1;
+                    total += 1;
+                },
+                else => {
+                    const count: u32 = @intCast(p);
+                    const max_bits_out = log - highBit(count - 1);
+                    const min_state_plus = count << @intCast(max_bits_out);
+                    self.delta_bits[s] = (max_bits_out << 16) - min_state_plus;
+                    self.delta_state[s] = @as(i32, @intCast(total)) - @as(i32, @intCast(count));
+                    total += count;
+                },
+            }
+        }
+        self.accuracy_log = accuracy_log;
+    }
+
+    inline fn next(self: *const EncodeTable, value: u32, symbol: u8) u32 {
+        const index = @as(i32, @intCast(value)) + self.delta_state[symbol];
+        return self.states[@intCast(index)];
+    }
+
+    /// Initial state for the first symbol encoded (the last one decoded)
+    pub fn initState(self: *const EncodeTable, symbol: u8) u32 {
+        const nb = (self.delta_bits[symbol] + (1 << 15)) >> 16;
+        const value = (nb << 16) - self.delta_bits[symbol];
+        return self.next(value >> @intCast(nb), symbol);
+    }
+
+    /// Encode `symbol`, writing the bits of the current state
+    pub inline fn encode(self: *const EncodeTable, writer: *bitstream.BitWriter, state: *u32, symbol: u8) !void {
+        const nb = (state.* + self.delta_bits[symbol]) >> 16;
+        try writer.add(state.*, @intCast(nb));
+        state.* = self.next(state.* >> @intCast(nb), symbol);
+    }
+
+    /// Write the final state for the decoder to start from
+    pub fn flush(self: *const EncodeTable, writer: *bitstream.BitWriter, state: u32) !void {
+        try writer.add(state, self.accuracy_log);
+    }
+};
+
+/// Accuracy log for `total` samples of symbols up to `max_symbol` (FSE_optimalTableLog)
+pub fn optimalAccuracyLog(max_log: u4, total: usize, max_symbol: usize) u4 {
+    var log: i32 = max_log;
+    if (total > 1) {
+        const src_bits = @as(i32, std.math.log2_int(usize, total - 1)) - 2;
+        if (src_bits < log) log = src_bits;
+    } else {
+        log = 0;
+    }
+    const min_bits: i32 = if (max_symbol > 0) @min(
+        @as(i32, std.math.log2_int(usize, total)) + 1,
+        @as(i32, std.math.log2_int(usize, max_symbol)) + 2,
+    ) else 1;
+    if (min_bits > log) log = min_bits;
+    return @intCast(std.math.clamp(log, 5, max_log));
+}
+
+/// Scale symbol counts to a distribution of `1 << accuracy_log`
+///
+/// Every symbol present gets a probability of at least one; rounding error
+/// is absorbed by the most probable symbols.
+pub fn normalize(counts: []const u32, total: usize, accuracy_log: u4, dist: *Distribution) void {
+    std.debug.assert(counts.len <= max_symbols and total > 0);
+    const size = @as(u64, 1) << accuracy_log;
+
+    var sum: u64 = 0;
+    var largest: usize = 0;
+    for (counts, 0..) |c, s| {
+        if (c == 0) {
+            dist.probs[s] = 0;
+            continue;
+        }
+        const p = @max(1, (@as(u64, c) * size + total / 2) / total);
+        dist.probs[s] = @intCast(p);
+        sum += p;
+        if (c > counts[largest]) largest = s;
+    }
+
+    while (sum != size) {
+        if (sum < size) {
+            dist.probs[largest] += @intCast(size - sum);
+            sum = size;
+        } else {
+            const best = std.mem.indexOfMax(i16, dist.probs[0..counts.len]);
+            const cut = @min(sum - size, @as(u64, @intCast(dist.probs[best] - 1)));
+            dist.probs[best] -= @intCast(cut);
+            sum -= cut;
+        }
+    }
+    dist.len = counts.len;
+    dist.accuracy_log = accuracy_log;
+}
+
+/// Write a table description (FSE_writeNCount)
+pub fn writeDistribution(dist: *const Distribution, writer: *bitstream.BitWriter) !void {
+    const probs = dist.slice();
+    const log: u6 = dist.accuracy_log;
+    try writer.add(log - 5, 4);
+
+    var remaining: i32 = (@as(i32, 1) << @intCast(log)) + 1;
+    var threshold: i32 = @as(i32, 1) << @intCast(log);
+    var nbits: u6 = log + 1;
+
+    var last: usize = 0;
+    for (probs, 0..) |p, s| {
+        if (p != 0) last = s;
+    }
+
+    var symbol: usize = 0;
+    var previous_zero = false;
+    while (symbol <= last and remaining > 1) {
+        if (previous_zero) {
+            var start = symbol;
+            while (probs[symbol] == 0) symbol += 1;
+            while (symbol >= start + 3) {
+                try writer.add(3, 2);
+                start += 3;
+            }
+            try writer.add(symbol - start, 2);
+        }
+
+        var count: i32 = probs[symbol];
+        symbol += 1;
+        const max = (2 * threshold - 1) - remaining;
+        remaining -= @intCast(@abs(count));
+        count += 1;
+        if (count >= threshold) count += max;
+        try writer.add(@intCast(count), if (count < max) nbits - 1 else nbits);
+        previous_zero = count == 1;
+
+        while (remaining < threshold) {
+            nbits -= 1;
+            threshold >>= 1;
+        }
+    }
+    std.debug.assert(remaining == 1);
+    try writer.flush();
+}
+
+/// Estimated bits to code `counts` with a distribution (null if a symbol is missing)
+pub fn cost(counts: []const u32, probs: []const i16, accuracy_log: u4) ?f64 {
+    var bits: f64 = 0;
+    for (counts, 0..) |c, s| {
+        if (c == 0) continue;
+        if (s >= probs.len or probs[s] == 0) return null;
+        const p: f64 = if (probs[s] == -1) 1 else @floatFromInt(probs[s]);
+        bits += @as(f64, @floatFromInt(c)) * (@as(f64, @floatFromInt(accuracy_log)) - std.math.log2(p));
+    }
+    return bits;
+}
+
+// Tests
+
+test "DecodeTable: predefined distributions build" {
+    var table: DecodeTable = .{};
+    try table.build(&literal_length_default, 6);
+    try table.build(&match_length_default, 6);
+    try table.build(&offset_default, 5);
+    // RFC 8878 Appendix A: offset code state 0 is symbol 0 with 5 bits
+    try std.testing.expectEqual(DecodeEntry{ .symbol = 0, .bits = 5, .baseline = 0 }, table.entries[0]);
+}
+
+test "writeDistribution: round trips through readDistribution" {
+    const allocator = std.testing.allocator;
+
+    const counts = [_]u32{ 90, 0, 0, 0, 0, 3, 1, 40, 0, 17, 1, 0, 250 };
+    var dist: Distribution = .{};
+    normalize(&counts, 402, 7, &dist);
+
+    var out = std.ArrayList(u8).init(allocator);
+    defer out.deinit();
+    var writer = bitstream.BitWriter{ .out = &out };
+    try writeDistribution(&dist, &writer);
+
+    var read_back: Distribution = .{};
+    const used = try readDistribution(out.items, 12, 9, &read_back);
+    try std.testing.expectEqual(out.items.len, used);
+    try std.testing.expectEqual(dist.accuracy_log, read_back.accuracy_log);
+    try std.testing.expectEqualSlices(i16, dist.slice(), read_back.slice());
+}
+
+test "EncodeTable: symbols decode back in reverse order" {
+    const allocator = std.testing.allocator;
+
+    const message = [_]u8{ 0, 7, 7, 1, 9, 0, 0, 3, 7, 12, 5, 0, 7, 7, 7, 1 };
+    var counts = [_]u32{0} ** 13;
+    for (message) |s| counts[s] += 1;
+    var dist: Distribution = .{};
+    normalize(&counts, message.len, 5, &dist);
+
+    var encoder: EncodeTable = .{};
+    try encoder.build(dist.slice(), 5);
+    var decoder: DecodeTable = .{};
+    try decoder.build(dist.slice(), 5);
+
+    var out = std.ArrayList(u8).init(allocator);
+    defer out.deinit();
+    var writer = bitstream.BitWriter{ .out = &out };
+    var state = encoder.initState(message[message.len - 1]);
+    var i = message.len - 1;
+    while (i > 0) {
+        i -= 1;
+        try encoder.encode(&writer, &state, message[i]);
+    }
+    try encoder.flush(&writer, state);
+    try writer.close();
+
+    var reader = try bitstream.ReverseBitReader.init(out.items);
+    var decode_state: usize = @intCast(reader.readBits(5));
+    for (message, 0..) |expected, n| {
+        const entry = decoder.entries[decode_state];
+        try std.testing.expectEqual(expected, entry.symbol);
+        if (n + 1 < message.len) {
+            decode_state = entry.baseline + @as(usize, @intCast(reader.readBits(@intCast(entry.bits))));
+        }
+    }
+    try std.testing.expect(reader.finished());
+}
@@ -0,0 +1,422 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Zstandard Huffman coding for literals (RFC 8878 section 4.2)
+//!
+//! Trees are described by per-symbol weights (weight = max_bits + 1 -
+//! code length, 0 = absent); the last symbol's weight is implied by the
+//! others. Codes are canonical: ordered by weight, then by symbol.
+
+const std = @import("std");
+const bitstream = @import("bitstream.zig");
+const fse = @import("fse.zig");
+
+/// Longest Huffman code Zstandard allows
+pub const max_bits = 11;
+
+/// Weights decoded or written per tree (symbols 0..255)
+const max_weights = 256;
+
+inline fn highBit(value: u32) u5 {
+    return @intCast(31 - @clz(value));
+}
+
+/// One decoding table cell
+pub const DecodeEntry = struct {
+    symbol: u8,
+    bits: u8,
+};
+
+/// Huffman decoding table indexed by the next `max_bits` stream bits
+pub const DecodeTable = struct {
+    entries: [1 << max_bits]DecodeEntry = undefined,
+    max_bits: u4 = 0,
+
+    /// Read a tree description and build the table
+    ///
+    /// Returns:
+    ///   - Bytes consumed
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Malformed description or incomplete tree
+    pub fn read(self: *DecodeTable, data: []const u8) !usize {
+        var weights: [max_weights]u8 = undefined;
+        var count: usize = 0;
+        const consumed = try readWeights(data, &weights, &count);
+
+        var total: u32 = 0;
+        for (weights[0..count]) |w| {
+            if (w > max_bits) return error.CorruptedStream;
+            if (w > 0) total += @as(u32, 1) << @intCast(w - 1);
+        }
+        if (total == 0) return error.CorruptedStream;
+
+        const table_bits = @as(u32, highBit(total)) + 1;
+        if (table_bits > max_bits) return error.CorruptedStream;
+        const rest = (@as(u32, 1) << @intCast(table_bits)) - total;
+        if (!std.math.isPowerOfTwo(rest)) return error.CorruptedStream;
+        weights[count] = @as(u8, highBit(rest)) + 1;
+        count += 1;
+
+        // Symbols of each weight take consecutive runs of 2^(weight-1) cells
+        var rank_start: [max_bits + 2]u32 = undefined;
+        var rank_count = [_]u32{0} ** (max_bits + 2);
+        for (weights[0..count]) |w| rank_count[w] += 1;
+        var position: u32 = 0;
+        for (1..table_bits + 1) |w| {
+            rank_start[w] = position;
+            position += rank_count[w] << @intCast(w - 1);
+        }
+        if (position != @as(u32, 1) << @intCast(table_bits)) return error.CorruptedStream;
+
+        for (weights[0..count], 0..) |w, s| {
+            if (w == 0) continue;
+            const len = @as(u32, 1) << @intCast(w - 1);
+            const start = rank_start[w];
+            @memset(self.entries[start..][0..len], .{
+                .symbol = @intCast(s),
+                .bits = @intCast(table_bits + 1 - w),
+            });
+            rank_start[w] += len;
+        }
+        self.max_bits = @intCast(table_bits);
+        return consumed;
+    }
+
+    /// Decode exactly `out.len` symbols from one stream
+    ///
+    /// Errors:
+    ///   - error.CorruptedStream: Stream is not consumed exactly
+    pub fn decodeStream(self: *const DecodeTable, data: []const u8, out: []u8) !void {
+        var reader = try bitstream.ReverseBitReader.init(data);
+        for (out) |*byte| {
+            const entry = self.entries[@intCast(reader.peek(self.max_bits))];
+            reader.consume(@intCast(entry.bits));
+            byte.* = entry.symbol;
+        }
+        if (!reader.finished()) return error.CorruptedStream;
+    }
+};
+
+/// Read the explicit weights of a tree description (all but the last symbol)
+fn readWeights(data: []const u8, weights: *[max_weights]u8, count: *usize) !usize {
+    if (data.len == 0) return error.CorruptedStream;
+    const header = data[0];
+
+    if (header >= 128) {
+        // Direct representation: 4 bits per weight, high nibble first
+        const n: usize = header - 127;
+        const bytes = (n + 1) / 2;
+        if (1 + bytes > data.len) return error.CorruptedStream;
+        for (0..n) |i| {
+            const b = data[1 + i / 2];
+            weights[i] = if (i % 2 == 0) b >> 4 else b & 0x0f;
+        }
+        count.* = n;
+        return 1 + bytes;
+    }
+
+    // FSE-compressed weights decoded by two interleaved states
+    const size: usize = header;
+    if (1 + size > data.len) return error.CorruptedStream;
+    const src = data[1..][0..size];
+
+    var dist: fse.Distribution = .{};
+    const used = try fse.readDistribution(src, max_bits + 1, 6, &dist);
+    var table: fse.DecodeTable = .{};
+    try table.build(dist.slice(), dist.accuracy_log);
+
+    var reader = try bitstream.ReverseBitReader.init(src[used..]);
+    var states = [2]usize{
+        @intCast(reader.readBits(dist.accuracy_log)),
+        @intCast(reader.readBits(dist.accuracy_log)),
+    };
+    var n: usize = 0;
+    var current: usize = 0;
+    while (true) {
+        if (n >= max_weights - 1) return error.CorruptedStream;
+        const entry = table.entries[states[current]];
+        weights[n] = entry.symbol;
+        n += 1;
+
+        const bits = reader.readBits(@intCast(entry.bits));
+        if (reader.overflow) {
+            // The other state still holds one final symbol
+            if (n >= max_weights - 1) return error.CorruptedStream;
+            weights[n] = table.entries[states[current ^ 1]].symbol;
+            n += 1;
+            break;
+        }
+        states[current] = entry.baseline + @as(usize, @intCast(bits));
+        current ^= 1;
+    }
+    count.* = n;
+    return 1 + size;
+}
+
+/// Canonical Huffman code built from literal frequencies
+pub const Encoder = struct {
+    lengths: [256]u8 = [_]u8{0} ** 256,
+    codes: [256]u16 = [_]u16{0} ** 256,
+    max_bits: u4 = 0,
+
+    /// Largest symbol present
+    last_symbol: u8 = 0,
+
+    /// Build length-limited codes for `freq`
+    ///
+    /// Returns:
+    ///   - false when fewer than two symbols are present
+    pub fn build(self: *Encoder, freq: *const [256]u32) bool {
+        var symbols: [256]u8 = undefined;
+        var n: usize = 0;
+        for (freq, 0..) |f, s| {
+            if (f == 0) continue;
+            symbols[n] = @intCast(s);
+            n += 1;
+        }
+        if (n < 2) return false;
+        self.last_symbol = symbols[n - 1];
+
+        // Two-queue Huffman construction over leaves sorted by frequency
+        const ByFrequency = struct {
+            fn lessThan(f: *const [256]u32, a: u8, b: u8) bool {
+                return f[a] < f[b] or (f[a] == f[b] and a < b);
+            }
+        };
+        std.mem.sort(u8, symbols[0..n], freq, ByFrequency.lessThan);
+
+        var weight: [511]u64 = undefined;
+        var parent: [511]u16 = undefined;
+        for (symbols[0..n], 0..) |s, i| weight[i] = freq[s];
+        var leaf: usize = 0;
+        var node: usize = n;
+        var next: usize = n;
+        while (next < 2 * n - 1) : (next += 1) {
+            var children: [2]usize = undefined;
+            for (&children) |*child| {
+                if (leaf < n and (node >= next or weight[leaf] <= weight[node])) {
+                    child.* = leaf;
+                    leaf += 1;
+                } else {
+                    child.* = node;
+                    node += 1;
+                }
+            }
+            weight[next] = weight[children[0]] + weight[children[1]];
+            parent[children[0]] = @intCast(next);
+            parent[children[1]] = @intCast(next);
+        }
+
+        // Depths from the root down (parents always have larger indexes)
+        var depth: [511]u8 = undefined;
+        const root = 2 * n - 2;
+        depth[root] = 0;
+        var count = [_]u32{0} ** 256;
+        var i = root;
+        while (i > 0) {
+            i -= 1;
+            depth[i] = depth[parent[i]] + 1;
+            if (i < n) count[depth[i]] += 1;
+        }
+
+        var longest: usize = 0;
+        for (count, 0..) |c, len| {
+            if (c > 0) longest = len;
+        }
+        if (longest > max_bits) {
+            // Fold overlong codes into max_bits, then restore the Kraft sum
+            for (max_bits + 1..longest + 1) |len| {
+                count[max_bits] += count[len];
+                count[len] = 0;
+            }
+            var kraft: u32 = 0;
+            for (1..max_bits + 1) |len| kraft += count[len] << @intCast(max_bits - len);
+            while (kraft > 1 << max_bits) : (kraft -= 1) {
+                count[max_bits] -= 1;
+                var len: usize = max_bits - 1;
+                while (len > 0) : (len -= 1) {
+                    if (count[len] != 0) {
+                        count[len] -= 1;
+                        count[len + 1] += 2;
+                        break;
+                    }
+                }
+            }
+            longest = max_bits;
+        }
+
+        // Most frequent symbols get the shortest codes
+        @memset(&self.lengths, 0);
+        var k = n;
+        for (1..longest + 1) |len| {
+            for (0..count[len]) |_| {
+                k -= 1;
+                self.lengths[symbols[k]] = @intCast(len);
+            }
+        }
+        self.max_bits = @intCast(longest);
+
+        // Canonical codes: by weight, then by symbol
+        var rank_start = [_]u32{0} ** (max_bits + 2);
+        var rank_count = [_]u32{0} ** (max_bits + 2);
+        for (self.lengths) |len| {
+            if (len > 0) rank_count[self.weight(len)] += 1;
+        }
+        var position: u32 = 0;
+        for (1..longest + 1) |w| {
+            rank_start[w] = position;
+            position += rank_count[w] << @intCast(w - 1);
+        }
+        for (self.lengths, 0..) |len, s| {
+            if (len == 0) continue;
+            const w = self.weight(len);
+            self.codes[s] = @intCast(rank_start[w] >> @intCast(w - 1));
+            rank_start[w] += @as(u32, 1) << @intCast(w - 1);
+        }
+        return true;
+    }
+
+    inline fn weight(self: *const Encoder, len: u8) u8 {
+        return if (len == 0) 0 else self.max_bits + 1 - len;
+    }
+
+    /// Append the tree description (weights of all symbols but the last)
+    ///
+    /// Returns:
+    ///   - false if the tree cannot be described (too many symbols)
+    pub fn writeTree(self: *const Encoder, out: *std.ArrayList(u8)) !bool {
+        const n: usize = self.last_symbol;
+        var weights: [max_weights]u8 = undefined;
+        for (0..n) |s| weights[s] = self.weight(self.lengths[s]);
+
+        const start = out.items.len;
+        if (try writeCompressedWeights(weights[0..n], out)) {
+            const size = out.items.len - start - 1;
+            if (size < 128 and (n > 128 or size + 1 < 1 + (n + 1) / 2)) {
+                out.items[start] = @intCast(size);
+                return true;
+            }
+            out.shrinkRetainingCapacity(start);
+        }
+        if (n > 128) return false;
+
+        try out.append(@intCast(127 + n));
+        var i: usize = 0;
+        while (i < n) : (i += 2) {
+            const low = if (i + 1 < n) weights[i + 1] else 0;
+            try out.append((weights[i] << 4) | low);
+        }
+        return true;
+    }
+
+    /// Append one stream coding `literals`
+    pub fn writeStream(self: *const Encoder, literals: []const u8, out: *std.ArrayList(u8)) !void {
+        var writer = bitstream.BitWriter{ .out = out };
+        var i = literals.len;
+        while (i > 0) {
+            i -= 1;
+            const s = literals[i];
+            try writer.add(self.codes[s], @intCast(self.lengths[s]));
+        }
+        try writer.close();
+    }
+};
+
+/// FSE-compress weights behind a placeholder size byte
+///
+/// Returns:
+///   - false (writing nothing) when the weights are not worth compressing
+fn writeCompressedWeights(weights: []const u8, out: *std.ArrayList(u8)) !bool {
+    const n = weights.len;
+    if (n <= 2) return false;
+
+    var counts = [_]u32{0} ** (max_bits + 1);
+    for (weights) |w| counts[w] += 1;
+    if (std.mem.indexOfScalar(u32, &counts, @intCast(n)) != null) return false;
+
+    var max_symbol: usize = 0;
+    for (counts, 0..) |c, s| {
+        if (c > 0) max_symbol = s;
+    }
+    const log = fse.optimalAccuracyLog(6, n, max_symbol);
+    var dist: fse.Distribution = .{};
+    fse.normalize(counts[0 .. max_symbol + 1], n, log, &dist);
+    var table: fse.EncodeTable = .{};
+    try table.build(dist.slice(), log);
+
+    try out.append(0);
+    var writer = bitstream.BitWriter{ .out = out };
+    try fse.writeDistribution(&dist, &writer);
+
+    // Even indexes belong to the first state, odd ones to the second
+    var states: [2]u32 = undefined;
+    states[(n - 1) & 1] = table.initState(weights[n - 1]);
+    states[(n - 2) & 1] = table.initState(weights[n - 2]);
+    var i = n - 2;
+    while (i > 0) {
+        i -= 1;
+        try table.encode(&writer, &states[i & 1], weights[i]);
+    }
+    try table.flush(&writer, states[1]);
+    try table.flush(&writer, states[0]);
+    try writer.close();
+    return true;
+}
+
+// Tests
+
+test "Encoder: codes decode through DecodeTable" {
+    const allocator = std.testing.allocator;
+
+    var literals: [4000]u8 = undefined;
+    var prng = std.Random.DefaultPrng.init(7);
+    for (&literals) |*b| {
+        // Skewed enough to need length limiting
+        const r = prng.random().int(u32);
+        b.* = @intCast(@min(@as(u32, @ctz(r | 0x8000_0000)) * 3 + (r >> 29), 120));
+    }
+    var freq = [_]u32{0} ** 256;
+    for (literals) |b| freq[b] += 1;
+
+    var encoder: Encoder = .{};
+    try std.testing.expect(encoder.build(&freq));
+    try std.testing.expect(encoder.max_bits <= max_bits);
+
+    var out = std.ArrayList(u8).init(allocator);
+    defer out.deinit();
+    try std.testing.expect(try encoder.writeTree(&out));
+    const tree_len = out.items.len;
+    try encoder.writeStream(&literals, &out);
+
+    var table: DecodeTable = .{};
+    try std.testing.expectEqual(tree_len, try table.read(out.items));
+    try std.testing.expectEqual(encoder.max_bits, table.max_bits);
+
+    var decoded: [literals.len]u8 = undefined;
+    try table.decodeStream(out.items[tree_len..], &decoded);
+    try std.testing.expectEqualSlices(u8, &literals, &decoded);
+}
+
+test "DecodeTable: rejects incomplete trees" {
+    var table: DecodeTable = .{};
+    // Direct weights 1, 2: total 3, implied remainder 1 -> tree of 4 cells
+    try std.testing.expectEqual(@as(usize, 2), try table.read(&.{ 129, 0x12 }));
+    // Weights 2, 2, 1 sum to 5: the remainder 3 is not a power of two
+    try std.testing.expectError(error.CorruptedStream, table.read(&.{ 130, 0x22, 0x10 }));
+    // Weight 12 is longer than max_bits allows
+    try std.testing.expectError(error.CorruptedStream, table.read(&.{ 129, 0xc1 }));
+    try std.testing.expectError(error.CorruptedStream, table.read(&.{}));
+}
@@ -0,0 +1,304 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Allocation profiling by call site
+//!
+//! Set `ZARC_ALLOC_PROFILE` to wrap the CLI's allocator in a
+//! `ProfilingAllocator`; when the command finishes, the call sites with
+//! the most allocations are printed to stderr. The value is the number of
+//! sites to print (any non-number prints the default).
+//!
+//! ```sh
+//! ZARC_ALLOC_PROFILE=10 zarc extract archive.tar.gz
+//! ```
+//!
+//! A call site is the return address of the `std.mem.Allocator` call, so
+//! generic containers (e.g. ArrayList growth) are attributed to the
+//! container function rather than its user.
+
+const std = @import("std");
+const instrument = @import("instrument.zig");
+
+/// Environment variable that enables profiling
+pub const env_var = "ZARC_ALLOC_PROFILE";
+
+/// Sites printed when the variable is not a number
+pub const default_top = 20;
+
+/// Number of sites to report, or null when profiling is off
+pub fn topFromEnv(allocator: std.mem.Allocator) ?usize {
+    const value = std.process.getEnvVarOwned(allocator, env_var) catch return null;
+    defer allocator.free(value);
+    return std.fmt.parseInt(usize, value, 10) catch default_top;
+}
+
+/// Allocation statistics for one call site (or all of them)
+pub const SiteStats = struct {
+    allocs: u64 = 0,
+    frees: u64 = 0,
+
+    /// Total bytes requested, including growth by resize/remap
+    bytes: u64 = 0,
+
+    /// Bytes currently allocated, and the most ever allocated at once
+    live_bytes: u64 = 0,
+    peak_bytes: u64 = 0,
+
+    fn grow(self: *SiteStats, n: usize) void {
+        self.bytes += n;
+        self.live_bytes += n;
+        self.peak_bytes = @max(self.peak_bytes, self.live_bytes);
+    }
+
+    fn shrink(self: *SiteStats, n: usize) void {
+        self.live_bytes -|= n;
+    }
+};
+
+/// Allocator wrapper that attributes allocations to call sites
+///
+/// Built on `instrument.CountingAllocator`, which keeps the totals (and
+/// feeds the `allocations` counter); this adds per-site and live-byte
+/// tracking on top.
+///
+/// Thread-safe: resize/remap/free hold the lock across the child call so
+/// a freed address cannot be reused before its record is removed. Every
+/// live allocation is tracked in a hash map, so this is a diagnostic
+/// tool, not something to leave on in production.
+/// Bookkeeping memory comes from the child allocator but is not counted.
+pub const ProfilingAllocator = struct {
+    counting: instrument.CountingAllocator,
+    mutex: std.Thread.Mutex = .{},
+
+    /// Statistics per call site (return address)
+    sites: std.AutoArrayHashMapUnmanaged(usize, SiteStats) = .empty,
+
+    /// Live allocations: address -> (site, length)
+    live: std.AutoHashMapUnmanaged(usize, Live) = .empty,
+
+    /// Bytes currently allocated, and the most ever allocated at once
+    live_bytes: u64 = 0,
+    peak_bytes: u64 = 0,
+
+    const Live = struct {
+        site: usize,
+        len: usize,
+    };
+
+    pub fn init(child: std.mem.Allocator) ProfilingAllocator {
+        return .{ .counting = .init(child) };
+    }
+
+    pub fn deinit(self: *ProfilingAllocator) void {
+        self.sites.deinit(self.counting.child);
+        self.live.deinit(self.counting.child);
+    }
+
+    pub fn allocator(self: *ProfilingAllocator) std.mem.Allocator {
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .alloc = alloc,
+                .resize = resize,
+                .remap = remap,
+                .free = free,
+            },
+        };
+    }
+
+    /// Totals across all call sites
+    pub fn totals(self: *ProfilingAllocator) SiteStats {
+        return .{
+            .allocs = self.counting.allocs.load(.monotonic),
+            .frees = self.counting.frees.load(.monotonic),
+            .bytes = self.counting.bytes.load(.monotonic),
+            .live_bytes = self.live_bytes,
+            .peak_bytes = self.peak_bytes,
+        };
+    }
+
+    fn alloc(ctx: *anyopaque, len: usize, alignment: std.mem.Alignment, ret_addr: usize) ?[*]u8 {
+        const self: *ProfilingAllocator = @ptrCast(@alignCast(ctx));
+        const ptr = self.counting.allocator().rawAlloc(len, alignment, ret_addr) orelse return null;
+
+        self.mutex.lock();
+        defer self.mutex.unlock();
+        self.record(ret_addr, @intFromPtr(ptr), len);
+        return ptr;
+    }
+
+    fn resize(ctx: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) bool {
+        const self: *ProfilingAllocator = @ptrCast(@alignCast(ctx));
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        if (!self.counting.allocator().rawResize(memory, alignment, new_len, ret_addr)) return false;
+        self.moved(@intFromPtr(memory.ptr), memory.len, @intFromPtr(memory.ptr), new_len);
+        return true;
+    }
+
+    fn remap(ctx: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) ?[*]u8 {
+        const self: *ProfilingAllocator = @ptrCast(@alignCast(ctx));
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const ptr = self.counting.allocator().rawRemap(memory, alignment, new_len, ret_addr) orelse return null;
+        self.moved(@intFromPtr(memory.ptr), memory.len, @intFromPtr(ptr), new_len);
+        return ptr;
+    }
+
+    fn free(ctx: *anyopaque, memory: []u8, alignment: std.mem.Alignment, ret_addr: usize) void {
+        const self: *ProfilingAllocator = @ptrCast(@alignCast(ctx));
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        self.counting.allocator().rawFree(memory, alignment, ret_addr);
+        self.live_bytes -|= memory.len;
+        if (self.live.fetchRemove(@intFromPtr(memory.ptr))) |kv| {
+            if (self.sites.getPtr(kv.value.site)) |site| {
+                site.frees += 1;
+                site.shrink(kv.value.len);
+            }
+        }
+    }
+
+    /// Count a new allocation (mutex held)
+    fn record(self: *ProfilingAllocator, site_addr: usize, addr: usize, len: usize) void {
+        self.grow(len);
+
+        // Statistics are best effort: if bookkeeping runs out of memory the
+        // allocation itself still succeeds
+        const site = self.sites.getOrPutValue(self.counting.child, site_addr, .{}) catch return;
+        site.value_ptr.allocs += 1;
+        site.value_ptr.grow(len);
+        self.live.put(self.counting.child, addr, .{ .site = site_addr, .len = len }) catch {};
+    }
+
+    /// Account for an allocation that changed size and/or address (mutex held)
+    fn moved(self: *ProfilingAllocator, old_addr: usize, old_len: usize, new_addr: usize, new_len: usize) void {
+        const entry = self.live.fetchRemove(old_addr) orelse return;
+        const site = self.sites.getPtr(entry.value.site);
+
+        if (new_len > old_len) {
+            self.grow(new_len - old_len);
+            if (site) |s| s.grow(new_len - old_len);
+        } else {
+            self.live_bytes -|= old_len - new_len;
+            if (site) |s| s.shrink(old_len - new_len);
+        }
+        self.live.put(self.counting.child, new_addr, .{ .site = entry.value.site, .len = new_len }) catch {};
+    }
+
+    /// Count live bytes (mutex held)
+    fn grow(self: *ProfilingAllocator, n: usize) void {
+        self.live_bytes += n;
+        self.peak_bytes = @max(self.peak_bytes, self.live_bytes);
+    }
+
+    /// Write totals and the `top` sites with the most allocations
+    pub fn writeReport(self: *ProfilingAllocator, writer: anytype, top: usize) !void {
+        self.mutex.lock();
+        defer self.mutex.unlock();
+
+        const all = self.totals();
+        try writer.print("Allocation profile: {d} allocs, {d} frees, {d} bytes, peak {d} bytes live\n", .{
+            all.allocs,
+            all.frees,
+            all.bytes,
+            all.peak_bytes,
+        });
+
+        const SortContext = struct {
+            stats: []const SiteStats,
+
+            pub fn lessThan(ctx: @This(), a: usize, b: usize) bool {
+                return ctx.stats[a].allocs > ctx.stats[b].allocs;
+            }
+        };
+        self.sites.sort(SortContext{ .stats = self.sites.values() });
+
+        try writer.print("{s:>10} {s:>10} {s:>14} {s:>14}  {s}\n", .{ "allocs", "frees", "bytes", "peak", "site" });
+        const count = @min(top, self.sites.count());
+        for (self.sites.keys()[0..count], self.sites.values()[0..count]) |addr, stats| {
+            try writer.print("{d:>10} {d:>10} {d:>14} {d:>14}  ", .{
+                stats.allocs,
+                stats.frees,
+                stats.bytes,
+                stats.peak_bytes,
+            });
+            try writeSite(writer, addr);
+            try writer.writeByte('\n');
+        }
+    }
+};
+
+/// Write a return address as `function (file:line)` when debug info allows
+fn writeSite(writer: anytype, ret_addr: usize) !void {
+    // The call instruction precedes the return address
+    const address = ret_addr -| 1;
+
+    const debug_info = std.debug.getSelfDebugInfo() catch return writer.print("0x{x}", .{ret_addr});
+    const module = debug_info.getModuleForAddress(address) catch return writer.print("0x{x}", .{ret_addr});
+    const symbol = module.getSymbolAtAddress(debug_info.allocator, address) catch return writer.print("0x{x}", .{ret_addr});
+    defer if (symbol.source_location) |loc| debug_info.allocator.free(loc.file_name);
+
+    try writer.writeAll(symbol.name);
+    if (symbol.source_location) |loc| {
+        try writer.print(" ({s}:{d})", .{ std.fs.path.basename(loc.file_name), loc.line });
+    }
+}
+
+// Tests
+test "ProfilingAllocator: attributes allocations to call sites" {
+    var profiler = ProfilingAllocator.init(std.testing.allocator);
+    defer profiler.deinit();
+    const allocator = profiler.allocator();
+
+    const a = try allocator.alloc(u8, 100);
+    const b = try allocator.alloc(u8, 10);
+    allocator.free(a);
+
+    try std.testing.expectEqual(@as(u64, 2), profiler.totals().allocs);
+    try std.testing.expectEqual(@as(u64, 1), profiler.totals().frees);
+    try std.testing.expectEqual(@as(u64, 10), profiler.totals().live_bytes);
+    try std.testing.expectEqual(@as(u64, 110), profiler.totals().peak_bytes);
+    try std.testing.expectEqual(@as(usize, 2), profiler.sites.count());
+
+    allocator.free(b);
+    try std.testing.expectEqual(@as(u64, 0), profiler.totals().live_bytes);
+    try std.testing.expectEqual(@as(usize, 0), profiler.live.count());
+
+    var out = std.ArrayList(u8).init(std.testing.allocator);
+    defer out.deinit();
+    try profiler.writeReport(out.writer(), 1);
+    try std.testing.expect(std.mem.startsWith(u8, out.items, "Allocation profile: 2 allocs, 2 frees"));
+}
+
+test "ProfilingAllocator: same site accumulates" {
+    var profiler = ProfilingAllocator.init(std.testing.allocator);
+    defer profiler.deinit();
+    const allocator = profiler.allocator();
+
+    for (0..5) |_| {
+        const p = try allocator.create(u64);
+        allocator.destroy(p);
+    }
+
+    try std.testing.expectEqual(@as(usize, 1), profiler.sites.count());
+    const stats = profiler.sites.values()[0];
+    try std.testing.expectEqual(@as(u64, 5), stats.allocs);
+    try std.testing.expectEqual(@as(u64, 5), stats.frees);
+    try std.testing.expectEqual(@as(u64, 8), stats.peak_bytes);
+}
@@ -99,6 +99,9 @@ pub const AppError = error{
     AbsoluteSymlinkNotAllowed,
     /// Filename contains NULL byte
     NullByteInFilename,
+    /// Entry name differs only in case from an earlier entry on a
+    /// case-insensitive destination
+    CaseCollision,
 };
 
 /// Unified error type for all zarc errors
@@ -258,6 +261,16 @@ pub fn formatError(
             .{ context.path, context.detail },
         ),
 
+        error.CaseCollision => try std.fmt.allocPrint(
+            allocator,
+            \\Error: Entry name collides with an earlier entry
+            \\File: {s}
+            \\Reason: The destination is case-insensitive and the names differ only in case
+            \\Suggestion: Extract to a case-sensitive filesystem to keep both entries
+        ,
+            .{context.path},
+        ),
+
         else => try std.fmt.allocPrint(
             allocator,
             "Error: {s}",
@@ -0,0 +1,425 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Hot-path instrumentation
+//!
+//! Compiled in with `zig build -Dinstrument=true`. When disabled, counters
+//! cost nothing and spans only check whether a timeline trace is being
+//! recorded (see `trace`).
+//!
+//! Spans are timed with the monotonic clock and aggregated per phase;
+//! counters and the per-entry latency histogram use relaxed atomics, so
+//! they can be updated from worker threads. While a trace is active,
+//! spans and entry timers are also recorded as trace events.
+//!
+//! Example:
+//! ```zig
+//! const span = instrument.begin(.write);
+//! defer span.end();
+//! try file.writeAll(data);
+//! instrument.count(.bytes_written, data.len);
+//! ```
+
+const std = @import("std");
+const build_options = @import("build_options");
+const trace = @import("trace.zig");
+
+/// Whether instrumentation is compiled in
+pub const enabled: bool = build_options.instrument;
+
+/// Timed phases
+///
+/// Phases are measured where the work happens and never nest, so their
+/// times add up to (at most) the wall time of a single-threaded run.
+pub const Phase = enum {
+    /// Reading archive bytes from the file
+    read,
+    /// Decompression (for zlib this includes its fused CRC-32)
+    inflate,
+    /// Stand-alone CRC-32 computation
+    crc,
+    /// Entry path sanitization
+    path_validation,
+    /// Creating files, directories and links
+    file_create,
+    /// Writing entry data
+    write,
+    /// Applying permissions and timestamps
+    metadata,
+};
+
+/// Event counters
+pub const Counter = enum {
+    /// System calls issued at instrumented sites
+    syscalls,
+    bytes_read,
+    bytes_written,
+    allocations,
+    entries,
+};
+
+const phase_count = @typeInfo(Phase).@"enum".fields.len;
+const counter_count = @typeInfo(Counter).@"enum".fields.len;
+
+/// Log-linear latency histogram (8 sub-buckets per power of two, ~12% error)
+pub const Histogram = struct {
+    pub const bucket_count = 62 * 8;
+
+    buckets: [bucket_count]std.atomic.Value(u64) = [_]std.atomic.Value(u64){.init(0)} ** bucket_count,
+
+    /// Bucket index for a value in nanoseconds
+    pub fn bucketOf(value: u64) usize {
+        if (value < 8) return @intCast(value);
+        const exp: u6 = @intCast(63 - @clz(value));
+        const mantissa: usize = @intCast((value >> (exp - 3)) & 7);
+        return (@as(usize, exp) - 2) * 8 + mantissa;
+    }
+
+    /// Smallest value that falls in a bucket
+    pub fn bucketFloor(index: usize) u64 {
+        if (index < 8) return index;
+        const exp: u6 = @intCast(index / 8 + 2);
+        return (8 + @as(u64, index % 8)) << (exp - 3);
+    }
+
+    pub fn record(self: *Histogram, value: u64) void {
+        _ = self.buckets[bucketOf(value)].fetchAdd(1, .monotonic);
+    }
+
+    pub fn total(self: *const Histogram) u64 {
+        var sum: u64 = 0;
+        for (&self.buckets) |*b| sum += b.load(.monotonic);
+        return sum;
+    }
+
+    /// Approximate percentile (0 < p <= 1); 0 when empty
+    pub fn percentile(self: *const Histogram, p: f64) u64 {
+        const n = self.total();
+        if (n == 0) return 0;
+        const rank: u64 = @max(1, @as(u64, @intFromFloat(@ceil(p * @as(f64, @floatFromInt(n))))));
+
+        var seen: u64 = 0;
+        for (&self.buckets, 0..) |*b, i| {
+            seen += b.load(.monotonic);
+            if (seen >= rank) return bucketFloor(i);
+        }
+        return bucketFloor(bucket_count - 1);
+    }
+
+    pub fn reset(self: *Histogram) void {
+        for (&self.buckets) |*b| b.store(0, .monotonic);
+    }
+};
+
+const PhaseTotals = struct {
+    ns: std.atomic.Value(u64) = .init(0),
+    calls: std.atomic.Value(u64) = .init(0),
+};
+
+var phases: [phase_count]PhaseTotals = [_]PhaseTotals{.{}} ** phase_count;
+var counters: [counter_count]std.atomic.Value(u64) = [_]std.atomic.Value(u64){.init(0)} ** counter_count;
+var entry_latency: Histogram = .{};
+
+/// An open timing span; call `end` exactly once
+pub const Span = struct {
+    phase: Phase,
+    start: ?std.time.Instant,
+
+    pub inline fn end(self: Span) void {
+        const start = self.start orelse return;
+        const now = std.time.Instant.now() catch return;
+        const ns = now.since(start);
+        if (enabled) {
+            const totals = &phases[@intFromEnum(self.phase)];
+            _ = totals.ns.fetchAdd(ns, .monotonic);
+            _ = totals.calls.fetchAdd(1, .monotonic);
+        }
+        trace.complete(@tagName(self.phase), start, ns, "");
+    }
+};
+
+/// Start timing a phase
+pub inline fn begin(phase: Phase) Span {
+    if (!enabled and !trace.isActive()) return .{ .phase = phase, .start = null };
+    return .{ .phase = phase, .start = std.time.Instant.now() catch null };
+}
+
+/// Add to a counter
+pub inline fn count(counter: Counter, n: u64) void {
+    if (!enabled) return;
+    _ = counters[@intFromEnum(counter)].fetchAdd(n, .monotonic);
+}
+
+/// Per-entry latency timer
+pub const EntryTimer = struct {
+    start: ?std.time.Instant,
+    /// Entry path; must stay valid until `end`
+    path: []const u8,
+
+    pub inline fn end(self: EntryTimer) void {
+        const start = self.start orelse return;
+        const now = std.time.Instant.now() catch return;
+        const ns = now.since(start);
+        if (enabled) {
+            entry_latency.record(ns);
+            count(.entries, 1);
+        }
+        trace.complete("entry", start, ns, self.path);
+    }
+};
+
+/// Start timing one archive entry
+///
+/// Parameters:
+///   - path: Entry path, shown on the trace timeline
+pub inline fn beginEntry(path: []const u8) EntryTimer {
+    if (!enabled and !trace.isActive()) return .{ .start = null, .path = path };
+    return .{ .start = std.time.Instant.now() catch null, .path = path };
+}
+
+/// Clear all phases, counters and latencies
+pub fn reset() void {
+    for (&phases) |*p| {
+        p.ns.store(0, .monotonic);
+        p.calls.store(0, .monotonic);
+    }
+    for (&counters) |*c| c.store(0, .monotonic);
+    entry_latency.reset();
+}
+
+/// Point-in-time copy of all statistics
+pub const Snapshot = struct {
+    phase_ns: [phase_count]u64,
+    phase_calls: [phase_count]u64,
+    counters: [counter_count]u64,
+    entry_p50_ns: u64,
+    entry_p99_ns: u64,
+
+    pub fn counter(self: Snapshot, c: Counter) u64 {
+        return self.counters[@intFromEnum(c)];
+    }
+
+    /// Write a human-readable breakdown
+    ///
+    /// Parameters:
+    ///   - writer: Destination
+    ///   - elapsed_ns: Wall time of the operation
+    ///   - payload_bytes: Bytes the operation produced (for throughput)
+    pub fn writeText(self: Snapshot, writer: anytype, elapsed_ns: u64, payload_bytes: u64) !void {
+        const elapsed_s = @as(f64, @floatFromInt(@max(elapsed_ns, 1))) / std.time.ns_per_s;
+        try writer.print("Elapsed: {d:.3} s, {d:.1} MB/s\n", .{
+            elapsed_s,
+            @as(f64, @floatFromInt(payload_bytes)) / (1024 * 1024) / elapsed_s,
+        });
+
+        if (!enabled) {
+            try writer.writeAll("(per-phase statistics need a build with -Dinstrument=true)\n");
+            return;
+        }
+
+        try writer.print("{s:<16} {s:>12} {s:>7} {s:>12}\n", .{ "phase", "ms", "%", "calls" });
+        for (0..phase_count) |i| {
+            const ns = self.phase_ns[i];
+            try writer.print("{s:<16} {d:>12.3} {d:>7.1} {d:>12}\n", .{
+                @tagName(@as(Phase, @enumFromInt(i))),
+                @as(f64, @floatFromInt(ns)) / std.time.ns_per_ms,
+                @as(f64, @floatFromInt(ns)) * 100 / @as(f64, @floatFromInt(@max(elapsed_ns, 1))),
+                self.phase_calls[i],
+            });
+        }
+
+        for (0..counter_count) |i| {
+            try writer.print("{s:<16} {d:>12}\n", .{ @tagName(@as(Counter, @enumFromInt(i))), self.counters[i] });
+        }
+        try writer.print("entry latency    p50 {d} ns, p99 {d} ns\n", .{ self.entry_p50_ns, self.entry_p99_ns });
+    }
+
+    /// Write the breakdown as one JSON object
+    pub fn writeJson(self: Snapshot, writer: anytype, elapsed_ns: u64, payload_bytes: u64) !void {
+        try writer.print("{{\"instrumented\":{},\"elapsed_ns\":{d},\"bytes\":{d}", .{
+            enabled,
+            elapsed_ns,
+            payload_bytes,
+        });
+        if (enabled) {
+            try writer.writeAll(",\"phases\":{");
+            for (0..phase_count) |i| {
+                try writer.print("{s}\"{s}\":{{\"ns\":{d},\"calls\":{d}}}", .{
+                    if (i == 0) "" else ",",
+                    @tagName(@as(Phase, @enumFromInt(i))),
+                    self.phase_ns[i],
+                    self.phase_calls[i],
+                });
+            }
+            try writer.writeAll("},\"counters\":{");
+            for (0..counter_count) |i| {
+                try writer.print("{s}\"{s}\":{d}", .{
+                    if (i == 0) "" else ",",
+                    @tagName(@as(Counter, @enumFromInt(i))),
+                    self.counters[i],
+                });
+            }
+            try writer.print("}},\"entry_latency_ns\":{{\"p50\":{d},\"p99\":{d}}}", .{
+                self.entry_p50_ns,
+                self.entry_p99_ns,
+            });
+        }
+        try writer.writeAll("}\n");
+    }
+};
+
+/// Capture the current statistics
+pub fn snapshot() Snapshot {
+    var result: Snapshot = undefined;
+    for (0..phase_count) |i| {
+        result.phase_ns[i] = phases[i].ns.load(.monotonic);
+        result.phase_calls[i] = phases[i].calls.load(.monotonic);
+    }
+    for (0..counter_count) |i| {
+        result.counters[i] = counters[i].load(.monotonic);
+    }
+    result.entry_p50_ns = entry_latency.percentile(0.50);
+    result.entry_p99_ns = entry_latency.percentile(0.99);
+    return result;
+}
+
+/// Allocator wrapper that counts calls and bytes
+///
+/// Every allocation also feeds the `allocations` counter. The statistics
+/// are relaxed atomics, so the wrapper can be shared with worker threads.
+pub const CountingAllocator = struct {
+    child: std.mem.Allocator,
+    allocs: std.atomic.Value(u64) = .init(0),
+    frees: std.atomic.Value(u64) = .init(0),
+
+    /// Total bytes requested, including growth by resize/remap
+    bytes: std.atomic.Value(u64) = .init(0),
+
+    pub fn init(child: std.mem.Allocator) CountingAllocator {
+        return .{ .child = child };
+    }
+
+    pub fn allocator(self: *CountingAllocator) std.mem.Allocator {
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .alloc = alloc,
+                .resize = resize,
+                .remap = remap,
+                .free = free,
+            },
+        };
+    }
+
+    pub fn reset(self: *CountingAllocator) void {
+        self.allocs.store(0, .monotonic);
+        self.frees.store(0, .monotonic);
+        self.bytes.store(0, .monotonic);
+    }
+
+    fn alloc(ctx: *anyopaque, len: usize, alignment: std.mem.Alignment, ret_addr: usize) ?[*]u8 {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ctx));
+        const ptr = self.child.rawAlloc(len, alignment, ret_addr) orelse return null;
+        self.counted(0, len);
+        return ptr;
+    }
+
+    fn resize(ctx: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) bool {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ctx));
+        if (!self.child.rawResize(memory, alignment, new_len, ret_addr)) return false;
+        _ = self.bytes.fetchAdd(new_len -| memory.len, .monotonic);
+        return true;
+    }
+
+    fn remap(ctx: *anyopaque, memory: []u8, alignment: std.mem.Alignment, new_len: usize, ret_addr: usize) ?[*]u8 {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ctx));
+        const ptr = self.child.rawRemap(memory, alignment, new_len, ret_addr) orelse return null;
+        self.counted(memory.len, new_len);
+        return ptr;
+    }
+
+    fn free(ctx: *anyopaque, memory: []u8, alignment: std.mem.Alignment, ret_addr: usize) void {
+        const self: *CountingAllocator = @ptrCast(@alignCast(ctx));
+        _ = self.frees.fetchAdd(1, .monotonic);
+        self.child.rawFree(memory, alignment, ret_addr);
+    }
+
+    /// Count one (re)allocation from `old_len` to `new_len` bytes
+    fn counted(self: *CountingAllocator, old_len: usize, new_len: usize) void {
+        _ = self.allocs.fetchAdd(1, .monotonic);
+        _ = self.bytes.fetchAdd(new_len -| old_len, .monotonic);
+        count(.allocations, 1);
+    }
+};
+
+// Tests
+test "Histogram: buckets are monotonic and cover u64" {
+    var prev: usize = 0;
+    for ([_]u64{ 0, 1, 7, 8, 9, 15, 16, 100, 1000, 1 << 40, std.math.maxInt(u64) }) |v| {
+        const b = Histogram.bucketOf(v);
+        try std.testing.expect(b >= prev and b < Histogram.bucket_count);
+        try std.testing.expect(Histogram.bucketFloor(b) <= v);
+        prev = b;
+    }
+    try std.testing.expectEqual(@as(u64, 96), Histogram.bucketFloor(Histogram.bucketOf(100)));
+}
+
+test "Histogram: percentiles" {
+    var h = Histogram{};
+    try std.testing.expectEqual(@as(u64, 0), h.percentile(0.5));
+
+    for (0..99) |_| h.record(1000);
+    h.record(1_000_000);
+
+    try std.testing.expectEqual(@as(u64, 100), h.total());
+    const p50 = h.percentile(0.50);
+    try std.testing.expect(p50 >= 896 and p50 <= 1000);
+    try std.testing.expect(h.percentile(0.99) <= 1000);
+    try std.testing.expect(h.percentile(1.0) > 900_000);
+}
+
+test "instrument: spans and counters" {
+    reset();
+    const span = begin(.write);
+    count(.bytes_written, 10);
+    span.end();
+    beginEntry("file.txt").end();
+
+    const snap = snapshot();
+    if (enabled) {
+        try std.testing.expectEqual(@as(u64, 1), snap.phase_calls[@intFromEnum(Phase.write)]);
+        try std.testing.expectEqual(@as(u64, 10), snap.counter(.bytes_written));
+        try std.testing.expectEqual(@as(u64, 1), snap.counter(.entries));
+    } else {
+        try std.testing.expectEqual(@as(u64, 0), snap.counter(.bytes_written));
+    }
+}
+
+test "CountingAllocator: counts calls and bytes" {
+    var counting = CountingAllocator.init(std.testing.allocator);
+    const allocator = counting.allocator();
+
+    const a = try allocator.alloc(u8, 100);
+    const b = try allocator.alloc(u32, 10);
+    allocator.free(a);
+    allocator.free(b);
+
+    try std.testing.expectEqual(@as(u64, 2), counting.allocs.load(.monotonic));
+    try std.testing.expectEqual(@as(u64, 2), counting.frees.load(.monotonic));
+    try std.testing.expectEqual(@as(u64, 140), counting.bytes.load(.monotonic));
+
+    counting.reset();
+    try std.testing.expectEqual(@as(u64, 0), counting.allocs.load(.monotonic));
+}
@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Timeline tracing in Chrome trace event format
+//!
+//! Enabled at runtime (`--trace=out.json`); while inactive, recording an
+//! event costs one relaxed atomic load. Events are recorded by
+//! `instrument` spans and entry timers, so every instrumented phase shows
+//! up on the timeline without extra call sites.
+//!
+//! Each thread appends complete ("X") events to its own fixed-size ring.
+//! A ring has a single writer and is published with release/acquire
+//! ordering, so recording takes no locks. When a ring is full the oldest
+//! events are overwritten.
+//!
+//! The resulting file opens in chrome://tracing and ui.perfetto.dev.
+
+const std = @import("std");
+
+/// Events kept per thread
+pub const ring_capacity = 8192;
+
+/// Longest label (e.g. entry path) kept per event
+pub const max_label_len = 64;
+
+const Event = struct {
+    /// Start, relative to the trace epoch
+    ts_ns: u64,
+    dur_ns: u64,
+    name: []const u8,
+    label_len: u8,
+    label: [max_label_len]u8,
+};
+
+const Ring = struct {
+    /// Registry link (immutable once published)
+    next: ?*Ring,
+    tid: std.Thread.Id,
+    thread_name: [32]u8 = undefined,
+    thread_name_len: u8 = 0,
+
+    /// Total events written; the slot for event i is i % ring_capacity
+    written: std.atomic.Value(u64) = .init(0),
+    events: [ring_capacity]Event = undefined,
+
+    fn push(self: *Ring, event: Event) void {
+        const index = self.written.load(.monotonic);
+        self.events[index % ring_capacity] = event;
+        self.written.store(index + 1, .release);
+    }
+};
+
+var active: std.atomic.Value(bool) = .init(false);
+var epoch: std.time.Instant = undefined;
+
+/// Bumped by every `start`, so threads drop rings freed by an earlier `stop`
+var generation: std.atomic.Value(u32) = .init(0);
+
+/// Every ring ever created (lock-free push-only list)
+var rings: std.atomic.Value(?*Ring) = .init(null);
+
+threadlocal var local_ring: ?*Ring = null;
+threadlocal var local_generation: u32 = 0;
+
+/// Whether events are currently being recorded
+pub inline fn isActive() bool {
+    return active.load(.monotonic);
+}
+
+/// Start recording
+///
+/// The calling thread is named "main" on the timeline.
+///
+/// Errors:
+///   - error.Unsupported: No monotonic clock
+pub fn start() !void {
+    epoch = std.time.Instant.now() catch return error.Unsupported;
+    _ = generation.fetchAdd(1, .monotonic);
+    active.store(true, .release);
+    setThreadName("main");
+}
+
+/// Stop recording and free all rings
+///
+/// Every thread that recorded events must have finished.
+pub fn stop() void {
+    active.store(false, .release);
+    var ring = rings.swap(null, .acq_rel);
+    while (ring) |r| {
+        ring = r.next;
+        std.heap.page_allocator.destroy(r);
+    }
+}
+
+/// Ring of the calling thread, registering one on first use
+fn threadRing() ?*Ring {
+    const current = generation.load(.monotonic);
+    if (local_generation == current) {
+        if (local_ring) |ring| return ring;
+    }
+
+    const ring = std.heap.page_allocator.create(Ring) catch return null;
+    ring.* = .{ .next = null, .tid = std.Thread.getCurrentId() };
+
+    var head = rings.load(.monotonic);
+    while (true) {
+        ring.next = head;
+        head = rings.cmpxchgWeak(head, ring, .release, .monotonic) orelse break;
+    }
+    local_ring = ring;
+    local_generation = current;
+    return ring;
+}
+
+/// Name the calling thread on the timeline (e.g. "readahead")
+pub fn setThreadName(name: []const u8) void {
+    if (!isActive()) return;
+    const ring = threadRing() orelse return;
+    const len = @min(name.len, ring.thread_name.len);
+    @memcpy(ring.thread_name[0..len], name[0..len]);
+    ring.thread_name_len = @intCast(len);
+}
+
+/// Record a complete event
+///
+/// Parameters:
+///   - name: Event name (must outlive the trace, e.g. a string literal)
+///   - begin: When the event started
+///   - dur_ns: Duration
+///   - label: Optional detail shown in the event's args (copied, truncated)
+pub fn complete(name: []const u8, begin: std.time.Instant, dur_ns: u64, label: []const u8) void {
+    if (!isActive()) return;
+    if (begin.order(epoch) == .lt) return; // Started before the trace
+
+    const ring = threadRing() orelse return;
+    var event = Event{
+        .ts_ns = begin.since(epoch),
+        .dur_ns = dur_ns,
+        .name = name,
+        .label_len = @intCast(@min(label.len, max_label_len)),
+        .label = undefined,
+    };
+    @memcpy(event.label[0..event.label_len], label[0..event.label_len]);
+    ring.push(event);
+}
+
+/// Write all recorded events as Chrome trace JSON
+///
+/// Every thread that recorded events must have finished.
+pub fn writeJson(writer: anytype) !void {
+    try writer.writeAll("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    var first = true;
+    var ring = rings.load(.acquire);
+    while (ring) |r| : (ring = r.next) {
+        const tid = r.tid;
+
+        if (r.thread_name_len > 0) {
+            try writer.writeAll(if (first) "\n" else ",\n");
+            first = false;
+            try writer.print("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{d},\"args\":{{\"name\":", .{tid});
+            try std.json.encodeJsonString(r.thread_name[0..r.thread_name_len], .{}, writer);
+            try writer.writeAll("}}");
+        }
+
+        const written = r.written.load(.acquire);
+        const oldest = written -| ring_capacity;
+        var i = oldest;
+        while (i < written) : (i += 1) {
+            const event = &r.events[i % ring_capacity];
+            try writer.writeAll(if (first) "\n" else ",\n");
+            first = false;
+
+            try writer.writeAll("{\"name\":");
+            try std.json.encodeJsonString(event.name, .{}, writer);
+            try writer.print(",\"cat\":\"zarc\",\"ph\":\"X\",\"pid\":1,\"tid\":{d},\"ts\":{d}.{d:0>3},\"dur\":{d}.{d:0>3}", .{
+                tid,
+                event.ts_ns / 1000,
+                event.ts_ns % 1000,
+                event.dur_ns / 1000,
+                event.dur_ns % 1000,
+            });
+            if (event.label_len > 0) {
+                try writer.writeAll(",\"args\":{\"detail\":");
+                try std.json.encodeJsonString(event.label[0..event.label_len], .{}, writer);
+                try writer.writeByte('}');
+            }
+            try writer.writeByte('}');
+        }
+    }
+
+    try writer.writeAll("\n]}\n");
+}
+
+// Tests
+test "trace: records per-thread events as valid JSON" {
+    const allocator = std.testing.allocator;
+
+    try start();
+    defer stop();
+
+    const t0 = try std.time.Instant.now();
+    complete("write", t0, 1500, "dir/file \"1\".txt");
+
+    const Worker = struct {
+        fn run() void {
+            setThreadName("worker");
+            const t = std.time.Instant.now() catch return;
+            for (0..3) |_| complete("inflate", t, 10, "");
+        }
+    };
+    const thread = try std.Thread.spawn(.{}, Worker.run, .{});
+    thread.join();
+
+    var out = std.ArrayList(u8).init(allocator);
+    defer out.deinit();
+    try writeJson(out.writer());
+
+    const parsed = try std.json.parseFromSlice(std.json.Value, allocator, out.items, .{});
+    defer parsed.deinit();
+
+    const events = parsed.value.object.get("traceEvents").?.array.items;
+    var complete_events: usize = 0;
+    var names: usize = 0;
+    for (events) |event| {
+        const ph = event.object.get("ph").?.string;
+        if (std.mem.eql(u8, ph, "X")) complete_events += 1;
+        if (std.mem.eql(u8, ph, "M")) names += 1;
+    }
+    try std.testing.expectEqual(@as(usize, 4), complete_events);
+    try std.testing.expectEqual(@as(usize, 2), names);
+}
+
+test "trace: ring keeps the newest events" {
+    try start();
+    defer stop();
+
+    const t0 = try std.time.Instant.now();
+    for (0..ring_capacity + 10) |i| complete("e", t0, i, "");
+
+    const ring = local_ring.?;
+    try std.testing.expectEqual(@as(u64, ring_capacity + 10), ring.written.load(.monotonic));
+    try std.testing.expectEqual(@as(u64, ring_capacity + 9), ring.events[(ring_capacity + 9) % ring_capacity].dur_ns);
+}
+
+test "trace: inactive trace records nothing" {
+    const t0 = try std.time.Instant.now();
+    complete("ignored", t0, 1, "");
+    try std.testing.expect(rings.load(.monotonic) == null);
+}
@@ -33,6 +33,15 @@ pub const EntryType = enum {
     fifo,
 };
 
+/// Extended attribute of an entry
+pub const Xattr = struct {
+    /// Namespaced name (e.g. "user.mime_type", "security.capability")
+    name: []const u8,
+
+    /// Raw value
+    value: []const u8,
+};
+
 /// Archive entry metadata
 pub const Entry = struct {
     /// Entry path (relative to archive root)
@@ -50,6 +59,15 @@ pub const Entry = struct {
     /// Modification time (Unix timestamp)
     mtime: i64,
 
+    /// Sub-second part of `mtime` in nanoseconds (PAX headers only)
+    mtime_nsec: u32 = 0,
+
+    /// Access time (Unix timestamp); null when the archive has none
+    atime: ?i64 = null,
+
+    /// Sub-second part of `atime` in nanoseconds
+    atime_nsec: u32 = 0,
+
     /// User ID (POSIX)
     uid: u32 = 0,
 
@@ -65,6 +83,11 @@ pub const Entry = struct {
     /// Symlink target path (for symlink/hardlink)
     link_target: []const u8 = "",
 
+    /// Raw PAX records carrying extended attributes and POSIX ACLs
+    /// (SCHILY.xattr.* and SCHILY.acl.*); decoded with
+    /// `tar.pax.decodeXattrs` only when extraction restores them
+    xattr_records: []const u8 = "",
+
     /// Format entry for display
     pub fn format(
         self: Entry,
@@ -133,12 +156,20 @@ pub const FormatType = enum {
     tar_bz2,
     /// Tar with xz/lzma2 compression
     tar_xz,
+    /// Tar with Zstandard compression
+    tar_zst,
+    /// Tar with LZ4 frame compression
+    tar_lz4,
     /// Gzip compression
     gz,
     /// Bzip2 compression
     bz2,
     /// XZ/LZMA2 compression
     xz,
+    /// Zstandard compression
+    zst,
+    /// LZ4 frame compression
+    lz4,
     /// ZIP format
     zip,
     /// 7-Zip format
@@ -153,9 +184,13 @@ pub const FormatType = enum {
             .tar_gz => ".tar.gz",
             .tar_bz2 => ".tar.bz2",
             .tar_xz => ".tar.xz",
+            .tar_zst => ".tar.zst",
+            .tar_lz4 => ".tar.lz4",
             .gz => ".gz",
             .bz2 => ".bz2",
             .xz => ".xz",
+            .zst => ".zst",
+            .lz4 => ".lz4",
             .zip => ".zip",
             .sevenzip => ".7z",
             .unknown => "",
@@ -170,6 +205,10 @@ pub const FormatType = enum {
             return .tar_bz2;
         } else if (std.ascii.endsWithIgnoreCase(path, ".tar.xz") or std.ascii.endsWithIgnoreCase(path, ".txz")) {
             return .tar_xz;
+        } else if (std.ascii.endsWithIgnoreCase(path, ".tar.zst") or std.ascii.endsWithIgnoreCase(path, ".tzst")) {
+            return .tar_zst;
+        } else if (std.ascii.endsWithIgnoreCase(path, ".tar.lz4")) {
+            return .tar_lz4;
         } else if (std.ascii.endsWithIgnoreCase(path, ".tar")) {
             return .tar;
         } else if (std.ascii.endsWithIgnoreCase(path, ".zip")) {
@@ -182,6 +221,10 @@ pub const FormatType = enum {
             return .bz2;
         } else if (std.ascii.endsWithIgnoreCase(path, ".xz")) {
             return .xz;
+        } else if (std.ascii.endsWithIgnoreCase(path, ".zst")) {
+            return .zst;
+        } else if (std.ascii.endsWithIgnoreCase(path, ".lz4")) {
+            return .lz4;
         } else {
             return .unknown;
         }
@@ -218,6 +261,21 @@ pub const SizeLimit = struct {
     pub const max_link_target_length: usize = 4096;
 };
 
+/// Observer of streaming decompression progress
+///
+/// Decoders call `observe` with running totals after each decode step, so
+/// policy checks (see `security.RatioMonitor`) can abort a stream while it
+/// is still being decompressed.
+pub const StreamObserver = struct {
+    ptr: *anyopaque,
+    observeFn: *const fn (ptr: *anyopaque, compressed: u64, uncompressed: u64) anyerror!void,
+
+    /// Report cumulative compressed bytes consumed and uncompressed bytes produced
+    pub fn observe(self: StreamObserver, compressed: u64, uncompressed: u64) !void {
+        return self.observeFn(self.ptr, compressed, uncompressed);
+    }
+};
+
 // Tests
 test "EntryType: basic types" {
     try std.testing.expectEqual(EntryType.file, EntryType.file);
@@ -301,6 +359,10 @@ test "FormatType: extension" {
     try std.testing.expectEqualStrings(".gz", FormatType.gz.extension());
     try std.testing.expectEqualStrings(".bz2", FormatType.bz2.extension());
     try std.testing.expectEqualStrings(".xz", FormatType.xz.extension());
+    try std.testing.expectEqualStrings(".tar.zst", FormatType.tar_zst.extension());
+    try std.testing.expectEqualStrings(".zst", FormatType.zst.extension());
+    try std.testing.expectEqualStrings(".tar.lz4", FormatType.tar_lz4.extension());
+    try std.testing.expectEqualStrings(".lz4", FormatType.lz4.extension());
     try std.testing.expectEqualStrings(".zip", FormatType.zip.extension());
     try std.testing.expectEqualStrings(".7z", FormatType.sevenzip.extension());
 }
@@ -314,6 +376,11 @@ test "FormatType: fromExtension" {
     try std.testing.expectEqual(FormatType.gz, FormatType.fromExtension("file.gz"));
     try std.testing.expectEqual(FormatType.bz2, FormatType.fromExtension("file.bz2"));
     try std.testing.expectEqual(FormatType.xz, FormatType.fromExtension("file.xz"));
+    try std.testing.expectEqual(FormatType.tar_zst, FormatType.fromExtension("archive.tar.zst"));
+    try std.testing.expectEqual(FormatType.tar_zst, FormatType.fromExtension("archive.tzst"));
+    try std.testing.expectEqual(FormatType.zst, FormatType.fromExtension("file.zst"));
+    try std.testing.expectEqual(FormatType.tar_lz4, FormatType.fromExtension("archive.tar.lz4"));
+    try std.testing.expectEqual(FormatType.lz4, FormatType.fromExtension("file.lz4"));
     try std.testing.expectEqual(FormatType.zip, FormatType.fromExtension("archive.zip"));
     try std.testing.expectEqual(FormatType.sevenzip, FormatType.fromExtension("archive.7z"));
     try std.testing.expectEqual(FormatType.unknown, FormatType.fromExtension("unknown.bin"));
@@ -14,6 +14,7 @@
 // limitations under the License.
 
 const std = @import("std");
+const types = @import("types.zig");
 
 /// Parse octal string to unsigned integer
 ///
@@ -57,6 +58,12 @@ pub fn parseOctal(text: []const u8) !u64 {
     return result;
 }
 
+/// Longest string produced by `formatSizeBuf` ("1024.0 KB"-style, plus slack)
+pub const max_size_len = 16;
+
+/// Length of the string produced by `formatTimestampBuf`
+pub const timestamp_len = "YYYY-MM-DD HH:MM:SS".len;
+
 /// Format file size in human-readable format
 ///
 /// Parameters:
@@ -73,6 +80,21 @@ pub fn parseOctal(text: []const u8) !u64 {
 /// defer allocator.free(size_str);
 /// ```
 pub fn formatSize(allocator: std.mem.Allocator, bytes: u64) ![]const u8 {
+    var buf: [max_size_len]u8 = undefined;
+    return try allocator.dupe(u8, formatSizeBuf(&buf, bytes));
+}
+
+/// Format file size into a caller-provided buffer
+///
+/// Allocation-free variant of `formatSize` for hot loops such as listing.
+///
+/// Parameters:
+///   - buf: Output buffer
+///   - bytes: File size in bytes
+///
+/// Returns:
+///   - Slice of `buf` holding the formatted size
+pub fn formatSizeBuf(buf: *[max_size_len]u8, bytes: u64) []const u8 {
     const kb: f64 = 1024.0;
     const mb: f64 = kb * 1024.0;
     const gb: f64 = mb * 1024.0;
@@ -80,17 +102,17 @@ pub fn formatSize(allocator: std.mem.Allocator, bytes: u64) ![]const u8 {
 
     const bytes_f = @as(f64, @floatFromInt(bytes));
 
-    if (bytes_f >= tb) {
-        return try std.fmt.allocPrint(allocator, "{d:.1} TB", .{bytes_f / tb});
-    } else if (bytes_f >= gb) {
-        return try std.fmt.allocPrint(allocator, "{d:.1} GB", .{bytes_f / gb});
-    } else if (bytes_f >= mb) {
-        return try std.fmt.allocPrint(allocator, "{d:.1} MB", .{bytes_f / mb});
-    } else if (bytes_f >= kb) {
-        return try std.fmt.allocPrint(allocator, "{d:.1} KB", .{bytes_f / kb});
-    } else {
-        return try std.fmt.allocPrint(allocator, "{d} B", .{bytes});
-    }
+    // Cannot overflow: the largest u64 is "16777216.0 TB"
+    return (if (bytes_f >= tb)
+        std.fmt.bufPrint(buf, "{d:.1} TB", .{bytes_f / tb})
+    else if (bytes_f >= gb)
+        std.fmt.bufPrint(buf, "{d:.1} GB", .{bytes_f / gb})
+    else if (bytes_f >= mb)
+        std.fmt.bufPrint(buf, "{d:.1} MB", .{bytes_f / mb})
+    else if (bytes_f >= kb)
+        std.fmt.bufPrint(buf, "{d:.1} KB", .{bytes_f / kb})
+    else
+        std.fmt.bufPrint(buf, "{d} B", .{bytes})) catch unreachable;
 }
 
 /// Format Unix timestamp to ISO 8601 string
@@ -110,14 +132,33 @@ pub fn formatSize(allocator: std.mem.Allocator, bytes: u64) ![]const u8 {
 /// // "2009-02-13 23:31:30"
 /// ```
 pub fn formatTimestamp(allocator: std.mem.Allocator, timestamp: i64) ![]const u8 {
-    const epoch_seconds = std.time.epoch.EpochSeconds{ .secs = @intCast(timestamp) };
+    var buf: [timestamp_len]u8 = undefined;
+    return try allocator.dupe(u8, formatTimestampBuf(&buf, timestamp));
+}
+
+/// Format Unix timestamp into a caller-provided buffer
+///
+/// Allocation-free variant of `formatTimestamp`. Timestamps before the
+/// epoch (or past year 9999) are clamped so the output width is fixed.
+///
+/// Parameters:
+///   - buf: Output buffer
+///   - timestamp: Unix timestamp (seconds since epoch)
+///
+/// Returns:
+///   - `buf`, holding "YYYY-MM-DD HH:MM:SS"
+pub fn formatTimestampBuf(buf: *[timestamp_len]u8, timestamp: i64) []const u8 {
+    const max_timestamp: i64 = 253402300799; // 9999-12-31 23:59:59
+    const epoch_seconds = std.time.epoch.EpochSeconds{
+        .secs = @intCast(std.math.clamp(timestamp, 0, max_timestamp)),
+    };
     const epoch_day = epoch_seconds.getEpochDay();
     const year_day = epoch_day.calculateYearDay();
     const month_day = year_day.calculateMonthDay();
     const day_seconds = epoch_seconds.getDaySeconds();
 
-    return try std.fmt.allocPrint(
-        allocator,
+    _ = std.fmt.bufPrint(
+        buf,
         "{d:0>4}-{d:0>2}-{d:0>2} {d:0>2}:{d:0>2}:{d:0>2}",
         .{
             year_day.year,
@@ -127,86 +168,177 @@ pub fn formatTimestamp(allocator: std.mem.Allocator, timestamp: i64) ![]const u8
             day_seconds.getMinutesIntoHour(),
             day_seconds.getSecondsIntoMinute(),
         },
-    );
+    ) catch unreachable;
+    return buf;
 }
 
-/// Check if path is safe (no path traversal)
+/// Format entry type and permission bits as `ls -l` style mode string
 ///
 /// Parameters:
-///   - path: Path to check
+///   - buf: Output buffer
+///   - entry_type: Entry type (selects the leading type character)
+///   - mode: POSIX mode bits
 ///
 /// Returns:
-///   - true if path is safe, false otherwise
+///   - `buf`, holding e.g. "drwxr-xr-x"
+pub fn formatMode(buf: *[10]u8, entry_type: types.EntryType, mode: u32) []const u8 {
+    buf[0] = switch (entry_type) {
+        .file, .hardlink => '-',
+        .directory => 'd',
+        .symlink => 'l',
+        .char_device => 'c',
+        .block_device => 'b',
+        .fifo => 'p',
+    };
+    const rwx = "rwx";
+    for (0..9) |i| {
+        const bit: u5 = @intCast(8 - i);
+        buf[1 + i] = if (mode & (@as(u32, 1) << bit) != 0) rwx[i % 3] else '-';
+    }
+    return buf;
+}
+
+/// Summary of a single pass over a path
+///
+/// Produced by `scanPath`. Each field answers one of the questions the
+/// path validators ask, so callers never need to walk the path again.
+pub const PathScan = struct {
+    /// Path contains a NULL byte
+    has_null: bool = false,
+
+    /// Path contains a control character (< 0x20) other than tab
+    has_control: bool = false,
+
+    /// A ".." component climbs above the directory the path starts in
+    escapes_root: bool = false,
+};
+
+/// Options for `scanPath`
+pub const PathScanOptions = struct {
+    /// Treat '\\' as a component separator in addition to '/'
+    backslash_is_separator: bool = true,
+};
+
+/// Number of bytes classified per SIMD step (16 or 32 depending on target)
+const path_lanes: comptime_int = @max(16, @min(std.simd.suggestVectorLength(u8) orelse 16, 32));
+const PathLane = @Vector(path_lanes, u8);
+const PathMask = std.meta.Int(.unsigned, path_lanes);
+
+inline fn laneMask(v: PathLane, comptime byte: u8) PathMask {
+    return @bitCast(v == @as(PathLane, @splat(byte)));
+}
+
+/// Classify a path in a single vectorized pass
+///
+/// Every chunk of `path_lanes` bytes is compared against NULL, control,
+/// separator and '.' in parallel, producing one bitmask per class.
+/// Component boundaries are taken from the separator mask, and "." / ".."
+/// components are recognised from the dot mask without re-reading bytes,
+/// so traversal depth is tracked in the same pass as character validation.
+///
+/// Parameters:
+///   - path: Path to scan
+///   - options: Which bytes count as separators
+///
+/// Returns:
+///   - Scan summary (see `PathScan`)
 ///
 /// Example:
 /// ```zig
-/// try std.testing.expect(isSafePath("foo/bar.txt"));
-/// try std.testing.expect(!isSafePath("../etc/passwd"));
+/// const scan = scanPath("foo/../../etc", .{});
+/// // scan.escapes_root == true
 /// ```
-pub fn isSafePath(path: []const u8) bool {
-    // Check for absolute paths
-    if (std.fs.path.isAbsolute(path)) {
-        return false;
-    }
-
-    // Check for path traversal
-    var it = std.mem.splitScalar(u8, path, '/');
+pub fn scanPath(path: []const u8, comptime options: PathScanOptions) PathScan {
+    var result = PathScan{};
     var depth: i32 = 0;
+    var component_start: usize = 0;
+
+    // Dot bits of the two bytes before the current chunk, so a "." or ".."
+    // component that straddles a chunk boundary is still recognised.
+    var dot_carry: u64 = 0;
+
+    var offset: usize = 0;
+    while (offset < path.len) : (offset += path_lanes) {
+        var chunk: [path_lanes]u8 = undefined;
+        const remaining = path.len - offset;
+        if (remaining >= path_lanes) {
+            chunk = path[offset..][0..path_lanes].*;
+        } else {
+            // Pad the tail with a byte that belongs to no class
+            @memset(&chunk, 'a');
+            @memcpy(chunk[0..remaining], path[offset..]);
+        }
+        const v: PathLane = chunk;
 
-    while (it.next()) |component| {
-        if (std.mem.eql(u8, component, "..")) {
-            depth -= 1;
-            if (depth < 0) {
-                return false; // Attempts to escape root
+        const below_space: PathMask = @bitCast(v < @as(PathLane, @splat(0x20)));
+        if (laneMask(v, 0) != 0) result.has_null = true;
+        if (below_space & ~laneMask(v, '\t') != 0) result.has_control = true;
+
+        var separators = laneMask(v, '/');
+        if (options.backslash_is_separator) separators |= laneMask(v, '\\');
+
+        // Bit (i + 2) of the window is the dot bit of byte (offset + i)
+        const window: u64 = (@as(u64, laneMask(v, '.')) << 2) | dot_carry;
+
+        while (separators != 0) {
+            const end = offset + @as(usize, @ctz(separators));
+            separators &= separators - 1;
+
+            const len = end - component_start;
+            var all_dots = false;
+            if (len > 0 and len <= 2) {
+                const bit: u6 = @intCast(component_start + 2 - offset);
+                const want = (@as(u64, 1) << @intCast(len)) - 1;
+                all_dots = (window >> bit) & want == want;
             }
-        } else if (!std.mem.eql(u8, component, ".") and component.len > 0) {
-            depth += 1;
+            stepComponent(&result, &depth, len, all_dots);
+            component_start = end + 1;
         }
+
+        dot_carry = (window >> path_lanes) & 0b11;
     }
 
-    return true;
+    // The last component is terminated by the end of the path
+    const tail = path[component_start..];
+    const tail_dots = tail.len <= 2 and
+        std.mem.allEqual(u8, tail, '.');
+    stepComponent(&result, &depth, tail.len, tail_dots);
+
+    return result;
 }
 
-/// Sanitize path by removing dangerous components
+inline fn stepComponent(result: *PathScan, depth: *i32, len: usize, all_dots: bool) void {
+    if (len == 0 or (all_dots and len == 1)) return;
+    if (all_dots and len == 2) {
+        depth.* -= 1;
+        if (depth.* < 0) result.escapes_root = true;
+    } else {
+        depth.* += 1;
+    }
+}
+
+/// Check if path is safe (no path traversal)
+///
+/// Only '/' separates components here; use `scanPath` directly when
+/// Windows separators must also be honoured.
 ///
 /// Parameters:
-///   - allocator: Memory allocator
-///   - path: Path to sanitize
+///   - path: Path to check
 ///
 /// Returns:
-///   - Sanitized path (caller must free)
-///
-/// Errors:
-///   - error.PathTraversalAttempt: Path contains unsafe traversal
+///   - true if path is safe, false otherwise
 ///
 /// Example:
 /// ```zig
-/// const safe = try sanitizePath(allocator, "./foo/./bar.txt");
-/// defer allocator.free(safe);
-/// // Result: "foo/bar.txt"
+/// try std.testing.expect(isSafePath("foo/bar.txt"));
+/// try std.testing.expect(!isSafePath("../etc/passwd"));
 /// ```
-pub fn sanitizePath(allocator: std.mem.Allocator, path: []const u8) ![]const u8 {
-    if (!isSafePath(path)) {
-        return error.PathTraversalAttempt;
-    }
-
-    var components = std.ArrayList([]const u8).init(allocator);
-    defer components.deinit();
-
-    var it = std.mem.splitScalar(u8, path, '/');
-    while (it.next()) |component| {
-        if (std.mem.eql(u8, component, ".") or component.len == 0) {
-            continue; // Skip "." and empty components
-        } else if (std.mem.eql(u8, component, "..")) {
-            if (components.items.len > 0) {
-                _ = components.pop();
-            }
-        } else {
-            try components.append(component);
-        }
+pub fn isSafePath(path: []const u8) bool {
+    if (std.fs.path.isAbsolute(path)) {
+        return false;
     }
 
-    return try std.mem.join(allocator, "/", components.items);
+    return !scanPath(path, .{ .backslash_is_separator = false }).escapes_root;
 }
 
 /// Calculate checksum for data block
@@ -303,6 +435,31 @@ test "formatTimestamp: specific date" {
     try std.testing.expectEqualStrings("2009-02-13 23:31:30", s);
 }
 
+test "formatSizeBuf: matches allocating variant" {
+    const allocator = std.testing.allocator;
+    var buf: [max_size_len]u8 = undefined;
+
+    for ([_]u64{ 0, 512, 1536, 5 * 1024 * 1024, 3 << 40, std.math.maxInt(u64) }) |bytes| {
+        const s = try formatSize(allocator, bytes);
+        defer allocator.free(s);
+        try std.testing.expectEqualStrings(s, formatSizeBuf(&buf, bytes));
+    }
+}
+
+test "formatTimestampBuf: fixed width and clamped" {
+    var buf: [timestamp_len]u8 = undefined;
+    try std.testing.expectEqualStrings("2009-02-13 23:31:30", formatTimestampBuf(&buf, 1234567890));
+    try std.testing.expectEqualStrings("1970-01-01 00:00:00", formatTimestampBuf(&buf, -5));
+}
+
+test "formatMode: type character and permission bits" {
+    var buf: [10]u8 = undefined;
+    try std.testing.expectEqualStrings("-rw-r--r--", formatMode(&buf, .file, 0o644));
+    try std.testing.expectEqualStrings("drwxr-xr-x", formatMode(&buf, .directory, 0o755));
+    try std.testing.expectEqualStrings("lrwxrwxrwx", formatMode(&buf, .symlink, 0o777));
+    try std.testing.expectEqualStrings("p---------", formatMode(&buf, .fifo, 0));
+}
+
 test "isSafePath: safe paths" {
     try std.testing.expect(isSafePath("foo/bar.txt"));
     try std.testing.expect(isSafePath("./foo/bar.txt"));
@@ -317,40 +474,55 @@ test "isSafePath: unsafe paths" {
     try std.testing.expect(!isSafePath("/absolute/path"));
 }
 
-test "sanitizePath: remove dots and empty components" {
-    const allocator = std.testing.allocator;
+test "scanPath: component boundaries across SIMD chunks" {
+    // ".." straddling a chunk boundary must still be seen as traversal
+    const pad = "a" ** (path_lanes - 2);
+    try std.testing.expect(!scanPath(pad ++ "/../x", .{}).escapes_root);
+    try std.testing.expect(scanPath(pad ++ "/../../x", .{}).escapes_root);
+    try std.testing.expect(!scanPath(pad[1..] ++ "/../x", .{}).escapes_root);
+    try std.testing.expect(scanPath(pad[1..] ++ "/../..", .{}).escapes_root);
+    try std.testing.expect(scanPath("./" ** path_lanes ++ "..", .{}).escapes_root);
 
-    {
-        const s = try sanitizePath(allocator, "./foo/./bar.txt");
-        defer allocator.free(s);
-        try std.testing.expectEqualStrings("foo/bar.txt", s);
-    }
+    // Long components that merely contain dots are ordinary names
+    try std.testing.expect(!scanPath("..." ++ pad ++ "/x", .{}).escapes_root);
 
-    {
-        const s = try sanitizePath(allocator, "foo//bar///baz.txt");
-        defer allocator.free(s);
-        try std.testing.expectEqualStrings("foo/bar/baz.txt", s);
-    }
+    try std.testing.expect(scanPath("a\x00b", .{}).has_null);
+    try std.testing.expect(scanPath(pad ++ "\n", .{}).has_control);
+    try std.testing.expect(!scanPath(pad ++ "\t", .{}).has_control);
 
-    {
-        const s = try sanitizePath(allocator, "foo/bar/../baz.txt");
-        defer allocator.free(s);
-        try std.testing.expectEqualStrings("foo/baz.txt", s);
-    }
+    try std.testing.expect(scanPath("..\\x", .{}).escapes_root);
+    try std.testing.expect(!scanPath("..\\x", .{ .backslash_is_separator = false }).escapes_root);
 }
 
-test "sanitizePath: path traversal error" {
-    const allocator = std.testing.allocator;
-
-    try std.testing.expectError(
-        error.PathTraversalAttempt,
-        sanitizePath(allocator, "../etc/passwd"),
-    );
-
-    try std.testing.expectError(
-        error.PathTraversalAttempt,
-        sanitizePath(allocator, "/absolute/path"),
-    );
+test "isSafePath: matches component-splitting reference" {
+    const reference = struct {
+        fn isSafe(path: []const u8) bool {
+            if (std.fs.path.isAbsolute(path)) return false;
+            var it = std.mem.splitScalar(u8, path, '/');
+            var depth: i32 = 0;
+            while (it.next()) |component| {
+                if (std.mem.eql(u8, component, "..")) {
+                    depth -= 1;
+                    if (depth < 0) return false;
+                } else if (!std.mem.eql(u8, component, ".") and component.len > 0) {
+                    depth += 1;
+                }
+            }
+            return true;
+        }
+    };
+
+    var prng = std.Random.DefaultPrng.init(0x7a617263);
+    const random = prng.random();
+    const alphabet = "..../\\ab";
+
+    var buf: [96]u8 = undefined;
+    for (0..5000) |_| {
+        const len = random.uintAtMost(usize, buf.len);
+        for (buf[0..len]) |*c| c.* = alphabet[random.uintLessThan(usize, alphabet.len)];
+        const path = buf[0..len];
+        try std.testing.expectEqual(reference.isSafe(path), isSafePath(path));
+    }
 }
 
 test "calculateChecksum: simple sum" {
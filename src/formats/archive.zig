@@ -120,6 +120,13 @@ pub const ArchiveReader = struct {
         ///   - error.NoCurrentEntry: No entry is currently being read
         read: *const fn (ptr: *anyopaque, buffer: []u8) anyerror!usize,
 
+        /// Borrow the rest of the current entry's data (optional)
+        ///
+        /// Implemented by readers over in-memory archives. Returns null
+        /// when this reader cannot lend its data, in which case read()
+        /// must be used.
+        readSlice: ?*const fn (ptr: *anyopaque) anyerror!?[]const u8 = null,
+
         /// Clean up resources (does not close the underlying file)
         ///
         /// Parameters:
@@ -174,6 +181,23 @@ pub const ArchiveReader = struct {
         return self.vtable.read(self.ptr, buffer);
     }
 
+    /// Borrow the rest of the current entry's data without copying
+    ///
+    /// Returns:
+    ///   - The unread data of the current entry, or null when the reader
+    ///     is not backed by memory (use read() instead)
+    ///
+    /// Example:
+    /// ```zig
+    /// if (try archive.readSlice()) |data| {
+    ///     hasher.update(data);
+    /// }
+    /// ```
+    pub fn readSlice(self: *ArchiveReader) !?[]const u8 {
+        const readSliceFn = self.vtable.readSlice orelse return null;
+        return readSliceFn(self.ptr);
+    }
+
     /// Clean up resources
     ///
     /// Note: Does not close the underlying file (caller is responsible)
@@ -360,6 +384,8 @@ fn cloneEntry(allocator: std.mem.Allocator, e: types.Entry) !types.Entry {
     out.gname = try cloneSlice(allocator, e.gname);
     errdefer allocator.free(out.gname);
     out.link_target = try cloneSlice(allocator, e.link_target);
+    errdefer allocator.free(out.link_target);
+    out.xattr_records = try cloneSlice(allocator, e.xattr_records);
     return out;
 }
 
@@ -369,6 +395,7 @@ pub fn freeEntry(allocator: std.mem.Allocator, e: types.Entry) void {
     allocator.free(e.uname);
     allocator.free(e.gname);
     allocator.free(e.link_target);
+    allocator.free(e.xattr_records);
 }
 
 /// Free a slice of entries and their string fields
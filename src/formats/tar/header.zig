@@ -118,6 +118,10 @@ pub const TarHeader = struct {
         /// GNU tar extensions
         pub const GNU_LONG_NAME: u8 = 'L';
         pub const GNU_LONG_LINK: u8 = 'K';
+
+        /// POSIX.1-2001 extended headers
+        pub const PAX_EXTENDED: u8 = 'x';
+        pub const PAX_GLOBAL: u8 = 'g';
     };
 
     /// Parse tar header from 512-byte block
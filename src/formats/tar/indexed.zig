@@ -0,0 +1,1303 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Indexed (seekable) compressed TAR
+//!
+//! An indexed archive is an ordinary .tar.gz or .tar.zst whose tar stream
+//! is cut every `frame_size` uncompressed bytes (1 MiB by default) and
+//! compressed piece by piece, one gzip member or Zstandard frame per
+//! piece. gzip and zstd read it as a single stream.
+//!
+//! After the last frame comes an index that decompressors skip: it is
+//! stored in Zstandard skippable frames, or in empty gzip members that
+//! carry it in a 'ZI' extra subfield. It holds a seek table (compressed
+//! and uncompressed size of every frame) and a member table (path, header
+//! offset and data size of every tar member), and ends with a fixed-size
+//! footer unit so that a reader finds it with one read at the end:
+//!
+//! ```
+//! index:  "ZIDX" version:u8 codec:u8 reserved:u16
+//!         frame_count:u32 member_count:u32
+//!         frame_count x (compressed_size:u32 uncompressed_size:u32)
+//!         member_count x (offset:u64 size:u64 path_len:u16 path)
+//!         crc32:u32                          (of everything above)
+//! footer: index_offset:u64 index_size:u32 "ZIDF"
+//! ```
+//!
+//! All integers are little-endian. With the seek table `IndexedReader`
+//! reaches any byte of the tar stream by decoding only the frames that
+//! hold it, and decodes runs of frames on all cores.
+
+const std = @import("std");
+const types = @import("../../core/types.zig");
+const archive = @import("../archive.zig");
+const header = @import("header.zig");
+const reader = @import("reader.zig");
+const gzip = @import("../../compress/gzip.zig");
+const deflate = @import("../../compress/deflate/encode.zig");
+const zstd = @import("../../compress/zstd.zig");
+const c_zlib = @import("../../c_compat/zlib.zig");
+const instrument = @import("../../core/instrument.zig");
+const trace = @import("../../core/trace.zig");
+
+const TarReader = reader.TarReader;
+
+/// Uncompressed bytes per frame unless configured otherwise
+pub const default_frame_size: usize = 1024 * 1024;
+
+const index_magic = "ZIDX";
+const footer_magic = "ZIDF";
+const index_version = 1;
+const index_header_size = 16;
+const frame_record_size = 8;
+const member_record_size = 18;
+const footer_size = 16;
+
+/// Skippable frame magic of Zstandard index units (the one the seekable
+/// Zstandard format uses for its seek table)
+const zstd_unit_magic: u32 = zstd.decode.skippable_magic_base + 0xE;
+
+/// Extra subfield ID of gzip index units
+const gzip_subfield = "ZI";
+
+/// gzip unit bytes before the payload: member header with FEXTRA, XLEN,
+/// subfield ID and subfield length
+const gzip_unit_head = 16;
+
+/// gzip unit bytes after the payload: an empty final deflate block, then
+/// CRC-32 and ISIZE of no data
+const gzip_unit_tail = [_]u8{ 0x03, 0x00 } ++ [_]u8{0} ** 8;
+
+/// Compression of the frames and index units
+pub const Codec = enum(u8) {
+    gzip = 1,
+    zstd = 2,
+
+    /// Bytes a unit adds around its payload
+    fn unitOverhead(self: Codec) usize {
+        return switch (self) {
+            .gzip => gzip_unit_head + gzip_unit_tail.len,
+            .zstd => 8,
+        };
+    }
+
+    /// Largest payload of one unit
+    fn maxUnitPayload(self: Codec) usize {
+        return switch (self) {
+            .gzip => std.math.maxInt(u16) - 4,
+            .zstd => std.math.maxInt(u32),
+        };
+    }
+
+    /// Codec of a file starting with `head`, if it is gzip or Zstandard
+    pub fn detect(head: []const u8) ?Codec {
+        if (head.len >= 2 and std.mem.eql(u8, head[0..2], &gzip.magic_number)) return .gzip;
+        if (head.len >= 4 and std.mem.readInt(u32, head[0..4], .little) == zstd.decode.magic_number) return .zstd;
+        return null;
+    }
+};
+
+/// One independently compressed frame
+pub const Frame = struct {
+    compressed_offset: u64,
+    uncompressed_offset: u64,
+    compressed_size: u32,
+    uncompressed_size: u32,
+};
+
+/// One tar member
+pub const Member = struct {
+    path: []const u8,
+    /// Offset of the member's tar header in the uncompressed stream
+    offset: u64,
+    /// Data size
+    size: u64,
+};
+
+/// Seek table and member table of an indexed archive
+pub const Index = struct {
+    allocator: std.mem.Allocator,
+    codec: Codec,
+    frames: []Frame,
+    members: []Member,
+    /// Backing memory of member paths
+    paths: []u8,
+    /// File offset of the index (the end of the last frame)
+    offset: u64,
+    /// Bytes from `offset` to the end of the file
+    size: u64,
+
+    pub fn deinit(self: *Index) void {
+        self.allocator.free(self.paths);
+        self.allocator.free(self.members);
+        self.allocator.free(self.frames);
+    }
+
+    /// Size of the uncompressed tar stream
+    pub fn uncompressedSize(self: Index) u64 {
+        if (self.frames.len == 0) return 0;
+        const last = self.frames[self.frames.len - 1];
+        return last.uncompressed_offset + last.uncompressed_size;
+    }
+
+    /// Frame holding uncompressed byte `offset` (`frames.len` past the end)
+    pub fn frameAt(self: Index, offset: u64) usize {
+        // First frame starting after offset
+        var lo: usize = 0;
+        var hi: usize = self.frames.len;
+        while (lo < hi) {
+            const mid = lo + (hi - lo) / 2;
+            if (self.frames[mid].uncompressed_offset <= offset) lo = mid + 1 else hi = mid;
+        }
+        if (lo == 0) return self.frames.len;
+        const frame = self.frames[lo - 1];
+        return if (offset < frame.uncompressed_offset + frame.uncompressed_size) lo - 1 else self.frames.len;
+    }
+
+    /// Index of the member with this exact path
+    pub fn find(self: Index, path: []const u8) ?usize {
+        for (self.members, 0..) |member, i| {
+            if (std.mem.eql(u8, member.path, path)) return i;
+        }
+        return null;
+    }
+};
+
+/// Serialize the index body (without units)
+fn encodeIndex(allocator: std.mem.Allocator, codec: Codec, frames: []const Frame, members: []const Member) ![]u8 {
+    var out = std.ArrayList(u8).init(allocator);
+    errdefer out.deinit();
+    const w = out.writer();
+
+    try out.appendSlice(index_magic);
+    try w.writeByte(index_version);
+    try w.writeByte(@intFromEnum(codec));
+    try w.writeInt(u16, 0, .little);
+    try w.writeInt(u32, @intCast(frames.len), .little);
+    try w.writeInt(u32, @intCast(members.len), .little);
+    for (frames) |frame| {
+        try w.writeInt(u32, frame.compressed_size, .little);
+        try w.writeInt(u32, frame.uncompressed_size, .little);
+    }
+    for (members) |member| {
+        try w.writeInt(u64, member.offset, .little);
+        try w.writeInt(u64, member.size, .little);
+        try w.writeInt(u16, @intCast(member.path.len), .little);
+        try out.appendSlice(member.path);
+    }
+    try w.writeInt(u32, std.hash.Crc32.hash(out.items), .little);
+
+    return out.toOwnedSlice();
+}
+
+/// Parse an index body whose frames end at file offset `offset`
+fn parseIndex(allocator: std.mem.Allocator, codec: Codec, data: []const u8, offset: u64) !Index {
+    if (data.len < index_header_size + 4) return error.CorruptedHeader;
+    const body = data[0 .. data.len - 4];
+    if (std.hash.Crc32.hash(body) != std.mem.readInt(u32, data[body.len..][0..4], .little)) return error.CorruptedHeader;
+    if (!std.mem.eql(u8, body[0..4], index_magic)) return error.CorruptedHeader;
+    if (body[4] != index_version) return error.UnsupportedVersion;
+    if (body[5] != @intFromEnum(codec)) return error.CorruptedHeader;
+
+    const frame_count = std.mem.readInt(u32, body[8..12], .little);
+    const member_count = std.mem.readInt(u32, body[12..16], .little);
+    if ((body.len - index_header_size) / frame_record_size < frame_count) return error.CorruptedHeader;
+
+    const frames = try allocator.alloc(Frame, frame_count);
+    errdefer allocator.free(frames);
+
+    var pos: usize = index_header_size;
+    var compressed: u64 = 0;
+    var uncompressed: u64 = 0;
+    for (frames) |*frame| {
+        const compressed_size = std.mem.readInt(u32, body[pos..][0..4], .little);
+        const uncompressed_size = std.mem.readInt(u32, body[pos + 4 ..][0..4], .little);
+        if (compressed_size == 0 or uncompressed_size == 0) return error.CorruptedHeader;
+        frame.* = .{
+            .compressed_offset = compressed,
+            .uncompressed_offset = uncompressed,
+            .compressed_size = compressed_size,
+            .uncompressed_size = uncompressed_size,
+        };
+        compressed += compressed_size;
+        uncompressed += uncompressed_size;
+        pos += frame_record_size;
+    }
+    if (compressed != offset) return error.CorruptedHeader;
+
+    // Member paths point into a copy of the member records
+    const paths = try allocator.dupe(u8, body[pos..]);
+    errdefer allocator.free(paths);
+    if (paths.len / member_record_size < member_count) return error.CorruptedHeader;
+    const members = try allocator.alloc(Member, member_count);
+    errdefer allocator.free(members);
+
+    var at: usize = 0;
+    for (members) |*member| {
+        if (paths.len - at < member_record_size) return error.CorruptedHeader;
+        const member_offset = std.mem.readInt(u64, paths[at..][0..8], .little);
+        const size = std.mem.readInt(u64, paths[at + 8 ..][0..8], .little);
+        const path_len = std.mem.readInt(u16, paths[at + 16 ..][0..2], .little);
+        at += member_record_size;
+
+        if (paths.len - at < path_len) return error.CorruptedHeader;
+        if (member_offset >= uncompressed or size > uncompressed - member_offset) return error.CorruptedHeader;
+        member.* = .{ .path = paths[at..][0..path_len], .offset = member_offset, .size = size };
+        at += path_len;
+    }
+    if (at != paths.len) return error.CorruptedHeader;
+
+    return .{
+        .allocator = allocator,
+        .codec = codec,
+        .frames = frames,
+        .members = members,
+        .paths = paths,
+        .offset = offset,
+        .size = 0,
+    };
+}
+
+/// Append `payload` wrapped in one unit that decompressors skip
+fn appendUnit(out: *std.ArrayList(u8), codec: Codec, payload: []const u8) !void {
+    std.debug.assert(payload.len <= codec.maxUnitPayload());
+    const w = out.writer();
+    switch (codec) {
+        .gzip => {
+            // ID1 ID2 CM FLG(FEXTRA) MTIME(0) XFL OS(unknown)
+            try out.appendSlice(&[_]u8{ 0x1f, 0x8b, gzip.compression_method_deflate, 0x04, 0, 0, 0, 0, 0, 0xff });
+            try w.writeInt(u16, @intCast(payload.len + 4), .little);
+            try out.appendSlice(gzip_subfield);
+            try w.writeInt(u16, @intCast(payload.len), .little);
+            try out.appendSlice(payload);
+            try out.appendSlice(&gzip_unit_tail);
+        },
+        .zstd => {
+            try w.writeInt(u32, zstd_unit_magic, .little);
+            try w.writeInt(u32, @intCast(payload.len), .little);
+            try out.appendSlice(payload);
+        },
+    }
+}
+
+const Unit = struct {
+    payload: []const u8,
+    size: usize,
+};
+
+/// The unit at the start of `data`, if it is a complete index unit
+fn parseUnit(codec: Codec, data: []const u8) ?Unit {
+    switch (codec) {
+        .gzip => {
+            if (data.len < gzip_unit_head) return null;
+            if (!std.mem.eql(u8, data[0..4], &[_]u8{ 0x1f, 0x8b, gzip.compression_method_deflate, 0x04 })) return null;
+            if (!std.mem.eql(u8, data[12..14], gzip_subfield)) return null;
+            const xlen = std.mem.readInt(u16, data[10..12], .little);
+            const len = std.mem.readInt(u16, data[14..16], .little);
+            if (xlen != @as(u32, len) + 4) return null;
+
+            const end = gzip_unit_head + @as(usize, len);
+            const size = end + gzip_unit_tail.len;
+            if (data.len < size) return null;
+            if (!std.mem.eql(u8, data[end..size], &gzip_unit_tail)) return null;
+            return .{ .payload = data[gzip_unit_head..][0..len], .size = size };
+        },
+        .zstd => {
+            if (data.len < 8 or std.mem.readInt(u32, data[0..4], .little) != zstd_unit_magic) return null;
+            const len = std.mem.readInt(u32, data[4..8], .little);
+            if (data.len - 8 < len) return null;
+            return .{ .payload = data[8..][0..len], .size = 8 + @as(usize, len) };
+        },
+    }
+}
+
+const Footer = struct {
+    index_offset: u64,
+    index_size: u32,
+};
+
+/// The footer unit at the end of the file, if there is one
+fn readFooter(file: std.fs.File, codec: Codec, file_size: u64) !?Footer {
+    const unit_size = codec.unitOverhead() + footer_size;
+    if (file_size < unit_size) return null;
+
+    var buf: [gzip_unit_head + gzip_unit_tail.len + footer_size]u8 = undefined;
+    const data = buf[0..unit_size];
+    if (try preadCounted(file, data, file_size - unit_size) != unit_size) return null;
+
+    const unit = parseUnit(codec, data) orelse return null;
+    if (unit.size != unit_size or unit.payload.len != footer_size) return null;
+    if (!std.mem.eql(u8, unit.payload[12..16], footer_magic)) return null;
+    return .{
+        .index_offset = std.mem.readInt(u64, unit.payload[0..8], .little),
+        .index_size = std.mem.readInt(u32, unit.payload[8..12], .little),
+    };
+}
+
+/// Codec of the file if it ends with an index footer
+fn probeCodec(file: std.fs.File) !?Codec {
+    var head: [4]u8 = undefined;
+    const head_len = try preadCounted(file, &head, 0);
+    const codec = Codec.detect(head[0..head_len]) orelse return null;
+    const file_size = (try file.stat()).size;
+    return if (try readFooter(file, codec, file_size) != null) codec else null;
+}
+
+/// Whether a .tar.gz or .tar.zst file carries a seek index
+///
+/// Costs two small positional reads; the file position is unchanged.
+pub fn probe(file: std.fs.File) !bool {
+    return try probeCodec(file) != null;
+}
+
+/// Read the index of an indexed archive
+///
+/// Parameters:
+///   - allocator: Owns the returned index
+///   - file: Archive file (read with positional reads)
+///
+/// Returns:
+///   - The index, or null if the file is not an indexed archive
+///
+/// Errors:
+///   - error.CorruptedHeader: The footer is present but the index is damaged
+///   - error.UnsupportedVersion: Index written by a newer format version
+///   - error.IncompleteArchive: The file ends inside the index
+pub fn readIndex(allocator: std.mem.Allocator, file: std.fs.File) !?Index {
+    var head: [4]u8 = undefined;
+    const head_len = try preadCounted(file, &head, 0);
+    const codec = Codec.detect(head[0..head_len]) orelse return null;
+    const file_size = (try file.stat()).size;
+    const footer = try readFooter(file, codec, file_size) orelse return null;
+
+    const units_end = file_size - (codec.unitOverhead() + footer_size);
+    if (footer.index_offset > units_end) return error.CorruptedHeader;
+    const units = try allocator.alloc(u8, @intCast(units_end - footer.index_offset));
+    defer allocator.free(units);
+    if (try preadCounted(file, units, footer.index_offset) != units.len) return error.IncompleteArchive;
+
+    const data = try allocator.alloc(u8, footer.index_size);
+    defer allocator.free(data);
+    var pos: usize = 0;
+    var len: usize = 0;
+    while (pos < units.len) {
+        const unit = parseUnit(codec, units[pos..]) orelse return error.CorruptedHeader;
+        if (unit.payload.len > data.len - len) return error.CorruptedHeader;
+        @memcpy(data[len..][0..unit.payload.len], unit.payload);
+        len += unit.payload.len;
+        pos += unit.size;
+    }
+    if (len != data.len) return error.CorruptedHeader;
+
+    var index = try parseIndex(allocator, codec, data, footer.index_offset);
+    index.size = file_size - footer.index_offset;
+    return index;
+}
+
+/// Positional read, counted as one read syscall
+fn preadCounted(file: std.fs.File, buffer: []u8, offset: u64) !usize {
+    const span = instrument.begin(.read);
+    defer span.end();
+    const n = try file.preadAll(buffer, offset);
+    instrument.count(.syscalls, 1);
+    instrument.count(.bytes_read, n);
+    return n;
+}
+
+/// Indexed .tar.gz / .tar.zst writer
+///
+/// Produces a tar stream through the ArchiveWriter interface, compresses
+/// it in independent frames of `frame_size` bytes (in parallel when
+/// `threads` > 1) and appends the seek and member index on finalize().
+///
+/// Must not be moved after init (worker threads hold pointers into it).
+///
+/// Example:
+/// ```zig
+/// var writer: IndexedWriter = undefined;
+/// try writer.init(allocator, file, .{ .codec = .zstd, .threads = 0 });
+/// defer writer.deinit();
+///
+/// try writer.addEntry(entry);
+/// _ = try writer.write(data);
+/// try writer.finalize();
+/// ```
+pub const IndexedWriter = struct {
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    options: Options,
+    pool: std.Thread.Pool,
+    threaded: bool,
+
+    /// Tar bytes of the frames being filled (one frame per job)
+    batch: []u8,
+    batch_len: usize = 0,
+    jobs: []Job,
+
+    frames: std.ArrayList(Frame),
+    members: std.ArrayList(Member),
+    /// Member paths
+    paths: std.heap.ArenaAllocator,
+
+    /// Tar bytes produced, tar bytes compressed and compressed bytes written
+    uncompressed_offset: u64 = 0,
+    flushed_offset: u64 = 0,
+    compressed_offset: u64 = 0,
+
+    /// Data size of the current entry and the part not yet written
+    entry_size: u64 = 0,
+    remaining: u64 = 0,
+    has_entry: bool = false,
+    finalized: bool = false,
+
+    pub const Options = struct {
+        codec: Codec = .zstd,
+        /// Uncompressed bytes per frame (below 4 GiB)
+        frame_size: usize = default_frame_size,
+        gzip_level: deflate.CompressionLevel = .default,
+        zstd_level: zstd.Level = .default,
+        /// Compression threads (0 = one per CPU, 1 = compress on the calling thread)
+        threads: usize = 1,
+    };
+
+    /// Compression of one frame
+    const Job = struct {
+        allocator: std.mem.Allocator,
+        codec: Codec,
+        gzip_level: deflate.CompressionLevel,
+        zstd_level: zstd.Level,
+        input: []const u8 = &.{},
+        output: std.ArrayList(u8),
+        /// Created on first use and reused for later frames
+        encoder: ?zstd.Encoder = null,
+        err: ?anyerror = null,
+
+        /// Worker: compress one frame
+        fn run(job: *Job) void {
+            trace.setThreadName("indexed worker");
+            job.compress() catch |err| {
+                job.err = err;
+            };
+        }
+
+        fn compress(job: *Job) !void {
+            job.output.clearRetainingCapacity();
+            switch (job.codec) {
+                .gzip => {
+                    const member = try gzip.compress(job.allocator, job.input, .{ .level = job.gzip_level });
+                    defer job.allocator.free(member);
+                    try job.output.appendSlice(member);
+                },
+                .zstd => {
+                    if (job.encoder == null) job.encoder = try zstd.Encoder.init(job.allocator, job.zstd_level);
+                    try job.encoder.?.compressFrame(job.input, true, &job.output);
+                },
+            }
+        }
+    };
+
+    /// Initialize the writer in place
+    ///
+    /// Parameters:
+    ///   - allocator: Memory allocator for buffers and the index
+    ///   - file: Output file, written sequentially from its current position
+    ///   - options: Codec, frame size, levels and thread count
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate frame buffers
+    ///   - (Errors from spawning pool threads)
+    pub fn init(self: *IndexedWriter, allocator: std.mem.Allocator, file: std.fs.File, options: Options) !void {
+        std.debug.assert(options.frame_size > 0 and options.frame_size < std.math.maxInt(u32));
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+
+        const batch = try allocator.alloc(u8, threads * options.frame_size);
+        errdefer allocator.free(batch);
+        const jobs = try allocator.alloc(Job, threads);
+        errdefer allocator.free(jobs);
+        for (jobs) |*job| {
+            job.* = .{
+                .allocator = allocator,
+                .codec = options.codec,
+                .gzip_level = options.gzip_level,
+                .zstd_level = options.zstd_level,
+                .output = std.ArrayList(u8).init(allocator),
+            };
+        }
+
+        self.* = .{
+            .allocator = allocator,
+            .file = file,
+            .options = options,
+            .pool = undefined,
+            .threaded = threads > 1,
+            .batch = batch,
+            .jobs = jobs,
+            .frames = std.ArrayList(Frame).init(allocator),
+            .members = std.ArrayList(Member).init(allocator),
+            .paths = std.heap.ArenaAllocator.init(allocator),
+        };
+        if (self.threaded) try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+    }
+
+    /// Stop worker threads and free buffers
+    ///
+    /// Note: Does not close the file (caller is responsible)
+    pub fn deinit(self: *IndexedWriter) void {
+        if (self.threaded) self.pool.deinit();
+        for (self.jobs) |*job| {
+            if (job.encoder) |*encoder| encoder.deinit();
+            job.output.deinit();
+        }
+        self.allocator.free(self.jobs);
+        self.allocator.free(self.batch);
+        self.frames.deinit();
+        self.members.deinit();
+        self.paths.deinit();
+    }
+
+    /// Get ArchiveWriter interface
+    pub fn archiveWriter(self: *IndexedWriter) archive.ArchiveWriter {
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .addEntry = addEntryVTable,
+                .write = writeVTable,
+                .finalize = finalizeVTable,
+                .deinit = deinitVTable,
+            },
+        };
+    }
+
+    fn addEntryVTable(ptr: *anyopaque, entry: types.Entry) anyerror!void {
+        const self: *IndexedWriter = @ptrCast(@alignCast(ptr));
+        return self.addEntry(entry);
+    }
+
+    fn writeVTable(ptr: *anyopaque, data: []const u8) anyerror!usize {
+        const self: *IndexedWriter = @ptrCast(@alignCast(ptr));
+        return self.write(data);
+    }
+
+    fn finalizeVTable(ptr: *anyopaque) anyerror!void {
+        const self: *IndexedWriter = @ptrCast(@alignCast(ptr));
+        return self.finalize();
+    }
+
+    fn deinitVTable(ptr: *anyopaque) void {
+        const self: *IndexedWriter = @ptrCast(@alignCast(ptr));
+        self.deinit();
+    }
+
+    /// Start a new entry; its data follows through write()
+    ///
+    /// Errors:
+    ///   - error.IncompleteArchive: The previous entry's data is incomplete
+    ///   - error.InvalidArgument: The archive is already finalized
+    ///   - error.FilenameTooLong: Path does not fit a ustar header
+    pub fn addEntry(self: *IndexedWriter, entry: types.Entry) !void {
+        if (self.finalized) return error.InvalidArgument;
+        if (self.remaining > 0) return error.IncompleteArchive;
+
+        const tar_header = try header.createHeader(&entry, self.allocator);
+        try self.members.append(.{
+            .path = try self.paths.allocator().dupe(u8, entry.path),
+            .offset = self.uncompressed_offset,
+            .size = entry.size,
+        });
+        try self.append(std.mem.asBytes(&tar_header));
+
+        self.has_entry = true;
+        self.entry_size = entry.size;
+        self.remaining = entry.size;
+    }
+
+    /// Write data of the current entry
+    ///
+    /// Returns:
+    ///   - Number of bytes written (all of `data`)
+    ///
+    /// Errors:
+    ///   - error.NoCurrentEntry: No entry was added
+    ///   - error.InvalidArgument: More data than the entry's size
+    pub fn write(self: *IndexedWriter, data: []const u8) !usize {
+        if (!self.has_entry) return error.NoCurrentEntry;
+        if (data.len > self.remaining) return error.InvalidArgument;
+
+        try self.append(data);
+        self.remaining -= data.len;
+        if (self.remaining == 0 and data.len > 0) {
+            const padding = (header.TarHeader.BLOCK_SIZE - self.entry_size % header.TarHeader.BLOCK_SIZE) % header.TarHeader.BLOCK_SIZE;
+            try self.appendZeros(@intCast(padding));
+        }
+        return data.len;
+    }
+
+    /// Write the end-of-archive marker, the last frames and the index
+    ///
+    /// Errors:
+    ///   - error.IncompleteArchive: The last entry's data is incomplete
+    pub fn finalize(self: *IndexedWriter) !void {
+        if (self.finalized) return;
+        if (self.remaining > 0) return error.IncompleteArchive;
+
+        try self.appendZeros(2 * header.TarHeader.BLOCK_SIZE);
+        try self.flush();
+        try self.writeIndex();
+        self.has_entry = false;
+        self.finalized = true;
+    }
+
+    fn append(self: *IndexedWriter, data: []const u8) !void {
+        var rest = data;
+        while (rest.len > 0) {
+            const n = @min(rest.len, self.batch.len - self.batch_len);
+            @memcpy(self.batch[self.batch_len..][0..n], rest[0..n]);
+            self.batch_len += n;
+            self.uncompressed_offset += n;
+            rest = rest[n..];
+            if (self.batch_len == self.batch.len) try self.flush();
+        }
+    }
+
+    fn appendZeros(self: *IndexedWriter, count: usize) !void {
+        const zeros = [_]u8{0} ** header.TarHeader.BLOCK_SIZE;
+        var left = count;
+        while (left > 0) {
+            const n = @min(left, zeros.len);
+            try self.append(zeros[0..n]);
+            left -= n;
+        }
+    }
+
+    /// Compress the buffered frames and write them in order
+    fn flush(self: *IndexedWriter) !void {
+        if (self.batch_len == 0) return;
+
+        const frame_size = self.options.frame_size;
+        const count = (self.batch_len + frame_size - 1) / frame_size;
+        for (self.jobs[0..count], 0..) |*job, i| {
+            job.input = self.batch[i * frame_size .. @min(self.batch_len, (i + 1) * frame_size)];
+            job.err = null;
+        }
+
+        if (self.threaded and count > 1) {
+            var wg: std.Thread.WaitGroup = .{};
+            for (self.jobs[0..count]) |*job| self.pool.spawnWg(&wg, Job.run, .{job});
+            self.pool.waitAndWork(&wg);
+        } else {
+            for (self.jobs[0..count]) |*job| {
+                job.compress() catch |err| {
+                    job.err = err;
+                };
+            }
+        }
+
+        for (self.jobs[0..count]) |*job| {
+            if (job.err) |err| return err;
+            try self.writeOut(job.output.items);
+            try self.frames.append(.{
+                .compressed_offset = self.compressed_offset,
+                .uncompressed_offset = self.flushed_offset,
+                .compressed_size = @intCast(job.output.items.len),
+                .uncompressed_size = @intCast(job.input.len),
+            });
+            self.compressed_offset += job.output.items.len;
+            self.flushed_offset += job.input.len;
+        }
+        self.batch_len = 0;
+    }
+
+    /// Append the index units and the footer unit
+    fn writeIndex(self: *IndexedWriter) !void {
+        const codec = self.options.codec;
+        const data = try encodeIndex(self.allocator, codec, self.frames.items, self.members.items);
+        defer self.allocator.free(data);
+
+        var units = std.ArrayList(u8).init(self.allocator);
+        defer units.deinit();
+
+        var rest: []const u8 = data;
+        while (rest.len > 0) {
+            const n = @min(rest.len, codec.maxUnitPayload());
+            try appendUnit(&units, codec, rest[0..n]);
+            rest = rest[n..];
+        }
+
+        var footer: [footer_size]u8 = undefined;
+        std.mem.writeInt(u64, footer[0..8], self.compressed_offset, .little);
+        std.mem.writeInt(u32, footer[8..12], @intCast(data.len), .little);
+        @memcpy(footer[12..16], footer_magic);
+        try appendUnit(&units, codec, &footer);
+
+        try self.writeOut(units.items);
+        self.compressed_offset += units.items.len;
+    }
+
+    fn writeOut(self: *IndexedWriter, data: []const u8) !void {
+        const span = instrument.begin(.write);
+        defer span.end();
+        try self.file.writeAll(data);
+        instrument.count(.syscalls, 1);
+        instrument.count(.bytes_written, data.len);
+    }
+};
+
+/// Indexed .tar.gz / .tar.zst reader
+///
+/// Reads the archive's index up front, so `members()` and `find()` list
+/// the archive without decompressing it, and `select()` jumps to one
+/// member by decoding only the frames that hold it. Sequential reading
+/// through next() decodes batches of frames on a thread pool.
+///
+/// Example:
+/// ```zig
+/// var reader = try IndexedReader.init(allocator, file, .{});
+/// defer reader.deinit();
+///
+/// const index = reader.find("docs/README.md") orelse return error.FileNotFound;
+/// const entry = try reader.select(index);
+/// const n = try reader.read(&buffer);
+/// ```
+pub const IndexedReader = struct {
+    allocator: std.mem.Allocator,
+
+    /// Heap-allocated: the thread pool and the TarReader hold pointers into it
+    stream: *FrameStream,
+
+    tar_reader: TarReader,
+
+    pub const Options = struct {
+        /// Decoding threads (0 = one per CPU, 1 = decode on the calling thread)
+        threads: usize = 0,
+        /// Frames decoded per batch, per thread
+        frames_per_thread: usize = 4,
+        /// Most compressed or uncompressed bytes per batch (raised to hold the largest frame)
+        batch_size: usize = 64 * 1024 * 1024,
+    };
+
+    /// Open an indexed archive
+    ///
+    /// Errors:
+    ///   - error.InvalidFormat: The file has no index (see `probe`)
+    ///   - error.CorruptedHeader: The index is damaged
+    ///   - error.OutOfMemory: Failed to allocate batch buffers
+    pub fn init(allocator: std.mem.Allocator, file: std.fs.File, options: Options) !IndexedReader {
+        var index = try readIndex(allocator, file) orelse return error.InvalidFormat;
+        const stream = FrameStream.create(allocator, file, index, options) catch |err| {
+            index.deinit();
+            return err;
+        };
+        errdefer stream.destroy();
+
+        return .{
+            .allocator = allocator,
+            .stream = stream,
+            .tar_reader = try stream.tarReader(allocator),
+        };
+    }
+
+    /// Clean up resources
+    ///
+    /// Note: Does not close the file (caller is responsible)
+    pub fn deinit(self: *IndexedReader) void {
+        self.tar_reader.deinit();
+        self.stream.destroy();
+    }
+
+    /// Observe decompression progress (called after every batch)
+    pub fn setObserver(self: *IndexedReader, observer: ?types.StreamObserver) void {
+        self.stream.observer = observer;
+    }
+
+    /// Compressed bytes read so far (the index included)
+    pub fn compressedBytes(self: *const IndexedReader) u64 {
+        return self.stream.compressed_bytes;
+    }
+
+    /// Uncompressed tar bytes decoded so far
+    pub fn uncompressedBytes(self: *const IndexedReader) u64 {
+        return self.stream.uncompressed_bytes;
+    }
+
+    /// Frames decoded so far
+    pub fn framesDecoded(self: *const IndexedReader) u64 {
+        return self.stream.frames_decoded;
+    }
+
+    /// Compression of the archive's frames
+    pub fn codec(self: *const IndexedReader) Codec {
+        return self.stream.index.codec;
+    }
+
+    /// All members, in archive order
+    pub fn members(self: *const IndexedReader) []const Member {
+        return self.stream.index.members;
+    }
+
+    /// Index of the member with this exact path
+    pub fn find(self: *const IndexedReader, path: []const u8) ?usize {
+        return self.stream.index.find(path);
+    }
+
+    /// Get ArchiveReader interface
+    pub fn archiveReader(self: *IndexedReader) archive.ArchiveReader {
+        return self.tar_reader.archiveReader();
+    }
+
+    /// Get the next entry in archive order
+    pub fn next(self: *IndexedReader) !?types.Entry {
+        return self.tar_reader.next();
+    }
+
+    /// Position the reader on one member, for selective extraction
+    ///
+    /// Only the frames from the member's header on are decoded; next()
+    /// continues with the member after it.
+    ///
+    /// Parameters:
+    ///   - index: Member index (see `find`)
+    ///
+    /// Returns:
+    ///   - Entry for the member
+    ///
+    /// Errors:
+    ///   - error.CorruptedHeader: The tar header at the indexed offset does not match the index
+    pub fn select(self: *IndexedReader, index: usize) !types.Entry {
+        const member = self.stream.index.members[index];
+        self.stream.seek(member.offset);
+        self.tar_reader.deinit();
+        self.tar_reader = try self.stream.tarReader(self.allocator);
+
+        const entry = try self.tar_reader.next() orelse return error.CorruptedHeader;
+        if (!std.mem.eql(u8, entry.path, member.path) or entry.size != member.size) return error.CorruptedHeader;
+        return entry;
+    }
+
+    /// Read data of the current entry
+    pub fn read(self: *IndexedReader, buffer: []u8) !usize {
+        return self.tar_reader.read(buffer);
+    }
+};
+
+/// Uncompressed tar stream of an indexed archive, decoded in batches of frames
+const FrameStream = struct {
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    index: Index,
+    pool: std.Thread.Pool,
+    threaded: bool,
+
+    in_buf: []u8,
+    out_buf: []u8,
+    tasks: []Task,
+    decoders: []zstd.decode.BlockDecoder,
+
+    /// Frames [first, first + count) are decoded in `tasks`
+    first: usize = 0,
+    count: usize = 0,
+
+    /// Uncompressed offset of the next byte to read, and its frame
+    position: u64 = 0,
+    frame: usize = 0,
+
+    frames_decoded: u64 = 0,
+    compressed_bytes: u64 = 0,
+    uncompressed_bytes: u64 = 0,
+    observer: ?types.StreamObserver = null,
+
+    const Task = struct {
+        codec: Codec,
+        input: []const u8,
+        output: []u8,
+        decoder: ?*zstd.decode.BlockDecoder,
+        err: ?anyerror = null,
+    };
+
+    /// Allocate the stream; takes ownership of `index` on success
+    fn create(allocator: std.mem.Allocator, file: std.fs.File, index: Index, options: IndexedReader.Options) !*FrameStream {
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+        const batch_frames = @max(1, threads * options.frames_per_thread);
+
+        var max_compressed: usize = 0;
+        var max_uncompressed: usize = 0;
+        for (index.frames) |frame| {
+            max_compressed = @max(max_compressed, frame.compressed_size);
+            max_uncompressed = @max(max_uncompressed, frame.uncompressed_size);
+        }
+
+        const self = try allocator.create(FrameStream);
+        errdefer allocator.destroy(self);
+
+        const in_buf = try allocator.alloc(u8, @max(max_compressed, @min(options.batch_size, max_compressed * batch_frames)));
+        errdefer allocator.free(in_buf);
+        const out_buf = try allocator.alloc(u8, @max(max_uncompressed, @min(options.batch_size, max_uncompressed * batch_frames)));
+        errdefer allocator.free(out_buf);
+        const tasks = try allocator.alloc(Task, batch_frames);
+        errdefer allocator.free(tasks);
+        const decoders = try allocator.alloc(zstd.decode.BlockDecoder, if (index.codec == .zstd) batch_frames else 0);
+        errdefer allocator.free(decoders);
+
+        self.* = .{
+            .allocator = allocator,
+            .file = file,
+            .index = index,
+            .pool = undefined,
+            .threaded = threads > 1,
+            .in_buf = in_buf,
+            .out_buf = out_buf,
+            .tasks = tasks,
+            .decoders = decoders,
+            .compressed_bytes = index.size,
+        };
+        if (self.threaded) try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+        return self;
+    }
+
+    fn destroy(self: *FrameStream) void {
+        const allocator = self.allocator;
+        if (self.threaded) self.pool.deinit();
+        allocator.free(self.decoders);
+        allocator.free(self.tasks);
+        allocator.free(self.out_buf);
+        allocator.free(self.in_buf);
+        self.index.deinit();
+        allocator.destroy(self);
+    }
+
+    fn tarReader(self: *FrameStream, allocator: std.mem.Allocator) !TarReader {
+        const source = std.io.AnyReader{ .context = self, .readFn = readDecoded };
+        return TarReader.initStream(allocator, source, .{ .context = self, .skipFn = skipDecoded });
+    }
+
+    fn readDecoded(context: *const anyopaque, buffer: []u8) anyerror!usize {
+        const self: *FrameStream = @constCast(@ptrCast(@alignCast(context)));
+        return self.read(buffer);
+    }
+
+    /// Skipping is a seek: frames wholly skipped are never decoded
+    fn skipDecoded(context: *anyopaque, count: u64) anyerror!void {
+        const self: *FrameStream = @ptrCast(@alignCast(context));
+        if (count > self.index.uncompressedSize() - self.position) return error.IncompleteArchive;
+        self.seek(self.position + count);
+    }
+
+    /// Move to uncompressed offset `offset`
+    fn seek(self: *FrameStream, offset: u64) void {
+        self.position = offset;
+        self.frame = self.index.frameAt(offset);
+    }
+
+    fn read(self: *FrameStream, dest: []u8) !usize {
+        if (dest.len == 0 or self.frame == self.index.frames.len) return 0;
+        if (self.frame < self.first or self.frame >= self.first + self.count) try self.decodeBatch(self.frame);
+
+        const frame = self.index.frames[self.frame];
+        const output = self.tasks[self.frame - self.first].output;
+        const at: usize = @intCast(self.position - frame.uncompressed_offset);
+        const n = @min(dest.len, output.len - at);
+        @memcpy(dest[0..n], output[at..][0..n]);
+
+        self.position += n;
+        if (at + n == output.len) self.frame += 1;
+        return n;
+    }
+
+    /// Decode frames from `start` until a buffer or the task list is full
+    fn decodeBatch(self: *FrameStream, start: usize) !void {
+        const frames = self.index.frames;
+        var count: usize = 0;
+        var in_used: usize = 0;
+        var out_used: usize = 0;
+
+        while (start + count < frames.len and count < self.tasks.len) {
+            const frame = frames[start + count];
+            if (in_used + frame.compressed_size > self.in_buf.len or
+                out_used + frame.uncompressed_size > self.out_buf.len)
+            {
+                break;
+            }
+            self.tasks[count] = .{
+                .codec = self.index.codec,
+                .input = self.in_buf[in_used..][0..frame.compressed_size],
+                .output = self.out_buf[out_used..][0..frame.uncompressed_size],
+                .decoder = if (self.decoders.len > 0) &self.decoders[count] else null,
+            };
+            in_used += frame.compressed_size;
+            out_used += frame.uncompressed_size;
+            count += 1;
+        }
+
+        // The buffers are invalid until the whole batch has decoded
+        self.count = 0;
+
+        // Frames are contiguous: one read covers the batch
+        if (try preadCounted(self.file, self.in_buf[0..in_used], frames[start].compressed_offset) != in_used) {
+            return error.IncompleteArchive;
+        }
+
+        if (self.threaded and count > 1) {
+            var wg: std.Thread.WaitGroup = .{};
+            for (self.tasks[0..count]) |*task| self.pool.spawnWg(&wg, decodeTask, .{task});
+            self.pool.waitAndWork(&wg);
+        } else {
+            for (self.tasks[0..count]) |*task| {
+                decodeFrame(task) catch |err| {
+                    task.err = err;
+                };
+            }
+        }
+        for (self.tasks[0..count]) |task| {
+            if (task.err) |err| return err;
+        }
+
+        self.first = start;
+        self.count = count;
+        self.frames_decoded += count;
+        self.compressed_bytes += in_used;
+        self.uncompressed_bytes += out_used;
+        if (self.observer) |observer| try observer.observe(self.compressed_bytes, self.uncompressed_bytes);
+    }
+
+    /// Worker: decode one frame
+    fn decodeTask(task: *Task) void {
+        trace.setThreadName("indexed worker");
+        decodeFrame(task) catch |err| {
+            task.err = err;
+        };
+    }
+
+    /// Decode one frame into exactly its output slice
+    fn decodeFrame(task: *Task) !void {
+        const span = instrument.begin(.inflate);
+        defer span.end();
+
+        switch (task.codec) {
+            .zstd => try zstd.decode.decodeFrame(task.decoder.?, task.input, task.output),
+            .gzip => {
+                var inflater = try c_zlib.Inflater.init(.gzip);
+                defer inflater.deinit();
+
+                var consumed: usize = 0;
+                var produced: usize = 0;
+                var spare: [1]u8 = undefined;
+                while (true) {
+                    // Once the output is full, anything but the end of stream is excess data
+                    const dst = if (produced < task.output.len) task.output[produced..] else &spare;
+                    const step = try inflater.step(task.input[consumed..], dst);
+                    consumed += step.consumed;
+                    if (produced == task.output.len and step.produced > 0) return error.CorruptedStream;
+                    produced += step.produced;
+                    if (step.stream_end) break;
+                    if (step.consumed == 0 and step.produced == 0) return error.CorruptedStream;
+                }
+                if (produced != task.output.len or consumed != task.input.len) return error.CorruptedStream;
+            },
+        }
+    }
+};
+
+// Tests
+
+const TestEntry = struct {
+    path: []const u8,
+    data: []const u8 = "",
+    entry_type: types.EntryType = .file,
+};
+
+const test_entries = [_]TestEntry{
+    .{ .path = "docs/", .entry_type = .directory },
+    .{ .path = "docs/a.txt", .data = "indexed archive " ** 700 },
+    .{ .path = "empty" },
+    .{ .path = "docs/b.bin", .data = "0123456789abcdef" ** 1500 },
+    .{ .path = "last.txt", .data = "the end\n" },
+};
+
+fn writeTestArchive(dir: std.fs.Dir, name: []const u8, options: IndexedWriter.Options) !std.fs.File {
+    const file = try dir.createFile(name, .{ .read = true });
+    errdefer file.close();
+
+    var writer: IndexedWriter = undefined;
+    try writer.init(std.testing.allocator, file, options);
+    defer writer.deinit();
+
+    for (test_entries) |e| {
+        try writer.addEntry(.{
+            .path = e.path,
+            .entry_type = e.entry_type,
+            .size = e.data.len,
+            .mode = if (e.entry_type == .directory) 0o755 else 0o644,
+            .mtime = 1700000000,
+        });
+        if (e.data.len > 0) {
+            // Two writes, so entries straddle frame boundaries mid-write
+            _ = try writer.write(e.data[0 .. e.data.len / 2]);
+            _ = try writer.write(e.data[e.data.len / 2 ..]);
+        }
+    }
+    try writer.finalize();
+    return file;
+}
+
+fn readEntryData(tar: anytype, allocator: std.mem.Allocator) ![]u8 {
+    var data = std.ArrayList(u8).init(allocator);
+    errdefer data.deinit();
+    var buffer: [1000]u8 = undefined;
+    while (true) {
+        const n = try tar.read(&buffer);
+        if (n == 0) break;
+        try data.appendSlice(buffer[0..n]);
+    }
+    return data.toOwnedSlice();
+}
+
+test "IndexedWriter/IndexedReader: round trip for both codecs" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    for ([_]Codec{ .gzip, .zstd }) |test_codec| {
+        for ([_]usize{ 1, 2 }) |threads| {
+            const file = try writeTestArchive(tmp_dir.dir, "test.tar", .{ .codec = test_codec, .frame_size = 4096, .threads = threads });
+            defer file.close();
+            try std.testing.expect(try probe(file));
+
+            var tar = try IndexedReader.init(std.testing.allocator, file, .{ .threads = threads, .frames_per_thread = 2 });
+            defer tar.deinit();
+            try std.testing.expectEqual(test_codec, tar.codec());
+            try std.testing.expectEqual(test_entries.len, tar.members().len);
+            try std.testing.expect(tar.stream.index.frames.len > 4);
+
+            for (test_entries) |e| {
+                const entry = (try tar.next()).?;
+                try std.testing.expectEqualStrings(e.path, entry.path);
+                const data = try readEntryData(&tar, std.testing.allocator);
+                defer std.testing.allocator.free(data);
+                try std.testing.expectEqualStrings(e.data, data);
+            }
+            try std.testing.expect((try tar.next()) == null);
+        }
+    }
+}
+
+test "IndexedReader: select decodes only the frames it needs" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const file = try writeTestArchive(tmp_dir.dir, "test.tar.zst", .{ .frame_size = 4096 });
+    defer file.close();
+
+    var tar = try IndexedReader.init(std.testing.allocator, file, .{ .threads = 1, .frames_per_thread = 1 });
+    defer tar.deinit();
+
+    const entry = try tar.select(tar.find("last.txt").?);
+    try std.testing.expectEqual(@as(u64, 8), entry.size);
+    const data = try readEntryData(&tar, std.testing.allocator);
+    defer std.testing.allocator.free(data);
+    try std.testing.expectEqualStrings("the end\n", data);
+    try std.testing.expect(tar.framesDecoded() <= 2);
+
+    // next() continues after the selected member, and earlier members stay reachable
+    try std.testing.expect((try tar.next()) == null);
+    _ = try tar.select(tar.find("docs/a.txt").?);
+    const first = try readEntryData(&tar, std.testing.allocator);
+    defer std.testing.allocator.free(first);
+    try std.testing.expectEqualStrings(test_entries[1].data, first);
+    try std.testing.expect(tar.find("missing") == null);
+}
+
+test "IndexedWriter: output is a plain .tar.gz / .tar.zst" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    {
+        const file = try writeTestArchive(tmp_dir.dir, "plain.tar.gz", .{ .codec = .gzip, .frame_size = 4096 });
+        file.close();
+        const gz_file = try tmp_dir.dir.openFile("plain.tar.gz", .{});
+        defer gz_file.close();
+
+        var tar_gz = try reader.TarGzReader.init(std.testing.allocator, gz_file);
+        defer tar_gz.deinit();
+        var archive_reader = tar_gz.archiveReader();
+        for (test_entries) |e| {
+            try std.testing.expectEqualStrings(e.path, (try archive_reader.next()).?.path);
+        }
+        try std.testing.expect((try archive_reader.next()) == null);
+    }
+
+    {
+        const file = try writeTestArchive(tmp_dir.dir, "plain.tar.zst", .{ .codec = .zstd, .frame_size = 4096 });
+        defer file.close();
+        const compressed = try tmp_dir.dir.readFileAlloc(std.testing.allocator, "plain.tar.zst", 1 << 20);
+        defer std.testing.allocator.free(compressed);
+
+        // The index units are skippable frames
+        const tar_data = try zstd.decompress(std.testing.allocator, compressed);
+        defer std.testing.allocator.free(tar_data);
+        var tar = try IndexedReader.init(std.testing.allocator, file, .{ .threads = 1 });
+        defer tar.deinit();
+        try std.testing.expectEqual(tar.stream.index.uncompressedSize(), tar_data.len);
+    }
+}
+
+test "IndexedReader: damaged index and frames are detected" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    for ([_]Codec{ .gzip, .zstd }) |test_codec| {
+        const file = try writeTestArchive(tmp_dir.dir, "bad.tar", .{ .codec = test_codec, .frame_size = 4096 });
+        defer file.close();
+
+        var index = (try readIndex(std.testing.allocator, file)).?;
+        const first = index.frames[0];
+        const index_offset = index.offset;
+        index.deinit();
+
+        // A flipped byte inside the index fails its CRC-32
+        var byte: [1]u8 = undefined;
+        _ = try file.preadAll(&byte, index_offset + 40);
+        byte[0] ^= 0x40;
+        try file.pwriteAll(&byte, index_offset + 40);
+        try std.testing.expectError(error.CorruptedHeader, IndexedReader.init(std.testing.allocator, file, .{}));
+        byte[0] ^= 0x40;
+        try file.pwriteAll(&byte, index_offset + 40);
+
+        // A flipped checksum byte of the first frame (gzip CRC-32, zstd content checksum)
+        const checksum_at = first.compressed_offset + first.compressed_size - @as(u64, if (test_codec == .gzip) 8 else 4);
+        _ = try file.preadAll(&byte, checksum_at);
+        byte[0] ^= 0x01;
+        try file.pwriteAll(&byte, checksum_at);
+
+        var tar = try IndexedReader.init(std.testing.allocator, file, .{ .threads = 1 });
+        defer tar.deinit();
+        try std.testing.expectError(error.ChecksumMismatch, tar.next());
+    }
+}
+
+test "readIndex: files without an index" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const plain = try gzip.compress(std.testing.allocator, "not an indexed archive", .{});
+    defer std.testing.allocator.free(plain);
+    try tmp_dir.dir.writeFile(.{ .sub_path = "plain.gz", .data = plain });
+    try tmp_dir.dir.writeFile(.{ .sub_path = "text", .data = "plain text" });
+
+    for ([_][]const u8{ "plain.gz", "text" }) |name| {
+        const file = try tmp_dir.dir.openFile(name, .{});
+        defer file.close();
+        try std.testing.expect(!try probe(file));
+        try std.testing.expect((try readIndex(std.testing.allocator, file)) == null);
+        try std.testing.expectError(error.InvalidFormat, IndexedReader.init(std.testing.allocator, file, .{}));
+    }
+}
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! In-memory TAR and TAR.GZ creation
+//!
+//! For callers that already hold the member data in memory (e.g. an RPC
+//! response). The tar size follows from the members alone, so the output
+//! buffer is reserved once: exactly for a tar, and with zlib's deflate
+//! bound for a tar.gz, whose compressed bytes are produced straight into
+//! it without an intermediate tar copy.
+//!
+//! Read the result back without copies with `TarReader.initSlice`.
+
+const std = @import("std");
+const types = @import("../../core/types.zig");
+const header = @import("header.zig");
+const c_zlib = @import("../../c_compat/zlib.zig");
+
+const block_size = header.TarHeader.BLOCK_SIZE;
+const zeros = [_]u8{0} ** (2 * block_size);
+
+/// One archive member and its data
+pub const Member = struct {
+    entry: types.Entry,
+
+    /// Entry data; must be `entry.size` bytes (empty for non-files)
+    data: []const u8 = "",
+};
+
+/// Options for writeTarGz
+pub const GzipOptions = struct {
+    /// Compression level 0-9, or -1 for zlib's default
+    level: i8 = -1,
+};
+
+/// Exact size of the tar archive holding `members`
+///
+/// Errors:
+///   - error.InvalidArgument: A member's data does not match its size
+///   - error.Overflow: The archive does not fit in memory
+pub fn tarSize(members: []const Member) !usize {
+    var size: usize = zeros.len;
+    for (members) |member| {
+        if (member.data.len != member.entry.size) return error.InvalidArgument;
+        const padded = std.mem.alignForward(usize, member.data.len, block_size);
+        size = try std.math.add(usize, size, try std.math.add(usize, block_size, padded));
+    }
+    return size;
+}
+
+/// Append a tar archive of `members` to `out`
+///
+/// `out` grows by one allocation of exactly the archive size. On error
+/// it is left as it was.
+///
+/// Parameters:
+///   - out: Growable output buffer
+///   - members: Entries and their data, in archive order
+///
+/// Errors:
+///   - error.InvalidArgument: A member's data does not match its size
+///   - error.FilenameTooLong: A path does not fit a ustar header
+///   - error.OutOfMemory: Failed to grow `out`
+///
+/// Example:
+/// ```zig
+/// var out = std.ArrayList(u8).init(allocator);
+/// defer out.deinit();
+/// try writeTar(&out, &.{
+///     .{ .entry = .{ .path = "a.txt", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 0 }, .data = "hello" },
+/// });
+/// ```
+pub fn writeTar(out: *std.ArrayList(u8), members: []const Member) !void {
+    try out.ensureTotalCapacityPrecise(try std.math.add(usize, out.items.len, try tarSize(members)));
+    const start = out.items.len;
+    errdefer out.shrinkRetainingCapacity(start);
+
+    for (members) |member| {
+        const tar_header = try header.createHeader(&member.entry, out.allocator);
+        out.appendSliceAssumeCapacity(std.mem.asBytes(&tar_header));
+        out.appendSliceAssumeCapacity(member.data);
+        out.appendSliceAssumeCapacity(zeros[0..padding(member.data.len)]);
+    }
+    out.appendSliceAssumeCapacity(&zeros);
+}
+
+/// Append a gzip-compressed tar archive of `members` to `out`
+///
+/// The tar stream is never materialized: headers and member data are fed
+/// to the deflater, which writes into `out`, reserved up front with the
+/// deflate bound of the tar size.
+///
+/// Parameters:
+///   - out: Growable output buffer
+///   - members: Entries and their data, in archive order
+///   - options: Compression level
+///
+/// Errors:
+///   - error.InvalidArgument: A member's data does not match its size
+///   - error.FilenameTooLong: A path does not fit a ustar header
+///   - error.CompressionFailed: zlib reported an error
+///   - error.OutOfMemory: Failed to grow `out`
+pub fn writeTarGz(out: *std.ArrayList(u8), members: []const Member, options: GzipOptions) !void {
+    const size = try tarSize(members);
+
+    var deflater = try c_zlib.Deflater.init(.gzip, options.level);
+    defer deflater.deinit();
+
+    try out.ensureTotalCapacityPrecise(try std.math.add(usize, out.items.len, deflater.bound(size)));
+    const start = out.items.len;
+    errdefer out.shrinkRetainingCapacity(start);
+
+    var sink = GzipSink{ .deflater = &deflater, .out = out };
+    for (members) |member| {
+        const tar_header = try header.createHeader(&member.entry, out.allocator);
+        try sink.feed(std.mem.asBytes(&tar_header));
+        try sink.feed(member.data);
+        try sink.feed(zeros[0..padding(member.data.len)]);
+    }
+    try sink.feed(&zeros);
+    try sink.finish();
+}
+
+/// Deflates into the unused capacity of an ArrayList
+const GzipSink = struct {
+    deflater: *c_zlib.Deflater,
+    out: *std.ArrayList(u8),
+
+    fn feed(self: *GzipSink, data: []const u8) !void {
+        var rest = data;
+        while (rest.len > 0) {
+            const step = try self.deflater.step(rest, try self.space(), false);
+            self.out.items.len += step.produced;
+            rest = rest[step.consumed..];
+        }
+    }
+
+    fn finish(self: *GzipSink) !void {
+        while (true) {
+            const step = try self.deflater.step("", try self.space(), true);
+            self.out.items.len += step.produced;
+            if (step.stream_end) return;
+        }
+    }
+
+    /// Unused capacity; the bound makes growing a never-taken fallback
+    fn space(self: *GzipSink) ![]u8 {
+        if (self.out.unusedCapacitySlice().len == 0) try self.out.ensureUnusedCapacity(64 * 1024);
+        return self.out.unusedCapacitySlice();
+    }
+};
+
+fn padding(size: usize) usize {
+    return (block_size - size % block_size) % block_size;
+}
+
+// Tests
+
+const TarReader = @import("reader.zig").TarReader;
+
+const test_members = [_]Member{
+    .{ .entry = .{ .path = "docs", .entry_type = .directory, .size = 0, .mode = 0o755, .mtime = 1700000000 } },
+    .{ .entry = .{ .path = "docs/a.txt", .entry_type = .file, .size = 13, .mode = 0o644, .mtime = 1700000000 }, .data = "hello, memory" },
+    .{ .entry = .{ .path = "docs/b.bin", .entry_type = .file, .size = 1024, .mode = 0o644, .mtime = 1700000000 }, .data = "0123456789abcdef" ** 64 },
+};
+
+test "writeTar: one exact allocation, read back without copies" {
+    const allocator = std.testing.allocator;
+
+    var out = std.ArrayList(u8).init(allocator);
+    defer out.deinit();
+    try writeTar(&out, &test_members);
+
+    try std.testing.expectEqual(try tarSize(&test_members), out.items.len);
+    try std.testing.expectEqual(out.items.len, out.capacity);
+
+    var reader = TarReader.initSlice(allocator, out.items);
+    defer reader.deinit();
+
+    for (test_members) |member| {
+        const entry = (try reader.next()).?;
+        try std.testing.expectEqualStrings(member.entry.path, entry.path);
+        const data = try reader.readSlice();
+        try std.testing.expectEqualStrings(member.data, data);
+        // Borrowed from the archive buffer
+        if (data.len > 0) try std.testing.expect(@intFromPtr(data.ptr) >= @intFromPtr(out.items.ptr));
+    }
+    try std.testing.expect((try reader.next()) == null);
+}
+
+test "writeTarGz: decompresses to the same tar" {
+    const allocator = std.testing.allocator;
+
+    var tar_out = std.ArrayList(u8).init(allocator);
+    defer tar_out.deinit();
+    try writeTar(&tar_out, &test_members);
+
+    var gz_out = std.ArrayList(u8).init(allocator);
+    defer gz_out.deinit();
+    try writeTarGz(&gz_out, &test_members, .{});
+    try std.testing.expect(gz_out.items.len < tar_out.items.len);
+
+    const decompressed = try c_zlib.decompress(allocator, .gzip, gz_out.items);
+    defer allocator.free(decompressed);
+    try std.testing.expectEqualSlices(u8, tar_out.items, decompressed);
+}
+
+test "writeTar: size mismatch leaves the buffer unchanged" {
+    var out = std.ArrayList(u8).init(std.testing.allocator);
+    defer out.deinit();
+    try out.appendSlice("prefix");
+
+    const bad = [_]Member{
+        .{ .entry = .{ .path = "x", .entry_type = .file, .size = 10, .mode = 0o644, .mtime = 0 }, .data = "short" },
+    };
+    try std.testing.expectError(error.InvalidArgument, writeTar(&out, &bad));
+    try std.testing.expectError(error.InvalidArgument, writeTarGz(&out, &bad, .{}));
+    try std.testing.expectEqualStrings("prefix", out.items);
+}
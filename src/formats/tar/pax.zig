@@ -0,0 +1,511 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! PAX extended header records (POSIX.1-2001)
+//!
+//! A typeflag 'x' header carries "<length> <keyword>=<value>\n" records
+//! that override fields of the ustar header that follows it. Unlike the
+//! octal header fields, PAX times keep their fractional part, which is
+//! what lets extraction restore nanosecond timestamps.
+//!
+//! Extended attributes ride along as SCHILY.xattr.<name> records and
+//! POSIX ACLs as SCHILY.acl.access/default in acl_to_text form. Readers
+//! only keep those records on the entry; `decodeXattrs` turns them into
+//! xattrs (ACLs as the kernel's system.posix_acl_* values) when
+//! extraction actually restores them.
+
+const std = @import("std");
+const types = @import("../../core/types.zig");
+const header = @import("header.zig");
+
+/// Maximum size of one extended header (same limit as GNU long names)
+pub const max_size: u64 = 16 * 1024 * 1024;
+
+const xattr_prefix = "SCHILY.xattr.";
+const acl_access_keyword = "SCHILY.acl.access";
+const acl_default_keyword = "SCHILY.acl.default";
+
+/// Namespaces an extended attribute may be restored into
+const xattr_namespaces = [_][]const u8{
+    "user.",
+    "trusted.",
+    "security.",
+    "system.posix_acl_access",
+    "system.posix_acl_default",
+};
+
+/// Seconds and nanoseconds since the Unix epoch
+pub const Timestamp = struct {
+    sec: i64,
+    nsec: u32 = 0,
+};
+
+/// Fields overridden by an extended header
+///
+/// Strings borrow from the header data passed to `parse`.
+pub const Overrides = struct {
+    path: ?[]const u8 = null,
+    linkpath: ?[]const u8 = null,
+    size: ?u64 = null,
+    mtime: ?Timestamp = null,
+    atime: ?Timestamp = null,
+    uid: ?u32 = null,
+    gid: ?u32 = null,
+    uname: ?[]const u8 = null,
+    gname: ?[]const u8 = null,
+
+    /// Header data, handed to the entry when it has xattr or ACL records
+    data: []const u8 = "",
+    has_xattrs: bool = false,
+
+    /// Parse the records of an extended header
+    ///
+    /// Unknown keywords are ignored, as POSIX requires.
+    ///
+    /// Parameters:
+    ///   - data: Extended header data (without block padding)
+    ///
+    /// Returns:
+    ///   - Overrides borrowing from `data`
+    ///
+    /// Errors:
+    ///   - error.CorruptedHeader: A record or a known value is malformed
+    pub fn parse(data: []const u8) !Overrides {
+        var overrides = Overrides{ .data = data };
+        var records = RecordIterator{ .data = data };
+        while (try records.next()) |record| {
+            try overrides.set(record.keyword, record.value);
+        }
+        return overrides;
+    }
+
+    fn set(self: *Overrides, keyword: []const u8, value: []const u8) !void {
+        if (std.mem.eql(u8, keyword, "path")) {
+            self.path = value;
+        } else if (std.mem.eql(u8, keyword, "linkpath")) {
+            self.linkpath = value;
+        } else if (std.mem.eql(u8, keyword, "size")) {
+            self.size = try parseDecimal(u64, value);
+        } else if (std.mem.eql(u8, keyword, "mtime")) {
+            self.mtime = try parseTimestamp(value);
+        } else if (std.mem.eql(u8, keyword, "atime")) {
+            self.atime = try parseTimestamp(value);
+        } else if (std.mem.eql(u8, keyword, "uid")) {
+            self.uid = try parseDecimal(u32, value);
+        } else if (std.mem.eql(u8, keyword, "gid")) {
+            self.gid = try parseDecimal(u32, value);
+        } else if (std.mem.eql(u8, keyword, "uname")) {
+            self.uname = value;
+        } else if (std.mem.eql(u8, keyword, "gname")) {
+            self.gname = value;
+        } else if (std.mem.startsWith(u8, keyword, xattr_prefix) or
+            std.mem.eql(u8, keyword, acl_access_keyword) or
+            std.mem.eql(u8, keyword, acl_default_keyword))
+        {
+            self.has_xattrs = true;
+        }
+    }
+
+    /// Apply the overrides to the entry built from the following header
+    ///
+    /// Strings are copied into `allocator` so the header data can be reused,
+    /// except `entry.xattr_records`: those borrow the header data, which
+    /// must stay valid as long as the entry.
+    pub fn apply(self: Overrides, allocator: std.mem.Allocator, entry: *types.Entry) !void {
+        if (self.path) |path| entry.path = try allocator.dupe(u8, path);
+        if (self.linkpath) |link| entry.link_target = try allocator.dupe(u8, link);
+        if (self.uname) |uname| entry.uname = try allocator.dupe(u8, uname);
+        if (self.gname) |gname| entry.gname = try allocator.dupe(u8, gname);
+        if (self.size) |size| entry.size = size;
+        if (self.uid) |uid| entry.uid = uid;
+        if (self.gid) |gid| entry.gid = gid;
+        if (self.mtime) |mtime| {
+            entry.mtime = mtime.sec;
+            entry.mtime_nsec = mtime.nsec;
+        }
+        if (self.atime) |atime| {
+            entry.atime = atime.sec;
+            entry.atime_nsec = atime.nsec;
+        }
+        if (self.has_xattrs) entry.xattr_records = self.data;
+    }
+};
+
+/// Decode the xattr and ACL records kept on an entry
+///
+/// Attributes outside the namespaces Linux accepts are skipped. An ACL
+/// that is malformed, or names users or groups without a numeric id, is
+/// dropped with a warning; the entry's other attributes are still kept.
+///
+/// Parameters:
+///   - allocator: Receives the list, names and values
+///   - records: `Entry.xattr_records` (PAX extended header data)
+///
+/// Returns:
+///   - Extended attributes, with POSIX ACLs as system.posix_acl_* values
+///
+/// Errors:
+///   - error.CorruptedHeader: The records themselves are malformed
+///   - error.OutOfMemory: Allocation failed
+pub fn decodeXattrs(allocator: std.mem.Allocator, records: []const u8) ![]const types.Xattr {
+    var xattrs = std.ArrayList(types.Xattr).init(allocator);
+    errdefer xattrs.deinit();
+
+    var it = RecordIterator{ .data = records };
+    while (try it.next()) |record| {
+        if (std.mem.startsWith(u8, record.keyword, xattr_prefix)) {
+            const name = record.keyword[xattr_prefix.len..];
+            if (!xattrAllowed(name)) continue;
+            try xattrs.append(.{
+                .name = try allocator.dupe(u8, name),
+                .value = try allocator.dupe(u8, record.value),
+            });
+            continue;
+        }
+
+        const name = if (std.mem.eql(u8, record.keyword, acl_access_keyword))
+            "system.posix_acl_access"
+        else if (std.mem.eql(u8, record.keyword, acl_default_keyword))
+            "system.posix_acl_default"
+        else
+            continue;
+        const value = encodeAcl(allocator, record.value) catch |err| switch (err) {
+            error.CorruptedHeader => {
+                std.log.warn("Dropping malformed ACL: {s}", .{record.value});
+                continue;
+            },
+            else => |e| return e,
+        } orelse {
+            std.log.warn("Dropping ACL with unresolvable names: {s}", .{record.value});
+            continue;
+        };
+        try xattrs.append(.{ .name = name, .value = value });
+    }
+    return xattrs.toOwnedSlice();
+}
+
+fn xattrAllowed(name: []const u8) bool {
+    if (std.mem.indexOfScalar(u8, name, 0) != null) return false;
+    for (xattr_namespaces) |namespace| {
+        const is_prefix = namespace[namespace.len - 1] == '.';
+        if (is_prefix and name.len > namespace.len and std.mem.startsWith(u8, name, namespace)) return true;
+        if (!is_prefix and std.mem.eql(u8, name, namespace)) return true;
+    }
+    return false;
+}
+
+/// ACL entry tags (linux/posix_acl.h)
+const AclTag = struct {
+    const user_obj: u16 = 0x01;
+    const user: u16 = 0x02;
+    const group_obj: u16 = 0x04;
+    const group: u16 = 0x08;
+    const mask: u16 = 0x10;
+    const other: u16 = 0x20;
+};
+
+const acl_xattr_version: u32 = 2;
+const acl_undefined_id: u32 = std.math.maxInt(u32);
+
+const AclEntry = struct {
+    tag: u16,
+    perm: u16,
+    id: u32,
+
+    fn lessThan(_: void, a: AclEntry, b: AclEntry) bool {
+        return if (a.tag != b.tag) a.tag < b.tag else a.id < b.id;
+    }
+};
+
+/// Encode a textual POSIX ACL as a system.posix_acl_* xattr value
+///
+/// Accepts the acl_to_text forms tar writers emit: entries separated by
+/// ',' or newlines, "tag:qualifier:perms" with long or short tag names,
+/// "#" comments, and star's trailing numeric ":<id>" field.
+///
+/// Returns:
+///   - Kernel ACL value (little-endian header and sorted entries), or
+///     null when a qualifier is a name without a numeric id, which cannot
+///     be resolved without the password database
+///
+/// Errors:
+///   - error.CorruptedHeader: Malformed ACL text
+///   - error.OutOfMemory: Allocation failed
+pub fn encodeAcl(allocator: std.mem.Allocator, text: []const u8) !?[]u8 {
+    var entries = std.ArrayList(AclEntry).init(allocator);
+    defer entries.deinit();
+
+    var specs = std.mem.tokenizeAny(u8, text, ",\n");
+    while (specs.next()) |raw| {
+        const uncommented = raw[0 .. std.mem.indexOfScalar(u8, raw, '#') orelse raw.len];
+        const spec = std.mem.trim(u8, uncommented, " \t");
+        if (spec.len == 0) continue;
+
+        var fields = std.mem.splitScalar(u8, spec, ':');
+        const tag_name = fields.next().?;
+        const qualifier = fields.next() orelse return error.CorruptedHeader;
+        const perms = fields.next() orelse return error.CorruptedHeader;
+        const numeric_id = fields.next();
+
+        var entry = AclEntry{ .tag = 0, .perm = 0, .id = acl_undefined_id };
+        if (std.mem.eql(u8, tag_name, "user") or std.mem.eql(u8, tag_name, "u")) {
+            entry.tag = if (qualifier.len == 0) AclTag.user_obj else AclTag.user;
+        } else if (std.mem.eql(u8, tag_name, "group") or std.mem.eql(u8, tag_name, "g")) {
+            entry.tag = if (qualifier.len == 0) AclTag.group_obj else AclTag.group;
+        } else if (std.mem.eql(u8, tag_name, "mask") or std.mem.eql(u8, tag_name, "m")) {
+            entry.tag = AclTag.mask;
+        } else if (std.mem.eql(u8, tag_name, "other") or std.mem.eql(u8, tag_name, "o")) {
+            entry.tag = AclTag.other;
+        } else {
+            return error.CorruptedHeader;
+        }
+
+        if (entry.tag == AclTag.user or entry.tag == AclTag.group) {
+            const id_text = numeric_id orelse qualifier;
+            entry.id = std.fmt.parseInt(u32, id_text, 10) catch return null;
+        }
+
+        for (perms) |c| {
+            entry.perm |= switch (c) {
+                'r' => 4,
+                'w' => 2,
+                'x' => 1,
+                '-' => 0,
+                else => return error.CorruptedHeader,
+            };
+        }
+        try entries.append(entry);
+    }
+
+    // The kernel requires entries ordered by tag, then id
+    std.mem.sort(AclEntry, entries.items, {}, AclEntry.lessThan);
+
+    const value = try allocator.alloc(u8, 4 + 8 * entries.items.len);
+    std.mem.writeInt(u32, value[0..4], acl_xattr_version, .little);
+    for (entries.items, 0..) |entry, i| {
+        const out = value[4 + 8 * i ..][0..8];
+        std.mem.writeInt(u16, out[0..2], entry.tag, .little);
+        std.mem.writeInt(u16, out[2..4], entry.perm, .little);
+        std.mem.writeInt(u32, out[4..8], entry.id, .little);
+    }
+    return value;
+}
+
+/// One "<keyword>=<value>" record
+pub const Record = struct {
+    keyword: []const u8,
+    value: []const u8,
+};
+
+/// Iterates the records of an extended header
+pub const RecordIterator = struct {
+    data: []const u8,
+    pos: usize = 0,
+
+    /// Next record, or null at the end of the data
+    ///
+    /// Errors:
+    ///   - error.CorruptedHeader: Bad length prefix or record layout
+    pub fn next(self: *RecordIterator) !?Record {
+        const rest = self.data[self.pos..];
+        // Some writers pad the data with NULs
+        if (rest.len == 0 or rest[0] == 0) return null;
+
+        const space = std.mem.indexOfScalar(u8, rest, ' ') orelse return error.CorruptedHeader;
+        const len = std.fmt.parseInt(usize, rest[0..space], 10) catch return error.CorruptedHeader;
+        if (len <= space + 1 or len > rest.len or rest[len - 1] != '\n') return error.CorruptedHeader;
+
+        const body = rest[space + 1 .. len - 1];
+        const eq = std.mem.indexOfScalar(u8, body, '=') orelse return error.CorruptedHeader;
+        if (eq == 0) return error.CorruptedHeader;
+
+        self.pos += len;
+        return .{ .keyword = body[0..eq], .value = body[eq + 1 ..] };
+    }
+};
+
+/// Parse a PAX time value ("1700000000.123456789", optionally negative)
+///
+/// Digits past nanosecond precision are truncated.
+///
+/// Errors:
+///   - error.CorruptedHeader: Not a decimal number
+pub fn parseTimestamp(value: []const u8) !Timestamp {
+    const negative = value.len > 0 and value[0] == '-';
+    const digits = if (negative) value[1..] else value;
+
+    const dot = std.mem.indexOfScalar(u8, digits, '.') orelse digits.len;
+    const whole = try parseDecimal(i64, digits[0..dot]);
+
+    var nsec: u32 = 0;
+    if (dot < digits.len) {
+        const fraction = digits[dot + 1 ..];
+        var scale: u32 = std.time.ns_per_s / 10;
+        for (fraction) |c| {
+            if (c < '0' or c > '9') return error.CorruptedHeader;
+            nsec += (c - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    if (!negative) return .{ .sec = whole, .nsec = nsec };
+    // -1.25 is 1.25 seconds before the epoch: sec = -2, nsec = 0.75 s
+    if (nsec == 0) return .{ .sec = -whole };
+    return .{ .sec = -whole - 1, .nsec = std.time.ns_per_s - nsec };
+}
+
+/// Append a typeflag 'x' header and its padded records to `out`
+///
+/// Parameters:
+///   - out: Tar stream being built
+///   - records: Encoded records ("<length> <keyword>=<value>\n" ...)
+///
+/// Errors:
+///   - error.OutOfMemory: Failed to grow `out`
+pub fn appendExtendedHeader(out: *std.ArrayList(u8), records: []const u8) !void {
+    const block_size = header.TarHeader.BLOCK_SIZE;
+    const meta = types.Entry{
+        .path = "././@PaxHeader",
+        .entry_type = .file,
+        .size = records.len,
+        .mode = 0o644,
+        .mtime = 0,
+    };
+    var ext = try header.createHeader(&meta, out.allocator);
+    ext.typeflag = header.TarHeader.TypeFlag.PAX_EXTENDED;
+    const checksum = header.calculateChecksum(std.mem.asBytes(&ext));
+    _ = std.fmt.bufPrint(ext.checksum[0..7], "{o:0>6}\x00", .{checksum}) catch unreachable;
+    ext.checksum[7] = ' ';
+
+    try out.appendSlice(std.mem.asBytes(&ext));
+    try out.appendSlice(records);
+    try out.appendNTimes(0, (block_size - records.len % block_size) % block_size);
+}
+
+fn parseDecimal(comptime T: type, value: []const u8) !T {
+    if (value.len == 0) return error.CorruptedHeader;
+    for (value) |c| {
+        if (c < '0' or c > '9') return error.CorruptedHeader;
+    }
+    return std.fmt.parseInt(T, value, 10) catch error.CorruptedHeader;
+}
+
+// Tests
+
+test "Overrides.parse: path, size and sub-second times" {
+    const data = "30 mtime=1700000000.123456789\n" ++
+        "20 atime=1699999999\n" ++
+        "32 path=some/very/long/name.txt\n" ++
+        "13 size=4096\n" ++
+        "28 SCHILY.dev=ignored-value\n";
+    const overrides = try Overrides.parse(data);
+
+    try std.testing.expectEqualStrings("some/very/long/name.txt", overrides.path.?);
+    try std.testing.expectEqual(@as(u64, 4096), overrides.size.?);
+    try std.testing.expectEqual(Timestamp{ .sec = 1700000000, .nsec = 123456789 }, overrides.mtime.?);
+    try std.testing.expectEqual(Timestamp{ .sec = 1699999999 }, overrides.atime.?);
+    try std.testing.expect(overrides.uid == null);
+
+    var entry = types.Entry{ .path = "short", .entry_type = .file, .size = 0, .mode = 0o644, .mtime = 1 };
+    var arena = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena.deinit();
+    try overrides.apply(arena.allocator(), &entry);
+    try std.testing.expectEqualStrings("some/very/long/name.txt", entry.path);
+    try std.testing.expectEqual(@as(i64, 1700000000), entry.mtime);
+    try std.testing.expectEqual(@as(u32, 123456789), entry.mtime_nsec);
+    try std.testing.expectEqual(@as(?i64, 1699999999), entry.atime);
+}
+
+test "parseTimestamp: fractions and negative times" {
+    try std.testing.expectEqual(Timestamp{ .sec = 5, .nsec = 500000000 }, try parseTimestamp("5.5"));
+    try std.testing.expectEqual(Timestamp{ .sec = 1, .nsec = 123456789 }, try parseTimestamp("1.1234567891"));
+    try std.testing.expectEqual(Timestamp{ .sec = -2, .nsec = 750000000 }, try parseTimestamp("-1.25"));
+    try std.testing.expectEqual(Timestamp{ .sec = -3 }, try parseTimestamp("-3"));
+    try std.testing.expectError(error.CorruptedHeader, parseTimestamp("12x"));
+    try std.testing.expectError(error.CorruptedHeader, parseTimestamp(""));
+}
+
+test "RecordIterator: rejects bad lengths" {
+    try std.testing.expectError(error.CorruptedHeader, Overrides.parse("99 path=x\n"));
+    try std.testing.expectError(error.CorruptedHeader, Overrides.parse("8 path=x\n"));
+    try std.testing.expectError(error.CorruptedHeader, Overrides.parse("path=x\n"));
+    // Trailing NUL padding is accepted
+    const overrides = try Overrides.parse("11 path=ab\n\x00\x00");
+    try std.testing.expectEqualStrings("ab", overrides.path.?);
+}
+
+test "Overrides.apply: xattrs and ACLs" {
+    const data = "42 SCHILY.xattr.user.mime_type=text/plain\n" ++
+        "41 SCHILY.xattr.security.capability=\x01\x00\x00\x02\n" ++
+        "39 SCHILY.xattr.com.apple.quarantine=x\n" ++
+        "83 SCHILY.acl.access=user::rw-,user:alice:r--:1001,group::r--,mask::r--,other::---\n";
+    const overrides = try Overrides.parse(data);
+    try std.testing.expect(overrides.has_xattrs);
+
+    var entry = types.Entry{ .path = "f", .entry_type = .file, .size = 0, .mode = 0o640, .mtime = 1 };
+    var arena = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena.deinit();
+    try overrides.apply(arena.allocator(), &entry);
+
+    // The records are kept as they are; nothing is decoded yet
+    try std.testing.expectEqual(data.ptr, entry.xattr_records.ptr);
+
+    const xattrs = try decodeXattrs(arena.allocator(), entry.xattr_records);
+
+    // com.apple.* is outside the namespaces Linux accepts and is dropped
+    try std.testing.expectEqual(@as(usize, 3), xattrs.len);
+    try std.testing.expectEqualStrings("user.mime_type", xattrs[0].name);
+    try std.testing.expectEqualStrings("text/plain", xattrs[0].value);
+    try std.testing.expectEqualStrings("security.capability", xattrs[1].name);
+    try std.testing.expectEqualSlices(u8, "\x01\x00\x00\x02", xattrs[1].value);
+    try std.testing.expectEqualStrings("system.posix_acl_access", xattrs[2].name);
+    try std.testing.expectEqual(@as(usize, 4 + 8 * 5), xattrs[2].value.len);
+}
+
+test "decodeXattrs: a malformed ACL is dropped, not fatal" {
+    const data = "27 SCHILY.xattr.user.a=one\n" ++
+        "32 SCHILY.acl.access=bogus::rw-\n" ++
+        "27 SCHILY.xattr.user.b=two\n";
+
+    // Listing and verifying never decode the records
+    var entry = types.Entry{ .path = "f", .entry_type = .file, .size = 0, .mode = 0o640, .mtime = 1 };
+    try (try Overrides.parse(data)).apply(std.testing.allocator, &entry);
+
+    var arena = std.heap.ArenaAllocator.init(std.testing.allocator);
+    defer arena.deinit();
+    const xattrs = try decodeXattrs(arena.allocator(), entry.xattr_records);
+    try std.testing.expectEqual(@as(usize, 2), xattrs.len);
+    try std.testing.expectEqualStrings("user.a", xattrs[0].name);
+    try std.testing.expectEqualStrings("user.b", xattrs[1].name);
+}
+
+test "encodeAcl: kernel layout and ordering" {
+    const allocator = std.testing.allocator;
+
+    const value = (try encodeAcl(allocator, "other::r--\ngroup::r-x\nuser:1000:rw-\nuser::rwx\nmask::rwx # comment\n")).?;
+    defer allocator.free(value);
+    const expected = "\x02\x00\x00\x00" ++
+        "\x01\x00\x07\x00\xff\xff\xff\xff" ++ // user::rwx
+        "\x02\x00\x06\x00\xe8\x03\x00\x00" ++ // user:1000:rw-
+        "\x04\x00\x05\x00\xff\xff\xff\xff" ++ // group::r-x
+        "\x10\x00\x07\x00\xff\xff\xff\xff" ++ // mask::rwx
+        "\x20\x00\x04\x00\xff\xff\xff\xff"; // other::r--
+    try std.testing.expectEqualSlices(u8, expected, value);
+
+    // Names without a numeric id cannot be resolved
+    try std.testing.expect((try encodeAcl(allocator, "user::rw-,user:alice:r--")) == null);
+    try std.testing.expectError(error.CorruptedHeader, encodeAcl(allocator, "bogus::rw-"));
+    try std.testing.expectError(error.CorruptedHeader, encodeAcl(allocator, "user::rwz"));
+}
@@ -0,0 +1,594 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! Push-based (non-blocking) TAR and TAR.GZ parser
+//!
+//! `TarReader` pulls bytes from a file or reader and blocks until they
+//! arrive. `PushParser` inverts that: the caller hands over whatever
+//! bytes it has (from epoll, io_uring, a socket callback, ...) and pulls
+//! events until the parser runs dry. No call ever blocks or performs
+//! I/O, and all state lives in the parser, so one thread can drive any
+//! number of archives.
+//!
+//! ```
+//! feed(bytes) ──> next() ──> .entry  (header parsed)
+//!                        ──> .data   (chunk of the current entry)
+//!                        ──> .end    (end-of-archive marker)
+//!                        ──> null    (needs more input)
+//! ```
+//!
+//! Data events borrow from the fed bytes (plain tar) or from the
+//! parser's inflate buffer (tar.gz), so nothing is copied twice.
+
+const std = @import("std");
+const types = @import("../../core/types.zig");
+const header = @import("header.zig");
+const pax = @import("pax.zig");
+const c_zlib = @import("../../c_compat/zlib.zig");
+
+const TarHeader = header.TarHeader;
+const block_size = TarHeader.BLOCK_SIZE;
+
+/// Something the parser found in the bytes fed so far
+pub const Event = union(enum) {
+    /// Next entry; its data follows as `.data` events. Strings stay
+    /// valid until the next `.entry` or `.end` event.
+    entry: types.Entry,
+
+    /// Piece of the current entry's data, valid until the next call
+    data: []const u8,
+
+    /// End of the archive; later calls return null
+    end,
+};
+
+/// Resumable TAR / TAR.GZ parser driven by the caller's input
+///
+/// Example:
+/// ```zig
+/// var parser = try PushParser.init(allocator, .{ .compression = .gzip });
+/// defer parser.deinit();
+///
+/// // Whenever the socket is readable:
+/// parser.feed(received);
+/// while (try parser.next()) |event| switch (event) {
+///     .entry => |entry| startUpload(entry.path),
+///     .data => |chunk| appendUpload(chunk),
+///     .end => finishUploads(),
+/// };
+/// // On EOF: parser.finish(), then drain next() once more
+/// ```
+pub const PushParser = struct {
+    allocator: std.mem.Allocator,
+    state: State = .header,
+
+    /// Caller bytes not consumed yet (borrowed until the next feed)
+    input: []const u8 = &.{},
+    input_ended: bool = false,
+
+    /// Header block being assembled across feeds
+    block: [block_size]u8 = undefined,
+    block_len: usize = 0,
+
+    /// Bytes left in the current data, padding or extension section
+    remaining: u64 = 0,
+    /// Data size of the current entry (for its padding)
+    entry_size: u64 = 0,
+
+    /// GNU long name/link being read, and the ones waiting for their entry
+    extension: Extension = .name,
+    gnu_long_name: std.ArrayListUnmanaged(u8) = .{},
+    gnu_long_link: std.ArrayListUnmanaged(u8) = .{},
+    has_long_name: bool = false,
+    has_long_link: bool = false,
+
+    /// PAX extended header records waiting for their entry
+    pax_data: std.ArrayListUnmanaged(u8) = .{},
+    has_pax: bool = false,
+
+    /// Strings of the current entry
+    entry_arena: std.heap.ArenaAllocator,
+
+    gzip: ?Gzip = null,
+
+    /// Same limit as TarReader
+    const max_gnu_extension_size: u64 = 16 * 1024 * 1024;
+
+    pub const Compression = enum { none, gzip };
+
+    pub const Options = struct {
+        compression: Compression = .none,
+        /// Inflate output buffer (tar.gz only)
+        buffer_size: usize = types.BufferSize.default,
+    };
+
+    const State = enum { header, extension, data, padding, end_block, done };
+
+    const Extension = enum { name, link, pax };
+
+    /// Inflated bytes waiting to be parsed
+    const Gzip = struct {
+        inflater: c_zlib.Inflater,
+        buffer: []u8,
+        start: usize = 0,
+        end: usize = 0,
+        /// The current gzip member is complete
+        member_done: bool = false,
+        /// zlib may hold output that did not fit the last step
+        pending: bool = false,
+    };
+
+    /// Create a parser
+    ///
+    /// Parameters:
+    ///   - allocator: Memory allocator (entry strings, inflate buffer)
+    ///   - options: Compression of the input and inflate buffer size
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate the inflate state
+    pub fn init(allocator: std.mem.Allocator, options: Options) !PushParser {
+        var self = PushParser{
+            .allocator = allocator,
+            .entry_arena = std.heap.ArenaAllocator.init(allocator),
+        };
+        if (options.compression == .gzip) {
+            std.debug.assert(options.buffer_size > 0);
+            var inflater = try c_zlib.Inflater.init(.gzip);
+            errdefer inflater.deinit();
+            self.gzip = .{
+                .inflater = inflater,
+                .buffer = try allocator.alloc(u8, options.buffer_size),
+            };
+        }
+        return self;
+    }
+
+    /// Free parser state
+    pub fn deinit(self: *PushParser) void {
+        if (self.gzip) |*gz| {
+            gz.inflater.deinit();
+            self.allocator.free(gz.buffer);
+        }
+        self.gnu_long_name.deinit(self.allocator);
+        self.gnu_long_link.deinit(self.allocator);
+        self.pax_data.deinit(self.allocator);
+        self.entry_arena.deinit();
+    }
+
+    /// Hand over the next input bytes
+    ///
+    /// `bytes` must stay valid until next() returns null; any bytes of a
+    /// previous feed must have been consumed by then (next() returned null).
+    /// Bytes fed after the end of the archive are ignored.
+    pub fn feed(self: *PushParser, bytes: []const u8) void {
+        std.debug.assert(self.input.len == 0 or self.state == .done);
+        self.input = bytes;
+    }
+
+    /// Declare the end of the input
+    ///
+    /// After this, next() reports `.end` for an archive that simply stops
+    /// at an entry boundary, and error.IncompleteArchive for a truncated one.
+    pub fn finish(self: *PushParser) void {
+        self.input_ended = true;
+    }
+
+    /// The archive's end marker was seen
+    pub fn isDone(self: *const PushParser) bool {
+        return self.state == .done;
+    }
+
+    /// Produce the next event from the input fed so far
+    ///
+    /// Returns:
+    ///   - An event, or null when more input is needed (or after `.end`)
+    ///
+    /// Errors:
+    ///   - error.CorruptedHeader: Invalid header or end marker
+    ///   - error.IncompleteArchive: Input ended inside the archive
+    ///   - error.ChecksumMismatch, error.DecompressionFailed: Bad gzip data
+    ///   - error.OutOfMemory: Failed to store entry strings
+    pub fn next(self: *PushParser) !?Event {
+        while (true) {
+            switch (self.state) {
+                .done => return null,
+                .header, .end_block => {
+                    if (!try self.fillBlock()) return self.starved();
+                    if (self.state == .end_block) {
+                        if (!isZeroBlock(&self.block)) return error.CorruptedHeader;
+                        return self.end();
+                    }
+                    if (isZeroBlock(&self.block)) {
+                        self.state = .end_block;
+                        continue;
+                    }
+                    if (try self.startEntry()) |entry| return .{ .entry = entry };
+                },
+                .extension => {
+                    const list = switch (self.extension) {
+                        .name => &self.gnu_long_name,
+                        .link => &self.gnu_long_link,
+                        .pax => &self.pax_data,
+                    };
+                    while (self.remaining > 0) {
+                        const avail = try self.available();
+                        if (avail.len == 0) return self.starved();
+                        const n: usize = @intCast(@min(self.remaining, avail.len));
+                        try list.appendSlice(self.allocator, avail[0..n]);
+                        self.consume(n);
+                        self.remaining -= n;
+                    }
+                    // Drop the terminating NUL of GNU names
+                    if (self.extension != .pax and list.items.len > 0 and list.items[list.items.len - 1] == 0) {
+                        list.items.len -= 1;
+                    }
+                    self.startPadding(self.entry_size);
+                },
+                .data => {
+                    if (self.remaining == 0) {
+                        self.startPadding(self.entry_size);
+                        continue;
+                    }
+                    const avail = try self.available();
+                    if (avail.len == 0) return self.starved();
+                    const n: usize = @intCast(@min(self.remaining, avail.len));
+                    self.consume(n);
+                    self.remaining -= n;
+                    return .{ .data = avail[0..n] };
+                },
+                .padding => {
+                    while (self.remaining > 0) {
+                        const avail = try self.available();
+                        if (avail.len == 0) return self.starved();
+                        const n: usize = @intCast(@min(self.remaining, avail.len));
+                        self.consume(n);
+                        self.remaining -= n;
+                    }
+                    self.state = .header;
+                },
+            }
+        }
+    }
+
+    /// Parse the header block; null for GNU and PAX extension headers
+    fn startEntry(self: *PushParser) !?types.Entry {
+        const tar_header = try TarHeader.parse(&self.block);
+
+        if (tar_header.typeflag == TarHeader.TypeFlag.PAX_EXTENDED) {
+            const size = try tar_header.getSize();
+            if (size > pax.max_size) return error.CorruptedHeader;
+
+            self.extension = .pax;
+            self.pax_data.clearRetainingCapacity();
+            self.has_pax = true;
+            self.entry_size = size;
+            self.remaining = size;
+            self.state = .extension;
+            return null;
+        }
+
+        if (tar_header.typeflag == TarHeader.TypeFlag.PAX_GLOBAL) {
+            // Global defaults are not applied, as in TarReader
+            const size = try tar_header.getSize();
+            self.startPadding(size);
+            self.remaining += size;
+            return null;
+        }
+
+        if (tar_header.typeflag == TarHeader.TypeFlag.GNU_LONG_NAME or
+            tar_header.typeflag == TarHeader.TypeFlag.GNU_LONG_LINK)
+        {
+            const size = try tar_header.getSize();
+            if (size > max_gnu_extension_size) return error.CorruptedHeader;
+
+            if (tar_header.typeflag == TarHeader.TypeFlag.GNU_LONG_NAME) {
+                self.extension = .name;
+                self.gnu_long_name.clearRetainingCapacity();
+                self.has_long_name = true;
+            } else {
+                self.extension = .link;
+                self.gnu_long_link.clearRetainingCapacity();
+                self.has_long_link = true;
+            }
+            self.entry_size = size;
+            self.remaining = size;
+            self.state = .extension;
+            return null;
+        }
+
+        _ = self.entry_arena.reset(.retain_capacity);
+        const arena = self.entry_arena.allocator();
+        var entry = try tar_header.toEntry(arena);
+        if (self.has_long_name) entry.path = try arena.dupe(u8, self.gnu_long_name.items);
+        if (self.has_long_link) entry.link_target = try arena.dupe(u8, self.gnu_long_link.items);
+        self.has_long_name = false;
+        self.has_long_link = false;
+        if (self.has_pax) {
+            try (try pax.Overrides.parse(self.pax_data.items)).apply(arena, &entry);
+            // pax_data is refilled by the next extended header, which may
+            // arrive while this entry is still valid
+            if (entry.xattr_records.len > 0) entry.xattr_records = try arena.dupe(u8, entry.xattr_records);
+            self.has_pax = false;
+        }
+
+        self.entry_size = entry.size;
+        self.remaining = entry.size;
+        self.state = .data;
+        return entry;
+    }
+
+    fn startPadding(self: *PushParser, size: u64) void {
+        self.remaining = (block_size - size % block_size) % block_size;
+        self.state = .padding;
+    }
+
+    fn end(self: *PushParser) Event {
+        _ = self.entry_arena.reset(.retain_capacity);
+        self.state = .done;
+        return .end;
+    }
+
+    /// Assemble `block` across feeds; false when input ran out first
+    fn fillBlock(self: *PushParser) !bool {
+        while (self.block_len < block_size) {
+            const avail = try self.available();
+            if (avail.len == 0) return false;
+            const n = @min(block_size - self.block_len, avail.len);
+            @memcpy(self.block[self.block_len..][0..n], avail[0..n]);
+            self.consume(n);
+            self.block_len += n;
+        }
+        self.block_len = 0;
+        return true;
+    }
+
+    /// Out of bytes: wait for more, or decide how the archive ended
+    fn starved(self: *PushParser) !?Event {
+        if (!self.input_ended) return null;
+
+        const gzip_complete = if (self.gzip) |gz| gz.member_done else true;
+        const at_boundary = self.block_len == 0 and (self.state == .header or self.state == .end_block);
+        // Like TarReader, accept archives without (or with half) an end marker
+        if (at_boundary and gzip_complete) return self.end();
+        return error.IncompleteArchive;
+    }
+
+    /// Tar bytes ready to parse (empty when more input is needed)
+    fn available(self: *PushParser) ![]const u8 {
+        const gz = if (self.gzip) |*g| g else return self.input;
+
+        while (gz.start == gz.end) {
+            if (self.input.len == 0 and !gz.pending) return &.{};
+            if (gz.member_done and self.input.len > 0) {
+                // Concatenated gzip members decode as one stream
+                try gz.inflater.reset();
+                gz.member_done = false;
+            }
+            const step = try gz.inflater.step(self.input, gz.buffer);
+            self.input = self.input[step.consumed..];
+            gz.start = 0;
+            gz.end = step.produced;
+            gz.member_done = step.stream_end;
+            // A full buffer may leave output inside zlib
+            gz.pending = step.produced == gz.buffer.len;
+        }
+        return gz.buffer[gz.start..gz.end];
+    }
+
+    fn consume(self: *PushParser, n: usize) void {
+        if (self.gzip) |*gz| {
+            gz.start += n;
+        } else {
+            self.input = self.input[n..];
+        }
+    }
+};
+
+fn isZeroBlock(block: *const [block_size]u8) bool {
+    return std.mem.allEqual(u8, block, 0);
+}
+
+// Tests
+
+const memory = @import("memory.zig");
+
+/// Entries and data seen by a parser, with data concatenated per entry
+const Collected = struct {
+    paths: std.ArrayList([]u8),
+    data: std.ArrayList(u8),
+    ended: bool = false,
+
+    fn init(allocator: std.mem.Allocator) Collected {
+        return .{ .paths = std.ArrayList([]u8).init(allocator), .data = std.ArrayList(u8).init(allocator) };
+    }
+
+    fn deinit(self: *Collected) void {
+        for (self.paths.items) |path| self.paths.allocator.free(path);
+        self.paths.deinit();
+        self.data.deinit();
+    }
+
+    fn drain(self: *Collected, parser: *PushParser) !void {
+        while (try parser.next()) |event| switch (event) {
+            .entry => |entry| try self.paths.append(try self.paths.allocator.dupe(u8, entry.path)),
+            .data => |chunk| try self.data.appendSlice(chunk),
+            .end => self.ended = true,
+        };
+    }
+};
+
+const long_path = "deep/" ++ "x" ** 300;
+
+/// Append a GNU 'L' extension header carrying `name` (NUL-terminated)
+fn appendLongName(tar_data: *std.ArrayList(u8), name: []const u8) !void {
+    const ext_entry = types.Entry{ .path = "././@LongLink", .entry_type = .file, .size = name.len + 1, .mode = 0o644, .mtime = 0 };
+    var ext = try header.createHeader(&ext_entry, tar_data.allocator);
+    ext.typeflag = TarHeader.TypeFlag.GNU_LONG_NAME;
+    const checksum = header.calculateChecksum(std.mem.asBytes(&ext));
+    _ = try std.fmt.bufPrint(ext.checksum[0..7], "{o:0>6}\x00", .{checksum});
+    ext.checksum[7] = ' ';
+    try tar_data.appendSlice(std.mem.asBytes(&ext));
+    try tar_data.appendSlice(name);
+    try tar_data.append(0);
+    try tar_data.appendNTimes(0, (block_size - (name.len + 1) % block_size) % block_size);
+}
+
+const test_members = [_]memory.Member{
+    .{ .entry = .{ .path = "a.txt", .entry_type = .file, .size = 3, .mode = 0o644, .mtime = 0 }, .data = "abc" },
+    .{ .entry = .{ .path = "dir", .entry_type = .directory, .size = 0, .mode = 0o755, .mtime = 0 } },
+    .{ .entry = .{ .path = "dir/b.bin", .entry_type = .file, .size = 3000, .mode = 0o644, .mtime = 0 }, .data = "0123456789" ** 300 },
+};
+
+test "PushParser: tar fed one byte at a time" {
+    const allocator = std.testing.allocator;
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try memory.writeTar(&tar_data, &test_members);
+
+    var parser = try PushParser.init(allocator, .{});
+    defer parser.deinit();
+    var seen = Collected.init(allocator);
+    defer seen.deinit();
+
+    for (0..tar_data.items.len) |i| {
+        parser.feed(tar_data.items[i..][0..1]);
+        try seen.drain(&parser);
+    }
+
+    try std.testing.expect(seen.ended);
+    try std.testing.expect(parser.isDone());
+    try std.testing.expectEqual(@as(usize, 3), seen.paths.items.len);
+    try std.testing.expectEqualStrings("dir/b.bin", seen.paths.items[2]);
+    try std.testing.expectEqualStrings("abc" ++ "0123456789" ** 300, seen.data.items);
+}
+
+test "PushParser: tar.gz in uneven chunks, concatenated members" {
+    const allocator = std.testing.allocator;
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try memory.writeTar(&tar_data, &test_members);
+
+    // Two gzip members splitting the tar stream mid-entry
+    const split = 700;
+    const first = try c_zlib.compress(allocator, .gzip, tar_data.items[0..split]);
+    defer allocator.free(first);
+    const second = try c_zlib.compress(allocator, .gzip, tar_data.items[split..]);
+    defer allocator.free(second);
+    const gz_data = try std.mem.concat(allocator, u8, &.{ first, second });
+    defer allocator.free(gz_data);
+
+    var parser = try PushParser.init(allocator, .{ .compression = .gzip, .buffer_size = 256 });
+    defer parser.deinit();
+    var seen = Collected.init(allocator);
+    defer seen.deinit();
+
+    var pos: usize = 0;
+    var chunk: usize = 1;
+    while (pos < gz_data.len) : (chunk = chunk * 3 % 97 + 1) {
+        const n = @min(chunk, gz_data.len - pos);
+        parser.feed(gz_data[pos..][0..n]);
+        pos += n;
+        try seen.drain(&parser);
+    }
+    parser.finish();
+    try seen.drain(&parser);
+
+    try std.testing.expect(seen.ended);
+    try std.testing.expectEqual(@as(usize, 3), seen.paths.items.len);
+    try std.testing.expectEqualStrings("abc" ++ "0123456789" ** 300, seen.data.items);
+}
+
+test "PushParser: GNU long name and truncated input" {
+    const allocator = std.testing.allocator;
+
+    // GNU 'L' extension header followed by the real header
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try appendLongName(&tar_data, long_path);
+    try memory.writeTar(&tar_data, test_members[0..1]);
+
+    var parser = try PushParser.init(allocator, .{});
+    defer parser.deinit();
+    parser.feed(tar_data.items);
+    const event = (try parser.next()).?;
+    try std.testing.expectEqualStrings(long_path, event.entry.path);
+
+    // Input ends inside the entry's data
+    var truncated = try PushParser.init(allocator, .{});
+    defer truncated.deinit();
+    truncated.feed(tar_data.items[0 .. tar_data.items.len - 2 * block_size - 512 + 1]);
+    truncated.finish();
+    try std.testing.expectEqualStrings(long_path, (try truncated.next()).?.entry.path);
+    try std.testing.expectEqualStrings("a", (try truncated.next()).?.data);
+    try std.testing.expectError(error.IncompleteArchive, truncated.next());
+}
+
+test "PushParser: GNU long name filling its block, then more entries" {
+    const allocator = std.testing.allocator;
+
+    // 511 bytes plus NUL: no padding. Padding computed from the
+    // NUL-trimmed name (511) would skip a byte of the next header.
+    const block_name = "y" ** (block_size - 1);
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try appendLongName(&tar_data, block_name);
+    try memory.writeTar(&tar_data, &test_members);
+
+    for ([_]usize{ tar_data.items.len, 1 }) |chunk| {
+        var parser = try PushParser.init(allocator, .{});
+        defer parser.deinit();
+        var seen = Collected.init(allocator);
+        defer seen.deinit();
+
+        var pos: usize = 0;
+        while (pos < tar_data.items.len) : (pos += chunk) {
+            parser.feed(tar_data.items[pos..@min(pos + chunk, tar_data.items.len)]);
+            try seen.drain(&parser);
+        }
+
+        try std.testing.expect(seen.ended);
+        try std.testing.expectEqual(@as(usize, 3), seen.paths.items.len);
+        try std.testing.expectEqualStrings(block_name, seen.paths.items[0]);
+        try std.testing.expectEqualStrings("dir", seen.paths.items[1]);
+        try std.testing.expectEqualStrings("abc" ++ "0123456789" ** 300, seen.data.items);
+    }
+}
+
+test "PushParser: PAX extended header split across feeds" {
+    const allocator = std.testing.allocator;
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try pax.appendExtendedHeader(&tar_data, "30 mtime=1700000000.123456789\n" ++
+        "32 path=some/very/long/name.txt\n");
+    try memory.writeTar(&tar_data, test_members[0..1]);
+
+    var parser = try PushParser.init(allocator, .{});
+    defer parser.deinit();
+
+    // Feed one byte at a time through the extension records
+    var fed: usize = 0;
+    const event = while (true) {
+        if (try parser.next()) |ev| break ev;
+        parser.feed(tar_data.items[fed .. fed + 1]);
+        fed += 1;
+    };
+    try std.testing.expectEqualStrings("some/very/long/name.txt", event.entry.path);
+    try std.testing.expectEqual(@as(i64, 1700000000), event.entry.mtime);
+    try std.testing.expectEqual(@as(u32, 123456789), event.entry.mtime_nsec);
+    try std.testing.expectEqual(@as(u64, 3), event.entry.size);
+}
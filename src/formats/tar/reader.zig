@@ -14,16 +14,24 @@
 // limitations under the License.
 
 const std = @import("std");
+const builtin = @import("builtin");
 const header = @import("header.zig");
+const pax = @import("pax.zig");
 const types = @import("../../core/types.zig");
 const errors = @import("../../core/errors.zig");
 const archive = @import("../archive.zig");
 const zlib = @import("../../compress/zlib.zig");
+const zstd = @import("../../compress/zstd.zig");
+const lz4 = @import("../../compress/lz4.zig");
+const bzip2 = @import("../../compress/bzip2.zig");
+const xz = @import("../../compress/xz.zig");
+const instrument = @import("../../core/instrument.zig");
 
 /// TAR archive reader with streaming support
 ///
 /// Reads TAR archive entries sequentially from a file or stream.
-/// Supports POSIX ustar format and GNU tar extensions (long filenames).
+/// Supports POSIX ustar format, PAX extended headers and GNU tar
+/// extensions (long filenames).
 ///
 /// Example:
 /// ```zig
@@ -49,8 +57,13 @@ pub const TarReader = struct {
     /// Prevents pathological archives from forcing huge allocations
     const MAX_GNU_EXTENSION_SIZE: u64 = 16 * 1024 * 1024;
 
+    /// Largest single copy_file_range(2) request in copyTo()
+    const max_copy_chunk: u64 = 1 << 30;
+
     allocator: std.mem.Allocator,
-    reader: std.io.AnyReader,
+
+    /// Where archive bytes come from
+    source: Source,
 
     /// Current entry being read
     current_entry: ?types.Entry = null,
@@ -67,8 +80,145 @@ pub const TarReader = struct {
     /// GNU tar long link name buffer (allocated when needed)
     gnu_long_link: ?[]u8 = null,
 
+    /// PAX extended header for the next entry (borrows the entry arena)
+    pax_overrides: ?pax.Overrides = null,
+
+    /// Backing memory for the current entry's strings
+    ///
+    /// Reset (keeping its capacity) on every next(), so reading an archive
+    /// does not allocate per entry. Entries are only valid until the next
+    /// call to next(), as documented on ArchiveReader.
+    entry_arena: std.heap.ArenaAllocator,
+
+    /// Capacity kept by `entry_arena` between entries
+    const ENTRY_ARENA_RETAIN: usize = 64 * 1024;
+
+    /// Skips forward in a stream without handing the bytes to the caller
+    ///
+    /// Lets wrappers such as TarGzReader discard entry payloads in large
+    /// steps instead of through TarReader's small discard buffer.
+    pub const Skipper = struct {
+        context: *anyopaque,
+
+        /// Skip exactly `count` bytes (error.IncompleteArchive on early end)
+        skipFn: *const fn (context: *anyopaque, count: u64) anyerror!void,
+    };
+
+    const Source = union(enum) {
+        file: FileSource,
+        stream: struct {
+            reader: std.io.AnyReader,
+            skipper: ?Skipper,
+        },
+        slice: SliceSource,
+    };
+
+    /// Archive held in memory; entry data is handed out as borrowed slices
+    const SliceSource = struct {
+        data: []const u8,
+        pos: usize = 0,
+
+        fn readAll(self: *SliceSource, dest: []u8) usize {
+            const n = @min(dest.len, self.data.len - self.pos);
+            @memcpy(dest[0..n], self.data[self.pos..][0..n]);
+            self.pos += n;
+            return n;
+        }
+
+        fn take(self: *SliceSource, count: u64) ![]const u8 {
+            if (count > self.data.len - self.pos) return error.IncompleteArchive;
+            const bytes = self.data[self.pos..][0..@intCast(count)];
+            self.pos += bytes.len;
+            return bytes;
+        }
+    };
+
+    /// Buffered view of an archive file
+    ///
+    /// Header reads are served from one buffer, and payloads that are not
+    /// read are skipped with a seek when the file is a regular file, so
+    /// scanning an archive costs roughly one syscall per buffer of headers.
+    const FileSource = struct {
+        file: std.fs.File,
+        buffer: []u8,
+        start: usize = 0,
+        end: usize = 0,
+
+        /// File offset corresponding to buffer[end]
+        offset: u64,
+
+        /// File size when seeking is possible (null for pipes/devices)
+        seekable_size: ?u64,
+
+        fn readAll(self: *FileSource, dest: []u8) !usize {
+            var copied: usize = 0;
+            while (copied < dest.len) {
+                if (self.start == self.end) {
+                    // Large reads bypass the buffer
+                    if (dest.len - copied >= self.buffer.len) {
+                        const n = try self.readFile(dest[copied..]);
+                        if (n == 0) break;
+                        copied += n;
+                        self.offset += n;
+                        continue;
+                    }
+                    self.start = 0;
+                    self.end = try self.readFile(self.buffer);
+                    self.offset += self.end;
+                    if (self.end == 0) break;
+                }
+                const n = @min(self.end - self.start, dest.len - copied);
+                @memcpy(dest[copied..][0..n], self.buffer[self.start..][0..n]);
+                self.start += n;
+                copied += n;
+            }
+            return copied;
+        }
+
+        fn skip(self: *FileSource, count: u64) !void {
+            const buffered = self.end - self.start;
+            if (count <= buffered) {
+                self.start += @intCast(count);
+                return;
+            }
+
+            var remaining = count - buffered;
+            self.start = 0;
+            self.end = 0;
+
+            if (self.seekable_size) |size| {
+                const target = self.offset + remaining;
+                if (target > size) return error.IncompleteArchive;
+                try self.file.seekTo(target);
+                instrument.count(.syscalls, 1);
+                self.offset = target;
+                return;
+            }
+
+            while (remaining > 0) {
+                const want: usize = @intCast(@min(remaining, @as(u64, self.buffer.len)));
+                const n = try self.readFile(self.buffer[0..want]);
+                if (n == 0) return error.IncompleteArchive;
+                self.offset += n;
+                remaining -= n;
+            }
+        }
+
+        fn readFile(self: *FileSource, dest: []u8) !usize {
+            const span = instrument.begin(.read);
+            defer span.end();
+            const n = try self.file.read(dest);
+            instrument.count(.syscalls, 1);
+            instrument.count(.bytes_read, n);
+            return n;
+        }
+    };
+
     /// Initialize TAR reader from a file
     ///
+    /// Reads are buffered and skipped entry data is seeked over when the
+    /// file is seekable, which makes header-only scans (listing) cheap.
+    ///
     /// Parameters:
     ///   - allocator: Memory allocator
     ///   - file: TAR archive file (must be opened for reading)
@@ -76,6 +226,9 @@ pub const TarReader = struct {
     /// Returns:
     ///   - Initialized TarReader
     ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate the read buffer
+    ///
     /// Example:
     /// ```zig
     /// const file = try std.fs.cwd().openFile("archive.tar", .{});
@@ -83,9 +236,54 @@ pub const TarReader = struct {
     /// defer reader.deinit();
     /// ```
     pub fn init(allocator: std.mem.Allocator, file: std.fs.File) !TarReader {
+        const buffer = try allocator.alloc(u8, types.BufferSize.default);
+
+        // Seeking is only trusted on regular files; pipes and character
+        // devices fall back to read-and-discard
+        const stat = file.stat() catch null;
+        const seekable = stat != null and stat.?.kind == .file;
+        const offset: u64 = if (seekable) file.getPos() catch 0 else 0;
+
+        return TarReader{
+            .allocator = allocator,
+            .entry_arena = std.heap.ArenaAllocator.init(allocator),
+            .source = .{ .file = .{
+                .file = file,
+                .buffer = buffer,
+                .offset = offset,
+                .seekable_size = if (seekable) stat.?.size else null,
+            } },
+        };
+    }
+
+    /// Initialize TAR reader over an archive in memory
+    ///
+    /// Nothing is copied: headers are parsed in place, skipping an entry
+    /// is pointer arithmetic, and readSlice() returns entry data as slices
+    /// of `data`, which must outlive the reader.
+    ///
+    /// Parameters:
+    ///   - allocator: Memory allocator (entry strings only)
+    ///   - data: The whole TAR archive
+    ///
+    /// Returns:
+    ///   - Initialized TarReader
+    ///
+    /// Example:
+    /// ```zig
+    /// var reader = TarReader.initSlice(allocator, request.body);
+    /// defer reader.deinit();
+    ///
+    /// while (try reader.next()) |entry| {
+    ///     const data = try reader.readSlice();
+    ///     try index.put(entry.path, data);
+    /// }
+    /// ```
+    pub fn initSlice(allocator: std.mem.Allocator, data: []const u8) TarReader {
         return TarReader{
             .allocator = allocator,
-            .reader = file.reader().any(),
+            .entry_arena = std.heap.ArenaAllocator.init(allocator),
+            .source = .{ .slice = .{ .data = data } },
         };
     }
 
@@ -105,9 +303,23 @@ pub const TarReader = struct {
     /// defer reader.deinit();
     /// ```
     pub fn initReader(allocator: std.mem.Allocator, reader: std.io.AnyReader) !TarReader {
+        return initStream(allocator, reader, null);
+    }
+
+    /// Initialize TAR reader from a generic reader with a fast skip path
+    ///
+    /// Parameters:
+    ///   - allocator: Memory allocator
+    ///   - reader: Any reader providing TAR data
+    ///   - skipper: Used instead of reading when entry data is skipped
+    ///
+    /// Returns:
+    ///   - Initialized TarReader
+    pub fn initStream(allocator: std.mem.Allocator, reader: std.io.AnyReader, skipper: ?Skipper) !TarReader {
         return TarReader{
             .allocator = allocator,
-            .reader = reader,
+            .entry_arena = std.heap.ArenaAllocator.init(allocator),
+            .source = .{ .stream = .{ .reader = reader, .skipper = skipper } },
         };
     }
 
@@ -115,20 +327,20 @@ pub const TarReader = struct {
     ///
     /// Note: Does not close the file (caller is responsible)
     pub fn deinit(self: *TarReader) void {
-        // Free current entry if any
-        if (self.current_entry) |entry| {
-            self.freeEntry(entry);
-            self.current_entry = null;
-        }
-
-        // Free GNU extension buffers
-        if (self.gnu_long_name) |name| {
-            self.allocator.free(name);
-            self.gnu_long_name = null;
-        }
-        if (self.gnu_long_link) |link| {
-            self.allocator.free(link);
-            self.gnu_long_link = null;
+        // Current entry and GNU extension buffers live in the arena
+        self.current_entry = null;
+        self.gnu_long_name = null;
+        self.gnu_long_link = null;
+        self.pax_overrides = null;
+        self.entry_arena.deinit();
+        self.entry_arena = std.heap.ArenaAllocator.init(self.allocator);
+
+        switch (self.source) {
+            .file => |*f| {
+                self.allocator.free(f.buffer);
+                f.buffer = &.{};
+            },
+            .stream, .slice => {},
         }
     }
 
@@ -157,6 +369,7 @@ pub const TarReader = struct {
             .vtable = &.{
                 .next = nextVTable,
                 .read = readVTable,
+                .readSlice = readSliceVTable,
                 .deinit = deinitVTable,
             },
         };
@@ -174,6 +387,13 @@ pub const TarReader = struct {
         return self.read(buffer);
     }
 
+    /// VTable implementation for readSlice()
+    fn readSliceVTable(ptr: *anyopaque) anyerror!?[]const u8 {
+        const self: *TarReader = @ptrCast(@alignCast(ptr));
+        if (self.source != .slice) return null;
+        return try self.readSlice();
+    }
+
     /// VTable implementation for deinit()
     fn deinitVTable(ptr: *anyopaque) void {
         const self: *TarReader = @ptrCast(@alignCast(ptr));
@@ -202,14 +422,17 @@ pub const TarReader = struct {
             // Skip remaining data and padding from previous entry
             try self.skipRemainingData();
             try self.skipPadding(entry.size);
-            self.freeEntry(entry);
             self.current_entry = null;
         }
+        self.gnu_long_name = null;
+        self.gnu_long_link = null;
+        self.pax_overrides = null;
+        _ = self.entry_arena.reset(.{ .retain_with_limit = ENTRY_ARENA_RETAIN });
 
         // Try to read next header
         while (true) {
             var header_block: [header.TarHeader.BLOCK_SIZE]u8 = undefined;
-            const n = try self.reader.readAll(&header_block);
+            const n = try self.readAll(&header_block);
 
             if (n == 0) {
                 // End of file
@@ -226,7 +449,7 @@ pub const TarReader = struct {
             if (isZeroBlock(&header_block)) {
                 // Read one more block to confirm (TAR has two zero blocks at end)
                 var second_block: [header.TarHeader.BLOCK_SIZE]u8 = undefined;
-                const n2 = try self.reader.readAll(&second_block);
+                const n2 = try self.readAll(&second_block);
 
                 if (n2 == 0) {
                     // Some TAR writers only emit one zero block at EOF
@@ -260,21 +483,40 @@ pub const TarReader = struct {
                 continue; // Read next header
             }
 
+            if (tar_header.typeflag == header.TarHeader.TypeFlag.PAX_EXTENDED) {
+                // Next block(s) override fields of the following header
+                try self.readPaxHeader(&tar_header);
+                continue;
+            }
+
+            if (tar_header.typeflag == header.TarHeader.TypeFlag.PAX_GLOBAL) {
+                // Global defaults are not applied; skip the records
+                const size = try tar_header.getSize();
+                try self.skipBytes(size);
+                self.file_position += size;
+                try self.skipPadding(size);
+                continue;
+            }
+
             // Convert header to entry
-            var entry = try tar_header.toEntry(self.allocator);
+            var entry = try tar_header.toEntry(self.entry_arena.allocator());
 
             // Replace name with GNU long name if available
             if (self.gnu_long_name) |long_name| {
-                self.allocator.free(entry.path);
                 entry.path = long_name;
-                self.gnu_long_name = null; // Ownership transferred
+                self.gnu_long_name = null;
             }
 
             // Replace link target with GNU long link if available
             if (self.gnu_long_link) |long_link| {
-                self.allocator.free(entry.link_target);
                 entry.link_target = long_link;
-                self.gnu_long_link = null; // Ownership transferred
+                self.gnu_long_link = null;
+            }
+
+            // PAX records take precedence over both
+            if (self.pax_overrides) |overrides| {
+                try overrides.apply(self.entry_arena.allocator(), &entry);
+                self.pax_overrides = null;
             }
 
             // Set up for reading entry data
@@ -318,7 +560,7 @@ pub const TarReader = struct {
         // Read up to remaining bytes
         const to_read_u64 = @min(@as(u64, buffer.len), self.remaining_bytes);
         const to_read: usize = @intCast(to_read_u64);
-        const n = try self.reader.readAll(buffer[0..to_read]);
+        const n = try self.readAll(buffer[0..to_read]);
 
         if (n != to_read) {
             return error.IncompleteArchive;
@@ -330,6 +572,96 @@ pub const TarReader = struct {
         return n;
     }
 
+    /// Borrow the rest of the current entry's data without copying
+    ///
+    /// Only for readers created with initSlice(). The slice points into the
+    /// caller's archive buffer, so it stays valid after next().
+    ///
+    /// Returns:
+    ///   - The unread data of the current entry (empty once fully read)
+    ///
+    /// Errors:
+    ///   - error.NoCurrentEntry: No entry is currently being read
+    ///   - error.InvalidArgument: The reader is not backed by memory
+    ///   - error.IncompleteArchive: Archive ends inside the entry
+    pub fn readSlice(self: *TarReader) ![]const u8 {
+        if (self.current_entry == null) return error.NoCurrentEntry;
+        const source = switch (self.source) {
+            .slice => |*s| s,
+            else => return error.InvalidArgument,
+        };
+
+        const data = try source.take(self.remaining_bytes);
+        self.file_position += self.remaining_bytes;
+        self.remaining_bytes = 0;
+        return data;
+    }
+
+    /// Archive file this reader reads from (null for streams and slices)
+    pub fn sourceFile(self: *const TarReader) ?std.fs.File {
+        return switch (self.source) {
+            .file => |f| f.file,
+            else => null,
+        };
+    }
+
+    /// Copy the rest of the current entry's data straight into a file
+    ///
+    /// For file-backed readers on Linux: bytes already buffered are
+    /// written out, and the rest moves file-to-file with copy_file_range(2)
+    /// without passing through user space. Stops early when the source is not a
+    /// file or the kernel refuses the copy; the caller read()s the rest.
+    ///
+    /// Parameters:
+    ///   - out: Destination, written at its current position
+    ///
+    /// Returns:
+    ///   - Number of bytes copied (0 when the fast path does not apply)
+    ///
+    /// Errors:
+    ///   - error.NoCurrentEntry: No entry is currently being read
+    ///   - error.IncompleteArchive: Archive ends inside the entry
+    pub fn copyTo(self: *TarReader, out: std.fs.File) !u64 {
+        if (self.current_entry == null) return error.NoCurrentEntry;
+        if (builtin.os.tag != .linux) return 0;
+        const source = switch (self.source) {
+            .file => |*f| f,
+            else => return 0,
+        };
+
+        // Buffered bytes first, so the file position is where the data continues
+        const buffered: usize = @intCast(@min(@as(u64, source.end - source.start), self.remaining_bytes));
+        if (buffered > 0) {
+            try out.writeAll(source.buffer[source.start..][0..buffered]);
+            source.start += buffered;
+            self.remaining_bytes -= buffered;
+            self.file_position += buffered;
+        }
+        var copied: u64 = buffered;
+
+        while (self.remaining_bytes > 0) {
+            const want: usize = @intCast(@min(self.remaining_bytes, max_copy_chunk));
+            const rc = std.os.linux.copy_file_range(source.file.handle, null, out.handle, null, want, 0);
+            switch (std.posix.errno(rc)) {
+                .SUCCESS => {},
+                .INTR => continue,
+                // Not a regular file, or no copies between these filesystems
+                .XDEV, .INVAL, .OPNOTSUPP, .NOSYS, .BADF => return copied,
+                .NOSPC => return error.NoSpaceLeft,
+                .IO => return error.InputOutput,
+                else => |err| return std.posix.unexpectedErrno(err),
+            }
+            instrument.count(.syscalls, 1);
+            if (rc == 0) return error.IncompleteArchive;
+
+            source.offset += rc;
+            self.remaining_bytes -= rc;
+            self.file_position += rc;
+            copied += rc;
+        }
+        return copied;
+    }
+
     /// Skip to next entry (skip remaining data of current entry)
     ///
     /// Automatically called by next(), but can be called manually
@@ -342,22 +674,7 @@ pub const TarReader = struct {
             return;
         }
 
-        // Read and discard remaining data
-        // Note: seekBy is not available on generic readers, so we always read and discard
-        var discard_buffer: [4096]u8 = undefined;
-        var remaining = self.remaining_bytes;
-
-        while (remaining > 0) {
-            const to_read_u64 = @min(remaining, @as(u64, discard_buffer.len));
-            const to_read: usize = @intCast(to_read_u64);
-            const n = try self.reader.readAll(discard_buffer[0..to_read]);
-
-            if (n != to_read) {
-                return error.IncompleteArchive;
-            }
-
-            remaining -= @as(u64, n);
-        }
+        try self.skipBytes(self.remaining_bytes);
         self.file_position += self.remaining_bytes;
         self.remaining_bytes = 0;
     }
@@ -377,17 +694,42 @@ pub const TarReader = struct {
             return;
         }
 
-        // Read and discard padding
-        // Note: seekBy is not available on generic readers
-        var discard_buffer: [512]u8 = undefined;
-        const to_read: usize = @intCast(padding);
-        const n = try self.reader.readAll(discard_buffer[0..to_read]);
+        try self.skipBytes(padding);
+        self.file_position += padding;
+    }
 
-        if (n != to_read) {
-            return error.IncompleteArchive;
-        }
+    /// Read from the source until `dest` is full or the input ends
+    fn readAll(self: *TarReader, dest: []u8) !usize {
+        return switch (self.source) {
+            .file => |*f| f.readAll(dest),
+            .stream => |s| s.reader.readAll(dest),
+            .slice => |*s| s.readAll(dest),
+        };
+    }
 
-        self.file_position += padding;
+    /// Discard exactly `count` bytes from the source
+    ///
+    /// Errors:
+    ///   - error.IncompleteArchive: Input ended first
+    fn skipBytes(self: *TarReader, count: u64) !void {
+        switch (self.source) {
+            .file => |*f| return f.skip(count),
+            .slice => |*s| _ = try s.take(count),
+            .stream => |s| {
+                if (s.skipper) |skipper| return skipper.skipFn(skipper.context, count);
+
+                var discard_buffer: [4096]u8 = undefined;
+                var remaining = count;
+                while (remaining > 0) {
+                    const to_read: usize = @intCast(@min(remaining, @as(u64, discard_buffer.len)));
+                    const n = try s.reader.readAll(discard_buffer[0..to_read]);
+                    if (n != to_read) {
+                        return error.IncompleteArchive;
+                    }
+                    remaining -= n;
+                }
+            },
+        }
     }
 
     /// Read GNU tar long name extension
@@ -406,17 +748,11 @@ pub const TarReader = struct {
             return error.CorruptedHeader;
         }
 
-        // Free previous long name if any
-        if (self.gnu_long_name) |old_name| {
-            self.allocator.free(old_name);
-        }
-
-        // Allocate buffer for long name
-        const name_buffer = try self.allocator.alloc(u8, @intCast(name_size));
-        errdefer self.allocator.free(name_buffer);
+        // Allocate buffer for long name (a previous one is left to the arena)
+        const name_buffer = try self.entry_arena.allocator().alloc(u8, @intCast(name_size));
 
         // Read name data
-        const n = try self.reader.readAll(name_buffer);
+        const n = try self.readAll(name_buffer);
         if (n != name_size) {
             return error.IncompleteArchive;
         }
@@ -433,12 +769,7 @@ pub const TarReader = struct {
             name_size;
 
         // Store name (trim to actual length)
-        if (actual_len < name_size) {
-            const trimmed = try self.allocator.realloc(name_buffer, actual_len);
-            self.gnu_long_name = trimmed;
-        } else {
-            self.gnu_long_name = name_buffer;
-        }
+        self.gnu_long_name = name_buffer[0..@intCast(actual_len)];
     }
 
     /// Read GNU tar long link extension
@@ -457,17 +788,11 @@ pub const TarReader = struct {
             return error.CorruptedHeader;
         }
 
-        // Free previous long link if any
-        if (self.gnu_long_link) |old_link| {
-            self.allocator.free(old_link);
-        }
-
-        // Allocate buffer for long link
-        const link_buffer = try self.allocator.alloc(u8, @intCast(link_size));
-        errdefer self.allocator.free(link_buffer);
+        // Allocate buffer for long link (a previous one is left to the arena)
+        const link_buffer = try self.entry_arena.allocator().alloc(u8, @intCast(link_size));
 
         // Read link data
-        const n = try self.reader.readAll(link_buffer);
+        const n = try self.readAll(link_buffer);
         if (n != link_size) {
             return error.IncompleteArchive;
         }
@@ -484,20 +809,35 @@ pub const TarReader = struct {
             link_size;
 
         // Store link (trim to actual length)
-        if (actual_len < link_size) {
-            const trimmed = try self.allocator.realloc(link_buffer, actual_len);
-            self.gnu_long_link = trimmed;
-        } else {
-            self.gnu_long_link = link_buffer;
-        }
+        self.gnu_long_link = link_buffer[0..@intCast(actual_len)];
     }
 
-    /// Free entry resources
-    fn freeEntry(self: *TarReader, entry: types.Entry) void {
-        self.allocator.free(entry.path);
-        self.allocator.free(entry.uname);
-        self.allocator.free(entry.gname);
-        self.allocator.free(entry.link_target);
+    /// Read a PAX extended header for the following entry
+    ///
+    /// Parameters:
+    ///   - tar_header: Header of type 'x' whose data holds the records
+    ///
+    /// Errors:
+    ///   - error.CorruptedHeader: Oversized header or malformed records
+    ///   - error.OutOfMemory: Failed to allocate buffer
+    ///   - error.IncompleteArchive: Unexpected end of file
+    fn readPaxHeader(self: *TarReader, tar_header: *const header.TarHeader) !void {
+        const size = try tar_header.getSize();
+        if (size > pax.max_size) {
+            return error.CorruptedHeader;
+        }
+
+        // Records are parsed in place; the overrides borrow this buffer
+        const data = try self.entry_arena.allocator().alloc(u8, @intCast(size));
+        const n = try self.readAll(data);
+        if (n != size) {
+            return error.IncompleteArchive;
+        }
+
+        self.file_position += size;
+        try self.skipPadding(size);
+
+        self.pax_overrides = try pax.Overrides.parse(data);
     }
 };
 
@@ -643,25 +983,96 @@ test "TarReader: ArchiveReader polymorphism" {
     try std.testing.expectEqual(@as(usize, 0), entries.len);
 }
 
+test "TarReader: skips entry data by seeking" {
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    // Payloads larger than the read buffer force real seeks
+    const sizes = [_]u64{ 3 * types.BufferSize.default + 17, 1, 0, 700 };
+    {
+        const file = try tmp_dir.dir.createFile("seek.tar", .{});
+        defer file.close();
+
+        for (sizes, 0..) |size, i| {
+            var name_buf: [16]u8 = undefined;
+            const entry_meta = types.Entry{
+                .path = try std.fmt.bufPrint(&name_buf, "f{d}", .{i}),
+                .entry_type = .file,
+                .size = size,
+                .mode = 0o644,
+                .mtime = 0,
+            };
+            const hdr = try header.createHeader(&entry_meta, allocator);
+            try file.writeAll(std.mem.asBytes(&hdr));
+            try file.seekBy(@intCast(size + calculatePadding(size)));
+        }
+        try file.writeAll(&([_]u8{0} ** 1024));
+    }
+
+    const file = try tmp_dir.dir.openFile("seek.tar", .{});
+    defer file.close();
+
+    var reader = try TarReader.init(allocator, file);
+    defer reader.deinit();
+
+    for (sizes, 0..) |size, i| {
+        const entry = (try reader.next()) orelse return error.TestUnexpectedResult;
+        var name_buf: [16]u8 = undefined;
+        try std.testing.expectEqualStrings(try std.fmt.bufPrint(&name_buf, "f{d}", .{i}), entry.path);
+        try std.testing.expectEqual(size, entry.size);
+
+        // Partially read the last entry so skip starts mid-buffer
+        if (i == sizes.len - 1) {
+            var buf: [100]u8 = undefined;
+            try std.testing.expectEqual(@as(usize, 100), try reader.read(&buf));
+        }
+    }
+    try std.testing.expectEqual(@as(?types.Entry, null), try reader.next());
+}
+
+test "TarReader: seeking past end of file is an incomplete archive" {
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    {
+        const file = try tmp_dir.dir.createFile("short.tar", .{});
+        defer file.close();
+
+        const entry_meta = types.Entry{
+            .path = "big.bin",
+            .entry_type = .file,
+            .size = 1 << 20,
+            .mode = 0o644,
+            .mtime = 0,
+        };
+        const hdr = try header.createHeader(&entry_meta, allocator);
+        try file.writeAll(std.mem.asBytes(&hdr));
+        try file.writeAll(&([_]u8{'x'} ** 512));
+    }
+
+    const file = try tmp_dir.dir.openFile("short.tar", .{});
+    defer file.close();
+
+    var reader = try TarReader.init(allocator, file);
+    defer reader.deinit();
+
+    _ = (try reader.next()) orelse return error.TestUnexpectedResult;
+    try std.testing.expectError(error.IncompleteArchive, reader.next());
+}
+
 /// TAR.GZ archive reader
 ///
-/// Reads gzip-compressed TAR archives. This wraps a TarReader with automatic
-/// gzip decompression.
-///
-/// **IMPORTANT - Memory Usage Limitation:**
-/// This implementation currently loads the ENTIRE decompressed archive into memory
-/// before reading entries. This violates the streaming extraction principle and
-/// may consume significant RAM (up to several GB for moderately compressed archives).
-///
-/// Memory constraints:
-/// - Maximum compressed file size: 512 MiB (enforced at read time)
-/// - Maximum decompressed size: 512 MiB (enforced by zlib decompression)
-/// - Decompression ratio limit: Enforced by zlib layer to prevent bombs
+/// Reads gzip-compressed TAR archives by streaming the file through a
+/// zlib inflater into a TarReader. Memory use is constant (one 64 KiB
+/// input buffer plus zlib state) regardless of archive size.
 ///
-/// For true streaming extraction without loading the entire archive into memory,
-/// a future implementation using streaming decompression is planned once Zig's
-/// std.compress APIs stabilize. Until then, use TarReader directly for
-/// uncompressed .tar files if memory is constrained.
+/// Decompression progress can be observed with `setObserver`, which is
+/// how extraction enforces compression-ratio and total-size limits while
+/// the stream is being decoded (see `security.RatioMonitor`).
 ///
 /// Example:
 /// ```zig
@@ -677,33 +1088,46 @@ test "TarReader: ArchiveReader polymorphism" {
 /// }
 /// ```
 pub const TarGzReader = struct {
-    /// Maximum compressed file size (512 MiB)
-    /// Prevents loading extremely large files into memory
-    const MAX_COMPRESSED_SIZE: usize = 512 * 1024 * 1024;
-
     allocator: std.mem.Allocator,
-    decompressed_data: []u8,
-    fixed_buffer_stream: std.io.FixedBufferStream([]u8),
+
+    /// Heap-allocated so the readers chained through it stay valid when
+    /// the TarGzReader itself is moved
+    stream: *Stream,
+
     tar_reader: TarReader,
 
+    const Stream = struct {
+        file: std.fs.File,
+        inflate: zlib.InflateReader,
+
+        fn readFile(context: *const anyopaque, buffer: []u8) anyerror!usize {
+            const file: *const std.fs.File = @ptrCast(@alignCast(context));
+            return file.read(buffer);
+        }
+
+        fn readInflated(context: *const anyopaque, buffer: []u8) anyerror!usize {
+            const inflate: *zlib.InflateReader = @constCast(@ptrCast(@alignCast(context)));
+            return inflate.read(buffer);
+        }
+
+        fn skipInflated(context: *anyopaque, count: u64) anyerror!void {
+            const inflate: *zlib.InflateReader = @ptrCast(@alignCast(context));
+            if (try inflate.skip(count) != count) return error.IncompleteArchive;
+        }
+    };
+
     /// Initialize TAR.GZ reader from a gzip-compressed file
     ///
-    /// **WARNING:** This function loads the ENTIRE compressed file into memory,
-    /// decompresses it completely, and holds the decompressed data in memory.
-    /// This is NOT a streaming implementation.
-    ///
     /// Parameters:
     ///   - allocator: Memory allocator
-    ///   - file: Gzip-compressed TAR archive file (max 512 MiB compressed)
+    ///   - file: Gzip-compressed TAR archive file
     ///
     /// Returns:
-    ///   - Initialized TarGzReader with full archive in memory
+    ///   - Initialized TarGzReader
     ///
     /// Errors:
-    ///   - error.OutOfMemory: Failed to allocate decompression buffer
-    ///   - error.FileTooBig: Compressed file exceeds MAX_COMPRESSED_SIZE (512 MiB)
-    ///   - error.DecompressionFailed: Failed to decompress gzip data
-    ///                                (may also indicate decompressed size > 512 MiB)
+    ///   - error.OutOfMemory: Failed to allocate decompression state
+    ///   - error.DecompressionFailed: File does not start with a gzip header
     ///
     /// Example:
     /// ```zig
@@ -714,35 +1138,47 @@ pub const TarGzReader = struct {
     /// defer reader.deinit();
     /// ```
     pub fn init(allocator: std.mem.Allocator, file: std.fs.File) !TarGzReader {
-        // Read compressed data
-        const compressed = try file.readToEndAlloc(allocator, MAX_COMPRESSED_SIZE);
-        defer allocator.free(compressed);
+        const stream = try allocator.create(Stream);
+        errdefer allocator.destroy(stream);
+
+        stream.file = file;
+        const source = std.io.AnyReader{ .context = &stream.file, .readFn = Stream.readFile };
+        stream.inflate = try zlib.InflateReader.init(allocator, source, .gzip);
+        errdefer stream.inflate.deinit();
+        try stream.inflate.checkHeader();
 
-        // Decompress gzip data
-        const decompressed = try zlib.decompress(allocator, .gzip, compressed);
-        errdefer allocator.free(decompressed);
+        const inflated = std.io.AnyReader{ .context = &stream.inflate, .readFn = Stream.readInflated };
 
-        // Create the TarGzReader struct first to ensure the fixed_buffer_stream
-        // is stored in the heap-allocated struct before we create the AnyReader
-        var result = TarGzReader{
+        return TarGzReader{
             .allocator = allocator,
-            .decompressed_data = decompressed,
-            .fixed_buffer_stream = std.io.fixedBufferStream(decompressed),
-            .tar_reader = undefined,
+            .stream = stream,
+            .tar_reader = try TarReader.initStream(allocator, inflated, .{
+                .context = &stream.inflate,
+                .skipFn = Stream.skipInflated,
+            }),
         };
-
-        // Now create tar reader using the struct's fixed_buffer_stream field
-        result.tar_reader = try TarReader.initReader(allocator, result.fixed_buffer_stream.reader().any());
-
-        return result;
     }
 
     /// Clean up resources
     ///
-    /// Frees the decompressed data buffer and tar reader resources.
+    /// Note: Does not close the file (caller is responsible)
     pub fn deinit(self: *TarGzReader) void {
         self.tar_reader.deinit();
-        self.allocator.free(self.decompressed_data);
+        self.stream.inflate.deinit();
+        self.allocator.destroy(self.stream);
+    }
+
+    /// Observe decompression progress
+    ///
+    /// The observer is called after every inflate step with the running
+    /// compressed/uncompressed totals; an error from it aborts reading.
+    pub fn setObserver(self: *TarGzReader, observer: ?types.StreamObserver) void {
+        self.stream.inflate.observer = observer;
+    }
+
+    /// Compressed bytes consumed so far
+    pub fn compressedBytes(self: *const TarGzReader) u64 {
+        return self.stream.inflate.compressed_bytes;
     }
 
     /// Get ArchiveReader interface
@@ -766,4 +1202,398 @@ pub const TarGzReader = struct {
     pub fn archiveReader(self: *TarGzReader) archive.ArchiveReader {
         return self.tar_reader.archiveReader();
     }
+
+    /// Get next entry (direct call, for code generic over the reader type)
+    pub inline fn next(self: *TarGzReader) !?types.Entry {
+        return self.tar_reader.next();
+    }
+
+    /// Read data from current entry (direct call, see next())
+    pub inline fn read(self: *TarGzReader, buffer: []u8) !usize {
+        return self.tar_reader.read(buffer);
+    }
 };
+
+/// Compressed TAR archive reader over a streaming decoder
+///
+/// Streams the file through a `Decoder` into a TarReader; skipped entry
+/// data is decompressed and discarded without being copied out.
+/// `Decoder` provides `read`, `skip`, `checkHeader`, `deinit`,
+/// `compressed_bytes` and `observer`, and either an
+/// `init(allocator, source[, options])` that returns it or, for the
+/// parallel decoders whose pools keep pointers into them, an in-place
+/// `init(self, allocator, source, options)`.
+///
+/// Example:
+/// ```zig
+/// const file = try std.fs.cwd().openFile("archive.tar.zst", .{});
+/// defer file.close();
+///
+/// var reader = try TarZstReader.init(allocator, file, .{});
+/// defer reader.deinit();
+///
+/// var archive_reader = reader.archiveReader();
+/// while (try archive_reader.next()) |entry| {
+///     std.debug.print("Entry: {s}\n", .{entry.path});
+/// }
+/// ```
+pub fn TarDecodedReader(comptime Decoder: type) type {
+    return struct {
+        const Self = @This();
+
+        allocator: std.mem.Allocator,
+
+        /// Heap-allocated so the decoder (and its thread pool, if any) and
+        /// the readers chained through it stay valid when this is moved
+        stream: *Stream,
+
+        tar_reader: TarReader,
+
+        /// Decoder options (empty for decoders without any)
+        pub const Options = if (@hasDecl(Decoder, "Options")) Decoder.Options else struct {};
+
+        const in_place = @typeInfo(@TypeOf(Decoder.init)).@"fn".params[0].type.? == *Decoder;
+
+        const Stream = struct {
+            file: std.fs.File,
+            decoder: Decoder,
+
+            fn readFile(context: *const anyopaque, buffer: []u8) anyerror!usize {
+                const file: *const std.fs.File = @ptrCast(@alignCast(context));
+                return file.read(buffer);
+            }
+
+            fn readDecoded(context: *const anyopaque, buffer: []u8) anyerror!usize {
+                const decoder: *Decoder = @constCast(@ptrCast(@alignCast(context)));
+                return decoder.read(buffer);
+            }
+
+            fn skipDecoded(context: *anyopaque, count: u64) anyerror!void {
+                const decoder: *Decoder = @ptrCast(@alignCast(context));
+                if (try decoder.skip(count) != count) return error.IncompleteArchive;
+            }
+        };
+
+        /// Initialize from a compressed file
+        ///
+        /// Errors:
+        ///   - error.OutOfMemory: Failed to allocate decompression state
+        ///   - error.DecompressionFailed: File does not start with a stream
+        ///     of the decoder's format
+        pub fn init(allocator: std.mem.Allocator, file: std.fs.File, options: Options) !Self {
+            const stream = try allocator.create(Stream);
+            errdefer allocator.destroy(stream);
+
+            stream.file = file;
+            const source = std.io.AnyReader{ .context = &stream.file, .readFn = Stream.readFile };
+            if (in_place) {
+                try stream.decoder.init(allocator, source, options);
+            } else if (@hasDecl(Decoder, "Options")) {
+                stream.decoder = try Decoder.init(allocator, source, options);
+            } else {
+                stream.decoder = try Decoder.init(allocator, source);
+            }
+            errdefer stream.decoder.deinit();
+            try stream.decoder.checkHeader();
+
+            const decoded = std.io.AnyReader{ .context = &stream.decoder, .readFn = Stream.readDecoded };
+
+            return .{
+                .allocator = allocator,
+                .stream = stream,
+                .tar_reader = try TarReader.initStream(allocator, decoded, .{
+                    .context = &stream.decoder,
+                    .skipFn = Stream.skipDecoded,
+                }),
+            };
+        }
+
+        /// Clean up resources
+        ///
+        /// Note: Does not close the file (caller is responsible)
+        pub fn deinit(self: *Self) void {
+            self.tar_reader.deinit();
+            self.stream.decoder.deinit();
+            self.allocator.destroy(self.stream);
+        }
+
+        /// Observe decompression progress
+        ///
+        /// The decoder reports its running compressed/uncompressed totals
+        /// after each block (or batch of blocks); an error from the
+        /// observer aborts reading. Must be set before the first entry is
+        /// read.
+        pub fn setObserver(self: *Self, observer: ?types.StreamObserver) void {
+            self.stream.decoder.observer = observer;
+        }
+
+        /// Compressed bytes consumed so far
+        pub fn compressedBytes(self: *const Self) u64 {
+            return self.stream.decoder.compressed_bytes;
+        }
+
+        /// Get ArchiveReader interface
+        pub fn archiveReader(self: *Self) archive.ArchiveReader {
+            return self.tar_reader.archiveReader();
+        }
+
+        /// Get next entry (direct call, for code generic over the reader type)
+        pub inline fn next(self: *Self) !?types.Entry {
+            return self.tar_reader.next();
+        }
+
+        /// Read data from current entry (direct call, see next())
+        pub inline fn read(self: *Self, buffer: []u8) !usize {
+            return self.tar_reader.read(buffer);
+        }
+    };
+}
+
+/// TAR.ZST archive reader
+///
+/// Memory use is the input buffer plus one Zstandard window (at most
+/// `zstd.default_max_window`, usually far less).
+pub const TarZstReader = TarDecodedReader(zstd.ZstdReader);
+
+/// TAR.LZ4 archive reader
+///
+/// Memory use is the input buffer plus one LZ4 block (4 MiB at most, plus
+/// 64 KiB of history for linked blocks).
+pub const TarLz4Reader = TarDecodedReader(lz4.Lz4Reader);
+
+/// TAR.BZ2 archive reader
+///
+/// bzip2 blocks are decoded on all cores through a bzip2.ParallelReader.
+/// Memory is the input batch plus about 5 MB per block in flight.
+pub const TarBz2Reader = TarDecodedReader(bzip2.ParallelReader);
+
+/// TAR.XZ archive reader
+///
+/// Goes through an xz.ParallelReader: blocks that record their sizes
+/// (`xz -T` output) are decoded on all cores, others in order with a
+/// window of the block's declared dictionary size.
+pub const TarXzReader = TarDecodedReader(xz.ParallelReader);
+
+test "TarGzReader: streams entries and aborts on observer error" {
+    const allocator = std.testing.allocator;
+
+    // One 64 KiB entry of zeros: highly compressible
+    const entry_size = 64 * 1024;
+    var tar_data: [512 + entry_size + 1024]u8 = undefined;
+    @memset(&tar_data, 0);
+    const entry_meta = types.Entry{
+        .path = "zeros.bin",
+        .entry_type = .file,
+        .size = entry_size,
+        .mode = 0o644,
+        .mtime = 0,
+    };
+    const hdr = try header.createHeader(&entry_meta, allocator);
+    @memcpy(tar_data[0..512], std.mem.asBytes(&hdr));
+
+    const compressed = try zlib.compress(allocator, .gzip, &tar_data);
+    defer allocator.free(compressed);
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "t.tar.gz", .data = compressed });
+
+    {
+        const file = try tmp_dir.dir.openFile("t.tar.gz", .{});
+        defer file.close();
+
+        var reader = try TarGzReader.init(allocator, file);
+        defer reader.deinit();
+
+        var arch = reader.archiveReader();
+        const entry = (try arch.next()) orelse return error.TestUnexpectedResult;
+        try std.testing.expectEqualStrings("zeros.bin", entry.path);
+        try std.testing.expectEqual(@as(u64, entry_size), entry.size);
+        try std.testing.expectEqual(@as(?types.Entry, null), try arch.next());
+        try std.testing.expect(reader.compressedBytes() > 0);
+    }
+
+    {
+        const file = try tmp_dir.dir.openFile("t.tar.gz", .{});
+        defer file.close();
+
+        var reader = try TarGzReader.init(allocator, file);
+        defer reader.deinit();
+
+        const Limit = struct {
+            fn observe(_: *anyopaque, _: u64, uncompressed: u64) anyerror!void {
+                if (uncompressed > 4096) return error.TotalSizeExceedsLimit;
+            }
+        };
+        var dummy: u8 = 0;
+        reader.setObserver(.{ .ptr = &dummy, .observeFn = Limit.observe });
+
+        // The header fits under the limit; skipping the payload does not
+        var arch = reader.archiveReader();
+        _ = (try arch.next()) orelse return error.TestUnexpectedResult;
+        try std.testing.expectError(error.TotalSizeExceedsLimit, arch.next());
+    }
+}
+
+test "TarZstReader: streams entries from independent frames" {
+    const allocator = std.testing.allocator;
+
+    const entry_size = 200 * 1024;
+    const tar_data = try allocator.alloc(u8, 512 + entry_size + 1024);
+    defer allocator.free(tar_data);
+    @memset(tar_data, 0);
+    for (tar_data[512..][0..entry_size], 0..) |*b, i| b.* = @truncate(i / 7);
+    const entry_meta = types.Entry{
+        .path = "counter.bin",
+        .entry_type = .file,
+        .size = entry_size,
+        .mode = 0o644,
+        .mtime = 0,
+    };
+    const hdr = try header.createHeader(&entry_meta, allocator);
+    @memcpy(tar_data[0..512], std.mem.asBytes(&hdr));
+
+    // Several frames, so the entry spans frame boundaries
+    const compressed = try zstd.compress(allocator, tar_data, .{ .frame_size = 64 * 1024 });
+    defer allocator.free(compressed);
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "t.tar.zst", .data = compressed });
+
+    const file = try tmp_dir.dir.openFile("t.tar.zst", .{});
+    defer file.close();
+
+    var reader = try TarZstReader.init(allocator, file, .{});
+    defer reader.deinit();
+
+    var arch = reader.archiveReader();
+    const entry = (try arch.next()) orelse return error.TestUnexpectedResult;
+    try std.testing.expectEqualStrings("counter.bin", entry.path);
+    try std.testing.expectEqual(@as(u64, entry_size), entry.size);
+    try std.testing.expectEqual(@as(?types.Entry, null), try arch.next());
+    try std.testing.expect(reader.compressedBytes() > 0);
+}
+
+test "TarLz4Reader: streams entries across blocks" {
+    const allocator = std.testing.allocator;
+
+    const entry_size = 200 * 1024;
+    const tar_data = try allocator.alloc(u8, 512 + entry_size + 1024);
+    defer allocator.free(tar_data);
+    @memset(tar_data, 0);
+    for (tar_data[512..][0..entry_size], 0..) |*b, i| b.* = @truncate(i / 7);
+    const entry_meta = types.Entry{
+        .path = "counter.bin",
+        .entry_type = .file,
+        .size = entry_size,
+        .mode = 0o644,
+        .mtime = 0,
+    };
+    const hdr = try header.createHeader(&entry_meta, allocator);
+    @memcpy(tar_data[0..512], std.mem.asBytes(&hdr));
+
+    // 64 KiB blocks, so the entry spans block boundaries
+    const compressed = try lz4.compress(allocator, tar_data, .{ .block_size = .max64KB });
+    defer allocator.free(compressed);
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "t.tar.lz4", .data = compressed });
+
+    const file = try tmp_dir.dir.openFile("t.tar.lz4", .{});
+    defer file.close();
+
+    var reader = try TarLz4Reader.init(allocator, file, .{});
+    defer reader.deinit();
+
+    var arch = reader.archiveReader();
+    const entry = (try arch.next()) orelse return error.TestUnexpectedResult;
+    try std.testing.expectEqualStrings("counter.bin", entry.path);
+    try std.testing.expectEqual(@as(u64, entry_size), entry.size);
+    try std.testing.expectEqual(@as(?types.Entry, null), try arch.next());
+    try std.testing.expect(reader.compressedBytes() > 0);
+}
+
+test "TarReader: PAX extended header overrides path and times" {
+    const allocator = std.testing.allocator;
+    const memory = @import("memory.zig");
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try pax.appendExtendedHeader(&tar_data, "30 mtime=1700000000.123456789\n" ++
+        "22 atime=1700000001.5\n" ++
+        "32 path=some/very/long/name.txt\n");
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "short", .entry_type = .file, .size = 3, .mode = 0o644, .mtime = 1700000000 }, .data = "abc" },
+        .{ .entry = .{ .path = "plain", .entry_type = .file, .size = 0, .mode = 0o644, .mtime = 42 } },
+    });
+
+    var reader = TarReader.initSlice(allocator, tar_data.items);
+    defer reader.deinit();
+
+    const entry = (try reader.next()).?;
+    try std.testing.expectEqualStrings("some/very/long/name.txt", entry.path);
+    try std.testing.expectEqual(@as(i64, 1700000000), entry.mtime);
+    try std.testing.expectEqual(@as(u32, 123456789), entry.mtime_nsec);
+    try std.testing.expectEqual(@as(?i64, 1700000001), entry.atime);
+    try std.testing.expectEqual(@as(u32, 500000000), entry.atime_nsec);
+    try std.testing.expectEqualStrings("abc", try reader.readSlice());
+
+    // Overrides apply to one entry only
+    const plain = (try reader.next()).?;
+    try std.testing.expectEqualStrings("plain", plain.path);
+    try std.testing.expectEqual(@as(u32, 0), plain.mtime_nsec);
+    try std.testing.expect(plain.atime == null);
+    try std.testing.expect((try reader.next()) == null);
+}
+
+test "TarReader: copyTo moves entry data file-to-file" {
+    const allocator = std.testing.allocator;
+    const memory = @import("memory.zig");
+
+    const big = try allocator.alloc(u8, 300 * 1024 + 5);
+    defer allocator.free(big);
+    for (big, 0..) |*b, i| b.* = @truncate(i *% 31);
+
+    var tar_data = std.ArrayList(u8).init(allocator);
+    defer tar_data.deinit();
+    try memory.writeTar(&tar_data, &.{
+        .{ .entry = .{ .path = "big.bin", .entry_type = .file, .size = big.len, .mode = 0o644, .mtime = 0 }, .data = big },
+        .{ .entry = .{ .path = "after.txt", .entry_type = .file, .size = 5, .mode = 0o644, .mtime = 0 }, .data = "after" },
+    });
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "t.tar", .data = tar_data.items });
+
+    const file = try tmp_dir.dir.openFile("t.tar", .{});
+    defer file.close();
+    var reader = try TarReader.init(allocator, file);
+    defer reader.deinit();
+    try std.testing.expect(reader.sourceFile() != null);
+
+    _ = (try reader.next()).?;
+    const out = try tmp_dir.dir.createFile("big.bin", .{ .read = true });
+    defer out.close();
+
+    // Whatever the fast path did not copy is read normally
+    const copied = try reader.copyTo(out);
+    var buf: [4096]u8 = undefined;
+    while (true) {
+        const n = try reader.read(&buf);
+        if (n == 0) break;
+        try out.writeAll(buf[0..n]);
+    }
+    if (builtin.os.tag == .linux) try std.testing.expect(copied > 0);
+
+    const written = try tmp_dir.dir.readFileAlloc(allocator, "big.bin", big.len + 1);
+    defer allocator.free(written);
+    try std.testing.expectEqualSlices(u8, big, written);
+
+    // The reader is positioned correctly for the next header
+    const after = (try reader.next()).?;
+    try std.testing.expectEqualStrings("after.txt", after.path);
+    const n = try reader.read(&buf);
+    try std.testing.expectEqualStrings("after", buf[0..n]);
+}
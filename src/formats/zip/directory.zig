@@ -0,0 +1,410 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! ZIP central directory
+//!
+//! The central directory at the end of a ZIP file lists every member
+//! with its sizes, CRC-32 and the offset of its local header, so the
+//! whole archive can be listed, and any member located, without touching
+//! member data. ZIP64 records are followed when present.
+//!
+//! Reference: PKWARE APPNOTE.TXT 6.3.10, sections 4.3 and 4.5
+
+const std = @import("std");
+const types = @import("../../core/types.zig");
+
+/// Record signatures (little-endian "PK\x..\x..")
+pub const Signature = struct {
+    pub const local_header: u32 = 0x04034b50;
+    pub const central_header: u32 = 0x02014b50;
+    pub const end_of_directory: u32 = 0x06054b50;
+    pub const zip64_end_of_directory: u32 = 0x06064b50;
+    pub const zip64_locator: u32 = 0x07064b50;
+};
+
+/// Fixed record sizes
+pub const local_header_size: usize = 30;
+pub const central_header_size: usize = 46;
+pub const end_of_directory_size: usize = 22;
+pub const zip64_end_of_directory_size: usize = 56;
+pub const zip64_locator_size: usize = 20;
+
+/// Largest central directory read into memory (256 MiB)
+pub const max_directory_size: u64 = 256 * 1024 * 1024;
+
+/// Compression methods
+pub const Method = enum(u16) {
+    stored = 0,
+    deflated = 8,
+    _,
+};
+
+/// General purpose flag: member is encrypted
+const flag_encrypted: u16 = 1 << 0;
+
+/// Host system in "version made by" whose external attributes hold a Unix mode
+const host_unix: u8 = 3;
+
+/// One member as described by the central directory
+pub const Member = struct {
+    /// Path inside the archive (points into the directory buffer)
+    path: []const u8,
+    method: Method,
+    flags: u16,
+    crc32: u32,
+    compressed_size: u64,
+    uncompressed_size: u64,
+
+    /// Offset of the member's local header from the start of the file
+    local_header_offset: u64,
+
+    entry_type: types.EntryType,
+    mode: u32,
+    mtime: i64,
+
+    pub fn isEncrypted(self: Member) bool {
+        return self.flags & flag_encrypted != 0;
+    }
+
+    /// Entry metadata for this member (symlink targets are filled in by the reader)
+    pub fn toEntry(self: Member) types.Entry {
+        return .{
+            .path = self.path,
+            .entry_type = self.entry_type,
+            .size = if (self.entry_type == .file) self.uncompressed_size else 0,
+            .mode = self.mode,
+            .mtime = self.mtime,
+        };
+    }
+};
+
+/// Parsed central directory
+pub const Directory = struct {
+    allocator: std.mem.Allocator,
+
+    /// Raw central directory bytes; member paths point into it
+    data: []u8,
+
+    members: []Member,
+
+    /// Offset of the central directory (member data must end before it)
+    offset: u64,
+
+    /// Read and parse the central directory of a ZIP file
+    ///
+    /// Only the end of the file and the directory itself are read.
+    ///
+    /// Parameters:
+    ///   - allocator: Memory allocator
+    ///   - file: ZIP file (read with positional reads; the file position is not used)
+    ///
+    /// Returns:
+    ///   - Directory owning its buffers (call deinit)
+    ///
+    /// Errors:
+    ///   - error.InvalidFormat: No end of central directory record
+    ///   - error.CorruptedHeader: Malformed or out-of-range directory records
+    ///   - error.UnsupportedFormat: Multi-disk (spanned) archive
+    ///   - error.OutOfMemory: Failed to allocate the directory
+    pub fn read(allocator: std.mem.Allocator, file: std.fs.File) !Directory {
+        const file_size = try file.getEndPos();
+        const end = try findEnd(file, file_size);
+
+        if (end.size > max_directory_size) return error.CorruptedHeader;
+        if (end.offset > end.position or end.size > end.position - end.offset) return error.CorruptedHeader;
+        // Every central header is at least 46 bytes
+        if (end.entries > end.size / central_header_size) return error.CorruptedHeader;
+
+        const data = try allocator.alloc(u8, @intCast(end.size));
+        errdefer allocator.free(data);
+        if (try file.preadAll(data, end.offset) != data.len) return error.CorruptedHeader;
+
+        const members = try allocator.alloc(Member, @intCast(end.entries));
+        errdefer allocator.free(members);
+
+        var pos: usize = 0;
+        for (members) |*member| {
+            const len = try parseCentralHeader(data[pos..], member);
+            if (member.local_header_offset >= end.offset) return error.CorruptedHeader;
+            pos += len;
+        }
+
+        return .{
+            .allocator = allocator,
+            .data = data,
+            .members = members,
+            .offset = end.offset,
+        };
+    }
+
+    pub fn deinit(self: *Directory) void {
+        self.allocator.free(self.members);
+        self.allocator.free(self.data);
+    }
+
+    /// Index of the member with this exact path
+    pub fn find(self: Directory, path: []const u8) ?usize {
+        for (self.members, 0..) |member, i| {
+            if (std.mem.eql(u8, member.path, path)) return i;
+        }
+        return null;
+    }
+};
+
+/// Location of the central directory
+const End = struct {
+    /// Offset and size of the central directory
+    offset: u64,
+    size: u64,
+    entries: u64,
+
+    /// Offset of the end of central directory record
+    position: u64,
+};
+
+/// Find the end of central directory record (and its ZIP64 counterpart)
+fn findEnd(file: std.fs.File, file_size: u64) !End {
+    if (file_size < end_of_directory_size) return error.InvalidFormat;
+
+    // The record is followed by a comment of at most 64 KiB
+    var tail: [end_of_directory_size + 0xFFFF]u8 = undefined;
+    const tail_len: usize = @intCast(@min(file_size, tail.len));
+    const tail_start = file_size - tail_len;
+    if (try file.preadAll(tail[0..tail_len], tail_start) != tail_len) return error.InvalidFormat;
+
+    var i = tail_len - end_of_directory_size;
+    const record = while (true) : (i -= 1) {
+        const candidate = tail[i..tail_len];
+        if (readU32(candidate, 0) == Signature.end_of_directory and
+            i + end_of_directory_size + readU16(candidate, 20) <= tail_len)
+        {
+            break candidate;
+        }
+        if (i == 0) return error.InvalidFormat;
+    };
+    const position = tail_start + i;
+
+    if (readU16(record, 4) != 0 or readU16(record, 6) != 0) return error.UnsupportedFormat;
+
+    var end = End{
+        .offset = readU32(record, 16),
+        .size = readU32(record, 12),
+        .entries = readU16(record, 10),
+        .position = position,
+    };
+
+    // A ZIP64 locator sits immediately before the end record
+    if (position >= zip64_locator_size) {
+        var locator: [zip64_locator_size]u8 = undefined;
+        if (try file.preadAll(&locator, position - zip64_locator_size) == locator.len and
+            readU32(&locator, 0) == Signature.zip64_locator)
+        {
+            const zip64_offset = readU64(&locator, 8);
+            if (zip64_offset > position - zip64_locator_size) return error.CorruptedHeader;
+
+            var zip64: [zip64_end_of_directory_size]u8 = undefined;
+            if (try file.preadAll(&zip64, zip64_offset) != zip64.len or
+                readU32(&zip64, 0) != Signature.zip64_end_of_directory)
+            {
+                return error.CorruptedHeader;
+            }
+            if (readU32(&zip64, 16) != 0 or readU32(&zip64, 20) != 0) return error.UnsupportedFormat;
+
+            end = .{
+                .entries = readU64(&zip64, 32),
+                .size = readU64(&zip64, 40),
+                .offset = readU64(&zip64, 48),
+                .position = zip64_offset,
+            };
+        }
+    }
+    return end;
+}
+
+/// Parse one central directory header
+///
+/// Returns:
+///   - Length of the record (fixed part, name, extra field and comment)
+fn parseCentralHeader(data: []const u8, member: *Member) !usize {
+    if (data.len < central_header_size) return error.CorruptedHeader;
+    if (readU32(data, 0) != Signature.central_header) return error.CorruptedHeader;
+
+    const made_by = readU16(data, 4);
+    const name_len: usize = readU16(data, 28);
+    const extra_len: usize = readU16(data, 30);
+    const comment_len: usize = readU16(data, 32);
+    const total = central_header_size + name_len + extra_len + comment_len;
+    if (data.len < total) return error.CorruptedHeader;
+
+    const path = data[central_header_size..][0..name_len];
+    const extra = data[central_header_size + name_len ..][0..extra_len];
+
+    member.* = .{
+        .path = path,
+        .method = @enumFromInt(readU16(data, 10)),
+        .flags = readU16(data, 8),
+        .crc32 = readU32(data, 16),
+        .compressed_size = readU32(data, 20),
+        .uncompressed_size = readU32(data, 24),
+        .local_header_offset = readU32(data, 42),
+        .entry_type = .file,
+        .mode = 0o644,
+        .mtime = dosToUnix(readU16(data, 14), readU16(data, 12)),
+    };
+
+    try parseExtra(extra, member);
+
+    // File type and permissions
+    const external = readU32(data, 38);
+    const unix_mode: u32 = external >> 16;
+    if (made_by >> 8 == host_unix and unix_mode != 0) {
+        member.entry_type = switch (unix_mode & 0o170000) {
+            0o040000 => .directory,
+            0o120000 => .symlink,
+            else => .file,
+        };
+        member.mode = unix_mode & 0o7777;
+    } else if (std.mem.endsWith(u8, path, "/") or external & 0x10 != 0) {
+        member.entry_type = .directory;
+        member.mode = 0o755;
+    }
+
+    return total;
+}
+
+/// Apply the ZIP64 and extended timestamp extra fields
+fn parseExtra(extra: []const u8, member: *Member) !void {
+    var pos: usize = 0;
+    while (pos + 4 <= extra.len) {
+        const id = readU16(extra, pos);
+        const size: usize = readU16(extra, pos + 2);
+        if (pos + 4 + size > extra.len) return error.CorruptedHeader;
+        const field = extra[pos + 4 ..][0..size];
+
+        switch (id) {
+            // ZIP64: 64-bit values for every 32-bit field saturated at 0xFFFFFFFF, in order
+            0x0001 => {
+                var at: usize = 0;
+                if (member.uncompressed_size == 0xFFFFFFFF) {
+                    if (at + 8 > field.len) return error.CorruptedHeader;
+                    member.uncompressed_size = readU64(field, at);
+                    at += 8;
+                }
+                if (member.compressed_size == 0xFFFFFFFF) {
+                    if (at + 8 > field.len) return error.CorruptedHeader;
+                    member.compressed_size = readU64(field, at);
+                    at += 8;
+                }
+                if (member.local_header_offset == 0xFFFFFFFF) {
+                    if (at + 8 > field.len) return error.CorruptedHeader;
+                    member.local_header_offset = readU64(field, at);
+                }
+            },
+            // Extended timestamp: flags byte, then mtime (UTC seconds) if bit 0 is set
+            0x5455 => {
+                if (field.len >= 5 and field[0] & 1 != 0) {
+                    member.mtime = std.mem.readInt(i32, field[1..5], .little);
+                }
+            },
+            else => {},
+        }
+        pos += 4 + size;
+    }
+}
+
+/// Convert an MS-DOS date and time to a Unix timestamp
+///
+/// DOS timestamps carry no time zone; they are interpreted as UTC.
+pub fn dosToUnix(date: u16, time: u16) i64 {
+    const year: i64 = 1980 + @as(i64, date >> 9);
+    const month: i64 = @max(1, @min(12, (date >> 5) & 0xF));
+    const day: i64 = @max(1, date & 0x1F);
+
+    // Days from civil (Howard Hinnant)
+    const y = if (month <= 2) year - 1 else year;
+    const era = @divFloor(y, 400);
+    const yoe = y - era * 400;
+    const mp = @mod(month + 9, 12);
+    const doy = @divFloor(153 * mp + 2, 5) + day - 1;
+    const doe = yoe * 365 + @divFloor(yoe, 4) - @divFloor(yoe, 100) + doy;
+    const days = era * 146097 + doe - 719468;
+
+    const hour: i64 = time >> 11;
+    const minute: i64 = (time >> 5) & 0x3F;
+    const second: i64 = (time & 0x1F) * 2;
+    return days * std.time.s_per_day + hour * 3600 + minute * 60 + second;
+}
+
+fn readU16(data: []const u8, offset: usize) u16 {
+    return std.mem.readInt(u16, data[offset..][0..2], .little);
+}
+
+fn readU32(data: []const u8, offset: usize) u32 {
+    return std.mem.readInt(u32, data[offset..][0..4], .little);
+}
+
+fn readU64(data: []const u8, offset: usize) u64 {
+    return std.mem.readInt(u64, data[offset..][0..8], .little);
+}
+
+// Tests
+test "dosToUnix: known timestamps" {
+    // 1980-01-01 00:00:00
+    try std.testing.expectEqual(@as(i64, 315532800), dosToUnix((0 << 9) | (1 << 5) | 1, 0));
+    // 2024-02-29 12:34:56
+    const date: u16 = (44 << 9) | (2 << 5) | 29;
+    const time: u16 = (12 << 11) | (34 << 5) | 28;
+    try std.testing.expectEqual(@as(i64, 1709210096), dosToUnix(date, time));
+}
+
+test "parseCentralHeader: unix mode, ZIP64 sizes and timestamp" {
+    var record = [_]u8{0} ** (central_header_size + 8 + 29);
+    std.mem.writeInt(u32, record[0..4], Signature.central_header, .little);
+    std.mem.writeInt(u16, record[4..6], (3 << 8) | 63, .little);
+    std.mem.writeInt(u16, record[10..12], 8, .little);
+    std.mem.writeInt(u32, record[16..20], 0xDEADBEEF, .little);
+    std.mem.writeInt(u32, record[20..24], 0xFFFFFFFF, .little);
+    std.mem.writeInt(u32, record[24..28], 0xFFFFFFFF, .little);
+    std.mem.writeInt(u16, record[28..30], 8, .little);
+    std.mem.writeInt(u16, record[30..32], 29, .little);
+    std.mem.writeInt(u32, record[38..42], @as(u32, 0o100755) << 16, .little);
+    std.mem.writeInt(u32, record[42..46], 1234, .little);
+    @memcpy(record[46..54], "bin/tool");
+
+    var extra = record[54..];
+    std.mem.writeInt(u16, extra[0..2], 0x0001, .little);
+    std.mem.writeInt(u16, extra[2..4], 16, .little);
+    std.mem.writeInt(u64, extra[4..12], 5 << 32, .little);
+    std.mem.writeInt(u64, extra[12..20], 3 << 32, .little);
+    std.mem.writeInt(u16, extra[20..22], 0x5455, .little);
+    std.mem.writeInt(u16, extra[22..24], 5, .little);
+    extra[24] = 1;
+    std.mem.writeInt(i32, extra[25..29], 1700000000, .little);
+
+    var member: Member = undefined;
+    const len = try parseCentralHeader(&record, &member);
+    try std.testing.expectEqual(record.len, len);
+    try std.testing.expectEqualStrings("bin/tool", member.path);
+    try std.testing.expectEqual(Method.deflated, member.method);
+    try std.testing.expectEqual(@as(u64, 5 << 32), member.uncompressed_size);
+    try std.testing.expectEqual(@as(u64, 3 << 32), member.compressed_size);
+    try std.testing.expectEqual(@as(u64, 1234), member.local_header_offset);
+    try std.testing.expectEqual(types.EntryType.file, member.entry_type);
+    try std.testing.expectEqual(@as(u32, 0o755), member.mode);
+    try std.testing.expectEqual(@as(i64, 1700000000), member.mtime);
+
+    // Truncated records are rejected
+    try std.testing.expectError(error.CorruptedHeader, parseCentralHeader(record[0..50], &member));
+}
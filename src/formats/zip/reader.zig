@@ -0,0 +1,896 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+const std = @import("std");
+const types = @import("../../core/types.zig");
+const archive = @import("../archive.zig");
+const directory = @import("directory.zig");
+const c_zlib = @import("../../c_compat/zlib.zig");
+const instrument = @import("../../core/instrument.zig");
+const trace = @import("../../core/trace.zig");
+
+pub const Member = directory.Member;
+pub const Method = directory.Method;
+pub const Directory = directory.Directory;
+
+/// Longest symlink target stored as member data
+const max_link_target = 4096;
+
+/// ZIP archive reader
+///
+/// Entries come from the central directory, so `next()` never touches
+/// member data and listing costs one read of the directory. Member data
+/// is located through its local header with positional reads, so any
+/// member can be read directly (`find` + `select`) without scanning the
+/// members before it.
+///
+/// Stored and deflated members are supported. Every member's size and
+/// CRC-32 are checked against the directory.
+///
+/// With `threads > 1`, members up to `max_parallel_member` bytes are
+/// decoded in batches on a thread pool (positional reads, raw inflate and
+/// CRC all run on the workers) the first time one of them is read; the
+/// allocator must then be thread-safe. Larger members stream through a
+/// single inflater on the calling thread.
+///
+/// Example:
+/// ```zig
+/// var reader = try ZipReader.init(allocator, file, .{ .threads = 0 });
+/// defer reader.deinit();
+///
+/// while (try reader.next()) |entry| {
+///     var buffer: [4096]u8 = undefined;
+///     while (true) {
+///         const n = try reader.read(&buffer);
+///         if (n == 0) break;
+///         // Process buffer[0..n]
+///     }
+/// }
+/// ```
+pub const ZipReader = struct {
+    allocator: std.mem.Allocator,
+    file: std.fs.File,
+    directory: Directory,
+
+    /// Member returned by the next call to next()
+    next_index: usize = 0,
+
+    /// Member being read
+    current: ?usize = null,
+
+    /// Where the current member's data comes from
+    source: Source = .none,
+
+    /// Sequential decoder for members not decoded in parallel
+    stream: MemberStream,
+
+    /// Target of the current symlink entry
+    link_target: [max_link_target]u8 = undefined,
+
+    /// Parallel decoder (null when single-threaded)
+    parallel: ?*Parallel = null,
+
+    /// Progress observer, called after each read with running totals
+    observer: ?types.StreamObserver = null,
+
+    /// Compressed bytes of members served from parallel batches
+    batch_compressed_bytes: u64 = 0,
+
+    /// Decompressed bytes returned by read()
+    uncompressed_bytes: u64 = 0,
+
+    pub const Options = struct {
+        /// Decoding threads (0 = one per CPU, 1 = decode on the calling thread)
+        threads: usize = 1,
+
+        /// Members up to this size (compressed and uncompressed) are decoded in parallel
+        max_parallel_member: usize = 8 * 1024 * 1024,
+
+        /// Most bytes decoded per parallel batch
+        batch_size: usize = 64 * 1024 * 1024,
+    };
+
+    const Source = union(enum) {
+        none,
+        /// Decoded by a parallel batch
+        buffered: struct { data: []const u8, pos: usize = 0 },
+        /// Decoded on demand by `stream`
+        stream,
+    };
+
+    /// Open a ZIP file and read its central directory
+    ///
+    /// Parameters:
+    ///   - allocator: Memory allocator (must be thread-safe when threads != 1)
+    ///   - file: ZIP file (not closed by deinit)
+    ///   - options: Decoding options
+    ///
+    /// Errors:
+    ///   - error.InvalidFormat: Not a ZIP file
+    ///   - error.CorruptedHeader: Malformed central directory
+    ///   - error.UnsupportedFormat: Multi-disk archive
+    ///   - error.OutOfMemory: Failed to allocate buffers
+    ///
+    /// Example:
+    /// ```zig
+    /// var reader = try ZipReader.init(allocator, file, .{});
+    /// defer reader.deinit();
+    /// ```
+    pub fn init(allocator: std.mem.Allocator, file: std.fs.File, options: Options) !ZipReader {
+        var dir = try Directory.read(allocator, file);
+        errdefer dir.deinit();
+
+        const in_buf = try allocator.alloc(u8, types.BufferSize.default);
+        errdefer allocator.free(in_buf);
+
+        var self = ZipReader{
+            .allocator = allocator,
+            .file = file,
+            .directory = dir,
+            .stream = .{ .file = file, .in_buf = in_buf },
+        };
+
+        const threads = if (options.threads == 0) std.Thread.getCpuCount() catch 1 else options.threads;
+        if (threads > 1) {
+            self.parallel = try Parallel.create(allocator, dir, threads, options);
+        }
+        return self;
+    }
+
+    /// Release the directory, buffers and worker threads
+    ///
+    /// Note: Does not close the file (caller is responsible)
+    pub fn deinit(self: *ZipReader) void {
+        if (self.parallel) |parallel| parallel.destroy(self.allocator);
+        self.parallel = null;
+        self.stream.deinit();
+        self.allocator.free(self.stream.in_buf);
+        self.directory.deinit();
+    }
+
+    /// Attach a progress observer (e.g. a ratio monitor)
+    pub fn setObserver(self: *ZipReader, observer: ?types.StreamObserver) void {
+        self.observer = observer;
+    }
+
+    /// All members, in central directory order
+    pub fn members(self: *const ZipReader) []const Member {
+        return self.directory.members;
+    }
+
+    /// Index of the member with this exact path
+    pub fn find(self: *const ZipReader, path: []const u8) ?usize {
+        return self.directory.find(path);
+    }
+
+    /// Create an ArchiveReader interface from this ZipReader
+    pub fn archiveReader(self: *ZipReader) archive.ArchiveReader {
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .next = nextVTable,
+                .read = readVTable,
+                .deinit = deinitVTable,
+            },
+        };
+    }
+
+    fn nextVTable(ptr: *anyopaque) anyerror!?types.Entry {
+        const self: *ZipReader = @ptrCast(@alignCast(ptr));
+        return self.next();
+    }
+
+    fn readVTable(ptr: *anyopaque, buffer: []u8) anyerror!usize {
+        const self: *ZipReader = @ptrCast(@alignCast(ptr));
+        return self.read(buffer);
+    }
+
+    fn deinitVTable(ptr: *anyopaque) void {
+        const self: *ZipReader = @ptrCast(@alignCast(ptr));
+        self.deinit();
+    }
+
+    /// Get the next member in central directory order
+    ///
+    /// Returns:
+    ///   - Entry (valid until the next call to next() or select()), or null at the end
+    ///
+    /// Errors:
+    ///   - (Errors from reading a symlink target)
+    pub fn next(self: *ZipReader) !?types.Entry {
+        if (self.next_index >= self.directory.members.len) {
+            self.current = null;
+            self.source = .none;
+            return null;
+        }
+        return try self.select(self.next_index);
+    }
+
+    /// Position the reader on one member, for selective extraction
+    ///
+    /// The member's data is read directly from its offset; next()
+    /// continues with the member after it.
+    ///
+    /// Parameters:
+    ///   - index: Member index (see `find`)
+    ///
+    /// Returns:
+    ///   - Entry for the member
+    ///
+    /// Example:
+    /// ```zig
+    /// const index = reader.find("docs/README.md") orelse return error.FileNotFound;
+    /// const entry = try reader.select(index);
+    /// const n = try reader.read(&buffer);
+    /// ```
+    pub fn select(self: *ZipReader, index: usize) !types.Entry {
+        const member = &self.directory.members[index];
+        self.current = index;
+        self.next_index = index + 1;
+        self.source = .none;
+
+        var entry = member.toEntry();
+        if (member.entry_type == .symlink) {
+            entry.link_target = try self.readLinkTarget(member.*);
+        }
+        return entry;
+    }
+
+    /// Read data from the current member
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 when the member is fully read)
+    ///
+    /// Errors:
+    ///   - error.NoCurrentEntry: next() has not returned a member
+    ///   - error.UnsupportedMethod: Encrypted member or unknown compression method
+    ///   - error.ChecksumMismatch: CRC-32 does not match the directory
+    ///   - error.CorruptedStream: Size does not match the directory, or bad deflate data
+    ///   - error.IncompleteArchive: Member data is truncated
+    pub fn read(self: *ZipReader, buffer: []u8) !usize {
+        const index = self.current orelse return error.NoCurrentEntry;
+        if (self.directory.members[index].entry_type != .file) return 0;
+
+        if (self.source == .none) try self.open(index);
+
+        const n = switch (self.source) {
+            .buffered => |*b| blk: {
+                const n = @min(buffer.len, b.data.len - b.pos);
+                @memcpy(buffer[0..n], b.data[b.pos..][0..n]);
+                b.pos += n;
+                break :blk n;
+            },
+            .stream => try self.stream.read(buffer),
+            .none => unreachable,
+        };
+
+        if (n > 0) {
+            self.uncompressed_bytes += n;
+            if (self.observer) |observer| {
+                try observer.observe(self.batch_compressed_bytes + self.stream.compressed_read, self.uncompressed_bytes);
+            }
+        }
+        return n;
+    }
+
+    /// Set up the data source for a file member
+    fn open(self: *ZipReader, index: usize) !void {
+        const member = self.directory.members[index];
+        try checkSupported(member);
+
+        if (self.parallel) |parallel| {
+            if (!parallel.covers(index) and parallel.accepts(member)) {
+                try parallel.decodeBatch(self.file, self.directory, index);
+            }
+            if (parallel.covers(index)) {
+                const task = &parallel.tasks[index - parallel.first];
+                if (task.err) |err| return err;
+                self.source = .{ .buffered = .{ .data = task.output } };
+                self.batch_compressed_bytes += member.compressed_size;
+                return;
+            }
+        }
+
+        try self.stream.begin(member, try dataOffset(self.file, self.directory.offset, member));
+        self.source = .stream;
+    }
+
+    /// Read a symlink member's target into `link_target`
+    fn readLinkTarget(self: *ZipReader, member: Member) ![]const u8 {
+        try checkSupported(member);
+        if (member.uncompressed_size > max_link_target) return error.CorruptedHeader;
+
+        try self.stream.begin(member, try dataOffset(self.file, self.directory.offset, member));
+        var len: usize = 0;
+        while (true) {
+            const n = try self.stream.read(self.link_target[len..]);
+            if (n == 0) break;
+            len += n;
+        }
+        return self.link_target[0..len];
+    }
+};
+
+/// Reject members this reader cannot decode
+fn checkSupported(member: Member) !void {
+    if (member.isEncrypted()) return error.UnsupportedMethod;
+    switch (member.method) {
+        .stored => if (member.compressed_size != member.uncompressed_size) return error.CorruptedHeader,
+        .deflated => {},
+        _ => return error.UnsupportedMethod,
+    }
+}
+
+/// Offset of a member's data, from its local header
+fn dataOffset(file: std.fs.File, directory_offset: u64, member: Member) !u64 {
+    var local: [directory.local_header_size]u8 = undefined;
+    if (try preadCounted(file, &local, member.local_header_offset) != local.len) return error.IncompleteArchive;
+    if (std.mem.readInt(u32, local[0..4], .little) != directory.Signature.local_header) {
+        return error.CorruptedHeader;
+    }
+
+    const name_len = std.mem.readInt(u16, local[26..28], .little);
+    const extra_len = std.mem.readInt(u16, local[28..30], .little);
+    const offset = member.local_header_offset + directory.local_header_size + name_len + extra_len;
+    if (offset > directory_offset or member.compressed_size > directory_offset - offset) {
+        return error.CorruptedHeader;
+    }
+    return offset;
+}
+
+/// Positional read, timed and counted as archive reads
+fn preadCounted(file: std.fs.File, buffer: []u8, offset: u64) !usize {
+    const span = instrument.begin(.read);
+    defer span.end();
+    const n = try file.preadAll(buffer, offset);
+    instrument.count(.syscalls, 1);
+    instrument.count(.bytes_read, n);
+    return n;
+}
+
+/// Decoder for one member at a time, using positional reads
+const MemberStream = struct {
+    file: std.fs.File,
+    in_buf: []u8,
+    in_start: usize = 0,
+    in_end: usize = 0,
+
+    /// Raw inflater, created on first use and reset per member
+    inflater: ?c_zlib.Inflater = null,
+
+    member: Member = undefined,
+
+    /// Next compressed byte to read, and how many are left
+    offset: u64 = 0,
+    compressed_left: u64 = 0,
+
+    produced: u64 = 0,
+    crc: u32 = 0,
+    finished: bool = true,
+
+    /// Compressed bytes read, over all members
+    compressed_read: u64 = 0,
+
+    fn deinit(self: *MemberStream) void {
+        if (self.inflater) |*inflater| inflater.deinit();
+        self.inflater = null;
+    }
+
+    fn begin(self: *MemberStream, member: Member, data_offset: u64) !void {
+        if (member.method == .deflated) {
+            if (self.inflater) |*inflater| {
+                try inflater.reset();
+            } else {
+                self.inflater = try c_zlib.Inflater.init(.raw);
+            }
+        }
+        self.member = member;
+        self.offset = data_offset;
+        self.compressed_left = member.compressed_size;
+        self.in_start = 0;
+        self.in_end = 0;
+        self.produced = 0;
+        self.crc = 0;
+        self.finished = false;
+    }
+
+    fn read(self: *MemberStream, dest: []u8) !usize {
+        if (self.finished or dest.len == 0) return 0;
+        return switch (self.member.method) {
+            .stored => self.readStored(dest),
+            else => self.readDeflated(dest),
+        };
+    }
+
+    fn readStored(self: *MemberStream, dest: []u8) !usize {
+        const remaining = self.member.uncompressed_size - self.produced;
+        const n: usize = @intCast(@min(dest.len, remaining));
+        if (n > 0) {
+            if (try preadCounted(self.file, dest[0..n], self.offset) != n) return error.IncompleteArchive;
+            self.offset += n;
+            self.compressed_left -= n;
+            self.compressed_read += n;
+            self.update(dest[0..n]);
+        }
+        if (self.produced == self.member.uncompressed_size) try self.finish();
+        return n;
+    }
+
+    fn readDeflated(self: *MemberStream, dest: []u8) !usize {
+        const inflater = &self.inflater.?;
+        while (true) {
+            if (self.in_start == self.in_end and self.compressed_left > 0) try self.fill();
+
+            const step = blk: {
+                const span = instrument.begin(.inflate);
+                defer span.end();
+                break :blk try inflater.step(self.in_buf[self.in_start..self.in_end], dest);
+            };
+            self.in_start += step.consumed;
+
+            if (step.produced > 0) {
+                if (self.produced + step.produced > self.member.uncompressed_size) return error.CorruptedStream;
+                self.update(dest[0..step.produced]);
+            }
+            if (step.stream_end) {
+                try self.finish();
+                return step.produced;
+            }
+            if (step.produced > 0) return step.produced;
+
+            if (step.consumed == 0) {
+                // No progress: zlib needs input we do not have
+                if (self.compressed_left == 0) return error.IncompleteArchive;
+                try self.fill();
+            }
+        }
+    }
+
+    /// Move unconsumed input to the front and read more
+    fn fill(self: *MemberStream) !void {
+        const leftover = self.in_end - self.in_start;
+        std.mem.copyForwards(u8, self.in_buf[0..leftover], self.in_buf[self.in_start..self.in_end]);
+        self.in_start = 0;
+        self.in_end = leftover;
+
+        const want: usize = @intCast(@min(self.in_buf.len - self.in_end, self.compressed_left));
+        if (want == 0) return;
+        if (try preadCounted(self.file, self.in_buf[self.in_end..][0..want], self.offset) != want) {
+            return error.IncompleteArchive;
+        }
+        self.offset += want;
+        self.compressed_left -= want;
+        self.compressed_read += want;
+        self.in_end += want;
+    }
+
+    fn update(self: *MemberStream, data: []const u8) void {
+        const span = instrument.begin(.crc);
+        defer span.end();
+        self.crc = c_zlib.crc32Update(self.crc, data);
+        self.produced += data.len;
+    }
+
+    /// Check the decoded member against the directory
+    fn finish(self: *MemberStream) !void {
+        self.finished = true;
+        if (self.produced != self.member.uncompressed_size) return error.CorruptedStream;
+        if (self.crc != self.member.crc32) return error.ChecksumMismatch;
+    }
+};
+
+/// Batch decoder: whole members inflated and CRC-checked on a thread pool
+const Parallel = struct {
+    pool: std.Thread.Pool,
+    options: ZipReader.Options,
+
+    /// Compressed input and decoded output for one batch
+    in_buf: []u8,
+    out_buf: []u8,
+    tasks: []Task,
+
+    /// Members [first, first + count) are decoded in `tasks`
+    first: usize = 0,
+    count: usize = 0,
+
+    /// Members queued per thread in one batch
+    const tasks_per_thread = 64;
+
+    const Task = struct {
+        file: std.fs.File = undefined,
+        directory_offset: u64 = 0,
+        member: Member = undefined,
+
+        /// Empty for members without data (directories, symlinks)
+        input: []u8 = &.{},
+        output: []u8 = &.{},
+        has_data: bool = false,
+
+        err: ?anyerror = null,
+    };
+
+    fn create(allocator: std.mem.Allocator, dir: Directory, threads: usize, options: ZipReader.Options) !*Parallel {
+        // Size the batch buffers for this archive, up to `batch_size`
+        var compressed: u64 = 0;
+        var uncompressed: u64 = 0;
+        for (dir.members) |member| {
+            if (member.entry_type != .file) continue;
+            compressed +|= member.compressed_size;
+            uncompressed +|= member.uncompressed_size;
+        }
+
+        const self = try allocator.create(Parallel);
+        errdefer allocator.destroy(self);
+
+        const in_buf = try allocator.alloc(u8, @intCast(@min(compressed, options.batch_size)));
+        errdefer allocator.free(in_buf);
+        const out_buf = try allocator.alloc(u8, @intCast(@min(uncompressed, options.batch_size)));
+        errdefer allocator.free(out_buf);
+        const tasks = try allocator.alloc(Task, threads * tasks_per_thread);
+        errdefer allocator.free(tasks);
+
+        self.* = .{
+            .pool = undefined,
+            .options = options,
+            .in_buf = in_buf,
+            .out_buf = out_buf,
+            .tasks = tasks,
+        };
+        try self.pool.init(.{ .allocator = allocator, .n_jobs = threads });
+        return self;
+    }
+
+    fn destroy(self: *Parallel, allocator: std.mem.Allocator) void {
+        self.pool.deinit();
+        allocator.free(self.tasks);
+        allocator.free(self.out_buf);
+        allocator.free(self.in_buf);
+        allocator.destroy(self);
+    }
+
+    fn covers(self: *const Parallel, index: usize) bool {
+        return index >= self.first and index < self.first + self.count;
+    }
+
+    /// Whether a member is small enough to decode in a batch
+    fn accepts(self: *const Parallel, member: Member) bool {
+        const limit = @min(self.options.max_parallel_member, self.in_buf.len, self.out_buf.len);
+        return member.entry_type == .file and
+            member.compressed_size <= limit and
+            member.uncompressed_size <= limit;
+    }
+
+    /// Decode members from `start` until a buffer, the task list or a large member ends the batch
+    fn decodeBatch(self: *Parallel, file: std.fs.File, dir: Directory, start: usize) !void {
+        var count: usize = 0;
+        var in_used: usize = 0;
+        var out_used: usize = 0;
+
+        for (dir.members[start..]) |member| {
+            if (count == self.tasks.len) break;
+
+            var task = Task{ .file = file, .directory_offset = dir.offset, .member = member };
+            if (member.entry_type == .file) {
+                if (!self.accepts(member)) break;
+                checkSupported(member) catch break;
+
+                const compressed: usize = @intCast(member.compressed_size);
+                const uncompressed: usize = @intCast(member.uncompressed_size);
+                const needs_input = member.method == .deflated;
+                if ((needs_input and in_used + compressed > self.in_buf.len) or
+                    out_used + uncompressed > self.out_buf.len)
+                {
+                    break;
+                }
+
+                if (needs_input) {
+                    task.input = self.in_buf[in_used..][0..compressed];
+                    in_used += compressed;
+                }
+                task.output = self.out_buf[out_used..][0..uncompressed];
+                out_used += uncompressed;
+                task.has_data = true;
+            }
+            self.tasks[count] = task;
+            count += 1;
+        }
+
+        var wg: std.Thread.WaitGroup = .{};
+        for (self.tasks[0..count]) |*task| {
+            if (task.has_data) self.pool.spawnWg(&wg, decodeTask, .{task});
+        }
+        self.pool.waitAndWork(&wg);
+
+        self.first = start;
+        self.count = count;
+    }
+
+    /// Worker: read, inflate and CRC-check one member
+    fn decodeTask(task: *Task) void {
+        trace.setThreadName("zip worker");
+        decodeMember(task) catch |err| {
+            task.err = err;
+        };
+    }
+
+    fn decodeMember(task: *Task) !void {
+        const member = task.member;
+        const offset = try dataOffset(task.file, task.directory_offset, member);
+
+        switch (member.method) {
+            .stored => {
+                if (try preadCounted(task.file, task.output, offset) != task.output.len) return error.IncompleteArchive;
+            },
+            else => {
+                if (try preadCounted(task.file, task.input, offset) != task.input.len) return error.IncompleteArchive;
+
+                const span = instrument.begin(.inflate);
+                defer span.end();
+
+                var inflater = try c_zlib.Inflater.init(.raw);
+                defer inflater.deinit();
+
+                var consumed: usize = 0;
+                var produced: usize = 0;
+                var spare: [1]u8 = undefined;
+                while (true) {
+                    // Once the output is full, anything but the end of stream is excess data
+                    const dst = if (produced < task.output.len) task.output[produced..] else &spare;
+                    const step = try inflater.step(task.input[consumed..], dst);
+                    consumed += step.consumed;
+                    if (produced == task.output.len and step.produced > 0) return error.CorruptedStream;
+                    produced += step.produced;
+                    if (step.stream_end) break;
+                    if (step.consumed == 0 and step.produced == 0) return error.IncompleteArchive;
+                }
+                if (produced != task.output.len) return error.CorruptedStream;
+            },
+        }
+
+        const span = instrument.begin(.crc);
+        defer span.end();
+        if (c_zlib.crc32Update(0, task.output) != member.crc32) return error.ChecksumMismatch;
+    }
+};
+
+// Tests
+
+const TestMember = struct {
+    path: []const u8,
+    data: []const u8 = "",
+    method: Method = .stored,
+    mode: u32 = 0o100644,
+    crc_xor: u32 = 0,
+};
+
+/// Build a ZIP file in memory (optionally with ZIP64 end records)
+fn buildTestZip(allocator: std.mem.Allocator, members: []const TestMember, zip64: bool) ![]u8 {
+    var out = std.ArrayList(u8).init(allocator);
+    errdefer out.deinit();
+    var central = std.ArrayList(u8).init(allocator);
+    defer central.deinit();
+
+    const w = out.writer();
+    const cw = central.writer();
+
+    for (members) |m| {
+        const offset: u32 = @intCast(out.items.len);
+        const body = if (m.method == .deflated)
+            try c_zlib.compress(allocator, .raw, m.data)
+        else
+            try allocator.dupe(u8, m.data);
+        defer allocator.free(body);
+        const crc = c_zlib.crc32Update(0, m.data) ^ m.crc_xor;
+
+        try w.writeInt(u32, directory.Signature.local_header, .little);
+        try w.writeInt(u16, 20, .little);
+        try w.writeInt(u16, 0, .little);
+        try w.writeInt(u16, @intFromEnum(m.method), .little);
+        try w.writeInt(u16, 0, .little);
+        try w.writeInt(u16, 0x21, .little);
+        try w.writeInt(u32, crc, .little);
+        try w.writeInt(u32, @intCast(body.len), .little);
+        try w.writeInt(u32, @intCast(m.data.len), .little);
+        try w.writeInt(u16, @intCast(m.path.len), .little);
+        try w.writeInt(u16, 0, .little);
+        try w.writeAll(m.path);
+        try w.writeAll(body);
+
+        try cw.writeInt(u32, directory.Signature.central_header, .little);
+        try cw.writeInt(u16, (3 << 8) | 20, .little);
+        try cw.writeInt(u16, 20, .little);
+        try cw.writeInt(u16, 0, .little);
+        try cw.writeInt(u16, @intFromEnum(m.method), .little);
+        try cw.writeInt(u16, 0, .little);
+        try cw.writeInt(u16, 0x21, .little);
+        try cw.writeInt(u32, crc, .little);
+        try cw.writeInt(u32, @intCast(body.len), .little);
+        try cw.writeInt(u32, @intCast(m.data.len), .little);
+        try cw.writeInt(u16, @intCast(m.path.len), .little);
+        try cw.writeInt(u16, 0, .little);
+        try cw.writeInt(u16, 0, .little);
+        try cw.writeInt(u16, 0, .little);
+        try cw.writeInt(u16, 0, .little);
+        try cw.writeInt(u32, m.mode << 16, .little);
+        try cw.writeInt(u32, offset, .little);
+        try cw.writeAll(m.path);
+    }
+
+    const cd_offset = out.items.len;
+    try out.appendSlice(central.items);
+
+    if (zip64) {
+        const zip64_offset = out.items.len;
+        try w.writeInt(u32, directory.Signature.zip64_end_of_directory, .little);
+        try w.writeInt(u64, directory.zip64_end_of_directory_size - 12, .little);
+        try w.writeInt(u16, 45, .little);
+        try w.writeInt(u16, 45, .little);
+        try w.writeInt(u32, 0, .little);
+        try w.writeInt(u32, 0, .little);
+        try w.writeInt(u64, members.len, .little);
+        try w.writeInt(u64, members.len, .little);
+        try w.writeInt(u64, central.items.len, .little);
+        try w.writeInt(u64, cd_offset, .little);
+
+        try w.writeInt(u32, directory.Signature.zip64_locator, .little);
+        try w.writeInt(u32, 0, .little);
+        try w.writeInt(u64, zip64_offset, .little);
+        try w.writeInt(u32, 1, .little);
+    }
+
+    try w.writeInt(u32, directory.Signature.end_of_directory, .little);
+    try w.writeInt(u16, 0, .little);
+    try w.writeInt(u16, 0, .little);
+    try w.writeInt(u16, if (zip64) 0xFFFF else @intCast(members.len), .little);
+    try w.writeInt(u16, if (zip64) 0xFFFF else @intCast(members.len), .little);
+    try w.writeInt(u32, if (zip64) 0xFFFFFFFF else @intCast(central.items.len), .little);
+    try w.writeInt(u32, if (zip64) 0xFFFFFFFF else @intCast(cd_offset), .little);
+    try w.writeInt(u16, 0, .little);
+
+    return out.toOwnedSlice();
+}
+
+fn writeTestZip(dir: std.fs.Dir, name: []const u8, members: []const TestMember, zip64: bool) !std.fs.File {
+    const data = try buildTestZip(std.testing.allocator, members, zip64);
+    defer std.testing.allocator.free(data);
+    try dir.writeFile(.{ .sub_path = name, .data = data });
+    return dir.openFile(name, .{});
+}
+
+/// Read every member and check it against its source
+fn expectMembers(reader: *ZipReader, expected: []const TestMember) !void {
+    var buffer: [1000]u8 = undefined;
+    var data = std.ArrayList(u8).init(std.testing.allocator);
+    defer data.deinit();
+
+    for (expected) |m| {
+        const entry = (try reader.next()).?;
+        try std.testing.expectEqualStrings(m.path, entry.path);
+
+        data.clearRetainingCapacity();
+        while (true) {
+            const n = try reader.read(&buffer);
+            if (n == 0) break;
+            try data.appendSlice(buffer[0..n]);
+        }
+
+        switch (entry.entry_type) {
+            .file => try std.testing.expectEqualStrings(m.data, data.items),
+            .symlink => try std.testing.expectEqualStrings(m.data, entry.link_target),
+            else => try std.testing.expectEqual(@as(usize, 0), data.items.len),
+        }
+    }
+    try std.testing.expect((try reader.next()) == null);
+}
+
+const test_members = [_]TestMember{
+    .{ .path = "dir/", .mode = 0o040755 },
+    .{ .path = "dir/a.txt", .data = "hello zip " ** 300, .method = .deflated },
+    .{ .path = "dir/b.bin", .data = "stored bytes" },
+    .{ .path = "empty", .method = .deflated },
+    .{ .path = "link", .data = "dir/a.txt", .mode = 0o120777 },
+    .{ .path = "big.txt", .data = "0123456789abcdef" ** 4096, .method = .deflated },
+};
+
+test "ZipReader: sequential read of stored, deflated, directory and symlink members" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const file = try writeTestZip(tmp_dir.dir, "test.zip", &test_members, false);
+    defer file.close();
+
+    var reader = try ZipReader.init(std.testing.allocator, file, .{});
+    defer reader.deinit();
+
+    try std.testing.expectEqual(test_members.len, reader.members().len);
+    try std.testing.expectEqual(types.EntryType.directory, reader.members()[0].entry_type);
+    try std.testing.expectEqual(@as(u32, 0o755), reader.members()[0].mode);
+    try std.testing.expectEqual(@as(i64, 315532800), reader.members()[1].mtime);
+
+    try expectMembers(&reader, &test_members);
+}
+
+test "ZipReader: parallel decode matches sequential" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const file = try writeTestZip(tmp_dir.dir, "test.zip", &test_members, false);
+    defer file.close();
+
+    // A small member limit sends big.txt through the streaming path
+    var reader = try ZipReader.init(std.testing.allocator, file, .{ .threads = 4, .max_parallel_member = 16 * 1024 });
+    defer reader.deinit();
+
+    try expectMembers(&reader, &test_members);
+}
+
+test "ZipReader: ZIP64 end records and selective read" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const file = try writeTestZip(tmp_dir.dir, "test64.zip", &test_members, true);
+    defer file.close();
+
+    var reader = try ZipReader.init(std.testing.allocator, file, .{});
+    defer reader.deinit();
+    try std.testing.expectEqual(test_members.len, reader.members().len);
+
+    const index = reader.find("dir/b.bin").?;
+    const entry = try reader.select(index);
+    try std.testing.expectEqual(@as(u64, 12), entry.size);
+
+    var buffer: [64]u8 = undefined;
+    const n = try reader.read(&buffer);
+    try std.testing.expectEqualStrings("stored bytes", buffer[0..n]);
+
+    // next() continues after the selected member
+    try std.testing.expectEqualStrings("empty", (try reader.next()).?.path);
+    try std.testing.expect(reader.find("missing") == null);
+}
+
+test "ZipReader: CRC mismatch is detected on both paths" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const bad = [_]TestMember{
+        .{ .path = "bad.txt", .data = "corrupted? " ** 50, .method = .deflated, .crc_xor = 1 },
+    };
+    const file = try writeTestZip(tmp_dir.dir, "bad.zip", &bad, false);
+    defer file.close();
+
+    for ([_]usize{ 1, 2 }) |threads| {
+        var reader = try ZipReader.init(std.testing.allocator, file, .{ .threads = threads });
+        defer reader.deinit();
+
+        _ = (try reader.next()).?;
+        try std.testing.expectError(error.ChecksumMismatch, drain(&reader));
+    }
+}
+
+fn drain(reader: *ZipReader) !void {
+    var buffer: [4096]u8 = undefined;
+    while (try reader.read(&buffer) != 0) {}
+}
+
+test "ZipReader: rejects files without a central directory" {
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    try tmp_dir.dir.writeFile(.{ .sub_path = "not.zip", .data = "PK\x03\x04 but nothing else of a zip file" });
+    const file = try tmp_dir.dir.openFile("not.zip", .{});
+    defer file.close();
+
+    try std.testing.expectError(error.InvalidFormat, ZipReader.init(std.testing.allocator, file, .{}));
+}
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+const std = @import("std");
+const builtin = @import("builtin");
+const types = @import("../core/types.zig");
+const trace = @import("../core/trace.zig");
+
+/// Reader that pulls from its source on a background thread
+///
+/// The source is read into a small ring of blocks by a producer thread
+/// while the consumer works on earlier blocks, so an expensive source
+/// (e.g. a decompressor) overlaps with whatever consumes its output.
+/// Errors from the source are delivered to the consumer after all data
+/// produced before the error.
+///
+/// The source is only ever touched by the producer thread. Single-threaded
+/// builds read the source directly.
+///
+/// Example:
+/// ```zig
+/// var ahead: ReadAhead = undefined;
+/// try ahead.init(allocator, inflate_reader.any(), .{});
+/// defer ahead.deinit();
+/// try ahead.start();
+///
+/// const n = try ahead.read(&buffer);
+/// ```
+pub const ReadAhead = struct {
+    allocator: std.mem.Allocator,
+    source: std.io.AnyReader,
+
+    /// Ring of blocks and the number of valid bytes in each
+    blocks: [][]u8,
+    lens: []usize,
+
+    mutex: std.Thread.Mutex = .{},
+    not_empty: std.Thread.Condition = .{},
+    not_full: std.Thread.Condition = .{},
+
+    /// Oldest filled block and number of filled blocks (guarded by mutex)
+    head: usize = 0,
+    filled: usize = 0,
+
+    /// Producer state (guarded by mutex)
+    eof: bool = false,
+    err: ?anyerror = null,
+    stop: bool = false,
+
+    /// Consumer position inside the head block (consumer-owned)
+    reading: bool = false,
+    pos: usize = 0,
+
+    thread: ?std.Thread = null,
+
+    pub const Options = struct {
+        /// Size of each block
+        block_size: usize = types.BufferSize.large,
+
+        /// Number of blocks in flight
+        depth: usize = 4,
+    };
+
+    pub const Reader = std.io.Reader(*ReadAhead, anyerror, read);
+
+    /// Initialize in place (the producer thread keeps a pointer to `self`)
+    ///
+    /// Errors:
+    ///   - error.OutOfMemory: Failed to allocate blocks
+    pub fn init(self: *ReadAhead, allocator: std.mem.Allocator, source: std.io.AnyReader, options: Options) !void {
+        std.debug.assert(options.depth > 0 and options.block_size > 0);
+
+        const blocks = try allocator.alloc([]u8, options.depth);
+        errdefer allocator.free(blocks);
+        const lens = try allocator.alloc(usize, options.depth);
+        errdefer allocator.free(lens);
+
+        var allocated: usize = 0;
+        errdefer for (blocks[0..allocated]) |block| allocator.free(block);
+        for (blocks) |*block| {
+            block.* = try allocator.alloc(u8, options.block_size);
+            allocated += 1;
+        }
+
+        self.* = .{
+            .allocator = allocator,
+            .source = source,
+            .blocks = blocks,
+            .lens = lens,
+        };
+    }
+
+    /// Start the producer thread
+    ///
+    /// Errors:
+    ///   - (Errors from std.Thread.spawn)
+    pub fn start(self: *ReadAhead) !void {
+        if (builtin.single_threaded) return;
+        self.thread = try std.Thread.spawn(.{}, produce, .{self});
+    }
+
+    /// Stop the producer and free blocks
+    ///
+    /// Safe to call before all data has been consumed.
+    pub fn deinit(self: *ReadAhead) void {
+        if (self.thread) |thread| {
+            self.mutex.lock();
+            self.stop = true;
+            self.not_full.signal();
+            self.mutex.unlock();
+            thread.join();
+            self.thread = null;
+        }
+
+        for (self.blocks) |block| self.allocator.free(block);
+        self.allocator.free(self.blocks);
+        self.allocator.free(self.lens);
+    }
+
+    /// Read buffered data, waiting for the producer when necessary
+    ///
+    /// Returns:
+    ///   - Number of bytes read (0 = end of stream)
+    ///
+    /// Errors:
+    ///   - (Any error returned by the source)
+    pub fn read(self: *ReadAhead, dest: []u8) anyerror!usize {
+        if (dest.len == 0) return 0;
+        if (self.thread == null) return self.source.read(dest);
+
+        if (!self.reading) {
+            self.mutex.lock();
+            defer self.mutex.unlock();
+
+            while (self.filled == 0) {
+                if (self.err) |err| return err;
+                if (self.eof) return 0;
+                self.not_empty.wait(&self.mutex);
+            }
+            self.reading = true;
+            self.pos = 0;
+        }
+
+        // The head block belongs to the consumer until it is released
+        const block = self.blocks[self.head][0..self.lens[self.head]];
+        const n = @min(dest.len, block.len - self.pos);
+        @memcpy(dest[0..n], block[self.pos..][0..n]);
+        self.pos += n;
+
+        if (self.pos == block.len) {
+            self.mutex.lock();
+            self.head = (self.head + 1) % self.blocks.len;
+            self.filled -= 1;
+            self.not_full.signal();
+            self.mutex.unlock();
+            self.reading = false;
+        }
+
+        return n;
+    }
+
+    /// Get a std.io.Reader for this read-ahead buffer
+    pub fn reader(self: *ReadAhead) Reader {
+        return .{ .context = self };
+    }
+
+    /// Producer thread: fill free blocks until end of stream, error or stop
+    fn produce(self: *ReadAhead) void {
+        trace.setThreadName("readahead");
+        while (true) {
+            self.mutex.lock();
+            while (self.filled == self.blocks.len and !self.stop) {
+                self.not_full.wait(&self.mutex);
+            }
+            if (self.stop) {
+                self.mutex.unlock();
+                return;
+            }
+            const slot = (self.head + self.filled) % self.blocks.len;
+            self.mutex.unlock();
+
+            // Fill the free block without holding the lock
+            const block = self.blocks[slot];
+            var len: usize = 0;
+            var err: ?anyerror = null;
+            var eof = false;
+            while (len < block.len) {
+                const n = self.source.read(block[len..]) catch |e| {
+                    err = e;
+                    break;
+                };
+                if (n == 0) {
+                    eof = true;
+                    break;
+                }
+                len += n;
+            }
+
+            self.mutex.lock();
+            self.lens[slot] = len;
+            if (len > 0) self.filled += 1;
+            self.err = err;
+            self.eof = eof;
+            self.not_empty.signal();
+            self.mutex.unlock();
+
+            if (err != null or eof) return;
+        }
+    }
+};
+
+// Tests
+test "ReadAhead: delivers all bytes in order" {
+    const allocator = std.testing.allocator;
+
+    var data: [100_000]u8 = undefined;
+    for (&data, 0..) |*b, i| b.* = @truncate(i *% 31);
+
+    var fbs = std.io.fixedBufferStream(&data);
+    const source = fbs.reader();
+
+    var ahead: ReadAhead = undefined;
+    try ahead.init(allocator, source.any(), .{ .block_size = 4096, .depth = 3 });
+    defer ahead.deinit();
+    try ahead.start();
+
+    const out = try ahead.reader().readAllAlloc(allocator, data.len + 1);
+    defer allocator.free(out);
+
+    try std.testing.expectEqualSlices(u8, &data, out);
+}
+
+test "ReadAhead: source errors follow earlier data" {
+    const allocator = std.testing.allocator;
+
+    const Failing = struct {
+        served: usize = 0,
+
+        fn read(context: *const anyopaque, buffer: []u8) anyerror!usize {
+            const self: *@This() = @constCast(@ptrCast(@alignCast(context)));
+            if (self.served >= 10_000) return error.CorruptedStream;
+            const n = @min(buffer.len, 10_000 - self.served);
+            @memset(buffer[0..n], 'z');
+            self.served += n;
+            return n;
+        }
+    };
+    var failing = Failing{};
+
+    var ahead: ReadAhead = undefined;
+    try ahead.init(allocator, .{ .context = &failing, .readFn = Failing.read }, .{ .block_size = 4096, .depth = 2 });
+    defer ahead.deinit();
+    try ahead.start();
+
+    var total: usize = 0;
+    var buf: [1000]u8 = undefined;
+    var failed: ?anyerror = null;
+    while (failed == null) {
+        const n = ahead.read(&buf) catch |err| {
+            failed = err;
+            continue;
+        };
+        if (n == 0) return error.TestUnexpectedResult;
+        total += n;
+    }
+    try std.testing.expectEqual(@as(?anyerror, error.CorruptedStream), failed);
+    try std.testing.expectEqual(@as(usize, 10_000), total);
+}
+
+test "ReadAhead: deinit while producer is blocked" {
+    const allocator = std.testing.allocator;
+
+    var data = [_]u8{1} ** 50_000;
+    var fbs = std.io.fixedBufferStream(&data);
+    const source = fbs.reader();
+
+    var ahead: ReadAhead = undefined;
+    try ahead.init(allocator, source.any(), .{ .block_size = 1024, .depth = 2 });
+    try ahead.start();
+
+    var buf: [10]u8 = undefined;
+    _ = try ahead.read(&buf);
+    ahead.deinit();
+}
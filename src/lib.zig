@@ -0,0 +1,998 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2025 itsakeyfut
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+//! libzarc: the C API declared in include/zarc.h
+//!
+//! Root of the static and shared library builds. The exported functions
+//! are thin wrappers over the same readers, extraction code and codecs
+//! the CLI uses: file descriptors go through `app/open.zig` (so ZIP and
+//! indexed archives get positional decoding), while memory buffers and
+//! read callbacks are streamed through a decompressor into a TarReader.
+//!
+//! Every handle is allocated with, and keeps using, the caller's
+//! zarc_allocator. That allocator need not be thread-safe, so nothing
+//! here decodes on worker threads. Errors are mapped to zarc_status codes by `statusOf`;
+//! the Zig error name stays available through zarc_archive_error().
+
+const std = @import("std");
+const builtin = @import("builtin");
+const types = @import("core/types.zig");
+const errors = @import("core/errors.zig");
+const archive = @import("formats/archive.zig");
+const detect = @import("formats/detect.zig");
+const tar = @import("formats/tar/reader.zig");
+const open = @import("app/open.zig");
+const extract = @import("app/extract.zig");
+const security = @import("app/security.zig");
+const zlib = @import("compress/zlib.zig");
+const gzip = @import("compress/gzip.zig");
+const deflate = @import("compress/deflate/encode.zig");
+const zstd = @import("compress/zstd.zig");
+const lz4 = @import("compress/lz4.zig");
+const bzip2 = @import("compress/bzip2.zig");
+const xz = @import("compress/xz.zig");
+
+pub const version = "0.1.0";
+
+/// zarc_status
+pub const Status = enum(c_int) {
+    ok = 0,
+    end = 1,
+    invalid_argument = -1,
+    no_memory = -2,
+    io = -3,
+    format = -4,
+    unsupported = -5,
+    corrupt = -6,
+    checksum = -7,
+    security = -8,
+    buffer_too_small = -9,
+    exists = -10,
+    callback = -11,
+
+    fn code(self: Status) c_int {
+        return @intFromEnum(self);
+    }
+};
+
+/// zarc_format
+const Format = enum(c_int) {
+    auto = 0,
+    tar = 1,
+    tar_gz = 2,
+    tar_bz2 = 3,
+    tar_xz = 4,
+    tar_zst = 5,
+    tar_lz4 = 6,
+    zip = 7,
+};
+
+/// zarc_codec
+const Codec = enum(c_int) {
+    gzip = 1,
+    zlib = 2,
+    zstd = 3,
+    lz4 = 4,
+    bzip2 = 5,
+    xz = 6,
+};
+
+/// zarc_allocator
+pub const CAllocator = extern struct {
+    ctx: ?*anyopaque,
+    alloc: ?*const fn (ctx: ?*anyopaque, size: usize, alignment: usize) callconv(.c) ?*anyopaque,
+    free: ?*const fn (ctx: ?*anyopaque, ptr: ?*anyopaque, size: usize, alignment: usize) callconv(.c) void,
+};
+
+/// zarc_read_fn
+pub const ReadFn = *const fn (ctx: ?*anyopaque, buf: ?*anyopaque, len: usize) callconv(.c) isize;
+
+/// zarc_entry
+pub const Entry = extern struct {
+    path: [*:0]const u8,
+    link_target: [*:0]const u8,
+    size: u64,
+    mtime: i64,
+    mode: u32,
+    uid: u32,
+    gid: u32,
+    type: i32,
+};
+
+/// zarc_extract_options
+pub const ExtractOptions = extern struct {
+    flags: u32,
+    symlinks: i32,
+    max_file_size: u64,
+    max_total_size: u64,
+
+    const overwrite: u32 = 1 << 0;
+    const preserve_permissions: u32 = 1 << 1;
+    const preserve_timestamps: u32 = 1 << 2;
+    const continue_on_error: u32 = 1 << 3;
+
+    const defaults = ExtractOptions{
+        .flags = preserve_timestamps,
+        .symlinks = 0,
+        .max_file_size = (security.SecurityPolicy{}).max_file_size,
+        .max_total_size = (security.SecurityPolicy{}).max_total_size,
+    };
+};
+
+/// zarc_extract_result
+pub const ExtractResult = extern struct {
+    extracted: u64,
+    failed: u64,
+    bytes: u64,
+};
+
+/// Map an error to its zarc_status
+fn statusOf(err: anyerror) Status {
+    return switch (err) {
+        error.OutOfMemory => .no_memory,
+        error.InvalidArgument => .invalid_argument,
+        error.InvalidFormat => .format,
+        error.UnsupportedFormat,
+        error.UnsupportedVersion,
+        error.UnsupportedMethod,
+        error.UnsupportedPlatform,
+        => .unsupported,
+        error.CorruptedHeader,
+        error.CorruptedStream,
+        error.CorruptedArchive,
+        error.IncompleteArchive,
+        error.DecompressionFailed,
+        error.InvalidData,
+        => .corrupt,
+        error.ChecksumMismatch => .checksum,
+        error.PathAlreadyExists, error.CaseCollision => .exists,
+        error.BufferTooSmall => .buffer_too_small,
+        error.CallbackFailed => .callback,
+        else => if (inErrorSet(errors.AppError, err)) .security else .io,
+    };
+}
+
+fn inErrorSet(comptime Set: type, err: anyerror) bool {
+    inline for (@typeInfo(Set).error_set.?) |e| {
+        if (std.mem.eql(u8, e.name, @errorName(err))) return true;
+    }
+    return false;
+}
+
+/// std.mem.Allocator over a zarc_allocator (malloc/free when none is given)
+const Adapter = struct {
+    callbacks: ?CAllocator,
+
+    fn init(c_allocator: ?*const CAllocator) !Adapter {
+        const callbacks = c_allocator orelse return .{ .callbacks = null };
+        if (callbacks.alloc == null or callbacks.free == null) return error.InvalidArgument;
+        return .{ .callbacks = callbacks.* };
+    }
+
+    fn allocator(self: *Adapter) std.mem.Allocator {
+        if (self.callbacks == null) return std.heap.c_allocator;
+        return .{
+            .ptr = self,
+            .vtable = &.{
+                .alloc = alloc,
+                .resize = std.mem.Allocator.noResize,
+                .remap = std.mem.Allocator.noRemap,
+                .free = free,
+            },
+        };
+    }
+
+    fn alloc(ctx: *anyopaque, len: usize, alignment: std.mem.Alignment, ret_addr: usize) ?[*]u8 {
+        _ = ret_addr;
+        const self: *Adapter = @ptrCast(@alignCast(ctx));
+        const callbacks = self.callbacks.?;
+        const ptr = callbacks.alloc.?(callbacks.ctx, len, alignment.toByteUnits()) orelse return null;
+        return @ptrCast(ptr);
+    }
+
+    fn free(ctx: *anyopaque, memory: []u8, alignment: std.mem.Alignment, ret_addr: usize) void {
+        _ = ret_addr;
+        const self: *Adapter = @ptrCast(@alignCast(ctx));
+        const callbacks = self.callbacks.?;
+        callbacks.free.?(callbacks.ctx, memory.ptr, memory.len, alignment.toByteUnits());
+    }
+};
+
+/// Raw archive bytes: a memory buffer, a read callback or a pipe, with
+/// the first bytes read ahead for format detection and replayed
+const Source = struct {
+    input: Input,
+    head: [detect_size]u8 = undefined,
+    head_start: usize = 0,
+    head_len: usize = 0,
+
+    /// Enough for the ustar magic of a plain tar header
+    const detect_size = 512;
+
+    const Input = union(enum) {
+        memory: []const u8,
+        callback: struct { read: ReadFn, ctx: ?*anyopaque },
+        file: std.fs.File,
+    };
+
+    fn fillHead(self: *Source) !void {
+        while (self.head_len < self.head.len) {
+            const n = try self.readInput(self.head[self.head_len..]);
+            if (n == 0) break;
+            self.head_len += n;
+        }
+    }
+
+    fn read(self: *Source, dest: []u8) !usize {
+        if (self.head_start < self.head_len) {
+            const n = @min(dest.len, self.head_len - self.head_start);
+            @memcpy(dest[0..n], self.head[self.head_start..][0..n]);
+            self.head_start += n;
+            return n;
+        }
+        return self.readInput(dest);
+    }
+
+    fn readInput(self: *Source, dest: []u8) !usize {
+        switch (self.input) {
+            .memory => |*data| {
+                const n = @min(dest.len, data.len);
+                @memcpy(dest[0..n], data.*[0..n]);
+                data.* = data.*[n..];
+                return n;
+            },
+            .callback => |callback| {
+                const n = callback.read(callback.ctx, dest.ptr, dest.len);
+                if (n < 0) return error.CallbackFailed;
+                if (n > dest.len) return error.InvalidArgument;
+                return @intCast(n);
+            },
+            .file => |file| return file.read(dest),
+        }
+    }
+
+    fn reader(self: *Source) std.io.AnyReader {
+        return .{ .context = self, .readFn = readSource };
+    }
+
+    fn readSource(context: *const anyopaque, dest: []u8) anyerror!usize {
+        const self: *Source = @constCast(@ptrCast(@alignCast(context)));
+        return self.read(dest);
+    }
+};
+
+/// Streaming decompressor for one codec (or none, for plain tar)
+const Decoder = union(enum) {
+    none: std.io.AnyReader,
+    inflate: zlib.InflateReader,
+    zstd: zstd.ZstdReader,
+    lz4: lz4.Lz4Reader,
+    bzip2: bzip2.Bz2Reader,
+    xz: xz.XzReader,
+
+    fn init(allocator: std.mem.Allocator, codec: ?Codec, source: std.io.AnyReader) !Decoder {
+        var self: Decoder = switch (codec orelse return .{ .none = source }) {
+            .gzip => .{ .inflate = try zlib.InflateReader.init(allocator, source, .gzip) },
+            .zlib => .{ .inflate = try zlib.InflateReader.init(allocator, source, .zlib) },
+            .zstd => .{ .zstd = try zstd.ZstdReader.init(allocator, source, .{}) },
+            .lz4 => .{ .lz4 = try lz4.Lz4Reader.init(allocator, source) },
+            .bzip2 => .{ .bzip2 = try bzip2.Bz2Reader.init(allocator, source) },
+            .xz => .{ .xz = try xz.XzReader.init(allocator, source) },
+        };
+        errdefer self.deinit();
+
+        switch (self) {
+            .none => {},
+            inline else => |*stream| try stream.checkHeader(),
+        }
+        return self;
+    }
+
+    fn deinit(self: *Decoder) void {
+        switch (self.*) {
+            .none => {},
+            inline else => |*stream| stream.deinit(),
+        }
+    }
+
+    fn read(self: *Decoder, dest: []u8) !usize {
+        return switch (self.*) {
+            .none => |source| source.read(dest),
+            inline else => |*stream| stream.read(dest),
+        };
+    }
+
+    fn reader(self: *Decoder) std.io.AnyReader {
+        return .{ .context = self, .readFn = readDecoded };
+    }
+
+    fn readDecoded(context: *const anyopaque, dest: []u8) anyerror!usize {
+        const self: *Decoder = @constCast(@ptrCast(@alignCast(context)));
+        return self.read(dest);
+    }
+};
+
+/// zarc_archive
+const Archive = struct {
+    adapter: Adapter,
+    reader: ?Reader = null,
+    archive_reader: archive.ArchiveReader = undefined,
+
+    /// NUL-terminated copies of the current entry's strings
+    path: std.ArrayListUnmanaged(u8) = .{},
+    link_target: std.ArrayListUnmanaged(u8) = .{},
+
+    last_error: ?anyerror = null,
+
+    const Reader = union(enum) {
+        file: open.OpenedArchive,
+        stream: struct {
+            source: Source,
+            decoder: Decoder,
+            tar_reader: tar.TarReader,
+        },
+    };
+
+    const Input = union(enum) {
+        fd: c_int,
+        memory: []const u8,
+        callback: struct { read: ReadFn, ctx: ?*anyopaque },
+    };
+
+    fn create(c_allocator: ?*const CAllocator) !*Archive {
+        var adapter = try Adapter.init(c_allocator);
+        const self = try adapter.allocator().create(Archive);
+        self.* = .{ .adapter = adapter };
+        return self;
+    }
+
+    fn destroy(self: *Archive) void {
+        if (self.reader) |*reader| switch (reader.*) {
+            .file => |*opened| opened.deinit(),
+            .stream => |*stream| {
+                stream.tar_reader.deinit();
+                stream.decoder.deinit();
+            },
+        };
+        const allocator = self.adapter.allocator();
+        self.path.deinit(allocator);
+        self.link_target.deinit(allocator);
+
+        var adapter = self.adapter;
+        adapter.allocator().destroy(self);
+    }
+
+    fn openInput(self: *Archive, input: Input, format: c_int) !void {
+        switch (input) {
+            .fd => |fd| {
+                const file = try fileFromFd(fd);
+                var head: [Source.detect_size]u8 = undefined;
+                if (file.preadAll(&head, 0)) |n| {
+                    const format_type = try formatType(format, head[0..n]);
+                    // One thread: the caller's allocator is not known to be thread-safe
+                    self.reader = .{ .file = try open.openArchive(self.adapter.allocator(), file, format_type, .{ .threads = 1 }) };
+                    self.archive_reader = self.reader.?.file.archiveReader();
+                } else |err| {
+                    // Pipes are read as a stream
+                    if (err != error.Unseekable) return err;
+                    try self.openStream(.{ .file = file }, format);
+                }
+            },
+            .memory => |data| try self.openStream(.{ .memory = data }, format),
+            .callback => |callback| try self.openStream(.{ .callback = .{ .read = callback.read, .ctx = callback.ctx } }, format),
+        }
+    }
+
+    fn openStream(self: *Archive, input: Source.Input, format: c_int) !void {
+        const allocator = self.adapter.allocator();
+        self.reader = .{ .stream = .{ .source = .{ .input = input }, .decoder = undefined, .tar_reader = undefined } };
+        errdefer self.reader = null;
+        const stream = &self.reader.?.stream;
+
+        try stream.source.fillHead();
+        const codec: ?Codec = switch (try formatType(format, stream.source.head[0..stream.source.head_len])) {
+            .tar => null,
+            .tar_gz => .gzip,
+            .tar_bz2 => .bzip2,
+            .tar_xz => .xz,
+            .tar_zst => .zstd,
+            .tar_lz4 => .lz4,
+            // ZIP needs random access
+            else => return error.UnsupportedFormat,
+        };
+
+        stream.decoder = try Decoder.init(allocator, codec, stream.source.reader());
+        errdefer stream.decoder.deinit();
+        stream.tar_reader = try tar.TarReader.initStream(allocator, stream.decoder.reader(), null);
+        self.archive_reader = stream.tar_reader.archiveReader();
+    }
+
+    /// Record `err` for zarc_archive_error() and return its status
+    fn fail(self: *Archive, err: anyerror) c_int {
+        self.last_error = err;
+        return statusOf(err).code();
+    }
+
+    fn fillEntry(self: *Archive, entry: types.Entry, out: *Entry) !void {
+        const allocator = self.adapter.allocator();
+        out.* = .{
+            .path = try terminated(&self.path, allocator, entry.path),
+            .link_target = try terminated(&self.link_target, allocator, entry.link_target),
+            .size = entry.size,
+            .mtime = entry.mtime,
+            .mode = entry.mode,
+            .uid = entry.uid,
+            .gid = entry.gid,
+            .type = switch (entry.entry_type) {
+                .file => 0,
+                .directory => 1,
+                .symlink => 2,
+                .hardlink => 3,
+                .char_device => 4,
+                .block_device => 5,
+                .fifo => 6,
+            },
+        };
+    }
+};
+
+/// zarc_decoder
+const DecoderHandle = struct {
+    adapter: Adapter,
+    source: Source,
+    decoder: Decoder,
+};
+
+/// Copy `text` into `buffer` with a terminating NUL
+fn terminated(buffer: *std.ArrayListUnmanaged(u8), allocator: std.mem.Allocator, text: []const u8) ![*:0]const u8 {
+    buffer.clearRetainingCapacity();
+    try buffer.ensureTotalCapacity(allocator, text.len + 1);
+    buffer.appendSliceAssumeCapacity(text);
+    buffer.appendAssumeCapacity(0);
+    return buffer.items[0..text.len :0].ptr;
+}
+
+fn fileFromFd(fd: c_int) !std.fs.File {
+    return if (builtin.os.tag == .windows) error.UnsupportedPlatform else .{ .handle = fd };
+}
+
+fn dirFromFd(fd: c_int) !std.fs.Dir {
+    return if (builtin.os.tag == .windows) error.UnsupportedPlatform else .{ .fd = fd };
+}
+
+/// Archive format from a zarc_format and the archive's first bytes
+fn formatType(format: c_int, head: []const u8) !types.FormatType {
+    const requested = std.meta.intToEnum(Format, format) catch return error.InvalidArgument;
+    return switch (requested) {
+        .auto => switch (detect.detectFormatFromBytes(head)) {
+            .gz => .tar_gz,
+            .bz2 => .tar_bz2,
+            .xz => .tar_xz,
+            .zst => .tar_zst,
+            .lz4 => .tar_lz4,
+            .zip => .zip,
+            .sevenzip => error.UnsupportedFormat,
+            // Old tar headers carry no magic
+            else => .tar,
+        },
+        .tar => .tar,
+        .tar_gz => .tar_gz,
+        .tar_bz2 => .tar_bz2,
+        .tar_xz => .tar_xz,
+        .tar_zst => .tar_zst,
+        .tar_lz4 => .tar_lz4,
+        .zip => .zip,
+    };
+}
+
+fn bytesOf(ptr: ?*const anyopaque, len: usize) ![]const u8 {
+    if (len == 0) return &.{};
+    const bytes: [*]const u8 = @ptrCast(ptr orelse return error.InvalidArgument);
+    return bytes[0..len];
+}
+
+fn bufferOf(ptr: ?*anyopaque, len: usize) ![]u8 {
+    if (len == 0) return &.{};
+    const bytes: [*]u8 = @ptrCast(ptr orelse return error.InvalidArgument);
+    return bytes[0..len];
+}
+
+// General
+
+export fn zarc_version() [*:0]const u8 {
+    return version;
+}
+
+export fn zarc_strerror(status: c_int) [*:0]const u8 {
+    const known = std.meta.intToEnum(Status, status) catch return "unknown status";
+    return switch (known) {
+        .ok => "success",
+        .end => "end of archive",
+        .invalid_argument => "invalid argument",
+        .no_memory => "out of memory",
+        .io => "I/O error",
+        .format => "not a recognized archive",
+        .unsupported => "unsupported format or feature",
+        .corrupt => "archive is corrupted or truncated",
+        .checksum => "checksum mismatch",
+        .security => "rejected by extraction policy",
+        .buffer_too_small => "buffer too small",
+        .exists => "file already exists",
+        .callback => "read callback failed",
+    };
+}
+
+// Archive reading
+
+fn openHandle(c_allocator: ?*const CAllocator, input: Archive.Input, format: c_int, out: ?*?*Archive) c_int {
+    const result = out orelse return Status.invalid_argument.code();
+    result.* = null;
+
+    const self = Archive.create(c_allocator) catch |err| return statusOf(err).code();
+    self.openInput(input, format) catch |err| {
+        self.destroy();
+        return statusOf(err).code();
+    };
+    result.* = self;
+    return Status.ok.code();
+}
+
+export fn zarc_archive_open_fd(c_allocator: ?*const CAllocator, fd: c_int, format: c_int, out: ?*?*Archive) c_int {
+    return openHandle(c_allocator, .{ .fd = fd }, format, out);
+}
+
+export fn zarc_archive_open_memory(
+    c_allocator: ?*const CAllocator,
+    data: ?*const anyopaque,
+    len: usize,
+    format: c_int,
+    out: ?*?*Archive,
+) c_int {
+    const bytes = bytesOf(data, len) catch |err| return statusOf(err).code();
+    return openHandle(c_allocator, .{ .memory = bytes }, format, out);
+}
+
+export fn zarc_archive_open_callback(
+    c_allocator: ?*const CAllocator,
+    read: ?ReadFn,
+    ctx: ?*anyopaque,
+    format: c_int,
+    out: ?*?*Archive,
+) c_int {
+    const read_fn = read orelse return Status.invalid_argument.code();
+    return openHandle(c_allocator, .{ .callback = .{ .read = read_fn, .ctx = ctx } }, format, out);
+}
+
+export fn zarc_archive_next(handle: ?*Archive, out: ?*Entry) c_int {
+    const self = handle orelse return Status.invalid_argument.code();
+    const entry_out = out orelse return Status.invalid_argument.code();
+
+    const entry = (self.archive_reader.next() catch |err| return self.fail(err)) orelse return Status.end.code();
+    self.fillEntry(entry, entry_out) catch |err| return self.fail(err);
+    return Status.ok.code();
+}
+
+export fn zarc_archive_read(handle: ?*Archive, buf: ?*anyopaque, len: usize) i64 {
+    const self = handle orelse return Status.invalid_argument.code();
+    const dest = bufferOf(buf, len) catch |err| return self.fail(err);
+    if (dest.len == 0) return 0;
+
+    const n = self.archive_reader.read(dest) catch |err| return self.fail(err);
+    return @intCast(n);
+}
+
+export fn zarc_archive_error(handle: ?*const Archive) [*:0]const u8 {
+    const self = handle orelse return "";
+    const err = self.last_error orelse return "";
+    return @errorName(err);
+}
+
+export fn zarc_archive_close(handle: ?*Archive) void {
+    if (handle) |self| self.destroy();
+}
+
+// Extraction
+
+export fn zarc_extract_options_init(options: ?*ExtractOptions) void {
+    if (options) |out| out.* = ExtractOptions.defaults;
+}
+
+export fn zarc_archive_extract(
+    handle: ?*Archive,
+    dirfd: c_int,
+    options: ?*const ExtractOptions,
+    result: ?*ExtractResult,
+) c_int {
+    const self = handle orelse return Status.invalid_argument.code();
+    const opts = if (options) |o| o.* else ExtractOptions.defaults;
+    const dir = dirFromFd(dirfd) catch |err| return self.fail(err);
+
+    const symlinks: security.SymlinkPolicy = switch (opts.symlinks) {
+        0 => .disallow,
+        1 => .only_relative,
+        2 => .allow_all,
+        else => return self.fail(error.InvalidArgument),
+    };
+    const preserve_permissions = opts.flags & ExtractOptions.preserve_permissions != 0;
+    const extract_options = extract.ExtractOptions{
+        .overwrite = opts.flags & ExtractOptions.overwrite != 0,
+        .preserve_permissions = preserve_permissions,
+        .preserve_timestamps = opts.flags & ExtractOptions.preserve_timestamps != 0,
+        .continue_on_error = opts.flags & ExtractOptions.continue_on_error != 0,
+        .security_policy = .{
+            .max_file_size = if (opts.max_file_size != 0) opts.max_file_size else ExtractOptions.defaults.max_file_size,
+            .max_total_size = if (opts.max_total_size != 0) opts.max_total_size else ExtractOptions.defaults.max_total_size,
+            .preserve_permissions = preserve_permissions,
+            .symlink_policy = symlinks,
+        },
+    };
+
+    const allocator = self.adapter.allocator();
+    var extracted = extract.extractArchiveToDir(allocator, &self.archive_reader, dir, extract_options) catch |err| return self.fail(err);
+    defer extracted.deinit(allocator);
+
+    if (result) |out| {
+        out.* = .{
+            .extracted = extracted.succeeded,
+            .failed = extracted.failed,
+            .bytes = extracted.total_bytes,
+        };
+    }
+    return Status.ok.code();
+}
+
+// Compression engines
+
+fn compressWith(allocator: std.mem.Allocator, codec: Codec, level: c_int, src: []const u8) ![]u8 {
+    if (level < 0 or level > 9) return error.InvalidArgument;
+    return switch (codec) {
+        .gzip => gzip.compress(allocator, src, .{
+            .level = if (level == 0) .default else @enumFromInt(@as(u4, @intCast(level))),
+        }),
+        .zlib => zlib.compress(allocator, .zlib, src),
+        .zstd => zstd.compress(allocator, src, .{
+            .level = if (level != 0 and level <= 2) .fast else .default,
+        }),
+        .lz4 => lz4.compress(allocator, src, .{}),
+        .bzip2, .xz => error.UnsupportedMethod,
+    };
+}
+
+/// Decompress `src` straight into `dest`
+///
+/// Once `dest` is full the rest is decoded into a stack buffer only to
+/// count the size required, so memory stays at the decoder's state
+/// however large the output is.
+fn decompressInto(allocator: std.mem.Allocator, codec: Codec, src: []const u8, dest: []u8, out_len: *usize) !void {
+    var source = Source{ .input = .{ .memory = src } };
+    var decoder = try Decoder.init(allocator, codec, source.reader());
+    defer decoder.deinit();
+
+    var len: usize = 0;
+    while (len < dest.len) {
+        const n = try decoder.read(dest[len..]);
+        if (n == 0) break;
+        len += n;
+    }
+
+    var scratch: [types.BufferSize.small]u8 = undefined;
+    var excess: usize = 0;
+    while (true) {
+        const n = try decoder.read(&scratch);
+        if (n == 0) break;
+        excess += n;
+    }
+
+    out_len.* = len + excess;
+    if (excess > 0) return error.BufferTooSmall;
+}
+
+/// Shared body of zarc_compress and zarc_decompress
+fn codecCall(
+    c_allocator: ?*const CAllocator,
+    codec: c_int,
+    level: ?c_int,
+    src: ?*const anyopaque,
+    src_len: usize,
+    dst: ?*anyopaque,
+    dst_capacity: usize,
+    dst_len: ?*usize,
+) !void {
+    const out_len = dst_len orelse return error.InvalidArgument;
+    const known = std.meta.intToEnum(Codec, codec) catch return error.InvalidArgument;
+    const input = try bytesOf(src, src_len);
+    const dest = try bufferOf(dst, dst_capacity);
+
+    var adapter = try Adapter.init(c_allocator);
+    const allocator = adapter.allocator();
+    const compress_level = level orelse return decompressInto(allocator, known, input, dest, out_len);
+
+    // Bounded by the codec's worst case for `input`
+    const output = try compressWith(allocator, known, compress_level, input);
+    defer allocator.free(output);
+
+    out_len.* = output.len;
+    if (output.len > dest.len) return error.BufferTooSmall;
+    @memcpy(dest[0..output.len], output);
+}
+
+export fn zarc_compress(
+    c_allocator: ?*const CAllocator,
+    codec: c_int,
+    level: c_int,
+    src: ?*const anyopaque,
+    src_len: usize,
+    dst: ?*anyopaque,
+    dst_capacity: usize,
+    dst_len: ?*usize,
+) c_int {
+    codecCall(c_allocator, codec, level, src, src_len, dst, dst_capacity, dst_len) catch |err| return statusOf(err).code();
+    return Status.ok.code();
+}
+
+export fn zarc_decompress(
+    c_allocator: ?*const CAllocator,
+    codec: c_int,
+    src: ?*const anyopaque,
+    src_len: usize,
+    dst: ?*anyopaque,
+    dst_capacity: usize,
+    dst_len: ?*usize,
+) c_int {
+    codecCall(c_allocator, codec, null, src, src_len, dst, dst_capacity, dst_len) catch |err| return statusOf(err).code();
+    return Status.ok.code();
+}
+
+fn openDecoder(c_allocator: ?*const CAllocator, codec: c_int, read: ?ReadFn, ctx: ?*anyopaque) !*DecoderHandle {
+    const known = std.meta.intToEnum(Codec, codec) catch return error.InvalidArgument;
+    const read_fn = read orelse return error.InvalidArgument;
+
+    var adapter = try Adapter.init(c_allocator);
+    const self = try adapter.allocator().create(DecoderHandle);
+    errdefer adapter.allocator().destroy(self);
+
+    self.* = .{
+        .adapter = adapter,
+        .source = .{ .input = .{ .callback = .{ .read = read_fn, .ctx = ctx } } },
+        .decoder = undefined,
+    };
+    self.decoder = try Decoder.init(self.adapter.allocator(), known, self.source.reader());
+    return self;
+}
+
+export fn zarc_decoder_open(
+    c_allocator: ?*const CAllocator,
+    codec: c_int,
+    read: ?ReadFn,
+    ctx: ?*anyopaque,
+    out: ?*?*DecoderHandle,
+) c_int {
+    const result = out orelse return Status.invalid_argument.code();
+    result.* = openDecoder(c_allocator, codec, read, ctx) catch |err| return statusOf(err).code();
+    return Status.ok.code();
+}
+
+export fn zarc_decoder_read(handle: ?*DecoderHandle, buf: ?*anyopaque, len: usize) i64 {
+    const self = handle orelse return Status.invalid_argument.code();
+    const dest = bufferOf(buf, len) catch |err| return statusOf(err).code();
+    if (dest.len == 0) return 0;
+
+    const n = self.decoder.read(dest) catch |err| return statusOf(err).code();
+    return @intCast(n);
+}
+
+export fn zarc_decoder_close(handle: ?*DecoderHandle) void {
+    const self = handle orelse return;
+    self.decoder.deinit();
+    var adapter = self.adapter;
+    adapter.allocator().destroy(self);
+}
+
+// Tests
+
+const header = @import("formats/tar/header.zig");
+
+/// zarc_allocator over std.testing.allocator, so leaks fail the test
+const TestAllocator = struct {
+    fn alloc(ctx: ?*anyopaque, size: usize, alignment: usize) callconv(.c) ?*anyopaque {
+        _ = ctx;
+        const memory = std.testing.allocator.rawAlloc(size, std.mem.Alignment.fromByteUnits(alignment), @returnAddress()) orelse return null;
+        return @ptrCast(memory);
+    }
+
+    fn free(ctx: ?*anyopaque, ptr: ?*anyopaque, size: usize, alignment: usize) callconv(.c) void {
+        _ = ctx;
+        const bytes: [*]u8 = @ptrCast(ptr.?);
+        std.testing.allocator.rawFree(bytes[0..size], std.mem.Alignment.fromByteUnits(alignment), @returnAddress());
+    }
+
+    const callbacks = CAllocator{ .ctx = null, .alloc = alloc, .free = free };
+};
+
+fn buildTestTar(allocator: std.mem.Allocator) ![]u8 {
+    var data = std.ArrayList(u8).init(allocator);
+    errdefer data.deinit();
+
+    const files = [_]struct { path: []const u8, body: []const u8 }{
+        .{ .path = "hello.txt", .body = "hello from libzarc\n" },
+        .{ .path = "dir/data.bin", .body = "0123456789" ** 100 },
+    };
+    for (files) |f| {
+        const entry = types.Entry{ .path = f.path, .entry_type = .file, .size = f.body.len, .mode = 0o644, .mtime = 1700000000 };
+        const hdr = try header.createHeader(&entry, allocator);
+        try data.appendSlice(std.mem.asBytes(&hdr));
+        try data.appendSlice(f.body);
+        try data.appendNTimes(0, (512 - f.body.len % 512) % 512);
+    }
+    try data.appendNTimes(0, 1024);
+    return data.toOwnedSlice();
+}
+
+fn expectTestEntries(handle: *Archive) !void {
+    var entry: Entry = undefined;
+    var buffer: [64]u8 = undefined;
+
+    try std.testing.expectEqual(Status.ok.code(), zarc_archive_next(handle, &entry));
+    try std.testing.expectEqualStrings("hello.txt", std.mem.span(entry.path));
+    try std.testing.expectEqual(@as(i32, 0), entry.type);
+    const n = zarc_archive_read(handle, &buffer, buffer.len);
+    try std.testing.expectEqualStrings("hello from libzarc\n", buffer[0..@intCast(n)]);
+
+    try std.testing.expectEqual(Status.ok.code(), zarc_archive_next(handle, &entry));
+    try std.testing.expectEqualStrings("dir/data.bin", std.mem.span(entry.path));
+    try std.testing.expectEqual(@as(u64, 1000), entry.size);
+
+    try std.testing.expectEqual(Status.end.code(), zarc_archive_next(handle, &entry));
+}
+
+test "zarc_archive_open_memory: tar.gz with a caller allocator" {
+    const tar_data = try buildTestTar(std.testing.allocator);
+    defer std.testing.allocator.free(tar_data);
+    const gz_data = try zlib.compress(std.testing.allocator, .gzip, tar_data);
+    defer std.testing.allocator.free(gz_data);
+
+    var handle: ?*Archive = null;
+    try std.testing.expectEqual(Status.ok.code(), zarc_archive_open_memory(&TestAllocator.callbacks, gz_data.ptr, gz_data.len, 0, &handle));
+    defer zarc_archive_close(handle);
+
+    try expectTestEntries(handle.?);
+}
+
+test "zarc_archive_open_callback: plain tar, and errors" {
+    const tar_data = try buildTestTar(std.testing.allocator);
+    defer std.testing.allocator.free(tar_data);
+
+    const Feed = struct {
+        data: []const u8,
+
+        // Short reads, to exercise the replayed detection head
+        fn read(ctx: ?*anyopaque, buf: ?*anyopaque, len: usize) callconv(.c) isize {
+            const self: *@This() = @ptrCast(@alignCast(ctx.?));
+            const n = @min(len, self.data.len, 100);
+            const dest: [*]u8 = @ptrCast(buf.?);
+            @memcpy(dest[0..n], self.data[0..n]);
+            self.data = self.data[n..];
+            return @intCast(n);
+        }
+
+        fn fail(ctx: ?*anyopaque, buf: ?*anyopaque, len: usize) callconv(.c) isize {
+            _ = ctx;
+            _ = buf;
+            _ = len;
+            return -1;
+        }
+    };
+
+    var feed = Feed{ .data = tar_data };
+    var handle: ?*Archive = null;
+    try std.testing.expectEqual(Status.ok.code(), zarc_archive_open_callback(&TestAllocator.callbacks, Feed.read, &feed, 0, &handle));
+    try expectTestEntries(handle.?);
+    zarc_archive_close(handle);
+
+    try std.testing.expectEqual(Status.callback.code(), zarc_archive_open_callback(null, Feed.fail, null, 0, &handle));
+    try std.testing.expect(handle == null);
+    try std.testing.expectEqual(Status.invalid_argument.code(), zarc_archive_open_memory(null, null, 10, 0, &handle));
+    try std.testing.expectEqual(Status.invalid_argument.code(), zarc_archive_open_memory(null, tar_data.ptr, tar_data.len, 42, &handle));
+}
+
+test "zarc_archive_open_fd: extract to a dirfd" {
+    if (builtin.os.tag == .windows) return error.SkipZigTest;
+
+    const tar_data = try buildTestTar(std.testing.allocator);
+    defer std.testing.allocator.free(tar_data);
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try tmp_dir.dir.writeFile(.{ .sub_path = "test.tar", .data = tar_data });
+    try tmp_dir.dir.makeDir("out");
+
+    const file = try tmp_dir.dir.openFile("test.tar", .{});
+    defer file.close();
+    var out_dir = try tmp_dir.dir.openDir("out", .{});
+    defer out_dir.close();
+
+    var handle: ?*Archive = null;
+    try std.testing.expectEqual(Status.ok.code(), zarc_archive_open_fd(&TestAllocator.callbacks, file.handle, 0, &handle));
+    defer zarc_archive_close(handle);
+
+    var result: ExtractResult = undefined;
+    try std.testing.expectEqual(Status.ok.code(), zarc_archive_extract(handle, out_dir.fd, null, &result));
+    try std.testing.expectEqual(@as(u64, 2), result.extracted);
+
+    var buffer: [64]u8 = undefined;
+    const hello = try out_dir.readFile("hello.txt", &buffer);
+    try std.testing.expectEqualStrings("hello from libzarc\n", hello);
+}
+
+test "zarc_compress/zarc_decompress: round trip and buffer sizing" {
+    const input = "compress me, compress me, compress me " ** 40;
+    var compressed: [4096]u8 = undefined;
+    var restored: [input.len]u8 = undefined;
+
+    for ([_]Codec{ .gzip, .zlib, .zstd, .lz4 }) |codec| {
+        var compressed_len: usize = 0;
+        try std.testing.expectEqual(Status.ok.code(), zarc_compress(&TestAllocator.callbacks, @intFromEnum(codec), 0, input.ptr, input.len, &compressed, compressed.len, &compressed_len));
+        try std.testing.expect(compressed_len < input.len);
+
+        var restored_len: usize = 0;
+        try std.testing.expectEqual(Status.ok.code(), zarc_decompress(&TestAllocator.callbacks, @intFromEnum(codec), &compressed, compressed_len, &restored, restored.len, &restored_len));
+        try std.testing.expectEqualStrings(input, restored[0..restored_len]);
+
+        // Too small: the required size is reported
+        try std.testing.expectEqual(Status.buffer_too_small.code(), zarc_decompress(null, @intFromEnum(codec), &compressed, compressed_len, &restored, 10, &restored_len));
+        try std.testing.expectEqual(input.len, restored_len);
+        try std.testing.expectEqual(Status.buffer_too_small.code(), zarc_decompress(null, @intFromEnum(codec), &compressed, compressed_len, &restored, input.len - 1, &restored_len));
+        try std.testing.expectEqual(input.len, restored_len);
+    }
+
+    var len: usize = 0;
+    try std.testing.expectEqual(Status.unsupported.code(), zarc_compress(null, @intFromEnum(Codec.xz), 0, input.ptr, input.len, &compressed, compressed.len, &len));
+    try std.testing.expectEqual(Status.invalid_argument.code(), zarc_compress(null, 99, 0, input.ptr, input.len, &compressed, compressed.len, &len));
+}
+
+test "zarc_decoder: streaming zstd" {
+    const input = "streamed through a callback " ** 100;
+    const compressed = try zstd.compress(std.testing.allocator, input, .{});
+    defer std.testing.allocator.free(compressed);
+
+    const Feed = struct {
+        data: []const u8,
+
+        fn read(ctx: ?*anyopaque, buf: ?*anyopaque, len: usize) callconv(.c) isize {
+            const self: *@This() = @ptrCast(@alignCast(ctx.?));
+            const n = @min(len, self.data.len);
+            const dest: [*]u8 = @ptrCast(buf.?);
+            @memcpy(dest[0..n], self.data[0..n]);
+            self.data = self.data[n..];
+            return @intCast(n);
+        }
+    };
+
+    var feed = Feed{ .data = compressed };
+    var handle: ?*DecoderHandle = null;
+    try std.testing.expectEqual(Status.ok.code(), zarc_decoder_open(&TestAllocator.callbacks, @intFromEnum(Codec.zstd), Feed.read, &feed, &handle));
+    defer zarc_decoder_close(handle);
+
+    var output = std.ArrayList(u8).init(std.testing.allocator);
+    defer output.deinit();
+    var buffer: [333]u8 = undefined;
+    while (true) {
+        const n = zarc_decoder_read(handle, &buffer, buffer.len);
+        try std.testing.expect(n >= 0);
+        if (n == 0) break;
+        try output.appendSlice(buffer[0..@intCast(n)]);
+    }
+    try std.testing.expectEqualStrings(input, output.items);
+}
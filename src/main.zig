@@ -20,6 +20,9 @@ pub const core = struct {
     pub const errors = @import("core/errors.zig");
     pub const types = @import("core/types.zig");
     pub const util = @import("core/util.zig");
+    pub const instrument = @import("core/instrument.zig");
+    pub const trace = @import("core/trace.zig");
+    pub const alloc_profile = @import("core/alloc_profile.zig");
 };
 
 // Format modules
@@ -28,6 +31,14 @@ pub const formats = struct {
     pub const tar = struct {
         pub const header = @import("formats/tar/header.zig");
         pub const reader = @import("formats/tar/reader.zig");
+        pub const indexed = @import("formats/tar/indexed.zig");
+        pub const memory = @import("formats/tar/memory.zig");
+        pub const push = @import("formats/tar/push.zig");
+        pub const pax = @import("formats/tar/pax.zig");
+    };
+    pub const zip = struct {
+        pub const directory = @import("formats/zip/directory.zig");
+        pub const reader = @import("formats/zip/reader.zig");
     };
 };
 
@@ -37,12 +48,19 @@ pub const io = struct {
     pub const writer = @import("io/writer.zig");
     pub const filesystem = @import("io/filesystem.zig");
     pub const streaming = @import("io/streaming.zig");
+    pub const readahead = @import("io/readahead.zig");
 };
 
 // Compression modules
 pub const compress = struct {
     pub const zlib = @import("compress/zlib.zig");
+    pub const crc32 = @import("compress/crc32.zig");
     pub const gzip = @import("compress/gzip.zig");
+    pub const bgzf = @import("compress/bgzf.zig");
+    pub const zstd = @import("compress/zstd.zig");
+    pub const lz4 = @import("compress/lz4.zig");
+    pub const bzip2 = @import("compress/bzip2.zig");
+    pub const xz = @import("compress/xz.zig");
     pub const deflate = struct {
         pub const decode = @import("compress/deflate/decode.zig");
         pub const encode = @import("compress/deflate/encode.zig");
@@ -53,6 +71,10 @@ pub const compress = struct {
 pub const app = struct {
     pub const security = @import("app/security.zig");
     pub const extract = @import("app/extract.zig");
+    pub const list = @import("app/list.zig");
+    pub const verify = @import("app/verify.zig");
+    pub const open = @import("app/open.zig");
+    pub const filter = @import("app/filter.zig");
 };
 
 // CLI modules
@@ -81,7 +103,19 @@ pub fn main() !void {
             std.log.err("Memory leak detected", .{});
         }
     }
-    const allocator = gpa.allocator();
+    // ZARC_ALLOC_PROFILE=<n>: report the top allocation sites on exit.
+    // Both wrappers feed the allocation counter when instrumentation is
+    // compiled in, so at most one of them is used.
+    var profiler = core.alloc_profile.ProfilingAllocator.init(gpa.allocator());
+    defer profiler.deinit();
+    var counting = core.instrument.CountingAllocator.init(gpa.allocator());
+    const profile_top = core.alloc_profile.topFromEnv(gpa.allocator());
+    const allocator = if (profile_top != null)
+        profiler.allocator()
+    else if (core.instrument.enabled)
+        counting.allocator()
+    else
+        gpa.allocator();
 
     // Get command-line arguments (skip program name)
     const args = try std.process.argsAlloc(allocator);
@@ -110,6 +144,11 @@ pub fn main() !void {
         err_out.printError("Unexpected error: {s}", .{@errorName(err)}) catch {};
         break :blk 1;
     };
+
+    // Reported here because the deferred exit skips every other defer
+    if (profile_top) |top| {
+        profiler.writeReport(std.io.getStdErr().writer(), top) catch {};
+    }
 }
 
 fn executeCommand(allocator: std.mem.Allocator, parsed: cli.args.ParsedArgs) !u8 {
@@ -120,6 +159,12 @@ fn executeCommand(allocator: std.mem.Allocator, parsed: cli.args.ParsedArgs) !u8
         .extract => |extract_args| {
             return cli.commands.runExtract(allocator, extract_args);
         },
+        .list => |list_args| {
+            return cli.commands.runList(allocator, list_args);
+        },
+        .test_archive => |test_args| {
+            return cli.commands.runTest(allocator, test_args);
+        },
         .help => |subcommand| {
             try cli.commands.printHelp(stdout_file, subcommand);
             return 0;
@@ -148,18 +193,47 @@ test {
     _ = core.errors;
     _ = core.types;
     _ = core.util;
+    _ = core.instrument;
+    _ = core.trace;
+    _ = core.alloc_profile;
     _ = formats.archive;
     _ = formats.tar.header;
     _ = formats.tar.reader;
+    _ = formats.tar.indexed;
+    _ = formats.tar.memory;
+    _ = formats.tar.push;
+    _ = formats.tar.pax;
+    _ = formats.zip.directory;
+    _ = formats.zip.reader;
     _ = io.reader;
     _ = io.writer;
     _ = io.filesystem;
+    _ = io.readahead;
     _ = compress.zlib;
+    _ = compress.crc32;
     _ = compress.gzip;
+    _ = compress.bgzf;
+    _ = compress.zstd;
+    _ = compress.zstd.bitstream;
+    _ = compress.zstd.fse;
+    _ = compress.zstd.huffman;
+    _ = compress.zstd.decode;
+    _ = compress.zstd.encode;
+    _ = compress.lz4;
+    _ = compress.lz4.block;
+    _ = compress.bzip2;
+    _ = compress.bzip2.block;
+    _ = compress.xz;
+    _ = compress.xz.lzma;
     _ = compress.deflate.decode;
     _ = compress.deflate.encode;
     _ = app.security;
     _ = app.extract;
+    _ = app.list;
+    _ = app.verify;
+    _ = app.open;
+    _ = app.filter;
+    _ = @import("lib.zig");
     _ = platform.common;
     _ = platform.linux;
     _ = platform.windows;
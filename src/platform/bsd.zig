@@ -31,6 +31,7 @@ pub const platform = common.Platform{
     .setFilePermissions = setFilePermissions,
     .getFilePermissions = getFilePermissions,
     .setFileTime = setFileTime,
+    .applyMetadata = applyMetadata,
     .createSymlink = createSymlink,
     .readSymlink = readSymlink,
     .isSymlink = isSymlink,
@@ -61,6 +62,41 @@ fn setFileTime(path: []const u8, mtime: i64) !void {
     try file.updateTimes(atime_nsec, mtime_nsec);
 }
 
+/// Apply metadata records through their descriptors
+///
+/// Extended attributes are not restored on this platform.
+fn applyMetadata(records: []const common.MetadataRecord, errors: []?anyerror) usize {
+    std.debug.assert(errors.len == records.len);
+
+    var failed: usize = 0;
+    for (records, errors) |record, *err| {
+        err.* = null;
+        applyRecord(record) catch |e| {
+            err.* = e;
+            failed += 1;
+        };
+    }
+    return failed;
+}
+
+fn applyRecord(record: common.MetadataRecord) !void {
+    const file = std.fs.File{ .handle = record.fd };
+
+    // Ownership first: chown clears set-id bits that the mode may set
+    if (record.uid != null or record.gid != null) {
+        try file.chown(record.uid, record.gid);
+    }
+    if (record.mode) |mode| {
+        try file.chmod(@as(u16, @intCast(mode & 0o7777)));
+    }
+    if (record.atime != null or record.mtime != null) {
+        const stat = try file.stat();
+        const atime_nsec: i128 = if (record.atime) |t| @as(i128, t) * std.time.ns_per_s + record.atime_nsec else stat.atime;
+        const mtime_nsec: i128 = if (record.mtime) |t| @as(i128, t) * std.time.ns_per_s + record.mtime_nsec else stat.mtime;
+        try file.updateTimes(atime_nsec, mtime_nsec);
+    }
+}
+
 /// Create symbolic link using POSIX symlink
 fn createSymlink(target: []const u8, link_path: []const u8) !void {
     try std.fs.cwd().symLink(target, link_path, .{});
@@ -15,6 +15,7 @@
 
 const std = @import("std");
 const builtin = @import("builtin");
+const types = @import("../core/types.zig");
 
 /// Platform-specific operations interface
 ///
@@ -51,6 +52,24 @@ pub const Platform = struct {
     ///   - mtime: Modification time (Unix timestamp in seconds)
     setFileTime: *const fn (path: []const u8, mtime: i64) anyerror!void,
 
+    /// Apply a batch of metadata updates through open descriptors
+    ///
+    /// Every attribute is set on the record's `fd`, so no path is looked
+    /// up and a symlink swapped in after the target was opened cannot
+    /// redirect the update. Records are independent: a failure is
+    /// reported in `errors` and the remaining records are still applied.
+    ///
+    /// Parameters:
+    ///   - records: Updates to apply, in order
+    ///   - errors: Same length as `records`; receives each record's error,
+    ///     or null on success
+    ///
+    /// Returns:
+    ///   - Number of records that failed
+    ///
+    /// Note: On Windows, ownership is ignored and mode is approximated
+    applyMetadata: *const fn (records: []const MetadataRecord, errors: []?anyerror) usize,
+
     /// Create a symbolic link
     ///
     /// Parameters:
@@ -95,6 +114,58 @@ pub const Platform = struct {
     getPlatformName: *const fn () []const u8,
 };
 
+/// One entry of a batched metadata update (see `Platform.applyMetadata`)
+///
+/// Null fields are left unchanged.
+pub const MetadataRecord = struct {
+    /// Open file or directory to update (see `openForMetadata`); not closed
+    fd: std.posix.fd_t,
+
+    /// POSIX permissions (e.g., 0o644)
+    mode: ?u32 = null,
+
+    /// Access time (Unix timestamp in seconds)
+    atime: ?i64 = null,
+
+    /// Sub-second part of `atime` in nanoseconds
+    atime_nsec: u32 = 0,
+
+    /// Modification time (Unix timestamp in seconds)
+    mtime: ?i64 = null,
+
+    /// Sub-second part of `mtime` in nanoseconds
+    mtime_nsec: u32 = 0,
+
+    /// Owner user ID
+    uid: ?u32 = null,
+
+    /// Owner group ID
+    gid: ?u32 = null,
+
+    /// Extended attributes, set after ownership and mode (Linux only;
+    /// other platforms ignore them)
+    xattrs: []const types.Xattr = &.{},
+};
+
+/// Open an existing file or directory to update its metadata
+///
+/// A symlink at the final component is not followed, so the descriptor
+/// always refers to the entry itself.
+///
+/// Parameters:
+///   - dir: Directory `sub_path` is relative to
+///   - sub_path: Path of the file or directory
+///
+/// Returns:
+///   - Descriptor for `MetadataRecord.fd` (caller closes it)
+pub fn openForMetadata(dir: std.fs.Dir, sub_path: []const u8) !std.posix.fd_t {
+    if (builtin.os.tag == .windows) {
+        return @import("windows.zig").openForMetadata(dir, sub_path);
+    }
+    // O_RDONLY still allows fchmod/fchown/futimens, and opens directories
+    return std.posix.openat(dir.fd, sub_path, .{ .NOFOLLOW = true, .CLOEXEC = true }, 0);
+}
+
 /// Get the platform-specific implementation for the current OS
 ///
 /// This function returns the appropriate Platform implementation
@@ -160,22 +231,58 @@ pub const Capabilities = struct {
     supports_hardlinks: bool,
     /// Supports extended attributes
     supports_xattr: bool,
-    /// Case-sensitive filesystem
+    /// Filesystems on this platform are usually case-sensitive; the
+    /// destination itself is probed by `probeDirectory`
     case_sensitive: bool,
+    /// Kernel can confine path resolution beneath a directory fd
+    /// (openat2 RESOLVE_BENEATH, Linux 5.6+; probed at runtime)
+    supports_resolve_beneath: bool = false,
+};
+
+/// Filesystem features of one directory (typically an extraction root)
+///
+/// These depend on the filesystem, not just the kernel, so they are
+/// probed per directory by `probeDirectory` and cached by the caller.
+pub const DirCapabilities = struct {
+    /// copy_file_range(2) works from the probed source file into this
+    /// directory (cross-filesystem copies are refused since Linux 5.19);
+    /// selects the in-kernel copy for large entries
+    copy_file_range: bool = false,
+    /// fallocate(2) can preallocate file space; large entries are
+    /// preallocated before their data is written
+    fallocate: bool = false,
+    /// Names differing only in case are distinct files here; otherwise
+    /// extraction rejects entries whose names collide this way
+    case_sensitive: bool = true,
 };
 
+/// Kernel features, probed once on first use
+var kernel_features: Capabilities = .{
+    .supports_permissions = true,
+    .supports_symlinks = true,
+    .supports_hardlinks = true,
+    .supports_xattr = true,
+    .case_sensitive = true,
+};
+var kernel_probe = std.once(probeKernel);
+
+fn probeKernel() void {
+    const linux = @import("linux.zig");
+    kernel_features.supports_resolve_beneath = linux.probeResolveBeneath();
+}
+
 /// Get platform capabilities
 ///
+/// Kernel features that vary between releases of the same OS are probed
+/// once on first call and cached.
+///
 /// Returns:
 ///   - Capabilities structure for the current platform
 pub fn getCapabilities() Capabilities {
     return switch (builtin.os.tag) {
-        .linux => .{
-            .supports_permissions = true,
-            .supports_symlinks = true,
-            .supports_hardlinks = true,
-            .supports_xattr = true,
-            .case_sensitive = true,
+        .linux => blk: {
+            kernel_probe.call();
+            break :blk kernel_features;
         },
         .windows => .{
             .supports_permissions = false,
@@ -208,6 +315,41 @@ pub fn getCapabilities() Capabilities {
     };
 }
 
+/// Probe the filesystem features of a directory
+///
+/// Creates short-lived scratch files in `dir`, so `dir` must be writable;
+/// features that cannot be probed are reported as unsupported, and case
+/// sensitivity falls back to the platform default. Callers probe once per
+/// destination rather than per entry.
+///
+/// Parameters:
+///   - dir: Directory to probe
+///   - source: File that will be copied into `dir` (e.g. the archive);
+///     copy_file_range is only reported for this pairing
+///
+/// Returns:
+///   - Directory capabilities
+pub fn probeDirectory(dir: std.fs.Dir, source: ?std.fs.File) DirCapabilities {
+    var caps = DirCapabilities{ .case_sensitive = probeCaseSensitive(dir) };
+    if (builtin.os.tag == .linux) {
+        @import("linux.zig").probeDirectory(dir.fd, if (source) |f| f.handle else null, &caps);
+    }
+    return caps;
+}
+
+/// Create a lowercase scratch name and look it up in uppercase
+fn probeCaseSensitive(dir: std.fs.Dir) bool {
+    const lower = ".zarc-case-probe";
+    const upper = ".ZARC-CASE-PROBE";
+
+    const file = dir.createFile(lower, .{ .exclusive = true }) catch return getCapabilities().case_sensitive;
+    file.close();
+    defer dir.deleteFile(lower) catch {};
+
+    _ = dir.statFile(upper) catch return true;
+    return false;
+}
+
 // Tests
 test "getPlatformName: returns valid name" {
     const name = getPlatformName();
@@ -240,4 +382,23 @@ test "getCapabilities: returns valid capabilities" {
     if (isWindows()) {
         try std.testing.expect(!caps.supports_permissions);
     }
+
+    // Kernel probes only run on Linux, and their results are stable
+    if (builtin.os.tag != .linux) {
+        try std.testing.expect(!caps.supports_resolve_beneath);
+    }
+    try std.testing.expectEqual(caps.supports_resolve_beneath, getCapabilities().supports_resolve_beneath);
+}
+
+test "probeDirectory: leaves no scratch files behind" {
+    var tmp_dir = std.testing.tmpDir(.{ .iterate = true });
+    defer tmp_dir.cleanup();
+
+    const caps = probeDirectory(tmp_dir.dir, null);
+
+    // Without a source file there is nothing to copy from
+    try std.testing.expect(!caps.copy_file_range);
+
+    var it = tmp_dir.dir.iterate();
+    try std.testing.expect((try it.next()) == null);
 }
@@ -25,6 +25,7 @@ pub const platform = common.Platform{
     .setFilePermissions = setFilePermissions,
     .getFilePermissions = getFilePermissions,
     .setFileTime = setFileTime,
+    .applyMetadata = applyMetadata,
     .createSymlink = createSymlink,
     .readSymlink = readSymlink,
     .isSymlink = isSymlink,
@@ -66,6 +67,56 @@ fn setFileTime(path: []const u8, mtime: i64) !void {
     }
 }
 
+/// Apply metadata records through their descriptors
+///
+/// Every attribute is set with an f*(2) call on the record's descriptor,
+/// so no path is resolved. io_uring has no chown/chmod/utimensat opcodes,
+/// so the calls are issued directly.
+fn applyMetadata(records: []const common.MetadataRecord, errors: []?anyerror) usize {
+    std.debug.assert(errors.len == records.len);
+
+    var failed: usize = 0;
+    for (records, errors) |record, *err| {
+        err.* = null;
+        applyRecord(record) catch |e| {
+            err.* = e;
+            failed += 1;
+        };
+    }
+    return failed;
+}
+
+fn applyRecord(record: common.MetadataRecord) !void {
+    // Ownership first: chown clears set-id bits that the mode may set,
+    // and security.capability, which is set below
+    if (record.uid != null or record.gid != null) {
+        try std.posix.fchown(record.fd, record.uid, record.gid);
+    }
+
+    if (record.mode) |mode| {
+        try std.posix.fchmod(record.fd, @intCast(mode));
+    }
+
+    // After chmod, which would otherwise overwrite an ACL's mask
+    for (record.xattrs) |xattr| try setFdXattr(record.fd, xattr.name, xattr.value);
+
+    if (record.atime != null or record.mtime != null) {
+        const times = [2]std.posix.timespec{
+            timeOrOmit(record.atime, record.atime_nsec),
+            timeOrOmit(record.mtime, record.mtime_nsec),
+        };
+        try std.posix.futimens(record.fd, &times);
+    }
+}
+
+/// Timestamp for futimens, or UTIME_OMIT to leave it unchanged
+fn timeOrOmit(seconds: ?i64, nsec: u32) std.posix.timespec {
+    return if (seconds) |sec|
+        .{ .sec = sec, .nsec = nsec }
+    else
+        .{ .sec = 0, .nsec = std.os.linux.UTIME.OMIT };
+}
+
 /// Create symbolic link using POSIX symlink
 fn createSymlink(target: []const u8, link_path: []const u8) !void {
     try std.fs.cwd().symLink(target, link_path, .{});
@@ -119,6 +170,336 @@ fn getPlatformName() []const u8 {
     return "Linux";
 }
 
+/// openat2(2) resolve flags (linux/openat2.h)
+pub const RESOLVE = struct {
+    pub const NO_XDEV: u64 = 0x01;
+    pub const NO_MAGICLINKS: u64 = 0x02;
+    pub const NO_SYMLINKS: u64 = 0x04;
+    pub const BENEATH: u64 = 0x08;
+    pub const IN_ROOT: u64 = 0x10;
+};
+
+/// `struct open_how` argument of openat2(2)
+const OpenHow = extern struct {
+    flags: u64,
+    mode: u64,
+    resolve: u64,
+};
+
+/// Resolution applied to every open below an extraction root
+const contained_resolve = RESOLVE.BENEATH | RESOLVE.NO_MAGICLINKS;
+
+/// Retries of an openat2 lookup that keeps racing a rename
+const max_resolve_races = 64;
+
+/// Errors from the beneath-root helpers (explicit: they recurse)
+pub const BeneathError = error{
+    PathTraversalAttempt,
+    SymLinkLoop,
+    FileNotFound,
+    PathAlreadyExists,
+    AccessDenied,
+    NotDir,
+    IsDir,
+    NameTooLong,
+    NoSpaceLeft,
+    Unsupported,
+    InvalidArgument,
+} || std.posix.MakeDirError || std.posix.UnexpectedError;
+
+/// Open a path with the kernel confining resolution beneath a directory
+///
+/// Uses openat2(2) with RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS, so "..",
+/// absolute symlinks, and symlinks pointing outside `dir_fd` all fail
+/// atomically inside the kernel instead of being checked up front.
+///
+/// Parameters:
+///   - dir_fd: Directory the path must stay beneath
+///   - path: Path relative to dir_fd
+///   - flags: open(2) flags
+///   - mode: Creation mode (used with O_CREAT)
+///
+/// Returns:
+///   - Newly opened file descriptor (caller must close)
+///
+/// Errors:
+///   - error.PathTraversalAttempt: Resolution would leave dir_fd, or a
+///     concurrent rename kept racing the lookup
+///   - error.Unsupported: Kernel lacks openat2 (pre-5.6) or it is filtered
+///   - error.InvalidArgument: Flags or path rejected (support itself is
+///     settled once by `probeResolveBeneath`)
+///   - (Usual open(2) errors)
+pub fn openBeneath(
+    dir_fd: std.posix.fd_t,
+    path: []const u8,
+    flags: std.posix.O,
+    mode: std.posix.mode_t,
+) BeneathError!std.posix.fd_t {
+    var path_buf: [std.fs.max_path_bytes:0]u8 = undefined;
+    const path_z = try std.fmt.bufPrintZ(&path_buf, "{s}", .{path});
+
+    var how = OpenHow{
+        .flags = @as(u32, @bitCast(flags)),
+        .mode = mode,
+        .resolve = contained_resolve,
+    };
+
+    // RESOLVE_BENEATH fails with EAGAIN when a rename races a ".." lookup;
+    // retry a bounded number of times so a hostile renamer cannot spin us
+    var races: usize = 0;
+    while (true) {
+        const rc = std.os.linux.syscall4(
+            .openat2,
+            @as(usize, @bitCast(@as(isize, dir_fd))),
+            @intFromPtr(path_z.ptr),
+            @intFromPtr(&how),
+            @sizeOf(OpenHow),
+        );
+        switch (std.posix.errno(rc)) {
+            .SUCCESS => return @intCast(rc),
+            .INTR => continue,
+            .AGAIN => {
+                races += 1;
+                if (races > max_resolve_races) return error.PathTraversalAttempt;
+                continue;
+            },
+            .XDEV => return error.PathTraversalAttempt,
+            .LOOP => return error.SymLinkLoop,
+            .NOENT => return error.FileNotFound,
+            .EXIST => return error.PathAlreadyExists,
+            .ACCES => return error.AccessDenied,
+            .NOTDIR => return error.NotDir,
+            .ISDIR => return error.IsDir,
+            .NAMETOOLONG => return error.NameTooLong,
+            .NOSPC => return error.NoSpaceLeft,
+            .NOSYS, .PERM => return error.Unsupported,
+            .INVAL => return error.InvalidArgument,
+            else => |err| return std.posix.unexpectedErrno(err),
+        }
+    }
+}
+
+/// Check whether the running kernel supports openat2 containment
+///
+/// Returns:
+///   - true on Linux 5.6+ when openat2 is not blocked by a seccomp filter
+pub fn probeResolveBeneath() bool {
+    const fd = openBeneath(std.posix.AT.FDCWD, ".", .{
+        .DIRECTORY = true,
+        .PATH = true,
+        .CLOEXEC = true,
+    }, 0) catch return false;
+    std.posix.close(fd);
+    return true;
+}
+
+/// Probe the filesystem features of a directory (see `common.probeDirectory`)
+///
+/// Works on unlinked scratch files, so nothing is left behind even if
+/// the process dies mid-probe.
+pub fn probeDirectory(dir_fd: std.posix.fd_t, source_fd: ?std.posix.fd_t, caps: *common.DirCapabilities) void {
+    const scratch = openScratch(dir_fd) orelse return;
+    defer std.posix.close(scratch);
+
+    caps.fallocate = std.posix.errno(std.os.linux.fallocate(scratch, 0, 0, 4096)) == .SUCCESS;
+
+    if (source_fd) |src| {
+        // Explicit offsets leave the source's file position alone
+        var off_in: i64 = 0;
+        var off_out: i64 = 0;
+        const rc = std.os.linux.copy_file_range(src, &off_in, scratch, &off_out, 1, 0);
+        caps.copy_file_range = std.posix.errno(rc) == .SUCCESS and rc == 1;
+    }
+}
+
+/// Open an unlinked read-write scratch file in a directory
+fn openScratch(dir_fd: std.posix.fd_t) ?std.posix.fd_t {
+    if (std.posix.openat(dir_fd, ".", .{
+        .ACCMODE = .RDWR,
+        .DIRECTORY = true,
+        .TMPFILE = true,
+        .CLOEXEC = true,
+    }, 0o600)) |fd| {
+        return fd;
+    } else |_| {}
+
+    // No O_TMPFILE here: a named file, unlinked right away
+    var name_buf: [48]u8 = undefined;
+    const name = std.fmt.bufPrintZ(&name_buf, ".zarc-probe-{d}", .{std.os.linux.getpid()}) catch return null;
+    const fd = std.posix.openat(dir_fd, name, .{
+        .ACCMODE = .RDWR,
+        .CREAT = true,
+        .EXCL = true,
+        .CLOEXEC = true,
+    }, 0o600) catch return null;
+    std.posix.unlinkat(dir_fd, name, 0) catch {};
+    return fd;
+}
+
+/// Reserve space for a file about to be written
+///
+/// Lets the filesystem allocate the file in as few extents as possible
+/// instead of growing it one write at a time.
+pub fn preallocate(fd: std.posix.fd_t, len: u64) !void {
+    const rc = std.os.linux.fallocate(fd, 0, 0, @intCast(len));
+    switch (std.posix.errno(rc)) {
+        .SUCCESS => return,
+        .NOSPC => return error.NoSpaceLeft,
+        .OPNOTSUPP, .NOSYS => return error.Unsupported,
+        else => |err| return std.posix.unexpectedErrno(err),
+    }
+}
+
+/// Create a directory and its parents without leaving a root directory
+///
+/// Each existing prefix is opened with `openBeneath`, and only the final
+/// missing component is created with mkdirat(2) relative to it, so a
+/// symlinked parent can never redirect creation outside `root_fd`.
+///
+/// Parameters:
+///   - root_fd: Extraction root
+///   - path: Directory path relative to root_fd
+pub fn makePathBeneath(root_fd: std.posix.fd_t, path: []const u8) BeneathError!void {
+    if (path.len == 0) return;
+
+    // Fast path: the directory already exists
+    if (openBeneath(root_fd, path, .{ .DIRECTORY = true, .PATH = true, .CLOEXEC = true }, 0)) |fd| {
+        std.posix.close(fd);
+        return;
+    } else |err| switch (err) {
+        error.FileNotFound => {},
+        else => return err,
+    }
+
+    var parent = try openParentBeneath(root_fd, path, true);
+    defer parent.close();
+
+    std.posix.mkdirat(parent.fd, parent.name, 0o755) catch |err| switch (err) {
+        error.PathAlreadyExists => {},
+        else => return err,
+    };
+}
+
+/// Parent directory of a path, opened beneath a root directory
+pub const BeneathParent = struct {
+    /// Directory descriptor (O_PATH) containing `name`
+    fd: std.posix.fd_t,
+
+    /// Whether `fd` was opened here (false when it is the root itself)
+    owned: bool,
+
+    /// Final path component, relative to `fd`
+    name: []const u8,
+
+    pub fn close(self: *BeneathParent) void {
+        if (self.owned) std.posix.close(self.fd);
+    }
+};
+
+/// Open the parent directory of `path` beneath `root_fd`
+///
+/// Parameters:
+///   - root_fd: Extraction root
+///   - path: Path relative to root_fd
+///   - create: Create missing parent directories first
+///
+/// Returns:
+///   - Parent descriptor and final component for use with *at(2) calls
+pub fn openParentBeneath(root_fd: std.posix.fd_t, path: []const u8, create: bool) BeneathError!BeneathParent {
+    const name = std.fs.path.basename(path);
+    const parent = std.fs.path.dirname(path) orelse "";
+    if (parent.len == 0) {
+        return .{ .fd = root_fd, .owned = false, .name = name };
+    }
+
+    if (create) try makePathBeneath(root_fd, parent);
+
+    const fd = try openBeneath(root_fd, parent, .{ .DIRECTORY = true, .PATH = true, .CLOEXEC = true }, 0);
+    return .{ .fd = fd, .owned = true, .name = name };
+}
+
+/// Set access and modification time through an open descriptor
+///
+/// Both are set with nanosecond precision in a single futimens(2) call.
+pub fn setFdTime(fd: std.posix.fd_t, atime: std.posix.timespec, mtime: std.posix.timespec) !void {
+    const times = [2]std.posix.timespec{ atime, mtime };
+    try std.posix.futimens(fd, &times);
+}
+
+/// Set an extended attribute through an open descriptor
+///
+/// Parameters:
+///   - fd: Open file or directory
+///   - name: Namespaced attribute name (e.g. "user.comment")
+///   - value: Raw attribute value
+///
+/// Errors:
+///   - error.Unsupported: Filesystem does not support the namespace
+///   - error.PermissionDenied: Namespace needs privileges (trusted.*,
+///     security.capability without CAP_SETFCAP)
+///   - error.InvalidArgument: Name or value rejected by the kernel
+pub fn setFdXattr(fd: std.posix.fd_t, name: []const u8, value: []const u8) !void {
+    // XATTR_NAME_MAX is 255
+    var name_buf: [256]u8 = undefined;
+    const name_z = std.fmt.bufPrintZ(&name_buf, "{s}", .{name}) catch return error.NameTooLong;
+
+    const rc = std.os.linux.syscall5(
+        .fsetxattr,
+        @as(usize, @bitCast(@as(isize, fd))),
+        @intFromPtr(name_z.ptr),
+        @intFromPtr(value.ptr),
+        value.len,
+        0,
+    );
+    return xattrResult(rc);
+}
+
+/// Set an extended attribute on a symlink itself
+///
+/// A symlink cannot be opened for fsetxattr(2), so lsetxattr(2) is given
+/// `/proc/self/fd/<dir_fd>/<name>`: the parent is taken from its open
+/// descriptor and only `name` is looked up, without being followed.
+/// The kernel refuses user.* attributes on symlinks.
+///
+/// Parameters:
+///   - dir_fd: Open parent directory (O_PATH is enough)
+///   - name: Final component of the symlink
+///   - attr_name: Namespaced attribute name
+///   - value: Raw attribute value
+///
+/// Errors:
+///   - Same as `setFdXattr`
+///   - error.FileNotFound: /proc is not mounted
+pub fn setLinkXattr(dir_fd: std.posix.fd_t, name: []const u8, attr_name: []const u8, value: []const u8) !void {
+    var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+    const path_z = std.fmt.bufPrintZ(&path_buf, "/proc/self/fd/{d}/{s}", .{ dir_fd, name }) catch return error.NameTooLong;
+    var name_buf: [256]u8 = undefined;
+    const name_z = std.fmt.bufPrintZ(&name_buf, "{s}", .{attr_name}) catch return error.NameTooLong;
+
+    const rc = std.os.linux.syscall5(
+        .lsetxattr,
+        @intFromPtr(path_z.ptr),
+        @intFromPtr(name_z.ptr),
+        @intFromPtr(value.ptr),
+        value.len,
+        0,
+    );
+    return xattrResult(rc);
+}
+
+fn xattrResult(rc: usize) !void {
+    switch (std.posix.errno(rc)) {
+        .SUCCESS => {},
+        .OPNOTSUPP => return error.Unsupported,
+        .PERM => return error.PermissionDenied,
+        .ACCES => return error.AccessDenied,
+        .NOENT => return error.FileNotFound,
+        .INVAL, .RANGE, .@"2BIG" => return error.InvalidArgument,
+        .NOSPC, .DQUOT => return error.NoSpaceLeft,
+        else => |err| return std.posix.unexpectedErrno(err),
+    }
+}
+
 // Tests
 test "Linux platform: set and get permissions" {
     if (@import("builtin").os.tag != .linux) {
@@ -178,6 +559,52 @@ test "Linux platform: set and get file time" {
     try std.testing.expectEqual(target_time, mtime_sec);
 }
 
+test "Linux platform: applyMetadata goes through descriptors" {
+    if (@import("builtin").os.tag != .linux) {
+        return error.SkipZigTest;
+    }
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    try tmp_dir.dir.makePath("sub");
+    var file = try tmp_dir.dir.createFile("sub/a.txt", .{});
+    file.close();
+
+    const file_fd = try common.openForMetadata(tmp_dir.dir, "sub/a.txt");
+    defer std.posix.close(file_fd);
+    const dir_fd = try common.openForMetadata(tmp_dir.dir, "sub");
+    defer std.posix.close(dir_fd);
+
+    // The update follows the descriptor, not the name it was opened by
+    try tmp_dir.dir.rename("sub/a.txt", "sub/b.txt");
+    try tmp_dir.dir.symLink("b.txt", "sub/a.txt", .{});
+
+    const records = [_]common.MetadataRecord{
+        .{ .fd = file_fd, .mode = 0o600, .mtime = 1234567890, .mtime_nsec = 250000000 },
+        // No such namespace: fails, but does not stop the batch
+        .{ .fd = file_fd, .xattrs = &.{.{ .name = "bogus.name", .value = "x" }} },
+        .{ .fd = dir_fd, .atime = 1000000000 },
+    };
+    var errors: [records.len]?anyerror = undefined;
+    try std.testing.expectEqual(@as(usize, 1), applyMetadata(&records, &errors));
+    try std.testing.expect(errors[0] == null);
+    try std.testing.expect(errors[1] != null);
+    try std.testing.expect(errors[2] == null);
+
+    const stat = try tmp_dir.dir.statFile("sub/b.txt");
+    try std.testing.expectEqual(@as(u32, 0o600), @as(u32, @intCast(stat.mode & 0o7777)));
+    try std.testing.expectEqual(@as(i128, 1234567890250000000), stat.mtime);
+
+    // Only the access time was given, so the directory's mtime is untouched
+    const dir_stat = try tmp_dir.dir.statFile("sub");
+    try std.testing.expectEqual(@as(i128, 1000000000), @divTrunc(dir_stat.atime, std.time.ns_per_s));
+    try std.testing.expect(@divTrunc(dir_stat.mtime, std.time.ns_per_s) != 1000000000);
+
+    // A symlink in place of the target is refused rather than followed
+    try std.testing.expectError(error.SymLinkLoop, common.openForMetadata(tmp_dir.dir, "sub/a.txt"));
+}
+
 test "Linux platform: symlink operations" {
     if (@import("builtin").os.tag != .linux) {
         return error.SkipZigTest;
@@ -212,6 +639,36 @@ test "Linux platform: symlink operations" {
     try std.testing.expect(!isSymlink("target.txt"));
 }
 
+test "Linux platform: openBeneath confines resolution" {
+    if (@import("builtin").os.tag != .linux or !probeResolveBeneath()) {
+        return error.SkipZigTest;
+    }
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const root = tmp_dir.dir.fd;
+    try makePathBeneath(root, "a/b/c");
+    try tmp_dir.dir.symLink("..", "a/up", .{});
+    try tmp_dir.dir.symLink("/etc", "a/abs", .{});
+
+    const fd = try openBeneath(root, "a/b/c", .{ .DIRECTORY = true, .CLOEXEC = true }, 0);
+    std.posix.close(fd);
+
+    try std.testing.expectError(
+        error.PathTraversalAttempt,
+        openBeneath(root, "../x", .{ .CLOEXEC = true }, 0),
+    );
+    try std.testing.expectError(
+        error.PathTraversalAttempt,
+        openBeneath(root, "a/up/../x", .{ .CLOEXEC = true }, 0),
+    );
+    try std.testing.expectError(
+        error.PathTraversalAttempt,
+        makePathBeneath(root, "a/abs/zarc"),
+    );
+}
+
 test "Linux platform: getPlatformName" {
     const name = getPlatformName();
     try std.testing.expectEqualStrings("Linux", name);
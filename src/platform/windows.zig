@@ -34,6 +34,7 @@ pub const platform = common.Platform{
     .setFilePermissions = setFilePermissions,
     .getFilePermissions = getFilePermissions,
     .setFileTime = setFileTime,
+    .applyMetadata = applyMetadata,
     .createSymlink = createSymlink,
     .readSymlink = readSymlink,
     .isSymlink = isSymlink,
@@ -121,6 +122,71 @@ fn setFileTime(path: []const u8, mtime: i64) !void {
     }
 }
 
+/// Apply metadata records through their handles
+///
+/// Ownership and extended attributes are ignored, and the mode is
+/// approximated by the read-only attribute.
+fn applyMetadata(records: []const common.MetadataRecord, errors: []?anyerror) usize {
+    std.debug.assert(errors.len == records.len);
+
+    var failed: usize = 0;
+    for (records, errors) |record, *err| {
+        err.* = null;
+        applyRecord(record) catch |e| {
+            err.* = e;
+            failed += 1;
+        };
+    }
+    return failed;
+}
+
+fn applyRecord(record: common.MetadataRecord) !void {
+    if (record.mtime) |mtime| {
+        const file = std.fs.File{ .handle = record.fd };
+        const mtime_ns = @as(i128, mtime) * std.time.ns_per_s + record.mtime_nsec;
+        const atime_ns = if (record.atime) |atime| @as(i128, atime) * std.time.ns_per_s + record.atime_nsec else mtime_ns;
+        try file.updateTimes(atime_ns, mtime_ns);
+    }
+    // Last: a read-only attribute would block SetFileTime
+    if (record.mode) |mode| try setReadOnly(record.fd, (mode & 0o200) == 0);
+}
+
+/// Set or clear FILE_ATTRIBUTE_READONLY through a handle
+fn setReadOnly(handle: windows.HANDLE, read_only: bool) !void {
+    var io: windows.IO_STATUS_BLOCK = undefined;
+    var info: windows.FILE_BASIC_INFORMATION = undefined;
+    switch (windows.ntdll.NtQueryInformationFile(handle, &io, &info, @sizeOf(windows.FILE_BASIC_INFORMATION), .FileBasicInformation)) {
+        .SUCCESS => {},
+        else => |rc| return windows.unexpectedStatus(rc),
+    }
+
+    const readonly: windows.ULONG = windows.FILE_ATTRIBUTE_READONLY;
+    info.FileAttributes = if (read_only) info.FileAttributes | readonly else info.FileAttributes & ~readonly;
+    // Zero leaves a time unchanged
+    info.CreationTime = 0;
+    info.LastAccessTime = 0;
+    info.LastWriteTime = 0;
+    info.ChangeTime = 0;
+
+    switch (windows.ntdll.NtSetInformationFile(handle, &io, &info, @sizeOf(windows.FILE_BASIC_INFORMATION), .FileBasicInformation)) {
+        .SUCCESS => {},
+        else => |rc| return windows.unexpectedStatus(rc),
+    }
+}
+
+/// Open a file or directory for attribute updates, without following
+/// a symlink or junction at the final component
+pub fn openForMetadata(dir: std.fs.Dir, sub_path: []const u8) !windows.HANDLE {
+    const path_w = try windows.sliceToPrefixedFileW(dir.fd, sub_path);
+    return windows.OpenFile(path_w.span(), .{
+        .dir = dir.fd,
+        .access_mask = windows.SYNCHRONIZE | windows.FILE_READ_ATTRIBUTES | windows.FILE_WRITE_ATTRIBUTES,
+        .creation = windows.FILE_OPEN,
+        .filter = .any,
+        .follow_symlinks = false,
+    });
+}
+
 /// Create symbolic link using CreateSymbolicLinkW
 ///
 /// Note: On Windows 10 and later with Developer Mode enabled,
@@ -16,6 +16,8 @@
 const std = @import("std");
 const zarc = @import("zarc");
 const TarReader = zarc.formats.tar.reader.TarReader;
+const TarBz2Reader = zarc.formats.tar.reader.TarBz2Reader;
+const TarXzReader = zarc.formats.tar.reader.TarXzReader;
 const extract = zarc.app.extract;
 const security = zarc.app.security;
 const builtin = @import("builtin");
@@ -76,9 +78,66 @@ test "compatibility: GNU tar - gzip compressed archive" {
 }
 
 test "compatibility: GNU tar - bzip2 compressed archive" {
-    // Note: Skip if bzip2 support is not yet implemented
-    std.debug.print("Skipping: bzip2 support not yet implemented\n", .{});
-    return error.SkipZigTest;
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const bz2_file = try std.fs.cwd().openFile("tests/fixtures/gnu_tar/basic.tar.bz2", .{});
+    defer bz2_file.close();
+
+    try tmp_dir.dir.makeDir("dest");
+    const dest_path = try tmp_dir.dir.realpathAlloc(allocator, "dest");
+    defer allocator.free(dest_path);
+
+    // Extract archive (bzip2 1.0.8 output, decoded on all cores)
+    var tar_reader = try TarBz2Reader.init(allocator, bz2_file, .{});
+    defer tar_reader.deinit();
+
+    var archive_reader = tar_reader.archiveReader();
+    defer archive_reader.deinit();
+
+    var result = try extract.extractArchive(allocator, &archive_reader, dest_path, .{});
+    defer result.deinit(allocator);
+
+    try std.testing.expect(result.succeeded > 0);
+    try std.testing.expectEqual(@as(usize, 0), result.failed);
+
+    var dest_dir = try std.fs.cwd().openDir(dest_path, .{});
+    defer dest_dir.close();
+    try dest_dir.accessZ("file1.txt", .{});
+}
+
+test "compatibility: GNU tar - xz compressed archive" {
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const xz_file = try std.fs.cwd().openFile("tests/fixtures/gnu_tar/basic.tar.xz", .{});
+    defer xz_file.close();
+
+    try tmp_dir.dir.makeDir("dest");
+    const dest_path = try tmp_dir.dir.realpathAlloc(allocator, "dest");
+    defer allocator.free(dest_path);
+
+    // Extract archive (single-threaded xz output: one block without sizes,
+    // decoded in order with a CRC64 check)
+    var tar_reader = try TarXzReader.init(allocator, xz_file, .{});
+    defer tar_reader.deinit();
+
+    var archive_reader = tar_reader.archiveReader();
+    defer archive_reader.deinit();
+
+    var result = try extract.extractArchive(allocator, &archive_reader, dest_path, .{});
+    defer result.deinit(allocator);
+
+    try std.testing.expect(result.succeeded > 0);
+    try std.testing.expectEqual(@as(usize, 0), result.failed);
+
+    var dest_dir = try std.fs.cwd().openDir(dest_path, .{});
+    defer dest_dir.close();
+    try dest_dir.accessZ("file1.txt", .{});
 }
 
 test "compatibility: GNU tar - long filename (GNU extension)" {
@@ -852,19 +852,18 @@ test "TarGzReader: read GNU tar.gz empty files" {
 // TarGzReader Error Handling Tests
 // =============================================================================
 
-test "TarGzReader: reject oversized archives (>512 MiB)" {
+test "TarGzReader: large archives are streamed, not loaded" {
     const allocator = std.testing.allocator;
 
-    // Create a temporary file that exceeds MAX_COMPRESSED_SIZE (512 MiB)
+    // A 513 MiB file used to be rejected outright by the in-memory reader.
+    // The streaming reader only buffers the gzip header, so a sparse file
+    // of zeros fails header validation without being read in full.
     var tmp_dir = std.testing.tmpDir(.{});
     defer tmp_dir.cleanup();
 
     const oversized_file = try tmp_dir.dir.createFile("oversized.gz", .{ .read = true });
     defer oversized_file.close();
 
-    // Write just enough data to trigger the size limit
-    // We don't need to write 512 MiB, just enough to exceed the readToEndAlloc limit
-    // The test will fail when trying to read more than MAX_COMPRESSED_SIZE
     const large_size: usize = 513 * 1024 * 1024; // 513 MiB
 
     // Seek to create a sparse file of the required size
@@ -872,9 +871,9 @@ test "TarGzReader: reject oversized archives (>512 MiB)" {
     try oversized_file.writeAll(&[_]u8{0});
     try oversized_file.seekTo(0);
 
-    // Should return error when trying to read oversized file
     const result = TarGzReader.init(allocator, oversized_file);
-    try std.testing.expectError(error.FileTooBig, result);
+    try std.testing.expectError(error.DecompressionFailed, result);
+    try std.testing.expect(try oversized_file.getPos() < large_size);
 }
 
 test "TarGzReader: handle corrupt gzip header" {